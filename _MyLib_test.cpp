@@ -38,9 +38,15 @@ extern bool ntp_client();
 
 // test_unicode_string_wcsstr.cpp
 extern bool test_uni_wcsstr();
+extern bool test_uni_wcsstr_benchmark();
 
 // test_match.cpp
 extern bool test_match();
+extern bool test_glob_set();
+extern bool test_glob_set_benchmark();
+extern bool test_glob_pattern();
+extern bool test_glob_options();
+extern bool test_match_benchmark();
 
 // test_std_future_async.cpp
 extern bool test_std_future_async();
@@ -49,6 +55,11 @@ extern bool test_std_future_async();
 extern bool test_cstream();
 extern bool test_cstream_read_only();
 extern bool test_cstream_read_write_string();
+extern bool test_cstream_growth_reset();
+extern bool test_cstream_pool();
+extern bool test_cstream_benchmark();
+extern bool test_csegmented_stream();
+extern bool test_csegmented_stream_benchmark();
 
 // _test_log.cpp
 extern bool test_log_rotate();
@@ -189,6 +200,25 @@ bool test_rc4_encrypt();
 // md5.cpp / sha2.cpp
 bool test_md5_sha2();
 
+// _test_sha2.cpp
+extern bool test_sha256_impl_equivalence();
+extern bool test_sha256_benchmark();
+
+// _test_hash_batch.cpp
+extern bool test_hash_batch_equivalence();
+extern bool test_hash_batch_benchmark();
+extern bool test_get_file_hash_batch();
+
+// _test_file_hash_engine.cpp
+extern bool test_file_hash_engine();
+extern bool test_file_hash_engine_benchmark();
+extern bool test_get_file_hash_by_filehandle();
+extern bool test_file_hash_engine_pool();
+
+// _test_file_hash_cache.cpp
+extern bool test_file_hash_cache();
+extern bool test_file_hash_cache_sweep();
+
 // _test_boost_asio_timer.cpp
 extern bool test_boost_asio_timer();
 
@@ -235,6 +265,8 @@ bool test_curl_http();
 bool test_curl_http_upload();
 bool test_curl_http_post_with_response_header();
 bool test_curl_http_patch();
+bool test_curl_http_download_ctx();
+bool test_curl_http_download_ctx_benchmark();
 
 // thread_pool.h
 extern bool test_thread_pool();
@@ -247,6 +279,11 @@ extern bool test_std_thread_with_lambda();
 
 //_test_aes256.cpp
 extern bool test_aes256_encrypt_decrypt_file();
+extern bool test_aes256_crypt_file_stream();
+extern bool test_aes256_gcm_crypt_buffer();
+extern bool test_aes256_gcm_benchmark();
+extern bool test_aes256_session();
+extern bool test_aes256_session_benchmark();
 
 // _test_sched_client.cpp
 extern bool test_sched_client();
@@ -290,6 +327,46 @@ bool test_print_percent();
 // _test_machine_id.cpp
 extern bool test_generate_machine_id();
 
+// _test_base64.cpp
+extern bool test_base64_simd();
+extern bool test_base64_benchmark();
+
+// _test_utf_transcode.cpp
+extern bool test_utf_transcode();
+extern bool test_utf_transcode_benchmark();
+
+// _test_string_tokenizer.cpp
+extern bool test_string_tokenizer();
+extern bool test_string_tokenizer_benchmark();
+
+// _test_case_fold.cpp
+extern bool test_case_fold();
+extern bool test_case_fold_benchmark();
+
+// _test_replace_set.cpp
+extern bool test_replace_set();
+extern bool test_replace_set_benchmark();
+
+// _test_hex_codec.cpp
+extern bool test_hex_codec();
+extern bool test_hex_codec_benchmark();
+
+// _test_num_parse.cpp
+extern bool test_num_parse();
+extern bool test_num_parse_benchmark();
+
+// _test_str_format.cpp
+extern bool test_str_format();
+extern bool test_str_format_benchmark();
+
+// _test_prng.cpp
+extern bool test_prng();
+extern bool test_prng_benchmark();
+
+// _test_timestamp.cpp
+extern bool test_timestamp();
+extern bool test_timestamp_benchmark();
+
 bool test_get_sid();
 bool test_std_string_find();
 
@@ -306,10 +383,21 @@ void run_test()
 	//assert_bool(true, get_mbr_gpt_info);
 	//assert_bool(true, ntp_client);
 	//assert_bool(true, test_uni_wcsstr);
+	//assert_bool(true, test_uni_wcsstr_benchmark);
 	//assert_bool(true, test_match);
+	//assert_bool(true, test_glob_set);
+	//assert_bool(true, test_glob_set_benchmark);
+	//assert_bool(true, test_glob_pattern);
+	//assert_bool(true, test_glob_options);
+	//assert_bool(true, test_match_benchmark);
 	//assert_bool(true, test_cstream);	
 	//assert_bool(true, test_cstream_read_only);
 	//assert_bool(true, test_cstream_read_write_string);
+	//assert_bool(true, test_cstream_growth_reset);
+	//assert_bool(true, test_cstream_pool);
+	//assert_bool(true, test_cstream_benchmark);
+	//assert_bool(true, test_csegmented_stream);
+	//assert_bool(true, test_csegmented_stream_benchmark);
 	//assert_bool(true, test_log_rotate);
 	//assert_bool(true, test_steady_timer);
 	//assert_bool(true, test_steady_multiple_timer_in_single_thread);
@@ -388,12 +476,32 @@ void run_test()
 	//assert_bool(true, test_get_process_creation_time);
 
 	//assert_bool(true, test_base64);
+	//assert_bool(true, test_base64_simd);
+	//assert_bool(true, test_base64_benchmark);
+	//assert_bool(true, test_utf_transcode);
+	//assert_bool(true, test_utf_transcode_benchmark);
 	//assert_bool(true, test_random);
 	//assert_bool(true, test_ip_mac);
 	//assert_bool(true, test_ip_to_str);
 
 	//assert_bool(true, test_strtok);
 	//assert_bool(true, test_split_stringw);
+	//assert_bool(true, test_string_tokenizer);
+	//assert_bool(true, test_string_tokenizer_benchmark);
+	//assert_bool(true, test_case_fold);
+	//assert_bool(true, test_case_fold_benchmark);
+	//assert_bool(true, test_replace_set);
+	//assert_bool(true, test_replace_set_benchmark);
+	//assert_bool(true, test_hex_codec);
+	//assert_bool(true, test_hex_codec_benchmark);
+	//assert_bool(true, test_num_parse);
+	//assert_bool(true, test_num_parse_benchmark);
+	//assert_bool(true, test_str_format);
+	//assert_bool(true, test_str_format_benchmark);
+	//assert_bool(true, test_prng);
+	//assert_bool(true, test_prng_benchmark);
+	//assert_bool(true, test_timestamp);
+	//assert_bool(true, test_timestamp_benchmark);
 	//assert_bool(true, test_cpp_class);
 	//assert_bool(true, test_nt_name_to_dos_name);
 
@@ -415,6 +523,17 @@ void run_test()
 	//assert_bool(true, test_file_time_stuff);
 	//assert_bool(true, test_rc4_encrypt);
 	//assert_bool(true, test_md5_sha2);
+	//assert_bool(true, test_sha256_impl_equivalence);
+	//assert_bool(true, test_sha256_benchmark);
+	//assert_bool(true, test_hash_batch_equivalence);
+	//assert_bool(true, test_hash_batch_benchmark);
+	//assert_bool(true, test_get_file_hash_batch);
+	//assert_bool(true, test_file_hash_engine);
+	//assert_bool(true, test_file_hash_engine_benchmark);
+	//assert_bool(true, test_get_file_hash_by_filehandle);
+	//assert_bool(true, test_file_hash_engine_pool);
+	//assert_bool(true, test_file_hash_cache);
+	//assert_bool(true, test_file_hash_cache_sweep);
 
 	//assert_bool(true, boost_lexical_cast);
 	//assert_bool(true, boost_shared_ptr_void);
@@ -449,6 +568,11 @@ void run_test()
 	//assert_bool(true, test_set_binary_data);
 	//assert_bool(true, test_reg_multi_value);
 	//assert_bool(true, test_aes256_encrypt_decrypt_file);
+	//assert_bool(true, test_aes256_crypt_file_stream);
+	//assert_bool(true, test_aes256_gcm_crypt_buffer);
+	//assert_bool(true, test_aes256_gcm_benchmark);
+	//assert_bool(true, test_aes256_session);
+	//assert_bool(true, test_aes256_session_benchmark);
 
 	//assert_bool(true, test_curl_https_down_with_auth);
 	//assert_bool(true, test_curl_https);
@@ -456,6 +580,8 @@ void run_test()
 	//assert_bool(true, test_curl_http_upload);
 	//assert_bool(true, test_curl_http_post_with_response_header);
 	//assert_bool(true, test_curl_http_patch);
+	//assert_bool(true, test_curl_http_download_ctx);
+	//assert_bool(true, test_curl_http_download_ctx_benchmark);
 	
 	//assert_bool(true, test_alignment);
 	//assert_bool(true, test_create_string_from_buffer);
@@ -2787,6 +2913,118 @@ bool test_crc64()
     log_info "e9c6d914c4b8d9ca == %016llx",
         (unsigned long long) crc64(0, (unsigned char*)"123456789", 9)
         log_end;
+
+    const int impls[] = {
+        CRC64_IMPL_BYTE,
+        CRC64_IMPL_SLICE8,
+        CRC64_IMPL_SLICE16,
+        CRC64_IMPL_PCLMUL
+    };
+
+    std::vector<unsigned char> data(64 * 1024 * 1024);
+    uint64_t seed = 0x5eed;
+    for (auto& b : data)
+    {
+        seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+        b = (unsigned char)(seed >> 56);
+    }
+
+    //
+    //  cross-implementation equivalence (unaligned start, 0 ~ 4 KB lengths,
+    //  zero/non-zero initial crc)
+    //
+    for (int impl : impls)
+    {
+        if (!crc64_set_impl(impl))
+        {
+            log_info "crc64 %s is not supported on this cpu.", crc64_impl_name(impl) log_end;
+            continue;
+        }
+
+        if (0xe9c6d914c4b8d9caull != crc64(0, (unsigned char*)"123456789", 9))
+        {
+            log_err "crc64 %s, check value mismatch.", crc64_impl_name(impl) log_end;
+            return false;
+        }
+
+        for (uint64_t len = 0; len <= 4096; len += (len < 512) ? 1 : 61)
+        {
+            for (uint64_t init : { 0ull, 0x0123456789abcdefull })
+            {
+                _ASSERTE(true == crc64_set_impl(CRC64_IMPL_BYTE));
+                uint64_t expected = crc64(init, &data[3], len);
+
+                _ASSERTE(true == crc64_set_impl(impl));
+                if (expected != crc64(init, &data[3], len))
+                {
+                    log_err "crc64 %s, mismatch. len=%llu",
+                        crc64_impl_name(impl),
+                        len
+                        log_end;
+                    crc64_set_impl(CRC64_IMPL_AUTO);
+                    return false;
+                }
+            }
+        }
+    }
+    crc64_set_impl(CRC64_IMPL_AUTO);
+
+    //
+    //  crc64_combine: 청크별로 별도 스레드에서 계산한 crc 를 합친 결과가
+    //  전체 버퍼의 crc 와 같아야 한다.
+    //
+    const uint64_t whole = crc64(0, data.data(), data.size());
+    for (uint64_t chunks : { 1ull, 2ull, 3ull, 7ull, 16ull })
+    {
+        uint64_t chunk_size = data.size() / chunks;
+        std::vector<uint64_t> crcs((size_t)chunks);
+        std::vector<std::thread> threads;
+        for (uint64_t i = 0; i < chunks; ++i)
+        {
+            uint64_t len = (i == chunks - 1) ? data.size() - chunk_size * i : chunk_size;
+            threads.push_back(std::thread([&crcs, &data, i, chunk_size, len]()
+            {
+                crcs[(size_t)i] = crc64(0, &data[(size_t)(chunk_size * i)], len);
+            }));
+        }
+
+        uint64_t combined = 0;
+        for (uint64_t i = 0; i < chunks; ++i)
+        {
+            threads[(size_t)i].join();
+            uint64_t len = (i == chunks - 1) ? data.size() - chunk_size * i : chunk_size;
+            combined = crc64_combine(combined, crcs[(size_t)i], len);
+        }
+
+        if (combined != whole)
+        {
+            log_err "crc64_combine mismatch. chunks=%llu", chunks log_end;
+            return false;
+        }
+    }
+
+    //
+    //  throughput
+    //
+    for (int impl : impls)
+    {
+        if (!crc64_set_impl(impl)) continue;
+
+        StopWatch sw;
+        sw.Start();
+        uint64_t crc = 0;
+        for (int i = 0; i < 4; ++i)
+        {
+            crc = crc64(crc, data.data(), data.size());
+        }
+        sw.Stop();
+
+        log_info "crc64 %-8s %10.2f MB/s",
+            crc64_impl_name(impl),
+            (double)(data.size() * 4) / (1024.0 * 1024.0) / sw.GetDurationSecond()
+            log_end;
+    }
+    crc64_set_impl(CRC64_IMPL_AUTO);
     return true;
 }
 
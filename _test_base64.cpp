@@ -0,0 +1,311 @@
+﻿/**
+ * @file    _test_base64.cpp
+ * @brief   base64 (scalar/SSSE3/AVX2) equivalence, validation and throughput tests.
+ *
+ * @author  Yonhgwhan, Roh (somma@somma.kr)
+ * @date    2026/10/18 created.
+ * @copyright (C)Somma, Inc. All rights reserved.
+**/
+#include "stdafx.h"
+#include "_MyLib/src/base64.h"
+#include "_MyLib/src/CStream.h"
+#include "_MyLib/src/StopWatch.h"
+#include <random>
+
+static const int _base64_impls[] = { BASE64_IMPL_SCALAR, BASE64_IMPL_SSSE3, BASE64_IMPL_AVX2 };
+
+/// @brief	예전 (René Nyffenegger) 구현의 인코딩. 결과 비교와 벤치마크용
+static std::string legacy_base64_encode(const unsigned char* in, size_t in_len)
+{
+	static const std::string chars = 
+		"ABCDEFGHIJKLMNOPQRSTUVWXYZ"
+		"abcdefghijklmnopqrstuvwxyz"
+		"0123456789+/";
+	std::string ret;
+	int i = 0;
+	unsigned char a3[3];
+	while (in_len--)
+	{
+		a3[i++] = *(in++);
+		if (3 == i)
+		{
+			ret += chars[(a3[0] & 0xfc) >> 2];
+			ret += chars[((a3[0] & 0x03) << 4) + ((a3[1] & 0xf0) >> 4)];
+			ret += chars[((a3[1] & 0x0f) << 2) + ((a3[2] & 0xc0) >> 6)];
+			ret += chars[a3[2] & 0x3f];
+			i = 0;
+		}
+	}
+	if (i)
+	{
+		for (int j = i; j < 3; j++) a3[j] = 0;
+		const unsigned char a4[4] = { 
+			(unsigned char)((a3[0] & 0xfc) >> 2),
+			(unsigned char)(((a3[0] & 0x03) << 4) + ((a3[1] & 0xf0) >> 4)),
+			(unsigned char)(((a3[1] & 0x0f) << 2) + ((a3[2] & 0xc0) >> 6)),
+			(unsigned char)(a3[2] & 0x3f) };
+		for (int j = 0; j < i + 1; j++) ret += chars[a4[j]];
+		while (i++ < 3) ret += '=';
+	}
+	return ret;
+}
+
+/// @brief	구현별 인코딩/디코딩 결과가 예전 구현과 같은지, 잘못된 입력을 
+///			거부하는지, 청크 단위 API 와 CMemoryStream API 가 같은 결과를 
+///			만드는지 확인한다.
+bool test_base64_simd()
+{
+	std::mt19937 rng(0x5a5a);
+	std::vector<uint8_t> data(64 * 1024 + 7);
+	for (auto& b : data) { b = (uint8_t)rng(); }
+
+	std::vector<size_t> sizes;
+	for (size_t i = 0; i <= 200; ++i) sizes.push_back(i);
+	sizes.push_back(1000);
+	sizes.push_back(4096);
+	sizes.push_back(data.size());
+
+	bool ret = true;
+	for (int impl : _base64_impls)
+	{
+		if (!base64_impl_supported(impl)) continue;
+		base64_set_impl(impl);
+
+		for (size_t size : sizes)
+		{
+			const std::string expected = legacy_base64_encode(data.data(), size);
+
+			//
+			//	인코딩: 호출자 버퍼, std::string, CMemoryStream
+			//
+			std::vector<char> encoded(base64_encoded_length(size) + 1, '#');
+			size_t encoded_len = 0;
+			if (!base64_encode(data.data(), size, encoded.data(), encoded.size() - 1, encoded_len) ||
+				encoded_len != expected.size() ||
+				0 != memcmp(encoded.data(), expected.c_str(), encoded_len) ||
+				'#' != encoded[encoded_len])
+			{
+				log_err "base64_encode() mismatch. impl=%s, size=%zu", base64_impl_name(impl), size log_end;
+				ret = false;
+				continue;
+			}
+			if (0 < size && expected != base64_encode(data.data(), (unsigned int)size))
+			{
+				log_err "base64_encode() (string) mismatch. impl=%s, size=%zu", base64_impl_name(impl), size log_end;
+				ret = false;
+			}
+
+			CMemoryStream stream;
+			if (!base64_encode(data.data(), size, stream) ||
+				stream.GetSize() != expected.size() ||
+				(0 < size && 0 != memcmp(stream.GetMemory(), expected.c_str(), expected.size())))
+			{
+				log_err "base64_encode() (stream) mismatch. impl=%s, size=%zu", base64_impl_name(impl), size log_end;
+				ret = false;
+			}
+
+			//
+			//	디코딩: 호출자 버퍼 (여유 없는 크기), std::string, CMemoryStream
+			//
+			std::vector<uint8_t> decoded(size + 1, 0xcc);
+			size_t decoded_len = 0;
+			if (!base64_decode(expected.c_str(), expected.size(), decoded.data(), size, decoded_len) ||
+				decoded_len != size ||
+				(0 < size && 0 != memcmp(decoded.data(), data.data(), size)) ||
+				0xcc != decoded[size])
+			{
+				log_err "base64_decode() mismatch. impl=%s, size=%zu", base64_impl_name(impl), size log_end;
+				ret = false;
+			}
+			if (0 < size && 0 < size % 3 &&
+				base64_decode(expected.c_str(), expected.size(), decoded.data(), size - 1, decoded_len))
+			{
+				log_err "base64_decode() accepted small buffer. impl=%s, size=%zu", base64_impl_name(impl), size log_end;
+				ret = false;
+			}
+
+			std::string legacy = base64_decode(expected);
+			if (legacy.size() != size || (0 < size && 0 != memcmp(legacy.c_str(), data.data(), size)))
+			{
+				log_err "base64_decode() (string) mismatch. impl=%s, size=%zu", base64_impl_name(impl), size log_end;
+				ret = false;
+			}
+
+			CMemoryStream decoded_stream;
+			if (!base64_decode(expected.c_str(), expected.size(), decoded_stream) ||
+				decoded_stream.GetSize() != size ||
+				(0 < size && 0 != memcmp(decoded_stream.GetMemory(), data.data(), size)))
+			{
+				log_err "base64_decode() (stream) mismatch. impl=%s, size=%zu", base64_impl_name(impl), size log_end;
+				ret = false;
+			}
+
+			//
+			//	청크 단위 인코딩/디코딩 (임의의 청크 경계)
+			//
+			base64_encoder encoder;
+			std::string chunked;
+			std::vector<char> chunk_out;
+			for (size_t pos = 0; pos <= size;)
+			{
+				const size_t r = (size_t)(rng() % 97);
+				size_t n = min(r, size - pos);
+				chunk_out.resize(base64_encoder::max_update_length(n) + 4);
+				size_t out_len = 0;
+				if (!encoder.update(data.data() + pos, n, chunk_out.data(), chunk_out.size(), out_len))
+				{
+					ret = false;
+					break;
+				}
+				chunked.append(chunk_out.data(), out_len);
+				pos += n;
+				if (pos == size)
+				{
+					if (!encoder.finish(chunk_out.data(), chunk_out.size(), out_len)) ret = false;
+					chunked.append(chunk_out.data(), out_len);
+					break;
+				}
+			}
+			if (chunked != expected)
+			{
+				log_err "base64_encoder mismatch. impl=%s, size=%zu", base64_impl_name(impl), size log_end;
+				ret = false;
+			}
+
+			base64_decoder decoder;
+			std::vector<uint8_t> dechunked;
+			std::vector<uint8_t> dechunk_out;
+			for (size_t pos = 0; pos < expected.size();)
+			{
+				const size_t r = (size_t)(rng() % 97 + 1);
+				size_t n = min(r, expected.size() - pos);
+				dechunk_out.resize(base64_decoder::max_update_length(n));
+				size_t out_len = 0;
+				if (!decoder.update(expected.c_str() + pos, n, dechunk_out.data(), dechunk_out.size(), out_len))
+				{
+					ret = false;
+					break;
+				}
+				dechunked.insert(dechunked.end(), dechunk_out.begin(), dechunk_out.begin() + out_len);
+				pos += n;
+			}
+			if (!decoder.finish() ||
+				dechunked.size() != size ||
+				(0 < size && 0 != memcmp(dechunked.data(), data.data(), size)))
+			{
+				log_err "base64_decoder mismatch. impl=%s, size=%zu", base64_impl_name(impl), size log_end;
+				ret = false;
+			}
+		}
+
+		//
+		//	잘못된 입력: 모든 위치에 잘못된 문자를 넣어본다. (SIMD 블록 내부/경계 포함)
+		//
+		const std::string valid = legacy_base64_encode(data.data(), 300);
+		const char bad_chars[] = { ' ', '\n', '-', '_', '.', '=', '\x80', '\xff', '\0', '@', '[', '`', '{' };
+		std::vector<uint8_t> out(valid.size());
+		for (size_t pos = 0; pos < valid.size(); ++pos)
+		{
+			for (char bad : bad_chars)
+			{
+				std::string broken = valid;
+				broken[pos] = bad;
+				size_t out_len = 0;
+				if (base64_decode(broken.c_str(), broken.size(), out.data(), out.size(), out_len))
+				{
+					log_err "invalid input accepted. impl=%s, pos=%zu, char=0x%02x",
+						base64_impl_name(impl), pos, (uint8_t)bad
+						log_end;
+					ret = false;
+				}
+			}
+		}
+
+		const char* invalid[] = { "A", "AB", "ABC", "A===", "====", "AB=C", "AB==AB==", "QQ=", "QR==", "QUJ=", "QUI=x" };
+		for (const char* str : invalid)
+		{
+			size_t out_len = 0;
+			if (base64_decode(str, strlen(str), out.data(), out.size(), out_len))
+			{
+				log_err "invalid input accepted. impl=%s, input=%s", base64_impl_name(impl), str log_end;
+				ret = false;
+			}
+		}
+
+		//
+		//	패딩 이후의 입력은 decoder 도 거부해야 한다.
+		//
+		base64_decoder decoder;
+		size_t out_len = 0;
+		if (!decoder.update("QQ==", 4, out.data(), out.size(), out_len) ||
+			decoder.update("QQ==", 4, out.data(), out.size(), out_len) ||
+			decoder.finish())
+		{
+			log_err "base64_decoder accepted data after padding. impl=%s", base64_impl_name(impl) log_end;
+			ret = false;
+		}
+	}
+
+	base64_set_impl(BASE64_IMPL_AUTO);
+	return ret;
+}
+
+/// @brief	64 MB 인코딩/디코딩 처리량 (예전 구현, 구현별)
+bool test_base64_benchmark()
+{
+	const size_t size = 64 * 1024 * 1024;
+	std::vector<uint8_t> data(size);
+	std::mt19937 rng(1);
+	for (auto& b : data) { b = (uint8_t)rng(); }
+
+	std::vector<char> encoded(base64_encoded_length(size));
+	std::vector<uint8_t> decoded(size);
+	const double mb = size / (1024.0 * 1024.0);
+
+	StopWatch sw;
+	sw.Start();
+	std::string legacy_encoded = legacy_base64_encode(data.data(), size);
+	sw.Stop();
+	const double legacy_encode = sw.GetDurationSecond();
+
+	log_info "legacy : encode %8.2f MB/s", mb / legacy_encode log_end;
+
+	bool ret = true;
+	for (int impl : _base64_impls)
+	{
+		if (!base64_impl_supported(impl)) continue;
+		base64_set_impl(impl);
+
+		size_t out_len = 0;
+		sw.Start();
+		for (int i = 0; i < 4; ++i)
+		{
+			base64_encode(data.data(), size, encoded.data(), encoded.size(), out_len);
+		}
+		sw.Stop();
+		const double encode_sec = sw.GetDurationSecond() / 4;
+
+		sw.Start();
+		for (int i = 0; i < 4; ++i)
+		{
+			if (!base64_decode(encoded.data(), encoded.size(), decoded.data(), decoded.size(), out_len)) ret = false;
+		}
+		sw.Stop();
+		const double decode_sec = sw.GetDurationSecond() / 4;
+
+		if (0 != memcmp(encoded.data(), legacy_encoded.c_str(), encoded.size()) || decoded != data)
+		{
+			log_err "mismatch. impl=%s", base64_impl_name(impl) log_end;
+			ret = false;
+		}
+
+		log_info "%-7s: encode %8.2f MB/s, decode %8.2f MB/s",
+			base64_impl_name(impl),
+			mb / encode_sec,
+			mb / decode_sec
+			log_end;
+	}
+
+	base64_set_impl(BASE64_IMPL_AUTO);
+	return ret;
+}
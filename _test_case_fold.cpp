@@ -0,0 +1,368 @@
+﻿/**
+ * @file    _test_case_fold.cpp
+ * @brief   ASCII case folding (scalar/SSE2/AVX2) tests and prefix compare benchmark.
+ *
+ * @author  Yonhgwhan, Roh (somma@somma.kr)
+ * @date    2026/10/18 created.
+ * @copyright (C)Somma, Inc. All rights reserved.
+**/
+#include "stdafx.h"
+#include "_MyLib/src/case_fold.h"
+#include "_MyLib/src/StopWatch.h"
+#include <wctype.h>
+#include <random>
+#include <vector>
+
+static const int _case_fold_impls[] = {
+	CASE_FOLD_IMPL_SCALAR,
+	CASE_FOLD_IMPL_SSE2,
+	CASE_FOLD_IMPL_AVX2
+};
+
+/// @brief	비교용 단순 구현
+static char ref_lower(char c)
+{
+	return (c >= 'A' && c <= 'Z') ? (char)(c + 0x20) : c;
+}
+
+static char ref_upper(char c)
+{
+	return (c >= 'a' && c <= 'z') ? (char)(c - 0x20) : c;
+}
+
+static bool ref_equals_ci(const std::string& lhs, const std::string& rhs)
+{
+	if (lhs.size() != rhs.size()) return false;
+	for (size_t i = 0; i < lhs.size(); ++i)
+	{
+		if (ref_lower(lhs[i]) != ref_lower(rhs[i])) return false;
+	}
+	return true;
+}
+
+static size_t ref_find_ci(const std::string& s, const std::string& needle, size_t pos)
+{
+	for (size_t i = pos; i + needle.size() <= s.size(); ++i)
+	{
+		if (ref_equals_ci(s.substr(i, needle.size()), needle)) return i;
+	}
+	return std::string::npos;
+}
+
+static bool ref_equals_ci(const std::wstring& lhs, const std::wstring& rhs)
+{
+	if (lhs.size() != rhs.size()) return false;
+	for (size_t i = 0; i < lhs.size(); ++i)
+	{
+		if (towlower(lhs[i]) != towlower(rhs[i])) return false;
+	}
+	return true;
+}
+
+static size_t ref_find_ci(const std::wstring& s, const std::wstring& needle, size_t pos)
+{
+	for (size_t i = pos; i + needle.size() <= s.size(); ++i)
+	{
+		if (ref_equals_ci(s.substr(i, needle.size()), needle)) return i;
+	}
+	return std::wstring::npos;
+}
+
+/// @brief	ASCII 대소문자와 '@', '[', '`', '{' 같은 경계 문자가 섞인 문자열
+static std::string random_ascii(std::mt19937& rng, size_t len)
+{
+	static const char chars[] = "aAbBzZyY@[`{09_\\.";
+	std::string str;
+	for (size_t i = 0; i < len; ++i)
+	{
+		str.push_back(chars[rng() % (sizeof(chars) - 1)]);
+	}
+	return str;
+}
+
+/// @brief	random_ascii() 에 한글/라틴 문자가 가끔 섞인 문자열
+static std::wstring random_wide(std::mt19937& rng, size_t len, bool ascii_only)
+{
+	static const wchar_t others[] = { 0x00c4, 0x00e4, 0x0100, 0x0101, 0xac00, 0xd64d, 0x0130 };
+	std::string ascii = random_ascii(rng, len);
+	std::wstring str(ascii.begin(), ascii.end());
+	if (!ascii_only)
+	{
+		for (size_t i = 0; i < str.size(); ++i)
+		{
+			if (0 == rng() % 16) str[i] = others[rng() % _countof(others)];
+		}
+	}
+	return str;
+}
+
+/// @brief	모든 구현이 단순 구현과 같은 결과를 내는지 확인한다.
+bool test_case_fold()
+{
+	bool ret = true;
+	for (int impl : _case_fold_impls)
+	{
+		if (!case_fold_set_impl(impl))
+		{
+			log_info "case_fold impl %s is not supported, skip.", case_fold_impl_name(impl) log_end;
+			continue;
+		}
+		if (impl != case_fold_get_impl()) return false;
+
+		std::mt19937 rng(impl);
+
+		//
+		//	블록 크기 (16/32 바이트, 8/16 문자) 경계 주변 길이를 모두 확인한다.
+		//
+		for (size_t len = 0; len <= 100; ++len)
+		{
+			std::string str = random_ascii(rng, len);
+
+			std::string lower(str);
+			std::string upper(str);
+			fold_to_lower(lower);
+			fold_to_upper(upper);
+			for (size_t i = 0; i < len; ++i)
+			{
+				if (lower[i] != ref_lower(str[i]) || upper[i] != ref_upper(str[i]))
+				{
+					log_err "fold mismatch. impl=%s, len=%zu, pos=%zu",
+						case_fold_impl_name(impl), len, i
+						log_end;
+					ret = false;
+					break;
+				}
+			}
+
+			//
+			//	대소문자만 바꾼 문자열은 같아야 하고, 한 문자를 바꾸면 달라야 한다.
+			//
+			if (!equals_ci(str, upper) || !equals_ci(lower, upper))
+			{
+				log_err "equals_ci failed. impl=%s, len=%zu", case_fold_impl_name(impl), len log_end;
+				ret = false;
+			}
+			for (size_t pos = 0; pos < len; ++pos)
+			{
+				std::string other(upper);
+				other[pos] = (other[pos] == '0') ? '1' : '0';
+				if (equals_ci(str, other) != ref_equals_ci(str, other))
+				{
+					log_err "equals_ci mismatch. impl=%s, len=%zu, pos=%zu",
+						case_fold_impl_name(impl), len, pos
+						log_end;
+					ret = false;
+				}
+			}
+
+			//
+			//	'@' (0x40) 와 '`' (0x60), '[' (0x5b) 와 '{' (0x7b) 는 같지 않다.
+			//
+			if (equals_ci(std::string(len, '@'), std::string(len, '`')) && 0 != len)
+			{
+				log_err "equals_ci boundary failed. impl=%s, len=%zu", case_fold_impl_name(impl), len log_end;
+				ret = false;
+			}
+
+			const size_t cut = (0 == len) ? 0 : rng() % (len + 1);
+			if (!starts_with_ci(str, lower.substr(0, cut)) || 
+				!ends_with_ci(str, upper.substr(len - cut)) ||
+				starts_with_ci(lower.substr(0, cut), str + "x"))
+			{
+				log_err "starts_with_ci/ends_with_ci failed. impl=%s, len=%zu", 
+					case_fold_impl_name(impl), len 
+					log_end;
+				ret = false;
+			}
+
+			for (size_t nlen = 1; nlen <= 4 && nlen <= len; ++nlen)
+			{
+				const std::string needle = upper.substr(rng() % (len - nlen + 1), nlen);
+				for (size_t pos = 0; pos <= len; pos += 7)
+				{
+					if (find_ci(str, needle, pos) != ref_find_ci(str, needle, pos))
+					{
+						log_err "find_ci mismatch. impl=%s, len=%zu, needle=%s, pos=%zu",
+							case_fold_impl_name(impl), len, needle.c_str(), pos
+							log_end;
+						ret = false;
+					}
+				}
+			}
+		}
+
+		//
+		//	wchar_t: ASCII 는 커널, 그 외 문자는 towlower 로 비교
+		//
+		for (size_t len = 0; len <= 70; ++len)
+		{
+			for (bool ascii_only : { true, false })
+			{
+				std::wstring str = random_wide(rng, len, ascii_only);
+
+				std::wstring lower(str);
+				fold_to_lower(lower);
+				for (size_t i = 0; i < len; ++i)
+				{
+					if (lower[i] != (wchar_t)towlower(str[i]))
+					{
+						log_err "wide fold mismatch. impl=%s, len=%zu, pos=%zu, char=0x%04x",
+							case_fold_impl_name(impl), len, i, (uint32_t)str[i]
+							log_end;
+						ret = false;
+						break;
+					}
+				}
+
+				std::wstring upper(str);
+				fold_to_upper(upper);
+				if (!equals_ci(str, upper) || !equals_ci(lower, upper))
+				{
+					log_err "wide equals_ci failed. impl=%s, len=%zu", case_fold_impl_name(impl), len log_end;
+					ret = false;
+				}
+
+				for (size_t nlen = 1; nlen <= 3 && nlen <= len; ++nlen)
+				{
+					const std::wstring needle = upper.substr(rng() % (len - nlen + 1), nlen);
+					for (size_t pos = 0; pos <= len; pos += 5)
+					{
+						if (find_ci(str, needle, pos) != ref_find_ci(str, needle, pos))
+						{
+							log_err "wide find_ci mismatch. impl=%s, len=%zu, pos=%zu",
+								case_fold_impl_name(impl), len, pos
+								log_end;
+							ret = false;
+						}
+					}
+				}
+			}
+		}
+
+		if (!starts_with_ci(L"\\Device\\HarddiskVolume11\\Windows", L"\\device\\harddiskvolume1") ||
+			!ends_with_ci(L"C:\\Users\\홍길동\\설치파일.EXE", L".exe") ||
+			!equals_ci(L"\x00c4pfel.txt", L"\x00e4PFEL.TXT") ||
+			equals_ci(std::string("\xc4pfel"), std::string("\xe4pfel")) ||
+			std::wstring::npos != find_ci(L"abc", L"abcd") ||
+			2 != find_ci(L"abc", L"", 2))
+		{
+			log_err "case_fold samples failed. impl=%s", case_fold_impl_name(impl) log_end;
+			ret = false;
+		}
+	}
+
+	case_fold_set_impl(CASE_FOLD_IMPL_AUTO);
+	return ret;
+}
+
+/// @brief	device 이름 prefix 비교 시간 (ns/비교)
+///			예전 방식 (소문자로 복사한 후 find) 과 starts_with_ci 비교
+bool test_case_fold_benchmark()
+{
+	static const wchar_t* const devices[] = {
+		L"\\Device\\HarddiskVolume1\\",
+		L"\\Device\\HarddiskVolume2\\",
+		L"\\Device\\HarddiskVolume3\\",
+		L"\\Device\\HarddiskVolume4\\",
+		L"\\Device\\HarddiskVolume11\\",
+		L"\\Device\\LanmanRedirector\\;Z:0000000000012345\\192.168.0.10\\share\\",
+	};
+	static const wchar_t* const files[] = {
+		L"\\Device\\HarddiskVolume3\\Windows\\System32\\svchost.exe",
+		L"\\DEVICE\\HARDDISKVOLUME11\\Users\\somma\\AppData\\Local\\Temp\\~DF3A7B21C4E9.TMP",
+		L"\\Device\\HarddiskVolume4\\Program Files (x86)\\Google\\Chrome\\Application\\chrome.exe",
+		L"\\Device\\Mup\\192.168.0.10\\share\\보고서\\2026년\\회의록_최종.docx",
+	};
+
+	std::vector<std::wstring> names;
+	for (size_t i = 0; i < 100000; ++i)
+	{
+		names.push_back(files[i % _countof(files)]);
+	}
+
+	const double count = (double)names.size() * _countof(devices);
+
+	//
+	//	예전 방식
+	//
+	{
+		size_t check = 0;
+
+		StopWatch sw;
+		sw.Start();
+		for (const auto& name : names)
+		{
+			std::wstring small_name(name);
+			for (auto& c : small_name) c = (wchar_t)towlower(c);
+
+			for (const wchar_t* device : devices)
+			{
+				std::wstring small_device(device);
+				for (auto& c : small_device) c = (wchar_t)towlower(c);
+				if (0 == small_name.find(small_device)) ++check;
+			}
+		}
+		sw.Stop();
+
+		log_info "lower+find : %7.1f ns/compare (check=%zu)", 
+			sw.GetDurationSecond() * 1e9 / count, check 
+			log_end;
+	}
+
+	for (int impl : _case_fold_impls)
+	{
+		if (!case_fold_set_impl(impl)) continue;
+
+		size_t check = 0;
+
+		StopWatch sw;
+		sw.Start();
+		for (const auto& name : names)
+		{
+			for (const wchar_t* device : devices)
+			{
+				if (starts_with_ci(name, device)) ++check;
+			}
+		}
+		sw.Stop();
+
+		log_info "%-10s : %7.1f ns/compare (check=%zu)",
+			case_fold_impl_name(impl), sw.GetDurationSecond() * 1e9 / count, check
+			log_end;
+	}
+
+	//
+	//	긴 문자열 소문자 변환 (MB/s)
+	//
+	std::mt19937 rng(1);
+	std::string text;
+	for (size_t i = 0; i < 64; ++i)
+	{
+		text += random_ascii(rng, 1024);
+	}
+	const int rounds = 1000;
+
+	for (int impl : _case_fold_impls)
+	{
+		if (!case_fold_set_impl(impl)) continue;
+
+		std::string buf(text);
+
+		StopWatch sw;
+		sw.Start();
+		for (int r = 0; r < rounds; ++r)
+		{
+			fold_to_lower(buf);
+			fold_to_upper(buf);
+		}
+		sw.Stop();
+
+		log_info "%-10s : %7.1f MB/s (fold_to_lower/upper)",
+			case_fold_impl_name(impl), 
+			(double)text.size() * rounds * 2 / sw.GetDurationSecond() / (1024 * 1024)
+			log_end;
+	}
+
+	case_fold_set_impl(CASE_FOLD_IMPL_AUTO);
+	return true;
+}
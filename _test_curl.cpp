@@ -10,6 +10,7 @@
 #include "_MyLib/src/curl_client.h"
 #include "_MyLib/src/curl_client_support.h"
 #include "_MyLib/src/StopWatch.h"
+#include "_MyLib/src/net_util.h"
 
 #include "json/json.h"
 
@@ -353,4 +354,268 @@ _mem_check_begin
 _mem_check_end;
 
 	return true;
-}
\ No newline at end of file
+}
+
+/// @brief	stand-in 서버가 보내는 데이터 패턴 (청크 번호로 재현 가능)
+static void http_standin_pattern(_In_ uint64_t chunk, _Out_ std::vector<uint8_t>& buffer)
+{
+	for (size_t i = 0; i < buffer.size(); ++i)
+	{
+		buffer[i] = (uint8_t)((i * 131) + (i >> 8) * 7) ^ (uint8_t)(chunk * 37 + 1);
+	}
+}
+
+/// @brief	테스트용 HTTP 서버 (stand-in)
+///			127.0.0.1 의 빈 포트에서 요청 하나를 받아서 content_length 바이트의 
+///			패턴 데이터를 응답한다. 
+typedef class http_standin_server
+{
+public:
+	http_standin_server() : _listen(INVALID_SOCKET), _port(0), _content_length(0) {}
+	~http_standin_server() { stop(); }
+
+	bool start(_In_ uint64_t content_length)
+	{
+		stop();
+		_content_length = content_length;
+
+		_listen = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+		if (INVALID_SOCKET == _listen)
+		{
+			log_err "socket() failed. wsa error=%d", WSAGetLastError() log_end;
+			return false;
+		}
+
+		sockaddr_in addr = { 0 };
+		addr.sin_family = AF_INET;
+		addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+		addr.sin_port = 0;
+		int addr_len = sizeof(addr);
+		if (SOCKET_ERROR == bind(_listen, (sockaddr*)&addr, sizeof(addr)) ||
+			SOCKET_ERROR == listen(_listen, 1) ||
+			SOCKET_ERROR == getsockname(_listen, (sockaddr*)&addr, &addr_len))
+		{
+			log_err "bind/listen() failed. wsa error=%d", WSAGetLastError() log_end;
+			stop();
+			return false;
+		}
+		_port = ntohs(addr.sin_port);
+
+		_thread = std::thread(&http_standin_server::serve, this);
+		return true;
+	}
+
+	void stop()
+	{
+		if (INVALID_SOCKET != _listen)
+		{
+			closesocket(_listen);
+			_listen = INVALID_SOCKET;
+		}
+		if (_thread.joinable()) _thread.join();
+	}
+
+	std::string url() const
+	{
+		std::stringstream strm;
+		strm << "http://127.0.0.1:" << _port << "/standin.bin";
+		return strm.str();
+	}
+
+private:
+	void serve()
+	{
+		SOCKET client = accept(_listen, nullptr, nullptr);
+		if (INVALID_SOCKET == client) return;
+
+		//
+		//	요청 헤더를 끝까지 읽는다. (내용은 보지 않음)
+		//
+		std::string request;
+		char buf[4096];
+		while (std::string::npos == request.find("\r\n\r\n"))
+		{
+			int ret = recv(client, buf, sizeof(buf), 0);
+			if (ret <= 0) break;
+			request.append(buf, ret);
+		}
+
+		std::stringstream header;
+		header << "HTTP/1.1 200 OK\r\n"
+			<< "Content-Type: application/octet-stream\r\n"
+			<< "Content-Length: " << _content_length << "\r\n"
+			<< "Connection: close\r\n\r\n";
+		std::string header_str = header.str();
+		send(client, header_str.c_str(), (int)header_str.size(), 0);
+
+		std::vector<uint8_t> chunk(1024 * 1024);
+		uint64_t sent = 0;
+		for (uint64_t index = 0; sent < _content_length; ++index)
+		{
+			http_standin_pattern(index, chunk);
+			int size = (int)min((uint64_t)chunk.size(), _content_length - sent);
+			for (int done = 0; done < size;)
+			{
+				int ret = send(client, (const char*)&chunk[done], size - done, 0);
+				if (ret <= 0)
+				{
+					closesocket(client);
+					return;
+				}
+				done += ret;
+			}
+			sent += size;
+		}
+
+		shutdown(client, SD_SEND);
+		closesocket(client);
+	}
+
+private:
+	SOCKET _listen;
+	uint16_t _port;
+	uint64_t _content_length;
+	std::thread _thread;
+} *phttp_standin_server;
+
+/// @brief	stand-in 서버에서 content_length 바이트를 다운로드하고, 
+///			http_download_ctx 가 다운로드 중에 계산한 해시가 파일을 
+///			다시 읽어서 계산한 해시와 같은지 확인한다.
+static bool 
+download_from_standin(
+	_In_ uint64_t content_length, 
+	_In_ uint32_t block_size,
+	_Out_ double& elapsed
+	)
+{
+	elapsed = 0.0;
+
+	http_standin_server server;
+	if (true != server.start(content_length)) return false;
+
+	std::wstring file_path;
+	if (true != get_temp_fileW(L"download_ctx", file_path)) return false;
+
+	bool ret = false;
+	do
+	{
+		handle_ptr file(open_file_to_write(file_path.c_str()),
+						[](HANDLE h)
+		{
+			if (INVALID_HANDLE_VALUE != h)
+			{
+				CloseHandle(h);
+			}
+		});
+		if (INVALID_HANDLE_VALUE == file.get())
+		{
+			log_err "open_file_to_write() failed. path=%ws", file_path.c_str() log_end;
+			break;
+		}
+
+		std::string md5;
+		std::string sha2;
+		{
+			curl_client cc;
+			if (true != cc.initialize()) break;
+
+			http_download_ctx ctx(server.url().c_str(), file.get(), block_size);
+
+			StopWatch sw; sw.Start();
+			HTTP_CODE http_response_code = 404;
+			if (true != cc.http_download_file(&ctx, http_response_code) ||
+				200 != http_response_code)
+			{
+				log_err "http_download_file() failed. code=%u", http_response_code log_end;
+				break;
+			}
+
+			//
+			//	http_download_file() 이 리턴하면 해시는 이미 계산되어 있다.
+			//
+			if (true != ctx.get_md5(md5) || true != ctx.get_sha2(sha2)) break;
+			sw.Stop();
+			elapsed = sw.GetDurationSecond();
+
+			if (ctx.bytes_received() != content_length)
+			{
+				log_err "size mismatch. received=%llu, expected=%llu",
+					ctx.bytes_received(),
+					content_length
+					log_end;
+				break;
+			}
+		}
+		file.reset();
+
+		std::string file_md5;
+		std::string file_sha2;
+		if (true != get_file_hash_by_filepath(file_path.c_str(), &file_md5, &file_sha2)) break;
+
+		if (0 != md5.compare(file_md5) || 0 != sha2.compare(file_sha2))
+		{
+			log_err "digest mismatch. size=%llu, block=%u, md5=%s (file=%s), sha2=%s (file=%s)",
+				content_length,
+				block_size,
+				md5.c_str(), file_md5.c_str(),
+				sha2.c_str(), file_sha2.c_str()
+				log_end;
+			break;
+		}
+		ret = true;
+	} while (false);
+
+	DeleteFileW(file_path.c_str());
+	return ret;
+}
+
+/// @brief	http_download_ctx 의 블록 버퍼링 + 인라인 해시 테스트
+bool test_curl_http_download_ctx()
+{
+	if (true != init_net_util()) return false;
+
+	const uint64_t sizes[] = { 1, 16 * 1024 - 1, 1024 * 1024, 1024 * 1024 + 1, 64 * 1024 * 1024 + 7 };
+	const uint32_t block_sizes[] = { 16 * 1024, HTTP_DOWNLOAD_DEFAULT_BLOCK_SIZE };
+
+	bool ret = true;
+	for (uint64_t size : sizes)
+	{
+		for (uint32_t block_size : block_sizes)
+		{
+			double elapsed = 0.0;
+			if (true != download_from_standin(size, block_size, elapsed))
+			{
+				log_err "download_from_standin() failed. size=%llu, block=%u", size, block_size log_end;
+				ret = false;
+			}
+		}
+	}
+
+	cleanup_net_util();
+	return ret;
+}
+
+/// @brief	multi-GB 다운로드 처리량 (해시 포함)
+bool test_curl_http_download_ctx_benchmark()
+{
+	if (true != init_net_util()) return false;
+
+	bool ret = true;
+	for (uint64_t size : { 1ull * 1024 * 1024 * 1024, 4ull * 1024 * 1024 * 1024 })
+	{
+		double elapsed = 0.0;
+		if (true != download_from_standin(size, HTTP_DOWNLOAD_DEFAULT_BLOCK_SIZE, elapsed))
+		{
+			ret = false;
+			break;
+		}
+		log_info "download %llu MB with md5/sha2: %.2f sec, %.2f MB/s",
+			size / (1024 * 1024),
+			elapsed,
+			(size / (1024.0 * 1024.0)) / elapsed
+			log_end;
+	}
+
+	cleanup_net_util();
+	return ret;
+}
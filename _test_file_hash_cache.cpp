@@ -0,0 +1,190 @@
+﻿/**
+ * @file    _test_file_hash_cache.cpp
+ * @brief   persistent file hash cache (file_hash_cache.h) tests.
+ *
+ * @author  Yonhgwhan, Roh (somma@somma.kr)
+ * @date    2026/10/18 created.
+ * @copyright (C)Somma, Inc. All rights reserved.
+**/
+#include "stdafx.h"
+#include "_MyLib/src/file_hash_cache.h"
+#include "_MyLib/src/StopWatch.h"
+
+/// @brief	파일 내용을 덮어쓴다. (CREATE_ALWAYS 로 열기 때문에 파일 id 는 유지된다)
+static bool overwrite_file(_In_ const wchar_t* file_path, _In_ const char* content)
+{
+	HANDLE file_handle = CreateFileW(file_path,
+									 GENERIC_WRITE,
+									 FILE_SHARE_READ,
+									 nullptr,
+									 CREATE_ALWAYS,
+									 FILE_ATTRIBUTE_NORMAL,
+									 nullptr);
+	if (INVALID_HANDLE_VALUE == file_handle)
+	{
+		log_err "CreateFileW() failed. path=%ws, gle=%u", file_path, GetLastError() log_end;
+		return false;
+	}
+
+	DWORD bytes_written = 0;
+	BOOL ret = WriteFile(file_handle, content, (DWORD)strlen(content), &bytes_written, nullptr);
+	CloseHandle(file_handle);
+	return TRUE == ret;
+}
+
+/// @brief	캐시 hit 결과가 실제 해시와 같은지, 파일이 바뀌면 무효화되는지 확인한다.
+bool test_file_hash_cache()
+{
+	std::wstring cache_path;
+	std::wstring file_path;
+	if (true != get_temp_fileW(L"file_hash_cache", cache_path) ||
+		true != get_temp_fileW(L"file_hash_cache_target", file_path))
+	{
+		log_err "get_temp_fileW() failed." log_end;
+		return false;
+	}
+
+	bool ret = false;
+	do
+	{
+		if (true != overwrite_file(file_path.c_str(), "file hash cache test, version 1")) break;
+
+		file_hash_cache cache;
+
+		//
+		//	2 의 거듭제곱으로 올리면 넘치는 capacity 는 거부해야 한다.
+		//
+		if (true == cache.open(cache_path.c_str(), 0x80000001) ||
+			true == cache.open(cache_path.c_str(), FILE_HASH_CACHE_MAX_CAPACITY + 1))
+		{
+			log_err "cache.open() accepted an invalid capacity." log_end;
+			break;
+		}
+
+		if (true != cache.open(cache_path.c_str()))
+		{
+			log_err "cache.open() failed." log_end;
+			break;
+		}
+
+		//
+		//	miss -> insert -> hit
+		//
+		std::string md5, sha2, cached_md5, cached_sha2;
+		if (true != get_file_hash_by_filepath(file_path.c_str(), &md5, &sha2, &cache)) break;
+		cache.flush();
+		if (true != get_file_hash_by_filepath(file_path.c_str(), &cached_md5, &cached_sha2, &cache)) break;
+
+		file_hash_cache_stats st = cache.stats();
+		if (1 != st.hits || 1 != st.misses || md5 != cached_md5 || sha2 != cached_sha2)
+		{
+			log_err "unexpected hit/miss. hits=%llu, misses=%llu",
+				st.hits,
+				st.misses
+				log_end;
+			break;
+		}
+
+		//
+		//	캐시를 사용하지 않는 결과와 같아야 한다.
+		//
+		std::string md5_nocache;
+		if (true != get_file_hash_by_filepath(file_path.c_str(), &md5_nocache, nullptr) ||
+			md5_nocache != cached_md5)
+		{
+			log_err "cached md5 mismatch." log_end;
+			break;
+		}
+
+		//
+		//	파일을 변경하면 무효화되어야 한다.
+		//
+		Sleep(20);
+		if (true != overwrite_file(file_path.c_str(), "file hash cache test, version 2")) break;
+		if (true != get_file_hash_by_filepath(file_path.c_str(), &md5, nullptr, &cache)) break;
+
+		st = cache.stats();
+		if (1 != st.invalidations || md5 == cached_md5)
+		{
+			log_err "not invalidated. invalidations=%llu", st.invalidations log_end;
+			break;
+		}
+
+		//
+		//	다시 열어도 (flush 된) 항목이 남아있어야 한다.
+		//
+		cache.close();
+		if (true != cache.open(cache_path.c_str())) break;
+		if (true != get_file_hash_by_filepath(file_path.c_str(), &cached_md5, nullptr, &cache)) break;
+		if (1 != cache.stats().hits || md5 != cached_md5)
+		{
+			log_err "persisted entry not found." log_end;
+			break;
+		}
+
+		ret = true;
+	} while (false);
+
+	DeleteFileW(file_path.c_str());
+	DeleteFileW(cache_path.c_str());
+	return ret;
+}
+
+/// @brief	system32 의 파일들을 캐시를 사용해서 두번 훑어서 시간을 비교한다.
+bool test_file_hash_cache_sweep()
+{
+	std::wstring cache_path;
+	if (true != get_temp_fileW(L"file_hash_cache_sweep", cache_path)) return false;
+
+	std::vector<std::wstring> files;
+	if (true != find_files(L"c:\\windows\\system32",
+						   (DWORD_PTR)&files,
+						   false,
+						   [](_In_ DWORD_PTR tag, _In_ const wchar_t* path)->bool
+	{
+		std::vector<std::wstring>* files = (std::vector<std::wstring>*)(tag);
+		files->push_back(path);
+		return true;
+	}))
+	{
+		log_err "find_files() failed." log_end;
+		return false;
+	}
+
+	file_hash_cache cache;
+	if (true != cache.open(cache_path.c_str(), 256 * 1024, 256))
+	{
+		log_err "cache.open() failed." log_end;
+		return false;
+	}
+
+	for (int sweep = 0; sweep < 2; ++sweep)
+	{
+		cache.reset_stats();
+
+		StopWatch sw;
+		sw.Start();
+		for (const auto& file : files)
+		{
+			std::string md5, sha2;
+			get_file_hash_by_filepath(file.c_str(), &md5, &sha2, &cache);
+		}
+		cache.flush();
+		sw.Stop();
+
+		file_hash_cache_stats st = cache.stats();
+		log_info "sweep %d, files=%zu, %.3f sec, hits=%llu, misses=%llu, invalidations=%llu, entries=%llu",
+			sweep,
+			files.size(),
+			sw.GetDurationSecond(),
+			st.hits,
+			st.misses,
+			st.invalidations,
+			st.entries
+			log_end;
+	}
+
+	cache.close();
+	DeleteFileW(cache_path.c_str());
+	return true;
+}
@@ -0,0 +1,301 @@
+﻿/**
+ * @file    _test_file_hash_engine.cpp
+ * @brief   pipelined file hashing engine (file_hash_engine.h) tests.
+ *
+ * @author  Yonhgwhan, Roh (somma@somma.kr)
+ * @date    2026/10/18 created.
+ * @copyright (C)Somma, Inc. All rights reserved.
+**/
+#include "stdafx.h"
+#include "_MyLib/src/file_hash_engine.h"
+#include "_MyLib/src/md5.h"
+#include "_MyLib/src/sha2.h"
+#include "_MyLib/src/crc64.h"
+#include "_MyLib/src/StopWatch.h"
+#include <random>
+
+/// @brief	size 바이트의 랜덤 데이터로 임시 파일을 만든다.
+static bool create_random_file(_In_ uint64_t size, _Out_ std::wstring& file_path, _Out_ std::vector<uint8_t>& data)
+{
+	if (true != get_temp_fileW(L"file_hash_engine", file_path))
+	{
+		log_err "get_temp_fileW() failed." log_end;
+		return false;
+	}
+
+	data.resize((size_t)size);
+	std::mt19937 rng((uint32_t)size);
+	for (auto& b : data) { b = (uint8_t)rng(); }
+
+	HANDLE file_handle = CreateFileW(file_path.c_str(),
+									 GENERIC_WRITE,
+									 FILE_SHARE_READ,
+									 nullptr,
+									 CREATE_ALWAYS,
+									 FILE_ATTRIBUTE_NORMAL,
+									 nullptr);
+	if (INVALID_HANDLE_VALUE == file_handle)
+	{
+		log_err "CreateFileW() failed. path=%ws, gle=%u", file_path.c_str(), GetLastError() log_end;
+		return false;
+	}
+
+	bool ret = true;
+	for (size_t pos = 0; pos < data.size();)
+	{
+		DWORD bytes_written = 0;
+		DWORD size_to_write = (DWORD)min((size_t)(16 * 1024 * 1024), data.size() - pos);
+		if (!WriteFile(file_handle, &data[pos], size_to_write, &bytes_written, nullptr))
+		{
+			log_err "WriteFile() failed. path=%ws, gle=%u", file_path.c_str(), GetLastError() log_end;
+			ret = false;
+			break;
+		}
+		pos += bytes_written;
+	}
+	CloseHandle(file_handle);
+	return ret;
+}
+
+/// @brief	모든 digest 조합과 윈도우 크기에 대해 메모리에서 계산한 값과 같은지 확인한다.
+bool test_file_hash_engine()
+{
+	const uint64_t sizes[] = { 0, 1, 4095, 1024 * 1024, 1024 * 1024 + 1, 9 * 1024 * 1024 + 77 };
+	const uint32_t window_sizes[] = { 64 * 1024, 1024 * 1024 };
+
+	bool ret = true;
+	for (uint64_t size : sizes)
+	{
+		std::wstring file_path;
+		std::vector<uint8_t> data;
+		if (true != create_random_file(size, file_path, data)) return false;
+
+		MD5_CTX md5;
+		MD5Init(&md5, 0);
+		MD5Update(&md5, data.data(), (unsigned int)data.size());
+		MD5Final(&md5);
+
+		uint8_t sha2[32];
+		sha256(sha2, data.data(), (unsigned long)data.size());
+
+		uint64_t crc = crc64(0, data.data(), data.size());
+
+		for (uint32_t window_size : window_sizes)
+		{
+			file_hash_engine engine(window_size, 3);
+			for (uint32_t digests = 1; digests <= FILE_HASH_ALL; ++digests)
+			{
+				file_digests result;
+				if (true != engine.hash_file(file_path.c_str(), digests, result))
+				{
+					log_err "hash_file() failed. size=%llu", size log_end;
+					ret = false;
+					continue;
+				}
+
+				if (result.digests != digests ||
+					result.file_size != size ||
+					((digests & FILE_HASH_MD5) && 0 != memcmp(result.md5, md5.digest, sizeof(result.md5))) ||
+					((digests & FILE_HASH_SHA256) && 0 != memcmp(result.sha256, sha2, sizeof(result.sha256))) ||
+					((digests & FILE_HASH_CRC64) && result.crc64 != crc))
+				{
+					log_err "digest mismatch. size=%llu, window=%u, digests=0x%x",
+						size,
+						window_size,
+						digests
+						log_end;
+					ret = false;
+				}
+			}
+		}
+
+		DeleteFileW(file_path.c_str());
+	}
+	return ret;
+}
+
+/// @brief	256 MB 파일에서 digest 별 단독 처리 시간과 동시 처리 시간을 비교한다.
+///			파이프라인이 동작하면 전체 시간이 합이 아니라 가장 느린 digest 에 가깝다.
+bool test_file_hash_engine_benchmark()
+{
+	std::wstring file_path;
+	std::vector<uint8_t> data;
+	if (true != create_random_file(256 * 1024 * 1024, file_path, data)) return false;
+	data.clear();
+	data.shrink_to_fit();
+
+	const uint32_t digest_sets[] = {
+		FILE_HASH_MD5,
+		FILE_HASH_SHA256,
+		FILE_HASH_CRC64,
+		FILE_HASH_MD5 | FILE_HASH_SHA256,
+		FILE_HASH_ALL
+	};
+
+	file_hash_engine engine;
+	for (uint32_t digests : digest_sets)
+	{
+		file_digests result;
+		StopWatch sw;
+		sw.Start();
+		bool ok = engine.hash_file(file_path.c_str(), digests, result);
+		sw.Stop();
+
+		log_info "digests=%s%s%s, %s, %.3f sec, %.2f MB/s",
+			(digests & FILE_HASH_MD5) ? "md5 " : "",
+			(digests & FILE_HASH_SHA256) ? "sha256 " : "",
+			(digests & FILE_HASH_CRC64) ? "crc64 " : "",
+			ok ? "ok" : "failed",
+			sw.GetDurationSecond(),
+			256.0 / sw.GetDurationSecond()
+			log_end;
+	}
+
+	DeleteFileW(file_path.c_str());
+	return true;
+}
+
+/// @brief	get_file_hash_by_filehandle() (스레드마다 엔진 재사용) 이 메모리에서
+///			계산한 값과 같은지 확인한다. 작은 파일과 큰 파일을 번갈아 해싱해서
+///			재사용되는 버퍼가 크기에 맞게 바뀌는지도 확인하고, 작은 파일을 
+///			반복해서 해싱하는 시간을 출력한다.
+bool test_get_file_hash_by_filehandle()
+{
+	const uint64_t sizes[] = { 0, 100, 70 * 1024, 3 * 1024 * 1024 + 5, 10, 1024 * 1024 + 1, 4095 };
+
+	bool ret = true;
+	for (uint64_t size : sizes)
+	{
+		std::wstring file_path;
+		std::vector<uint8_t> data;
+		if (true != create_random_file(size, file_path, data)) return false;
+
+		MD5_CTX md5;
+		MD5Init(&md5, 0);
+		MD5Update(&md5, data.data(), (unsigned int)data.size());
+		MD5Final(&md5);
+
+		uint8_t sha2[32];
+		sha256(sha2, data.data(), (unsigned long)data.size());
+
+		std::string expected_md5;
+		std::string expected_sha2;
+		bin_to_hexa_fast(sizeof(md5.digest), md5.digest, false, expected_md5);
+		bin_to_hexa_fast(sizeof(sha2), sha2, false, expected_sha2);
+
+		//
+		//	FILE_FLAG_OVERLAPPED (ReadFile 이 ERROR_IO_PENDING 리턴), 
+		//	FILE_FLAG_NO_BUFFERING (정렬되지 않은 ReadFile 거부) 핸들도 
+		//	같은 결과를 내야 한다.
+		//
+		const DWORD flags_list[] = { 
+			FILE_ATTRIBUTE_NORMAL, 
+			FILE_FLAG_OVERLAPPED, 
+			FILE_FLAG_NO_BUFFERING 
+		};
+		for (DWORD flags : flags_list)
+		{
+			HANDLE file_handle = CreateFileW(file_path.c_str(),
+											 GENERIC_READ,
+											 FILE_SHARE_READ,
+											 nullptr,
+											 OPEN_EXISTING,
+											 flags,
+											 nullptr);
+			if (INVALID_HANDLE_VALUE == file_handle)
+			{
+				log_err "CreateFileW() failed. path=%ws, gle=%u", file_path.c_str(), GetLastError() log_end;
+				DeleteFileW(file_path.c_str());
+				return false;
+			}
+
+			std::string md5_str;
+			std::string sha2_str;
+			if (true != get_file_hash_by_filehandle(file_handle, &md5_str, &sha2_str) ||
+				md5_str != expected_md5 ||
+				sha2_str != expected_sha2)
+			{
+				log_err "get_file_hash_by_filehandle() mismatch. size=%llu, flags=0x%08x", 
+					size, 
+					flags 
+					log_end;
+				ret = false;
+			}
+
+			//
+			//	작은 파일 반복 (엔진/버퍼 재사용)
+			//
+			if (100 == size && FILE_ATTRIBUTE_NORMAL == flags)
+			{
+				StopWatch sw;
+				sw.Start();
+				for (int i = 0; i < 1000; ++i)
+				{
+					if (true != get_file_hash_by_filehandle(file_handle, &md5_str, nullptr) ||
+						md5_str != expected_md5)
+					{
+						log_err "get_file_hash_by_filehandle() mismatch. size=%llu", size log_end;
+						ret = false;
+						break;
+					}
+				}
+				sw.Stop();
+				log_info "100 byte file, %.2f us/call", sw.GetDurationMilliSecond() log_end;
+			}
+
+			CloseHandle(file_handle);
+		}
+		DeleteFileW(file_path.c_str());
+	}
+	return ret;
+}
+
+/// @brief	엔진 풀은 쉬고 있는 엔진을 FILE_HASH_ENGINE_POOL_SIZE 개까지만 보관하고 
+///			재사용한다.
+bool test_file_hash_engine_pool()
+{
+	file_hash_engine_trim();
+
+	std::vector<file_hash_engine*> engines;
+	for (int i = 0; i < FILE_HASH_ENGINE_POOL_SIZE + 2; ++i)
+	{
+		engines.push_back(file_hash_engine_acquire());
+	}
+	for (size_t i = 0; i < engines.size(); ++i)
+	{
+		for (size_t j = i + 1; j < engines.size(); ++j)
+		{
+			if (engines[i] == engines[j])
+			{
+				log_err "same engine acquired twice." log_end;
+				return false;
+			}
+		}
+	}
+
+	//
+	//	FILE_HASH_ENGINE_POOL_SIZE 개만 보관되고 (마지막에 반환한 것부터) 재사용된다.
+	//
+	for (auto engine : engines)
+	{
+		file_hash_engine_release(engine);
+	}
+	for (int i = 0; i < FILE_HASH_ENGINE_POOL_SIZE; ++i)
+	{
+		file_hash_engine* engine = file_hash_engine_acquire();
+		if (engine != engines[FILE_HASH_ENGINE_POOL_SIZE - 1 - i])
+		{
+			log_err "pooled engine is not reused. index=%d", i log_end;
+			return false;
+		}
+		engines[FILE_HASH_ENGINE_POOL_SIZE - 1 - i] = engine;
+	}
+	for (int i = 0; i < FILE_HASH_ENGINE_POOL_SIZE; ++i)
+	{
+		file_hash_engine_release(engines[i]);
+	}
+
+	file_hash_engine_trim();
+	file_hash_engine_release(nullptr);
+	return true;
+}
@@ -0,0 +1,246 @@
+﻿/**
+ * @file    _test_hash_batch.cpp
+ * @brief   multi-buffer md5/sha256 (hash_batch.h) equivalence and throughput tests.
+ *
+ * @author  Yonhgwhan, Roh (somma@somma.kr)
+ * @date    2026/10/18 created.
+ * @copyright (C)Somma, Inc. All rights reserved.
+**/
+#include "stdafx.h"
+#include "_MyLib/src/hash_batch.h"
+#include "_MyLib/src/md5.h"
+#include "_MyLib/src/sha2.h"
+#include "_MyLib/src/StopWatch.h"
+#include <random>
+
+static const uint32_t _batch_lanes[] = { 1, 4, 8, 16 };
+
+/// @brief	모든 lane 구성이 단일 버퍼 md5/sha256 과 같은 digest 를 만드는지 확인한다.
+bool test_hash_batch_equivalence()
+{
+	//
+	//	0 ~ 1000 bytes 사이의 다양한 크기의 버퍼 (패딩 경계인 55, 56, 63, 64 포함)
+	//
+	std::mt19937 rng(0xba7c);
+	std::vector<std::vector<uint8_t>> buffers;
+	for (size_t size = 0; size < 200; ++size)
+	{
+		buffers.push_back(std::vector<uint8_t>(size));
+	}
+	for (int i = 0; i < 100; ++i)
+	{
+		buffers.push_back(std::vector<uint8_t>(rng() % 10000));
+	}
+	for (auto& buffer : buffers)
+	{
+		for (auto& b : buffer) { b = (uint8_t)rng(); }
+	}
+
+	std::vector<const uint8_t*> data;
+	std::vector<size_t> sizes;
+	for (const auto& buffer : buffers)
+	{
+		data.push_back(buffer.data());
+		sizes.push_back(buffer.size());
+	}
+
+	//
+	//	기준 digest
+	//
+	typedef uint8_t md5_digest[MD5_BATCH_DIGEST_SIZE];
+	typedef uint8_t sha2_digest[SHA256_BATCH_DIGEST_SIZE];
+	std::vector<uint8_t> md5_expected_buf(buffers.size() * MD5_BATCH_DIGEST_SIZE);
+	std::vector<uint8_t> sha2_expected_buf(buffers.size() * SHA256_BATCH_DIGEST_SIZE);
+	md5_digest* md5_expected = (md5_digest*)md5_expected_buf.data();
+	sha2_digest* sha2_expected = (sha2_digest*)sha2_expected_buf.data();
+	for (size_t i = 0; i < buffers.size(); ++i)
+	{
+		MD5_CTX ctx;
+		MD5Init(&ctx, 0);
+		MD5Update(&ctx, (unsigned char*)buffers[i].data(), (unsigned int)buffers[i].size());
+		MD5Final(&ctx);
+		memcpy(md5_expected[i], ctx.digest, MD5_BATCH_DIGEST_SIZE);
+
+		sha256(sha2_expected[i], buffers[i].data(), (unsigned long)buffers[i].size());
+	}
+
+	bool ret = true;
+	for (uint32_t lanes : _batch_lanes)
+	{
+		if (!hash_batch_set_lanes(lanes))
+		{
+			log_info "%u lanes is not supported on this cpu.", lanes log_end;
+			continue;
+		}
+
+		std::vector<uint8_t> md5_actual_buf(buffers.size() * MD5_BATCH_DIGEST_SIZE);
+		std::vector<uint8_t> sha2_actual_buf(buffers.size() * SHA256_BATCH_DIGEST_SIZE);
+		md5_digest* md5_actual = (md5_digest*)md5_actual_buf.data();
+		sha2_digest* sha2_actual = (sha2_digest*)sha2_actual_buf.data();
+		md5_batch(buffers.size(), data.data(), sizes.data(), md5_actual);
+		sha256_batch(buffers.size(), data.data(), sizes.data(), sha2_actual);
+
+		for (size_t i = 0; i < buffers.size(); ++i)
+		{
+			if (0 != memcmp(md5_expected[i], md5_actual[i], MD5_BATCH_DIGEST_SIZE))
+			{
+				log_err "md5 digest mismatch. lanes=%u, size=%zu", lanes, sizes[i] log_end;
+				ret = false;
+			}
+			if (0 != memcmp(sha2_expected[i], sha2_actual[i], SHA256_BATCH_DIGEST_SIZE))
+			{
+				log_err "sha256 digest mismatch. lanes=%u, size=%zu", lanes, sizes[i] log_end;
+				ret = false;
+			}
+		}
+	}
+
+	hash_batch_set_lanes(0);
+	return ret;
+}
+
+/// @brief	작은 버퍼 여러개를 lane 구성별로 해싱하는 처리량을 측정한다.
+bool test_hash_batch_benchmark()
+{
+	const size_t buffer_sizes[] = { 64, 512, 4096 };
+	const size_t total = 256 * 1024 * 1024;
+
+	for (size_t buffer_size : buffer_sizes)
+	{
+		const size_t count = 4096;
+		std::vector<uint8_t> pool(buffer_size * count);
+		std::mt19937 rng(0);
+		for (auto& b : pool) { b = (uint8_t)rng(); }
+
+		std::vector<const uint8_t*> data(count);
+		std::vector<size_t> sizes(count, buffer_size);
+		for (size_t i = 0; i < count; ++i)
+		{
+			data[i] = &pool[i * buffer_size];
+		}
+
+		std::vector<uint8_t> md5_digests(count * MD5_BATCH_DIGEST_SIZE);
+		std::vector<uint8_t> sha2_digests(count * SHA256_BATCH_DIGEST_SIZE);
+		size_t iterations = max((size_t)1, total / pool.size());
+
+		for (uint32_t lanes : _batch_lanes)
+		{
+			if (!hash_batch_set_lanes(lanes)) continue;
+
+			StopWatch sw;
+			sw.Start();
+			for (size_t i = 0; i < iterations; ++i)
+			{
+				md5_batch(count, data.data(), sizes.data(), (uint8_t(*)[MD5_BATCH_DIGEST_SIZE])md5_digests.data());
+			}
+			sw.Stop();
+			double md5_mbps = (double)(pool.size() * iterations) / (1024.0 * 1024.0) / sw.GetDurationSecond();
+
+			sw.Start();
+			for (size_t i = 0; i < iterations; ++i)
+			{
+				sha256_batch(count, data.data(), sizes.data(), (uint8_t(*)[SHA256_BATCH_DIGEST_SIZE])sha2_digests.data());
+			}
+			sw.Stop();
+			double sha2_mbps = (double)(pool.size() * iterations) / (1024.0 * 1024.0) / sw.GetDurationSecond();
+
+			log_info "buffer=%5zu, lanes=%2u, md5 %10.2f MB/s, sha256 %10.2f MB/s",
+				buffer_size,
+				lanes,
+				md5_mbps,
+				sha2_mbps
+				log_end;
+		}
+	}
+
+	hash_batch_set_lanes(0);
+	return true;
+}
+
+/// @brief	get_file_hash_batch() 의 결과가 파일 하나씩 get_file_hash_by_filepath() 로
+///			구한 것과 같은지 확인한다. 
+///			(빈 파일, 패딩 경계, 배치 한도 (8MB) 를 넘는 파일, 없는 파일 포함)
+bool test_get_file_hash_batch()
+{
+	const size_t sizes[] = { 0, 1, 55, 56, 64, 4095, 64 * 1024 + 3, 8 * 1024 * 1024 + 1 };
+
+	std::mt19937 rng(0xf11e);
+	std::vector<std::wstring> file_paths;
+	bool ret = true;
+	for (size_t size : sizes)
+	{
+		std::wstring file_path;
+		if (true != get_temp_fileW(L"hash_batch", file_path))
+		{
+			log_err "get_temp_fileW() failed." log_end;
+			ret = false;
+			break;
+		}
+
+		std::vector<uint8_t> data(size);
+		for (auto& b : data) { b = (uint8_t)rng(); }
+
+		HANDLE file_handle = CreateFileW(file_path.c_str(),
+										 GENERIC_WRITE,
+										 FILE_SHARE_READ,
+										 nullptr,
+										 CREATE_ALWAYS,
+										 FILE_ATTRIBUTE_NORMAL,
+										 nullptr);
+		if (INVALID_HANDLE_VALUE == file_handle)
+		{
+			log_err "CreateFileW() failed. path=%ws, gle=%u", file_path.c_str(), GetLastError() log_end;
+			ret = false;
+			break;
+		}
+
+		DWORD bytes_written = 0;
+		if (!data.empty() && 
+			(!WriteFile(file_handle, data.data(), (DWORD)data.size(), &bytes_written, nullptr) ||
+			 bytes_written != data.size()))
+		{
+			log_err "WriteFile() failed. path=%ws, gle=%u", file_path.c_str(), GetLastError() log_end;
+			ret = false;
+		}
+		CloseHandle(file_handle);
+		file_paths.push_back(file_path);
+	}
+
+	//
+	//	없는 파일은 해당 항목만 실패해야 한다.
+	//
+	file_paths.push_back(L"c:\\__not_exist_dir__\\__not_exist_file__");
+
+	std::vector<file_hash_result> results;
+	if (ret && true != get_file_hash_batch(file_paths, true, true, results))
+	{
+		log_err "get_file_hash_batch() failed." log_end;
+		ret = false;
+	}
+
+	for (size_t i = 0; ret && i < file_paths.size(); ++i)
+	{
+		std::string md5;
+		std::string sha2;
+		const bool expected = get_file_hash_by_filepath(file_paths[i].c_str(), &md5, &sha2);
+		if (results[i].succeeded != expected ||
+			(expected && (results[i].md5 != md5 || results[i].sha2 != sha2)))
+		{
+			log_err "get_file_hash_batch() mismatch. path=%ws, succeeded=%d, md5=%s/%s, sha2=%s/%s",
+				file_paths[i].c_str(),
+				results[i].succeeded,
+				results[i].md5.c_str(),
+				md5.c_str(),
+				results[i].sha2.c_str(),
+				sha2.c_str()
+				log_end;
+			ret = false;
+		}
+	}
+
+	for (const auto& file_path : file_paths)
+	{
+		DeleteFileW(file_path.c_str());
+	}
+	return ret;
+}
@@ -0,0 +1,353 @@
+﻿/**
+ * @file    _test_hex_codec.cpp
+ * @brief   hex encode/decode (scalar/SSSE3/AVX2) equivalence, validation, hexdump format and throughput tests.
+ *
+ * @author  Yonhgwhan, Roh (somma@somma.kr)
+ * @date    2026/10/18 created.
+ * @copyright (C)Somma, Inc. All rights reserved.
+**/
+#include "stdafx.h"
+#include "_MyLib/src/hex_codec.h"
+#include "_MyLib/src/CStream.h"
+#include "_MyLib/src/StopWatch.h"
+#include <random>
+
+static const int _hex_impls[] = { HEX_IMPL_SCALAR, HEX_IMPL_SSSE3, HEX_IMPL_AVX2 };
+
+/// @brief	예전 bin_to_hexa() 와 같이 바이트마다 printf 로 인코딩한다. 
+///			결과 비교와 벤치마크용
+static std::string legacy_hex_encode(const uint8_t* in, size_t in_len, bool upper_case)
+{
+	std::string ret;
+	char buf[4];
+	for (size_t i = 0; i < in_len; ++i)
+	{
+		snprintf(buf, sizeof(buf), (upper_case) ? "%02X" : "%02x", in[i]);
+		ret += buf;
+	}
+	return ret;
+}
+
+/// @brief	예전 dump_memory() 와 같은 형식의 라인 (x64 의 "0x%08p" 는 16 자리)
+static std::list<std::string> legacy_hexdump(uint64_t base_offset, const uint8_t* buf, size_t size)
+{
+	std::list<std::string> rs;
+	rs.push_back("                      00 01 02 03 04 05 06 07   08 09 0A 0B 0C 0D 0E 0F");
+	rs.push_back("                      -- -- -- -- -- -- -- --   -- -- -- -- -- -- -- --");
+
+	char cell[8];
+	for (size_t pos = 0; pos < size; pos += 16)
+	{
+		std::string line;
+		snprintf(cell, sizeof(cell), "0x");
+		line = cell;
+		char offset[32];
+		snprintf(offset, sizeof(offset), "%016llX    ", (unsigned long long)(base_offset + pos));
+		line += offset;
+
+		std::string ascii;
+		for (size_t i = 0; i < 16; ++i)
+		{
+			if (8 == i) line += "  ";
+			if (pos + i < size)
+			{
+				const uint8_t b = buf[pos + i];
+				snprintf(cell, sizeof(cell), "%02X ", b);
+				line += cell;
+				ascii += (0x20 <= b && 0x7f > b) ? (char)b : '.';
+			}
+			else
+			{
+				line += "   ";
+			}
+		}
+		rs.push_back(line + "   " + ascii);
+	}
+	return rs;
+}
+
+/// @brief	구현별 인코딩/디코딩 결과가 printf 결과와 같은지, 잘못된 입력을 
+///			거부하는지, hexdump 가 예전 dump_memory() 형식과 같은지 확인한다.
+bool test_hex_codec()
+{
+	std::mt19937 rng(0x1e55);
+	std::vector<uint8_t> data(16 * 1024 + 5);
+	for (auto& b : data) { b = (uint8_t)rng(); }
+
+	std::vector<size_t> sizes;
+	for (size_t i = 0; i <= 130; ++i) sizes.push_back(i);
+	sizes.push_back(1000);
+	sizes.push_back(4096);
+	sizes.push_back(data.size());
+
+	bool ret = true;
+	for (int impl : _hex_impls)
+	{
+		if (!hex_impl_supported(impl)) continue;
+		hex_set_impl(impl);
+
+		for (size_t size : sizes)
+		{
+			for (int upper = 0; upper < 2; ++upper)
+			{
+				const std::string expected = legacy_hex_encode(data.data(), size, 0 != upper);
+				const std::wstring expected_w(expected.begin(), expected.end());
+
+				//
+				//	인코딩: 호출자 버퍼, std::string (append), std::wstring, CMemoryStream
+				//
+				std::vector<char> encoded(hex_encoded_length(size) + 1, '#');
+				size_t encoded_len = 0;
+				if (!hex_encode(data.data(), size, 0 != upper, encoded.data(), encoded.size() - 1, encoded_len) ||
+					encoded_len != expected.size() ||
+					0 != memcmp(encoded.data(), expected.c_str(), encoded_len) ||
+					'#' != encoded[encoded_len])
+				{
+					log_err "hex_encode() mismatch. impl=%s, size=%zu", hex_impl_name(impl), size log_end;
+					ret = false;
+					continue;
+				}
+				if (0 < size && 
+					hex_encode(data.data(), size, 0 != upper, encoded.data(), encoded.size() - 2, encoded_len))
+				{
+					log_err "hex_encode() accepted small buffer. impl=%s, size=%zu", hex_impl_name(impl), size log_end;
+					ret = false;
+				}
+
+				std::string str = "prefix:";
+				if (!hex_encode(data.data(), size, 0 != upper, str) || str != "prefix:" + expected)
+				{
+					log_err "hex_encode() (string) mismatch. impl=%s, size=%zu", hex_impl_name(impl), size log_end;
+					ret = false;
+				}
+
+				std::wstring wstr;
+				if (!hex_encode(data.data(), size, 0 != upper, wstr) || wstr != expected_w)
+				{
+					log_err "hex_encode() (wstring) mismatch. impl=%s, size=%zu", hex_impl_name(impl), size log_end;
+					ret = false;
+				}
+
+				CMemoryStream stream;
+				if (!hex_encode(data.data(), size, 0 != upper, stream) ||
+					stream.GetSize() != expected.size() ||
+					(0 < size && 0 != memcmp(stream.GetMemory(), expected.c_str(), expected.size())))
+				{
+					log_err "hex_encode() (stream) mismatch. impl=%s, size=%zu", hex_impl_name(impl), size log_end;
+					ret = false;
+				}
+
+				//
+				//	디코딩: 대/소문자가 섞인 입력 (char, wchar_t), 여유 없는 크기
+				//
+				std::string mixed = expected;
+				for (auto& ch : mixed)
+				{
+					if (0 != (rng() & 1)) ch = (char)toupper((unsigned char)ch);
+				}
+				const std::wstring mixed_w(mixed.begin(), mixed.end());
+
+				std::vector<uint8_t> decoded(size + 1, 0xcc);
+				size_t decoded_len = 0;
+				if (!hex_decode(mixed.c_str(), mixed.size(), decoded.data(), size, decoded_len) ||
+					decoded_len != size ||
+					(0 < size && 0 != memcmp(decoded.data(), data.data(), size)) ||
+					0xcc != decoded[size])
+				{
+					log_err "hex_decode() mismatch. impl=%s, size=%zu", hex_impl_name(impl), size log_end;
+					ret = false;
+				}
+
+				std::fill(decoded.begin(), decoded.end(), (uint8_t)0xcc);
+				if (!hex_decode(mixed_w.c_str(), mixed_w.size(), decoded.data(), size, decoded_len) ||
+					decoded_len != size ||
+					(0 < size && 0 != memcmp(decoded.data(), data.data(), size)) ||
+					0xcc != decoded[size])
+				{
+					log_err "hex_decode() (wchar_t) mismatch. impl=%s, size=%zu", hex_impl_name(impl), size log_end;
+					ret = false;
+				}
+				if (0 < size && hex_decode(mixed.c_str(), mixed.size(), decoded.data(), size - 1, decoded_len))
+				{
+					log_err "hex_decode() accepted small buffer. impl=%s, size=%zu", hex_impl_name(impl), size log_end;
+					ret = false;
+				}
+			}
+		}
+
+		//
+		//	잘못된 입력: 모든 위치에 잘못된 문자를 넣어본다. (SIMD 블록 내부/경계 포함)
+		//
+		const std::string valid = legacy_hex_encode(data.data(), 100, false);
+		const char bad_chars[] = { ' ', '/', ':', '@', 'G', '`', 'g', 'x', '\x80', '\xff', '\0', '\x10' };
+		std::vector<uint8_t> out(valid.size() / 2);
+		for (size_t pos = 0; pos < valid.size(); ++pos)
+		{
+			for (char bad : bad_chars)
+			{
+				std::string broken = valid;
+				broken[pos] = bad;
+				size_t out_len = 0;
+				if (hex_decode(broken.c_str(), broken.size(), out.data(), out.size(), out_len))
+				{
+					log_err "invalid input accepted. impl=%s, pos=%zu, char=0x%02x",
+						hex_impl_name(impl), pos, (uint8_t)bad
+						log_end;
+					ret = false;
+				}
+			}
+
+			std::wstring broken_w(valid.begin(), valid.end());
+			broken_w[pos] = (wchar_t)(0x100 + (uint8_t)valid[pos]);
+			size_t out_len = 0;
+			if (hex_decode(broken_w.c_str(), broken_w.size(), out.data(), out.size(), out_len))
+			{
+				log_err "invalid input accepted (wchar_t). impl=%s, pos=%zu", hex_impl_name(impl), pos log_end;
+				ret = false;
+			}
+		}
+
+		size_t out_len = 0;
+		if (hex_decode("abc", 3, out.data(), out.size(), out_len))
+		{
+			log_err "odd length accepted. impl=%s", hex_impl_name(impl) log_end;
+			ret = false;
+		}
+	}
+	hex_set_impl(HEX_IMPL_AUTO);
+
+	//
+	//	hexdump: 예전 dump_memory() 형식, 중지, CMemoryStream
+	//
+	for (size_t size : { (size_t)0, (size_t)1, (size_t)7, (size_t)8, (size_t)9, (size_t)15, (size_t)16, (size_t)17, (size_t)100, (size_t)4096 })
+	{
+		const uint64_t base = 0x00007ff6a1b20000ull + size;
+		const std::list<std::string> expected = legacy_hexdump(base, data.data(), size);
+
+		std::list<std::string> lines;
+		if (!hexdump(base, data.data(), size, true, [&lines](_In_ const char* line, _In_ size_t line_len)
+		{
+			lines.push_back(std::string(line, line_len));
+			return true;
+		}) || lines != expected)
+		{
+			log_err "hexdump() mismatch. size=%zu", size log_end;
+			ret = false;
+		}
+
+		std::string joined;
+		for (const auto& line : expected) { joined += line; joined += '\n'; }
+
+		CMemoryStream stream;
+		if (!hexdump(base, data.data(), size, true, stream) ||
+			stream.GetSize() != joined.size() ||
+			0 != memcmp(stream.GetMemory(), joined.c_str(), joined.size()))
+		{
+			log_err "hexdump() (stream) mismatch. size=%zu", size log_end;
+			ret = false;
+		}
+	}
+
+	size_t count = 0;
+	if (hexdump(0, data.data(), 256, false, [&count](_In_ const char*, _In_ size_t)
+	{
+		return ++count < 3;
+	}) || 3 != count)
+	{
+		log_err "hexdump() did not stop. count=%zu", count log_end;
+		ret = false;
+	}
+
+	return ret;
+}
+
+/// @brief	16 MB 인코딩/디코딩 처리량 (printf, 구현별) 과 hexdump 처리량
+bool test_hex_codec_benchmark()
+{
+	const size_t size = 16 * 1024 * 1024;
+	std::vector<uint8_t> data(size);
+	std::mt19937 rng(1);
+	for (auto& b : data) { b = (uint8_t)rng(); }
+
+	std::vector<char> encoded(hex_encoded_length(size));
+	std::vector<uint8_t> decoded(size);
+	const double mb = size / (1024.0 * 1024.0);
+
+	StopWatch sw;
+	sw.Start();
+	std::string legacy_encoded = legacy_hex_encode(data.data(), size, false);
+	sw.Stop();
+	log_info "printf : encode %8.2f MB/s", mb / sw.GetDurationSecond() log_end;
+
+	bool ret = true;
+	for (int impl : _hex_impls)
+	{
+		if (!hex_impl_supported(impl)) continue;
+		hex_set_impl(impl);
+
+		size_t out_len = 0;
+		sw.Start();
+		for (int i = 0; i < 4; ++i)
+		{
+			hex_encode(data.data(), size, false, encoded.data(), encoded.size(), out_len);
+		}
+		sw.Stop();
+		const double encode_sec = sw.GetDurationSecond() / 4;
+
+		sw.Start();
+		for (int i = 0; i < 4; ++i)
+		{
+			if (!hex_decode(encoded.data(), encoded.size(), decoded.data(), decoded.size(), out_len)) ret = false;
+		}
+		sw.Stop();
+		const double decode_sec = sw.GetDurationSecond() / 4;
+
+		if (0 != memcmp(encoded.data(), legacy_encoded.c_str(), encoded.size()) || decoded != data)
+		{
+			log_err "mismatch. impl=%s", hex_impl_name(impl) log_end;
+			ret = false;
+		}
+
+		log_info "%-7s: encode %8.2f MB/s, decode %8.2f MB/s",
+			hex_impl_name(impl),
+			mb / encode_sec,
+			mb / decode_sec
+			log_end;
+	}
+	hex_set_impl(HEX_IMPL_AUTO);
+
+	//
+	//	hexdump: 1 MB 를 라인 list 로 (예전 방식) / sink 로 / CMemoryStream 으로
+	//
+	const size_t dump_size = 1024 * 1024;
+	const double dump_mb = dump_size / (1024.0 * 1024.0);
+
+	sw.Start();
+	std::list<std::string> legacy_lines = legacy_hexdump(0, data.data(), dump_size);
+	sw.Stop();
+	log_info "hexdump (printf, list)   : %8.2f MB/s", dump_mb / sw.GetDurationSecond() log_end;
+
+	size_t total = 0;
+	sw.Start();
+	if (!hexdump(0, data.data(), dump_size, true, [&total](_In_ const char*, _In_ size_t line_len)
+	{
+		total += line_len;
+		return true;
+	}))
+	{
+		ret = false;
+	}
+	sw.Stop();
+	log_info "hexdump (table, sink)    : %8.2f MB/s, %zu bytes", dump_mb / sw.GetDurationSecond(), total log_end;
+
+	CMemoryStream stream;
+	sw.Start();
+	if (!hexdump(0, data.data(), dump_size, true, stream)) ret = false;
+	sw.Stop();
+	log_info "hexdump (table, stream)  : %8.2f MB/s, %zu bytes", 
+		dump_mb / sw.GetDurationSecond(), 
+		stream.GetSize() 
+		log_end;
+
+	return ret;
+}
@@ -9,6 +9,9 @@
 
 #include "stdafx.h"
 #include "_MyLib/src/match.h"
+#include "_MyLib/src/prng.h"
+#include "_MyLib/src/str_format.h"
+#include "_MyLib/src/StopWatch.h"
 
 bool test_match()
 {
@@ -71,4 +74,556 @@ bool test_match()
 	_mem_check_end;
 
 	return true;
-}
\ No newline at end of file
+}
+
+/// @brief	glob_set 의 결과가 패턴을 하나씩 매치 함수로 확인한 결과와 같은지 확인한다.
+bool test_glob_set()
+{
+	bool ret = true;
+
+	//
+	//	예제
+	//
+	{
+		glob_set rules(glob_syntax::gitignore);
+		rules.add("*.exe");
+		rules.add("/windows/system32/*.dll");
+		rules.add("**/temp/**/*.tmp");
+		rules.add("*");
+		rules.add("setup?.msi");
+		rules.add("[a-c]*.log");
+		rules.compile();
+
+		struct
+		{
+			const char* path;
+			std::vector<uint32_t> expected;
+		} const cases[] = {
+			{ "c:\\users\\temp\\a.exe", { 0, 3 } },
+			{ "\\windows\\system32\\ntdll.dll", { 1, 3 } },
+			{ "\\windows\\system32\\drivers\\x.dll", { 3 } },
+			{ "d\\temp\\x\\y\\z.tmp", { 2, 3 } },
+			{ "dl\\setup1.msi", { 3, 4 } },
+			{ "x\\boot.log", { 3, 5 } },
+			{ "x\\boot.log\\", { 3 } },
+			{ "", { 3 } },
+		};
+
+		std::vector<uint32_t> ids;
+		for (const auto& c : cases)
+		{
+			rules.match_all(c.path, ids);
+			if (ids != c.expected)
+			{
+				log_err "glob_set mismatch. path=%s, matched=%zu, expected=%zu",
+					c.path,
+					ids.size(),
+					c.expected.size()
+					log_end;
+				ret = false;
+			}
+
+			uint32_t first = 0;
+			bool found = rules.match_first(c.path, first);
+			if (found != !c.expected.empty() || (found && first != c.expected[0]))
+			{
+				ret = false;
+			}
+		}
+	}
+
+	//
+	//	랜덤 패턴/텍스트로 교차 확인
+	//
+	static const char* pattern_items[] = {
+		"a", "b", "ab", "ba", ".", "/", "\\\\", "\\*", "*", "?", "**", "**/", "[ab]", "[!a]", "[a-", "x.y"
+	};
+	static const char text_chars[] = "ab.\\x/y*";
+
+	xoshiro256ss rng(2019);
+	for (glob_syntax syntax : { glob_syntax::wildcard, glob_syntax::glob, glob_syntax::gitignore })
+	{
+		glob_set set(syntax);
+		for (int i = 0; i < 300; ++i)
+		{
+			std::string pattern;
+			const int items = 1 + (int)rng.uniform(5);
+			for (int k = 0; k < items; ++k)
+			{
+				pattern += pattern_items[rng.uniform(_countof(pattern_items))];
+			}
+			set.add(pattern);
+		}
+		set.compile();
+
+		std::vector<uint32_t> ids;
+		std::vector<uint32_t> expected;
+		for (int i = 0; i < 3000; ++i)
+		{
+			std::string text;
+			const size_t len = (size_t)rng.uniform(12);
+			for (size_t k = 0; k < len; ++k)
+			{
+				text += text_chars[rng.uniform(sizeof(text_chars) - 1)];
+			}
+
+			expected.clear();
+			for (uint32_t id = 0; id < (uint32_t)set.size(); ++id)
+			{
+				bool matched;
+				switch (syntax)
+				{
+				case glob_syntax::wildcard: matched = match_string(text, set.pattern(id)); break;
+				case glob_syntax::glob: matched = glob_match_string(text, set.pattern(id)); break;
+				default: matched = gitignore_glob_match_string(text, set.pattern(id)); break;
+				}
+				if (matched) expected.push_back(id);
+			}
+
+			set.match_all(text, ids);
+			if (ids != expected)
+			{
+				log_err "glob_set cross check failed. syntax=%d, text=%s, matched=%zu, expected=%zu",
+					(int)syntax,
+					text.c_str(),
+					ids.size(),
+					expected.size()
+					log_end;
+				ret = false;
+				break;
+			}
+		}
+	}
+
+	return ret;
+}
+
+/// @brief	10k 개 규칙 x 1M 경로: 패턴마다 매치 함수를 호출하는 루프와 glob_set 비교
+///			루프는 너무 느려서 경로 일부로만 측정하고 경로 하나당 시간을 비교한다.
+bool test_glob_set_benchmark()
+{
+	const uint32_t rule_count = 10000;
+	const uint32_t path_count = 1000000;
+	const uint32_t loop_path_count = 2000;
+
+	static const char* dirs[] = {
+		"windows", "system32", "program files", "users", "appdata", "local", "temp",
+		"roaming", "programdata", "drivers", "syswow64", "microsoft", "downloads"
+	};
+	static const char* exts[] = { "exe", "dll", "sys", "tmp", "log", "ps1", "bat", "txt" };
+
+	xoshiro256ss rng(10000);
+	auto word = [&](const char* prefix)
+	{
+		char buf[32];
+		format_to(buf, sizeof(buf), "%s%u", prefix, (uint32_t)rng.uniform(5000));
+		return std::string(buf);
+	};
+
+	glob_set rules(glob_syntax::gitignore);
+	std::vector<std::string> patterns;
+	for (uint32_t i = 0; i < rule_count; ++i)
+	{
+		std::string pattern;
+		switch (rng.uniform(4))
+		{
+		case 0: pattern = "**/" + std::string(dirs[rng.uniform(_countof(dirs))]) + "/" + word("tool") + "*." + exts[rng.uniform(_countof(exts))]; break;
+		case 1: pattern = "/windows/system32/" + word("svc") + "?.dll"; break;
+		case 2: pattern = word("setup") + "*.exe"; break;
+		default: pattern = "/users/*/appdata/" + word("cache") + "/**"; break;
+		}
+		patterns.push_back(pattern);
+		rules.add(pattern);
+	}
+
+	StopWatch sw;
+	sw.Start();
+	rules.compile();
+	sw.Stop();
+	log_info "compile %u rules: %.3f ms", rule_count, sw.GetDurationMilliSecond() log_end;
+
+	std::vector<std::string> paths;
+	for (uint32_t i = 0; i < 4096; ++i)
+	{
+		std::string path;
+		const int depth = 2 + (int)rng.uniform(4);
+		for (int k = 0; k < depth; ++k)
+		{
+			path += "\\";
+			path += (0 == rng.uniform(3)) ? word("tool") : std::string(dirs[rng.uniform(_countof(dirs))]);
+		}
+		path += "\\" + ((0 == rng.uniform(2)) ? word("setup") : word("svc")) + "." + exts[rng.uniform(_countof(exts))];
+		paths.push_back(path);
+	}
+
+	size_t loop_matches = 0;
+	sw.Start();
+	for (uint32_t i = 0; i < loop_path_count; ++i)
+	{
+		const std::string& path = paths[i % paths.size()];
+		for (const auto& pattern : patterns)
+		{
+			if (gitignore_glob_match_string(path, pattern)) ++loop_matches;
+		}
+	}
+	sw.Stop();
+	const double loop_ns = sw.GetDurationSecond() * 1e9 / loop_path_count;
+
+	size_t set_matches = 0;
+	std::vector<uint32_t> ids;
+	sw.Start();
+	for (uint32_t i = 0; i < path_count; ++i)
+	{
+		set_matches += rules.match_all(paths[i % paths.size()], ids);
+	}
+	sw.Stop();
+	const double set_ns = sw.GetDurationSecond() * 1e9 / path_count;
+
+	log_info "per-pattern loop : %10.1f ns/path (%u paths, %zu matches)", loop_ns, loop_path_count, loop_matches log_end;
+	log_info "glob_set         : %10.1f ns/path (%u paths, %zu matches, x%.0f)", set_ns, path_count, set_matches, loop_ns / set_ns log_end;
+	return true;
+}
+
+/// @brief	glob_pattern 의 사전 필터가 매치되는 텍스트를 거르지 않는지 
+///			(결과가 원래 매치 함수와 같은지) 모든 구현에 대해 확인한다.
+bool test_glob_pattern()
+{
+	bool ret = true;
+
+	//
+	//	앵커 예제
+	//
+	{
+		glob_pattern temp_exe(glob_syntax::wildcard, "*\\temp\\*.exe");
+		glob_pattern windows(glob_syntax::wildcard, "c:\\windows\\*");
+		glob_pattern exact(glob_syntax::wildcard, "c:\\boot.ini");
+
+		struct
+		{
+			const glob_pattern* pattern;
+			const char* text;
+			bool prefilter;
+			bool expected;
+		} const cases[] = {
+			{ &temp_exe, "c:\\users\\me\\appdata\\local\\temp\\a.exe", true, true },
+			{ &temp_exe, "c:\\users\\me\\appdata\\local\\temp\\a.dll", false, false },
+			{ &temp_exe, "c:\\windows\\system32\\a.exe", false, false },
+			{ &temp_exe, "\\temp\\.exe", true, true },
+			{ &temp_exe, "\\temp.exe", false, false },
+			{ &windows, "c:\\windows\\notepad.exe", true, true },
+			{ &windows, "d:\\windows\\notepad.exe", false, false },
+			{ &exact, "c:\\boot.ini", true, true },
+			{ &exact, "c:\\boot.ini.bak", false, false },
+		};
+		for (const auto& c : cases)
+		{
+			const bool prefilter = c.pattern->prefilter(c.text, strlen(c.text));
+			const bool matched = c.pattern->match(c.text);
+			if (prefilter != c.prefilter || matched != c.expected)
+			{
+				log_err "glob_pattern mismatch. pattern=%s, text=%s, prefilter=%d, match=%d",
+					c.pattern->pattern().c_str(),
+					c.text,
+					prefilter,
+					matched
+					log_end;
+				ret = false;
+			}
+		}
+	}
+
+	//
+	//	랜덤 패턴/텍스트 교차 확인 (구현마다)
+	//
+	static const char* pattern_items[] = {
+		"a", "b", "ab", "ba", "aab", ".", "/", "\\\\", "\\", "\\*", "*", "?", "**", "**/", "[ab]", "[!a]", "[a-", "x.y"
+	};
+	static const char text_chars[] = "ab.\\x/y*";
+
+	const int saved_impl = match_get_impl();
+	for (int impl : { MATCH_IMPL_SCALAR, MATCH_IMPL_SSE2, MATCH_IMPL_AVX2 })
+	{
+		if (!match_set_impl(impl)) continue;
+
+		xoshiro256ss rng(2022);
+		for (glob_syntax syntax : { glob_syntax::wildcard, glob_syntax::glob, glob_syntax::gitignore })
+		{
+			for (int p = 0; p < 400; ++p)
+			{
+				std::string pattern_text;
+				const int items = 1 + (int)rng.uniform(6);
+				for (int k = 0; k < items; ++k)
+				{
+					pattern_text += pattern_items[rng.uniform(_countof(pattern_items))];
+				}
+				const glob_pattern pattern(syntax, pattern_text);
+
+				for (int t = 0; t < 200; ++t)
+				{
+					//
+					//	SIMD 블록 경계를 지나도록 가끔 긴 텍스트도 만든다.
+					//
+					std::string text;
+					const size_t len = (size_t)rng.uniform((0 == t % 10) ? 80 : 14);
+					for (size_t k = 0; k < len; ++k)
+					{
+						text += text_chars[rng.uniform(sizeof(text_chars) - 1)];
+					}
+
+					bool expected;
+					switch (syntax)
+					{
+					case glob_syntax::wildcard: expected = match_string(text, pattern_text); break;
+					case glob_syntax::glob: expected = glob_match_string(text, pattern_text); break;
+					default: expected = gitignore_glob_match_string(text, pattern_text); break;
+					}
+
+					if (pattern.match(text) != expected)
+					{
+						log_err "glob_pattern cross check failed. impl=%s, syntax=%d, pattern=%s, text=%s",
+							match_impl_name(impl),
+							(int)syntax,
+							pattern_text.c_str(),
+							text.c_str()
+							log_end;
+						ret = false;
+						t = 200;
+						p = 400;
+					}
+				}
+			}
+		}
+	}
+	match_set_impl(saved_impl);
+
+	return ret;
+}
+
+/// @brief	Windows 동작 (대소문자 무시, '\\') 과 Linux 동작 ('/', dot 파일) 을
+///			한 바이너리에서 같이 사용할 수 있는지 확인한다.
+bool test_glob_options()
+{
+	bool ret = true;
+
+	const glob_options win = glob_windows_options();
+	const glob_options posix = glob_posix_options();
+
+	struct
+	{
+		glob_syntax syntax;
+		const char* pattern;
+		const char* text;
+		bool win;
+		bool posix;
+	} const cases[] = {
+		{ glob_syntax::glob, "*.TXT", "a.txt", true, false },
+		{ glob_syntax::glob, "c:/Windows/*.exe", "C:\\WINDOWS\\notepad.EXE", true, false },
+		{ glob_syntax::glob, "/usr/bin/*", "/usr/bin/ls", true, true },
+		{ glob_syntax::glob, "dir/*", "dir\\a.c", true, false },
+		{ glob_syntax::glob, "dir/*", "dir/.git", true, false },
+		{ glob_syntax::glob, "dir/?git", "dir/.git", true, false },
+		{ glob_syntax::glob, "*", ".bashrc", true, false },
+		{ glob_syntax::glob, "[A-C]*.log", "b.log", true, false },
+		{ glob_syntax::glob, "[!a]x.log", "Ax.log", false, true },
+		{ glob_syntax::gitignore, "*.o", "src\\main.O", true, false },
+		{ glob_syntax::gitignore, "*.o", "src/main.o", true, true },
+		{ glob_syntax::gitignore, "**/temp/*.exe", "users/me/temp/a.exe", true, true },
+		{ glob_syntax::gitignore, "**/temp/*.exe", "Users\\me\\Temp\\a.exe", true, false },
+		{ glob_syntax::gitignore, "/build/", "./build/", false, true },
+		{ glob_syntax::gitignore, "/build/", ".\\Build\\", true, false },
+		{ glob_syntax::wildcard, "*.TXT", "a.txt", false, false },
+	};
+
+	for (const auto& c : cases)
+	{
+		glob_match_fn win_match = get_glob_matcher(c.syntax, win);
+		glob_match_fn posix_match = get_glob_matcher(c.syntax, posix);
+		const std::string text(c.text);
+		const std::string pattern(c.pattern);
+
+		const bool w = win_match(text.data(), text.size(), pattern.data(), pattern.size());
+		const bool p = posix_match(text.data(), text.size(), pattern.data(), pattern.size());
+		const bool wp = glob_pattern(c.syntax, pattern, win).match(text);
+		const bool pp = glob_pattern(c.syntax, pattern, posix).match(text);
+		if (w != c.win || p != c.posix || wp != c.win || pp != c.posix)
+		{
+			log_err "glob_options mismatch. syntax=%d, pattern=%s, text=%s, win=%d/%d, posix=%d/%d",
+				(int)c.syntax,
+				c.pattern,
+				c.text,
+				w,
+				wp,
+				p,
+				pp
+				log_end;
+			ret = false;
+		}
+	}
+
+	//
+	//	기본 옵션은 매크로로 정한 기존 함수와 같아야 한다.
+	//
+	if (get_glob_matcher(glob_syntax::glob) != &basic_glob_match<glob_default_case, glob_default_sep, glob_default_dot> ||
+		get_glob_matcher(glob_syntax::gitignore) != &basic_gitignore_glob_match<glob_default_case, glob_default_sep, glob_default_dot>)
+	{
+		log_err "default glob matcher mismatch" log_end;
+		ret = false;
+	}
+	if (nullptr != get_glob_matcher(glob_syntax::glob, glob_options(false, ':', true)))
+	{
+		log_err "unsupported separator accepted" log_end;
+		ret = false;
+	}
+
+	//
+	//	옵션 조합마다 glob_set 과 특수화된 매치 함수를 하나씩 확인한 결과가 
+	//	같은지 랜덤 교차 확인
+	//
+	static const char* pattern_items[] = {
+		"a", "B", "ab", ".", "/", "\\\\", "*", "?", "**", "**/", "[a-b]", "[!A]", "x.Y"
+	};
+	static const char text_chars[] = "aAbB.\\/xy";
+
+	xoshiro256ss rng(2023);
+	for (int option_bits = 0; option_bits < 8; ++option_bits)
+	{
+		const glob_options options(0 != (option_bits & 1), (option_bits & 2) ? '/' : '\\', 0 != (option_bits & 4));
+		for (glob_syntax syntax : { glob_syntax::glob, glob_syntax::gitignore })
+		{
+			glob_match_fn matcher = get_glob_matcher(syntax, options);
+			glob_set rules(syntax, options);
+			std::vector<std::string> patterns;
+			for (int p = 0; p < 100; ++p)
+			{
+				std::string pattern;
+				const int items = 1 + (int)rng.uniform(5);
+				for (int k = 0; k < items; ++k)
+				{
+					pattern += pattern_items[rng.uniform(_countof(pattern_items))];
+				}
+				patterns.push_back(pattern);
+				rules.add(pattern);
+			}
+			rules.compile();
+
+			std::vector<uint32_t> ids;
+			for (int t = 0; t < 300; ++t)
+			{
+				std::string text;
+				const size_t len = (size_t)rng.uniform(12);
+				for (size_t k = 0; k < len; ++k)
+				{
+					text += text_chars[rng.uniform(sizeof(text_chars) - 1)];
+				}
+
+				std::vector<uint32_t> expected;
+				for (uint32_t id = 0; id < (uint32_t)patterns.size(); ++id)
+				{
+					if (matcher(text.data(), text.size(), patterns[id].data(), patterns[id].size()))
+						expected.push_back(id);
+				}
+				rules.match_all(text, ids);
+				if (ids != expected)
+				{
+					log_err "glob_set/glob_options cross check failed. options=%d, syntax=%d, text=%s",
+						option_bits,
+						(int)syntax,
+						text.c_str()
+						log_end;
+					ret = false;
+					break;
+				}
+			}
+		}
+	}
+
+	return ret;
+}
+
+/// @brief	흔한 규칙 (*\temp\*.exe, c:\windows\* ...) 을 대부분 매치되지 않는
+///			경로에 적용할 때 경로 하나당 비용
+///			match_string() 직접 호출 / glob_pattern (구현별)
+bool test_match_benchmark()
+{
+	const uint32_t path_count = 200000;
+	static const char* rules[] = {
+		"*\\temp\\*.exe",
+		"c:\\windows\\*",
+		"*\\appdata\\roaming\\*\\*.ps1",
+		"*\\downloads\\*.msi",
+		"c:\\programdata\\*\\update.exe",
+		"*.scr",
+	};
+	static const char* dirs[] = {
+		"users", "somma", "documents", "projects", "src", "program files", "common files",
+		"microsoft shared", "build", "output", "cache", "images", "library", "temp", "windows"
+	};
+	static const char* exts[] = { "txt", "cpp", "h", "png", "dll", "json", "xml", "log", "exe" };
+
+	xoshiro256ss rng(2022);
+	std::vector<std::string> paths;
+	for (uint32_t i = 0; i < 4096; ++i)
+	{
+		std::string path = (0 == rng.uniform(4)) ? "c:" : "d:";
+		const int depth = 3 + (int)rng.uniform(6);
+		for (int k = 0; k < depth; ++k)
+		{
+			path += "\\";
+			path += dirs[rng.uniform(_countof(dirs))];
+		}
+		path += "\\file" + std::to_string(rng.uniform(100000)) + "." + exts[rng.uniform(_countof(exts))];
+		paths.push_back(path);
+	}
+
+	std::vector<std::string> rule_text(std::begin(rules), std::end(rules));
+	std::vector<glob_pattern> patterns;
+	for (const auto& rule : rule_text)
+	{
+		patterns.push_back(glob_pattern(glob_syntax::wildcard, rule));
+	}
+
+	StopWatch sw;
+	size_t matches = 0;
+	sw.Start();
+	for (uint32_t i = 0; i < path_count; ++i)
+	{
+		const std::string& path = paths[i % paths.size()];
+		for (const auto& rule : rule_text)
+		{
+			if (match_string(path, rule)) ++matches;
+		}
+	}
+	sw.Stop();
+	log_info "%-14s: %8.1f ns/path (%u rules, %zu matches)",
+		"match_string",
+		sw.GetDurationSecond() * 1e9 / path_count,
+		(uint32_t)rule_text.size(),
+		matches
+		log_end;
+
+	const int saved_impl = match_get_impl();
+	for (int impl : { MATCH_IMPL_SCALAR, MATCH_IMPL_SSE2, MATCH_IMPL_AVX2 })
+	{
+		if (!match_set_impl(impl)) continue;
+
+		matches = 0;
+		sw.Start();
+		for (uint32_t i = 0; i < path_count; ++i)
+		{
+			const std::string& path = paths[i % paths.size()];
+			for (const auto& pattern : patterns)
+			{
+				if (pattern.match(path)) ++matches;
+			}
+		}
+		sw.Stop();
+		log_info "glob_pattern %-6s: %8.1f ns/path (%u rules, %zu matches)",
+			match_impl_name(impl),
+			sw.GetDurationSecond() * 1e9 / path_count,
+			(uint32_t)patterns.size(),
+			matches
+			log_end;
+	}
+	match_set_impl(saved_impl);
+	return true;
+}
@@ -0,0 +1,328 @@
+﻿/**
+ * @file    _test_num_parse.cpp
+ * @brief   parse_number()/parse_number_list() correctness, str_to_xxx compatibility and throughput tests.
+ *
+ * @author  Yonhgwhan, Roh (somma@somma.kr)
+ * @date    2026/10/18 created.
+ * @copyright (C)Somma, Inc. All rights reserved.
+**/
+#include "stdafx.h"
+#include "_MyLib/src/num_parse.h"
+#include "_MyLib/src/Win32Utils.h"
+#include "_MyLib/src/StopWatch.h"
+#include <random>
+
+/// @brief	str 전체를 T 로 파싱해서 기대값과 비교한다. (char, wchar_t 모두)
+template <typename T>
+static bool check_parse(const char* str, std::errc expected_ec, T expected_value, size_t expected_len)
+{
+	const std::wstring wstr(str, str + strlen(str));
+
+	T value = (T)0x5a;
+	const parse_number_result<char> r = parse_number(str, str + strlen(str), value);
+	T wvalue = (T)0x5a;
+	const parse_number_result<wchar_t> wr = parse_number(wstr.c_str(), wstr.c_str() + wstr.size(), wvalue);
+
+	const T unchanged = (T)0x5a;
+	const T expected = (std::errc() == expected_ec) ? expected_value : unchanged;
+	if (r.ec != expected_ec || (size_t)(r.ptr - str) != expected_len || value != expected ||
+		wr.ec != expected_ec || (size_t)(wr.ptr - wstr.c_str()) != expected_len || wvalue != expected)
+	{
+		log_err "parse_number() mismatch. str=%s, ec=%d/%d, len=%zu/%zu",
+			str, 
+			(int)r.ec, 
+			(int)wr.ec, 
+			(size_t)(r.ptr - str), 
+			(size_t)(wr.ptr - wstr.c_str())
+			log_end;
+		return false;
+	}
+	return true;
+}
+
+/// @brief	경계값, 16 진수, 오류, SWAR 경로 (모든 길이/위치), 목록 파싱, 
+///			str_to_xxx 의 예전 동작을 확인한다.
+bool test_num_parse()
+{
+	const std::errc ok = std::errc();
+	const std::errc invalid = std::errc::invalid_argument;
+	const std::errc range = std::errc::result_out_of_range;
+
+	bool ret = true;
+	ret &= check_parse<int32_t>("0", ok, 0, 1);
+	ret &= check_parse<int32_t>("-0", ok, 0, 2);
+	ret &= check_parse<int32_t>("2147483647", ok, INT32_MAX, 10);
+	ret &= check_parse<int32_t>("-2147483648", ok, INT32_MIN, 11);
+	ret &= check_parse<int32_t>("2147483648", range, 0, 10);
+	ret &= check_parse<int32_t>("-2147483649", range, 0, 11);
+	ret &= check_parse<int32_t>("0x7fffffff", ok, INT32_MAX, 10);
+	ret &= check_parse<int32_t>("-0x80000000", ok, INT32_MIN, 11);
+	ret &= check_parse<int32_t>("0x80000000", range, 0, 10);
+	ret &= check_parse<int32_t>("", invalid, 0, 0);
+	ret &= check_parse<int32_t>("-", invalid, 0, 0);
+	ret &= check_parse<int32_t>("+1", invalid, 0, 0);
+	ret &= check_parse<int32_t>(" 1", invalid, 0, 0);
+	ret &= check_parse<int32_t>("x1", invalid, 0, 0);
+	ret &= check_parse<int32_t>("12ab", ok, 12, 2);
+	ret &= check_parse<int32_t>("0x", ok, 0, 1);
+	ret &= check_parse<int32_t>("0xg", ok, 0, 1);
+	ret &= check_parse<int32_t>("0X1aF", ok, 0x1af, 5);
+	ret &= check_parse<int32_t>("010", ok, 10, 3);
+	ret &= check_parse<uint8_t>("255", ok, 255, 3);
+	ret &= check_parse<uint8_t>("256", range, 0, 3);
+	ret &= check_parse<int8_t>("-128", ok, -128, 4);
+	ret &= check_parse<int8_t>("128", range, 0, 3);
+	ret &= check_parse<uint16_t>("65535", ok, 65535, 5);
+	ret &= check_parse<uint16_t>("65536", range, 0, 5);
+	ret &= check_parse<uint32_t>("-1", invalid, 0, 0);
+	ret &= check_parse<uint32_t>("4294967295", ok, UINT32_MAX, 10);
+	ret &= check_parse<uint32_t>("4294967296", range, 0, 10);
+	ret &= check_parse<uint32_t>("0xffffffff", ok, UINT32_MAX, 10);
+	ret &= check_parse<uint64_t>("18446744073709551615", ok, UINT64_MAX, 20);
+	ret &= check_parse<uint64_t>("18446744073709551616", range, 0, 20);
+	ret &= check_parse<uint64_t>("99999999999999999999999999,", range, 0, 26);
+	ret &= check_parse<uint64_t>("0xffffffffffffffff", ok, UINT64_MAX, 18);
+	ret &= check_parse<uint64_t>("0x10000000000000000", range, 0, 19);
+	ret &= check_parse<uint64_t>("000000000000000000000000000000001", ok, 1, 33);
+	ret &= check_parse<int64_t>("9223372036854775807", ok, INT64_MAX, 19);
+	ret &= check_parse<int64_t>("-9223372036854775808", ok, INT64_MIN, 20);
+	ret &= check_parse<int64_t>("9223372036854775808", range, 0, 19);
+	ret &= check_parse<int64_t>("-9223372036854775809", range, 0, 20);
+
+	//
+	//	base 지정
+	//
+	uint32_t v32 = 0;
+	const char* hex_str = "ff";
+	if (std::errc() != parse_number(hex_str, hex_str + 2, v32, 16).ec || 0xff != v32) ret = false;
+	const char* dec_str = "0x10";
+	if (std::errc() != parse_number(dec_str, dec_str + 4, v32, 10).ec || 0 != v32) ret = false;
+	if (std::errc::invalid_argument != parse_number(dec_str, dec_str + 4, v32, 8).ec) ret = false;
+
+	//
+	//	SWAR 경로: 1~20 자리 숫자를 다양한 위치와 뒤따르는 문자로 파싱한다.
+	//	(8 문자 단위 읽기가 끝에 걸치는 경우 포함)
+	//
+	std::mt19937_64 rng(0x7a11);
+	const char tails[] = { '\0', ',', ' ', '/', ':', 'a', '\xff', '\x80' };
+	for (int i = 0; i < 20000; ++i)
+	{
+		const int digits = 1 + (int)(rng() % 20);
+		uint64_t v = rng();
+		std::string str = std::to_string(v);
+		if ((int)str.size() > digits) str.resize(digits);
+		const uint64_t expected = strtoull(str.c_str(), nullptr, 10);
+
+		const std::string prefix(rng() % 9, '0');
+		std::string input = prefix + str;
+		const size_t number_len = input.size();
+		const char tail = tails[rng() % _countof(tails)];
+		if ('\0' != tail) input += tail;
+		input += std::string(rng() % 10, (char)('0' + rng() % 10));
+		if ('\0' == tail) input.resize(number_len);
+
+		uint64_t parsed = 0;
+		const parse_number_result<char> r = parse_number(input.c_str(), input.c_str() + input.size(), parsed);
+		const std::wstring winput(input.begin(), input.end());
+		uint64_t wparsed = 0;
+		const parse_number_result<wchar_t> wr = parse_number(winput.c_str(), winput.c_str() + winput.size(), wparsed);
+		if (std::errc() != r.ec || parsed != expected || (size_t)(r.ptr - input.c_str()) != number_len ||
+			std::errc() != wr.ec || wparsed != expected || (size_t)(wr.ptr - winput.c_str()) != number_len)
+		{
+			log_err "SWAR path mismatch. input=%s", input.c_str() log_end;
+			ret = false;
+			break;
+		}
+	}
+
+	//
+	//	wchar_t: ascii 가 아닌 문자 (하위 바이트가 숫자인 문자 포함) 에서 멈춰야 한다.
+	//
+	const wchar_t wide[] = { L'1', L'2', L'3', (wchar_t)0x0134, L'5', L'6', L'7', L'8', L'9', L'0', 0 };
+	uint32_t wv = 0;
+	const parse_number_result<wchar_t> wr = parse_number(wide, wide + wcslen(wide), wv);
+	if (std::errc() != wr.ec || 123 != wv || 3 != wr.ptr - wide) ret = false;
+	const wchar_t fullwidth[] = { 0xff11, 0xff12, 0 };	// 전각 숫자
+	if (std::errc::invalid_argument != parse_number(fullwidth, fullwidth + 2, wv).ec) ret = false;
+
+	//
+	//	목록 파싱
+	//
+	{
+		std::vector<uint32_t> values;
+		const char* csv = "1,22,333\r\n4444 , 0x10\r\n\r\n55555\r\n";
+		if (!parse_number_list(csv, csv + strlen(csv), ',', values) ||
+			values != std::vector<uint32_t>({ 1, 22, 333, 4444, 16, 55555 }))
+		{
+			log_err "parse_number_list() (csv) mismatch." log_end;
+			ret = false;
+		}
+
+		values.clear();
+		const wchar_t* pids = L"  4  88\t1024   65532\n 4294967295";
+		if (!parse_number_list(pids, pids + wcslen(pids), L' ', values) ||
+			values != std::vector<uint32_t>({ 4, 88, 1024, 65532, 4294967295u }))
+		{
+			log_err "parse_number_list() (pids) mismatch." log_end;
+			ret = false;
+		}
+
+		const char* invalid_lists[] = { "1,,2", ",1", "1,2,", "1,2a", "1 2", "4294967296", "1,-2", "1,\n2" };
+		const size_t invalid_offsets[] = { 2, 0, 4, 2, 0, 0, 2, 2 };
+		const size_t invalid_counts[] = { 1, 0, 2, 1, 0, 0, 1, 1 };	// 문제가 된 필드 앞의 값만 남아야 함
+		for (size_t i = 0; i < _countof(invalid_lists); ++i)
+		{
+			values.clear();
+			size_t offset = 0xffff;
+			if (parse_number_list(invalid_lists[i], invalid_lists[i] + strlen(invalid_lists[i]), ',', values, &offset) ||
+				offset != invalid_offsets[i] ||
+				values.size() != invalid_counts[i])
+			{
+				log_err "invalid list accepted or wrong offset. list=%s, offset=%zu, values=%zu", 
+					invalid_lists[i], 
+					offset,
+					values.size()
+					log_end;
+				ret = false;
+			}
+		}
+
+		std::vector<int64_t> signed_values;
+		const char* signed_list = "-1 -9223372036854775808 9223372036854775807";
+		if (!parse_number_list(signed_list, signed_list + strlen(signed_list), ' ', signed_values) ||
+			signed_values != std::vector<int64_t>({ -1, INT64_MIN, INT64_MAX }))
+		{
+			log_err "parse_number_list() (signed) mismatch." log_end;
+			ret = false;
+		}
+
+		values.clear();
+		const char* empty = "";
+		if (!parse_number_list(empty, empty, ',', values) || !values.empty()) ret = false;
+	}
+
+	//
+	//	str_to_xxx: 예전 동작 (앞 공백, '+', 뒤의 문자 무시, 숫자가 없으면 0) + 16 진수
+	//
+	int32_t i32 = -1;
+	if (!str_to_int32("  +42xyz", i32) || 42 != i32) ret = false;
+	if (!str_to_int32("invalid", i32) || 0 != i32) ret = false;
+	if (!str_to_int32("0x7fffffff", i32) || INT32_MAX != i32) ret = false;
+	if (!wstr_to_int32(L"\t-17", i32) || -17 != i32) ret = false;
+	if (str_to_int32("2147483648", i32)) ret = false;
+
+	uint16_t u16 = 0;
+	if (!str_to_uint16(" 8080 ", u16) || 8080 != u16) ret = false;
+	if (str_to_uint16("   ", u16)) ret = false;
+	if (str_to_uint16("65536", u16)) ret = false;
+	if (str_to_uint16(" -1", u16)) ret = false;
+	if (!wstr_to_uint16(L"0xffff", u16) || 0xffff != u16) ret = false;
+
+	uint32_t u32 = 0;
+	if (!wstr_to_uint32(L"0x1000", u32) || 0x1000 != u32) ret = false;
+	if (wstr_to_uint32(L"-5", u32)) ret = false;
+	if (wstr_to_uint32(nullptr, u32)) ret = false;
+
+	uint64_t u64 = 0;
+	if (!wstr_to_uint64(L"132456789012345678", u64) || 132456789012345678ull != u64) ret = false;
+	if (wstr_to_uint64(L"18446744073709551616", u64)) ret = false;
+
+	int64_t i64 = 0;
+	if (!wstr_to_int64(L"-9223372036854775808", i64) || INT64_MIN != i64) ret = false;
+
+	return ret;
+}
+
+/// @brief	1M 개 숫자의 파싱 처리량 (strtoull / parse_number / parse_number_list)
+bool test_num_parse_benchmark()
+{
+	const size_t count = 1000000;
+	std::mt19937_64 rng(1);
+
+	//
+	//	pid 처럼 짧은 숫자 (공백 구분) 와 타임스탬프처럼 긴 숫자 (csv)
+	//
+	std::string pids;
+	std::vector<uint32_t> pid_values;
+	std::string stamps;
+	std::vector<uint64_t> stamp_values;
+	for (size_t i = 0; i < count; ++i)
+	{
+		const uint32_t pid = (uint32_t)(rng() % 70000) * 4;
+		pids += std::to_string(pid);
+		pids += ' ';
+		pid_values.push_back(pid);
+
+		const uint64_t stamp = 132000000000000000ull + rng() % 1000000000000000ull;
+		stamps += std::to_string(stamp);
+		stamps += (0 == (i + 1) % 4) ? "\r\n" : ",";
+		stamp_values.push_back(stamp);
+	}
+	const std::wstring wstamps(stamps.begin(), stamps.end());
+
+	bool ret = true;
+	StopWatch sw;
+	struct
+	{
+		const char* name;
+		const std::string* input;
+		char delimiter;
+		bool is_pid;
+	} cases[] = { { "pid", &pids, ' ', true }, { "stamp", &stamps, ',', false } };
+
+	for (auto& c : cases)
+	{
+		//
+		//	strtoull 로 하나씩 (예전 방식)
+		//
+		std::vector<uint64_t> legacy;
+		legacy.reserve(count);
+		sw.Start();
+		const char* p = c.input->c_str();
+		while ('\0' != *p)
+		{
+			char* end = nullptr;
+			legacy.push_back(strtoull(p, &end, 10));
+			p = end;
+			while (c.delimiter == *p || '\r' == *p || '\n' == *p) ++p;
+		}
+		sw.Stop();
+		const double legacy_sec = sw.GetDurationSecond();
+
+		std::vector<uint64_t> values;
+		values.reserve(count);
+		sw.Start();
+		if (!parse_number_list(c.input->c_str(), c.input->c_str() + c.input->size(), c.delimiter, values)) ret = false;
+		sw.Stop();
+		const double list_sec = sw.GetDurationSecond();
+
+		if (legacy != values || 
+			values.size() != count ||
+			(c.is_pid && values.back() != pid_values.back()) ||
+			(!c.is_pid && values.back() != stamp_values.back()))
+		{
+			log_err "mismatch. case=%s", c.name log_end;
+			ret = false;
+		}
+
+		log_info "%-5s: strtoull %7.2f ns/number, parse_number_list %7.2f ns/number (%.1fx)",
+			c.name,
+			legacy_sec * 1e9 / count,
+			list_sec * 1e9 / count,
+			legacy_sec / list_sec
+			log_end;
+	}
+
+	//
+	//	wchar_t: 예전 wstr_to_uint64 는 WcsToMbsEx() 변환 후 파싱했다.
+	//
+	std::vector<uint64_t> wvalues;
+	wvalues.reserve(count);
+	sw.Start();
+	if (!parse_number_list(wstamps.c_str(), wstamps.c_str() + wstamps.size(), L',', wvalues)) ret = false;
+	sw.Stop();
+	if (wvalues != stamp_values) ret = false;
+	log_info "wstamp: parse_number_list %7.2f ns/number", sw.GetDurationSecond() * 1e9 / count log_end;
+
+	return ret;
+}
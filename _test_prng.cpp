@@ -0,0 +1,270 @@
+﻿/**
+ * @file    _test_prng.cpp
+ * @brief   xoshiro256** known answers, bounded sampling, fill/string and thread-local PRNG tests.
+ *
+ * @author  Yonhgwhan, Roh (somma@somma.kr)
+ * @date    2026/10/18 created.
+ * @copyright (C)Somma, Inc. All rights reserved.
+**/
+#include "stdafx.h"
+#include "_MyLib/src/prng.h"
+#include "_MyLib/src/Win32Utils.h"
+#include "_MyLib/src/StopWatch.h"
+#include <thread>
+#include <random>
+#include <sstream>
+#include <set>
+
+/// @brief	참조 구현과 같은 수열, 범위, 분포, 버퍼 경계, 스레드별 시드를 확인한다.
+bool test_prng()
+{
+	bool ret = true;
+
+	//
+	//	상태 {1, 2, 3, 4} 에서 참조 구현 (xoshiro256starstar.c) 의 출력
+	//
+	{
+		const uint64_t state[4] = { 1, 2, 3, 4 };
+		const uint64_t expected[] = {
+			0x0000000000002d00ull,
+			0x0000000000000000ull,
+			0x000000005a007080ull,
+			0x10e0000000009d80ull,
+			0x10e0b61ce1009d80ull,
+			0x0870021ce143ad00ull
+		};
+		xoshiro256ss rng(state);
+		for (size_t i = 0; i < _countof(expected); ++i)
+		{
+			uint64_t x = rng.next();
+			if (x != expected[i])
+			{
+				log_err "known answer mismatch. index=%zu, 0x%016llx != 0x%016llx",
+					i,
+					(unsigned long long)x,
+					(unsigned long long)expected[i]
+					log_end;
+				ret = false;
+			}
+		}
+
+		xoshiro256ss a(1234), b(1234);
+		for (int i = 0; i < 100; ++i)
+		{
+			if (a.next() != b.next()) ret = false;
+		}
+	}
+
+	//
+	//	uniform() / range(): 범위와 양 끝 값, 대략적인 분포
+	//
+	{
+		xoshiro256ss rng(42);
+		const uint64_t bounds[] = { 1, 2, 3, 7, 10, 1000, 0x80000001ull, 0xffffffffull, 0x100000001ull, 0xffffffffffffffffull };
+		for (uint64_t bound : bounds)
+		{
+			for (int i = 0; i < 10000; ++i)
+			{
+				if (rng.uniform(bound) >= bound) ret = false;
+			}
+		}
+		if (0 != rng.uniform(0)) ret = false;
+
+		uint32_t hist[6] = { 0 };
+		bool seen_min = false, seen_max = false;
+		for (int i = 0; i < 60000; ++i)
+		{
+			int64_t x = rng.range(-3, 2);
+			if (x < -3 || x > 2) { ret = false; continue; }
+			++hist[x + 3];
+			seen_min |= (-3 == x);
+			seen_max |= (2 == x);
+		}
+		if (!seen_min || !seen_max) ret = false;
+		for (uint32_t h : hist)
+		{
+			if (h < 9000 || h > 11000)
+			{
+				log_err "range() distribution skewed. count=%u (expected ~10000)", h log_end;
+				ret = false;
+			}
+		}
+
+		const int64_t i64_min = (std::numeric_limits<int64_t>::min)();
+		const int64_t i64_max = (std::numeric_limits<int64_t>::max)();
+		rng.range(i64_min, i64_max);
+		if (7 != rng.range(7, 7)) ret = false;
+
+		for (int i = 0; i < 10000; ++i)
+		{
+			double d = rng.to_double();
+			if (d < 0.0 || d >= 1.0) ret = false;
+			int r = get_random_int(-5, 5);
+			if (r < -5 || r > 5) ret = false;
+		}
+	}
+
+	//
+	//	fill() / string(): 8 바이트 단위가 아닌 길이에서 경계를 넘지 않아야 한다.
+	//
+	{
+		xoshiro256ss rng(7);
+		uint8_t buf[80];
+		for (size_t len = 0; len <= 64; ++len)
+		{
+			memset(buf, 0xcc, sizeof(buf));
+			rng.fill(&buf[8], len);
+			for (size_t i = 0; i < 8; ++i)
+			{
+				if (0xcc != buf[i] || 0xcc != buf[8 + len + i]) ret = false;
+			}
+		}
+
+		char str[80];
+		wchar_t wstr[80];
+		for (size_t len = 0; len <= 64; ++len)
+		{
+			memset(str, '#', sizeof(str));
+			wmemset(wstr, L'#', _countof(wstr));
+			prng_string(str, len);
+			prng_string(wstr, len, L"ab", 2);
+			for (size_t i = 0; i < len; ++i)
+			{
+				if (nullptr == strchr(prng_alnum, str[i]) || '\0' == str[i]) ret = false;
+				if (L'a' != wstr[i] && L'b' != wstr[i]) ret = false;
+			}
+			if ('#' != str[len] || L'#' != wstr[len]) ret = false;
+		}
+
+		std::string rs = generate_random_string(33);
+		std::wstring wrs = generate_random_stringw(17);
+		if (33 != rs.size() || 17 != wrs.size()) ret = false;
+		if (!generate_random_string(0).empty()) ret = false;
+	}
+
+	//
+	//	스레드마다 다른 시드로 시작해야 한다.
+	//
+	{
+		uint64_t first[8] = { 0 };
+		std::vector<std::thread> threads;
+		for (int t = 0; t < 8; ++t)
+		{
+			threads.push_back(std::thread([t, &first]() { first[t] = prng_next(); }));
+		}
+		for (auto& thread : threads) thread.join();
+
+		std::set<uint64_t> unique(std::begin(first), std::end(first));
+		if (unique.size() != _countof(first))
+		{
+			log_err "thread-local engines share a seed." log_end;
+			ret = false;
+		}
+
+		prng_seed(99);
+		uint64_t x = prng_next();
+		prng_seed(99);
+		if (x != prng_next()) ret = false;
+	}
+
+	//
+	//	csprng_fill()
+	//
+	{
+		uint8_t key[32] = { 0 };
+		uint8_t zero[32] = { 0 };
+		if (!csprng_fill(key, sizeof(key)) || 0 == memcmp(key, zero, sizeof(key)))
+		{
+			log_err "csprng_fill() failed." log_end;
+			ret = false;
+		}
+	}
+
+	return ret;
+}
+
+/// @brief	예전 구현 (random_device + engine 생성, rand() + stringstream) 과 비교
+bool test_prng_benchmark()
+{
+	const int count = 200000;
+	StopWatch sw;
+	int64_t sink = 0;
+
+	sw.Start();
+	for (int i = 0; i < count; ++i)
+	{
+		std::random_device seed;
+		std::default_random_engine re(seed());
+		std::uniform_int_distribution<uint32_t> range(0, 1000);
+		sink += range(re);
+	}
+	sw.Stop();
+	log_info "int    legacy      : %8.2f ns/call", sw.GetDurationSecond() * 1e9 / count log_end;
+
+	sw.Start();
+	for (int i = 0; i < count; ++i)
+	{
+		sink += get_random_int(0, 1000);
+	}
+	sw.Stop();
+	log_info "int    get_random_int: %8.2f ns/call", sw.GetDurationSecond() * 1e9 / count log_end;
+
+	sw.Start();
+	xoshiro256ss& rng = prng_thread_local();
+	for (int i = 0; i < count; ++i)
+	{
+		sink += (int64_t)rng.uniform(1001);
+	}
+	sw.Stop();
+	log_info "int    uniform()   : %8.2f ns/call", sw.GetDurationSecond() * 1e9 / count log_end;
+
+	static const char alphanum[] =
+		"0123456789"
+		"ABCDEFGHIJKLMNOPQRSTUVWXYZ"
+		"abcdefghijklmnopqrstuvwxyz";
+
+	sw.Start();
+	for (int i = 0; i < count; ++i)
+	{
+		std::stringstream strm;
+		for (size_t n = 0; n < 16; ++n)
+		{
+			strm << alphanum[rand() % (sizeof(alphanum) - 1)];
+		}
+		sink += (int64_t)strm.str().size();
+	}
+	sw.Stop();
+	log_info "string legacy      : %8.2f ns/16 chars", sw.GetDurationSecond() * 1e9 / count log_end;
+
+	sw.Start();
+	for (int i = 0; i < count; ++i)
+	{
+		sink += (int64_t)generate_random_string(16).size();
+	}
+	sw.Stop();
+	log_info "string generate    : %8.2f ns/16 chars", sw.GetDurationSecond() * 1e9 / count log_end;
+
+	char name[16];
+	sw.Start();
+	for (int i = 0; i < count; ++i)
+	{
+		prng_string(name, sizeof(name));
+		sink += name[0];
+	}
+	sw.Stop();
+	log_info "string prng_string : %8.2f ns/16 chars", sw.GetDurationSecond() * 1e9 / count log_end;
+
+	std::vector<uint8_t> buf(16 * 1024 * 1024);
+	sw.Start();
+	prng_fill(buf.data(), buf.size());
+	sw.Stop();
+	log_info "fill   prng_fill   : %8.2f MB/s", buf.size() / sw.GetDurationSecond() / (1024 * 1024) log_end;
+
+	sw.Start();
+	csprng_fill(buf.data(), buf.size());
+	sw.Stop();
+	log_info "fill   csprng_fill : %8.2f MB/s", buf.size() / sw.GetDurationSecond() / (1024 * 1024) log_end;
+
+	log_info "(sink=%lld)", (long long)sink log_end;
+	return true;
+}
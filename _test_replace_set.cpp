@@ -0,0 +1,366 @@
+﻿/**
+ * @file    _test_replace_set.cpp
+ * @brief   Aho-Corasick replace_set tests and benchmark against chained find_and_replace_string.
+ *
+ * @author  Yonhgwhan, Roh (somma@somma.kr)
+ * @date    2026/10/18 created.
+ * @copyright (C)Somma, Inc. All rights reserved.
+**/
+#include "stdafx.h"
+#include "_MyLib/src/replace_set.h"
+#include "_MyLib/src/case_fold.h"
+#include "_MyLib/src/Win32Utils.h"
+#include "_MyLib/src/StopWatch.h"
+#include <random>
+#include <vector>
+
+/// @brief	비교용 단순 구현
+///			각 위치에서 매치되는 가장 긴 패턴을 치환하고, 없으면 한 문자 복사
+template <typename CharT>
+static std::basic_string<CharT> 
+ref_replace(
+	_In_ const std::basic_string<CharT>& source,
+	_In_ const std::vector<std::pair<std::basic_string<CharT>, std::basic_string<CharT>>>& pairs,
+	_In_ bool case_insensitive
+	)
+{
+	auto fold = [case_insensitive](CharT c)
+	{
+		return (case_insensitive && c >= 'A' && c <= 'Z') ? (CharT)(c + 0x20) : c;
+	};
+
+	std::basic_string<CharT> out;
+	size_t i = 0;
+	while (i < source.size())
+	{
+		size_t best = pairs.size();
+		for (size_t p = 0; p < pairs.size(); ++p)
+		{
+			const auto& find = pairs[p].first;
+			if (find.size() > source.size() - i) continue;
+			if (best != pairs.size() && find.size() <= pairs[best].first.size()) continue;
+
+			size_t k = 0;
+			while (k < find.size() && fold(source[i + k]) == fold(find[k])) ++k;
+			if (k == find.size()) best = p;
+		}
+
+		if (best == pairs.size())
+		{
+			out.push_back(source[i++]);
+		}
+		else
+		{
+			out += pairs[best].second;
+			i += pairs[best].first.size();
+		}
+	}
+	return out;
+}
+
+template <typename CharT>
+static bool 
+check_replace(
+	_In_ const std::vector<std::pair<std::basic_string<CharT>, std::basic_string<CharT>>>& pairs,
+	_In_ const std::basic_string<CharT>& source,
+	_In_ bool case_insensitive
+	)
+{
+	basic_replace_set<CharT> set(case_insensitive);
+	for (const auto& pair : pairs)
+	{
+		if (!set.add(pair.first, pair.second)) return false;
+	}
+	if (!set.compile()) return false;
+
+	return (set.replace(source) == ref_replace(source, pairs, case_insensitive));
+}
+
+bool test_replace_set()
+{
+	typedef std::vector<std::pair<std::string, std::string>> pairs_a;
+	typedef std::vector<std::pair<std::wstring, std::wstring>> pairs_w;
+
+	//
+	//	leftmost-longest
+	//
+	{
+		replace_set_a set;
+		set.add("he", "1");
+		set.add("she", "2");
+		set.add("his", "3");
+		set.add("hers", "4");
+		set.compile();
+
+		std::string out;
+		if (1 != set.replace("ushers", out) || out != "u2rs") return false;
+		if (2 != set.replace("hishers", out) || out != "34") return false;
+	}
+	{
+		replace_set_a set;
+		set.add("ab", "<ab>");
+		set.add("abc", "<abc>");
+		set.add("abcd", "<abcd>");
+		set.add("bcde", "<bcde>");
+		set.compile();
+
+		if (set.replace("xabcdex") != "x<abcd>ex") return false;	// 같은 시작이면 가장 긴 것
+		if (set.replace("xabcx") != "x<abc>x") return false;
+		if (set.replace("xbcdex") != "x<bcde>x") return false;
+		if (set.replace("abab") != "<ab><ab>") return false;
+		if (set.replace("") != "") return false;
+	}
+	{
+		//	치환 결과는 다시 검색하지 않는다.
+		replace_set_a set;
+		set.add(",", "\\,");
+		set.add("aa", "a");
+		set.compile();
+
+		std::string out;
+		if (3 != set.replace("0123456789,Version=v4,5aaa", out) || 
+			out != "0123456789\\,Version=v4\\,5aa")
+		{
+			return false;
+		}
+	}
+
+	//
+	//	add/compile 오류
+	//
+	{
+		replace_set_a set(true);
+		if (set.add("", "x")) return false;
+		if (!set.add("%SystemRoot%", "C:\\Windows")) return false;
+		if (set.add("%SYSTEMROOT%", "D:\\Windows")) return false;	// 대소문자만 다른 중복
+		if (!set.compile() || set.add("x", "y")) return false;
+
+		if (set.replace("\"%systemroot%\\system32\\svchost.exe\" -k %SystemRoot%") != 
+			"\"C:\\Windows\\system32\\svchost.exe\" -k C:\\Windows")
+		{
+			return false;
+		}
+
+		replace_set_a empty;
+		empty.compile();
+		if (empty.replace("abc") != "abc") return false;
+	}
+
+	//
+	//	wchar_t, 한글 패턴
+	//
+	{
+		replace_set_w set(true);
+		set.add(L"%UserProfile%", L"C:\\Users\\홍길동");
+		set.add(L"\\Device\\HarddiskVolume1\\", L"C:\\");
+		set.add(L"\\Device\\HarddiskVolume11\\", L"D:\\");
+		set.add(L"홍길동", L"<user>");
+		set.compile();
+
+		std::wstring out;
+		if (3 != set.replace(L"\\DEVICE\\HARDDISKVOLUME11\\Users\\홍길동\\a.txt|\\device\\harddiskvolume1\\b", out) ||
+			out != L"D:\\Users\\<user>\\a.txt|C:\\b")
+		{
+			return false;
+		}
+
+		//	치환 결과의 "홍길동" 은 다시 치환되지 않는다.
+		if (set.replace(L"%USERPROFILE%\\홍길동") != L"C:\\Users\\홍길동\\<user>") return false;
+	}
+
+	//
+	//	짧은 패턴이 계속 매치되는 동안 긴 패턴의 접두어가 이어지는 입력
+	//	(매치마다 다시 훑으면 O(n * 패턴 길이))
+	//
+	{
+		replace_set_a set;
+		set.add("a", "1");
+		set.add(std::string(999, 'a') + "b", "2");
+		set.compile();
+
+		const std::string source = std::string(100000, 'a') + "b";
+		std::string out;
+		if (100000 - 999 + 1 != set.replace(source, out) ||
+			out != std::string(100000 - 999, '1') + "2")
+		{
+			return false;
+		}
+	}
+
+	//
+	//	임의의 패턴/입력 (작은 알파벳) 으로 단순 구현과 비교
+	//
+	std::mt19937 rng(15);
+	for (int round = 0; round < 3000; ++round)
+	{
+		const bool case_insensitive = (0 == round % 2);
+		const char alphabet[] = "abAB";
+
+		pairs_a pairs_narrow;
+		pairs_w pairs_wide;
+		const size_t pattern_count = 1 + rng() % 6;
+		for (size_t p = 0; p < pattern_count; ++p)
+		{
+			std::string find;
+			const size_t len = 1 + rng() % 4;
+			for (size_t k = 0; k < len; ++k) find.push_back(alphabet[rng() % 4]);
+
+			bool duplicate = false;
+			for (const auto& pair : pairs_narrow)
+			{
+				if (case_insensitive ? equals_ci(pair.first, find) : (pair.first == find)) duplicate = true;
+			}
+			if (duplicate) continue;
+
+			const std::string replace = std::to_string(p) + "|";
+			pairs_narrow.push_back(std::make_pair(find, replace));
+			pairs_wide.push_back(std::make_pair(std::wstring(find.begin(), find.end()), 
+												std::wstring(replace.begin(), replace.end())));
+		}
+
+		//	가끔은 replace() 의 구간 (4096 글자) 보다 긴 입력
+		std::string source;
+		const size_t len = (0 == round % 100) ? 8000 + rng() % 1000 : rng() % 64;
+		for (size_t k = 0; k < len; ++k) source.push_back(alphabet[rng() % 4]);
+
+		if (!check_replace(pairs_narrow, source, case_insensitive) ||
+			!check_replace(pairs_wide, std::wstring(source.begin(), source.end()), case_insensitive))
+		{
+			log_err "replace_set mismatch. source=%s, case_insensitive=%s", 
+				source.c_str(), 
+				case_insensitive ? "true" : "false"
+				log_end;
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/// @brief	환경변수 확장/경로 변환/마스킹 패턴을 이벤트 문자열에 적용하는 시간
+///			find_and_replace_string() 을 패턴마다 호출하는 것과 비교
+bool test_replace_set_benchmark()
+{
+	std::vector<std::pair<std::wstring, std::wstring>> pairs = {
+		{ L"%SystemRoot%", L"C:\\Windows" },
+		{ L"%windir%", L"C:\\Windows" },
+		{ L"%SystemDrive%", L"C:" },
+		{ L"%ProgramFiles%", L"C:\\Program Files" },
+		{ L"%ProgramFiles(x86)%", L"C:\\Program Files (x86)" },
+		{ L"%ProgramData%", L"C:\\ProgramData" },
+		{ L"%AppData%", L"C:\\Users\\somma\\AppData\\Roaming" },
+		{ L"%LocalAppData%", L"C:\\Users\\somma\\AppData\\Local" },
+		{ L"%Temp%", L"C:\\Users\\somma\\AppData\\Local\\Temp" },
+		{ L"%UserProfile%", L"C:\\Users\\somma" },
+		{ L"%ComSpec%", L"C:\\Windows\\system32\\cmd.exe" },
+		{ L"%Public%", L"C:\\Users\\Public" },
+		{ L"\\SystemRoot\\", L"C:\\Windows\\" },
+		{ L"\\??\\", L"" },
+		{ L"password=", L"password=********" },
+		{ L"token=", L"token=********" },
+		{ L"somma@somma.kr", L"<email>" },
+		{ L"192.168.0.10", L"<ip>" },
+	};
+	for (int volume = 1; volume <= 12; ++volume)
+	{
+		pairs.push_back(std::make_pair(L"\\Device\\HarddiskVolume" + std::to_wstring(volume) + L"\\",
+									   std::wstring(1, (wchar_t)(L'B' + volume)) + L":\\"));
+	}
+
+	static const wchar_t* const fragments[] = {
+		L"\"%SystemRoot%\\system32\\svchost.exe\" -k netsvcs -p -s Schedule ",
+		L"\\Device\\HarddiskVolume3\\Program Files\\Google\\Chrome\\Application\\chrome.exe ",
+		L"--type=renderer --lang=ko --field-trial-handle=1736,i,5842193017634251203 ",
+		L"\\??\\C:\\Windows\\system32\\conhost.exe 0xffffffff -ForceV1 ",
+		L"%LocalAppData%\\Microsoft\\Teams\\current\\Teams.exe --system-initiated ",
+		L"curl https://192.168.0.10/api?token=abcdef0123456789&user=somma@somma.kr ",
+		L"\\Device\\HarddiskVolume11\\Users\\somma\\Documents\\보고서\\2026년\\회의록.docx ",
+		L"net use \\\\fileserver\\share /user:somma password=P@ssw0rd! ",
+	};
+
+	std::mt19937 rng(7);
+	std::vector<std::wstring> events;
+	size_t total = 0;
+	for (size_t i = 0; i < 20000; ++i)
+	{
+		std::wstring event;
+		const size_t count = 2 + rng() % 5;
+		for (size_t k = 0; k < count; ++k)
+		{
+			event += fragments[rng() % _countof(fragments)];
+		}
+		total += event.size();
+		events.push_back(event);
+	}
+	log_info "%zu events, %zu chars, %zu patterns", events.size(), total, pairs.size() log_end;
+
+	const int rounds = 5;
+	const double count = (double)events.size() * rounds;
+
+	//
+	//	패턴마다 find_and_replace_string()
+	//
+	size_t check_chained = 0;
+	{
+		StopWatch sw;
+		sw.Start();
+		for (int r = 0; r < rounds; ++r)
+		{
+			for (const auto& event : events)
+			{
+				std::wstring str(event);
+				for (auto& pair : pairs)
+				{
+					find_and_replace_string(str, pair.first, pair.second);
+				}
+				check_chained += str.size();
+			}
+		}
+		sw.Stop();
+
+		log_info "chained find_and_replace_string : %8.1f ns/event (check=%zu)",
+			sw.GetDurationSecond() * 1e9 / count, check_chained
+			log_end;
+	}
+
+	//
+	//	replace_set (출력 버퍼 재사용)
+	//
+	for (bool case_insensitive : { false, true })
+	{
+		replace_set_w set(case_insensitive);
+		for (const auto& pair : pairs)
+		{
+			set.add(pair.first, pair.second);
+		}
+
+		StopWatch sw;
+		sw.Start();
+		set.compile();
+		sw.Stop();
+		const double compile_us = sw.GetDurationMilliSecond() * 1000.0;
+
+		size_t check = 0;
+		std::wstring out;
+		sw.Start();
+		for (int r = 0; r < rounds; ++r)
+		{
+			for (const auto& event : events)
+			{
+				set.replace(event, out);
+				check += out.size();
+			}
+		}
+		sw.Stop();
+
+		log_info "replace_set%-20s : %8.1f ns/event (check=%zu, compile=%.1f us)",
+			case_insensitive ? " (case insensitive)" : "",
+			sw.GetDurationSecond() * 1e9 / count, 
+			check,
+			compile_us
+			log_end;
+
+		if (check != check_chained) return false;
+	}
+	return true;
+}
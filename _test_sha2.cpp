@@ -0,0 +1,157 @@
+﻿/**
+ * @file    _test_sha2.cpp
+ * @brief   sha256 block kernel (generic/avx2/sha-ni) equivalence and throughput tests.
+ *
+ * @author  Yonhgwhan, Roh (somma@somma.kr)
+ * @date    2026/10/18 created.
+ * @copyright (C)Somma, Inc. All rights reserved.
+**/
+#include "stdafx.h"
+#include "_MyLib/src/sha2.h"
+#include "_MyLib/src/StopWatch.h"
+#include <random>
+
+static const int _sha256_impls[] = {
+	SHA256_IMPL_GENERIC,
+	SHA256_IMPL_AVX2,
+	SHA256_IMPL_SHANI
+};
+
+/// @brief	data 를 chunk 단위로 잘라서 sha256_hash() 를 호출한다.
+static void
+sha256_chunked(
+	_In_ const uint8_t* data,
+	_In_ uint32_t size,
+	_In_ uint32_t chunk,
+	_Out_ uint8_t digest[SHA256_DIGEST_SIZE]
+	)
+{
+	sha256_ctx ctx;
+	sha256_begin(&ctx);
+	for (uint32_t pos = 0; pos < size; pos += chunk)
+	{
+		sha256_hash(&data[pos], min(chunk, size - pos), &ctx);
+	}
+	sha256_end(digest, &ctx);
+}
+
+/// @brief	모든 구현이 generic 구현과 동일한 digest 를 만드는지 확인한다.
+bool test_sha256_impl_equivalence()
+{
+	const uint8_t abc_digest[SHA256_DIGEST_SIZE] = {
+		0xba, 0x78, 0x16, 0xbf, 0x8f, 0x01, 0xcf, 0xea, 0x41, 0x41, 0x40, 0xde, 0x5d, 0xae, 0x22, 0x23,
+		0xb0, 0x03, 0x61, 0xa3, 0x96, 0x17, 0x7a, 0x9c, 0xb4, 0x10, 0xff, 0x61, 0xf2, 0x00, 0x15, 0xad
+	};
+
+	std::vector<uint8_t> data(64 * 1024 + 123);
+	std::mt19937 rng(0x5a2);
+	for (auto& b : data) { b = (uint8_t)rng(); }
+
+	const uint32_t chunks[] = { 1, 3, 63, 64, 65, 127, 128, 1000, 4096, 0xffffffff };
+
+	bool ret = true;
+	for (int impl : _sha256_impls)
+	{
+		if (!sha256_impl_supported(impl))
+		{
+			log_info "%s is not supported on this cpu.", sha256_impl_name(impl) log_end;
+			continue;
+		}
+
+		_ASSERTE(SHA2_GOOD == sha256_set_impl(impl));
+
+		uint8_t digest[SHA256_DIGEST_SIZE];
+		sha256(digest, (const unsigned char*)"abc", 3);
+		if (0 != memcmp(digest, abc_digest, sizeof(digest)))
+		{
+			log_err "%s, \"abc\" digest mismatch.", sha256_impl_name(impl) log_end;
+			ret = false;
+		}
+
+		for (uint32_t size = 0; size < (uint32_t)data.size(); size = size * 2 + 61)
+		{
+			for (uint32_t chunk : chunks)
+			{
+				uint8_t expected[SHA256_DIGEST_SIZE];
+				uint8_t actual[SHA256_DIGEST_SIZE];
+
+				_ASSERTE(SHA2_GOOD == sha256_set_impl(SHA256_IMPL_GENERIC));
+				sha256_chunked(data.data(), size, chunk, expected);
+
+				_ASSERTE(SHA2_GOOD == sha256_set_impl(impl));
+				sha256_chunked(data.data(), size, chunk, actual);
+
+				if (0 != memcmp(expected, actual, sizeof(expected)))
+				{
+					log_err "%s, digest mismatch. size=%u, chunk=%u",
+						sha256_impl_name(impl),
+						size,
+						chunk
+						log_end;
+					ret = false;
+				}
+			}
+		}
+	}
+
+	sha256_set_impl(SHA256_IMPL_AUTO);
+	return ret;
+}
+
+/// @brief	64 B ~ 1 GiB 입력에 대해 구현별 처리량을 측정한다.
+bool test_sha256_benchmark()
+{
+	const uint32_t buffer_size = 64 * 1024 * 1024;
+	const uint64_t sizes[] = {
+		64,
+		1024,
+		64 * 1024,
+		1024 * 1024,
+		64 * 1024 * 1024,
+		1024 * 1024 * 1024
+	};
+
+	std::vector<uint8_t> data(buffer_size);
+	std::mt19937 rng(0);
+	for (auto& b : data) { b = (uint8_t)rng(); }
+
+	for (int impl : _sha256_impls)
+	{
+		if (SHA2_GOOD != sha256_set_impl(impl)) continue;
+
+		for (uint64_t size : sizes)
+		{
+			//
+			//	작은 입력은 여러번 반복해서 측정한다. (최소 256 MB 를 처리)
+			//	1 GiB 입력은 64 MB 버퍼를 반복해서 밀어 넣는다.
+			//
+			uint64_t iterations = max((uint64_t)1, (256 * 1024 * 1024) / size);
+
+			uint8_t digest[SHA256_DIGEST_SIZE];
+			StopWatch sw;
+			sw.Start();
+			for (uint64_t i = 0; i < iterations; ++i)
+			{
+				sha256_ctx ctx;
+				sha256_begin(&ctx);
+				for (uint64_t pos = 0; pos < size; pos += buffer_size)
+				{
+					sha256_hash(data.data(), (unsigned long)min((uint64_t)buffer_size, size - pos), &ctx);
+				}
+				sha256_end(digest, &ctx);
+			}
+			sw.Stop();
+
+			double mb = (double)(size * iterations) / (1024.0 * 1024.0);
+			log_info "%-8s size=%11llu, iterations=%8llu, %10.2f MB/s",
+				sha256_impl_name(impl),
+				size,
+				iterations,
+				mb / sw.GetDurationSecond()
+				log_end;
+		}
+	}
+
+	sha256_set_impl(SHA256_IMPL_AUTO);
+	return true;
+}
@@ -10,6 +10,8 @@
 #include "stdafx.h"
 #include "_MyLib/src/AirCrypto.h"
 #include "_MyLib/src/openssl_leak_checker.h"
+#include "_MyLib/src/StopWatch.h"
+#include <thread>
 
 /// @brief aes256_crypt_buffer_v2() 함수 테스트 (보안 강화 함수)
 bool test_aes256_crypt_buffer_v2()
@@ -320,3 +322,556 @@ bool test_aes256_encrypt_decrypt_file()
     checker.check_for_leaks("aes256_encrypt_file");
     return ret;
 }
+
+/// @brief	aes256_crypt_file_stream() 이 aes256_crypt_buffer_v2() 와 같은 결과를 
+///			만드는지 (v2 포맷 호환), 버퍼 크기/double buffering 조합별로 확인한다.
+bool test_aes256_crypt_file_stream()
+{
+    const unsigned char key[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ1234567890*!=&?&/";
+    const uint32_t key_len = (uint32_t)strlen((const char*)key);
+    const std::wstring dir = L"C:\\_test_aes256_stream";
+    const std::wstring plain_path = dir + L"\\plain.bin";
+    const std::wstring crypt_path = dir + L"\\plain.bin.crypto";
+    const std::wstring decrypt_path = dir + L"\\plain.bin.decrypted";
+
+    const uint32_t sizes[] = { 1, 15, 16, 4095, 4096, 4097, 1024 * 1024 + 3, 20 * 1024 * 1024 };
+    const uint32_t buffer_sizes[] = { 4 * 1024, 64 * 1024, AES256_STREAM_DEFAULT_BUFFER_SIZE };
+
+    WUDeleteDirectoryW(dir.c_str());
+    WUCreateDirectory(dir.c_str());
+
+    bool ret = true;
+    for (uint32_t size : sizes)
+    {
+        std::vector<unsigned char> plain(size);
+        for (uint32_t i = 0; i < size; ++i) { plain[i] = (unsigned char)(i * 31 + 7); }
+
+        if (!SaveBinaryFile(dir.c_str(), L"plain.bin", size, plain.data()))
+        {
+            log_err "SaveBinaryFile() failed." log_end;
+            ret = false;
+            break;
+        }
+
+        unsigned char* expected = nullptr;
+        uint32_t expected_len = 0;
+        if (!aes256_crypt_buffer_v2(key, key_len, plain.data(), size, expected, expected_len, true))
+        {
+            log_err "aes256_crypt_buffer_v2() failed." log_end;
+            ret = false;
+            break;
+        }
+        char_ptr expected_ptr((char*)expected, [](char* p) { free(p); });
+
+        for (uint32_t buffer_size : buffer_sizes)
+        {
+            for (bool double_buffering : { false, true })
+            {
+                aes256_stream_options options;
+                options.buffer_size = buffer_size;
+                options.double_buffering = double_buffering;
+
+                PBYTE encrypted = nullptr;
+                PBYTE decrypted = nullptr;
+                DWORD encrypted_len = 0;
+                DWORD decrypted_len = 0;
+                if (!aes256_encrypt_file(key, plain_path, crypt_path, options) ||
+                    !aes256_decrypt_file(key, crypt_path, decrypt_path, options) ||
+                    !LoadFileToMemory(crypt_path.c_str(), encrypted_len, encrypted) ||
+                    !LoadFileToMemory(decrypt_path.c_str(), decrypted_len, decrypted))
+                {
+                    log_err "stream crypt failed. size=%u, buffer=%u, double=%d",
+                        size, buffer_size, double_buffering
+                        log_end;
+                    ret = false;
+                    continue;
+                }
+
+                if (encrypted_len != expected_len ||
+                    0 != memcmp(encrypted, expected, expected_len) ||
+                    decrypted_len != size ||
+                    0 != memcmp(decrypted, plain.data(), size))
+                {
+                    log_err "stream crypt mismatch. size=%u, buffer=%u, double=%d",
+                        size, buffer_size, double_buffering
+                        log_end;
+                    ret = false;
+                }
+                free(encrypted);
+                free(decrypted);
+            }
+        }
+
+        //
+        //  입력과 출력이 같은 파일 (in-place)
+        //  같은 문자열은 aes256_encrypt_file() 이 거부하므로 대소문자만 다른 경로를 쓴다.
+        //
+        const std::wstring alias_path = dir + L"\\PLAIN.BIN";
+        PBYTE encrypted = nullptr;
+        PBYTE decrypted = nullptr;
+        DWORD encrypted_len = 0;
+        DWORD decrypted_len = 0;
+        if (!aes256_encrypt_file(key, plain_path, alias_path) ||
+            !LoadFileToMemory(plain_path.c_str(), encrypted_len, encrypted) ||
+            !aes256_decrypt_file(key, alias_path, plain_path) ||
+            !LoadFileToMemory(plain_path.c_str(), decrypted_len, decrypted))
+        {
+            log_err "in-place stream crypt failed. size=%u", size log_end;
+            ret = false;
+            continue;
+        }
+
+        if (encrypted_len != expected_len ||
+            0 != memcmp(encrypted, expected, expected_len) ||
+            decrypted_len != size ||
+            0 != memcmp(decrypted, plain.data(), size))
+        {
+            log_err "in-place stream crypt mismatch. size=%u", size log_end;
+            ret = false;
+        }
+        free(encrypted);
+        free(decrypted);
+    }
+
+    WUDeleteDirectoryW(dir.c_str());
+    return ret;
+}
+
+/// @brief	aes256_gcm_crypt_buffer() 왕복, 스레드 수와 무관한 복호화, 
+///			변조/잘라내기/순서 변경 탐지를 확인한다.
+bool test_aes256_gcm_crypt_buffer()
+{
+    const unsigned char key[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ1234567890*!=&?&/";
+    const uint32_t key_len = (uint32_t)strlen((const char*)key);
+    const uint32_t segment_size = AES256_GCM_MIN_SEGMENT_SIZE;
+    const size_t sizes[] = { 0, 1, 15, segment_size - 1, segment_size, segment_size + 1, 7 * segment_size + 13 };
+    const uint32_t thread_counts[] = { 1, 4 };
+
+    aes256_gcm_options options;
+    options.segment_size = segment_size;
+
+    for (size_t size : sizes)
+    {
+        std::vector<unsigned char> plain(size);
+        for (size_t i = 0; i < size; ++i) { plain[i] = (unsigned char)(i * 31 + 7); }
+
+        for (uint32_t thread_count : thread_counts)
+        {
+            options.thread_count = thread_count;
+
+            unsigned char* encrypted = nullptr;
+            size_t encrypted_len = 0;
+            if (!aes256_gcm_crypt_buffer(key, key_len, plain.data(), size, encrypted, encrypted_len, true, options))
+            {
+                log_err "aes256_gcm_crypt_buffer(encrypt) failed. size=%zu", size log_end;
+                return false;
+            }
+            char_ptr encrypted_ptr((char*)encrypted, [](char* p) { free(p); });
+
+            if (encrypted_len != aes256_gcm_encrypted_length(size, segment_size) ||
+                !is_aes256_gcm_buffer(encrypted, encrypted_len))
+            {
+                log_err "invalid encrypted buffer. size=%zu, len=%zu", size, encrypted_len log_end;
+                return false;
+            }
+
+            //
+            //  다른 스레드 수로 복호화해도 결과는 같아야 한다.
+            //
+            aes256_gcm_options decrypt_options;
+            decrypt_options.thread_count = (1 == thread_count) ? 4 : 1;
+
+            unsigned char* decrypted = nullptr;
+            size_t decrypted_len = 0;
+            if (!aes256_gcm_crypt_buffer(key, key_len, encrypted, encrypted_len, decrypted, decrypted_len, false, decrypt_options))
+            {
+                log_err "aes256_gcm_crypt_buffer(decrypt) failed. size=%zu", size log_end;
+                return false;
+            }
+            char_ptr decrypted_ptr((char*)decrypted, [](char* p) { free(p); });
+
+            if (decrypted_len != size || (0 < size && 0 != memcmp(decrypted, plain.data(), size)))
+            {
+                log_err "decrypted data mismatch. size=%zu", size log_end;
+                return false;
+            }
+        }
+
+        //
+        //  변조 탐지 
+        //
+        unsigned char* encrypted = nullptr;
+        size_t encrypted_len = 0;
+        if (!aes256_gcm_crypt_buffer(key, key_len, plain.data(), size, encrypted, encrypted_len, true, options))
+        {
+            return false;
+        }
+        std::vector<unsigned char> sealed(encrypted, encrypted + encrypted_len);
+        free(encrypted);
+
+        auto must_fail = [&](_In_ const std::vector<unsigned char>& tampered, _In_ const char* what) -> bool
+        {
+            unsigned char* out = nullptr;
+            size_t out_len = 0;
+            if (aes256_gcm_crypt_buffer(key, key_len, tampered.data(), tampered.size(), out, out_len, false, options))
+            {
+                free(out);
+                log_err "tampered buffer decrypted. size=%zu, %s", size, what log_end;
+                return false;
+            }
+            return (nullptr == out);
+        };
+
+        std::vector<unsigned char> tampered = sealed;
+        tampered[AES256_GCM_HEADER_SIZE] ^= 0x01;                   // 첫 세그먼트 (또는 tag)
+        if (!must_fail(tampered, "segment")) return false;
+
+        tampered = sealed;
+        tampered[tampered.size() - 1] ^= 0x80;                      // 마지막 tag
+        if (!must_fail(tampered, "tag")) return false;
+
+        tampered = sealed;
+        ((paes256_gcm_header)tampered.data())->reserved[0] ^= 0x01; // 헤더
+        if (!must_fail(tampered, "header")) return false;
+
+        tampered = sealed;
+        tampered.resize(tampered.size() - 1);                       // 잘라내기
+        if (!must_fail(tampered, "truncate")) return false;
+
+        unsigned char wrong_key[] = "wrong passphrase";
+        unsigned char* out = nullptr;
+        size_t out_len = 0;
+        if (aes256_gcm_crypt_buffer(wrong_key, (uint32_t)strlen((const char*)wrong_key), sealed.data(), sealed.size(), out, out_len, false))
+        {
+            free(out);
+            log_err "decrypted with wrong key. size=%zu", size log_end;
+            return false;
+        }
+
+        if (size > 2 * segment_size)
+        {
+            //
+            //  세그먼트 0, 1 순서 변경 
+            //
+            const size_t unit = segment_size + AES256_GCM_TAG_SIZE;
+            tampered = sealed;
+            std::swap_ranges(tampered.begin() + AES256_GCM_HEADER_SIZE,
+                             tampered.begin() + AES256_GCM_HEADER_SIZE + unit,
+                             tampered.begin() + AES256_GCM_HEADER_SIZE + unit);
+            if (!must_fail(tampered, "reorder")) return false;
+
+            //
+            //  마지막 세그먼트를 제거하고 헤더의 길이를 맞춰도 실패해야 한다.
+            //
+            const size_t segments = (size + segment_size - 1) / segment_size;
+            tampered.assign(sealed.begin(), sealed.begin() + AES256_GCM_HEADER_SIZE + (segments - 1) * unit);
+            ((paes256_gcm_header)tampered.data())->plaintext_length = (segments - 1) * segment_size;
+            if (!must_fail(tampered, "drop last segment")) return false;
+        }
+    }
+
+    //
+    //  CBC (v2) 버퍼는 GCM 버퍼로 인식되면 안된다.
+    //
+    unsigned char* cbc = nullptr;
+    uint32_t cbc_len = 0;
+    if (!aes256_crypt_buffer_v2(key, key_len, key, key_len, cbc, cbc_len, true))
+    {
+        return false;
+    }
+    bool is_gcm = is_aes256_gcm_buffer(cbc, cbc_len);
+    free(cbc);
+    if (is_gcm)
+    {
+        log_err "cbc buffer detected as gcm buffer." log_end;
+        return false;
+    }
+    return true;
+}
+
+/// @brief	64 MB 버퍼에 대해 CBC (v2) 와 GCM bulk mode (스레드 수별) 처리량 비교
+bool test_aes256_gcm_benchmark()
+{
+    const unsigned char key[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ1234567890*!=&?&/";
+    const uint32_t key_len = (uint32_t)strlen((const char*)key);
+    const uint32_t size = 64 * 1024 * 1024;
+
+    std::vector<unsigned char> plain(size);
+    for (uint32_t i = 0; i < size; ++i) { plain[i] = (unsigned char)(i * 31 + 7); }
+
+    StopWatch sw;
+    sw.Start();
+    unsigned char* cbc = nullptr;
+    uint32_t cbc_len = 0;
+    if (!aes256_crypt_buffer_v2(key, key_len, plain.data(), size, cbc, cbc_len, true))
+    {
+        return false;
+    }
+    sw.Stop();
+    free(cbc);
+    log_info "cbc (v2)      : %.2f MB/s", (size / (1024.0 * 1024.0)) / sw.GetDurationSecond() log_end;
+
+    const uint32_t hw = max(std::thread::hardware_concurrency(), (unsigned int)1);
+    for (uint32_t thread_count : { (uint32_t)1, (uint32_t)2, (uint32_t)4, hw })
+    {
+        aes256_gcm_options options;
+        options.thread_count = thread_count;
+
+        sw.Start();
+        unsigned char* encrypted = nullptr;
+        size_t encrypted_len = 0;
+        if (!aes256_gcm_crypt_buffer(key, key_len, plain.data(), size, encrypted, encrypted_len, true, options))
+        {
+            return false;
+        }
+        sw.Stop();
+        const double encrypt_sec = sw.GetDurationSecond();
+
+        sw.Start();
+        unsigned char* decrypted = nullptr;
+        size_t decrypted_len = 0;
+        bool ok = aes256_gcm_crypt_buffer(key, key_len, encrypted, encrypted_len, decrypted, decrypted_len, false, options);
+        sw.Stop();
+        free(encrypted);
+        if (!ok) return false;
+        free(decrypted);
+
+        log_info "gcm %2u threads: encrypt %.2f MB/s, decrypt %.2f MB/s (includes kdf)",
+            thread_count,
+            (size / (1024.0 * 1024.0)) / encrypt_sec,
+            (size / (1024.0 * 1024.0)) / sw.GetDurationSecond()
+            log_end;
+    }
+    return true;
+}
+
+/// @brief	aes256_session 의 출력이 aes256_crypt_buffer_v2() 와 같은지,
+///			호출자 버퍼/vector/encrypt_many() 로 왕복이 되는지 확인한다.
+bool test_aes256_session()
+{
+    const unsigned char key[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ1234567890*!=&?&/";
+    const uint32_t key_len = (uint32_t)strlen((const char*)key);
+    const uint32_t sizes[] = { 1, 15, 16, 17, 255, 256, 1000, 4096, 65537 };
+
+    aes256_session session;
+    if (!session.initialize(key, key_len))
+    {
+        log_err "aes256_session::initialize() failed." log_end;
+        return false;
+    }
+
+    std::vector<std::vector<unsigned char>> plains;
+    std::vector<aes256_record> records;
+    for (uint32_t size : sizes)
+    {
+        std::vector<unsigned char> plain(size);
+        for (uint32_t i = 0; i < size; ++i) { plain[i] = (unsigned char)(i * 31 + size); }
+        plains.push_back(plain);
+    }
+    for (const auto& plain : plains)
+    {
+        aes256_record record = { plain.data(), (uint32_t)plain.size() };
+        records.push_back(record);
+    }
+
+    std::vector<unsigned char> encrypted;
+    std::vector<unsigned char> decrypted;
+    for (const auto& plain : plains)
+    {
+        const uint32_t size = (uint32_t)plain.size();
+
+        unsigned char* expected = nullptr;
+        uint32_t expected_len = 0;
+        if (!aes256_crypt_buffer_v2(key, key_len, plain.data(), size, expected, expected_len, true))
+        {
+            return false;
+        }
+        char_ptr expected_ptr((char*)expected, [](char* p) { free(p); });
+
+        //
+        //  vector 출력 (같은 세션으로 반복해도 결과가 같아야 한다)
+        //
+        for (int i = 0; i < 2; ++i)
+        {
+            if (!session.encrypt(plain.data(), size, encrypted) ||
+                encrypted.size() != expected_len ||
+                0 != memcmp(encrypted.data(), expected, expected_len))
+            {
+                log_err "session encrypt mismatch with v2. size=%u", size log_end;
+                return false;
+            }
+        }
+
+        if (!session.decrypt(encrypted.data(), (uint32_t)encrypted.size(), decrypted) ||
+            decrypted != plain)
+        {
+            log_err "session decrypt failed. size=%u", size log_end;
+            return false;
+        }
+
+        //
+        //  호출자 버퍼 출력
+        //
+        std::vector<unsigned char> buffer(aes256_session::encrypted_length(size));
+        uint32_t length = 0;
+        if (!session.encrypt(plain.data(), size, buffer.data(), (uint32_t)buffer.size(), length) ||
+            length != expected_len ||
+            0 != memcmp(buffer.data(), expected, expected_len))
+        {
+            log_err "session encrypt (caller buffer) failed. size=%u", size log_end;
+            return false;
+        }
+        if (session.encrypt(plain.data(), size, buffer.data(), (uint32_t)buffer.size() - 1, length))
+        {
+            log_err "small output buffer accepted. size=%u", size log_end;
+            return false;
+        }
+    }
+
+    //
+    //  패딩을 더하면 넘치거나 int 범위를 넘는 길이는 EVP 를 호출하기 전에 거부한다.
+    //  (입력은 읽지 않으므로 작은 버퍼로 확인한다)
+    //
+    {
+        if (0 != aes256_session::encrypted_length(0xfffffff0) ||
+            0 != aes256_session::encrypted_length(aes256_session::max_input_length + 1) ||
+            0 == aes256_session::encrypted_length(aes256_session::max_input_length))
+        {
+            log_err "encrypted_length() overflow check failed." log_end;
+            return false;
+        }
+
+        unsigned char small[32] = { 0 };
+        uint32_t length = 0;
+        std::vector<unsigned char> out;
+        const aes256_record huge = { small, 0xfffffff0 };
+        std::vector<aes256_record> huge_results;
+        if (session.encrypt(small, 0xfffffff0, small, sizeof(small), length) ||
+            session.decrypt(small, 0x80000000, small, sizeof(small), length) ||
+            session.encrypt(small, 0xfffffff0, out) ||
+            session.encrypt_many(&huge, 1, huge_results))
+        {
+            log_err "oversized input accepted." log_end;
+            return false;
+        }
+    }
+
+    //
+    //  encrypt_many() / decrypt_many()
+    //
+    std::vector<aes256_record> sealed;
+    if (!session.encrypt_many(records.data(), records.size(), sealed) ||
+        sealed.size() != records.size())
+    {
+        log_err "encrypt_many() failed." log_end;
+        return false;
+    }
+
+    std::vector<std::vector<unsigned char>> copies;
+    std::vector<aes256_record> sealed_records;
+    for (const auto& r : sealed)
+    {
+        copies.push_back(std::vector<unsigned char>(r.data, r.data + r.length));
+    }
+    for (const auto& c : copies)
+    {
+        aes256_record record = { c.data(), (uint32_t)c.size() };
+        sealed_records.push_back(record);
+    }
+
+    std::vector<aes256_record> opened;
+    if (!session.decrypt_many(sealed_records.data(), sealed_records.size(), opened) ||
+        opened.size() != plains.size())
+    {
+        log_err "decrypt_many() failed." log_end;
+        return false;
+    }
+    for (size_t i = 0; i < plains.size(); ++i)
+    {
+        if (opened[i].length != plains[i].size() ||
+            0 != memcmp(opened[i].data, plains[i].data(), opened[i].length))
+        {
+            log_err "decrypt_many() mismatch. index=%zu", i log_end;
+            return false;
+        }
+    }
+
+    //
+    //  다른 salt 를 쓰는 세션은 다른 암호문을 만들고, 같은 salt 로만 복호화 된다.
+    //
+    const unsigned char salt[8] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+    aes256_session salted;
+    aes256_session salted2;
+    if (!salted.initialize(key, key_len, salt) || !salted2.initialize(key, key_len, salt))
+    {
+        return false;
+    }
+    if (!salted.encrypt(plains[4].data(), (uint32_t)plains[4].size(), encrypted) ||
+        encrypted == copies[4] ||
+        !salted2.decrypt(encrypted.data(), (uint32_t)encrypted.size(), decrypted) ||
+        decrypted != plains[4])
+    {
+        log_err "salted session failed." log_end;
+        return false;
+    }
+    return true;
+}
+
+/// @brief	256 B ~ 4 KB 레코드에 대해 aes256_crypt_buffer_v2() 와 
+///			aes256_session (encrypt, encrypt_many) 의 records/sec 비교
+bool test_aes256_session_benchmark()
+{
+    const unsigned char key[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ1234567890*!=&?&/";
+    const uint32_t key_len = (uint32_t)strlen((const char*)key);
+    const uint32_t record_count = 20000;
+    const uint32_t batch_size = 64;
+
+    aes256_session session;
+    if (!session.initialize(key, key_len)) return false;
+
+    StopWatch sw;
+    for (uint32_t size : { 256, 512, 1024, 2048, 4096 })
+    {
+        std::vector<unsigned char> plain(size, 0x5a);
+
+        sw.Start();
+        for (uint32_t i = 0; i < record_count; ++i)
+        {
+            unsigned char* out = nullptr;
+            uint32_t out_len = 0;
+            if (!aes256_crypt_buffer_v2(key, key_len, plain.data(), size, out, out_len, true)) return false;
+            free(out);
+        }
+        sw.Stop();
+        const double v2_sec = sw.GetDurationSecond();
+
+        std::vector<unsigned char> buffer(aes256_session::encrypted_length(size));
+        sw.Start();
+        for (uint32_t i = 0; i < record_count; ++i)
+        {
+            uint32_t out_len = 0;
+            if (!session.encrypt(plain.data(), size, buffer.data(), (uint32_t)buffer.size(), out_len)) return false;
+        }
+        sw.Stop();
+        const double session_sec = sw.GetDurationSecond();
+
+        std::vector<aes256_record> records(batch_size);
+        for (auto& r : records) { r.data = plain.data(); r.length = size; }
+        std::vector<aes256_record> results;
+        sw.Start();
+        for (uint32_t i = 0; i < record_count; i += batch_size)
+        {
+            if (!session.encrypt_many(records.data(), records.size(), results)) return false;
+        }
+        sw.Stop();
+        const double many_sec = sw.GetDurationSecond();
+
+        log_info "%4u bytes: v2 %9.0f rec/s, session %9.0f rec/s, encrypt_many %9.0f rec/s",
+            size,
+            record_count / v2_sec,
+            record_count / session_sec,
+            ((record_count + batch_size - 1) / batch_size * batch_size) / many_sec
+            log_end;
+    }
+    return true;
+}
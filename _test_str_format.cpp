@@ -0,0 +1,196 @@
+﻿/**
+ * @file    _test_str_format.cpp
+ * @brief   format_to/format_append/format_tls/format_buffer correctness, compile-time checks and multi-thread tests.
+ *
+ * @author  Yonhgwhan, Roh (somma@somma.kr)
+ * @date    2026/10/18 created.
+ * @copyright (C)Somma, Inc. All rights reserved.
+**/
+#include "stdafx.h"
+#include "_MyLib/src/str_format.h"
+#include "_MyLib/src/Win32Utils.h"
+#include "_MyLib/src/StopWatch.h"
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <functional>
+
+//
+//	컴파일 시간 검사: 맞는 형식과 틀린 형식
+//
+#define FORMAT_VALID(fmt, ...) \
+	format_checker::check(fmt, decltype(format_checker::types(__VA_ARGS__))())
+
+static_assert(FORMAT_VALID("plain"), "");
+static_assert(FORMAT_VALID("%d %u %x %5.2f %s %ws %ls %p %c %%", 1, 2u, (short)3, 1.0, "s", L"w", L"l", (void*)0, 'c'), "");
+static_assert(FORMAT_VALID("%llu %lld %I64x %zu %Iu %I32d", (uint64_t)1, (int64_t)1, (uint64_t)1, (size_t)1, (size_t)1, 1), "");
+static_assert(FORMAT_VALID("%-*.*s|%08.3e", 10, 3, "abc", 2.5), "");
+static_assert(FORMAT_VALID("%hs %S %p", "narrow", L"wide", "p"), "");
+static_assert(!FORMAT_VALID("%d"), "missing argument");
+static_assert(!FORMAT_VALID("%d", 1, 2), "extra argument");
+static_assert(!FORMAT_VALID("%s", 1), "integer for string");
+static_assert(!FORMAT_VALID("%s", L"wide"), "wide string for %s");
+static_assert(!FORMAT_VALID("%ws", "narrow"), "narrow string for %ws");
+static_assert(!FORMAT_VALID("%s", std::string()), "class type");
+static_assert(!FORMAT_VALID("%d", (uint64_t)1), "64 bit integer for %d");
+static_assert(!FORMAT_VALID("%llu", 1), "32 bit integer for %llu");
+static_assert(!FORMAT_VALID("%f", 1), "integer for %f");
+static_assert(!FORMAT_VALID("%n", (int*)0), "%n");
+static_assert(!FORMAT_VALID("%", 1), "truncated conversion");
+static_assert(!FORMAT_VALID("%*d", (size_t)1, 1), "size_t width");
+
+/// @brief	버퍼 크기, spill, 스레드별 버퍼, 예전 format_string() 을 확인한다.
+bool test_str_format()
+{
+	bool ret = true;
+
+	//
+	//	format_to: vsnprintf 와 같은 의미 (잘라서 쓰고 필요한 길이를 리턴)
+	//
+	char small[8];
+	if (10 != FORMAT_TO(small, sizeof(small), "%s-%d", "hello", 1234) || 0 != strcmp(small, "hello-1"))
+	{
+		log_err "format_to() truncation mismatch. buf=%s", small log_end;
+		ret = false;
+	}
+	if (3 != FORMAT_TO(small, sizeof(small), "%d", 123) || 0 != strcmp(small, "123")) ret = false;
+	if (5 != FORMAT_TO(nullptr, 0, "%s", "12345")) ret = false;
+
+	//
+	//	format_append: 스택 버퍼보다 긴 결과 포함
+	//
+	std::string out = "head:";
+	const std::string long_str(3000, 'x');
+	if (!FORMAT_APPEND(out, "%s|%d", long_str.c_str(), 7) || out != "head:" + long_str + "|7") ret = false;
+	if (!FORMAT_APPEND(out, "!") || out != "head:" + long_str + "|7!") ret = false;
+
+	//
+	//	format_buffer: 내부 배열 -> spill -> clear 후 재사용
+	//
+	format_buffer<16> buf;
+	if (!FORMAT_APPEND(buf, "%d", 123456789) || buf.spilled() || 0 != strcmp(buf.c_str(), "123456789")) ret = false;
+	if (!FORMAT_APPEND(buf, "-%s", "abcdefghij") || !buf.spilled() || buf.str() != "123456789-abcdefghij")
+	{
+		log_err "format_buffer spill mismatch. buf=%s", buf.c_str() log_end;
+		ret = false;
+	}
+	buf.append_raw("++", 2);
+	if (buf.str() != "123456789-abcdefghij++") ret = false;
+	buf.clear();
+	if (!buf.empty() || buf.spilled() || !FORMAT_APPEND(buf, "%c", 'z') || buf.str() != "z") ret = false;
+	buf.append_raw("0123456789abcdef", 16);
+	if (!buf.spilled() || buf.str() != "z0123456789abcdef") ret = false;
+
+	//
+	//	예전 format_string(): 배열 전체 사용 (예전에는 8 바이트까지만 썼음)
+	//
+	char arr[64];
+	if (!format_string(arr, "%s %d", "format_string", 42) || 0 != strcmp(arr, "format_string 42"))
+	{
+		log_err "format_string(buf) mismatch. buf=%s", arr log_end;
+		ret = false;
+	}
+	if (format_string(small, "%s", "too long for small")) ret = false;
+	if (!format_string(arr, sizeof(arr), "%u", 7u) || 0 != strcmp(arr, "7")) ret = false;
+
+	const char* s = format_string("%s/%d", long_str.c_str(), 1);
+	if (nullptr == s || long_str + "/1" != s)
+	{
+		log_err "format_string() long result mismatch." log_end;
+		ret = false;
+	}
+
+	//
+	//	format_tls: 여러 스레드에서 동시에 포맷팅해도 결과가 섞이지 않아야 한다.
+	//
+	std::atomic<int> corrupted(0);
+	std::vector<std::thread> threads;
+	for (int t = 0; t < 16; ++t)
+	{
+		threads.push_back(std::thread([t, &corrupted]()
+		{
+			char expected[64];
+			for (int i = 0; i < 20000; ++i)
+			{
+				format_to(expected, sizeof(expected), "thread=%d, seq=%d", t, i);
+				const char* p = format_string("thread=%d, seq=%d", t, i);
+				if (nullptr == p || 0 != strcmp(p, expected)) ++corrupted;
+			}
+		}));
+	}
+	for (auto& thread : threads) thread.join();
+	if (0 != corrupted)
+	{
+		log_err "format_string() corrupted. count=%d", corrupted.load() log_end;
+		ret = false;
+	}
+
+	return ret;
+}
+
+/// @brief	16 스레드에서 이벤트 한줄 포맷팅 (ns/event)
+///			예전 방식 (static 버퍼 + 락 + string 복사) / format_tls / format_buffer
+bool test_str_format_benchmark()
+{
+	const int thread_count = 16;
+	const int count = 200000;
+	static char legacy_buf[2048];
+	std::mutex legacy_lock;
+
+	auto run = [&](const char* name, std::function<void(int, int, size_t&)> body)
+	{
+		size_t total = 0;
+		std::mutex total_lock;
+		std::vector<std::thread> threads;
+		StopWatch sw;
+		sw.Start();
+		for (int t = 0; t < thread_count; ++t)
+		{
+			threads.push_back(std::thread([&, t]()
+			{
+				size_t len = 0;
+				for (int i = 0; i < count; ++i)
+				{
+					body(t, i, len);
+				}
+				std::lock_guard<std::mutex> lock(total_lock);
+				total += len;
+			}));
+		}
+		for (auto& thread : threads) thread.join();
+		sw.Stop();
+
+		log_info "%-14s: %8.2f ns/event (%d threads), %zu bytes",
+			name,
+			sw.GetDurationSecond() * 1e9 / ((double)thread_count * count),
+			thread_count,
+			total
+			log_end;
+	};
+
+	run("legacy", [&](int t, int i, size_t& len)
+	{
+		std::string line;
+		{
+			std::lock_guard<std::mutex> lock(legacy_lock);
+			snprintf(legacy_buf, sizeof(legacy_buf), "pid=%u, tid=%d, seq=%d, path=%s", 1234u, t, i, "C:\\Windows\\System32\\svchost.exe");
+			line = legacy_buf;
+		}
+		len += line.size();
+	});
+
+	run("format_tls", [&](int t, int i, size_t& len)
+	{
+		const char* line = FORMAT_TLS("pid=%u, tid=%d, seq=%d, path=%s", 1234u, t, i, "C:\\Windows\\System32\\svchost.exe");
+		len += strlen(line);
+	});
+
+	run("format_buffer", [&](int t, int i, size_t& len)
+	{
+		format_buffer<256> line;
+		FORMAT_APPEND(line, "pid=%u, tid=%d, seq=%d, path=%s", 1234u, t, i, "C:\\Windows\\System32\\svchost.exe");
+		len += line.size();
+	});
+
+	return true;
+}
@@ -0,0 +1,249 @@
+﻿/**
+ * @file    _test_string_tokenizer.cpp
+ * @brief   string_view tokenizer / small_vector tests and split benchmark.
+ *
+ * @author  Yonhgwhan, Roh (somma@somma.kr)
+ * @date    2026/10/18 created.
+ * @copyright (C)Somma, Inc. All rights reserved.
+**/
+#include "stdafx.h"
+#include "_MyLib/src/string_tokenizer.h"
+#include "_MyLib/src/Win32Utils.h"
+#include "_MyLib/src/StopWatch.h"
+#include <vector>
+#include <list>
+
+/// @brief	예전 split_string_a() 구현 (비교용)
+static
+std::list<std::string>
+legacy_split_string_a(
+	_In_ const std::string source,
+	_In_ const std::string token,
+	_In_ const bool remove_space
+	)
+{
+	if (source.empty()) return std::list<std::string>();
+	if (token.empty() || source.size() <= token.size())
+	{
+		return std::list<std::string>{ source };
+	}
+
+	std::list<std::string> out;
+	size_t pos_s = 0;
+	size_t pos_e = source.find(token);
+	while (pos_e != std::string::npos)
+	{
+		auto s = source.substr(pos_s, pos_e - pos_s);
+		if (true != s.empty())
+		{
+			if (true == remove_space && token != " ")
+			{
+				s = trima(s, " ");
+			}
+			out.push_back(s);
+		}
+
+		pos_s = pos_e + token.size();
+		pos_e = source.find(token, pos_s);
+	}
+
+	auto remain = source.substr(pos_s, pos_e - pos_s);
+	if (true != remain.empty())
+	{
+		if (true == remove_space && token != " ")
+		{
+			remain = trima(remain, " ");
+		}
+		out.push_back(remain);
+	}
+	return out;
+}
+
+template <typename range_type>
+static std::vector<std::string> to_vector(const range_type& range)
+{
+	std::vector<std::string> out;
+	for (const auto& token : range)
+	{
+		out.push_back(std::string(token));
+	}
+	return out;
+}
+
+bool test_string_tokenizer()
+{
+	typedef std::vector<std::string> strings;
+
+	//
+	//	한 문자 / 여러 문자 구분자, trim, 빈 토큰
+	//
+	if (to_vector(tokenize("a,b,,c,", ",")) != strings({ "a", "b", "c" })) return false;
+	if (to_vector(tokenize("a,b,,c,", ",", TOKEN_KEEP_EMPTY)) != strings({ "a", "b", "", "c", "" })) return false;
+	if (to_vector(tokenize(",", ",", TOKEN_KEEP_EMPTY)) != strings({ "", "" })) return false;
+	if (to_vector(tokenize("", ",")) != strings()) return false;
+	if (to_vector(tokenize("", ",", TOKEN_KEEP_EMPTY)) != strings({ "" })) return false;
+	if (to_vector(tokenize("abc", "")) != strings({ "abc" })) return false;
+	if (to_vector(tokenize("abc", ",")) != strings({ "abc" })) return false;
+	if (to_vector(tokenize("a::b:c::::d", "::")) != strings({ "a", "b:c", "d" })) return false;
+	if (to_vector(tokenize(" a \t| b|\r\n |c ", "|", TOKEN_TRIM)) != strings({ "a", "b", "c" })) return false;
+	if (to_vector(tokenize(" a | |c", "|", TOKEN_TRIM | TOKEN_KEEP_EMPTY)) != strings({ "a", "", "c" })) return false;
+
+	std::vector<std::wstring> wtokens;
+	for (auto token : tokenize(L"c:\\windows\\system32\\drivers", L"\\"))
+	{
+		wtokens.push_back(std::wstring(token));
+	}
+	if (wtokens != std::vector<std::wstring>({ L"c:", L"windows", L"system32", L"drivers" })) return false;
+
+	//
+	//	view 는 source 를 가리켜야 한다. (복사 없음)
+	//
+	const std::string source = "abc def";
+	for (auto token : tokenize(source, " "))
+	{
+		if (token.data() < source.data() || token.data() + token.size() > source.data() + source.size())
+		{
+			return false;
+		}
+	}
+
+	//
+	//	extract_token_view 는 extract_*_tokenExA() 와 같은 결과
+	//
+	const char* org = "ABCDEFG.HIJ.KLMN";
+	for (bool first : { true, false })
+	{
+		for (bool forward : { true, false })
+		{
+			const std::string expected = first ? 
+				extract_first_tokenExA(org, ".", forward) : 
+				extract_last_tokenExA(org, ".", forward);
+			if (expected != extract_token_view<char>(org, ".", first, forward)) return false;
+		}
+	}
+	if ("ABCDEFG" != extract_token_view<char>(org, ".", true, true)) return false;
+	if ("KLMN" != extract_token_view<char>(org, ".", false, false)) return false;
+	if (org != extract_token_view<char>(org, "/", true, true)) return false;
+
+	//
+	//	split_string_views, small_vector 재사용
+	//
+	small_vector<std::string_view, 4> parts;
+	if (3 != split_string_views("a b c", " ", parts) || !parts.is_inline()) return false;
+	if (6 != split_string_views("a b c d e f", " ", parts) || parts.is_inline()) return false;
+	if (parts[5] != "f" || parts.front() != "a" || parts.back() != "f") return false;
+
+	const size_t capacity = parts.capacity();
+	if (2 != split_string_views("x y", " ", parts) || capacity != parts.capacity()) return false;
+
+	small_vector<std::string_view, 4> copied(parts);
+	small_vector<std::string_view, 4> moved(std::move(parts));
+	if (2 != copied.size() || 2 != moved.size() || !parts.empty() || moved[1] != "y") return false;
+
+	small_vector<int, 2> numbers;
+	for (int i = 0; i < 100; ++i)
+	{
+		numbers.push_back(i);
+		numbers.push_back(numbers[0]);		// 자기 원소를 push_back 하면서 늘어나는 경우
+	}
+	for (int i = 0; i < 100; ++i)
+	{
+		if (numbers[i * 2] != i || numbers[i * 2 + 1] != 0) return false;
+	}
+
+	//
+	//	split_string_a/w 는 예전 구현과 같아야 한다.
+	//
+	const struct
+	{
+		const char* source;
+		const char* token;
+	} cases[] = {
+		{ "abc | def | cde | xyz", "|" },
+		{ "", "|" },
+		{ "abcde", "aaaaaaaaaaaaaaa" },
+		{ "abcde", "abcde" },
+		{ "abcde", "abcdX" },
+		{ "abcdeFabcdeabcdeabcdeFFFF", "abcde" },
+		{ "  abcde       abcde abcd", " " },
+		{ "a, ,b,,  c  ,", "," },
+		{ "|", "|" },
+		{ "||", "|" },
+		{ "abc", "" },
+	};
+	for (const auto& c : cases)
+	{
+		for (bool remove_space : { true, false })
+		{
+			const auto expected = legacy_split_string_a(c.source, c.token, remove_space);
+			if (expected != split_string_a(c.source, c.token, remove_space))
+			{
+				log_err "split_string_a mismatch. source=%s, token=%s", c.source, c.token log_end;
+				return false;
+			}
+
+			std::list<std::wstring> wexpected;
+			for (const auto& s : expected) wexpected.push_back(MbsToWcsEx(s.c_str()));
+			if (wexpected != split_string_w(MbsToWcsEx(c.source), MbsToWcsEx(c.token), remove_space))
+			{
+				log_err "split_string_w mismatch. source=%s, token=%s", c.source, c.token log_end;
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+/// @brief	커맨드라인 토크나이징 (예전 구현, split_string_a, tokenize, split_string_views)
+bool test_string_tokenizer_benchmark()
+{
+	const std::string cmdline = 
+		"\"C:\\Program Files (x86)\\Google\\Chrome\\Application\\chrome.exe\" --type=renderer "
+		"--lang=ko --field-trial-handle=1736,i,5842193017634251203,13960731204952376211,262144 "
+		"--enable-features=NetworkServiceInProcess --mojo-platform-channel-handle=3220 /prefetch:1";
+	const int rounds = 1000000;
+	size_t check = 0;
+
+	StopWatch sw;
+	sw.Start();
+	for (int i = 0; i < rounds; ++i)
+	{
+		check += legacy_split_string_a(cmdline, " ", true).size();
+	}
+	sw.Stop();
+	log_info "legacy split_string_a : %7.1f ns/call", sw.GetDurationSecond() * 1e9 / rounds log_end;
+
+	sw.Start();
+	for (int i = 0; i < rounds; ++i)
+	{
+		check += split_string_a(cmdline, " ", true).size();
+	}
+	sw.Stop();
+	log_info "split_string_a        : %7.1f ns/call", sw.GetDurationSecond() * 1e9 / rounds log_end;
+
+	sw.Start();
+	for (int i = 0; i < rounds; ++i)
+	{
+		for (auto token : tokenize(cmdline, " ", TOKEN_TRIM))
+		{
+			check += token.size();
+		}
+	}
+	sw.Stop();
+	log_info "tokenize              : %7.1f ns/call", sw.GetDurationSecond() * 1e9 / rounds log_end;
+
+	small_vector<std::string_view, 16> parts;
+	sw.Start();
+	for (int i = 0; i < rounds; ++i)
+	{
+		check += split_string_views(cmdline, " ", parts, TOKEN_TRIM);
+	}
+	sw.Stop();
+	log_info "split_string_views    : %7.1f ns/call (check=%zu)", 
+		sw.GetDurationSecond() * 1e9 / rounds, 
+		check 
+		log_end;
+
+	return true;
+}
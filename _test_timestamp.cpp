@@ -0,0 +1,237 @@
+﻿/**
+ * @file    _test_timestamp.cpp
+ * @brief   Cached timestamp formatting: known values, buffer limits, concurrent cache use and 16-thread benchmark.
+ *
+ * @author  Yonhgwhan, Roh (somma@somma.kr)
+ * @date    2026/10/18 created.
+ * @copyright (C)Somma, Inc. All rights reserved.
+**/
+#include "stdafx.h"
+#include "_MyLib/src/timestamp.h"
+#include "_MyLib/src/Win32Utils.h"
+#include "_MyLib/src/StopWatch.h"
+#include <thread>
+#include <atomic>
+#include <functional>
+
+/// @brief	캐시를 거치지 않는 참조 구현 (예전 sys_time_to_str2() 와 같은 API 사용)
+static std::string reference_timestamp(_In_ int64_t unix_msec, _In_ bool localtime)
+{
+	const uint64_t ft_int = (uint64_t)(unix_msec * 10000 + 116444736000000000ll);
+	FILETIME ft;
+	ft.dwLowDateTime = (DWORD)(ft_int & 0xffffffff);
+	ft.dwHighDateTime = (DWORD)(ft_int >> 32);
+
+	SYSTEMTIME utc;
+	SYSTEMTIME local;
+	FileTimeToSystemTime(&ft, &utc);
+	PSYSTEMTIME st = &utc;
+	if (localtime)
+	{
+		SystemTimeToTzSpecificLocalTime(NULL, &utc, &local);
+		st = &local;
+	}
+
+	char buf[64];
+	snprintf(buf, sizeof(buf), "%04u-%02u-%02u %02u:%02u:%02u.%03u",
+			 st->wYear, st->wMonth, st->wDay,
+			 st->wHour, st->wMinute, st->wSecond, st->wMilliseconds);
+	return buf;
+}
+
+/// @brief	알려진 값, 버퍼 크기, 예전 함수 포맷, 여러 스레드에서 캐시 슬롯 경쟁
+bool test_timestamp()
+{
+	bool ret = true;
+	char buf[TIMESTAMP_BUF_SIZE];
+
+	struct
+	{
+		int64_t unix_msec;
+		timestamp_style style;
+		const char* expected;
+	} const utc_cases[] = {
+		{ 0, timestamp_style::date_time, "1970-01-01 00:00:00" },
+		{ 1495542204821ll, timestamp_style::date_time, "2017-05-23 12:23:24" },
+		{ 1495542204821ll, timestamp_style::date_time_msec, "2017-05-23 12:23:24.821" },
+		{ 1495542204821ll, timestamp_style::iso8601, "2017-05-23T12:23:24.821Z" },
+		{ 1495542204005ll, timestamp_style::date_time_msec, "2017-05-23 12:23:24.005" },
+		{ -1, timestamp_style::date_time_msec, "1969-12-31 23:59:59.999" },
+		{ 951782400000ll, timestamp_style::date_time, "2000-02-29 00:00:00" },
+		{ -11644473600000ll, timestamp_style::date_time, "1601-01-01 00:00:00" },
+		{ 253402300799999ll, timestamp_style::date_time_msec, "9999-12-31 23:59:59.999" },
+	};
+	for (const auto& c : utc_cases)
+	{
+		size_t len = format_timestamp(c.unix_msec, false, c.style, buf, sizeof(buf));
+		if (len != strlen(c.expected) || 0 != strcmp(buf, c.expected))
+		{
+			log_err "format_timestamp() mismatch. unix_msec=%lld, %s != %s",
+				c.unix_msec,
+				buf,
+				c.expected
+				log_end;
+			ret = false;
+		}
+	}
+
+	//
+	//	연도 범위, 버퍼 크기
+	//
+	if (0 != format_timestamp(253402300800000ll, false, timestamp_style::date_time, buf, sizeof(buf))) ret = false;
+	if (0 != format_timestamp(0, false, timestamp_style::date_time, buf, 19)) ret = false;
+	if (19 != format_timestamp(0, false, timestamp_style::date_time, buf, 20)) ret = false;
+	if (0 != format_timestamp(0, true, timestamp_style::iso8601, buf, 29)) ret = false;
+	if (29 != format_timestamp(0, true, timestamp_style::iso8601, buf, 30)) ret = false;
+
+	//
+	//	지역 시각은 SystemTimeToTzSpecificLocalTime() 결과와 같아야 한다. 
+	//
+	const int64_t now = timestamp_now_msec();
+	for (int64_t t : { now, (int64_t)1495542204821ll, (int64_t)1483228800000ll, (int64_t)1500000000123ll })
+	{
+		format_timestamp(t, true, timestamp_style::date_time_msec, buf, sizeof(buf));
+		std::string expected = reference_timestamp(t, true);
+		if (expected != buf)
+		{
+			log_err "localtime mismatch. %s != %s", buf, expected.c_str() log_end;
+			ret = false;
+		}
+
+		format_timestamp(t, true, timestamp_style::iso8601, buf, sizeof(buf));
+		expected[10] = 'T';
+		if (0 != strncmp(buf, expected.c_str(), expected.size()) ||
+			('+' != buf[23] && '-' != buf[23]) || ':' != buf[26])
+		{
+			log_err "iso8601 mismatch. %s", buf log_end;
+			ret = false;
+		}
+	}
+
+	int64_t coarse = timestamp_now_msec(timestamp_clock::coarse);
+	if (coarse < now - 1000 || coarse > timestamp_now_msec() + 1000) ret = false;
+
+	//
+	//	예전 함수 포맷
+	//
+	SYSTEMTIME st = { 0 };
+	st.wYear = 2017; st.wMonth = 5; st.wDay = 23;
+	st.wHour = 12; st.wMinute = 23; st.wSecond = 24; st.wMilliseconds = 21;
+	if (sys_time_to_str(&st, false) != "2017-05-23 12:23:24" ||
+		sys_time_to_str(&st, false, true) != "2017-05-23 12:23:24 21")
+	{
+		log_err "sys_time_to_str() mismatch. %s", sys_time_to_str(&st, false, true).c_str() log_end;
+		ret = false;
+	}
+	if (29 != sys_time_to_str2(&st).size() || 19 != time_now_to_str(true, false).size())
+	{
+		ret = false;
+	}
+	if (file_time_to_str(131400000000000000ull, false, true) != "2017-05-23 08:00:00 0")
+	{
+		log_err "file_time_to_str() mismatch. %s", file_time_to_str(131400000000000000ull, false, true).c_str() log_end;
+		ret = false;
+	}
+
+	//
+	//	여러 스레드가 서로 다른 초를 포맷팅해서 슬롯을 계속 바꿔도 
+	//	항상 올바른 결과가 나와야 한다.
+	//
+	std::atomic<int> mismatch(0);
+	std::vector<std::thread> threads;
+	for (int t = 0; t < 16; ++t)
+	{
+		threads.push_back(std::thread([t, now, &mismatch]()
+		{
+			char out[TIMESTAMP_BUF_SIZE];
+			for (int i = 0; i < 20000; ++i)
+			{
+				const int64_t ms = now + (int64_t)((i + t) % 7) * 1000 + (i % 1000);
+				const bool local = (0 != (i & 1));
+				format_timestamp(ms, local, timestamp_style::date_time_msec, out, sizeof(out));
+				if (reference_timestamp(ms, local) != out) ++mismatch;
+			}
+		}));
+	}
+	for (auto& thread : threads) thread.join();
+	if (0 != mismatch)
+	{
+		log_err "concurrent format_timestamp() mismatch. count=%d", mismatch.load() log_end;
+		ret = false;
+	}
+
+	return ret;
+}
+
+/// @brief	16 스레드에서 현재 시각 포맷팅 (ns/timestamp)
+bool test_timestamp_benchmark()
+{
+	const int thread_count = 16;
+	const int count = 200000;
+
+	auto run = [&](const char* name, std::function<size_t()> body)
+	{
+		std::atomic<size_t> total(0);
+		std::vector<std::thread> threads;
+		StopWatch sw;
+		sw.Start();
+		for (int t = 0; t < thread_count; ++t)
+		{
+			threads.push_back(std::thread([&]()
+			{
+				size_t len = 0;
+				for (int i = 0; i < count; ++i)
+				{
+					len += body();
+				}
+				total += len;
+			}));
+		}
+		for (auto& thread : threads) thread.join();
+		sw.Stop();
+
+		log_info "%-28s: %8.2f ns/timestamp (%d threads, %zu bytes)",
+			name,
+			sw.GetDurationSecond() * 1e9 / ((double)thread_count * count),
+			thread_count,
+			total.load()
+			log_end;
+	};
+
+	run("legacy (tz + printf)", []()
+	{
+		SYSTEMTIME utc;
+		SYSTEMTIME local;
+		GetSystemTime(&utc);
+		SystemTimeToTzSpecificLocalTime(NULL, &utc, &local);
+		TIME_ZONE_INFORMATION tzi = { 0 };
+		GetTimeZoneInformation(&tzi);
+
+		char buf[64];
+		snprintf(buf, sizeof(buf), "%04u-%02u-%02uT%02u:%02u:%02u.%03u%c%02u:%02u",
+				 local.wYear, local.wMonth, local.wDay,
+				 local.wHour, local.wMinute, local.wSecond, local.wMilliseconds,
+				 (0 > tzi.Bias) ? '+' : '-',
+				 (unsigned)labs(tzi.Bias / 60), (unsigned)labs(tzi.Bias % 60));
+		return strlen(buf);
+	});
+
+	run("format_timestamp_now", []()
+	{
+		char buf[TIMESTAMP_BUF_SIZE];
+		return format_timestamp_now(true, timestamp_style::iso8601, buf, sizeof(buf));
+	});
+
+	run("format_timestamp_now coarse", []()
+	{
+		char buf[TIMESTAMP_BUF_SIZE];
+		return format_timestamp_now(true, timestamp_style::iso8601, buf, sizeof(buf), timestamp_clock::coarse);
+	});
+
+	run("time_now_to_str2", []()
+	{
+		return time_now_to_str2().size();
+	});
+
+	return true;
+}
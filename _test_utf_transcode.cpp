@@ -0,0 +1,394 @@
+﻿/**
+ * @file    _test_utf_transcode.cpp
+ * @brief   UTF-8 <-> UTF-16 transcoder (scalar/SSE2/AVX2) tests and benchmark.
+ *
+ * @author  Yonhgwhan, Roh (somma@somma.kr)
+ * @date    2026/10/18 created.
+ * @copyright (C)Somma, Inc. All rights reserved.
+**/
+#include "stdafx.h"
+#include "_MyLib/src/utf_transcode.h"
+#include "_MyLib/src/StopWatch.h"
+#include <random>
+#include <vector>
+
+static const int _utf_impls[] = {
+	UTF_IMPL_SCALAR,
+	UTF_IMPL_SSE2,
+	UTF_IMPL_AVX2
+};
+
+/// @brief	code point 하나를 UTF-8/UTF-16 으로 붙인다. (비교용 단순 구현)
+static void append_code_point(_In_ uint32_t cp, _Inout_ std::string& utf8, _Inout_ std::u16string& utf16)
+{
+	if (cp < 0x80)
+	{
+		utf8.push_back((char)cp);
+	}
+	else if (cp < 0x800)
+	{
+		utf8.push_back((char)(0xc0 | (cp >> 6)));
+		utf8.push_back((char)(0x80 | (cp & 0x3f)));
+	}
+	else if (cp < 0x10000)
+	{
+		utf8.push_back((char)(0xe0 | (cp >> 12)));
+		utf8.push_back((char)(0x80 | ((cp >> 6) & 0x3f)));
+		utf8.push_back((char)(0x80 | (cp & 0x3f)));
+	}
+	else
+	{
+		utf8.push_back((char)(0xf0 | (cp >> 18)));
+		utf8.push_back((char)(0x80 | ((cp >> 12) & 0x3f)));
+		utf8.push_back((char)(0x80 | ((cp >> 6) & 0x3f)));
+		utf8.push_back((char)(0x80 | (cp & 0x3f)));
+	}
+
+	if (cp < 0x10000)
+	{
+		utf16.push_back((char16_t)cp);
+	}
+	else
+	{
+		utf16.push_back((char16_t)(0xd800 | ((cp - 0x10000) >> 10)));
+		utf16.push_back((char16_t)(0xdc00 | ((cp - 0x10000) & 0x3ff)));
+	}
+}
+
+/// @brief	ASCII 가 대부분이고 가끔 다른 문자가 섞인 문자열을 만든다.
+static uint32_t random_code_point(_Inout_ std::mt19937& rng, _In_ uint32_t ascii_percent)
+{
+	if (rng() % 100 < ascii_percent) return rng() % 0x80;
+
+	switch (rng() % 4)
+	{
+	case 0: return 0x80 + rng() % (0x800 - 0x80);
+	case 1: return 0x800 + rng() % (0xd800 - 0x800);
+	case 2: return 0xe000 + rng() % (0x10000 - 0xe000);
+	}
+	return 0x10000 + rng() % (0x110000 - 0x10000);
+}
+
+/// @brief	모든 구현이 같은 결과를 만들고, 잘못된 입력을 거부하는지 확인한다.
+bool test_utf_transcode()
+{
+	bool ret = true;
+	std::mt19937 rng(1);
+
+	for (int impl : _utf_impls)
+	{
+		if (!utf_transcode_impl_supported(impl))
+		{
+			log_info "%s not supported, skip", utf_transcode_impl_name(impl) log_end;
+			continue;
+		}
+		utf_transcode_set_impl(impl);
+
+		//
+		//	길이와 ASCII 비율을 바꿔가며 왕복 변환 (SIMD 블록 경계 포함)
+		//
+		std::string u8out;
+		std::u16string u16out;
+		for (uint32_t ascii_percent : { 100, 99, 90, 50, 0 })
+		{
+			for (size_t count = 0; count < 300; ++count)
+			{
+				std::string utf8;
+				std::u16string utf16;
+				for (size_t i = 0; i < count; ++i)
+				{
+					append_code_point(random_code_point(rng, ascii_percent), utf8, utf16);
+				}
+
+				if (!utf8_to_utf16(utf8.c_str(), utf8.size(), u16out) || u16out != utf16)
+				{
+					log_err "utf8_to_utf16 mismatch. impl=%s, ascii=%u, count=%zu",
+						utf_transcode_impl_name(impl), ascii_percent, count
+						log_end;
+					ret = false;
+				}
+				if (!utf16_to_utf8(utf16.c_str(), utf16.size(), u8out, true) || u8out != utf8)
+				{
+					log_err "utf16_to_utf8 mismatch. impl=%s, ascii=%u, count=%zu",
+						utf_transcode_impl_name(impl), ascii_percent, count
+						log_end;
+					ret = false;
+				}
+				if (!is_valid_utf8(utf8.c_str(), utf8.size()))
+				{
+					log_err "is_valid_utf8 failed. impl=%s, ascii=%u, count=%zu",
+						utf_transcode_impl_name(impl), ascii_percent, count
+						log_end;
+					ret = false;
+				}
+
+				size_t prefix = 0;
+				while (prefix < utf8.size() && (uint8_t)utf8[prefix] < 0x80) ++prefix;
+				if (prefix != ascii_prefix_length(utf8.c_str(), utf8.size()))
+				{
+					log_err "ascii_prefix_length(char) mismatch. impl=%s, count=%zu", 
+						utf_transcode_impl_name(impl), count 
+						log_end;
+					ret = false;
+				}
+
+				prefix = 0;
+				while (prefix < utf16.size() && utf16[prefix] < 0x80) ++prefix;
+				if (prefix != ascii_prefix_length(utf16.c_str(), utf16.size()))
+				{
+					log_err "ascii_prefix_length(char16_t) mismatch. impl=%s, count=%zu", 
+						utf_transcode_impl_name(impl), count 
+						log_end;
+					ret = false;
+				}
+			}
+		}
+
+		//
+		//	잘못된 UTF-8 시퀀스를 ASCII 문자열의 모든 위치에 넣어본다.
+		//
+		const char* invalid_utf8[] = {
+			"\x80",							// continuation
+			"\xbf",
+			"\xc0\xaf",						// overlong '/'
+			"\xc1\xbf",
+			"\xe0\x80\xaf",					// overlong 3 바이트
+			"\xe0\x9f\xbf",
+			"\xed\xa0\x80",					// U+D800
+			"\xed\xbf\xbf",					// U+DFFF
+			"\xf0\x80\x80\xaf",				// overlong 4 바이트
+			"\xf0\x8f\xbf\xbf",
+			"\xf4\x90\x80\x80",				// U+110000
+			"\xf5\x80\x80\x80",
+			"\xff",
+			"\xc3",							// 잘린 시퀀스
+			"\xe2\x82",
+			"\xf0\x9f\x98",
+			"\xc3\x28",						// 잘못된 continuation
+			"\xe2\x28\xa1",
+			"\xf0\x9f\x28\x80",
+		};
+		for (const char* bad : invalid_utf8)
+		{
+			for (size_t pos = 0; pos <= 70; ++pos)
+			{
+				std::string str(70, 'a');
+				str.insert(pos, bad);
+				if (utf8_to_utf16(str.c_str(), str.size(), u16out) || 
+					!u16out.empty() ||
+					is_valid_utf8(str.c_str(), str.size()))
+				{
+					log_err "invalid utf8 accepted. impl=%s, pos=%zu, lead=0x%02x",
+						utf_transcode_impl_name(impl), pos, (uint8_t)bad[0]
+						log_end;
+					ret = false;
+				}
+			}
+		}
+
+		//
+		//	짝이 맞지 않는 surrogate 는 U+FFFD 로 바꾸고, strict 이면 실패
+		//
+		const char16_t unpaired[] = { 0xd800, 0xdbff, 0xdc00, 0xdfff };
+		for (char16_t s : unpaired)
+		{
+			for (size_t pos = 0; pos <= 40; ++pos)
+			{
+				std::u16string str(40, u'a');
+				str.insert(str.begin() + pos, s);
+
+				std::string expected(40, 'a');
+				expected.insert(pos, "\xef\xbf\xbd");
+
+				if (!utf16_to_utf8(str.c_str(), str.size(), u8out) || 
+					u8out != expected ||
+					utf16_to_utf8(str.c_str(), str.size(), u8out, true))
+				{
+					log_err "unpaired surrogate mismatch. impl=%s, pos=%zu, unit=0x%04x",
+						utf_transcode_impl_name(impl), pos, s
+						log_end;
+					ret = false;
+				}
+			}
+		}
+
+		//
+		//	출력 버퍼가 최대 길이보다 작으면 실패
+		//
+		char16_t small16[4];
+		char small8[8];
+		size_t out_len = 0;
+		if (utf8_to_utf16("abcde", 5, small16, 4, out_len) ||
+			utf16_to_utf8(u"abc", 3, small8, 8, out_len))
+		{
+			log_err "small output buffer accepted. impl=%s", utf_transcode_impl_name(impl) log_end;
+			ret = false;
+		}
+	}
+
+	utf_transcode_set_impl(UTF_IMPL_AUTO);
+	return ret;
+}
+
+/// @brief	이벤트에서 흔히 보이는 경로/커맨드라인 코퍼스
+static void make_path_corpus(_Out_ std::vector<std::u16string>& corpus)
+{
+	static const char16_t* const dirs[] = {
+		u"C:\\Windows\\System32\\",
+		u"C:\\Windows\\SysWOW64\\",
+		u"C:\\Program Files\\Common Files\\microsoft shared\\ClickToRun\\",
+		u"C:\\Program Files (x86)\\Google\\Chrome\\Application\\",
+		u"C:\\Users\\somma\\AppData\\Local\\Temp\\",
+		u"C:\\Users\\홍길동\\AppData\\Roaming\\카카오톡\\",
+		u"C:\\Users\\홍길동\\Documents\\보고서\\2026년\\",
+		u"\\Device\\HarddiskVolume3\\Windows\\WinSxS\\amd64_microsoft-windows-servicingstack_31bf3856ad364e35\\",
+	};
+	static const char16_t* const files[] = {
+		u"svchost.exe",
+		u"RuntimeBroker.exe",
+		u"chrome.exe",
+		u"OfficeClickToRun.exe",
+		u"~DF3A7B21C4E9.TMP",
+		u"설치파일.exe",
+		u"회의록_최종.docx",
+		u"KakaoTalk.exe",
+	};
+	static const char16_t* const args[] = {
+		u"",
+		u" -k netsvcs -p -s Schedule",
+		u" --type=renderer --lang=ko --field-trial-handle=1736,i,5842193017634251203,13960731204952376211,262144 --mojo-platform-channel-handle=3220 /prefetch:1",
+		u" /c \"C:\\Users\\홍길동\\Desktop\\새 폴더\\run.bat\"",
+		u" -Embedding",
+	};
+
+	std::mt19937 rng(7);
+	corpus.clear();
+	for (size_t i = 0; i < 100000; ++i)
+	{
+		std::u16string str;
+		const bool cmdline = (0 == rng() % 2);
+		if (cmdline) str.push_back(u'"');
+		str.append(dirs[rng() % _countof(dirs)]);
+		str.append(files[rng() % _countof(files)]);
+		if (cmdline)
+		{
+			str.push_back(u'"');
+			str.append(args[rng() % _countof(args)]);
+		}
+		corpus.push_back(str);
+	}
+}
+
+/// @brief	경로/커맨드라인 코퍼스 변환 시간 (ns/문자열, 구현별)
+bool test_utf_transcode_benchmark()
+{
+	std::vector<std::u16string> corpus16;
+	make_path_corpus(corpus16);
+
+	std::vector<std::string> corpus8;
+	size_t total16 = 0;
+	size_t total8 = 0;
+	for (const auto& str : corpus16)
+	{
+		std::string utf8;
+		if (!utf16_to_utf8(str.c_str(), str.size(), utf8)) return false;
+		total16 += str.size();
+		total8 += utf8.size();
+		corpus8.push_back(utf8);
+	}
+	log_info "corpus: %zu strings, %zu utf16 chars, %zu utf8 bytes", 
+		corpus16.size(), total16, total8 
+		log_end;
+
+	const int rounds = 20;
+	const double count = (double)corpus16.size() * rounds;
+
+	for (int impl : _utf_impls)
+	{
+		if (!utf_transcode_set_impl(impl)) continue;
+
+		//
+		//	출력 문자열을 재사용한다. (호출자 버퍼)
+		//
+		std::u16string u16out;
+		std::string u8out;
+		size_t check = 0;
+
+		StopWatch sw;
+		sw.Start();
+		for (int r = 0; r < rounds; ++r)
+		{
+			for (const auto& str : corpus8)
+			{
+				if (!utf8_to_utf16(str.c_str(), str.size(), u16out)) return false;
+				check += u16out.size();
+			}
+		}
+		sw.Stop();
+		const double to16 = sw.GetDurationSecond() * 1e9 / count;
+
+		sw.Start();
+		for (int r = 0; r < rounds; ++r)
+		{
+			for (const auto& str : corpus16)
+			{
+				if (!utf16_to_utf8(str.c_str(), str.size(), u8out)) return false;
+				check += u8out.size();
+			}
+		}
+		sw.Stop();
+		const double to8 = sw.GetDurationSecond() * 1e9 / count;
+
+		if (check != (total16 + total8) * rounds) return false;
+
+		log_info "%-6s : utf8->utf16 %7.1f ns/str, utf16->utf8 %7.1f ns/str",
+			utf_transcode_impl_name(impl), to16, to8
+			log_end;
+	}
+
+#if defined(_WIN32)
+	//
+	//	예전 구현 (길이를 구하는 호출 + 변환 호출) 과 비교
+	//
+	{
+		size_t check = 0;
+
+		StopWatch sw;
+		sw.Start();
+		for (int r = 0; r < rounds; ++r)
+		{
+			for (const auto& str : corpus8)
+			{
+				int len = MultiByteToWideChar(CP_UTF8, MB_ERR_INVALID_CHARS, str.c_str(), -1, nullptr, 0);
+				std::unique_ptr<wchar_t[]> buf(new wchar_t[len]);
+				MultiByteToWideChar(CP_UTF8, MB_ERR_INVALID_CHARS, str.c_str(), -1, buf.get(), len);
+				check += std::wstring(buf.get()).size();
+			}
+		}
+		sw.Stop();
+		const double to16 = sw.GetDurationSecond() * 1e9 / count;
+
+		sw.Start();
+		for (int r = 0; r < rounds; ++r)
+		{
+			for (const auto& str : corpus16)
+			{
+				const wchar_t* wcs = (const wchar_t*)str.c_str();
+				int len = WideCharToMultiByte(CP_UTF8, 0, wcs, -1, nullptr, 0, nullptr, nullptr);
+				std::unique_ptr<char[]> buf(new char[len]);
+				WideCharToMultiByte(CP_UTF8, 0, wcs, -1, buf.get(), len, nullptr, nullptr);
+				check += std::string(buf.get()).size();
+			}
+		}
+		sw.Stop();
+		const double to8 = sw.GetDurationSecond() * 1e9 / count;
+
+		log_info "win32  : utf8->utf16 %7.1f ns/str, utf16->utf8 %7.1f ns/str (check=%zu)",
+			to16, to8, check
+			log_end;
+	}
+#endif
+
+	utf_transcode_set_impl(UTF_IMPL_AUTO);
+	return true;
+}
@@ -17,6 +17,10 @@
 #include <openssl/evp.h>
 #include <openssl/rand.h>
 #include <openssl/err.h>
+#include <future>
+#include <thread>
+#include <atomic>
+#include <vector>
 
 #include "_MyLib/src/Win32Utils.h"
 #include "_MyLib/src/AirCrypto.h"
@@ -27,12 +31,14 @@
 * @brief	aes256 파일 암호화
 * @param 	target_file_path ex) C:\\test_folder\\a.txt
 *			encrypt_file_path ex) C:\\test_folder\\a.txt.crypto
+*			options 버퍼 크기, double buffering 여부 (aes256_crypt_file_stream() 참고)
 **/
 bool 
 aes256_encrypt_file(
 	_In_ const unsigned char* key,
 	_In_ const std::wstring& target_file_path,
-	_In_ const std::wstring& encrypt_file_path
+	_In_ const std::wstring& encrypt_file_path,
+	_In_ const aes256_stream_options& options
 )
 {
 	_ASSERTE(nullptr != key);
@@ -47,71 +53,19 @@ aes256_encrypt_file(
 		return false;
 	}
 
-	DWORD file_size = 0;	
-	std::wstring encrypt_file_name;
-	if (!extract_last_tokenW(const_cast<std::wstring&>(encrypt_file_path),
-							 L"\\",
-							 encrypt_file_name,
-							 false,
-							 false))
+	if (!aes256_crypt_file_stream(key,
+								  (uint32_t)strlen((const char*)key),
+								  target_file_path,
+								  encrypt_file_path,
+								  true,
+								  options))
 	{
-		log_err
-			"extract_last_tokenW(%ws) failed.",
-			encrypt_file_path.c_str()
+		log_err "aes256_crypt_file_stream() failed. path=%ws", 
+			target_file_path.c_str() 
 			log_end;
 		return false;
 	}
 
-	std::wstring encrypt_file_directory;
-	if (!extract_last_tokenW(const_cast<std::wstring&>(encrypt_file_path),
-							 L"\\",
-							 encrypt_file_directory,
-							 true,
-							 false))
-	{
-		log_err "extract_last_tokenW(path=%ws) failed.",
-			encrypt_file_path.c_str()
-			log_end;
-		return false;
-	}
-
-
-	PBYTE buffer = nullptr;	
-	if (!LoadFileToMemory(target_file_path.c_str(), file_size, buffer))
-	{
-		log_err "LoadFileToMemory() failed. path=%ws", target_file_path.c_str() log_end;
-		return false;
-	}
-	_ASSERTE(nullptr != buffer);
-	if (nullptr == buffer) return false;
-	char_ptr buffer_ptr((char *)buffer, [](char* ptr) { free(ptr); });
-
-	uint32_t length = 0;
-	unsigned char* encrypt_data = nullptr;	
-    if (!aes256_crypt_buffer_v2(const_cast<unsigned char*>(key),
-                                (uint32_t)strlen((const char*)key),
-                                buffer,
-                                file_size,
-                                encrypt_data,
-                                length,
-                                true))
-	{
-		log_err "aes256_crypt_buffer() failed." log_end;
-		return false;
-	}
-	_ASSERTE(nullptr != encrypt_data);
-	if (nullptr == encrypt_data) return false;
-	char_ptr edata_ptr((char*)encrypt_data, [](char* ptr) { free(ptr); });
-
-	if (!SaveBinaryFile(encrypt_file_directory.c_str(),
-						encrypt_file_name.c_str(),
-						length,
-						encrypt_data))
-	{
-		log_err "SaveBinaryFile() failed." log_end;
-		return false;
-	}	
-
 	return true;
 }
 
@@ -119,12 +73,14 @@ aes256_encrypt_file(
 * @brief	aes256 파일 복호화
 * @param 	encrypt_file_path ex) C:\\test_folder\\a.txt.crypto
 *			decrypt_file_path ex) C:\\test_folder\\a.txt
+*			options 버퍼 크기, double buffering 여부 (aes256_crypt_file_stream() 참고)
 **/
 bool 
 aes256_decrypt_file(
 	_In_ const unsigned char* key,
 	_In_ const std::wstring& encrypt_file_path,
-	_In_ const std::wstring& decrypt_file_path
+	_In_ const std::wstring& decrypt_file_path,
+	_In_ const aes256_stream_options& options
 	)
 {
 	_ASSERTE(nullptr != key);
@@ -139,93 +95,37 @@ aes256_decrypt_file(
 		return false;
 	}
 
-	PBYTE buffer = nullptr;
-	DWORD file_size = 0;
-	uint32_t length = 0;
-	unsigned char* encrypt_data = nullptr;
-
-	std::wstring decrypt_file_name;
-	if(!extract_last_tokenW(const_cast<std::wstring&>(decrypt_file_path),
-							L"\\", 
-							decrypt_file_name, 
-							false, 
-							false))
+	if (!aes256_crypt_file_stream(key,
+								  (uint32_t)strlen((const char*)key),
+								  encrypt_file_path,
+								  decrypt_file_path,
+								  false,
+								  options))
 	{
-		log_err "extract_last_tokenW(path=%ws) failed.", 
-			decrypt_file_path.c_str() 
+		log_err "aes256_crypt_file_stream() failed. path=%ws", 
+			encrypt_file_path.c_str() 
 			log_end;
 		return false;
 	}
-	std::wstring decrypt_file_directory;
-	if(!extract_last_tokenW(const_cast<std::wstring&>(decrypt_file_path),
-							L"\\", 
-							decrypt_file_directory, 
-							true, 
-							false))
-	{
-		log_err "extract_last_tokenW(path=%ws) failed.", 
-			decrypt_file_path.c_str()
-			log_end;
-		return false;
-	}
-
-	if (LoadFileToMemory(encrypt_file_path.c_str(), file_size, buffer))
-	{
-		// RAII를 위한 버퍼 가드
-		auto buffer_guard = [](void* p) { free(p); };
-		std::unique_ptr<void, decltype(buffer_guard)> smart_buffer(buffer, buffer_guard);
-
-        if (!aes256_crypt_buffer_v2(const_cast<unsigned char*>(key),
-                                    (uint32_t)strlen((char*)key),
-                                    buffer,
-                                    file_size,
-                                    encrypt_data,
-                                    length,
-                                    false))
-		{
-			log_err "aes256_crypt_buffer() failed." log_end;
-			return false;
-			// buffer는 smart_buffer 소멸자에서 자동으로 해제됨
-		}
-
-		// RAII를 위한 encrypt_data 가드
-		auto encrypt_data_guard = [](void* p) { free(p); };
-		std::unique_ptr<void, decltype(encrypt_data_guard)> smart_encrypt_data(encrypt_data, encrypt_data_guard);
-
-		if (!SaveBinaryFile(decrypt_file_directory.c_str(),
-							decrypt_file_name.c_str(),
-							length,  
-							encrypt_data))
-		{
-			log_err "SaveBinaryFile() failed." log_end;
-			return false;			
-		}
-	}
-	else
-	{
-		log_err "LoadFileToMemory err" log_end;
-		return false;
-	}
 
 	return true;
 }
 
 
-/// @brief 보안이 강화된 새로운 AES 초기화 함수 (SHA-256, salt 사용)
-bool 
-aes_init_v2(
+/// @brief	aes256_crypt_buffer_v2() 의 고정 salt ("AirCrypt")
+static const unsigned char _aes_v2_salt[8] = {0x41, 0x69, 0x72, 0x43, 0x72, 0x79, 0x70, 0x74};
+
+/// @brief	passphrase 와 salt 로 AES 256 CBC 의 key, IV 를 만든다. (v2 방식)
+static
+bool
+aes_derive_key_v2(
 	_In_ const unsigned char* key_data, 
 	_In_ const int key_data_len, 
-	_Outptr_ EVP_CIPHER_CTX* ctx, 
-	bool encrypt
+	_In_ const unsigned char* salt,
+	_Out_writes_bytes_(EVP_MAX_KEY_LENGTH) unsigned char* key,
+	_Out_writes_bytes_(EVP_MAX_IV_LENGTH) unsigned char* iv
 	)
 {
-	unsigned char key[EVP_MAX_KEY_LENGTH]={0};
-	unsigned char iv[EVP_MAX_IV_LENGTH]={0};
-
-	// 고정 salt 사용
-	static const unsigned char salt[8] = {0x41, 0x69, 0x72, 0x43, 0x72, 0x79, 0x70, 0x74};
-
 	/*
 	 * Gen key & IV for AES 256 CBC mode. A SHA-256 digest is used to hash the supplied key material.
 	 * nrounds is the number of times the we hash the material. More rounds are more secure but
@@ -244,6 +144,26 @@ aes_init_v2(
 		log_err "Key size is %d bits - should be 256 bits", ret log_end;
 		return false;
 	}
+	return true;
+}
+
+/// @brief 보안이 강화된 새로운 AES 초기화 함수 (SHA-256, salt 사용)
+bool 
+aes_init_v2(
+	_In_ const unsigned char* key_data, 
+	_In_ const int key_data_len, 
+	_Outptr_ EVP_CIPHER_CTX* ctx, 
+	bool encrypt
+	)
+{
+	unsigned char key[EVP_MAX_KEY_LENGTH]={0};
+	unsigned char iv[EVP_MAX_IV_LENGTH]={0};
+
+	// 고정 salt 사용
+	if (!aes_derive_key_v2(key_data, key_data_len, _aes_v2_salt, key, iv))
+	{
+		return false;
+	}
 
 	if (true == encrypt)
 	{
@@ -454,4 +374,961 @@ aes256_crypt_buffer_v2(
 	Output = out;
 	OutputLength = outlen;
 	return true;
-}
\ No newline at end of file
+}
+
+/// @brief	file_handle 과 file_path 가 같은 파일인지 (볼륨, 파일 인덱스) 확인한다.
+///			file_path 가 없으면 false
+static
+bool
+is_same_file(
+	_In_ HANDLE file_handle,
+	_In_ const wchar_t* file_path
+	)
+{
+	handle_ptr other(CreateFileW(file_path,
+								 FILE_READ_ATTRIBUTES,
+								 FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+								 nullptr,
+								 OPEN_EXISTING,
+								 FILE_ATTRIBUTE_NORMAL,
+								 nullptr),
+					 [](HANDLE h)
+	{
+		if (INVALID_HANDLE_VALUE != h) CloseHandle(h);
+	});
+	if (INVALID_HANDLE_VALUE == other.get()) return false;
+
+	BY_HANDLE_FILE_INFORMATION a;
+	BY_HANDLE_FILE_INFORMATION b;
+	if (!GetFileInformationByHandle(file_handle, &a) ||
+		!GetFileInformationByHandle(other.get(), &b))
+	{
+		log_err "GetFileInformationByHandle() failed. path=%ws, gle=%u",
+			file_path,
+			GetLastError()
+			log_end;
+		return false;
+	}
+
+	return (a.dwVolumeSerialNumber == b.dwVolumeSerialNumber &&
+			a.nFileIndexHigh == b.nFileIndexHigh &&
+			a.nFileIndexLow == b.nFileIndexLow);
+}
+
+/// @brief	input_file_path 를 options.buffer_size 단위로 읽어서 EVP_CIPHER_CTX 
+///			하나로 암호화/복호화하면서 output_file_path 에 기록한다. 
+///
+///			출력은 aes256_crypt_buffer_v2() 와 동일하다. (v2 포맷)
+///			메모리는 파일 크기와 상관없이 버퍼 (double buffering 이면 입/출력 
+///			각 2개) 만큼만 사용한다.
+///
+///			double_buffering 이 true 이면 다음 블록 읽기와 이전 블록 쓰기를 
+///			별도 스레드에서 수행해서 암호화와 I/O 가 겹쳐지게 한다.
+///
+///			입력과 출력이 같은 파일이면 같은 디렉토리의 임시 파일에 기록한 후 
+///			MoveFileExW() 로 교체한다.
+bool
+aes256_crypt_file_stream(
+	_In_ const unsigned char* PassPhrase,
+	_In_ const uint32_t PassPhraseLen,
+	_In_ const std::wstring& input_file_path,
+	_In_ const std::wstring& output_file_path,
+	_In_ bool Encrypt,
+	_In_ const aes256_stream_options& options
+	)
+{
+	_ASSERTE(nullptr != PassPhrase);
+	_ASSERTE(0 < PassPhraseLen);
+	if (nullptr == PassPhrase || 0 == PassPhraseLen)
+	{
+		log_err "aes256_crypt_file_stream() invalid parameters" log_end;
+		return false;
+	}
+
+	//
+	//	출력 파일의 디렉토리가 없으면 생성한다. (SaveBinaryFile() 과 동일)
+	//
+	std::wstring output_directory;
+	if (extract_last_tokenW(const_cast<std::wstring&>(output_file_path),
+							L"\\",
+							output_directory,
+							true,
+							false) &&
+		!output_directory.empty())
+	{
+		if (!WUCreateDirectory(output_directory.c_str()))
+		{
+			log_err "WUCreateDirectory() failed. path=%ws",
+				output_directory.c_str()
+				log_end;
+			return false;
+		}
+	}
+
+	handle_ptr input(open_file_to_read(input_file_path.c_str()), 
+					 [](HANDLE h) 
+	{
+		if (INVALID_HANDLE_VALUE != h) CloseHandle(h);
+	});
+	if (INVALID_HANDLE_VALUE == input.get())
+	{
+		log_err "open_file_to_read() failed. path=%ws",
+			input_file_path.c_str()
+			log_end;
+		return false;
+	}
+
+	//
+	//	입력을 읽는 동안 같은 파일을 CREATE_ALWAYS 로 열 수 없으므로 (공유 위반, 
+	//	성공하더라도 입력이 잘림) 임시 파일에 기록하고 마지막에 교체한다.
+	//
+	const bool in_place = is_same_file(input.get(), output_file_path.c_str());
+	const std::wstring write_path = (true == in_place) ? 
+		output_file_path + L"." + std::to_wstring(GetCurrentThreadId()) + L".tmp" :
+		output_file_path;
+
+	HANDLE output = CreateFileW(write_path.c_str(),
+								GENERIC_WRITE,
+								FILE_SHARE_READ,
+								nullptr,
+								CREATE_ALWAYS,
+								FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+								nullptr);
+	if (INVALID_HANDLE_VALUE == output)
+	{
+		log_err "CreateFileW() failed. path=%ws, gle=%u",
+			write_path.c_str(),
+			GetLastError()
+			log_end;
+		return false;
+	}
+
+	auto ctx_guard = [](EVP_CIPHER_CTX* p) { EVP_CIPHER_CTX_free(p); };
+	std::unique_ptr<EVP_CIPHER_CTX, decltype(ctx_guard)> ctx(EVP_CIPHER_CTX_new(), ctx_guard);
+
+	bool ret = false;
+	do
+	{
+		if (nullptr == ctx.get())
+		{
+			log_err "EVP_CIPHER_CTX_new() failed." log_end;
+			break;
+		}
+
+		if (!aes_init_v2(PassPhrase, PassPhraseLen, ctx.get(), Encrypt))
+		{
+			log_err "aes_init_v2() failed." log_end;
+			break;
+		}
+
+		const uint32_t buffer_size = min(max(options.buffer_size, 
+											 (uint32_t)AES256_STREAM_MIN_BUFFER_SIZE),
+										 (uint32_t)AES256_STREAM_MAX_BUFFER_SIZE);
+		const uint32_t buffer_count = (true == options.double_buffering) ? 2 : 1;
+		const std::launch policy = (true == options.double_buffering) ? 
+			std::launch::async : 
+			std::launch::deferred;
+
+		std::vector<unsigned char> in[2];
+		std::vector<unsigned char> out[2];
+		DWORD in_size[2] = { 0 };
+		for (uint32_t i = 0; i < buffer_count; ++i)
+		{
+			in[i].resize(buffer_size);
+			out[i].resize(buffer_size + EVP_MAX_BLOCK_LENGTH);
+		}
+
+		//
+		//	버퍼를 가득 채울때까지 읽는다. (in_size == 0 이면 EOF)
+		//
+		auto read_chunk = [&](uint32_t idx) -> bool
+		{
+			in_size[idx] = 0;
+			while (in_size[idx] < buffer_size)
+			{
+				DWORD bytes_read = 0;
+				if (!ReadFile(input.get(),
+							  &in[idx][in_size[idx]],
+							  buffer_size - in_size[idx],
+							  &bytes_read,
+							  nullptr))
+				{
+					log_err "ReadFile() failed. path=%ws, gle=%u",
+						input_file_path.c_str(),
+						GetLastError()
+						log_end;
+					return false;
+				}
+				if (0 == bytes_read) break;
+				in_size[idx] += bytes_read;
+			}
+			return true;
+		};
+
+		auto write_chunk = [&](uint32_t idx, DWORD size) -> bool
+		{
+			DWORD bytes_written = 0;
+			if (0 < size && 
+				(!WriteFile(output, out[idx].data(), size, &bytes_written, nullptr) ||
+				 bytes_written != size))
+			{
+				log_err "WriteFile() failed. path=%ws, gle=%u",
+					write_path.c_str(),
+					GetLastError()
+					log_end;
+				return false;
+			}
+			return true;
+		};
+
+		//
+		//	double buffering 이면 cur 블록을 암호화하는 동안 다음 블록을 
+		//	다른 버퍼 (cur ^ 1) 로 읽고, 이전 블록을 기록한다.
+		//	그렇지 않으면 (deferred) 읽기는 get() 할 때 수행되고, 쓰기는 
+		//	바로 기다리므로 버퍼 하나로 순서대로 처리된다.
+		//
+		uint32_t cur = 0;
+		std::future<bool> pending_read = std::async(policy, read_chunk, cur);
+		std::future<bool> pending_write;
+		bool failed = false;
+		for (;;)
+		{
+			if (!pending_read.get())
+			{
+				failed = true;
+				break;
+			}
+
+			const bool last = (0 == in_size[cur]);
+			const uint32_t next = (uint32_t)((cur + 1) % buffer_count);
+			if (!last)
+			{
+				pending_read = std::async(policy, read_chunk, next);
+			}
+
+			int out_len = 0;
+			int rc = 0;
+			if (!last)
+			{
+				rc = (true == Encrypt) ?
+					EVP_EncryptUpdate(ctx.get(), out[cur].data(), &out_len, in[cur].data(), (int)in_size[cur]) :
+					EVP_DecryptUpdate(ctx.get(), out[cur].data(), &out_len, in[cur].data(), (int)in_size[cur]);
+			}
+			else
+			{
+				rc = (true == Encrypt) ?
+					EVP_EncryptFinal_ex(ctx.get(), out[cur].data(), &out_len) :
+					EVP_DecryptFinal_ex(ctx.get(), out[cur].data(), &out_len);
+			}
+			if (!rc)
+			{
+				log_err "EVP_%sUpdate/Final() failed. path=%ws",
+					(true == Encrypt) ? "Encrypt" : "Decrypt",
+					input_file_path.c_str()
+					log_end;
+				failed = true;
+				break;
+			}
+
+			if (pending_write.valid() && !pending_write.get())
+			{
+				failed = true;
+				break;
+			}
+			pending_write = std::async(policy, write_chunk, cur, (DWORD)out_len);
+			if (true != options.double_buffering && !pending_write.get())
+			{
+				failed = true;
+				break;
+			}
+
+			if (last) break;
+			cur = next;
+		}
+
+		//
+		//	진행중인 읽기/쓰기를 기다린다. 
+		//
+		if (pending_read.valid()) pending_read.wait();
+		if (pending_write.valid() && !pending_write.get()) failed = true;
+		if (failed) break;
+
+		ret = true;
+	} while (false);
+
+	CloseHandle(output);
+	if (ret && in_place)
+	{
+		input.reset();
+		if (!MoveFileExW(write_path.c_str(), output_file_path.c_str(), MOVEFILE_REPLACE_EXISTING))
+		{
+			log_err "MoveFileExW() failed. from=%ws, to=%ws, gle=%u",
+				write_path.c_str(),
+				output_file_path.c_str(),
+				GetLastError()
+				log_end;
+			ret = false;
+		}
+	}
+
+	if (!ret)
+	{
+		DeleteFileW(write_path.c_str());
+	}
+	return ret;
+}
+
+/// @brief	PBKDF2-HMAC-SHA256 으로 AES-256 key 를 만든다.
+static 
+bool 
+aes256_gcm_derive_key(
+	_In_ const unsigned char* PassPhrase,
+	_In_ const uint32_t PassPhraseLen,
+	_In_ const uint8_t* salt,
+	_In_ uint32_t iterations,
+	_Out_writes_bytes_(32) uint8_t* key
+	)
+{
+	if (1 != PKCS5_PBKDF2_HMAC((const char*)PassPhrase,
+							   (int)PassPhraseLen,
+							   salt,
+							   AES256_GCM_SALT_SIZE,
+							   (int)iterations,
+							   EVP_sha256(),
+							   32,
+							   key))
+	{
+		log_err "PKCS5_PBKDF2_HMAC() failed." log_end;
+		return false;
+	}
+	return true;
+}
+
+/// @brief	세그먼트 하나를 암호화/복호화 한다. 
+///			ctx 는 EVP_aes_256_gcm() 와 key 로 초기화되어 있어야 하고,
+///			여기서는 세그먼트의 IV 만 설정한다.
+static 
+bool
+aes256_gcm_crypt_segment(
+	_In_ EVP_CIPHER_CTX* ctx,
+	_In_ const aes256_gcm_header& header,
+	_In_ uint32_t index,
+	_In_ bool last,
+	_In_reads_bytes_(length) const uint8_t* input,
+	_In_ uint32_t length,
+	_Out_writes_bytes_(length) uint8_t* output,
+	_Inout_updates_bytes_(AES256_GCM_TAG_SIZE) uint8_t* tag,
+	_In_ bool encrypt
+	)
+{
+	uint8_t iv[12];
+	memcpy(iv, header.nonce_prefix, sizeof(header.nonce_prefix));
+	iv[8] = (uint8_t)(index >> 24);
+	iv[9] = (uint8_t)(index >> 16);
+	iv[10] = (uint8_t)(index >> 8);
+	iv[11] = (uint8_t)(index);
+
+	const uint8_t last_flag = (true == last) ? 1 : 0;
+	int len = 0;
+	if (true == encrypt)
+	{
+		if (1 != EVP_EncryptInit_ex(ctx, nullptr, nullptr, nullptr, iv) ||
+			1 != EVP_EncryptUpdate(ctx, nullptr, &len, (const uint8_t*)&header, sizeof(header)) ||
+			1 != EVP_EncryptUpdate(ctx, nullptr, &len, &last_flag, sizeof(last_flag)) ||
+			(0 < length && 1 != EVP_EncryptUpdate(ctx, output, &len, input, (int)length)) ||
+			1 != EVP_EncryptFinal_ex(ctx, output + length, &len) ||
+			1 != EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_GCM_GET_TAG, AES256_GCM_TAG_SIZE, tag))
+		{
+			log_err "segment encryption failed. segment=%u", index log_end;
+			return false;
+		}
+	}
+	else
+	{
+		if (1 != EVP_DecryptInit_ex(ctx, nullptr, nullptr, nullptr, iv) ||
+			1 != EVP_DecryptUpdate(ctx, nullptr, &len, (const uint8_t*)&header, sizeof(header)) ||
+			1 != EVP_DecryptUpdate(ctx, nullptr, &len, &last_flag, sizeof(last_flag)) ||
+			(0 < length && 1 != EVP_DecryptUpdate(ctx, output, &len, input, (int)length)) ||
+			1 != EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_GCM_SET_TAG, AES256_GCM_TAG_SIZE, tag))
+		{
+			log_err "segment decryption failed. segment=%u", index log_end;
+			return false;
+		}
+
+		if (1 != EVP_DecryptFinal_ex(ctx, output + length, &len))
+		{
+			log_err "segment authentication failed. segment=%u", index log_end;
+			return false;
+		}
+	}
+	return true;
+}
+
+/// @brief	Input 이 AES-256-GCM 세그먼트 포맷 (헤더) 으로 시작하는지 확인한다.
+bool
+is_aes256_gcm_buffer(
+	_In_reads_bytes_(InputLength) const unsigned char* Input,
+	_In_ size_t InputLength
+	)
+{
+	if (nullptr == Input || InputLength < sizeof(aes256_gcm_header)) return false;
+
+	const aes256_gcm_header* header = (const aes256_gcm_header*)Input;
+	return (AES256_GCM_MAGIC == header->magic &&
+			AES256_GCM_VERSION == header->version &&
+			AES256_GCM_HEADER_SIZE == header->header_size);
+}
+
+/// @brief	평문 크기에 대한 암호문 크기 (헤더 + 세그먼트별 tag 포함)
+size_t
+aes256_gcm_encrypted_length(
+	_In_ size_t PlainLength,
+	_In_ uint32_t SegmentSize
+	)
+{
+	_ASSERTE(0 < SegmentSize);
+	if (0 == SegmentSize) return 0;
+
+	//
+	//	빈 입력도 tag 를 가진 세그먼트 하나로 표현한다.
+	//
+	const size_t segment_count = (0 == PlainLength) ? 1 : (PlainLength + SegmentSize - 1) / SegmentSize;
+	return AES256_GCM_HEADER_SIZE + PlainLength + segment_count * AES256_GCM_TAG_SIZE;
+}
+
+/// @brief	AES-256-GCM 세그먼트 포맷으로 암호화/복호화 한다.
+///
+///			세그먼트마다 IV (카운터 범위) 가 다르므로 세그먼트들은 서로 독립적이다.
+///			스레드마다 EVP_CIPHER_CTX 를 하나씩 만들어 key 를 한번만 설정하고, 
+///			다음 세그먼트 번호를 atomic 카운터에서 가져와 처리한다.
+bool
+aes256_gcm_crypt_buffer(
+	_In_ const unsigned char* PassPhrase,
+	_In_ const uint32_t PassPhraseLen,
+	_In_reads_bytes_(InputLength) const unsigned char* Input,
+	_In_ const size_t InputLength,
+	_Outptr_ unsigned char*& Output,
+	_Out_ size_t& OutputLength,
+	_In_ bool Encrypt,
+	_In_ const aes256_gcm_options& options
+	)
+{
+	_ASSERTE(nullptr != PassPhrase);
+	_ASSERTE(0 < PassPhraseLen);
+	_ASSERTE(nullptr != Input || 0 == InputLength);
+
+	Output = nullptr;
+	OutputLength = 0;
+
+	if (nullptr == PassPhrase ||
+		0 == PassPhraseLen ||
+		(nullptr == Input && 0 != InputLength))
+	{
+		log_err "aes256_gcm_crypt_buffer() invalid parameters" log_end;
+		return false;
+	}
+
+	aes256_gcm_header header;
+	memset(&header, 0x00, sizeof(header));
+	if (true == Encrypt)
+	{
+		if (options.segment_size < AES256_GCM_MIN_SEGMENT_SIZE ||
+			options.segment_size > AES256_GCM_MAX_SEGMENT_SIZE)
+		{
+			log_err "invalid segment size. segment_size=%u", options.segment_size log_end;
+			return false;
+		}
+
+		header.magic = AES256_GCM_MAGIC;
+		header.version = AES256_GCM_VERSION;
+		header.header_size = AES256_GCM_HEADER_SIZE;
+		header.segment_size = options.segment_size;
+		header.kdf_iterations = AES256_GCM_KDF_ITERATIONS;
+		header.plaintext_length = InputLength;
+		if (1 != RAND_bytes(header.salt, sizeof(header.salt)) ||
+			1 != RAND_bytes(header.nonce_prefix, sizeof(header.nonce_prefix)))
+		{
+			log_err "RAND_bytes() failed." log_end;
+			return false;
+		}
+	}
+	else
+	{
+		if (!is_aes256_gcm_buffer(Input, InputLength))
+		{
+			log_err "not an aes256 gcm buffer." log_end;
+			return false;
+		}
+		memcpy(&header, Input, sizeof(header));
+
+		//
+		//	헤더는 AAD 로 인증되지만, 인증 전에 크기 계산에 쓰이므로 범위를 먼저 확인한다.
+		//
+		if (header.segment_size < AES256_GCM_MIN_SEGMENT_SIZE ||
+			header.segment_size > AES256_GCM_MAX_SEGMENT_SIZE ||
+			0 == header.kdf_iterations ||
+			header.kdf_iterations > AES256_GCM_KDF_ITERATIONS * 100 ||
+			header.plaintext_length > InputLength ||
+			aes256_gcm_encrypted_length((size_t)header.plaintext_length, header.segment_size) != InputLength)
+		{
+			log_err "invalid aes256 gcm header. segment_size=%u, plaintext_length=%llu, input_length=%zu",
+				header.segment_size,
+				header.plaintext_length,
+				InputLength
+				log_end;
+			return false;
+		}
+	}
+
+	const size_t plain_length = (size_t)header.plaintext_length;
+	const uint32_t segment_size = header.segment_size;
+	const uint64_t segment_count = (0 == plain_length) ? 1 : (plain_length + segment_size - 1) / segment_size;
+	if (segment_count > 0xffffffff)
+	{
+		log_err "too many segments. segment_count=%llu", segment_count log_end;
+		return false;
+	}
+
+	uint8_t key[32];
+	if (!aes256_gcm_derive_key(PassPhrase, PassPhraseLen, header.salt, header.kdf_iterations, key))
+	{
+		return false;
+	}
+
+	const size_t out_length = (true == Encrypt) ? aes256_gcm_encrypted_length(plain_length, segment_size) : plain_length;
+	unsigned char* out = (unsigned char*)malloc(max(out_length, (size_t)1));
+	if (nullptr == out)
+	{
+		log_err "malloc() failed. size=%zu", out_length log_end;
+		OPENSSL_cleanse(key, sizeof(key));
+		return false;
+	}
+	if (true == Encrypt)
+	{
+		memcpy(out, &header, sizeof(header));
+	}
+
+	std::atomic<uint64_t> next_segment(0);
+	std::atomic<bool> failed(false);
+	auto worker = [&]()
+	{
+		auto ctx_guard = [](EVP_CIPHER_CTX* p) { EVP_CIPHER_CTX_free(p); };
+		std::unique_ptr<EVP_CIPHER_CTX, decltype(ctx_guard)> ctx(EVP_CIPHER_CTX_new(), ctx_guard);
+		if (nullptr == ctx.get() ||
+			1 != ((true == Encrypt) ? 
+				  EVP_EncryptInit_ex(ctx.get(), EVP_aes_256_gcm(), nullptr, key, nullptr) :
+				  EVP_DecryptInit_ex(ctx.get(), EVP_aes_256_gcm(), nullptr, key, nullptr)))
+		{
+			log_err "EVP_CIPHER_CTX init failed." log_end;
+			failed = true;
+			return;
+		}
+
+		for (;;)
+		{
+			const uint64_t index = next_segment++;
+			if (index >= segment_count || true == failed) break;
+
+			const size_t plain_offset = (size_t)index * segment_size;
+			const size_t crypt_offset = AES256_GCM_HEADER_SIZE + (size_t)index * (segment_size + AES256_GCM_TAG_SIZE);
+			const uint32_t length = (uint32_t)min((size_t)segment_size, plain_length - plain_offset);
+
+			bool ok = false;
+			if (true == Encrypt)
+			{
+				ok = aes256_gcm_crypt_segment(ctx.get(),
+											  header,
+											  (uint32_t)index,
+											  index + 1 == segment_count,
+											  Input + plain_offset,
+											  length,
+											  out + crypt_offset,
+											  out + crypt_offset + length,
+											  true);
+			}
+			else
+			{
+				ok = aes256_gcm_crypt_segment(ctx.get(),
+											  header,
+											  (uint32_t)index,
+											  index + 1 == segment_count,
+											  Input + crypt_offset,
+											  length,
+											  out + plain_offset,
+											  const_cast<uint8_t*>(Input + crypt_offset + length),
+											  false);
+			}
+
+			if (!ok)
+			{
+				failed = true;
+				break;
+			}
+		}
+	};
+
+	//
+	//	호출 스레드도 워커로 사용한다.
+	//
+	uint32_t thread_count = options.thread_count;
+	if (0 == thread_count)
+	{
+		thread_count = max(std::thread::hardware_concurrency(), (unsigned int)1);
+	}
+	thread_count = (uint32_t)min((uint64_t)thread_count, segment_count);
+
+	std::vector<std::thread> workers;
+	for (uint32_t i = 1; i < thread_count; ++i)
+	{
+		workers.push_back(std::thread(worker));
+	}
+	worker();
+	for (auto& t : workers)
+	{
+		t.join();
+	}
+	OPENSSL_cleanse(key, sizeof(key));
+
+	if (true == failed)
+	{
+		//
+		//	인증에 실패한 평문이 남지 않도록 지운다.
+		//
+		OPENSSL_cleanse(out, out_length);
+		free(out);
+		return false;
+	}
+
+	Output = out;
+	OutputLength = out_length;
+	return true;
+}
+
+/// @brief	aes256_session
+aes256_session::aes256_session() : _enc_ctx(nullptr), _dec_ctx(nullptr)
+{
+	memset(_iv, 0x00, sizeof(_iv));
+}
+
+aes256_session::~aes256_session()
+{
+	finalize();
+}
+
+/// @brief	key/IV 를 만들고, 암호화/복호화 context 에 key 를 설정해둔다.
+///			이후 호출에서는 IV 만 다시 설정하므로 key 유도와 key schedule 
+///			계산을 반복하지 않는다.
+bool 
+aes256_session::initialize(
+	_In_ const unsigned char* PassPhrase,
+	_In_ const uint32_t PassPhraseLen,
+	_In_opt_ const unsigned char* salt
+	)
+{
+	_ASSERTE(nullptr != PassPhrase);
+	_ASSERTE(0 < PassPhraseLen);
+	if (nullptr == PassPhrase || 0 == PassPhraseLen)
+	{
+		log_err "aes256_session::initialize() invalid parameters" log_end;
+		return false;
+	}
+
+	finalize();
+
+	unsigned char key[EVP_MAX_KEY_LENGTH] = { 0 };
+	unsigned char iv[EVP_MAX_IV_LENGTH] = { 0 };
+	if (!aes_derive_key_v2(PassPhrase,
+						   (int)PassPhraseLen,
+						   (nullptr != salt) ? salt : _aes_v2_salt,
+						   key,
+						   iv))
+	{
+		return false;
+	}
+	memcpy(_iv, iv, sizeof(_iv));
+
+	bool ret = false;
+	do
+	{
+		_enc_ctx = EVP_CIPHER_CTX_new();
+		_dec_ctx = EVP_CIPHER_CTX_new();
+		if (nullptr == _enc_ctx || nullptr == _dec_ctx)
+		{
+			log_err "EVP_CIPHER_CTX_new() failed." log_end;
+			break;
+		}
+
+		if (!EVP_EncryptInit_ex(_enc_ctx, EVP_aes_256_cbc(), nullptr, key, _iv) ||
+			!EVP_DecryptInit_ex(_dec_ctx, EVP_aes_256_cbc(), nullptr, key, _iv))
+		{
+			log_err "EVP_EncryptInit_ex() / EVP_DecryptInit_ex() failed." log_end;
+			break;
+		}
+		ret = true;
+	} while (false);
+
+	OPENSSL_cleanse(key, sizeof(key));
+	OPENSSL_cleanse(iv, sizeof(iv));
+	if (!ret)
+	{
+		finalize();
+	}
+	return ret;
+}
+
+void aes256_session::finalize()
+{
+	if (nullptr != _enc_ctx)
+	{
+		EVP_CIPHER_CTX_free(_enc_ctx);
+		_enc_ctx = nullptr;
+	}
+	if (nullptr != _dec_ctx)
+	{
+		EVP_CIPHER_CTX_free(_dec_ctx);
+		_dec_ctx = nullptr;
+	}
+	OPENSSL_cleanse(_iv, sizeof(_iv));
+	if (!_pool.empty())
+	{
+		OPENSSL_cleanse(_pool.data(), _pool.size());
+	}
+}
+
+bool 
+aes256_session::encrypt(
+	_In_reads_bytes_(InputLength) const unsigned char* Input,
+	_In_ uint32_t InputLength,
+	_Out_writes_bytes_to_(OutputSize, OutputLength) unsigned char* Output,
+	_In_ uint32_t OutputSize,
+	_Out_ uint32_t& OutputLength
+	)
+{
+	return crypt(true, Input, InputLength, Output, OutputSize, OutputLength);
+}
+
+bool 
+aes256_session::decrypt(
+	_In_reads_bytes_(InputLength) const unsigned char* Input,
+	_In_ uint32_t InputLength,
+	_Out_writes_bytes_to_(OutputSize, OutputLength) unsigned char* Output,
+	_In_ uint32_t OutputSize,
+	_Out_ uint32_t& OutputLength
+	)
+{
+	return crypt(false, Input, InputLength, Output, OutputSize, OutputLength);
+}
+
+bool 
+aes256_session::encrypt(
+	_In_reads_bytes_(InputLength) const unsigned char* Input,
+	_In_ uint32_t InputLength,
+	_Inout_ std::vector<unsigned char>& Output
+	)
+{
+	if (InputLength > max_input_length)
+	{
+		log_err "input too large. input=%u", InputLength log_end;
+		Output.clear();
+		return false;
+	}
+	Output.resize(encrypted_length(InputLength));
+
+	uint32_t length = 0;
+	if (!crypt(true, Input, InputLength, Output.data(), (uint32_t)Output.size(), length))
+	{
+		Output.clear();
+		return false;
+	}
+	Output.resize(length);
+	return true;
+}
+
+bool 
+aes256_session::decrypt(
+	_In_reads_bytes_(InputLength) const unsigned char* Input,
+	_In_ uint32_t InputLength,
+	_Inout_ std::vector<unsigned char>& Output
+	)
+{
+	if (InputLength > max_input_length)
+	{
+		log_err "input too large. input=%u", InputLength log_end;
+		Output.clear();
+		return false;
+	}
+	Output.resize(InputLength);
+
+	uint32_t length = 0;
+	if (!crypt(false, Input, InputLength, Output.data(), (uint32_t)Output.size(), length))
+	{
+		Output.clear();
+		return false;
+	}
+	Output.resize(length);
+	return true;
+}
+
+bool 
+aes256_session::encrypt_many(
+	_In_reads_(count) const aes256_record* records,
+	_In_ size_t count,
+	_Out_ std::vector<aes256_record>& results
+	)
+{
+	return crypt_many(true, records, count, results);
+}
+
+bool 
+aes256_session::decrypt_many(
+	_In_reads_(count) const aes256_record* records,
+	_In_ size_t count,
+	_Out_ std::vector<aes256_record>& results
+	)
+{
+	return crypt_many(false, records, count, results);
+}
+
+/// @brief	IV 만 다시 설정하고 (key schedule 은 유지) 한 레코드를 처리한다.
+bool 
+aes256_session::crypt(
+	_In_ bool encrypt,
+	_In_reads_bytes_(InputLength) const unsigned char* Input,
+	_In_ uint32_t InputLength,
+	_Out_writes_bytes_to_(OutputSize, OutputLength) unsigned char* Output,
+	_In_ uint32_t OutputSize,
+	_Out_ uint32_t& OutputLength
+	)
+{
+	OutputLength = 0;
+
+	if (!initialized())
+	{
+		log_err "session is not initialized." log_end;
+		return false;
+	}
+
+	if (nullptr == Output ||
+		(nullptr == Input && 0 != InputLength))
+	{
+		log_err "invalid parameters" log_end;
+		return false;
+	}
+
+	//
+	//	EVP 는 길이를 int 로 받고, 암호화 출력은 패딩만큼 커진다.
+	//
+	if (InputLength > max_input_length)
+	{
+		log_err "input too large. input=%u, max=%u", InputLength, max_input_length log_end;
+		return false;
+	}
+
+	if (true == encrypt)
+	{
+		if (OutputSize < encrypted_length(InputLength))
+		{
+			log_err "output buffer too small. input=%u, output=%u", InputLength, OutputSize log_end;
+			return false;
+		}
+	}
+	else
+	{
+		//
+		//	복호화 출력은 입력보다 클 수 없다. (패딩이 제거됨)
+		//
+		if (0 == InputLength || 0 != InputLength % 16 || OutputSize < InputLength)
+		{
+			log_err "invalid ciphertext length or output buffer too small. input=%u, output=%u", 
+				InputLength, 
+				OutputSize 
+				log_end;
+			return false;
+		}
+	}
+
+	int len = 0;
+	int final_len = 0;
+	if (true == encrypt)
+	{
+		if (!EVP_EncryptInit_ex(_enc_ctx, nullptr, nullptr, nullptr, _iv) ||
+			!EVP_EncryptUpdate(_enc_ctx, Output, &len, Input, (int)InputLength) ||
+			!EVP_EncryptFinal_ex(_enc_ctx, Output + len, &final_len))
+		{
+			log_err "encryption failed." log_end;
+			return false;
+		}
+	}
+	else
+	{
+		if (!EVP_DecryptInit_ex(_dec_ctx, nullptr, nullptr, nullptr, _iv) ||
+			!EVP_DecryptUpdate(_dec_ctx, Output, &len, Input, (int)InputLength) ||
+			!EVP_DecryptFinal_ex(_dec_ctx, Output + len, &final_len))
+		{
+			log_err "decryption failed." log_end;
+			return false;
+		}
+	}
+
+	OutputLength = (uint32_t)(len + final_len);
+	return true;
+}
+
+/// @brief	출력 크기의 합만큼 _pool 을 (필요할 때만) 늘리고, 레코드들을 
+///			순서대로 _pool 에 연속으로 처리한다.
+bool 
+aes256_session::crypt_many(
+	_In_ bool encrypt,
+	_In_reads_(count) const aes256_record* records,
+	_In_ size_t count,
+	_Out_ std::vector<aes256_record>& results
+	)
+{
+	results.clear();
+	if (nullptr == records && 0 != count)
+	{
+		log_err "invalid parameters" log_end;
+		return false;
+	}
+
+	size_t total = 0;
+	for (size_t i = 0; i < count; ++i)
+	{
+		if (records[i].length > max_input_length)
+		{
+			log_err "record %zu is too large. length=%u", i, records[i].length log_end;
+			return false;
+		}
+
+		const size_t size = (true == encrypt) ? encrypted_length(records[i].length) : records[i].length;
+		if (size > _pool.max_size() - total)
+		{
+			log_err "total output size overflows. record=%zu", i log_end;
+			return false;
+		}
+		total += size;
+	}
+	if (_pool.size() < total)
+	{
+		_pool.resize(total);
+	}
+
+	results.resize(count);
+	size_t offset = 0;
+	for (size_t i = 0; i < count; ++i)
+	{
+		const uint32_t size = (true == encrypt) ? encrypted_length(records[i].length) : records[i].length;
+		uint32_t length = 0;
+		if (!crypt(encrypt, records[i].data, records[i].length, _pool.data() + offset, size, length))
+		{
+			log_err "record %zu failed.", i log_end;
+			results.clear();
+			return false;
+		}
+
+		results[i].data = _pool.data() + offset;
+		results[i].length = length;
+		offset += length;
+	}
+	return true;
+}
@@ -9,20 +9,54 @@
 **---------------------------------------------------------------------------*/
 #pragma once
 
+#include <stdint.h>
 #include <string>
+#include <vector>
+
+#define AES256_STREAM_DEFAULT_BUFFER_SIZE	(1024 * 1024)
+#define AES256_STREAM_MIN_BUFFER_SIZE		(4 * 1024)
+#define AES256_STREAM_MAX_BUFFER_SIZE		(64 * 1024 * 1024)
+
+/// @brief	파일 암호화/복호화 스트리밍 옵션
+typedef struct aes256_stream_options
+{
+	aes256_stream_options() :
+		buffer_size(AES256_STREAM_DEFAULT_BUFFER_SIZE),
+		double_buffering(true)
+	{}
+
+	uint32_t buffer_size;		///< 한번에 읽고 암호화하는 크기 (4 KB ~ 64 MB)
+	bool double_buffering;		///< 다음 블록 읽기, 이전 블록 쓰기를 암호화와 겹쳐서 수행
+} *paes256_stream_options;
 
 bool 
 aes256_encrypt_file(
 	_In_ const unsigned char* key,
 	_In_ const std::wstring& target_file_path,
-	_In_ const std::wstring& encrypt_file_path
+	_In_ const std::wstring& encrypt_file_path,
+	_In_ const aes256_stream_options& options = aes256_stream_options()
 	);
 
 bool 
 aes256_decrypt_file(
 	_In_ const unsigned char* key,
 	_In_ const std::wstring& encrypt_file_path,
-	_In_ const std::wstring& decrypt_file_path
+	_In_ const std::wstring& decrypt_file_path,
+	_In_ const aes256_stream_options& options = aes256_stream_options()
+	);
+
+/// @brief	파일을 고정 크기 블록 단위로 읽고, 암호화/복호화해서 기록한다.
+///			출력은 aes256_crypt_buffer_v2() 와 호환된다. (v2 포맷)
+///			사용하는 메모리는 파일 크기와 무관하다. (4 GB 이상 파일도 처리 가능)
+///			입력과 출력이 같은 파일이면 임시 파일에 기록한 후 교체한다.
+bool
+aes256_crypt_file_stream(
+	_In_ const unsigned char* PassPhrase,
+	_In_ const uint32_t PassPhraseLen,
+	_In_ const std::wstring& input_file_path,
+	_In_ const std::wstring& output_file_path,
+	_In_ bool Encrypt,
+	_In_ const aes256_stream_options& options
 	);
 
 /// @brief AES256으로 메모리 버퍼를 암호화/복호화함 (보안 강화 버전)
@@ -45,4 +79,191 @@ aes256_crypt_buffer_v2(
 	_Outptr_ unsigned char*& Output,
 	_Out_ uint32_t& OutputLength,
 	_In_ bool Encrypt
-	);
\ No newline at end of file
+	);
+
+//
+//	AES-256-GCM 세그먼트 포맷 (bulk mode)
+//
+//	[aes256_gcm_header (64 bytes)]
+//	[segment 0 ciphertext][tag 0 (16 bytes)]
+//	[segment 1 ciphertext][tag 1 (16 bytes)]
+//	...
+//
+//	- key 는 PBKDF2-HMAC-SHA256(passphrase, salt, kdf_iterations) 로 만든다.
+//	- 세그먼트 i 의 IV 는 nonce_prefix (8 bytes) || big-endian(i) (4 bytes) 이다.
+//	  세그먼트마다 독립적인 카운터 범위를 사용하므로 병렬로 처리할 수 있다.
+//	- 세그먼트마다 헤더 전체와 마지막 세그먼트 여부를 AAD 로 인증하므로
+//	  세그먼트 변조, 순서 변경, 잘라내기, 헤더 변조를 모두 탐지한다.
+//	- 기존 CBC (v2) 포맷과는 호환되지 않는다. CBC 포맷은 그대로 유지된다.
+//
+#define AES256_GCM_MAGIC					0x4d434741		// 'AGCM'
+#define AES256_GCM_VERSION					1
+#define AES256_GCM_HEADER_SIZE				64
+#define AES256_GCM_TAG_SIZE					16
+#define AES256_GCM_SALT_SIZE				16
+#define AES256_GCM_KDF_ITERATIONS			100000
+#define AES256_GCM_DEFAULT_SEGMENT_SIZE		(1024 * 1024)
+#define AES256_GCM_MIN_SEGMENT_SIZE			(4 * 1024)
+#define AES256_GCM_MAX_SEGMENT_SIZE			(64 * 1024 * 1024)
+
+#pragma pack(push, 1)
+typedef struct aes256_gcm_header
+{
+	uint32_t magic;					///< AES256_GCM_MAGIC
+	uint16_t version;				///< AES256_GCM_VERSION
+	uint16_t header_size;			///< AES256_GCM_HEADER_SIZE
+	uint32_t segment_size;			///< 세그먼트 평문 크기 (마지막 세그먼트는 더 작을 수 있음)
+	uint32_t kdf_iterations;		///< PBKDF2 반복 횟수
+	uint64_t plaintext_length;
+	uint8_t salt[AES256_GCM_SALT_SIZE];
+	uint8_t nonce_prefix[8];
+	uint8_t reserved[16];
+} *paes256_gcm_header;
+#pragma pack(pop)
+static_assert(sizeof(aes256_gcm_header) == AES256_GCM_HEADER_SIZE, "invalid aes256_gcm_header size");
+
+/// @brief	GCM bulk mode 옵션
+typedef struct aes256_gcm_options
+{
+	aes256_gcm_options() :
+		segment_size(AES256_GCM_DEFAULT_SEGMENT_SIZE),
+		thread_count(0)
+	{}
+
+	uint32_t segment_size;		///< 암호화 시 세그먼트 크기 (4 KB ~ 64 MB), 복호화 시에는 헤더의 값을 사용
+	uint32_t thread_count;		///< 세그먼트를 처리할 스레드 수 (0 이면 CPU 수)
+} *paes256_gcm_options;
+
+/// @brief	Input 이 AES-256-GCM 세그먼트 포맷 (헤더) 으로 시작하는지 확인한다.
+///			CBC (v2) 포맷과 구분하기 위해 사용한다.
+bool
+is_aes256_gcm_buffer(
+	_In_reads_bytes_(InputLength) const unsigned char* Input,
+	_In_ size_t InputLength
+	);
+
+/// @brief	평문 크기에 대한 암호문 크기 (헤더 + 세그먼트별 tag 포함)
+size_t
+aes256_gcm_encrypted_length(
+	_In_ size_t PlainLength,
+	_In_ uint32_t SegmentSize = AES256_GCM_DEFAULT_SEGMENT_SIZE
+	);
+
+/// @brief	AES-256-GCM 세그먼트 포맷으로 암호화/복호화 한다.
+///			세그먼트들은 options.thread_count 개의 스레드에서 병렬로 처리된다.
+///			복호화 시 어느 세그먼트라도 인증에 실패하면 false 를 리턴하고
+///			출력을 만들지 않는다.
+/// @param	Output	malloc() 으로 할당되므로 호출자가 free() 해야 함
+bool
+aes256_gcm_crypt_buffer(
+	_In_ const unsigned char* PassPhrase,
+	_In_ const uint32_t PassPhraseLen,
+	_In_reads_bytes_(InputLength) const unsigned char* Input,
+	_In_ const size_t InputLength,
+	_Outptr_ unsigned char*& Output,
+	_Out_ size_t& OutputLength,
+	_In_ bool Encrypt,
+	_In_ const aes256_gcm_options& options = aes256_gcm_options()
+	);
+
+//
+//	aes256_session
+//
+typedef struct evp_cipher_ctx_st EVP_CIPHER_CTX;
+
+/// @brief	encrypt_many() 의 입력/출력 레코드
+typedef struct aes256_record
+{
+	const unsigned char* data;
+	uint32_t length;
+} *paes256_record;
+
+/// @brief	같은 passphrase 로 작은 버퍼를 많이 암호화/복호화 할 때 사용한다.
+///
+///			aes256_crypt_buffer_v2() 는 호출할 때마다 EVP_CIPHER_CTX 생성, 
+///			key 유도 (EVP_BytesToKey), 출력 버퍼 malloc 을 하지만, 세션은 
+///			initialize() 에서 key/IV 를 한번만 만들고 context (key schedule) 를 
+///			재사용하며, 호출자 버퍼나 세션이 소유한 버퍼에 출력한다.
+///
+///			salt 를 지정하지 않으면 출력은 aes256_crypt_buffer_v2() 와 동일하다. (v2 포맷)
+///			세션 하나를 여러 스레드에서 동시에 사용하면 안된다. (스레드마다 세션 하나)
+typedef class aes256_session
+{
+public:
+	aes256_session();
+	~aes256_session();
+
+	/// @param	salt	8 bytes, nullptr 이면 aes256_crypt_buffer_v2() 와 같은 고정 salt
+	bool initialize(_In_ const unsigned char* PassPhrase,
+					_In_ const uint32_t PassPhraseLen,
+					_In_opt_ const unsigned char* salt = nullptr);
+	void finalize();
+	bool initialized() const { return nullptr != _enc_ctx; }
+
+	/// @brief	레코드 하나의 최대 입력 크기 
+	///			(EVP_XXXUpdate() 의 길이가 int 이고, 패딩을 더해도 넘치지 않아야 함)
+	static const uint32_t max_input_length = 0x7fffffff - 16;
+
+	/// @brief	InputLength 바이트를 암호화했을 때의 출력 크기 (PKCS 패딩 포함)
+	///			InputLength 가 max_input_length 보다 크면 0
+	static uint32_t encrypted_length(_In_ uint32_t InputLength)
+	{
+		if (InputLength > max_input_length) return 0;
+		return (InputLength / 16 + 1) * 16;
+	}
+
+	/// @brief	호출자 버퍼에 암호화/복호화 한다.
+	///			암호화 시 OutputSize >= encrypted_length(InputLength),
+	///			복호화 시 OutputSize >= InputLength 이어야 한다.
+	///			InputLength 가 max_input_length 보다 크면 false
+	bool encrypt(_In_reads_bytes_(InputLength) const unsigned char* Input,
+				 _In_ uint32_t InputLength,
+				 _Out_writes_bytes_to_(OutputSize, OutputLength) unsigned char* Output,
+				 _In_ uint32_t OutputSize,
+				 _Out_ uint32_t& OutputLength);
+	bool decrypt(_In_reads_bytes_(InputLength) const unsigned char* Input,
+				 _In_ uint32_t InputLength,
+				 _Out_writes_bytes_to_(OutputSize, OutputLength) unsigned char* Output,
+				 _In_ uint32_t OutputSize,
+				 _Out_ uint32_t& OutputLength);
+
+	/// @brief	Output 의 크기를 조정해서 암호화/복호화 한다. 
+	///			같은 vector 를 재사용하면 할당이 일어나지 않는다.
+	bool encrypt(_In_reads_bytes_(InputLength) const unsigned char* Input,
+				 _In_ uint32_t InputLength,
+				 _Inout_ std::vector<unsigned char>& Output);
+	bool decrypt(_In_reads_bytes_(InputLength) const unsigned char* Input,
+				 _In_ uint32_t InputLength,
+				 _Inout_ std::vector<unsigned char>& Output);
+
+	/// @brief	records 를 모두 암호화해서 세션이 소유한 버퍼에 연속으로 기록한다.
+	///			results[i] 는 records[i] 의 암호문을 가리키며, 다음 
+	///			encrypt_many()/decrypt_many() 호출 전까지 유효하다.
+	bool encrypt_many(_In_reads_(count) const aes256_record* records,
+					  _In_ size_t count,
+					  _Out_ std::vector<aes256_record>& results);
+	bool decrypt_many(_In_reads_(count) const aes256_record* records,
+					  _In_ size_t count,
+					  _Out_ std::vector<aes256_record>& results);
+
+private:
+	bool crypt(_In_ bool encrypt,
+			   _In_reads_bytes_(InputLength) const unsigned char* Input,
+			   _In_ uint32_t InputLength,
+			   _Out_writes_bytes_to_(OutputSize, OutputLength) unsigned char* Output,
+			   _In_ uint32_t OutputSize,
+			   _Out_ uint32_t& OutputLength);
+	bool crypt_many(_In_ bool encrypt,
+					_In_reads_(count) const aes256_record* records,
+					_In_ size_t count,
+					_Out_ std::vector<aes256_record>& results);
+
+private:
+	EVP_CIPHER_CTX* _enc_ctx;
+	EVP_CIPHER_CTX* _dec_ctx;
+	unsigned char _iv[16];
+
+	/// encrypt_many()/decrypt_many() 출력 버퍼 (재사용)
+	std::vector<unsigned char> _pool;
+
+} *paes256_session;
\ No newline at end of file
@@ -13,6 +13,198 @@
 #include "stdafx.h"
 #include "CStream.h"
 #include "Win32Utils.h"
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+
+//
+//	스트림 버퍼 풀
+//
+typedef struct stream_pool_class
+{
+	std::mutex lock;
+	std::vector<char*> buffers;
+} *pstream_pool_class;
+
+static stream_pool_class _pool_classes[STREAM_POOL_CLASS_COUNT];
+static std::atomic<bool> _pool_enabled(false);
+static std::atomic<size_t> _pool_limit(STREAM_POOL_DEFAULT_LIMIT);
+static std::atomic<uint64_t> _pool_cached_bytes(0);
+static std::atomic<uint64_t> _pool_hits(0);
+static std::atomic<uint64_t> _pool_misses(0);
+static std::atomic<uint64_t> _pool_returns(0);
+static std::atomic<uint64_t> _pool_discards(0);
+
+/// @brief	전역 스트림이 풀보다 늦게 소멸되더라도 풀을 사용하지 않도록 
+///			(_pool_classes 보다 먼저 소멸된다) 풀을 끈다.
+static struct stream_pool_cleanup
+{
+	~stream_pool_cleanup() { stream_pool_enable(false); }
+} _pool_cleanup;
+
+/// @brief	size 를 담을 수 있는 가장 작은 클래스, 없으면 STREAM_POOL_CLASS_COUNT
+static uint32_t stream_pool_class_index(_In_ size_t size, _Out_ size_t& class_size)
+{
+	uint32_t index = 0;
+	class_size = STREAM_POOL_MIN_CLASS_SIZE;
+	while (class_size < size && index < STREAM_POOL_CLASS_COUNT)
+	{
+		class_size <<= 1;
+		++index;
+	}
+	return index;
+}
+
+void stream_pool_enable(_In_ bool enable)
+{
+	_pool_enabled.store(enable);
+	if (!enable)
+	{
+		stream_pool_trim();
+	}
+}
+
+bool stream_pool_enabled()
+{
+	return _pool_enabled.load(std::memory_order_relaxed);
+}
+
+void stream_pool_set_limit(_In_ size_t max_cached_bytes)
+{
+	_pool_limit.store(max_cached_bytes);
+}
+
+char* stream_pool_acquire(_In_ size_t size, _Out_ size_t& capacity)
+{
+	capacity = 0;
+	if (!_pool_enabled.load(std::memory_order_relaxed) || size > STREAM_POOL_MAX_CLASS_SIZE)
+	{
+		return nullptr;
+	}
+
+	size_t class_size;
+	const uint32_t index = stream_pool_class_index(size, class_size);
+	_ASSERTE(index < STREAM_POOL_CLASS_COUNT);
+
+	char* ptr = nullptr;
+	{
+		pstream_pool_class pc = &_pool_classes[index];
+		std::lock_guard<std::mutex> lock(pc->lock);
+		if (!pc->buffers.empty())
+		{
+			ptr = pc->buffers.back();
+			pc->buffers.pop_back();
+		}
+	}
+
+	if (nullptr != ptr)
+	{
+		_pool_cached_bytes.fetch_sub(class_size);
+		_pool_hits.fetch_add(1, std::memory_order_relaxed);
+	}
+	else
+	{
+		ptr = (char*)malloc(class_size);
+		if (nullptr == ptr) return nullptr;
+		_pool_misses.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	capacity = class_size;
+	return ptr;
+}
+
+void stream_pool_release(_In_opt_ char* ptr, _In_ size_t capacity)
+{
+	if (nullptr == ptr) return;
+
+	size_t class_size;
+	const uint32_t index = stream_pool_class_index(capacity, class_size);
+	if (!_pool_enabled.load(std::memory_order_relaxed) ||
+		index >= STREAM_POOL_CLASS_COUNT ||
+		class_size != capacity)
+	{
+		free(ptr);
+		_pool_discards.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+
+	//
+	//	한도를 넘으면 보관하지 않는다.
+	//
+	if (_pool_cached_bytes.fetch_add(class_size) + class_size > _pool_limit.load(std::memory_order_relaxed))
+	{
+		_pool_cached_bytes.fetch_sub(class_size);
+		free(ptr);
+		_pool_discards.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+
+	//
+	//	위의 확인 이후 stream_pool_enable(false) 가 trim 을 끝냈을 수 있으므로 
+	//	클래스 lock 을 잡은 상태에서 다시 확인한다. 
+	//	trim 은 플래그를 내린 뒤 같은 lock 을 잡기 때문에, 여기서 플래그가 
+	//	켜져 있다면 보관한 버퍼는 trim 이 해제한다.
+	//
+	bool cached = false;
+	{
+		pstream_pool_class pc = &_pool_classes[index];
+		std::lock_guard<std::mutex> lock(pc->lock);
+		if (_pool_enabled.load())
+		{
+			pc->buffers.push_back(ptr);
+			cached = true;
+		}
+	}
+
+	if (!cached)
+	{
+		_pool_cached_bytes.fetch_sub(class_size);
+		free(ptr);
+		_pool_discards.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+	_pool_returns.fetch_add(1, std::memory_order_relaxed);
+}
+
+void stream_pool_trim()
+{
+	size_t class_size = STREAM_POOL_MIN_CLASS_SIZE;
+	for (uint32_t index = 0; index < STREAM_POOL_CLASS_COUNT; ++index, class_size <<= 1)
+	{
+		std::vector<char*> buffers;
+		{
+			pstream_pool_class pc = &_pool_classes[index];
+			std::lock_guard<std::mutex> lock(pc->lock);
+			buffers.swap(pc->buffers);
+		}
+
+		for (char* ptr : buffers)
+		{
+			free(ptr);
+		}
+		_pool_cached_bytes.fetch_sub(buffers.size() * class_size);
+	}
+}
+
+stream_pool_stats stream_pool_get_stats()
+{
+	stream_pool_stats stats;
+	stats.hits = _pool_hits.load();
+	stats.misses = _pool_misses.load();
+	stats.returns = _pool_returns.load();
+	stats.discards = _pool_discards.load();
+	stats.cached_bytes = _pool_cached_bytes.load();
+	return stats;
+}
+
+void stream_pool_reset_stats()
+{
+	_pool_hits.store(0);
+	_pool_misses.store(0);
+	_pool_returns.store(0);
+	_pool_discards.store(0);
+}
 
 
 /// @brief	Constructor
@@ -91,7 +283,7 @@ CMemoryStream::IncreseSize(
 	{
 		if (nullptr != m_pMemory)
 		{
-			free(m_pMemory); 
+			stream_pool_release(m_pMemory, _capacity);
 			m_pMemory = nullptr;
 		}
 
@@ -114,18 +306,35 @@ CMemoryStream::IncreseSize(
 		//
 		size_t new_size = newSize;
 		_ASSERTE(_page_size > 0);			
-		uint32_t remain = newSize % _page_size;
+		size_t remain = newSize % _page_size;
 		if (0 != remain)
 		{
 			new_size += (_page_size - remain);
 		}		
+
+		//
+		//	풀이 켜져있으면 풀의 버퍼로 옮기고, 이전 버퍼는 풀에 반환한다.
+		//
+		size_t pool_capacity = 0;
+		char* ptr = stream_pool_acquire(new_size, pool_capacity);
+		if (nullptr != ptr)
+		{
+			if (nullptr != m_pMemory)
+			{
+				RtlCopyMemory(ptr, m_pMemory, min(m_size, _capacity));
+				stream_pool_release(m_pMemory, _capacity);
+			}
+			_capacity = pool_capacity;
+			m_pMemory = ptr;
+			return _capacity;
+		}
 		
-		char *ptr = (char *) realloc(m_pMemory, new_size);
+		ptr = (char *) realloc(m_pMemory, new_size);
 		if (nullptr == ptr)
 		{
 			// 메모리 부족, m_pMemory 는 변경되지 않음. 
 			log_err
-				"No resources for stream. req size=%u",
+				"No resources for stream. req size=%zu",
 				new_size
 				log_end;
 			return 0;
@@ -140,6 +349,20 @@ CMemoryStream::IncreseSize(
 	return _capacity;
 }
 
+/// @brief	required 바이트를 쓸 수 있도록 버퍼를 키운다. 
+///			필요한 만큼만 (페이지 단위로) 키우면 작은 쓰기를 반복할 때마다 
+///			재할당/복사가 일어나므로 (전체 O(n^2)), 현재 capacity 의 1.5 배 
+///			이상으로 키운다.
+bool CMemoryStream::Grow(_In_ size_t required)
+{
+	size_t new_size = _capacity + _capacity / 2;
+	if (new_size < required)
+	{
+		new_size = required;
+	}
+	return IncreseSize(new_size) >= required;
+}
+
 /// @brief	`size` 만큼 `Buffer` 에 복사하고, 스트림 포지션을 size 만큼 이동
 /// @return	성공시 `size` 를 리턴하고, 스트림의 읽기 가능한 영역이 `size` 보다 
 ///			작으면 0 (에러)을 리턴
@@ -243,11 +466,11 @@ CMemoryStream::WriteToStream(
 	if ( (m_pos >= 0) && (size >= 0) )
 	{
 		size_t pos = m_pos + size;
-		if (pos > 0)
+		if (pos > m_pos)
 		{
-			if (pos > m_size)
+			if (pos > _capacity)
 			{
-				if (0 == IncreseSize(pos))
+				if (!Grow(pos))
 				{
 					return 0;
 				}
@@ -402,3 +625,308 @@ std::wstring CMemoryStream::ReadWstring()
 		return _null_stringw;
 	}
 }
+
+
+/// @brief	Constructor
+CSegmentedStream::CSegmentedStream(_In_ size_t chunk_size)
+	:
+	_chunk_size(STREAM_POOL_MIN_CLASS_SIZE),
+	_chunk_shift(0),
+	m_size(0),
+	m_pos(0)
+{
+	while (_chunk_size < chunk_size && _chunk_size < STREAM_POOL_MAX_CLASS_SIZE)
+	{
+		_chunk_size <<= 1;
+	}
+	while (((size_t)1 << _chunk_shift) < _chunk_size)
+	{
+		++_chunk_shift;
+	}
+}
+
+/// @brief	Destructor
+CSegmentedStream::~CSegmentedStream()
+{
+	ClearStream();
+}
+
+/// @brief	스트림이 사용한 자원을 소멸한다. 
+///			(풀이 켜져있으면 청크를 풀에 반환한다)
+void CSegmentedStream::ClearStream(void)
+{
+	for (char* chunk : _chunks)
+	{
+		stream_pool_release(chunk, _chunk_size);
+	}
+	_chunks.clear();
+	m_size = 0;
+	m_pos = 0;
+}
+
+/// @brief	청크를 하나 추가한다.
+bool CSegmentedStream::AddChunk()
+{
+	size_t capacity = 0;
+	char* chunk = stream_pool_acquire(_chunk_size, capacity);
+	if (nullptr == chunk)
+	{
+		chunk = (char*)malloc(_chunk_size);
+		if (nullptr == chunk)
+		{
+			log_err
+				"No resources for stream. chunk size=%zu",
+				_chunk_size
+				log_end;
+			return false;
+		}
+	}
+	_ASSERTE(nullptr == chunk || 0 == capacity || capacity == _chunk_size);
+
+	_chunks.push_back(chunk);
+	return true;
+}
+
+/// @brief	pos 부터 size 만큼 Buffer 로 복사한다. (범위는 호출자가 확인)
+void 
+CSegmentedStream::CopyOut(
+	_In_ size_t pos, 
+	_Out_ char* Buffer, 
+	_In_ size_t size
+	)
+{
+	size_t done = 0;
+	while (done < size)
+	{
+		const size_t offset = pos & (_chunk_size - 1);
+		const size_t count = min(_chunk_size - offset, size - done);
+		RtlCopyMemory(&Buffer[done], &_chunks[pos >> _chunk_shift][offset], count);
+		done += count;
+		pos += count;
+	}
+}
+
+/// @brief	`size` 만큼 `Buffer` 에 복사하고, 스트림 포지션을 size 만큼 이동
+/// @return	성공시 `size` 를 리턴하고, 스트림의 읽기 가능한 영역이 `size` 보다 
+///			작으면 0 (에러)을 리턴
+size_t
+CSegmentedStream::ReadFromStream(
+	_Out_ char* const Buffer,
+	_In_ const size_t size
+	)
+{
+	_ASSERTE(size > 0);
+	_ASSERTE(size <= m_size);
+	if (size == 0 || size > m_size)
+	{
+		log_err
+			"Invalid parameter. =%zu, m_size=%zu",
+			size,
+			m_size
+			log_end;
+		return 0;
+	}
+
+	size_t cb_can_read = m_size - m_pos;
+	if (size > cb_can_read)
+	{
+		log_err
+			"Invalid request. available=%zu, size=%zu",
+			cb_can_read,
+			size
+			log_end;
+		return 0;
+	}
+
+	CopyOut(m_pos, Buffer, size);
+	m_pos += size;
+	return size;
+}
+
+/// @brief	현재 포지션부터 최대 size 만큼 복사하고, 복사한 크기를 리턴한다.
+size_t
+CSegmentedStream::ReadSome(
+	_Out_ char* const Buffer,
+	_In_ const size_t size
+	)
+{
+	_ASSERTE(nullptr != Buffer);
+	if (nullptr == Buffer || m_pos >= m_size) return 0;
+
+	const size_t count = min(size, m_size - m_pos);
+	CopyOut(m_pos, Buffer, count);
+	m_pos += count;
+	return count;
+}
+
+/// @brief	버퍼로부터 데이터를 읽어 스트림의 현재 포지션에 쓴다.
+///			CMemoryStream 과 마찬가지로 쓰고 난 위치가 스트림의 끝이 된다.
+///			모자란 만큼 청크만 추가하고, 이미 쓴 데이터는 옮기지 않는다.
+///			성공시 Write 한 바이트 수
+///			실패시 0
+size_t
+CSegmentedStream::WriteToStream(
+	const char* Buffer,
+	size_t size
+	)
+{
+	_ASSERTE(nullptr != Buffer);
+	_ASSERTE(size > 0);
+	if (nullptr == Buffer || size == 0 || (size_t)(-1) == size)
+	{
+		return 0;
+	}
+
+	const size_t end = m_pos + size;
+	if (end < m_pos) return 0;
+
+	while (GetCapacity() < end)
+	{
+		if (!AddChunk()) return 0;
+	}
+
+	size_t done = 0;
+	size_t pos = m_pos;
+	while (done < size)
+	{
+		const size_t offset = pos & (_chunk_size - 1);
+		const size_t count = min(_chunk_size - offset, size - done);
+		RtlCopyMemory(&_chunks[pos >> _chunk_shift][offset], &Buffer[done], count);
+		done += count;
+		pos += count;
+	}
+
+	m_pos = end;
+	m_size = m_pos;
+	return size;
+}
+
+/// @brief	[offset, GetSize()) 범위를 청크 단위로 iov 에 넣는다.
+size_t 
+CSegmentedStream::GetIovec(
+	_Out_ std::vector<stream_iovec>& iov, 
+	_In_ size_t offset
+	)
+{
+	iov.clear();
+
+	size_t pos = offset;
+	while (pos < m_size)
+	{
+		const size_t chunk_offset = pos & (_chunk_size - 1);
+		stream_iovec v;
+		v.base = &_chunks[pos >> _chunk_shift][chunk_offset];
+		v.len = min(_chunk_size - chunk_offset, m_size - pos);
+		iov.push_back(v);
+		pos += v.len;
+	}
+	return iov.size();
+}
+
+/// @brief	스트림 전체를 문자열로 복사한다.
+std::string CSegmentedStream::to_str()
+{
+	if (0 == m_size) return _null_stringa;
+
+	std::string str;
+	str.resize(m_size);
+	CopyOut(0, &str[0], m_size);
+	return str;
+}
+
+/// @brief	스트림 전체를 청크 단위로 파일의 현재 위치에 쓴다.
+bool CSegmentedStream::WriteToFile(_In_ HANDLE file_handle)
+{
+	_ASSERTE(nullptr != file_handle && INVALID_HANDLE_VALUE != file_handle);
+	if (nullptr == file_handle || INVALID_HANDLE_VALUE == file_handle) return false;
+
+	std::vector<stream_iovec> iov;
+	GetIovec(iov);
+	for (const auto& v : iov)
+	{
+		size_t done = 0;
+		while (done < v.len)
+		{
+			DWORD bytes_written = 0;
+			if (!WriteFile(file_handle,
+						   &v.base[done],
+						   (DWORD)(v.len - done),
+						   &bytes_written,
+						   nullptr))
+			{
+				log_err "WriteFile() failed. file handle=0x%p, gle=%u",
+					file_handle,
+					GetLastError()
+					log_end;
+				return false;
+			}
+			if (0 == bytes_written)
+			{
+				log_err "WriteFile() wrote nothing. file handle=0x%p, remain=%zu",
+					file_handle,
+					v.len - done
+					log_end;
+				return false;
+			}
+			done += bytes_written;
+		}
+	}
+	return true;
+}
+
+/// @brief	스트림에 std::string 을 쓴다. (바이트 수, 내용)
+bool CSegmentedStream::WriteString(_In_ const std::string& str)
+{
+	if (true != WriteInt<size_t>(str.size() * sizeof(char)))
+	{
+		return false;
+	}
+	if (str.empty()) return true;
+
+	return (str.size() * sizeof(char) == WriteToStream(str.c_str(), str.size() * sizeof(char)));
+}
+
+/// @brief	스트림에 std::wstring 을 쓴다. (바이트 수, 내용)
+bool CSegmentedStream::WriteWstring(_In_ const std::wstring& wstr)
+{
+	if (true != WriteInt<size_t>(wstr.size() * sizeof(wchar_t)))
+	{
+		return false;
+	}
+	if (wstr.empty()) return true;
+
+	return (wstr.size() * sizeof(wchar_t) == WriteToStream((const char*)wstr.c_str(), wstr.size() * sizeof(wchar_t)));
+}
+
+/// @brief	Reads std::string from stream.
+std::string CSegmentedStream::ReadString()
+{
+	size_t size = ReadInt<size_t>();
+	if (0 == size || size > m_size - m_pos) return _null_stringa;
+
+	std::string str;
+	str.resize(size / sizeof(char));
+	if (size != ReadFromStream(&str[0], size))
+	{
+		return _null_stringa;
+	}
+	return str;
+}
+
+/// @brief	Reads std::wstring from stream.
+std::wstring CSegmentedStream::ReadWstring()
+{
+	size_t size = ReadInt<size_t>();
+	if (0 == size || size > m_size - m_pos) return _null_stringw;
+
+	_ASSERTE(0 == size % sizeof(wchar_t));
+	if (0 != size % sizeof(wchar_t)) return _null_stringw;
+
+	std::wstring wstr;
+	wstr.resize(size / sizeof(wchar_t));
+	if (size != ReadFromStream((char*)&wstr[0], size))
+	{
+		return _null_stringw;
+	}
+	return wstr;
+}
@@ -13,6 +13,53 @@
 #pragma once
 #include "BaseWindowsHeader.h"
 
+//
+//	스트림 버퍼 풀 
+//
+//	프로세스 전역, 크기 클래스 (4KB ~ 16MB, 2 의 거듭제곱) 별로 반환된 버퍼를 
+//	보관해두었다가 다음 스트림이 재사용한다. 스트림을 많이 만들고 지우는 
+//	경우 (업로드, HTTP 응답) 의 할당/해제를 줄인다. 
+//	기본은 꺼져있고, stream_pool_enable(true) 로 켠다. 
+//	풀의 버퍼도 malloc() 으로 할당하므로 ReleaseMemory() 로 넘겨받은 
+//	버퍼는 그대로 free() 하면 된다.
+//
+#define STREAM_POOL_MIN_CLASS_SIZE		(4 * 1024)
+#define STREAM_POOL_CLASS_COUNT			13			///< 4KB ~ 16MB
+#define STREAM_POOL_MAX_CLASS_SIZE		(STREAM_POOL_MIN_CLASS_SIZE << (STREAM_POOL_CLASS_COUNT - 1))
+#define STREAM_POOL_DEFAULT_LIMIT		(64 * 1024 * 1024)
+
+typedef struct stream_pool_stats
+{
+	uint64_t hits;			///< 풀에 있던 버퍼를 재사용
+	uint64_t misses;		///< 풀이 비어있어서 새로 할당
+	uint64_t returns;		///< 풀에 반환된 버퍼
+	uint64_t discards;		///< 풀이 꺼져있거나 가득 차서 (또는 크기가 맞지 않아서) 해제된 버퍼
+	uint64_t cached_bytes;	///< 지금 풀에 보관중인 버퍼 크기의 합
+} *pstream_pool_stats;
+
+/// @brief	풀을 켜거나 끈다. 끌 때 보관중인 버퍼를 모두 해제한다.
+void stream_pool_enable(_In_ bool enable);
+bool stream_pool_enabled();
+
+/// @brief	풀에 보관할 버퍼 크기의 합 (기본 STREAM_POOL_DEFAULT_LIMIT)
+void stream_pool_set_limit(_In_ size_t max_cached_bytes);
+
+/// @brief	size 이상인 가장 작은 클래스의 버퍼를 꺼낸다. 
+///			capacity 에 버퍼의 실제 크기 (클래스 크기) 를 돌려준다. 
+///			size 가 STREAM_POOL_MAX_CLASS_SIZE 보다 크거나, 풀이 꺼져있으면 
+///			nullptr 을 리턴한다.
+char* stream_pool_acquire(_In_ size_t size, _Out_ size_t& capacity);
+
+/// @brief	버퍼를 풀에 반환한다. capacity 가 클래스 크기가 아니거나, 풀이 
+///			꺼져있거나, 가득 찼으면 해제한다. (ptr 은 malloc() 으로 할당된 것)
+void stream_pool_release(_In_opt_ char* ptr, _In_ size_t capacity);
+
+/// @brief	보관중인 버퍼를 모두 해제한다.
+void stream_pool_trim();
+
+stream_pool_stats stream_pool_get_stats();
+void stream_pool_reset_stats();
+
 //
 // 메모리 스트림 클래스 
 //
@@ -37,6 +84,10 @@ public:
 	bool Reserve(_In_ size_t size);
 	void ClearStream(void);
 
+	/// @brief	데이터만 비우고 버퍼 (capacity) 는 그대로 둔다. 
+	///			같은 스트림을 반복해서 채우는 경우 재할당하지 않는다.
+	void reset();
+
 	// 스트림 버퍼의 할당된 사이즈 (데이터 + 여유공간)
 	size_t GetCapacity() { return _capacity; }
 
@@ -65,11 +116,15 @@ public:
 		}
 	}
 
-	// 메모리 포인터를 리턴(소유권을 이전)한다.
+	// 메모리 포인터를 리턴(소유권을 이전)하고, 스트림을 비운다. 
+	// 데이터의 크기는 호출 전에 GetSize() 로 구해둔다.
 	char* ReleaseMemory()
 	{
 		char* r = m_pMemory;
 		m_pMemory = nullptr;
+		_capacity = 0;
+		m_size = 0;
+		m_pos = 0;
 		return r;
 	}
 	
@@ -133,6 +188,7 @@ public:
 
 private:	
 	size_t IncreseSize(_In_ size_t newSize);
+	bool Grow(_In_ size_t required);
 
 } *PMemoryStream;
 
@@ -140,11 +196,12 @@ private:
 
 
 /// @brief	스트림이 사용한 자원을 소멸한다. 
+///			(풀이 켜져있으면 버퍼를 풀에 반환한다)
 inline void CMemoryStream::ClearStream(void)
 {	
 	if (!_read_only && nullptr != m_pMemory)
 	{
-		free(m_pMemory);
+		stream_pool_release(m_pMemory, _capacity);
 	}
 
 	_capacity = 0;
@@ -154,6 +211,19 @@ inline void CMemoryStream::ClearStream(void)
 	_read_only = false;
 }
 
+/// @brief	데이터만 비우고 버퍼는 그대로 둔다. 
+inline void CMemoryStream::reset()
+{
+	if (_read_only)
+	{
+		ClearStream();
+		return;
+	}
+
+	m_size = 0;
+	m_pos = 0;
+}
+
 /// @brief	스트림의 포지션을 이동한다. 
 ///			스트림이 유효하고, 요청한 위치가 스트림 범위내인 경우 이동이 가능하다. 
 inline bool CMemoryStream::SetPos(_In_ size_t new_pos)
@@ -168,3 +238,132 @@ inline bool CMemoryStream::SetPos(_In_ size_t new_pos)
 		return false;
 	}
 }
+
+
+/// @brief	세그먼트 스트림의 청크 하나 (scatter/gather I/O 용)
+typedef struct stream_iovec
+{
+	const char* base;
+	size_t len;
+} *pstream_iovec;
+
+//
+// 세그먼트 (rope) 메모리 스트림 클래스
+//
+//	고정 크기 청크의 목록으로 데이터를 저장한다. 스트림이 커져도 청크만 
+//	추가하므로 이미 쓴 데이터를 재할당/복사하지 않는다. 
+//	읽기/쓰기 API 는 CMemoryStream 과 같고, 데이터가 연속된 메모리가 아니므로 
+//	GetMemory(), RefFromStream() 대신 GetIovec() 로 청크 목록을 구해서 
+//	curl 콜백, 파일 쓰기 등에 그대로 넘긴다.
+//	청크는 스트림 버퍼 풀 (stream_pool_enable()) 이 켜져있으면 풀에서 꺼낸다.
+//
+typedef class CSegmentedStream
+{
+public:
+	/// @param	chunk_size	청크 크기 (STREAM_POOL_MIN_CLASS_SIZE 이상의 
+	///						2 의 거듭제곱으로 올림)
+	explicit CSegmentedStream(_In_ size_t chunk_size = 64 * 1024);
+	virtual ~CSegmentedStream();
+
+	void ClearStream(void);
+
+	/// @brief	데이터만 비우고 청크는 그대로 둔다.
+	void reset();
+
+	// 할당된 청크 크기의 합
+	size_t GetCapacity() { return _chunks.size() * _chunk_size; }
+
+	size_t GetChunkSize() { return _chunk_size; }
+	size_t GetChunkCount() { return _chunks.size(); }
+
+	// 스트림의 사이즈
+	size_t GetSize() { return m_size; };
+
+	// 스트림의 포지션을 리턴한다.
+	size_t GetPos() { return m_pos; };
+
+	// 스트림의 포지션을 이동한다. 
+	bool SetPos(_In_ size_t new_pos);
+
+	/// @brief	[offset, GetSize()) 범위의 데이터를 청크 단위로 iov 에 넣는다. 
+	///			(iov 의 기존 내용은 지운다) 청크 수를 리턴한다.
+	///			스트림에 쓰면 (청크가 추가되거나 내용이 바뀌므로) 다시 구해야 한다.
+	size_t GetIovec(_Out_ std::vector<stream_iovec>& iov, _In_ size_t offset = 0);
+
+	// 스트림 객체를 문자열로 변환한다. (데이터를 복사한다)
+	std::string to_str();
+
+	/// @brief	스트림 전체를 청크 단위로 파일의 현재 위치에 쓴다.
+	bool WriteToFile(_In_ HANDLE file_handle);
+
+	// `size` 만큼 `Buffer` 에 복사하고, 스트림 포지션을 size 만큼 이동
+	size_t ReadFromStream(_Out_ char* const Buffer, _In_ const size_t size);
+
+	/// @brief	현재 포지션부터 최대 size 만큼 복사하고 복사한 크기를 리턴한다. 
+	///			(남은 데이터가 없으면 0, curl 읽기 콜백 용)
+	size_t ReadSome(_Out_ char* const Buffer, _In_ const size_t size);
+
+	// 버퍼로부터 데이터를 읽어 스트림의 현재 포지션에 쓴다.
+	size_t WriteToStream(_In_ const char* Buffer, _In_ size_t size);
+
+	/// @brief	스트림으로부터 integer type 값을 읽고, 읽은 값을 리턴한다.
+	///			(CMemoryStream::ReadInt() 참고)
+	template <typename int_type> int_type ReadInt()
+	{
+		int_type value;
+		if (sizeof(value) != ReadFromStream((char*)&value, sizeof(value)))
+		{
+			return 0;
+		}
+		else
+		{
+			return value;
+		}
+	}
+
+	/// @brief	스트림에 integer type 값을 쓰고, 성공시 true 를 리턴한다.
+	template <typename int_type> bool WriteInt(const int_type value)
+	{
+		return (sizeof(value) == WriteToStream((const char*)&value, sizeof(value)));
+	}
+
+	/// string/wstring 전용 함수 (CMemoryStream 과 같은 형식)
+	bool WriteString(_In_ const std::string& str);
+	bool WriteWstring(_In_ const std::wstring& wstr);
+
+	std::string ReadString();
+	std::wstring ReadWstring();
+
+private:
+	bool AddChunk();
+	void CopyOut(_In_ size_t pos, _Out_ char* Buffer, _In_ size_t size);
+
+private:
+	size_t _chunk_size;
+	uint32_t _chunk_shift;
+	std::vector<char*> _chunks;
+
+	size_t m_size;
+	size_t m_pos;
+
+} *PSegmentedStream;
+
+/// @brief	스트림의 포지션을 이동한다. (CMemoryStream::SetPos() 와 같은 조건)
+inline bool CSegmentedStream::SetPos(_In_ size_t new_pos)
+{
+	if (m_size > 0 && m_size >= new_pos)
+	{
+		m_pos = new_pos;
+		return true;
+	}
+	else
+	{
+		return false;
+	}
+}
+
+inline void CSegmentedStream::reset()
+{
+	m_size = 0;
+	m_pos = 0;
+}
@@ -48,10 +48,20 @@
 
 #include "md5.h"
 #include "sha2.h"
+#include "hash_batch.h"
+#include "file_hash_engine.h"
+#include "file_hash_cache.h"
 #include "FileIoHelperClass.h"
 #include "ResourceHelper.h"
 #include "gpt_partition_guid.h"
 #include "process_tree.h"
+#include "utf_transcode.h"
+#include "string_tokenizer.h"
+#include "case_fold.h"
+#include "hex_codec.h"
+#include "num_parse.h"
+#include "prng.h"
+#include "timestamp.h"
 
 
 char _int_to_char_table[] = {
@@ -96,13 +106,11 @@ char _ascii_table[] = {
 };
 
 
-/// @brief	int type 랜덤값을 리턴한다.
+/// @brief	[min, max] 범위의 int type 랜덤값을 리턴한다. (max 포함)
+///			스레드별 PRNG 를 사용하므로 보안용 값에는 사용하면 안된다. (csprng_fill())
 int get_random_int(_In_ int min, _In_ int max)
 {
-	std::random_device seed;
-	std::default_random_engine re(seed());
-	std::uniform_int_distribution<uint32_t> range(min, max);
-	return range(re);
+	return (int)prng_range(min, max);
 }
 
 /// @brief	
@@ -324,22 +332,71 @@ add_day_to_file_time(
 }
 
 
-/// @brief	현재 시각을 `2017-05-23 21:23:24.821` 포맷 문자열로 출력한다. 
-std::string	time_now_to_str(_In_ bool localtime, _In_ bool show_misec)
+/// @brief	sys_time_to_str() 포맷 (show_misec 이면 `2017-05-23 21:23:24 821`)
+static std::string unix_msec_to_str(_In_ int64_t unix_msec, _In_ bool localtime, _In_ bool show_misec)
 {
-	SYSTEMTIME utc_system_time;
-	GetSystemTime(&utc_system_time);
+	char buf[TIMESTAMP_BUF_SIZE];
+	size_t len = format_timestamp(unix_msec, 
+								  localtime, 
+								  timestamp_style::date_time, 
+								  buf, 
+								  sizeof(buf));
+	if (0 == len)
+	{
+		log_err "Can't make time string. unix_msec=%lld", unix_msec log_end;
+		return std::string("1601-01-01 00:00:000");
+	}
+
+	if (show_misec)
+	{
+		const int64_t second = (unix_msec >= 0) ? unix_msec / 1000 : -((-unix_msec + 999) / 1000);
+		buf[len++] = ' ';
+		len += (size_t)format_to(&buf[len], sizeof(buf) - len, "%u", (uint32_t)(unix_msec - second * 1000));
+	}
+	return std::string(buf, len);
+}
 
-	return sys_time_to_str(&utc_system_time, localtime, show_misec);
+/// @brief	`2017-05-23T21:23:24.821+09:00` 포맷 (localtime)
+static std::string unix_msec_to_str2(_In_ int64_t unix_msec)
+{
+	char buf[TIMESTAMP_BUF_SIZE];
+	size_t len = format_timestamp(unix_msec, 
+								  true, 
+								  timestamp_style::iso8601, 
+								  buf, 
+								  sizeof(buf));
+	if (0 == len)
+	{
+		log_err "Can't make time string. unix_msec=%lld", unix_msec log_end;
+		return std::string("1601-01-01T00:00:00.000+00:00");
+	}
+	return std::string(buf, len);
+}
+
+/// @brief	SYSTEMTIME (UTC) 을 unix_msec 로 변환한다. 
+static bool sys_time_to_unix_msec(_In_ const PSYSTEMTIME utc_sys_time, _Out_ int64_t& unix_msec)
+{
+	FILETIME ft;
+	if (!SystemTimeToFileTime(utc_sys_time, &ft))
+	{
+		unix_msec = 0;
+		return false;
+	}
+	unix_msec = timestamp_msec_from_filetime(file_time_to_int(&ft));
+	return true;
+}
+
+/// @brief	현재 시각을 `2017-05-23 21:23:24 821` 포맷 문자열로 출력한다. 
+///			초 단위로 캐시된 문자열을 사용하므로 매번 타임존 변환을 하지 않는다.
+std::string	time_now_to_str(_In_ bool localtime, _In_ bool show_misec)
+{
+	return unix_msec_to_str(timestamp_now_msec(), localtime, show_misec);
 }
 
 /// @brief	현재 시각을 `2017-05-23T21:23:24.821+09:00` 포맷 문자열로 출력한다. 
 std::string	time_now_to_str2()
 {
-	SYSTEMTIME utc_system_time;
-	GetSystemTime(&utc_system_time);
-
-	return sys_time_to_str2(&utc_system_time);
+	return unix_msec_to_str2(timestamp_now_msec());
 }
 
 /// @brief  현재 시각을 FILETIME 으로 리턴한다.
@@ -362,9 +419,7 @@ file_time_to_str(
 	_In_ bool show_misec
 )
 {
-	SYSTEMTIME utc;
-	FileTimeToSystemTime(file_time, &utc);
-	return sys_time_to_str(&utc, localtime, show_misec);
+	return file_time_to_str(file_time_to_int(file_time), localtime, show_misec);
 }
 
 /// @brief  FILETIME to `yyyy-mm-dd hh:mi:ss` string representation.
@@ -375,12 +430,11 @@ file_time_to_str(
 	_In_ bool show_misec
 )
 {
-	FILETIME ft;
-	int_to_file_time(file_time, &ft);
-	return file_time_to_str(&ft, localtime, show_misec);
+	return unix_msec_to_str(timestamp_msec_from_filetime(file_time), localtime, show_misec);
 }
 
 /// @brief  SYSTEMTIME (UTC) to `yyyy-mm-dd hh:mi:ss` string representation.
+///			show_misec 이면 `yyyy-mm-dd hh:mi:ss ms` (ms 는 자리수를 맞추지 않음)
 std::string
 sys_time_to_str(
 	_In_ const PSYSTEMTIME utc_sys_time,
@@ -388,58 +442,19 @@ sys_time_to_str(
 	_In_ bool show_misec
 )
 {
-	char buf[32];
-
-	SYSTEMTIME local;
-	PSYSTEMTIME time = utc_sys_time;
-
-	if (true == localtime)
-	{
-		SystemTimeToTzSpecificLocalTime(NULL, utc_sys_time, &local);
-		time = &local;
-	}
-
-	HRESULT hr;
-
-	if (!show_misec)
-	{
-		hr = StringCbPrintfA(buf, sizeof(buf),
-							 "%04u-%02u-%02u %02u:%02u:%02u",
-							 time->wYear,
-							 time->wMonth,
-							 time->wDay,
-							 time->wHour,
-							 time->wMinute,
-							 time->wSecond);
-	}
-	else
+	int64_t unix_msec;
+	if (!sys_time_to_unix_msec(utc_sys_time, unix_msec))
 	{
-		hr = StringCbPrintfA(buf, sizeof(buf),
-							 "%04u-%02u-%02u %02u:%02u:%02u %u",
-							 time->wYear,
-							 time->wMonth,
-							 time->wDay,
-							 time->wHour,
-							 time->wMinute,
-							 time->wSecond,
-							 time->wMilliseconds);
-	}
-
-	if (!SUCCEEDED(hr))
-	{
-		log_err "Can't make time string. hr=%u",
-			hr
-			log_end;
+		log_err "Can't make time string. gle=%u", GetLastError() log_end;
 		return std::string("1601-01-01 00:00:000");
 	}
-
-	return std::string(buf);
+	return unix_msec_to_str(unix_msec, localtime, show_misec);
 }
 
 
 /// @brief  `2017-05-23T21:23:24.821+09:00` 포맷 시간 문자열을 리턴한다. 
-///			[localtime][time zone] 포맷이므로 utc_sys_time 파라미터를 
-///			반드시 localtime 으로 변환해야 한다. 
+///			utc_sys_time 을 localtime 으로 변환하고, 그 시각의 타임존 
+///			오프셋 (일광 절약 시간 포함) 을 붙인다.
 ///
 ///			https://www.w3.org/TR/NOTE-datetime 참고
 std::string
@@ -447,50 +462,13 @@ sys_time_to_str2(
 	_In_ const PSYSTEMTIME utc_sys_time
 )
 {
-	char buf[32];
-
-	//
-	//	local time 으로 변환
-	// 
-	SYSTEMTIME local_sys_time;
-	SystemTimeToTzSpecificLocalTime(NULL, utc_sys_time, &local_sys_time);
-
-
-	//
-	//	타임존 정보
-	//	UTC+xxx 인 경우 TimeZone.Bias 값은 음수를 가지므로 +/- 기호를 설정한다.
-	TIME_ZONE_INFORMATION lpTimeZone = { 0 };
-	GetTimeZoneInformation(&lpTimeZone);
-
-	char tz_sign = '-';
-	if (0 > lpTimeZone.Bias)
-	{
-		tz_sign = '+';
-	}
-
-
-	HRESULT hr = StringCbPrintfA(buf,
-								 sizeof(buf),
-								 "%04u-%02u-%02uT%02u:%02u:%02u.%u%c%02u:%02u",
-								 local_sys_time.wYear,
-								 local_sys_time.wMonth,
-								 local_sys_time.wDay,
-								 local_sys_time.wHour,
-								 local_sys_time.wMinute,
-								 local_sys_time.wSecond,
-								 local_sys_time.wMilliseconds,
-								 tz_sign,
-								 labs(lpTimeZone.Bias / 60),
-								 labs(lpTimeZone.Bias % 60));
-	if (!SUCCEEDED(hr))
-	{
-		log_err "Can't make time string. hr=%u",
-			hr
-			log_end;
-		return std::string("1601-01-01T00:00:000+00:00");
+	int64_t unix_msec;
+	if (!sys_time_to_unix_msec(utc_sys_time, unix_msec))
+	{
+		log_err "Can't make time string. gle=%u", GetLastError() log_end;
+		return std::string("1601-01-01T00:00:00.000+00:00");
 	}
-
-	return std::string(buf);
+	return unix_msec_to_str2(unix_msec);
 }
 
 /// @brief	현재 시간을 ISO 8601 UTC 형식으로 변환
@@ -2607,12 +2585,52 @@ SaveBinaryFile(
 	return true;
 }
 
+/// @brief	file_digests 의 바이너리 해시를 hex 문자열로 변환한다.
+static
+bool
+file_digests_to_hexa(
+	_In_ const file_digests& digests,
+	_Out_opt_ const std::string* md5,
+	_Out_opt_ const std::string* sha2
+)
+{
+	if (nullptr != md5)
+	{
+		if (true != bin_to_hexa_fast(sizeof(digests.md5),
+									 (uint8_t*)digests.md5,
+									 false,
+									 (std::string&)*md5))
+		{
+			log_err "bin_to_hexa_fast() failed. " log_end;
+			return false;
+		}
+	}
+
+	if (nullptr != sha2)
+	{
+		if (true != bin_to_hexa_fast(sizeof(digests.sha256),
+									 (uint8_t*)digests.sha256,
+									 false,
+									 (std::string&)*sha2))
+		{
+			log_err "bin_to_hexa_fast() failed. " log_end;
+			return false;
+		}
+	}
+	return true;
+}
+
 /// @brief	파일의 해시를 계산한다.
+///
+///			cache 가 지정된 경우 파일을 FILE_READ_ATTRIBUTES 로만 열어서 
+///			key (볼륨, 파일 id, 크기, 시각) 를 구하고, 캐시에 있으면 파일 
+///			데이터를 읽지 않고 리턴한다. 없으면 해시를 계산해서 캐시에 추가한다.
 bool
 get_file_hash_by_filepath(
 	_In_ const wchar_t* file_path,
 	_Out_opt_ const std::string* md5,
-	_Out_opt_ const std::string* sha2
+	_Out_opt_ const std::string* sha2,
+	_In_opt_ file_hash_cache* cache
 )
 {
 	_ASSERTE(nullptr != file_path);
@@ -2622,6 +2640,23 @@ get_file_hash_by_filepath(
 		return false;
 	}
 
+	uint32_t digests = 0;
+	if (nullptr != md5) { digests |= FILE_HASH_MD5; }
+	if (nullptr != sha2) { digests |= FILE_HASH_SHA256; }
+
+	file_hash_cache_key key;
+	bool use_cache = (nullptr != cache && 
+					  cache->is_open() && 
+					  file_hash_cache::get_key(file_path, key));
+	if (use_cache)
+	{
+		file_digests cached;
+		if (cache->lookup(key, digests, cached))
+		{
+			return file_digests_to_hexa(cached, md5, sha2);
+		}
+	}
+
 	handle_ptr file_handle(
 		CreateFileW(file_path,
 					GENERIC_READ,
@@ -2648,9 +2683,34 @@ get_file_hash_by_filepath(
 		return false;
 	}
 
-	return get_file_hash_by_filehandle(file_handle.get(),
-									   md5,
-									   sha2);
+	//
+	//	조회에 사용한 key 는 경로로 따로 연 파일의 것이므로, 그 사이에 경로가 
+	//	rename/교체되었을 수 있다. 실제로 해싱할 핸들로 key 를 다시 구해서 
+	//	그 key 로 추가한다. 
+	//	(해싱하는 도중에 파일이 변경되면 다음 조회시 시각이 달라서 무효화된다)
+	//
+	if (use_cache)
+	{
+		use_cache = file_hash_cache::get_key(file_handle.get(), key);
+	}
+
+	if (!use_cache)
+	{
+		return get_file_hash_by_filehandle(file_handle.get(),
+										   md5,
+										   sha2);
+	}
+
+	file_digests result;
+	if (true != cache->hash_file(file_handle.get(), key, digests, result))
+	{
+		log_err "cache->hash_file() failed. path=%ws",
+			file_path
+			log_end;
+		return false;
+	}
+
+	return file_digests_to_hexa(result, md5, sha2);
 }
 
 
@@ -2669,98 +2729,206 @@ get_file_hash_by_filehandle(
 		return false;
 	}
 
-	bool ret = false;
-	MD5_CTX* ctx_md5 = nullptr;
-	sha256_ctx* ctx_sha2 = nullptr;
-	uint8_t* sha2_buf = nullptr;
-	do
-	{
-		if (nullptr != md5)
-		{
-			ctx_md5 = (MD5_CTX*)malloc(sizeof(MD5_CTX));
-			if (nullptr == ctx_md5) break;
-		}
+	//
+	//	NOTE by somma
+	//	MMIO 윈도우를 순서대로 매핑하면서 MD5, SHA-256 을 같은 스레드에서 
+	//	차례로 계산하던 것을 file_hash_engine 으로 변경했다. 
+	//	다음 윈도우를 읽는 동안 digest 별 워커 스레드가 현재 윈도우를 
+	//	해싱하므로 큰 파일에서는 I/O 와 해시 계산이 겹쳐진다.
+	//	엔진 (윈도우 버퍼) 은 엔진 풀에서 빌려서 재사용한다.
+	//
+	uint32_t digests = 0;
+	if (nullptr != md5) { digests |= FILE_HASH_MD5; }
+	if (nullptr != sha2) { digests |= FILE_HASH_SHA256; }
+
+	file_digests result;
+	file_hash_engine* engine = file_hash_engine_acquire();
+	const bool hashed = engine->hash_file(file_handle, digests, result);
+	file_hash_engine_release(engine);
+	if (true != hashed)
+	{
+		log_err "engine.hash_file() failed. file handle=0x%p",
+			file_handle
+			log_end;
+		return false;
+	}
 
-		if (nullptr != sha2)
-		{
-			ctx_sha2 = (sha256_ctx*)malloc(sizeof(sha256_ctx));
-			sha2_buf = (uint8_t*)malloc(32);
-			if (nullptr == ctx_sha2 || nullptr == sha2_buf) break;
-		}
+	return file_digests_to_hexa(result, md5, sha2);
+}
 
-		_ASSERTE(!(nullptr == ctx_md5 && nullptr == ctx_sha2));
 
-		/// NOTE by somma
-		/// ReadFile() 로 읽어서 해시를 구하던 코드를 FileIoHelper 를 사용해서
-		/// MMIO 로 변경했으나 성능상의 큰 이득은 없는것 같다. 
-		/// 어차피 실행 파일 사이즈가 작아서 크게 이득은 없을 듯 싶다.
-		FileIoHelper fio;
-		if (true != fio.OpenForRead(file_handle))
-		{
-			log_err "fio.OpenForRead() failed. file handle=0x%p",
-				file_handle
-				log_end;
-			break;
-		}
+/// @brief	여러 파일의 해시를 multi-buffer 해시(hash_batch.h)로 한번에 계산한다.
+///
+///			작은 파일들은 매핑해서 모아두었다가 md5_batch(), sha256_batch() 로
+///			SIMD lane 마다 파일 하나씩 동시에 해싱한다. 
+///			크기가 큰 파일은 lane 하나가 오래 붙잡히게 되므로 
+///			get_file_hash_by_filehandle() 로 따로 처리한다.
+///
+///			results 는 file_paths 와 같은 순서/개수로 채워지며, 개별 파일의 
+///			성공 여부는 file_hash_result::succeeded 로 확인한다.
+bool
+get_file_hash_batch(
+	_In_ const std::vector<std::wstring>& file_paths,
+	_In_ bool md5,
+	_In_ bool sha2,
+	_Out_ std::vector<file_hash_result>& results
+)
+{
+	_ASSERTE(!(true != md5 && true != sha2));
+	if (true != md5 && true != sha2) return false;
 
-		if (nullptr != ctx_md5) { MD5Init(ctx_md5, 0); }
-		if (nullptr != ctx_sha2) { sha256_begin(ctx_sha2); }
+	const uint64_t max_batch_file_size = 8 * 1024 * 1024;
+	const uint64_t max_batch_bytes = 64 * 1024 * 1024;
+	const size_t max_batch_files = 256;
 
-		bool err = false;
-		uint64_t file_size = fio.FileSize();
-		uint64_t pos = 0;
-		while (pos < file_size)
-		{
-			if (err) break;
-						
-			uint32_t size = (uint32_t)min(fio.GetOptimizedBlockSize(), file_size - pos);
-			uint8_t* ptr = fio.GetFilePointer(true, pos, size);
+	results.clear();
+	results.resize(file_paths.size());
 
-			if (nullptr != ctx_md5) { MD5Update(ctx_md5, ptr, size); }
-			if (nullptr != ctx_sha2) { sha256_hash(ptr, size, ctx_sha2); }
+	size_t next = 0;
+	while (next < file_paths.size())
+	{
+		//
+		//	한번에 처리할 파일들을 오픈/매핑한다.
+		//
+		std::vector<size_t> indexes;
+		std::vector<handle_ptr> handles;
+		std::vector<std::unique_ptr<FileIoHelper>> fios;
+		std::vector<const uint8_t*> ptrs;
+		std::vector<size_t> sizes;
+		uint64_t batch_bytes = 0;
+
+		for (; 
+			 next < file_paths.size() && 
+			 indexes.size() < max_batch_files && 
+			 batch_bytes < max_batch_bytes;
+			 ++next)
+		{
+			file_hash_result& result = results[next];
+
+			handle_ptr file_handle(
+				CreateFileW(file_paths[next].c_str(),
+							GENERIC_READ,
+							FILE_SHARE_DELETE | FILE_SHARE_READ | FILE_SHARE_WRITE,
+							NULL,
+							OPEN_EXISTING,
+							FILE_ATTRIBUTE_NORMAL,
+							NULL),
+				[](HANDLE h)
+			{
+				if (INVALID_HANDLE_VALUE != h)
+				{
+					CloseHandle(h);
+				}
+			});
+			if (INVALID_HANDLE_VALUE == file_handle.get())
+			{
+				log_err
+					"CreateFileW() failed. path=%ws, gle = %u",
+					file_paths[next].c_str(),
+					GetLastError()
+					log_end;
+				continue;
+			}
 
-			fio.ReleaseFilePointer();
-			pos += size;
+			LARGE_INTEGER file_size = { 0 };
+			if (!GetFileSizeEx(file_handle.get(), &file_size))
+			{
+				log_err
+					"GetFileSizeEx() failed. path=%ws, gle = %u",
+					file_paths[next].c_str(),
+					GetLastError()
+					log_end;
+				continue;
+			}
+
+			if ((uint64_t)file_size.QuadPart > max_batch_file_size)
+			{
+				result.succeeded = get_file_hash_by_filehandle(file_handle.get(),
+															   md5 ? &result.md5 : nullptr,
+															   sha2 ? &result.sha2 : nullptr);
+				continue;
+			}
+
+			const uint8_t* ptr = nullptr;
+			std::unique_ptr<FileIoHelper> fio;
+			if (0 != file_size.QuadPart)
+			{
+				fio = std::make_unique<FileIoHelper>();
+				if (true != fio->OpenForRead(file_handle.get()))
+				{
+					log_err "fio.OpenForRead() failed. path=%ws",
+						file_paths[next].c_str()
+						log_end;
+					continue;
+				}
+
+				ptr = fio->GetFilePointer(true, 0, (uint32_t)file_size.QuadPart);
+				if (nullptr == ptr)
+				{
+					log_err "fio.GetFilePointer() failed. path=%ws",
+						file_paths[next].c_str()
+						log_end;
+					continue;
+				}
+			}
+
+			indexes.push_back(next);
+			handles.push_back(std::move(file_handle));
+			fios.push_back(std::move(fio));
+			ptrs.push_back(ptr);
+			sizes.push_back((size_t)file_size.QuadPart);
+			batch_bytes += (uint64_t)file_size.QuadPart;
 		}
 
-		if (nullptr != ctx_md5) { MD5Final(ctx_md5); }
-		if (nullptr != ctx_sha2) { sha256_end(sha2_buf, ctx_sha2); }
+		if (indexes.empty()) continue;
 
 		//
-		//	Hash 바이너리 버퍼를 hex 문자열로 변환
+		//	lane 병렬 해싱 후 hex 문자열로 변환
 		//
-		std::string tmp;
-		if (nullptr != ctx_md5)
+		std::vector<uint8_t> md5_digests;
+		std::vector<uint8_t> sha2_digests;
+		if (true == md5)
 		{
-			if (true != bin_to_hexa_fast(sizeof(ctx_md5->digest),
-										 ctx_md5->digest,
-										 false,
-										 (std::string&)*md5))
-			{
-				log_err "bin_to_hexa_fast() failed. " log_end;
-				break;
-			}
+			md5_digests.resize(indexes.size() * MD5_BATCH_DIGEST_SIZE);
+			md5_batch(indexes.size(),
+					  ptrs.data(),
+					  sizes.data(),
+					  (uint8_t(*)[MD5_BATCH_DIGEST_SIZE])md5_digests.data());
+		}
+		if (true == sha2)
+		{
+			sha2_digests.resize(indexes.size() * SHA256_BATCH_DIGEST_SIZE);
+			sha256_batch(indexes.size(),
+						 ptrs.data(),
+						 sizes.data(),
+						 (uint8_t(*)[SHA256_BATCH_DIGEST_SIZE])sha2_digests.data());
 		}
 
-		if (nullptr != ctx_sha2)
+		for (size_t i = 0; i < indexes.size(); ++i)
 		{
-			if (true != bin_to_hexa_fast(32,
-										 sha2_buf,
-										 false,
-										 (std::string&)*sha2))
+			file_hash_result& result = results[indexes[i]];
+			bool ok = true;
+			if (true == md5)
 			{
-				log_err "bin_to_hexa_fast() failed. " log_end;
-				break;
+				ok &= bin_to_hexa_fast(MD5_BATCH_DIGEST_SIZE,
+									   &md5_digests[i * MD5_BATCH_DIGEST_SIZE],
+									   false,
+									   result.md5);
 			}
-		}
+			if (true == sha2)
+			{
+				ok &= bin_to_hexa_fast(SHA256_BATCH_DIGEST_SIZE,
+									   &sha2_digests[i * SHA256_BATCH_DIGEST_SIZE],
+									   false,
+									   result.sha2);
+			}
+			result.succeeded = ok;
 
-		ret = true;
-	} while (false);
+			if (fios[i]) { fios[i]->ReleaseFilePointer(); }
+		}
+	}
 
-	free_and_nil(ctx_md5);
-	free_and_nil(ctx_sha2);
-	free_and_nil(sha2_buf);
-	return ret;
+	return true;
 }
 
 
@@ -3611,280 +3779,181 @@ wchar_t* Utf8MbsToWcs(_In_ const char* utf8)
 	return outWchar;
 }
 
-/**
-* @brief
-* @param
-* @see
-* @remarks
-* @code
-* @endcode
-* @return
-*/
-std::wstring MbsToWcsEx(_In_ const char *mbs)
+/// @brief	CP_ACP 문자열을 wide 문자열로 변환한다.
+///			ASCII 문자열은 Win32 API 를 호출하지 않고 바로 변환하고, 그 외에는
+///			wcs 를 최대 길이로 한번만 resize 해서 MultiByteToWideChar() 를 
+///			한번만 호출한다. (wcs 를 재사용하면 할당이 없다)
+bool MbsToWcsEx(_In_ const char *mbs, _Out_ std::wstring& wcs)
 {
-	_ASSERTE(nullptr != mbs);	
-	if (nullptr == mbs) return _null_stringw;
-	if (0x00 == mbs[0]) return _null_stringw;
+	wcs.clear();
 
-	//
-	//	필요한 버퍼 사이즈 구하기
-	//
-	int outLen = MultiByteToWideChar(CP_ACP,
-									 MB_PRECOMPOSED,
-									 mbs,
-									 -1,
-									 nullptr,
-									 0);
-	if (0 == outLen) return _null_stringw;
+	_ASSERTE(nullptr != mbs);
+	if (nullptr == mbs) return false;
+
+	const size_t length = strlen(mbs);
+	if (0 == length) return true;
+	if (length > INT_MAX) return false;
 
 	//
-	//	버퍼 할당 
-	//	- outLen contains NULL char
+	//	ANSI 코드 페이지의 0x00~0x7f 는 ASCII 와 같다.
 	//
-	wchar_ptr outWchar((wchar_t*)malloc(outLen * (sizeof(wchar_t))),
-					   [](wchar_t* p)
+	if (length == ascii_prefix_length(mbs, length))
 	{
-		if (nullptr != p) free(p);
-	});
-
-	if (nullptr == outWchar.get()) return _null_stringw;
-	RtlZeroMemory(outWchar.get(), outLen);
+		return utf8_to_utf16(mbs, length, wcs);
+	}
 
 	//
-	//	문자열 변환
+	//	CP_ACP 의 한 바이트는 최대 한 문자로 변환된다.
 	//
-	if (0 == MultiByteToWideChar(CP_ACP, 
-								 MB_PRECOMPOSED, 
-								 mbs, 
-								 -1, 
-								 outWchar.get(), 
-								 outLen))
+	wcs.resize(length);
+	int outLen = MultiByteToWideChar(CP_ACP,
+									 MB_PRECOMPOSED,
+									 mbs,
+									 (int)length,
+									 &wcs[0],
+									 (int)length);
+	if (0 == outLen)
 	{
 		log_err
 			"MultiByteToWideChar() failed, errcode=0x%08x",
 			GetLastError()
 			log_end;
-		return _null_stringw;
+		wcs.clear();
+		return false;
 	}
 
-	return std::wstring(outWchar.get());
+	wcs.resize(outLen);
+	return true;
 }
 
-/**
-* @brief
-* @param
-* @see
-* @remarks
-* @code
-* @endcode
-* @return
-*/
-std::string WcsToMbsEx(_In_ const wchar_t *wcs)
+std::wstring MbsToWcsEx(_In_ const char *mbs)
+{
+	std::wstring wcs;
+	MbsToWcsEx(mbs, wcs);
+	return wcs;
+}
+
+/// @brief	wide 문자열을 CP_ACP 문자열로 변환한다.
+///			ASCII 문자열은 Win32 API 를 호출하지 않고 바로 변환한다.
+bool WcsToMbsEx(_In_ const wchar_t *wcs, _Out_ std::string& mbs)
 {
-	_ASSERTE(nullptr != wcs);	
-	if (nullptr == wcs) return _null_stringa;
-	if (0x00 == wcs[0]) return _null_stringa;
+	mbs.clear();
+
+	_ASSERTE(nullptr != wcs);
+	if (nullptr == wcs) return false;
+
+	const size_t length = wcslen(wcs);
+	if (0 == length) return true;
+	if (length > INT_MAX / 3) return false;
+
+	if (length == ascii_prefix_length(wcs, length))
+	{
+		return utf16_to_utf8(wcs, length, mbs);
+	}
 
 	//
-	//	변환에 필요한 버퍼 사이즈 구하기
+	//	한 문자는 최대 3 바이트로 변환된다. (DBCS 는 2 바이트, ACP 가 UTF-8 이면 3 바이트)
 	//
+	mbs.resize(length * 3);
 	int outLen = WideCharToMultiByte(CP_ACP, 
 									 0, 
 									 wcs, 
-									 -1, 
-									 nullptr, 
-									 0, 
+									 (int)length, 
+									 &mbs[0], 
+									 (int)mbs.size(), 
 									 nullptr, 
 									 nullptr);
-	if (0 == outLen) return _null_stringa;
-
-	//
-	//	버퍼 할당
-	//
-	char_ptr outChar((char*)malloc(outLen * sizeof(char)),
-					 [](char* p)
-	{
-		if (nullptr != p) free(p);
-	});
-	if (nullptr == outChar.get()) return _null_stringa;
-	RtlZeroMemory(outChar.get(), outLen);
-
-	//
-	//	변환
-	//
-	if (0 == WideCharToMultiByte(CP_ACP, 
-								 0, 
-								 wcs, 
-								 -1, 
-								 outChar.get(), 
-								 outLen, 
-								 nullptr, 
-								 nullptr))
+	if (0 == outLen)
 	{
 		log_err
 			"WideCharToMultiByte() failed, errcode=0x%08x",
 			GetLastError()
 			log_end;			
-		return _null_stringa;
+		mbs.clear();
+		return false;
 	}
 
-	return std::string(outChar.get());
+	mbs.resize(outLen);
+	return true;
 }
 
-/**
-* @brief
-* @param
-* @see
-* @remarks
-* @code
-* @endcode
-* @return
-*/
-std::string WcsToMbsUTF8Ex(_In_ const wchar_t *wcs)
+std::string WcsToMbsEx(_In_ const wchar_t *wcs)
 {
-	_ASSERTE(nullptr != wcs);
-	if (nullptr == wcs) return _null_stringa;
-	if (0x00 == wcs[0]) return _null_stringa;
-	
-	//
-	//	변환에 필요한 버퍼 사이즈 계산
-	//
-	int outLen = WideCharToMultiByte(CP_UTF8, 
-									 0, 
-									 wcs, 
-									 -1, 
-									 nullptr, 
-									 0, 
-									 nullptr, 
-									 nullptr);
-	if (0 == outLen) return _null_stringa;
+	std::string mbs;
+	WcsToMbsEx(wcs, mbs);
+	return mbs;
+}
 
-	char_ptr outChar((char*)malloc(outLen * sizeof(char)),
-					 [](char* p)
-	{
-		if (nullptr != p) free(p);
-	});
-	if (nullptr == outChar.get()) return _null_stringa;
-	RtlZeroMemory(outChar.get(), outLen);
+/// @brief	wide 문자열을 UTF-8 문자열로 변환한다. (Win32 API 를 사용하지 않음)
+///			짝이 맞지 않는 surrogate 는 WideCharToMultiByte() 처럼 U+FFFD 로 바꾼다.
+bool WcsToMbsUTF8Ex(_In_ const wchar_t *wcs, _Out_ std::string& utf8)
+{
+	utf8.clear();
 
-	//
-	//	변환
-	//
-	if (0 == WideCharToMultiByte(CP_UTF8, 
-								 0, 
-								 wcs, 
-								 -1, 
-								 outChar.get(), 
-								 outLen, 
-								 nullptr, 
-								 nullptr))
-	{
-		log_err
-			"WideCharToMultiByte() failed, errcode=0x%08x",
-			GetLastError()
-			log_end;
-		return _null_stringa;
-	}
+	_ASSERTE(nullptr != wcs);
+	if (nullptr == wcs) return false;
 
-	return std::string(outChar.get());
+	return utf16_to_utf8(wcs, wcslen(wcs), utf8);
 }
 
-/// @brief	
-std::wstring Utf8MbsToWcsEx(_In_ const char* utf8)
+std::string WcsToMbsUTF8Ex(_In_ const wchar_t *wcs)
 {
-	_ASSERTE(nullptr != utf8);
-	if (nullptr == utf8) return _null_stringw;
-	if (0x00 == utf8[0]) return _null_stringw;
+	std::string utf8;
+	WcsToMbsUTF8Ex(wcs, utf8);
+	return utf8;
+}
 
-	//
-	//	변환에 필요한 버퍼 크기 계산
-	//
-	int outLen = MultiByteToWideChar(CP_UTF8, 
-									 MB_ERR_INVALID_CHARS, 
-									 utf8, 
-									 -1, 
-									 nullptr, 
-									 0);
-	if (0 == outLen) return _null_stringw;
+/// @brief	UTF-8 문자열을 wide 문자열로 변환한다. (Win32 API 를 사용하지 않음)
+///			MB_ERR_INVALID_CHARS 와 같이 올바르지 않은 UTF-8 이면 false
+bool Utf8MbsToWcsEx(_In_ const char* utf8, _Out_ std::wstring& wcs)
+{
+	wcs.clear();
 
-	//
-	//	버퍼 할당
-	//
-	wchar_ptr outWchar((wchar_t*)malloc(outLen * (sizeof(wchar_t))), 
-					   [](wchar_t* p) 
-	{
-		if (nullptr != p)free(p);
-	});
-	if (nullptr == outWchar.get()) return _null_stringw;
-	RtlZeroMemory(outWchar.get(), outLen);
+	_ASSERTE(nullptr != utf8);
+	if (nullptr == utf8) return false;
 
-	//
-	//	변환
-	//
-	if (0 == MultiByteToWideChar(CP_UTF8, 
-								 MB_ERR_INVALID_CHARS, 
-								 utf8, 
-								 -1, 
-								 outWchar.get(), 
-								 outLen))
-	{
-		log_err
-			"MultiByteToWideChar() failed, errcode=0x%08x",
-			GetLastError()
-			log_end;
-		return _null_stringw;
-	}
+	return utf8_to_utf16(utf8, strlen(utf8), wcs);
+}
 
-	return std::wstring(outWchar.get());
+std::wstring Utf8MbsToWcsEx(_In_ const char* utf8)
+{
+	std::wstring wcs;
+	Utf8MbsToWcsEx(utf8, wcs);
+	return wcs;
 }
 
-/// @brief	포맷팅된 문자열을 리턴한다. (테스트용으로만 쓸것)
-///			static 배열을 사용하므로 Thread safe 하지 않으며 포맷팅된 
-///			문자열의 길이가 buffer 사이즈를 넘는경우 nullptr 을 리턴
+/// @brief	포맷팅된 문자열을 리턴한다. 
+///			예전에는 static 배열을 사용해서 Thread safe 하지 않았고, 2 KB 를 
+///			넘으면 nullptr 을 리턴했다. 이제는 스레드별 버퍼 (넘치면 string 으로 
+///			spill) 를 사용하며, 형식 오류인 경우만 nullptr 을 리턴한다.
 const 
 char* 
 const 
 format_string(
-	_In_z_ const char* const fmt, ...
+	_In_z_ _Printf_format_string_ const char* const fmt, ...
 )
 {
-	static char buf[2048];
-
 	va_list args;
 	va_start(args, fmt);
-	HRESULT hr = StringCbVPrintfA(buf, sizeof(buf), fmt, args);
+	const char* ret = vformat_tls(fmt, args);
 	va_end(args);
-
-	if (SUCCEEDED(hr))
-	{
-		return buf;
-	}
-	else
-	{
-		return nullptr;
-	}
+	return ret;
 }
 
 /// @brief	buf 에 포맷팅된 문자열을 리턴한다.
 bool 
 format_string(
-	_Out_ char* buf,
-	_In_z_ const char* const fmt,
+	_Out_writes_z_(buf_size) char* buf,
+	_In_ size_t buf_size,
+	_In_z_ _Printf_format_string_ const char* const fmt,
 	...)
 {
 	va_list args;
 	va_start(args, fmt);
-	HRESULT hr = StringCbVPrintfA(buf, sizeof(buf), fmt, args);
+	const int n = vformat_to(buf, buf_size, fmt, args);
 	va_end(args);
 
-	if (SUCCEEDED(hr))
-	{
-		return true;
-	}
-	else
-	{
-		return false;
-	}
+	return (0 <= n && (size_t)n < buf_size);
 }
 
 /// @brief  src 의 뒤에서부터 fnd 문자열을 찾는다. 
@@ -3901,24 +3970,20 @@ rstrnicmp(
 	_ASSERTE(NULL != fnd);
 	if (NULL == src || NULL == fnd) return false;
 
-	uint32_t src_len = (uint32_t)wcslen(src);
-	uint32_t fnd_len = (uint32_t)wcslen(fnd);
-	if (fnd_len > src_len) return false;
+	const std::wstring_view src_view(src);
+	const std::wstring_view fnd_view(fnd);
+	if (fnd_view.size() > src_view.size()) return false;
 
-	int sidx = src_len - 1; // uint32_t 타입 쓰면 안됨!
-	int fidx = fnd_len - 1;
-	while (fidx >= 0)
-	{
-		if (true == case_insensitive)
-		{
-			if (towlower(fnd[fidx--]) != towlower(src[sidx--])) return false;
-		}
-		else
-		{
-			if (fnd[fidx--] != src[sidx--]) return false;
-		}
+	if (true == case_insensitive)
+	{
+		return ends_with_ci(src_view, fnd_view);
+	}
+	else
+	{
+		return (0 == src_view.compare(src_view.size() - fnd_view.size(), 
+									  fnd_view.size(), 
+									  fnd_view));
 	}
-	return true;
 }
 
 bool
@@ -3932,24 +3997,20 @@ rstrnicmpa(
 	_ASSERTE(NULL != fnd);
 	if (NULL == src || NULL == fnd) return false;
 
-	uint32_t src_len = (uint32_t)strlen(src);
-	uint32_t fnd_len = (uint32_t)strlen(fnd);
-	if (fnd_len > src_len) return false;
+	const std::string_view src_view(src);
+	const std::string_view fnd_view(fnd);
+	if (fnd_view.size() > src_view.size()) return false;
 
-	int sidx = src_len - 1; // uint32_t 타입 쓰면 안됨!
-	int fidx = fnd_len - 1;
-	while (fidx >= 0)
+	if (true == case_insensitive)
 	{
-		if (true == case_insensitive)
-		{
-			if (towlower(fnd[fidx--]) != towlower(src[sidx--])) return false;
-		}
-		else
-		{
-			if (fnd[fidx--] != src[sidx--]) return false;
-		}
+		return ends_with_ci(src_view, fnd_view);
+	}
+	else
+	{
+		return (0 == src_view.compare(src_view.size() - fnd_view.size(), 
+									  fnd_view.size(), 
+									  fnd_view));
 	}
-	return true;
 }
 
 /// @brief  src 의 앞에서부터 fnd 문자열을 찾는다. 
@@ -3966,7 +4027,7 @@ lstrnicmp(
 
 	if (true == case_insensitive)
 	{
-		return (0 == _wcsnicmp(src, fnd, wcslen(fnd))) ? true : false;
+		return starts_with_ci(src, fnd);
 	}
 	else
 	{
@@ -3988,7 +4049,7 @@ lstrnicmpa(
 
 	if (true == case_insensitive)
 	{
-		return (0 == _strnicmp(src, fnd, strlen(fnd))) ? true : false;
+		return starts_with_ci(src, fnd);
 	}
 	else
 	{
@@ -4008,48 +4069,39 @@ is_same_string(
 	_ASSERTE(nullptr != rhs);
 	if (nullptr == lhs || nullptr == rhs) return false;
 
-	size_t len = max(wcslen(lhs), wcslen(rhs));
 	if (true == case_insensitive)
 	{
-		return (0 == _wcsnicmp(lhs, rhs, len)) ? true : false;
+		return equals_ci(lhs, rhs);
 	}
 	else
 	{
-		return (0 == wcsncmp(lhs, rhs, len)) ? true : false;
+		return (0 == wcscmp(lhs, rhs)) ? true : false;
 	}
 }
 
 /// @brief
 std::string to_upper_string(const std::string& input) {
 	std::string tmp(input);
-	if (!tmp.empty()) {
-		CharUpperA(&tmp[0]);
-	}
+	fold_to_upper(tmp);
 	return tmp;
 }
 
 std::wstring to_upper_string(const std::wstring& input) {
 	std::wstring tmp(input);
-	if (!tmp.empty()) {
-		CharUpperW(&tmp[0]);
-	}
+	fold_to_upper(tmp);
 	return tmp;
 }
 
 /// @brief
 std::string to_lower_string(const std::string& input) {
 	std::string tmp(input);
-	if (!tmp.empty()) {
-		CharLowerA(&tmp[0]);
-	}
+	fold_to_lower(tmp);
 	return tmp;
 }
 
 std::wstring to_lower_string(const std::wstring& input) {
 	std::wstring tmp(input);
-	if (!tmp.empty()) {
-		CharLowerW(&tmp[0]);
-	}
+	fold_to_lower(tmp);
 	return tmp;
 }
 
@@ -4100,12 +4152,12 @@ extract_first_tokenW(
 
 	if (true == forward)
 	{
-		out_string = org_string.substr(0, pos);
+		out_string.assign(org_string, 0, pos);
 		if (delete_token) org_string.erase(0, pos + token.size());
 	}
 	else
 	{
-		out_string = org_string.substr(pos + token.size(), org_string.size());
+		out_string.assign(org_string, pos + token.size());
 		if (delete_token) org_string.erase(pos, org_string.size());
 	}
 	return true;
@@ -4138,12 +4190,7 @@ extract_first_tokenExW(
 	_ASSERTE(NULL != token);
 	if (NULL == org || NULL == token) return _null_stringw;
 
-	std::wstring org_string = org;
-	std::wstring out_string;
-	if (true != extract_first_tokenW(org_string, token, out_string, forward, false))
-		return _null_stringw;
-	else
-		return out_string;
+	return std::wstring(extract_token_view<wchar_t>(org, token, true, forward));
 }
 
 std::wstring
@@ -4157,15 +4204,7 @@ extract_first_tokenExW(
 	_ASSERTE(!token.empty());
 	if (org.empty() || token.empty()) return _null_stringw;
 
-	std::wstring out_string;
-	if (true != extract_first_tokenW(const_cast<std::wstring&>(org), 
-									 token, 
-									 out_string, 
-									 forward, 
-									 false))
-		return _null_stringw;
-	else
-		return out_string;
+	return std::wstring(extract_token_view<wchar_t>(org, token, true, forward));
 }
 
 
@@ -4208,14 +4247,14 @@ extract_first_tokenA(
 		return true;
 	}
 
-	if (TRUE == forward)
+	if (true == forward)
 	{
-		out_string = org_string.substr(0, pos);
+		out_string.assign(org_string, 0, pos);
 		if (delete_token) org_string.erase(0, pos + token.size());
 	}
 	else
 	{
-		out_string = org_string.substr(pos + token.size(), org_string.size());
+		out_string.assign(org_string, pos + token.size());
 		if (delete_token) org_string.erase(pos, org_string.size());
 	}
 	return true;
@@ -4248,16 +4287,7 @@ extract_first_tokenExA(
 	_ASSERTE(NULL != token);
 	if (NULL == org || NULL == token) return _null_stringa;
 
-	std::string org_string = org;
-	std::string out_string;
-	if (true != extract_first_tokenA(org_string, 
-									 token, 
-									 out_string, 
-									 forward, 
-									 false))
-		return _null_stringa;
-	else
-		return out_string;
+	return std::string(extract_token_view<char>(org, token, true, forward));
 }
 
 std::string
@@ -4271,15 +4301,7 @@ extract_first_tokenExA(
 	_ASSERTE(!token.empty());
 	if (org.empty() || token.empty()) return _null_stringa;
 
-	std::string out_string;
-	if (true != extract_first_tokenA(const_cast<std::string&>(org),
-									 token,
-									 out_string,
-									 forward,
-									 false))
-		return _null_stringa;
-	else
-		return out_string;
+	return std::string(extract_token_view<char>(org, token, true, forward));
 }
 
 
@@ -4324,12 +4346,12 @@ extract_last_tokenW(
 
 	if (true == forward)
 	{
-		out_string = org_string.substr(0, pos);
+		out_string.assign(org_string, 0, pos);
 		if (delete_token) org_string.erase(0, pos + token.size());
 	}
 	else
 	{
-		out_string = org_string.substr(pos + token.size(), org_string.size());
+		out_string.assign(org_string, pos + token.size());
 		if (delete_token) org_string.erase(pos, org_string.size());
 	}
 	return true;
@@ -4355,12 +4377,7 @@ extract_last_tokenExW(
 	_ASSERTE(NULL != token);
 	if (NULL == org || NULL == token) return _null_stringw;
 
-	std::wstring org_string = org;
-	std::wstring out_string;
-	if (true != extract_last_tokenW(org_string, token, out_string, forward, false))
-		return _null_stringw;
-	else
-		return out_string;
+	return std::wstring(extract_token_view<wchar_t>(org, token, false, forward));
 }
 
 /**
@@ -4403,12 +4420,12 @@ extract_last_tokenA(
 
 	if (true == forward)
 	{
-		out_string = org_string.substr(0, pos);
+		out_string.assign(org_string, 0, pos);
 		if (delete_token) org_string.erase(0, pos + token.size());
 	}
 	else
 	{
-		out_string = org_string.substr(pos + token.size(), org_string.size());
+		out_string.assign(org_string, pos + token.size());
 		if (delete_token) org_string.erase(pos, org_string.size());
 	}
 	return true;
@@ -4434,13 +4451,7 @@ extract_last_tokenExA(
 	_ASSERTE(NULL != token);
 	if (NULL == org || NULL == token) return _null_stringa;
 
-	std::string org_string = org;
-	std::string out_string;
-	if (true != extract_last_tokenA(org_string, token, out_string, forward, false))
-		return _null_stringa;
-	else
-		return out_string;
-
+	return std::string(extract_token_view<char>(org, token, false, forward));
 }
 
 /// @brief	파일의 확장자를 리턴한다. 
@@ -4531,98 +4542,64 @@ std::wstring ltrimw(std::wstring& s, const std::wstring& drop)
 ///			token 문자열이 없는 경우 source 문자열이 그대로 리스트로 반환된다.
 ///			token 문자열이 source 문자열보다 길거나 같은경우 source 문자열이 그대로 리스트로 반환된다.
 ///			token 문자열이 공백문자인 경우 remove_space 파라미터는 무시된다.
-std::list<std::string>
-split_string_a(
-	_In_ const std::string source,
-	_In_ const std::string token,
+///
+///			토큰마다 문자열 하나만 할당한다. 할당이 없어야 하는 경우에는 
+///			tokenize() 나 split_string_views() 를 사용할 것
+template <typename CharT>
+static
+std::list<std::basic_string<CharT>>
+split_string_t(
+	_In_ const std::basic_string<CharT>& source,
+	_In_ const std::basic_string<CharT>& token,
 	_In_ const bool remove_space
 )
 {
-	if (source.empty()) return std::list<std::string>();
-	if (token.empty() || source.size() <= token.size())
-	{
-		return std::list<std::string>{ source };
-	}
+	typedef std::basic_string_view<CharT> view_type;
+	const CharT space[] = { (CharT)' ', 0 };
 
-	std::list<std::string> out;
-	size_t pos_s = 0;
-	size_t pos_e = source.find(token);
-	while (pos_e != std::string::npos)
+	std::list<std::basic_string<CharT>> out;
+	if (source.empty()) return out;
+	if (token.empty() || source.size() <= token.size())
 	{
-		//	tokenize 된 문자열이 token 과 동일한 경우 substring 문자열은 
-		//	빈 문자열이 되므로 결과에 포함되지 않는다.
-		auto s = source.substr(pos_s, pos_e - pos_s);
-		if (true != s.empty())
-		{
-			if (true == remove_space && token != " ")
-			{
-				s = trima(s, " ");
-			}
-			out.push_back(s);			
-		}
-		
-		pos_s = pos_e + token.size();
-		pos_e = source.find(token, pos_s);
+		out.push_back(source);
+		return out;
 	}
 
-	auto remain = source.substr(pos_s, pos_e - pos_s);
-	if (true != remain.empty())
+	//
+	//	tokenize 된 문자열이 token 과 동일한 경우 substring 문자열은 
+	//	빈 문자열이 되므로 결과에 포함되지 않는다. 
+	//	(trim 은 빈 문자열을 걸러낸 후에 하므로 공백만 있는 토큰은 빈 문자열로 포함됨)
+	//
+	const bool trim = (true == remove_space && token != space);
+	for (view_type s : basic_token_range<CharT>(source, token))
 	{
-		if (true == remove_space && token != " ")
+		if (trim)
 		{
-			remain = trima(remain, " ");
+			s = trim_view(s, view_type(space));
 		}
-		out.push_back(remain);
+		out.emplace_back(s);
 	}
-
 	return out;
 }
 
+std::list<std::string>
+split_string_a(
+	_In_ const std::string& source,
+	_In_ const std::string& token,
+	_In_ const bool remove_space
+)
+{
+	return split_string_t(source, token, remove_space);
+}
+
 std::list<std::wstring>
 split_string_w(
-	_In_ const std::wstring source,
-	_In_ const std::wstring token,
+	_In_ const std::wstring& source,
+	_In_ const std::wstring& token,
 	_In_ const bool remove_space
 )
 {
-	if (source.empty()) return std::list<std::wstring>();
-	if (token.empty() || source.size() <= token.size())
-	{
-		return std::list<std::wstring>{ source };
-	}
-
-	std::list<std::wstring> out;
-	size_t pos_s = 0;
-	size_t pos_e = source.find(token);
-	while (pos_e != std::wstring::npos)
-	{
-		//	tokenize 된 문자열이 token 과 동일한 경우 substring 문자열은 
-		//	빈 문자열이 되므로 결과에 포함되지 않는다.
-		auto s = source.substr(pos_s, pos_e - pos_s);
-		if (true != s.empty())
-		{
-			if (true == remove_space && token != L" ")
-			{
-				s = trimw(s, L" ");
-			}
-			out.push_back(s);
-		}
-
-		pos_s = pos_e + token.size();
-		pos_e = source.find(token, pos_s);
-	}
-
-	auto remain = source.substr(pos_s, pos_e - pos_s);
-	if (true != remain.empty())
-	{
-		if (true == remove_space && token != L" ")
-		{
-			remain = trimw(remain, L" ");
-		}
-		out.push_back(remain);
-	}
-
-	return out;
+	return split_string_t(source, token, remove_space);
 }
 
 /// @brief
@@ -4776,7 +4753,8 @@ find_and_replace_string_exw(
 		return _null_stringw;
 }
 
-/// @brief	랜덤한 문자열 생성하기 
+/// @brief	랜덤한 문자열 생성하기 (출력 가능한 ASCII 문자)
+///			스레드별 PRNG 를 사용하므로 보안용 값에는 사용하면 안된다. (csprng_fill())
 std::string generate_random_string(_In_ const size_t length)
 {
 	static const char alphanum[] =
@@ -4788,13 +4766,12 @@ std::string generate_random_string(_In_ const size_t length)
 		"[\\]^_`"
 		"{|}~";
 
-	std::stringstream strm;
-	for (size_t i = 0; i < length; ++i) 
+	std::string str(length, '\0');
+	if (0 != length)
 	{
-		strm << alphanum[rand() % (sizeof(alphanum) - 1)];
+		prng_string(&str[0], length, alphanum, sizeof(alphanum) - 1);
 	}
-
-	return strm.str();
+	return str;
 }
 
 std::wstring generate_random_stringw(_In_ const size_t length)
@@ -4808,14 +4785,12 @@ std::wstring generate_random_stringw(_In_ const size_t length)
 		L"[\\]^_`"
 		L"{|}~";
 
-	std::wstringstream strm;
-	for (size_t i = 0; i < length; ++i)
+	std::wstring str(length, L'\0');
+	if (0 != length)
 	{
-		wchar_t w = alphanumw[rand() % ((sizeof(alphanumw) / sizeof(wchar_t)) - 1)];
-		strm << w;
+		prng_string(&str[0], length, alphanumw, _countof(alphanumw) - 1);
 	}
-
-	return strm.str();
+	return str;
 }
 
 
@@ -5426,196 +5401,23 @@ dump_memory(
 )
 {
 	std::list<std::string> rs;
-	rs.push_back("                      00 01 02 03 04 05 06 07   08 09 0A 0B 0C 0D 0E 0F");
-	rs.push_back("                      -- -- -- -- -- -- -- --   -- -- -- -- -- -- -- --");
 
 	_ASSERTE(nullptr != buf);
 	_ASSERTE(0 < buf_len);
-	if (nullptr == buf || 0 == buf_len) return rs;
-
-	//	!주의! - 한 라인이 line_dump 보다 큰 경우 
-	//	(설마 그런일이...?!) 문제가 발생 할 수 있음
-	char line_dump[1024];
-		
-	CHAR print_buf[128 * sizeof(CHAR)] = { 0 };
-	DWORD i = 0, ib = 0;
-	UCHAR*  Addr = buf;
-	CHAR*	Pos = NULL;
-	size_t	Remain = 0;
+	if (nullptr == buf) buf_len = 0;
 
-	while(i < buf_len)
+	//
+	//	buf_len 이 0 이면 헤더 두 줄만 들어간다.
+	//
+	hexdump(base_offset, 
+			buf, 
+			buf_len, 
+			true, 
+			[&rs](_In_ const char* line, _In_ size_t line_len)
 	{
-		ib = i;
-
-		// reset all
-		//
-		Pos = print_buf;
-		Remain = sizeof(print_buf);
-
-		//
-		//	offset
-		//
-		if (!SUCCEEDED(StringCbPrintfExA(
-			Pos,
-			Remain,
-			&Pos,
-			&Remain,
-			0,
-			"0x%08p    ",
-			base_offset + i)))
-		{
-			log_err "StringCbPrintfEx() failed" log_end;
-			break;
-		}
-
-		//
-		// first 8 bytes
-		//
-		for (int x = 0; x < 8; x++, i++)
-		{
-			if (i < buf_len)
-			{
-				if (!SUCCEEDED(StringCbPrintfExA(
-					Pos,
-					Remain,
-					&Pos,
-					&Remain,
-					0,
-					"%02X ",
-					Addr[i])))
-				{
-					log_err "StringCbPrintfEx() failed" log_end;
-					break;
-				}
-			}
-			else
-			{
-				if (!SUCCEEDED(StringCbPrintfExA(
-					Pos,
-					Remain,
-					&Pos,
-					&Remain,
-					0,
-					"%s",
-					"   ")))
-				{
-					log_err "StringCbPrintfEx() failed" log_end;
-					break;
-				}
-			}
-		}
-		
-		//
-		// insert space between first 8bytes and last 8 bytes.
-		//
-		if (!SUCCEEDED(StringCbPrintfExA(
-			Pos,
-			Remain,
-			&Pos,
-			&Remain,
-			0,
-			"%s",
-			"  ")))
-		{
-			log_err "StringCbPrintfEx() failed" log_end;
-			break;
-		}
-		
-		//
-		// last 8 bytes
-		//		
-		for (int x = 0; x < 8; x++, i++)
-		{
-			if (i < buf_len)
-			{
-				if (!SUCCEEDED(StringCbPrintfExA(
-					Pos,
-					Remain,
-					&Pos,
-					&Remain,
-					0,
-					"%02X ",
-					Addr[i])))
-				{
-					log_err "StringCbPrintfEx() failed" log_end;
-					break;
-				}
-			}
-			else
-			{
-				if (!SUCCEEDED(StringCbPrintfExA(
-					Pos,
-					Remain,
-					&Pos,
-					&Remain,
-					0,
-					"%s",
-					"   ")))
-				{
-					log_err "StringCbPrintfEx() failed" log_end;
-					break;
-				}
-			}
-		}
-		
-		//
-		//	Dump memory as ascii
-		//
-		char ascii[64] = { 0 };
-		Pos = ascii;
-		Remain = sizeof(ascii) - sizeof(char);
-		for (DWORD p = 0; p < 16 && ib < buf_len; ++p, ++ib)
-		{
-			if (0x20 <= Addr[ib] && 0x7F > Addr[ib])
-			{
-				if (!SUCCEEDED(StringCbPrintfExA(
-					Pos,
-					Remain,
-					&Pos,
-					&Remain,
-					0,
-					"%c",
-					Addr[ib])))
-				{
-					log_err "StringCbPrintfEx() failed" log_end;
-					break;
-				}
-			}
-			else
-			{
-				if (!SUCCEEDED(StringCbPrintfExA(
-					Pos,
-					Remain,
-					&Pos,
-					&Remain,
-					0,
-					"%c",
-					'.')))
-				{
-					log_err "StringCbPrintfEx() failed" log_end;
-					break;
-				}
-			}
-		}
-
-		// add line dump string..
-		StringCbPrintfA(line_dump, 
-						sizeof(line_dump), 
-						"%s   %s", 
-						print_buf, 
-						ascii);
-		rs.push_back(line_dump);
-		
-		memset(print_buf, 0x00, sizeof(print_buf));
-	}
-
-	//// add rest of dump
-	//StringCbPrintfA(line_dump, 
-	//				sizeof(line_dump), 
-	//				"%s", 
-	//				print_buf);
-	//rs.push_back(line_dump);
-	
+		rs.push_back(std::string(line, line_len));
+		return true;
+	});
 	return rs;
 }
 
@@ -8428,47 +8230,12 @@ bin_to_hexa(
 	_Out_ std::string& hex_string
 )
 {
+	hex_string.clear();
+
 	_ASSERTE(NULL != code);
 	if (NULL == code) return false;
 
-	//> allocate memory
-	UINT32			buffer_size = ((code_size * 2) + 1) * sizeof(char);
-
-	char_ptr hex_buf((char*)malloc(buffer_size), [](char* p) {
-		if (nullptr != p)
-		{
-			free(p);
-		}
-	});
-	if (NULL == hex_buf.get()) return false;
-	RtlZeroMemory(hex_buf.get(), buffer_size);
-
-	char*	pos = hex_buf.get();
-	size_t	remain = buffer_size;
-	for (UINT32 i = 0; i < code_size; ++i)
-	{
-		HRESULT hr = StringCbPrintfExA(pos, remain, &pos, &remain, 0, "%02x", code[i]);
-		if (!SUCCEEDED(hr))
-		{
-			log_err
-				"StringCbPrintfExW(pos = 0x%p, remain = %u), hr = 0x%08x",
-				pos, remain, hr
-				log_end
-				return false;
-		}
-	}
-
-	hex_string = hex_buf.get();
-	if (true == upper_case)
-	{
-		hex_string = to_upper_string(hex_string);
-	}
-	else
-	{
-		hex_string = to_lower_string(hex_string);
-	}
-
-	return true;
+	return hex_encode(code, code_size, upper_case, hex_string);
 }
 
 
@@ -8523,31 +8290,8 @@ bin_to_hexa_fast(
 	_Out_ std::string& hex_string
 )
 {
-	char* table = _int_to_char_table;
-	if (true == upper_case)
-	{
-		table = _int_to_upper_char_table;
-	}
-
-	uint32_t buffer_size = ((size * 2) + 1) * sizeof(char);
-	char_ptr hex_buffer((char*)malloc(buffer_size), [](char* p) {
-		if (nullptr != p)
-		{
-			free(p);
-		}
-	});
-
-	if (nullptr == hex_buffer.get()) return false;
-
-	for (uint32_t i = 0; i < size; ++i)
-	{
-		hex_buffer.get()[i * 2] = table[buffer[i] >> 4];
-		hex_buffer.get()[i * 2 + 1] = table[buffer[i] & 0xf];
-	}
-	hex_buffer.get()[buffer_size - 1] = 0x00;
-
-	hex_string = hex_buffer.get();
-	return true;
+	hex_string.clear();
+	return hex_encode(buffer, size, upper_case, hex_string);
 }
 
 bool
@@ -8558,30 +8302,8 @@ bin_to_hexw_fast(
 	_Out_ std::wstring& hex_string
 )
 {
-	char* table = _int_to_char_table;
-	if (true == upper_case)
-	{
-		table = _int_to_upper_char_table;
-	}
-
-	uint32_t buffer_size = ((size * 2) + 1) * sizeof(wchar_t);
-	wchar_ptr hex_buffer((wchar_t*)malloc(buffer_size), [](wchar_t* p) {
-		if (nullptr != p)
-		{
-			free(p);
-		}
-	});
-	if (nullptr == hex_buffer.get()) return false;
-
-	for (uint32_t i = 0; i < size; ++i)
-	{
-		hex_buffer.get()[i * 2] = table[buffer[i] >> 4];
-		hex_buffer.get()[i * 2 + 1] = table[buffer[i] & 0xf];
-	}
-	hex_buffer.get()[(buffer_size / sizeof(wchar_t)) - 1] = 0x00;
-
-	hex_string = hex_buffer.get();
-	return true;
+	hex_string.clear();
+	return hex_encode(buffer, size, upper_case, hex_string);
 }
 
 
@@ -8602,13 +8324,40 @@ bin_to_hexw(
 	_Out_ std::wstring& hex_string
 )
 {
-	std::string hexa;
-	if (true != bin_to_hexa(code_size, code, upper_case, hexa))
-	{
-		return false;
-	}
+	hex_string.clear();
+
+	_ASSERTE(NULL != code);
+	if (NULL == code) return false;
+
+	return hex_encode(code, code_size, upper_case, hex_string);
+}
 
-	hex_string = MbsToWcsEx(hexa.c_str());
+/// @brief	str_to_xxx()/wstr_to_xxx() 의 공통 구현 (parse_number() 사용)
+///
+///			예전 (strtol 기반) 동작을 유지한다. 
+///			- 앞의 공백과 '+' 는 무시하고, 숫자 뒤의 문자도 무시한다.
+///			- 숫자가 없으면 0 으로 성공한다. (allow_empty 가 false 이고 
+///			  빈 문자열이면 실패)
+///			- 범위를 넘거나, 부호 없는 타입인데 '-' 로 시작하면 실패한다.
+///			10 진수 외에 "0x" 로 시작하는 16 진수도 파싱한다.
+template <typename T, typename CharT>
+static bool str_to_number(_In_ const CharT* str, _In_ bool allow_empty, _Out_ T& value)
+{
+	if (NULL == str) return false;
+
+	const CharT* p = str;
+	while (' ' == *p || ('\t' <= *p && '\r' >= *p)) ++p;
+	if (!allow_empty && 0 == *p) return false;
+	if (!std::is_signed<T>::value && '-' == *p) return false;
+	if ('+' == *p) ++p;
+
+	T parsed = 0;
+	const parse_number_result<CharT> r = parse_number(p, 
+													  p + std::char_traits<CharT>::length(p), 
+													  parsed);
+	if (std::errc::result_out_of_range == r.ec) return false;
+
+	value = parsed;
 	return true;
 }
 
@@ -8623,134 +8372,54 @@ bin_to_hexw(
 **/
 bool str_to_int32(_In_ const char* int32_string, _Out_ int32_t& int32_val)
 {
-	if (NULL == int32_string) return false;
-
-	errno = 0;
-	int32_val = strtol(int32_string, NULL, 10);
-	if (ERANGE == errno) { return false; }
-
-	return true;
+	return str_to_number(int32_string, true, int32_val);
 }
 
 /// @brief Convert string to uint16_t with range validation (0 ~ 65535)
 bool str_to_uint16(_In_ const char* uint16_string, _Out_ uint16_t& uint16_val)
 {
-	if (NULL == uint16_string) return false;
-
-	//> Remove leading/trailing whitespace, reject negative numbers
-	std::string str = uint16_string;
-	trima(str);
-	if (str.empty() || str[0] == '-') return false;
-
-	//> Convert to uint32_t first
-	errno = 0;
-	unsigned long val = strtoul(str.c_str(), NULL, 10);
-	if (ERANGE == errno) { return false; }
-
-	//> Range check for uint16_t (0 ~ 65535)
-	if (val > 0xFFFF) { return false; }
-
-	uint16_val = static_cast<uint16_t>(val);
-	return true;
+	//> 빈 문자열 (공백만 있는 경우 포함) 은 에러처리
+	return str_to_number(uint16_string, false, uint16_val);
 }
 
 bool str_to_uint32(_In_ const char* uint32_string, _Out_ uint32_t& uint32_val)
 {
-	if (NULL == uint32_string) return false;
-
-	//> 문자열 양쪽 공백 모두 제거, '-' 로 시작하는 경우 에러처리
-	std::string str = uint32_string;
-	trima(str);
-	if (str[0] == '-') return false;
-
-	errno = 0;
-	uint32_val = strtoul(str.c_str(), NULL, 10);
-	if (ERANGE == errno) { return false; }
-	return true;
+	return str_to_number(uint32_string, true, uint32_val);
 }
 
 bool str_to_int64(_In_ const char* int64_string, _Out_ int64_t& int64_val)
 {
-	if (NULL == int64_string) return false;
-
-	errno = 0;
-	int64_val = _strtoi64(int64_string, NULL, 10);
-	if (ERANGE == errno)
-	{
-		// msdn 에는 ERANGE 를 리턴한다는 내용이 없고, _I64_MAX, _I64_MIN 를 리턴한다고 하는데,
-		// 실제로 범위를 넘는 input 을 넣어보면 ERANGE 를 리턴함을 확인했음
-		//
-		// test_str_to_xxx() 테스트 확인		
-		return false;
-	}
-
-	if (EINVAL == errno)
-	{
-		return false;
-	}
-
-	return true;
+	return str_to_number(int64_string, true, int64_val);
 }
 
 bool str_to_uint64(_In_ const char* uint64_string, _Out_ uint64_t& uint64_val)
 {
-	if (NULL == uint64_string) return false;
-
-	//> 문자열 양쪽 공백 모두 제거, '-' 로 시작하는 경우 에러처리
-	std::string str = uint64_string;
-	trima(str);
-	if (str[0] == '-') return false;
-
-	errno = 0;
-	uint64_val = _strtoui64(str.c_str(), NULL, 10);
-	if (ERANGE == errno)
-	{
-		// msdn 에는 ERANGE 를 리턴한다는 내용이 없고, _UI64_MAX 를 리턴한다고 하는데,
-		// 실제로 범위를 넘는 input 을 넣어보면 ERANGE 를 리턴함을 확인했음
-		//
-		// test_str_to_xxx() 테스트 확인
-		errno = 0;
-		return false;
-	}
-
-	if (EINVAL == errno)
-	{
-		errno = 0;
-		return false;
-	}
-
-
-	return true;
+	return str_to_number(uint64_string, true, uint64_val);
 }
 
 bool wstr_to_int32(_In_ const wchar_t* int32_string, _Out_ int32_t& int32_val)
 {
-	if (NULL == int32_string) return false;
-	return str_to_int32(WcsToMbsEx(int32_string).c_str(), int32_val);
+	return str_to_number(int32_string, true, int32_val);
 }
 
 bool wstr_to_uint16(_In_ const wchar_t* uint16_string, _Out_ uint16_t& uint16_val)
 {
-	if (NULL == uint16_string) return false;
-	return str_to_uint16(WcsToMbsEx(uint16_string).c_str(), uint16_val);
+	return str_to_number(uint16_string, false, uint16_val);
 }
 
 bool wstr_to_uint32(_In_ const wchar_t* uint32_string, _Out_ uint32_t& uint32_val)
 {
-	if (NULL == uint32_string) return false;
-	return str_to_uint32(WcsToMbsEx(uint32_string).c_str(), uint32_val);
+	return str_to_number(uint32_string, true, uint32_val);
 }
 
 bool wstr_to_int64(_In_ const wchar_t* int64_string, _Out_ int64_t& int64_val)
 {
-	if (NULL == int64_string) return false;
-	return str_to_int64(WcsToMbsEx(int64_string).c_str(), int64_val);
+	return str_to_number(int64_string, true, int64_val);
 }
 
 bool wstr_to_uint64(_In_ const wchar_t* uint64_string, _Out_ uint64_t& uint64_val)
 {
-	if (NULL == uint64_string) return false;
-	return str_to_uint64(WcsToMbsEx(uint64_string).c_str(), uint64_val);
+	return str_to_number(uint64_string, true, uint64_val);
 }
 
 /**
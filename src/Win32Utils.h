@@ -15,6 +15,7 @@
 #include "BaseWindowsHeader.h"
 #include <functional>
 #include <list>
+#include "str_format.h"
 
 //
 //  _pointer 가 _alignment 바운더리에 있는지 확인 (fltKernel.h 에 정의되어있음)
@@ -283,11 +284,16 @@ SaveBinaryFile(
 	_In_ PBYTE    Data
 	);
 
+class file_hash_cache;
+
+/// cache 를 지정하면 (file_hash_cache.h) 파일이 바뀌지 않았을 때 
+/// 파일을 읽지 않고 캐시된 해시를 리턴한다. nullptr 이면 캐시를 사용하지 않는다.
 bool 
 get_file_hash_by_filepath(
 	_In_ const wchar_t* file_path,
 	_Out_opt_ const std::string* md5,
-	_Out_opt_ const std::string* sha2
+	_Out_opt_ const std::string* sha2,
+	_In_opt_ file_hash_cache* cache = nullptr
 );
 
 bool 
@@ -297,6 +303,23 @@ get_file_hash_by_filehandle(
 	_Out_opt_ const std::string* sha2
 );
 
+typedef struct file_hash_result
+{
+	file_hash_result() : succeeded(false) {}
+
+	bool succeeded;
+	std::string md5;
+	std::string sha2;
+} *pfile_hash_result;
+
+bool
+get_file_hash_batch(
+	_In_ const std::vector<std::wstring>& file_paths,
+	_In_ bool md5,
+	_In_ bool sha2,
+	_Out_ std::vector<file_hash_result>& results
+);
+
 
 /// 콜백 대신 람다를 사용할 수 있음
 //	if (true != find_files(root,
@@ -440,13 +463,50 @@ std::string WcsToMbsEx(_In_ const wchar_t *wcs);
 std::string WcsToMbsUTF8Ex(_In_ const wchar_t *wcs);
 std::wstring Utf8MbsToWcsEx(_In_ const char* utf8);
 
+/// @brief	변환 결과를 호출자의 문자열에 쓴다. (문자열을 재사용하면 할당이 없음)
+bool MbsToWcsEx(_In_ const char *mbs, _Out_ std::wstring& wcs);
+bool WcsToMbsEx(_In_ const wchar_t *wcs, _Out_ std::string& mbs);
+bool WcsToMbsUTF8Ex(_In_ const wchar_t *wcs, _Out_ std::string& utf8);
+bool Utf8MbsToWcsEx(_In_ const char* utf8, _Out_ std::wstring& wcs);
+
 __inline std::wstring MbsToWcsEx(_In_ const std::string& mbs) { return MbsToWcsEx(mbs.c_str()); }
 __inline std::string WcsToMbsEx(_In_ const std::wstring& wcs) { return WcsToMbsEx(wcs.c_str()); }
 __inline std::string WcsToMbsUTF8Ex(_In_ const std::wstring& wcs) { return WcsToMbsUTF8Ex(wcs.c_str()); }
 __inline std::wstring Utf8MbsToWcsEx(_In_ const std::string& utf8) { return Utf8MbsToWcsEx(utf8.c_str()); }
 
-const char* const format_string(_In_z_ const char* const fmt, ...);
-bool format_string(_In_ char* buf, _In_z_ const char* const fmt, ...);
+/// @brief	포맷팅된 문자열을 리턴한다. 스레드별 버퍼 (format_tls()) 를 사용하므로 
+///			같은 스레드에서 다음 format_string() 을 호출하기 전까지 유효하다.
+const char* const format_string(_In_z_ _Printf_format_string_ const char* const fmt, ...) STR_FORMAT_PRINTF(1, 2);
+
+/// @brief	buf 에 포맷팅한다. 잘리거나 형식 오류면 false
+bool 
+format_string(
+	_Out_writes_z_(buf_size) char* buf, 
+	_In_ size_t buf_size, 
+	_In_z_ _Printf_format_string_ const char* const fmt, 
+	...
+	) STR_FORMAT_PRINTF(3, 4);
+
+/// @brief	배열 buf 전체를 사용해서 포맷팅한다. 잘리거나 형식 오류면 false
+template <size_t N>
+bool format_string(_Out_writes_z_(N) char (&buf)[N], _In_z_ _Printf_format_string_ const char* const fmt, ...)
+{
+	va_list args;
+	va_start(args, fmt);
+	const int n = vformat_to(buf, N, fmt, args);
+	va_end(args);
+	return (0 <= n && (size_t)n < N);
+}
+
+/// @brief	예전의 format_string(char* buf, fmt, ...) 는 크기를 알 수 없어서
+///			sizeof(buf) (포인터 크기) 만큼만 썼다. 포인터로 호출하면 
+///			format_string(const char* fmt, ...) 가 선택되지 않도록 여기서 막는다.
+template <typename T, typename = typename std::enable_if<std::is_same<T, char*>::value>::type>
+bool format_string(_In_ T buf, _In_z_ const char* const fmt, ...)
+{
+	static_assert(!std::is_same<T, char*>::value, "use format_string(buf, buf_size, fmt, ...)");
+	return false;
+}
 
 
 /// @brief  src 의 뒤에서부터 fnd 문자열을 찾는다. 
@@ -569,17 +629,19 @@ std::wstring ltrimw(std::wstring& s, const std::wstring& drop = L" ");
 /// @brief  source 문자열을 token 스트링으로 토크나이징한 결과를 리스트로 리턴한다.
 ///			token 문자열이 없는 경우 source 문자열이 그대로 리스트로 반환된다.
 ///			token 문자열이 source 문자열보다 길거나 같은경우 source 문자열이 그대로 리스트로 반환된다.
+///			할당 없이 토크나이징하려면 string_tokenizer.h 의 tokenize(), 
+///			split_string_views() 를 사용할 것
 std::list<std::string>
 split_string_a(
-	_In_ const std::string source,
-	_In_ const std::string token,
+	_In_ const std::string& source,
+	_In_ const std::string& token,
 	_In_ const bool remove_space = false
 );
 
 std::list<std::wstring>
 split_string_w(
-	_In_ const std::wstring source,
-	_In_ const std::wstring token,
+	_In_ const std::wstring& source,
+	_In_ const std::wstring& token,
 	_In_ const bool remove_space = false
 );
 
@@ -608,21 +670,32 @@ uint64_t hash_string64w(_In_ const wchar_t* s, _In_opt_ uint64_t seed = 0);
 
 /// @brief	source 에서 find 문자열을 모두 찾아 replace 문자열로 변경하고, 변경한 횟수를 리턴한다.
 ///         source 문자열 객체를 직접 변경한다.
+///			제자리에서 replace() 하지 않고 새 버퍼에 한번에 써서 바꾼다. (치환된 
+///			부분은 다시 검색하지 않음, e.g. find = ',' replace = '\,')
+///			여러 패턴을 치환할 때는 replace_set.h 의 replace_set_a/w 를 사용한다.
 template <typename T> int		
 find_and_replace_string(IN T& source, IN T& find, IN T replace)
 {
-    uint32_t adv = (uint32_t)replace.size();
-    int count = 0;
+	if (find.empty()) return 0;
+
 	size_t pos = source.find(find, 0);
+	if (T::npos == pos) return 0;
+
+	T out;
+	out.reserve(source.size());
+
+	int count = 0;
+	size_t copied = 0;
 	while (T::npos != pos)
 	{
-		source.replace(pos, find.length(), replace);
-        pos += adv;     // replace 가 find 문자열을 포함하고 있는 더 긴 문자열인 경우 
-                        // adv 만큼 pos 를 보정해 주지 않으면 무한루프에 빠진다. 
-                        // e.g. find = ',' replace = '\,' 
+		out.append(source, copied, pos - copied);
+		out.append(replace);
+		copied = pos + find.length();
 		++count;
-		pos = source.find(find, pos);
+		pos = source.find(find, copied);
 	}
+	out.append(source, copied, T::npos);
+	source.swap(out);
 	return count;
 }
 
@@ -1045,6 +1118,10 @@ bin_to_hexw(
 	_Out_ std::wstring& hex_string
 	);
 
+/// @brief	10 진수와 "0x" 로 시작하는 16 진수를 파싱한다. (wstr_to_xxx 는 변환 없이 파싱)
+///			숫자가 없으면 0 으로 성공하고, 범위를 넘으면 실패한다. 
+///			오류를 정확하게 알아야 하거나 목록을 파싱할 때는 num_parse.h 의 
+///			parse_number(), parse_number_list() 를 사용한다.
 bool str_to_int32(_In_ const char* int32_string, _Out_ int32_t& int32_val);
 bool str_to_uint16(_In_ const char* uint16_string, _Out_ uint16_t& uint16_val);
 bool str_to_uint32(_In_ const char* uint32_string, _Out_ uint32_t& uint32_val);
@@ -23,103 +23,605 @@
 
    René Nyffenegger rene.nyffenegger@adp-gmbh.ch
 
+   [ by somma ]
+   Altered: 문자 단위 루프를 테이블 기반 스칼라 코드와 SIMD 커널 (base64_x86.cpp)
+   로 교체하고, 호출자 버퍼/CMemoryStream/청크 단위 API 를 추가함.
+   base64_encode()/base64_decode() 의 결과는 예전 구현과 같다.
+
 */
 
 #include "stdafx.h"
 
 #include "base64.h"
-#include <iostream>
+#include "CStream.h"
+#include "cpu_features.h"
+#include <atomic>
+
+static const char _encode_table[] = 
+	"ABCDEFGHIJKLMNOPQRSTUVWXYZ"
+	"abcdefghijklmnopqrstuvwxyz"
+	"0123456789+/";
+
+/// 문자 -> 6 비트 값, base64 문자가 아니면 ('=' 포함) 0xff
+static const uint8_t _decode_table[256] = 
+{
+	0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x3e, 0xff, 0xff, 0xff, 0x3f,
+	0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3a, 0x3b, 0x3c, 0x3d, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	0xff, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e,
+	0x0f, 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0xff, 0xff, 0xff, 0xff, 0xff,
+	0xff, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e, 0x1f, 0x20, 0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28,
+	0x29, 0x2a, 0x2b, 0x2c, 0x2d, 0x2e, 0x2f, 0x30, 0x31, 0x32, 0x33, 0xff, 0xff, 0xff, 0xff, 0xff,
+	0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff
+};
+
+//
+//	커널은 처리할 수 있는 만큼 처리하고 처리한 입력 크기를 리턴한다. 
+//	encode: 3 의 배수 바이트, decode: 4 의 배수 문자 ('=' 없음)
+//
+typedef size_t (*base64_encode_fn)(const uint8_t* in, size_t in_len, char* out);
+typedef size_t (*base64_decode_fn)(const char* in, size_t in_len, uint8_t* out, bool& valid);
+
+#if defined(CPU_FEATURES_X86)
+size_t base64_encode_ssse3(const uint8_t* in, size_t in_len, char* out);
+size_t base64_encode_avx2(const uint8_t* in, size_t in_len, char* out);
+size_t base64_decode_ssse3(const char* in, size_t in_len, uint8_t* out, bool& valid);
+size_t base64_decode_avx2(const char* in, size_t in_len, uint8_t* out, bool& valid);
+#endif
+
+static size_t base64_encode_scalar(const uint8_t* in, size_t in_len, char* out)
+{
+	size_t done = 0;
+	for (; in_len - done >= 3; done += 3)
+	{
+		const uint32_t v = ((uint32_t)in[done] << 16) | ((uint32_t)in[done + 1] << 8) | in[done + 2];
+		out[0] = _encode_table[(v >> 18) & 0x3f];
+		out[1] = _encode_table[(v >> 12) & 0x3f];
+		out[2] = _encode_table[(v >> 6) & 0x3f];
+		out[3] = _encode_table[v & 0x3f];
+		out += 4;
+	}
+	return done;
+}
 
-static const std::string base64_chars =
-             "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
-             "abcdefghijklmnopqrstuvwxyz"
-             "0123456789+/";
+static size_t base64_decode_scalar(const char* in, size_t in_len, uint8_t* out, bool& valid)
+{
+	valid = true;
+	size_t done = 0;
+	for (; in_len - done >= 4; done += 4)
+	{
+		const uint32_t a = _decode_table[(uint8_t)in[done]];
+		const uint32_t b = _decode_table[(uint8_t)in[done + 1]];
+		const uint32_t c = _decode_table[(uint8_t)in[done + 2]];
+		const uint32_t d = _decode_table[(uint8_t)in[done + 3]];
+		if (0 != ((a | b | c | d) & 0x80))
+		{
+			valid = false;
+			break;
+		}
+
+		const uint32_t v = (a << 18) | (b << 12) | (c << 6) | d;
+		out[0] = (uint8_t)(v >> 16);
+		out[1] = (uint8_t)(v >> 8);
+		out[2] = (uint8_t)v;
+		out += 3;
+	}
+	return done;
+}
 
+typedef struct base64_kernels
+{
+	int impl;
+	base64_encode_fn encode;
+	base64_decode_fn decode;
+} *pbase64_kernels;
+
+static const base64_kernels _kernels_scalar = { BASE64_IMPL_SCALAR, base64_encode_scalar, base64_decode_scalar };
+#if defined(CPU_FEATURES_X86)
+static const base64_kernels _kernels_ssse3 = { BASE64_IMPL_SSSE3, base64_encode_ssse3, base64_decode_ssse3 };
+static const base64_kernels _kernels_avx2 = { BASE64_IMPL_AVX2, base64_encode_avx2, base64_decode_avx2 };
+#endif
+
+static const base64_kernels* base64_impl_kernels(int impl)
+{
+	switch (impl)
+	{
+	case BASE64_IMPL_SCALAR:
+		return &_kernels_scalar;
+#if defined(CPU_FEATURES_X86)
+	case BASE64_IMPL_SSSE3:
+		return get_cpu_features().ssse3 ? &_kernels_ssse3 : nullptr;
+	case BASE64_IMPL_AVX2:
+		return get_cpu_features().avx2 ? &_kernels_avx2 : nullptr;
+#endif
+	}
+	return nullptr;
+}
 
-static inline bool is_base64(unsigned char c) {
-  return (isalnum(c) || (c == '+') || (c == '/'));
+static int base64_best_impl()
+{
+	if (nullptr != base64_impl_kernels(BASE64_IMPL_AVX2)) return BASE64_IMPL_AVX2;
+	if (nullptr != base64_impl_kernels(BASE64_IMPL_SSSE3)) return BASE64_IMPL_SSSE3;
+	return BASE64_IMPL_SCALAR;
 }
 
-std::string base64_encode(unsigned char const* bytes_to_encode, unsigned int in_len) {
-  std::string ret;
-  int i = 0;
-  int j = 0;
-  unsigned char char_array_3[3];
-  unsigned char char_array_4[4];
+static std::atomic<const base64_kernels*> _kernels(nullptr);
+
+static const base64_kernels* base64_get_kernels()
+{
+	const base64_kernels* kernels = _kernels.load(std::memory_order_relaxed);
+	if (nullptr == kernels)
+	{
+		kernels = base64_impl_kernels(base64_best_impl());
+		_kernels.store(kernels, std::memory_order_relaxed);
+	}
+	return kernels;
+}
 
-  while (in_len--) {
-    char_array_3[i++] = *(bytes_to_encode++);
-    if (i == 3) {
-      char_array_4[0] = (char_array_3[0] & 0xfc) >> 2;
-      char_array_4[1] = ((char_array_3[0] & 0x03) << 4) + ((char_array_3[1] & 0xf0) >> 4);
-      char_array_4[2] = ((char_array_3[1] & 0x0f) << 2) + ((char_array_3[2] & 0xc0) >> 6);
-      char_array_4[3] = char_array_3[2] & 0x3f;
+/// @brief	base64_encode()/base64_decode() 가 사용할 구현을 선택한다.
+///			BASE64_IMPL_AUTO 는 CPU 가 지원하는 가장 빠른 구현을 선택한다.
+bool base64_set_impl(int impl)
+{
+	if (BASE64_IMPL_AUTO == impl)
+	{
+		impl = base64_best_impl();
+	}
 
-      for(i = 0; (i <4) ; i++)
-        ret += base64_chars[char_array_4[i]];
-      i = 0;
-    }
-  }
+	const base64_kernels* kernels = base64_impl_kernels(impl);
+	if (nullptr == kernels) return false;
+
+	_kernels.store(kernels, std::memory_order_relaxed);
+	return true;
+}
+
+int base64_get_impl()
+{
+	return base64_get_kernels()->impl;
+}
 
-  if (i)
-  {
-    for(j = i; j < 3; j++)
-      char_array_3[j] = '\0';
+bool base64_impl_supported(int impl)
+{
+	return (BASE64_IMPL_AUTO == impl || nullptr != base64_impl_kernels(impl));
+}
 
-    char_array_4[0] = (char_array_3[0] & 0xfc) >> 2;
-    char_array_4[1] = ((char_array_3[0] & 0x03) << 4) + ((char_array_3[1] & 0xf0) >> 4);
-    char_array_4[2] = ((char_array_3[1] & 0x0f) << 2) + ((char_array_3[2] & 0xc0) >> 6);
-    char_array_4[3] = char_array_3[2] & 0x3f;
+const char* base64_impl_name(int impl)
+{
+	switch (impl)
+	{
+	case BASE64_IMPL_AUTO: return "auto";
+	case BASE64_IMPL_SCALAR: return "scalar";
+	case BASE64_IMPL_SSSE3: return "ssse3";
+	case BASE64_IMPL_AVX2: return "avx2";
+	}
+	return "unknown";
+}
 
-    for (j = 0; (j < i + 1); j++)
-      ret += base64_chars[char_array_4[j]];
+/// @brief	in_len (3 의 배수) 바이트를 인코딩한다.
+static void encode_triples(const uint8_t* in, size_t in_len, char* out)
+{
+	_ASSERTE(0 == in_len % 3);
 
-    while((i++ < 3))
-      ret += '=';
+	size_t done = base64_get_kernels()->encode(in, in_len, out);
+	base64_encode_scalar(in + done, in_len - done, out + (done / 3) * 4);
+}
 
-  }
+/// @brief	마지막 1~2 바이트를 패딩과 함께 인코딩한다.
+static void encode_tail(const uint8_t* in, size_t in_len, char* out)
+{
+	_ASSERTE(0 < in_len && in_len < 3);
 
-  return ret;
+	const uint32_t v = ((uint32_t)in[0] << 16) | ((2 == in_len) ? ((uint32_t)in[1] << 8) : 0);
+	out[0] = _encode_table[(v >> 18) & 0x3f];
+	out[1] = _encode_table[(v >> 12) & 0x3f];
+	out[2] = (2 == in_len) ? _encode_table[(v >> 6) & 0x3f] : '=';
+	out[3] = '=';
+}
 
+/// @brief	in_len (4 의 배수) 문자를 디코딩한다. 
+///			'=' 는 마지막 블록에서만 허용하고, 남는 비트는 0 이어야 한다.
+static bool decode_quanta(const char* in, size_t in_len, uint8_t* out, size_t& out_len, bool& padded)
+{
+	_ASSERTE(0 == in_len % 4);
+
+	out_len = 0;
+	padded = false;
+	if (0 == in_len) return true;
+
+	size_t pad = 0;
+	if ('=' == in[in_len - 1])
+	{
+		pad = ('=' == in[in_len - 2]) ? 2 : 1;
+	}
+	const size_t body = (0 == pad) ? in_len : in_len - 4;
+
+	bool valid = true;
+	size_t done = base64_get_kernels()->decode(in, body, out, valid);
+	if (valid)
+	{
+		done += base64_decode_scalar(in + done, body - done, out + (done / 4) * 3, valid);
+	}
+	if (!valid || done != body) return false;
+	out_len = (body / 4) * 3;
+
+	if (0 < pad)
+	{
+		const char* last = &in[body];
+		const uint32_t a = _decode_table[(uint8_t)last[0]];
+		const uint32_t b = _decode_table[(uint8_t)last[1]];
+		const uint32_t c = (1 == pad) ? _decode_table[(uint8_t)last[2]] : 0;
+		if (0 != ((a | b | c) & 0x80)) return false;
+
+		//
+		//	인코딩에 사용되지 않는 비트가 0 이 아니면 올바른 인코딩이 아니다.
+		//
+		if (1 == pad)
+		{
+			if (0 != (c & 0x03)) return false;
+		}
+		else
+		{
+			if (0 != (b & 0x0f)) return false;
+		}
+
+		const uint32_t v = (a << 18) | (b << 12) | (c << 6);
+		out[out_len++] = (uint8_t)(v >> 16);
+		if (1 == pad)
+		{
+			out[out_len++] = (uint8_t)(v >> 8);
+		}
+		padded = true;
+	}
+	return true;
 }
 
-std::string base64_decode(std::string const& encoded_string) {
-  int in_len = (int)encoded_string.size();
-  int i = 0;
-  int j = 0;
-  int in_ = 0;
-  unsigned char char_array_4[4], char_array_3[3];
-  std::string ret;
 
-  while (in_len-- && ( encoded_string[in_] != '=') && is_base64(encoded_string[in_])) {
-    char_array_4[i++] = encoded_string[in_]; in_++;
-    if (i ==4) {
-      for (i = 0; i <4; i++)
-        char_array_4[i] = (unsigned char)base64_chars.find(char_array_4[i]);
+std::string base64_encode(unsigned char const* bytes_to_encode, unsigned int in_len) 
+{
+	std::string ret;
+	if (0 == in_len) return ret;
 
-      char_array_3[0] = (char_array_4[0] << 2) + ((char_array_4[1] & 0x30) >> 4);
-      char_array_3[1] = ((char_array_4[1] & 0xf) << 4) + ((char_array_4[2] & 0x3c) >> 2);
-      char_array_3[2] = ((char_array_4[2] & 0x3) << 6) + char_array_4[3];
+	ret.resize(base64_encoded_length(in_len));
 
-      for (i = 0; (i < 3); i++)
-        ret += char_array_3[i];
-      i = 0;
-    }
-  }
+	size_t out_len = 0;
+	base64_encode(bytes_to_encode, in_len, &ret[0], ret.size(), out_len);
+	return ret;
+}
 
-  if (i) {
-    for (j = i; j <4; j++)
-      char_array_4[j] = 0;
+/// @brief	예전 구현과 같이 첫번째 '=' 나 base64 가 아닌 문자 전까지만 
+///			디코딩한다. 마지막 2~3 문자 블록은 1~2 바이트로 디코딩한다.
+std::string base64_decode(std::string const& encoded_string) 
+{
+	const char* in = encoded_string.c_str();
+	size_t len = 0;
+	while (len < encoded_string.size() && 0xff != _decode_table[(uint8_t)in[len]])
+	{
+		++len;
+	}
+
+	const size_t body = (len / 4) * 4;
+	const size_t rem = len - body;
+	std::string ret;
+	ret.resize((body / 4) * 3 + ((rem > 1) ? rem - 1 : 0));
+	if (ret.empty()) return ret;
+
+	size_t out_len = 0;
+	bool padded = false;
+	decode_quanta(in, body, (uint8_t*)&ret[0], out_len, padded);
+
+	if (rem > 1)
+	{
+		const uint32_t v = ((uint32_t)_decode_table[(uint8_t)in[body]] << 18) |
+						   ((uint32_t)_decode_table[(uint8_t)in[body + 1]] << 12) |
+						   ((rem > 2) ? ((uint32_t)_decode_table[(uint8_t)in[body + 2]] << 6) : 0);
+		ret[out_len++] = (char)(v >> 16);
+		if (rem > 2)
+		{
+			ret[out_len++] = (char)(v >> 8);
+		}
+	}
+	return ret;
+}
 
-    for (j = 0; j <4; j++)
-      char_array_4[j] = (unsigned char)base64_chars.find(char_array_4[j]);
+/// @brief	out 에 인코딩한다. (null 문자를 붙이지 않음)
+bool 
+base64_encode(
+	_In_reads_bytes_(in_len) const uint8_t* in, 
+	_In_ size_t in_len, 
+	_Out_writes_to_(out_size, out_len) char* out, 
+	_In_ size_t out_size, 
+	_Out_ size_t& out_len
+	)
+{
+	out_len = 0;
+	if ((nullptr == in && 0 != in_len) || nullptr == out) return false;
+
+	const size_t length = base64_encoded_length(in_len);
+	if (out_size < length)
+	{
+		log_err "output buffer too small. required=%zu, size=%zu", length, out_size log_end;
+		return false;
+	}
+
+	const size_t full = (in_len / 3) * 3;
+	encode_triples(in, full, out);
+	if (full < in_len)
+	{
+		encode_tail(in + full, in_len - full, out + (full / 3) * 4);
+	}
+	out_len = length;
+	return true;
+}
 
-    char_array_3[0] = (char_array_4[0] << 2) + ((char_array_4[1] & 0x30) >> 4);
-    char_array_3[1] = ((char_array_4[1] & 0xf) << 4) + ((char_array_4[2] & 0x3c) >> 2);
-    char_array_3[2] = ((char_array_4[2] & 0x3) << 6) + char_array_4[3];
+/// @brief	stream 의 현재 위치에 인코딩한 문자열을 쓴다.
+///			스택 버퍼 (4 KB) 단위로 인코딩해서 스트림에 쓴다.
+bool 
+base64_encode(
+	_In_reads_bytes_(in_len) const uint8_t* in, 
+	_In_ size_t in_len, 
+	_Inout_ CMemoryStream& stream
+	)
+{
+	base64_encoder encoder;
+	return (encoder.update(in, in_len, stream) && encoder.finish(stream));
+}
 
-    for (j = 0; (j < i - 1); j++) ret += char_array_3[j];
-  }
+/// @brief	out 에 디코딩한다. 
+bool 
+base64_decode(
+	_In_reads_(in_len) const char* in, 
+	_In_ size_t in_len, 
+	_Out_writes_bytes_to_(out_size, out_len) uint8_t* out, 
+	_In_ size_t out_size, 
+	_Out_ size_t& out_len
+	)
+{
+	out_len = 0;
+	if ((nullptr == in && 0 != in_len) || (nullptr == out && 0 != in_len)) return false;
+	if (0 != in_len % 4) return false;
+
+	size_t length = base64_decoded_max_length(in_len);
+	if (0 < in_len && '=' == in[in_len - 1])
+	{
+		length -= ('=' == in[in_len - 2]) ? 2 : 1;
+	}
+	if (out_size < length)
+	{
+		log_err "output buffer too small. required=%zu, size=%zu", length, out_size log_end;
+		return false;
+	}
+
+	bool padded = false;
+	return decode_quanta(in, in_len, out, out_len, padded);
+}
 
-  return ret;
-}
\ No newline at end of file
+/// @brief	stream 의 현재 위치에 디코딩한 데이터를 쓴다.
+///			입력이 올바르지 않으면 false 를 리턴하며, 그 전까지 디코딩한 
+///			데이터는 스트림에 쓰여 있을 수 있다.
+bool 
+base64_decode(
+	_In_reads_(in_len) const char* in, 
+	_In_ size_t in_len, 
+	_Inout_ CMemoryStream& stream
+	)
+{
+	base64_decoder decoder;
+	return (decoder.update(in, in_len, stream) && decoder.finish());
+}
+
+
+//
+//	base64_encoder
+//
+
+bool 
+base64_encoder::update(
+	_In_reads_bytes_(in_len) const uint8_t* in,
+	_In_ size_t in_len,
+	_Out_writes_to_(out_size, out_len) char* out,
+	_In_ size_t out_size,
+	_Out_ size_t& out_len
+	)
+{
+	out_len = 0;
+	if (0 == in_len) return true;
+	if (nullptr == in || nullptr == out) return false;
+	if (out_size < max_update_length(in_len))
+	{
+		log_err "output buffer too small. required=%zu, size=%zu", max_update_length(in_len), out_size log_end;
+		return false;
+	}
+
+	//
+	//	이전 호출에서 남은 바이트를 먼저 3 바이트로 채운다.
+	//
+	size_t pos = 0;
+	if (0 < _pending_len)
+	{
+		while (_pending_len < 3 && pos < in_len)
+		{
+			_pending[_pending_len++] = in[pos++];
+		}
+		if (3 > _pending_len) return true;
+
+		base64_encode_scalar(_pending, 3, out);
+		out_len = 4;
+		_pending_len = 0;
+	}
+
+	const size_t full = ((in_len - pos) / 3) * 3;
+	encode_triples(in + pos, full, out + out_len);
+	out_len += (full / 3) * 4;
+	pos += full;
+
+	while (pos < in_len)
+	{
+		_pending[_pending_len++] = in[pos++];
+	}
+	return true;
+}
+
+bool 
+base64_encoder::update(
+	_In_reads_bytes_(in_len) const uint8_t* in,
+	_In_ size_t in_len,
+	_Inout_ CMemoryStream& stream
+	)
+{
+	char buffer[4096];
+	const size_t chunk = (sizeof(buffer) / 4) * 3 - 3;	// pending 바이트 여유
+
+	for (size_t pos = 0; pos < in_len;)
+	{
+		const size_t size = min(chunk, in_len - pos);
+		size_t out_len = 0;
+		if (!update(in + pos, size, buffer, sizeof(buffer), out_len)) return false;
+		if (0 < out_len && out_len != stream.WriteToStream(buffer, out_len))
+		{
+			log_err "WriteToStream() failed." log_end;
+			return false;
+		}
+		pos += size;
+	}
+	return true;
+}
+
+bool 
+base64_encoder::finish(
+	_Out_writes_to_(out_size, out_len) char* out,
+	_In_ size_t out_size,
+	_Out_ size_t& out_len
+	)
+{
+	out_len = 0;
+	if (0 == _pending_len) return true;
+	if (nullptr == out || out_size < 4) return false;
+
+	encode_tail(_pending, _pending_len, out);
+	out_len = 4;
+	_pending_len = 0;
+	return true;
+}
+
+bool base64_encoder::finish(_Inout_ CMemoryStream& stream)
+{
+	char buffer[4];
+	size_t out_len = 0;
+	if (!finish(buffer, sizeof(buffer), out_len)) return false;
+	if (0 < out_len && out_len != stream.WriteToStream(buffer, out_len))
+	{
+		log_err "WriteToStream() failed." log_end;
+		return false;
+	}
+	return true;
+}
+
+
+//
+//	base64_decoder
+//
+
+bool 
+base64_decoder::update(
+	_In_reads_(in_len) const char* in,
+	_In_ size_t in_len,
+	_Out_writes_bytes_to_(out_size, out_len) uint8_t* out,
+	_In_ size_t out_size,
+	_Out_ size_t& out_len
+	)
+{
+	out_len = 0;
+	if (_failed) return false;
+	if (0 == in_len) return true;
+
+	if (nullptr == in || nullptr == out || _padded)
+	{
+		_failed = true;
+		return false;
+	}
+	if (out_size < max_update_length(in_len))
+	{
+		log_err "output buffer too small. required=%zu, size=%zu", max_update_length(in_len), out_size log_end;
+		_failed = true;
+		return false;
+	}
+
+	size_t pos = 0;
+	if (0 < _pending_len)
+	{
+		while (_pending_len < 4 && pos < in_len)
+		{
+			_pending[_pending_len++] = in[pos++];
+		}
+		if (4 > _pending_len) return true;
+
+		if (!decode_quanta(_pending, 4, out, out_len, _padded))
+		{
+			_failed = true;
+			return false;
+		}
+		_pending_len = 0;
+	}
+
+	const size_t full = ((in_len - pos) / 4) * 4;
+	if (0 < full)
+	{
+		size_t length = 0;
+		if (_padded || !decode_quanta(in + pos, full, out + out_len, length, _padded))
+		{
+			_failed = true;
+			return false;
+		}
+		out_len += length;
+		pos += full;
+	}
+
+	if (pos < in_len && _padded)
+	{
+		_failed = true;
+		return false;
+	}
+	while (pos < in_len)
+	{
+		_pending[_pending_len++] = in[pos++];
+	}
+	return true;
+}
+
+bool 
+base64_decoder::update(
+	_In_reads_(in_len) const char* in,
+	_In_ size_t in_len,
+	_Inout_ CMemoryStream& stream
+	)
+{
+	uint8_t buffer[3072];
+	const size_t chunk = (sizeof(buffer) / 3) * 4 - 4;	// pending 문자 여유
+
+	for (size_t pos = 0; pos < in_len;)
+	{
+		const size_t size = min(chunk, in_len - pos);
+		size_t out_len = 0;
+		if (!update(in + pos, size, buffer, sizeof(buffer), out_len)) return false;
+		if (0 < out_len && out_len != stream.WriteToStream((const char*)buffer, out_len))
+		{
+			log_err "WriteToStream() failed." log_end;
+			_failed = true;
+			return false;
+		}
+		pos += size;
+	}
+	return true;
+}
+
+bool base64_decoder::finish()
+{
+	return (!_failed && 0 == _pending_len);
+}
@@ -26,8 +26,11 @@
 */
 
 /// 
+#include <stdint.h>
 #include <string>
 
+class CMemoryStream;
+
 // [ by somma ]
 // character set 에 따라서 결과가 달라질 수 있으므로 ascii 문자열이 아닌 경우 (한글, 특수문자가 포함된 문자열)
 // bytes_to_encode 는 반드시 utf8 인코딩된 문자열을 사용해야 한다. 
@@ -38,4 +41,138 @@
 // 디코딩할 때도 당연히 base64 decoded (utf8 로 간주) --> ucs16 으로 변경해서 사용
 
 std::string base64_encode(unsigned char const* bytes_to_encode, unsigned int in_len);
-std::string base64_decode(std::string const& encoded_string);
\ No newline at end of file
+
+// [ by somma ]
+// 예전 구현과 동일하게 첫번째 '=' 나 base64 가 아닌 문자 전까지만 디코딩한다. (에러 없음)
+// 입력 검증이 필요하면 아래의 base64_decode(in, in_len, out, ...) 를 사용해야 한다.
+std::string base64_decode(std::string const& encoded_string);
+
+
+//
+//	[ by somma ]
+//	SIMD (AVX2/SSSE3) 구현, 호출자 버퍼/CMemoryStream 출력 API
+//
+//	- 인코딩은 항상 '=' 패딩을 붙인다. (RFC 4648, 표준 알파벳)
+//	- 디코딩은 엄격하다. 길이가 4 의 배수가 아니거나, 알파벳 이외의 문자 
+//	  (공백, 개행 포함), 마지막 블록 이외의 '=', 0 이 아닌 남는 비트가 
+//	  있으면 false 를 리턴한다.
+//
+#define BASE64_IMPL_AUTO	0
+#define BASE64_IMPL_SCALAR	1
+#define BASE64_IMPL_SSSE3	2
+#define BASE64_IMPL_AVX2	3
+
+bool base64_set_impl(int impl);
+int base64_get_impl();
+bool base64_impl_supported(int impl);
+const char* base64_impl_name(int impl);
+
+/// @brief	in_len 바이트를 인코딩한 문자열의 길이 (패딩 포함, null 제외)
+inline size_t base64_encoded_length(size_t in_len) { return ((in_len + 2) / 3) * 4; }
+
+/// @brief	in_len 문자를 디코딩했을 때의 최대 바이트 수
+inline size_t base64_decoded_max_length(size_t in_len) { return (in_len / 4) * 3; }
+
+/// @brief	out 에 인코딩한다. (null 문자를 붙이지 않음)
+///			out_size 가 base64_encoded_length(in_len) 보다 작으면 false
+bool 
+base64_encode(
+	_In_reads_bytes_(in_len) const uint8_t* in, 
+	_In_ size_t in_len, 
+	_Out_writes_to_(out_size, out_len) char* out, 
+	_In_ size_t out_size, 
+	_Out_ size_t& out_len
+	);
+
+/// @brief	stream 의 현재 위치에 인코딩한 문자열을 쓴다.
+bool 
+base64_encode(
+	_In_reads_bytes_(in_len) const uint8_t* in, 
+	_In_ size_t in_len, 
+	_Inout_ CMemoryStream& stream
+	);
+
+/// @brief	out 에 디코딩한다. 
+///			out_size 가 디코딩한 크기보다 작거나, 입력이 올바르지 않으면 false
+bool 
+base64_decode(
+	_In_reads_(in_len) const char* in, 
+	_In_ size_t in_len, 
+	_Out_writes_bytes_to_(out_size, out_len) uint8_t* out, 
+	_In_ size_t out_size, 
+	_Out_ size_t& out_len
+	);
+
+/// @brief	stream 의 현재 위치에 디코딩한 데이터를 쓴다.
+bool 
+base64_decode(
+	_In_reads_(in_len) const char* in, 
+	_In_ size_t in_len, 
+	_Inout_ CMemoryStream& stream
+	);
+
+/// @brief	청크 단위로 입력되는 데이터를 인코딩한다.
+///			update() 를 여러번 호출한 결과를 이어붙이고 finish() 의 결과를 
+///			붙이면 전체를 한번에 base64_encode() 한 것과 같다.
+typedef class base64_encoder
+{
+public:
+	base64_encoder() : _pending_len(0) {}
+
+	void reset() { _pending_len = 0; }
+
+	/// @brief	update(in_len) 이 쓸 수 있는 최대 문자 수
+	static size_t max_update_length(size_t in_len) { return ((in_len + 2) / 3) * 4; }
+
+	/// @brief	out_size 는 max_update_length(in_len) 이상이어야 한다.
+	bool update(_In_reads_bytes_(in_len) const uint8_t* in,
+				_In_ size_t in_len,
+				_Out_writes_to_(out_size, out_len) char* out,
+				_In_ size_t out_size,
+				_Out_ size_t& out_len);
+	bool update(_In_reads_bytes_(in_len) const uint8_t* in,
+				_In_ size_t in_len,
+				_Inout_ CMemoryStream& stream);
+
+	/// @brief	남은 바이트를 패딩과 함께 쓴다. (최대 4 문자)
+	bool finish(_Out_writes_to_(out_size, out_len) char* out,
+				_In_ size_t out_size,
+				_Out_ size_t& out_len);
+	bool finish(_Inout_ CMemoryStream& stream);
+
+private:
+	uint8_t _pending[3];
+	size_t _pending_len;
+} *pbase64_encoder;
+
+/// @brief	청크 단위로 입력되는 base64 문자열을 디코딩한다. (청크 경계는 임의)
+///			잘못된 입력을 만나면 그 이후의 호출은 모두 실패한다.
+typedef class base64_decoder
+{
+public:
+	base64_decoder() : _pending_len(0), _padded(false), _failed(false) {}
+
+	void reset() { _pending_len = 0; _padded = false; _failed = false; }
+
+	/// @brief	update(in_len) 이 쓸 수 있는 최대 바이트 수
+	static size_t max_update_length(size_t in_len) { return ((in_len + 3) / 4) * 3; }
+
+	/// @brief	out_size 는 max_update_length(in_len) 이상이어야 한다.
+	bool update(_In_reads_(in_len) const char* in,
+				_In_ size_t in_len,
+				_Out_writes_bytes_to_(out_size, out_len) uint8_t* out,
+				_In_ size_t out_size,
+				_Out_ size_t& out_len);
+	bool update(_In_reads_(in_len) const char* in,
+				_In_ size_t in_len,
+				_Inout_ CMemoryStream& stream);
+
+	/// @brief	입력이 4 문자 단위로 끝났는지 확인한다.
+	bool finish();
+
+private:
+	char _pending[4];
+	size_t _pending_len;
+	bool _padded;		///< '=' 로 끝나는 블록을 처리했음 (더 이상 입력이 있으면 안됨)
+	bool _failed;
+} *pbase64_decoder;
\ No newline at end of file
@@ -0,0 +1,212 @@
+﻿/**
+ * @file    base64_x86.cpp
+ * @brief   x86 base64 encode/decode kernels (SSSE3, AVX2).
+ *
+ * base64.cpp 에서 CPU 지원 여부에 따라 런타임에 선택된다.
+ * 커널은 처리할 수 있는 만큼만 처리하고 처리한 입력 크기를 리턴하며, 
+ * 나머지 (꼬리, 패딩) 는 base64.cpp 의 스칼라 코드가 처리한다.
+ *
+ * - encode : 12 바이트를 pshufb 로 3 바이트씩 4 바이트 슬롯에 펼치고, 
+ *            mulhi/mullo 로 6 비트 인덱스 4 개를 만든 뒤, 인덱스 범위별 
+ *            오프셋을 pshufb 로 찾아서 더한다. (Wojciech Muła 의 방식)
+ * - decode : 각 문자의 상/하위 nibble 로 pshufb 테이블을 찾아서 AND 가 0 이 
+ *            아니면 잘못된 문자로 판단하고, 같은 nibble 로 문자별 오프셋을 
+ *            찾아서 6 비트 값을 만든 뒤 maddubs/madd 로 3 바이트씩 합친다.
+ *
+ * @author  Yonhgwhan, Roh (somma@somma.kr)
+ * @date    2026/10/18 created.
+ * @copyright (C)Somma, Inc. All rights reserved.
+**/
+#include "stdafx.h"
+#include "cpu_features.h"
+
+#if defined(CPU_FEATURES_X86)
+#include <immintrin.h>
+
+/// @brief	12 바이트 (하위 12 바이트만 사용) 를 16 개의 6 비트 인덱스로 펼친다.
+CPU_TARGET("ssse3")
+static inline __m128i enc_reshuffle_ssse3(__m128i in)
+{
+	in = _mm_shuffle_epi8(in, _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1));
+	const __m128i t0 = _mm_and_si128(in, _mm_set1_epi32(0x0fc0fc00));
+	const __m128i t1 = _mm_mulhi_epu16(t0, _mm_set1_epi32(0x04000040));
+	const __m128i t2 = _mm_and_si128(in, _mm_set1_epi32(0x003f03f0));
+	const __m128i t3 = _mm_mullo_epi16(t2, _mm_set1_epi32(0x01000010));
+	return _mm_or_si128(t1, t3);
+}
+
+/// @brief	6 비트 인덱스를 문자로 바꾼다.
+///			0..25 -> 'A', 26..51 -> 'a', 52..61 -> '0', 62 -> '+', 63 -> '/'
+CPU_TARGET("ssse3")
+static inline __m128i enc_translate_ssse3(const __m128i in)
+{
+	const __m128i lut = _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, 
+									  '0' - 52, '0' - 52, '0' - 52, '0' - 52, 
+									  '0' - 52, '0' - 52, '0' - 52, '+' - 62, 
+									  '/' - 63, 'A', 0, 0);
+	__m128i index = _mm_subs_epu8(in, _mm_set1_epi8(51));
+	const __m128i less = _mm_cmpgt_epi8(_mm_set1_epi8(26), in);
+	index = _mm_or_si128(index, _mm_and_si128(less, _mm_set1_epi8(13)));
+	return _mm_add_epi8(in, _mm_shuffle_epi8(lut, index));
+}
+
+/// @brief	16 바이트를 읽어서 12 바이트씩 인코딩한다. 
+CPU_TARGET("ssse3")
+size_t base64_encode_ssse3(const uint8_t* in, size_t in_len, char* out)
+{
+	size_t done = 0;
+	while (in_len - done >= 16)
+	{
+		__m128i str = _mm_loadu_si128((const __m128i*)&in[done]);
+		str = enc_translate_ssse3(enc_reshuffle_ssse3(str));
+		_mm_storeu_si128((__m128i*)out, str);
+		out += 16;
+		done += 12;
+	}
+	return done;
+}
+
+/// @brief	lane 마다 12 바이트씩 (28 바이트를 읽어서) 24 바이트를 인코딩한다.
+CPU_TARGET("avx2")
+size_t base64_encode_avx2(const uint8_t* in, size_t in_len, char* out)
+{
+	const __m256i shuffle = _mm256_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1,
+											10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1);
+	const __m256i lut = _mm256_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, 
+										 '0' - 52, '0' - 52, '0' - 52, '0' - 52, 
+										 '0' - 52, '0' - 52, '0' - 52, '+' - 62, 
+										 '/' - 63, 'A', 0, 0,
+										 'a' - 26, '0' - 52, '0' - 52, '0' - 52, 
+										 '0' - 52, '0' - 52, '0' - 52, '0' - 52, 
+										 '0' - 52, '0' - 52, '0' - 52, '+' - 62, 
+										 '/' - 63, 'A', 0, 0);
+
+	size_t done = 0;
+	while (in_len - done >= 28)
+	{
+		__m256i str = _mm256_inserti128_si256(
+			_mm256_castsi128_si256(_mm_loadu_si128((const __m128i*)&in[done])),
+			_mm_loadu_si128((const __m128i*)&in[done + 12]),
+			1);
+
+		str = _mm256_shuffle_epi8(str, shuffle);
+		const __m256i t0 = _mm256_and_si256(str, _mm256_set1_epi32(0x0fc0fc00));
+		const __m256i t1 = _mm256_mulhi_epu16(t0, _mm256_set1_epi32(0x04000040));
+		const __m256i t2 = _mm256_and_si256(str, _mm256_set1_epi32(0x003f03f0));
+		const __m256i t3 = _mm256_mullo_epi16(t2, _mm256_set1_epi32(0x01000010));
+		str = _mm256_or_si256(t1, t3);
+
+		__m256i index = _mm256_subs_epu8(str, _mm256_set1_epi8(51));
+		const __m256i less = _mm256_cmpgt_epi8(_mm256_set1_epi8(26), str);
+		index = _mm256_or_si256(index, _mm256_and_si256(less, _mm256_set1_epi8(13)));
+		str = _mm256_add_epi8(str, _mm256_shuffle_epi8(lut, index));
+
+		_mm256_storeu_si256((__m256i*)out, str);
+		out += 32;
+		done += 24;
+	}
+	return done;
+}
+
+//
+//	decode
+//
+//	lut_lo[lo nibble] & lut_hi[hi nibble] 가 0 이 아니면 base64 문자가 아니다.
+//	lut_roll[hi nibble (+ '/' 보정)] 을 더하면 6 비트 값이 된다.
+//
+#define B64_DEC_LUT_LO	0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, \
+						0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A
+#define B64_DEC_LUT_HI	0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, \
+						0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10
+#define B64_DEC_LUT_ROLL	0, 16, 19, 4, -65, -65, -71, -71, \
+							0, 0, 0, 0, 0, 0, 0, 0
+
+/// @brief	16 문자씩 디코딩한다. 출력은 16 바이트를 쓰지만 12 바이트만 유효하다.
+///			호출자 버퍼를 넘어서 쓰지 않도록 입력이 24 문자 이상 남았을 때만 
+///			처리한다. (남은 8 문자가 최소 6 바이트를 만듦)
+///			잘못된 문자가 있으면 valid 를 false 로 하고, 그 블록 전까지 처리한 
+///			크기를 리턴한다.
+CPU_TARGET("ssse3")
+size_t base64_decode_ssse3(const char* in, size_t in_len, uint8_t* out, bool& valid)
+{
+	const __m128i lut_lo = _mm_setr_epi8(B64_DEC_LUT_LO);
+	const __m128i lut_hi = _mm_setr_epi8(B64_DEC_LUT_HI);
+	const __m128i lut_roll = _mm_setr_epi8(B64_DEC_LUT_ROLL);
+	const __m128i mask_2f = _mm_set1_epi8(0x2f);
+	const __m128i zero = _mm_setzero_si128();
+
+	valid = true;
+	size_t done = 0;
+	while (in_len - done >= 24)
+	{
+		__m128i str = _mm_loadu_si128((const __m128i*)&in[done]);
+
+		const __m128i hi_nibbles = _mm_and_si128(_mm_srli_epi32(str, 4), mask_2f);
+		const __m128i lo_nibbles = _mm_and_si128(str, mask_2f);
+		const __m128i hi = _mm_shuffle_epi8(lut_hi, hi_nibbles);
+		const __m128i lo = _mm_shuffle_epi8(lut_lo, lo_nibbles);
+		if (0xffff != _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(lo, hi), zero)))
+		{
+			valid = false;
+			break;
+		}
+
+		const __m128i eq_2f = _mm_cmpeq_epi8(str, mask_2f);
+		const __m128i roll = _mm_shuffle_epi8(lut_roll, _mm_add_epi8(eq_2f, hi_nibbles));
+		str = _mm_add_epi8(str, roll);
+
+		str = _mm_maddubs_epi16(str, _mm_set1_epi32(0x01400140));
+		str = _mm_madd_epi16(str, _mm_set1_epi32(0x00011000));
+		str = _mm_shuffle_epi8(str, _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+
+		_mm_storeu_si128((__m128i*)out, str);
+		out += 12;
+		done += 16;
+	}
+	return done;
+}
+
+/// @brief	32 문자씩 디코딩한다. 출력은 32 바이트를 쓰지만 24 바이트만 유효하다.
+///			입력이 48 문자 이상 남았을 때만 처리한다. (남은 16 문자가 최소 12 바이트)
+CPU_TARGET("avx2")
+size_t base64_decode_avx2(const char* in, size_t in_len, uint8_t* out, bool& valid)
+{
+	const __m256i lut_lo = _mm256_setr_epi8(B64_DEC_LUT_LO, B64_DEC_LUT_LO);
+	const __m256i lut_hi = _mm256_setr_epi8(B64_DEC_LUT_HI, B64_DEC_LUT_HI);
+	const __m256i lut_roll = _mm256_setr_epi8(B64_DEC_LUT_ROLL, B64_DEC_LUT_ROLL);
+	const __m256i mask_2f = _mm256_set1_epi8(0x2f);
+
+	valid = true;
+	size_t done = 0;
+	while (in_len - done >= 48)
+	{
+		__m256i str = _mm256_loadu_si256((const __m256i*)&in[done]);
+
+		const __m256i hi_nibbles = _mm256_and_si256(_mm256_srli_epi32(str, 4), mask_2f);
+		const __m256i lo_nibbles = _mm256_and_si256(str, mask_2f);
+		const __m256i hi = _mm256_shuffle_epi8(lut_hi, hi_nibbles);
+		const __m256i lo = _mm256_shuffle_epi8(lut_lo, lo_nibbles);
+		if (!_mm256_testz_si256(lo, hi))
+		{
+			valid = false;
+			break;
+		}
+
+		const __m256i eq_2f = _mm256_cmpeq_epi8(str, mask_2f);
+		const __m256i roll = _mm256_shuffle_epi8(lut_roll, _mm256_add_epi8(eq_2f, hi_nibbles));
+		str = _mm256_add_epi8(str, roll);
+
+		str = _mm256_maddubs_epi16(str, _mm256_set1_epi32(0x01400140));
+		str = _mm256_madd_epi16(str, _mm256_set1_epi32(0x00011000));
+		str = _mm256_shuffle_epi8(str, _mm256_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+														2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+		str = _mm256_permutevar8x32_epi32(str, _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 3, 7));
+
+		_mm256_storeu_si256((__m256i*)out, str);
+		out += 24;
+		done += 32;
+	}
+	return done;
+}
+
+#endif//CPU_FEATURES_X86
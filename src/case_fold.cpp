@@ -0,0 +1,424 @@
+﻿/**
+ * @file    case_fold.cpp
+ * @brief   Vectorised ASCII case folding and case-insensitive compare/search.
+ *
+ * @author  Yonhgwhan, Roh (somma@somma.kr)
+ * @date    2026/10/18 created.
+ * @copyright (C)Somma, Inc. All rights reserved.
+**/
+#include "stdafx.h"
+#include "case_fold.h"
+#include "cpu_features.h"
+#include <wchar.h>
+#include <wctype.h>
+#include <atomic>
+
+//
+//	커널 (8 비트, 16 비트 문자)
+//
+//	fold  : [from, from + 25] 범위의 문자의 0x20 비트를 뒤집는다. 
+//	        ('A' 이면 소문자로, 'a' 이면 대문자로) ASCII 가 아닌 문자가 
+//	        없으면 true
+//	equal : ASCII 대소문자를 무시하고 앞에서부터 같은 문자 수
+//	find  : ASCII 소문자로 바꿨을 때 c 와 같은 첫번째 위치, 없으면 len 
+//	        (16 비트 커널은 ASCII 가 아닌 문자에서도 멈춘다)
+//
+typedef bool (*fold8_fn)(uint8_t* s, size_t len, uint8_t from);
+typedef bool (*fold16_fn)(uint16_t* s, size_t len, uint16_t from);
+typedef size_t (*equal8_fn)(const uint8_t* a, const uint8_t* b, size_t len);
+typedef size_t (*equal16_fn)(const uint16_t* a, const uint16_t* b, size_t len);
+typedef size_t (*find8_fn)(const uint8_t* s, size_t len, uint8_t c);
+typedef size_t (*find16_fn)(const uint16_t* s, size_t len, uint16_t c);
+
+#if defined(CPU_FEATURES_X86)
+bool case_fold8_sse2(uint8_t* s, size_t len, uint8_t from);
+bool case_fold16_sse2(uint16_t* s, size_t len, uint16_t from);
+size_t case_equal8_sse2(const uint8_t* a, const uint8_t* b, size_t len);
+size_t case_equal16_sse2(const uint16_t* a, const uint16_t* b, size_t len);
+size_t case_find8_sse2(const uint8_t* s, size_t len, uint8_t c);
+size_t case_find16_sse2(const uint16_t* s, size_t len, uint16_t c);
+
+bool case_fold8_avx2(uint8_t* s, size_t len, uint8_t from);
+bool case_fold16_avx2(uint16_t* s, size_t len, uint16_t from);
+size_t case_equal8_avx2(const uint8_t* a, const uint8_t* b, size_t len);
+size_t case_equal16_avx2(const uint16_t* a, const uint16_t* b, size_t len);
+size_t case_find8_avx2(const uint8_t* s, size_t len, uint8_t c);
+size_t case_find16_avx2(const uint16_t* s, size_t len, uint16_t c);
+#endif
+
+template <typename U>
+static inline U ascii_lower(U c)
+{
+	return ((U)(c - 'A') < 26) ? (U)(c | 0x20) : c;
+}
+
+template <typename U>
+static bool case_fold_scalar(U* s, size_t len, U from)
+{
+	bool ascii = true;
+	for (size_t i = 0; i < len; ++i)
+	{
+		if ((U)(s[i] - from) < 26)
+		{
+			s[i] ^= 0x20;
+		}
+		else if (s[i] >= 0x80)
+		{
+			ascii = false;
+		}
+	}
+	return ascii;
+}
+
+template <typename U>
+static size_t case_equal_scalar(const U* a, const U* b, size_t len)
+{
+	for (size_t i = 0; i < len; ++i)
+	{
+		if (ascii_lower(a[i]) != ascii_lower(b[i])) return i;
+	}
+	return len;
+}
+
+static size_t case_find8_scalar(const uint8_t* s, size_t len, uint8_t c)
+{
+	for (size_t i = 0; i < len; ++i)
+	{
+		if (ascii_lower(s[i]) == c) return i;
+	}
+	return len;
+}
+
+template <typename U>
+static size_t case_find_wide_scalar(const U* s, size_t len, U c)
+{
+	for (size_t i = 0; i < len; ++i)
+	{
+		if (ascii_lower(s[i]) == c || s[i] >= 0x80) return i;
+	}
+	return len;
+}
+
+typedef struct case_fold_kernels
+{
+	int impl;
+	fold8_fn fold8;
+	fold16_fn fold16;
+	equal8_fn equal8;
+	equal16_fn equal16;
+	find8_fn find8;
+	find16_fn find16;
+} *pcase_fold_kernels;
+
+static const case_fold_kernels _kernels_scalar = {
+	CASE_FOLD_IMPL_SCALAR,
+	case_fold_scalar<uint8_t>,
+	case_fold_scalar<uint16_t>,
+	case_equal_scalar<uint8_t>,
+	case_equal_scalar<uint16_t>,
+	case_find8_scalar,
+	case_find_wide_scalar<uint16_t>
+};
+#if defined(CPU_FEATURES_X86)
+static const case_fold_kernels _kernels_sse2 = {
+	CASE_FOLD_IMPL_SSE2,
+	case_fold8_sse2,
+	case_fold16_sse2,
+	case_equal8_sse2,
+	case_equal16_sse2,
+	case_find8_sse2,
+	case_find16_sse2
+};
+static const case_fold_kernels _kernels_avx2 = {
+	CASE_FOLD_IMPL_AVX2,
+	case_fold8_avx2,
+	case_fold16_avx2,
+	case_equal8_avx2,
+	case_equal16_avx2,
+	case_find8_avx2,
+	case_find16_avx2
+};
+#endif
+
+static const case_fold_kernels* case_fold_impl_kernels(int impl)
+{
+	switch (impl)
+	{
+	case CASE_FOLD_IMPL_SCALAR:
+		return &_kernels_scalar;
+#if defined(CPU_FEATURES_X86)
+	case CASE_FOLD_IMPL_SSE2:
+		return get_cpu_features().sse2 ? &_kernels_sse2 : nullptr;
+	case CASE_FOLD_IMPL_AVX2:
+		return get_cpu_features().avx2 ? &_kernels_avx2 : nullptr;
+#endif
+	}
+	return nullptr;
+}
+
+static int case_fold_best_impl()
+{
+	if (nullptr != case_fold_impl_kernels(CASE_FOLD_IMPL_AVX2)) return CASE_FOLD_IMPL_AVX2;
+	if (nullptr != case_fold_impl_kernels(CASE_FOLD_IMPL_SSE2)) return CASE_FOLD_IMPL_SSE2;
+	return CASE_FOLD_IMPL_SCALAR;
+}
+
+static std::atomic<const case_fold_kernels*> _kernels(nullptr);
+
+static const case_fold_kernels* case_fold_get_kernels()
+{
+	const case_fold_kernels* kernels = _kernels.load(std::memory_order_relaxed);
+	if (nullptr == kernels)
+	{
+		kernels = case_fold_impl_kernels(case_fold_best_impl());
+		_kernels.store(kernels, std::memory_order_relaxed);
+	}
+	return kernels;
+}
+
+/// @brief	case fold 함수들이 사용할 구현을 선택한다.
+///			CASE_FOLD_IMPL_AUTO 는 CPU 가 지원하는 가장 빠른 구현을 선택한다.
+bool case_fold_set_impl(int impl)
+{
+	if (CASE_FOLD_IMPL_AUTO == impl)
+	{
+		impl = case_fold_best_impl();
+	}
+
+	const case_fold_kernels* kernels = case_fold_impl_kernels(impl);
+	if (nullptr == kernels) return false;
+
+	_kernels.store(kernels, std::memory_order_relaxed);
+	return true;
+}
+
+int case_fold_get_impl()
+{
+	return case_fold_get_kernels()->impl;
+}
+
+bool case_fold_impl_supported(int impl)
+{
+	return (CASE_FOLD_IMPL_AUTO == impl || nullptr != case_fold_impl_kernels(impl));
+}
+
+const char* case_fold_impl_name(int impl)
+{
+	switch (impl)
+	{
+	case CASE_FOLD_IMPL_AUTO: return "auto";
+	case CASE_FOLD_IMPL_SCALAR: return "scalar";
+	case CASE_FOLD_IMPL_SSE2: return "sse2";
+	case CASE_FOLD_IMPL_AVX2: return "avx2";
+	}
+	return "unknown";
+}
+
+
+//
+//	wchar_t 는 windows 에서는 16 비트 (커널 사용), 그 외에는 32 비트 (스칼라)
+//
+#if WCHAR_MAX == 0xffff
+typedef uint16_t wide_unit;
+
+static inline bool wide_fold(const case_fold_kernels* kernels, wchar_t* s, size_t len, wide_unit from)
+{
+	return kernels->fold16((uint16_t*)s, len, from);
+}
+
+static inline size_t wide_equal(const case_fold_kernels* kernels, const wchar_t* a, const wchar_t* b, size_t len)
+{
+	return kernels->equal16((const uint16_t*)a, (const uint16_t*)b, len);
+}
+
+static inline size_t wide_find(const case_fold_kernels* kernels, const wchar_t* s, size_t len, wide_unit c)
+{
+	return kernels->find16((const uint16_t*)s, len, c);
+}
+#else
+typedef uint32_t wide_unit;
+
+static inline bool wide_fold(const case_fold_kernels* kernels, wchar_t* s, size_t len, wide_unit from)
+{
+	UNREFERENCED_PARAMETER(kernels);
+	return case_fold_scalar<uint32_t>((uint32_t*)s, len, from);
+}
+
+static inline size_t wide_equal(const case_fold_kernels* kernels, const wchar_t* a, const wchar_t* b, size_t len)
+{
+	UNREFERENCED_PARAMETER(kernels);
+	return case_equal_scalar<uint32_t>((const uint32_t*)a, (const uint32_t*)b, len);
+}
+
+static inline size_t wide_find(const case_fold_kernels* kernels, const wchar_t* s, size_t len, wide_unit c)
+{
+	UNREFERENCED_PARAMETER(kernels);
+	return case_find_wide_scalar<uint32_t>((const uint32_t*)s, len, c);
+}
+#endif//WCHAR_MAX == 0xffff
+
+/// @brief	wchar_t 비교용 소문자 (ASCII 가 아니면 towlower)
+static inline wide_unit fold_wide(wchar_t c)
+{
+	const wide_unit u = (wide_unit)c;
+	return (u < 0x80) ? ascii_lower(u) : (wide_unit)towlower((wint_t)c);
+}
+
+/// @brief	a, b 의 len 문자가 대소문자를 무시하고 같은지 
+///			커널이 다르다고 한 위치에서는 towlower 로 한번 더 비교한다.
+static bool wide_equals(const case_fold_kernels* kernels, const wchar_t* a, const wchar_t* b, size_t len)
+{
+	size_t i = 0;
+	while (i < len)
+	{
+		i += wide_equal(kernels, &a[i], &b[i], len - i);
+		if (i == len) break;
+
+		if (fold_wide(a[i]) != fold_wide(b[i])) return false;
+		++i;
+	}
+	return true;
+}
+
+
+/// @brief	s 를 그 자리에서 소문자로 바꾼다.
+void fold_to_lower(_Inout_updates_(len) char* s, _In_ size_t len)
+{
+	if (nullptr == s || 0 == len) return;
+	if (case_fold_get_kernels()->fold8((uint8_t*)s, len, 'A')) return;
+
+#if defined(_WIN32)
+	CharLowerBuffA(s, (DWORD)len);
+#endif
+}
+
+void fold_to_lower(_Inout_updates_(len) wchar_t* s, _In_ size_t len)
+{
+	if (nullptr == s || 0 == len) return;
+	if (wide_fold(case_fold_get_kernels(), s, len, 'A')) return;
+
+#if defined(_WIN32)
+	CharLowerBuffW(s, (DWORD)len);
+#else
+	for (size_t i = 0; i < len; ++i)
+	{
+		if ((wide_unit)s[i] >= 0x80) s[i] = (wchar_t)towlower((wint_t)s[i]);
+	}
+#endif
+}
+
+/// @brief	s 를 그 자리에서 대문자로 바꾼다.
+void fold_to_upper(_Inout_updates_(len) char* s, _In_ size_t len)
+{
+	if (nullptr == s || 0 == len) return;
+	if (case_fold_get_kernels()->fold8((uint8_t*)s, len, 'a')) return;
+
+#if defined(_WIN32)
+	CharUpperBuffA(s, (DWORD)len);
+#endif
+}
+
+void fold_to_upper(_Inout_updates_(len) wchar_t* s, _In_ size_t len)
+{
+	if (nullptr == s || 0 == len) return;
+	if (wide_fold(case_fold_get_kernels(), s, len, 'a')) return;
+
+#if defined(_WIN32)
+	CharUpperBuffW(s, (DWORD)len);
+#else
+	for (size_t i = 0; i < len; ++i)
+	{
+		if ((wide_unit)s[i] >= 0x80) s[i] = (wchar_t)towupper((wint_t)s[i]);
+	}
+#endif
+}
+
+/// @brief	대소문자를 무시하고 비교한다.
+bool equals_ci(_In_ std::string_view lhs, _In_ std::string_view rhs)
+{
+	if (lhs.size() != rhs.size()) return false;
+	return (lhs.size() == case_fold_get_kernels()->equal8((const uint8_t*)lhs.data(), 
+														  (const uint8_t*)rhs.data(), 
+														  lhs.size()));
+}
+
+bool equals_ci(_In_ std::wstring_view lhs, _In_ std::wstring_view rhs)
+{
+	if (lhs.size() != rhs.size()) return false;
+	return wide_equals(case_fold_get_kernels(), lhs.data(), rhs.data(), lhs.size());
+}
+
+bool starts_with_ci(_In_ std::string_view s, _In_ std::string_view prefix)
+{
+	return (prefix.size() <= s.size() && equals_ci(s.substr(0, prefix.size()), prefix));
+}
+
+bool starts_with_ci(_In_ std::wstring_view s, _In_ std::wstring_view prefix)
+{
+	return (prefix.size() <= s.size() && equals_ci(s.substr(0, prefix.size()), prefix));
+}
+
+bool ends_with_ci(_In_ std::string_view s, _In_ std::string_view suffix)
+{
+	return (suffix.size() <= s.size() && equals_ci(s.substr(s.size() - suffix.size()), suffix));
+}
+
+bool ends_with_ci(_In_ std::wstring_view s, _In_ std::wstring_view suffix)
+{
+	return (suffix.size() <= s.size() && equals_ci(s.substr(s.size() - suffix.size()), suffix));
+}
+
+/// @brief	첫 문자로 후보 위치를 커널로 찾고, 나머지를 비교한다.
+size_t find_ci(_In_ std::string_view s, _In_ std::string_view needle, _In_ size_t pos)
+{
+	if (pos > s.size()) return std::string_view::npos;
+	if (needle.empty()) return pos;
+	if (needle.size() > s.size() - pos) return std::string_view::npos;
+
+	const case_fold_kernels* kernels = case_fold_get_kernels();
+	const uint8_t* str = (const uint8_t*)s.data();
+	const uint8_t* nd = (const uint8_t*)needle.data();
+	const uint8_t first = ascii_lower(nd[0]);
+	const size_t rest = needle.size() - 1;
+	const size_t last = s.size() - needle.size();
+
+	for (size_t i = pos; i <= last; ++i)
+	{
+		i += kernels->find8(&str[i], last - i + 1, first);
+		if (i > last) break;
+
+		if (rest == kernels->equal8(&str[i + 1], &nd[1], rest)) return i;
+	}
+	return std::string_view::npos;
+}
+
+size_t find_ci(_In_ std::wstring_view s, _In_ std::wstring_view needle, _In_ size_t pos)
+{
+	if (pos > s.size()) return std::wstring_view::npos;
+	if (needle.empty()) return pos;
+	if (needle.size() > s.size() - pos) return std::wstring_view::npos;
+
+	const case_fold_kernels* kernels = case_fold_get_kernels();
+	const wide_unit first = fold_wide(needle[0]);
+	const size_t rest = needle.size() - 1;
+	const size_t last = s.size() - needle.size();
+
+	for (size_t i = pos; i <= last; ++i)
+	{
+		//
+		//	첫 문자가 ASCII 이면 커널로 후보를 찾는다. 
+		//	(커널은 ASCII 가 아닌 문자에서도 멈추므로 다시 확인해야 한다)
+		//
+		if (first < 0x80)
+		{
+			i += wide_find(kernels, &s[i], last - i + 1, first);
+			if (i > last) break;
+		}
+
+		if (fold_wide(s[i]) == first && wide_equals(kernels, &s[i + 1], &needle[1], rest))
+		{
+			return i;
+		}
+	}
+	return std::wstring_view::npos;
+}
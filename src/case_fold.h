@@ -0,0 +1,61 @@
+﻿/**
+ * @file    case_fold.h
+ * @brief   Vectorised ASCII case folding and case-insensitive compare/search.
+ *
+ * 문자열을 소문자로 복사하지 않고 (할당 없이) 대소문자를 무시하고 비교/검색한다.
+ * ASCII 구간은 SSE2/AVX2 커널 (CPU 에 따라 런타임에 선택) 이 16/32 바이트씩 
+ * 처리한다.
+ *
+ *	- 비교/검색 (equals_ci, starts_with_ci, ends_with_ci, find_ci)
+ *	  char    : ASCII 문자만 대소문자를 무시한다. (멀티바이트/UTF-8 의 
+ *	            0x80 이상 바이트는 그대로 비교, _strnicmp 의 "C" 로케일 동작)
+ *	  wchar_t : ASCII 가 아닌 문자는 towlower() 로 비교한다.
+ *	- 변환 (fold_to_lower, fold_to_upper) 
+ *	  ASCII 는 커널이 바꾸고, ASCII 가 아닌 문자가 있으면 windows 에서는 
+ *	  CharLowerBuff/CharUpperBuff 로 (to_lower_string() 과 같은 결과), 
+ *	  그 외 플랫폼에서는 towlower/towupper (wchar_t 만) 로 바꾼다.
+ *
+ * @author  Yonhgwhan, Roh (somma@somma.kr)
+ * @date    2026/10/18 created.
+ * @copyright (C)Somma, Inc. All rights reserved.
+**/
+#pragma once
+#include <stdint.h>
+#include <string>
+#include <string_view>
+
+#define CASE_FOLD_IMPL_AUTO		0
+#define CASE_FOLD_IMPL_SCALAR	1
+#define CASE_FOLD_IMPL_SSE2		2
+#define CASE_FOLD_IMPL_AVX2		3
+
+bool case_fold_set_impl(int impl);
+int case_fold_get_impl();
+bool case_fold_impl_supported(int impl);
+const char* case_fold_impl_name(int impl);
+
+/// @brief	s 를 그 자리에서 소문자/대문자로 바꾼다.
+void fold_to_lower(_Inout_updates_(len) char* s, _In_ size_t len);
+void fold_to_lower(_Inout_updates_(len) wchar_t* s, _In_ size_t len);
+void fold_to_upper(_Inout_updates_(len) char* s, _In_ size_t len);
+void fold_to_upper(_Inout_updates_(len) wchar_t* s, _In_ size_t len);
+
+inline void fold_to_lower(_Inout_ std::string& s) { if (!s.empty()) fold_to_lower(&s[0], s.size()); }
+inline void fold_to_lower(_Inout_ std::wstring& s) { if (!s.empty()) fold_to_lower(&s[0], s.size()); }
+inline void fold_to_upper(_Inout_ std::string& s) { if (!s.empty()) fold_to_upper(&s[0], s.size()); }
+inline void fold_to_upper(_Inout_ std::wstring& s) { if (!s.empty()) fold_to_upper(&s[0], s.size()); }
+
+/// @brief	대소문자를 무시하고 비교한다.
+bool equals_ci(_In_ std::string_view lhs, _In_ std::string_view rhs);
+bool equals_ci(_In_ std::wstring_view lhs, _In_ std::wstring_view rhs);
+
+bool starts_with_ci(_In_ std::string_view s, _In_ std::string_view prefix);
+bool starts_with_ci(_In_ std::wstring_view s, _In_ std::wstring_view prefix);
+
+bool ends_with_ci(_In_ std::string_view s, _In_ std::string_view suffix);
+bool ends_with_ci(_In_ std::wstring_view s, _In_ std::wstring_view suffix);
+
+/// @brief	s 의 pos 위치부터 대소문자를 무시하고 needle 을 찾는다. 
+///			없으면 npos (std::string::npos 와 같은 값)
+size_t find_ci(_In_ std::string_view s, _In_ std::string_view needle, _In_ size_t pos = 0);
+size_t find_ci(_In_ std::wstring_view s, _In_ std::wstring_view needle, _In_ size_t pos = 0);
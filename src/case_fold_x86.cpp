@@ -0,0 +1,399 @@
+﻿/**
+ * @file    case_fold_x86.cpp
+ * @brief   x86 ASCII case folding kernels (SSE2, AVX2) for case_fold.
+ *
+ * case_fold.cpp 에서 CPU 지원 여부에 따라 런타임에 선택된다.
+ * [from, from + 25] 범위 검사는 unsigned 비교 대신 0x80 (16 비트는 0x8000) 
+ * 만큼 치우친 signed 비교 한번으로 한다.
+ *
+ * @author  Yonhgwhan, Roh (somma@somma.kr)
+ * @date    2026/10/18 created.
+ * @copyright (C)Somma, Inc. All rights reserved.
+**/
+#include "stdafx.h"
+#include "cpu_features.h"
+
+#if defined(CPU_FEATURES_X86)
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+/// @brief	v 의 최하위 1 비트 위치 (v != 0)
+static inline uint32_t lowest_bit(uint32_t v)
+{
+#if defined(_MSC_VER)
+	unsigned long index;
+	_BitScanForward(&index, v);
+	return (uint32_t)index;
+#else
+	return (uint32_t)__builtin_ctz(v);
+#endif
+}
+
+template <typename U>
+static inline U ascii_lower(U c)
+{
+	return ((U)(c - 'A') < 26) ? (U)(c | 0x20) : c;
+}
+
+
+//
+//	SSE2
+//
+
+/// @brief	[from, from + 25] 범위의 바이트는 0x20, 나머지는 0
+CPU_TARGET("sse2")
+static inline __m128i case_bit8_sse2(const __m128i v, const __m128i bias, const __m128i limit)
+{
+	const __m128i in_range = _mm_cmpgt_epi8(limit, _mm_sub_epi8(v, bias));
+	return _mm_and_si128(in_range, _mm_set1_epi8(0x20));
+}
+
+CPU_TARGET("sse2")
+static inline __m128i case_bit16_sse2(const __m128i v, const __m128i bias, const __m128i limit)
+{
+	const __m128i in_range = _mm_cmpgt_epi16(limit, _mm_sub_epi16(v, bias));
+	return _mm_and_si128(in_range, _mm_set1_epi16(0x20));
+}
+
+CPU_TARGET("sse2")
+static inline bool case_fold8_sse2_inline(uint8_t* s, size_t len, uint8_t from)
+{
+	const __m128i bias = _mm_set1_epi8((char)(from + 0x80));
+	const __m128i limit = _mm_set1_epi8((char)(-128 + 26));
+	__m128i high = _mm_setzero_si128();
+
+	size_t i = 0;
+	for (; len - i >= 16; i += 16)
+	{
+		const __m128i v = _mm_loadu_si128((const __m128i*)&s[i]);
+		_mm_storeu_si128((__m128i*)&s[i], _mm_xor_si128(v, case_bit8_sse2(v, bias, limit)));
+		high = _mm_or_si128(high, v);
+	}
+
+	bool ascii = (0 == _mm_movemask_epi8(high));
+	for (; i < len; ++i)
+	{
+		if ((uint8_t)(s[i] - from) < 26)
+		{
+			s[i] ^= 0x20;
+		}
+		else if (s[i] >= 0x80)
+		{
+			ascii = false;
+		}
+	}
+	return ascii;
+}
+
+CPU_TARGET("sse2")
+static inline bool case_fold16_sse2_inline(uint16_t* s, size_t len, uint16_t from)
+{
+	const __m128i bias = _mm_set1_epi16((short)(from + 0x8000));
+	const __m128i limit = _mm_set1_epi16((short)(-32768 + 26));
+	__m128i high = _mm_setzero_si128();
+
+	size_t i = 0;
+	for (; len - i >= 8; i += 8)
+	{
+		const __m128i v = _mm_loadu_si128((const __m128i*)&s[i]);
+		_mm_storeu_si128((__m128i*)&s[i], _mm_xor_si128(v, case_bit16_sse2(v, bias, limit)));
+		high = _mm_or_si128(high, v);
+	}
+
+	high = _mm_and_si128(high, _mm_set1_epi16((short)0xff80));
+	bool ascii = (0xffff == _mm_movemask_epi8(_mm_cmpeq_epi16(high, _mm_setzero_si128())));
+	for (; i < len; ++i)
+	{
+		if ((uint16_t)(s[i] - from) < 26)
+		{
+			s[i] ^= 0x20;
+		}
+		else if (s[i] >= 0x80)
+		{
+			ascii = false;
+		}
+	}
+	return ascii;
+}
+
+CPU_TARGET("sse2")
+static inline size_t case_equal8_sse2_inline(const uint8_t* a, const uint8_t* b, size_t len)
+{
+	const __m128i bias = _mm_set1_epi8((char)('A' + 0x80));
+	const __m128i limit = _mm_set1_epi8((char)(-128 + 26));
+
+	size_t i = 0;
+	for (; len - i >= 16; i += 16)
+	{
+		__m128i va = _mm_loadu_si128((const __m128i*)&a[i]);
+		__m128i vb = _mm_loadu_si128((const __m128i*)&b[i]);
+		va = _mm_or_si128(va, case_bit8_sse2(va, bias, limit));
+		vb = _mm_or_si128(vb, case_bit8_sse2(vb, bias, limit));
+
+		const uint32_t mask = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(va, vb));
+		if (0xffff != mask) return i + lowest_bit(~mask);
+	}
+
+	for (; i < len; ++i)
+	{
+		if (ascii_lower(a[i]) != ascii_lower(b[i])) return i;
+	}
+	return len;
+}
+
+CPU_TARGET("sse2")
+static inline size_t case_equal16_sse2_inline(const uint16_t* a, const uint16_t* b, size_t len)
+{
+	const __m128i bias = _mm_set1_epi16((short)('A' + 0x8000));
+	const __m128i limit = _mm_set1_epi16((short)(-32768 + 26));
+
+	size_t i = 0;
+	for (; len - i >= 8; i += 8)
+	{
+		__m128i va = _mm_loadu_si128((const __m128i*)&a[i]);
+		__m128i vb = _mm_loadu_si128((const __m128i*)&b[i]);
+		va = _mm_or_si128(va, case_bit16_sse2(va, bias, limit));
+		vb = _mm_or_si128(vb, case_bit16_sse2(vb, bias, limit));
+
+		const uint32_t mask = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi16(va, vb));
+		if (0xffff != mask) return i + lowest_bit(~mask) / 2;
+	}
+
+	for (; i < len; ++i)
+	{
+		if (ascii_lower(a[i]) != ascii_lower(b[i])) return i;
+	}
+	return len;
+}
+
+CPU_TARGET("sse2")
+static inline size_t case_find8_sse2_inline(const uint8_t* s, size_t len, uint8_t c)
+{
+	const __m128i bias = _mm_set1_epi8((char)('A' + 0x80));
+	const __m128i limit = _mm_set1_epi8((char)(-128 + 26));
+	const __m128i vc = _mm_set1_epi8((char)c);
+
+	size_t i = 0;
+	for (; len - i >= 16; i += 16)
+	{
+		__m128i v = _mm_loadu_si128((const __m128i*)&s[i]);
+		v = _mm_or_si128(v, case_bit8_sse2(v, bias, limit));
+
+		const uint32_t mask = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v, vc));
+		if (0 != mask) return i + lowest_bit(mask);
+	}
+
+	for (; i < len; ++i)
+	{
+		if (ascii_lower(s[i]) == c) return i;
+	}
+	return len;
+}
+
+/// @brief	c 와 같거나 ASCII 가 아닌 첫번째 위치
+CPU_TARGET("sse2")
+static inline size_t case_find16_sse2_inline(const uint16_t* s, size_t len, uint16_t c)
+{
+	const __m128i bias = _mm_set1_epi16((short)('A' + 0x8000));
+	const __m128i limit = _mm_set1_epi16((short)(-32768 + 26));
+	const __m128i vc = _mm_set1_epi16((short)c);
+	const __m128i high = _mm_set1_epi16((short)0xff80);
+
+	size_t i = 0;
+	for (; len - i >= 8; i += 8)
+	{
+		const __m128i v = _mm_loadu_si128((const __m128i*)&s[i]);
+		const __m128i lower = _mm_or_si128(v, case_bit16_sse2(v, bias, limit));
+		const __m128i ascii = _mm_cmpeq_epi16(_mm_and_si128(v, high), _mm_setzero_si128());
+
+		const uint32_t mask = (~(uint32_t)_mm_movemask_epi8(ascii) & 0xffff) |
+							  (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi16(lower, vc));
+		if (0 != mask) return i + lowest_bit(mask) / 2;
+	}
+
+	for (; i < len; ++i)
+	{
+		if (ascii_lower(s[i]) == c || s[i] >= 0x80) return i;
+	}
+	return len;
+}
+
+CPU_TARGET("sse2")
+bool case_fold8_sse2(uint8_t* s, size_t len, uint8_t from)
+{
+	return case_fold8_sse2_inline(s, len, from);
+}
+
+CPU_TARGET("sse2")
+bool case_fold16_sse2(uint16_t* s, size_t len, uint16_t from)
+{
+	return case_fold16_sse2_inline(s, len, from);
+}
+
+CPU_TARGET("sse2")
+size_t case_equal8_sse2(const uint8_t* a, const uint8_t* b, size_t len)
+{
+	return case_equal8_sse2_inline(a, b, len);
+}
+
+CPU_TARGET("sse2")
+size_t case_equal16_sse2(const uint16_t* a, const uint16_t* b, size_t len)
+{
+	return case_equal16_sse2_inline(a, b, len);
+}
+
+CPU_TARGET("sse2")
+size_t case_find8_sse2(const uint8_t* s, size_t len, uint8_t c)
+{
+	return case_find8_sse2_inline(s, len, c);
+}
+
+CPU_TARGET("sse2")
+size_t case_find16_sse2(const uint16_t* s, size_t len, uint16_t c)
+{
+	return case_find16_sse2_inline(s, len, c);
+}
+
+
+//
+//	AVX2 (32 바이트 블록, 나머지는 SSE2 로 처리)
+//
+
+CPU_TARGET("avx2")
+static inline __m256i case_bit8_avx2(const __m256i v, const __m256i bias, const __m256i limit)
+{
+	const __m256i in_range = _mm256_cmpgt_epi8(limit, _mm256_sub_epi8(v, bias));
+	return _mm256_and_si256(in_range, _mm256_set1_epi8(0x20));
+}
+
+CPU_TARGET("avx2")
+static inline __m256i case_bit16_avx2(const __m256i v, const __m256i bias, const __m256i limit)
+{
+	const __m256i in_range = _mm256_cmpgt_epi16(limit, _mm256_sub_epi16(v, bias));
+	return _mm256_and_si256(in_range, _mm256_set1_epi16(0x20));
+}
+
+CPU_TARGET("avx2")
+bool case_fold8_avx2(uint8_t* s, size_t len, uint8_t from)
+{
+	const __m256i bias = _mm256_set1_epi8((char)(from + 0x80));
+	const __m256i limit = _mm256_set1_epi8((char)(-128 + 26));
+	__m256i high = _mm256_setzero_si256();
+
+	size_t i = 0;
+	for (; len - i >= 32; i += 32)
+	{
+		const __m256i v = _mm256_loadu_si256((const __m256i*)&s[i]);
+		_mm256_storeu_si256((__m256i*)&s[i], _mm256_xor_si256(v, case_bit8_avx2(v, bias, limit)));
+		high = _mm256_or_si256(high, v);
+	}
+
+	const bool ascii = (0 == _mm256_movemask_epi8(high));
+	return case_fold8_sse2_inline(&s[i], len - i, from) && ascii;
+}
+
+CPU_TARGET("avx2")
+bool case_fold16_avx2(uint16_t* s, size_t len, uint16_t from)
+{
+	const __m256i bias = _mm256_set1_epi16((short)(from + 0x8000));
+	const __m256i limit = _mm256_set1_epi16((short)(-32768 + 26));
+	__m256i high = _mm256_setzero_si256();
+
+	size_t i = 0;
+	for (; len - i >= 16; i += 16)
+	{
+		const __m256i v = _mm256_loadu_si256((const __m256i*)&s[i]);
+		_mm256_storeu_si256((__m256i*)&s[i], _mm256_xor_si256(v, case_bit16_avx2(v, bias, limit)));
+		high = _mm256_or_si256(high, v);
+	}
+
+	high = _mm256_and_si256(high, _mm256_set1_epi16((short)0xff80));
+	const bool ascii = (0xffffffff == (uint32_t)_mm256_movemask_epi8(
+		_mm256_cmpeq_epi16(high, _mm256_setzero_si256())));
+	return case_fold16_sse2_inline(&s[i], len - i, from) && ascii;
+}
+
+CPU_TARGET("avx2")
+size_t case_equal8_avx2(const uint8_t* a, const uint8_t* b, size_t len)
+{
+	const __m256i bias = _mm256_set1_epi8((char)('A' + 0x80));
+	const __m256i limit = _mm256_set1_epi8((char)(-128 + 26));
+
+	size_t i = 0;
+	for (; len - i >= 32; i += 32)
+	{
+		__m256i va = _mm256_loadu_si256((const __m256i*)&a[i]);
+		__m256i vb = _mm256_loadu_si256((const __m256i*)&b[i]);
+		va = _mm256_or_si256(va, case_bit8_avx2(va, bias, limit));
+		vb = _mm256_or_si256(vb, case_bit8_avx2(vb, bias, limit));
+
+		const uint32_t mask = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(va, vb));
+		if (0xffffffff != mask) return i + lowest_bit(~mask);
+	}
+	return i + case_equal8_sse2_inline(&a[i], &b[i], len - i);
+}
+
+CPU_TARGET("avx2")
+size_t case_equal16_avx2(const uint16_t* a, const uint16_t* b, size_t len)
+{
+	const __m256i bias = _mm256_set1_epi16((short)('A' + 0x8000));
+	const __m256i limit = _mm256_set1_epi16((short)(-32768 + 26));
+
+	size_t i = 0;
+	for (; len - i >= 16; i += 16)
+	{
+		__m256i va = _mm256_loadu_si256((const __m256i*)&a[i]);
+		__m256i vb = _mm256_loadu_si256((const __m256i*)&b[i]);
+		va = _mm256_or_si256(va, case_bit16_avx2(va, bias, limit));
+		vb = _mm256_or_si256(vb, case_bit16_avx2(vb, bias, limit));
+
+		const uint32_t mask = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi16(va, vb));
+		if (0xffffffff != mask) return i + lowest_bit(~mask) / 2;
+	}
+	return i + case_equal16_sse2_inline(&a[i], &b[i], len - i);
+}
+
+CPU_TARGET("avx2")
+size_t case_find8_avx2(const uint8_t* s, size_t len, uint8_t c)
+{
+	const __m256i bias = _mm256_set1_epi8((char)('A' + 0x80));
+	const __m256i limit = _mm256_set1_epi8((char)(-128 + 26));
+	const __m256i vc = _mm256_set1_epi8((char)c);
+
+	size_t i = 0;
+	for (; len - i >= 32; i += 32)
+	{
+		__m256i v = _mm256_loadu_si256((const __m256i*)&s[i]);
+		v = _mm256_or_si256(v, case_bit8_avx2(v, bias, limit));
+
+		const uint32_t mask = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, vc));
+		if (0 != mask) return i + lowest_bit(mask);
+	}
+	return i + case_find8_sse2_inline(&s[i], len - i, c);
+}
+
+CPU_TARGET("avx2")
+size_t case_find16_avx2(const uint16_t* s, size_t len, uint16_t c)
+{
+	const __m256i bias = _mm256_set1_epi16((short)('A' + 0x8000));
+	const __m256i limit = _mm256_set1_epi16((short)(-32768 + 26));
+	const __m256i vc = _mm256_set1_epi16((short)c);
+	const __m256i high = _mm256_set1_epi16((short)0xff80);
+
+	size_t i = 0;
+	for (; len - i >= 16; i += 16)
+	{
+		const __m256i v = _mm256_loadu_si256((const __m256i*)&s[i]);
+		const __m256i lower = _mm256_or_si256(v, case_bit16_avx2(v, bias, limit));
+		const __m256i ascii = _mm256_cmpeq_epi16(_mm256_and_si256(v, high), _mm256_setzero_si256());
+
+		const uint32_t mask = ~(uint32_t)_mm256_movemask_epi8(ascii) |
+							  (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi16(lower, vc));
+		if (0 != mask) return i + lowest_bit(mask) / 2;
+	}
+	return i + case_find16_sse2_inline(&s[i], len - i, c);
+}
+
+#endif//CPU_FEATURES_X86
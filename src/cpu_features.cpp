@@ -0,0 +1,100 @@
+﻿/**
+ * @file    cpu_features.cpp
+ * @brief   Runtime detection of x86 instruction set extensions.
+ *
+ * @author  Yonhgwhan, Roh (somma@somma.kr)
+ * @date    2026/10/18 created.
+ * @copyright (C)Somma, Inc. All rights reserved.
+**/
+#include "stdafx.h"
+#include "cpu_features.h"
+
+#if defined(CPU_FEATURES_X86)
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+
+static void cpuid_ex(_Out_ int regs[4], _In_ int leaf, _In_ int subleaf)
+{
+#if defined(_MSC_VER)
+	__cpuidex(regs, leaf, subleaf);
+#else
+	unsigned int a = 0, b = 0, c = 0, d = 0;
+	__cpuid_count(leaf, subleaf, a, b, c, d);
+	regs[0] = (int)a; regs[1] = (int)b; regs[2] = (int)c; regs[3] = (int)d;
+#endif
+}
+
+static uint64_t read_xcr0()
+{
+#if defined(_MSC_VER)
+	return _xgetbv(0);
+#else
+	uint32_t eax = 0, edx = 0;
+	__asm__ volatile ("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+	return ((uint64_t)edx << 32) | eax;
+#endif
+}
+
+static cpu_features detect_cpu_features()
+{
+	cpu_features f = {};
+
+	int regs[4] = { 0 };
+	cpuid_ex(regs, 0, 0);
+	int max_leaf = regs[0];
+	if (max_leaf < 1) return f;
+
+	cpuid_ex(regs, 1, 0);
+	const int ecx1 = regs[2];
+	const int edx1 = regs[3];
+
+	f.sse2 = (edx1 & (1 << 26)) != 0;
+	f.ssse3 = (ecx1 & (1 << 9)) != 0;
+	f.sse41 = (ecx1 & (1 << 19)) != 0;
+	f.sse42 = (ecx1 & (1 << 20)) != 0;
+	f.pclmulqdq = (ecx1 & (1 << 1)) != 0;
+
+	//
+	//	AVX 계열은 CPU 지원 여부 뿐만 아니라 OS 가 ymm/zmm 레지스터를
+	//	context switch 시 저장해주는지(OSXSAVE + XCR0) 도 확인해야 한다.
+	//
+	bool os_avx = false;
+	bool os_avx512 = false;
+	if (0 != (ecx1 & (1 << 27)))
+	{
+		uint64_t xcr0 = read_xcr0();
+		os_avx = (xcr0 & 0x06) == 0x06;
+		os_avx512 = os_avx && (xcr0 & 0xe0) == 0xe0;
+	}
+	f.avx = os_avx && (ecx1 & (1 << 28)) != 0;
+
+	if (max_leaf >= 7)
+	{
+		cpuid_ex(regs, 7, 0);
+		const int ebx7 = regs[1];
+		f.avx2 = f.avx && (ebx7 & (1 << 5)) != 0;
+		f.bmi2 = (ebx7 & (1 << 8)) != 0;
+		f.sha = (ebx7 & (1 << 29)) != 0;
+		f.avx512f = os_avx512 && (ebx7 & (1 << 16)) != 0;
+		f.avx512bw = f.avx512f && (ebx7 & (1 << 30)) != 0;
+	}
+
+	return f;
+}
+#else
+static cpu_features detect_cpu_features()
+{
+	cpu_features f = {};
+	return f;
+}
+#endif//CPU_FEATURES_X86
+
+/// @brief	CPU 가 지원하는 명령어셋 정보를 리턴한다.
+const cpu_features& get_cpu_features()
+{
+	static const cpu_features _features = detect_cpu_features();
+	return _features;
+}
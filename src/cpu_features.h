@@ -0,0 +1,46 @@
+﻿/**
+ * @file    cpu_features.h
+ * @brief   Runtime detection of x86 instruction set extensions.
+ *
+ * SIMD kernels (sha2, crc64, base64, ...) use this to pick an implementation
+ * at runtime instead of requiring a specific /arch build option.
+ *
+ * @author  Yonhgwhan, Roh (somma@somma.kr)
+ * @date    2026/10/18 created.
+ * @copyright (C)Somma, Inc. All rights reserved.
+**/
+#pragma once
+#include <stdint.h>
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+#define CPU_FEATURES_X86	1
+#endif
+
+//
+//	MSVC 는 /arch 옵션 없이도 모든 intrinsic 을 사용할 수 있지만, gcc/clang 은
+//	함수 단위로 target 을 지정해줘야 한다.
+//
+#if defined(_MSC_VER) && !defined(__clang__)
+#define CPU_TARGET(isa)
+#else
+#define CPU_TARGET(isa)	__attribute__((target(isa)))
+#endif
+
+typedef struct cpu_features
+{
+	bool sse2;
+	bool ssse3;
+	bool sse41;
+	bool sse42;
+	bool pclmulqdq;
+	bool avx;
+	bool avx2;
+	bool bmi2;
+	bool sha;
+	bool avx512f;
+	bool avx512bw;
+} *pcpu_features;
+
+/// @brief	CPU 가 지원하는 명령어셋 정보를 리턴한다.
+///			최초 호출시 한번만 CPUID 를 실행하고, 이후에는 캐시된 값을 리턴한다.
+const cpu_features& get_cpu_features();
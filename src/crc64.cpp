@@ -38,6 +38,15 @@
  * POSSIBILITY OF SUCH DAMAGE. */
 #include <stdafx.h>
 #include <stdint.h>
+#include <string.h>
+#include <atomic>
+#include "crc64.h"
+#include "cpu_features.h"
+
+#if defined(CPU_FEATURES_X86)
+#include <emmintrin.h>
+#include <wmmintrin.h>
+#endif
 
 static const uint64_t crc64_tab[256] = {
     UINT64_C(0x0000000000000000), UINT64_C(0x7ad870c830358979),
@@ -170,7 +179,93 @@ static const uint64_t crc64_tab[256] = {
     UINT64_C(0x536fa08fdfd90e51), UINT64_C(0x29b7d047efec8728),
 };
 
-uint64_t crc64(uint64_t crc, const unsigned char *s, uint64_t l) {
+/* Slicing-by-8/16 tables. crc64_slice_tab[0] is crc64_tab, and
+ * crc64_slice_tab[k][n] is the crc of byte n followed by k zero bytes. */
+typedef struct crc64_tables {
+    uint64_t slice[16][256];
+
+    /* x^(2^k) mod P, used by crc64_combine(). */
+    uint64_t x2n[64];
+
+    /* PCLMULQDQ folding constants. (see crc64_pclmul()) */
+    uint64_t fold128[2];
+    uint64_t fold1024[2];
+
+    crc64_tables();
+} *pcrc64_tables;
+
+/* Polynomial arithmetic below works on bit reflected values, bit 63 is the
+ * x^0 coefficient and bit 0 is x^63, the same order crc64_tab uses. */
+#define CRC64_POLY_REFLECTED UINT64_C(0x95ac9329ac4bc9b5)
+
+/* a(x) * b(x) mod P(x) */
+static uint64_t crc64_multmodp(uint64_t a, uint64_t b) {
+    uint64_t m = UINT64_C(1) << 63;
+    uint64_t p = 0;
+
+    for (;;) {
+        if (a & m) {
+            p ^= b;
+            if ((a & (m - 1)) == 0)
+                break;
+        }
+        m >>= 1;
+        b = (b & 1) ? (b >> 1) ^ CRC64_POLY_REFLECTED : b >> 1;
+    }
+    return p;
+}
+
+/* x^(n * 2^k) mod P(x) */
+static uint64_t crc64_x2nmodp(const uint64_t x2n[64], uint64_t n, unsigned k) {
+    uint64_t p = UINT64_C(1) << 63;
+
+    while (n) {
+        if (n & 1)
+            p = crc64_multmodp(x2n[k & 63], p);
+        n >>= 1;
+        k++;
+    }
+    return p;
+}
+
+crc64_tables::crc64_tables() {
+    int k, n;
+
+    for (n = 0; n < 256; n++)
+        slice[0][n] = crc64_tab[n];
+    for (k = 1; k < 16; k++) {
+        for (n = 0; n < 256; n++) {
+            uint64_t c = slice[k - 1][n];
+            slice[k][n] = crc64_tab[(uint8_t)c] ^ (c >> 8);
+        }
+    }
+
+    x2n[0] = UINT64_C(1) << 62;     /* x^1 */
+    for (k = 1; k < 64; k++)
+        x2n[k] = crc64_multmodp(x2n[k - 1], x2n[k - 1]);
+
+    /* Folding a 128 bit accumulator forward by D bits multiplies its high
+     * and low 64 bit halves by x^(D+64) and x^D. A reflected carry-less
+     * multiply yields the product times x, so the constants are one degree
+     * lower. [0] is for the low qword, [1] for the high qword. */
+    fold128[0] = crc64_x2nmodp(x2n, 128 + 64 - 1, 0);
+    fold128[1] = crc64_x2nmodp(x2n, 128 - 1, 0);
+    fold1024[0] = crc64_x2nmodp(x2n, 1024 + 64 - 1, 0);
+    fold1024[1] = crc64_x2nmodp(x2n, 1024 - 1, 0);
+}
+
+static const crc64_tables& crc64_get_tables(void) {
+    static const crc64_tables tables;
+    return tables;
+}
+
+static inline uint64_t crc64_load64(const unsigned char *s) {
+    uint64_t v;
+    memcpy(&v, s, sizeof(v));   /* little endian only */
+    return v;
+}
+
+static uint64_t crc64_byte(uint64_t crc, const unsigned char *s, uint64_t l) {
     uint64_t j;
 
     for (j = 0; j < l; j++) {
@@ -180,6 +275,178 @@ uint64_t crc64(uint64_t crc, const unsigned char *s, uint64_t l) {
     return crc;
 }
 
+static uint64_t crc64_slice8(uint64_t crc, const unsigned char *s, uint64_t l) {
+    const uint64_t (*t)[256] = crc64_get_tables().slice;
+
+    for (; l >= 8; s += 8, l -= 8) {
+        crc ^= crc64_load64(s);
+        crc = t[7][(uint8_t)crc] ^
+              t[6][(uint8_t)(crc >> 8)] ^
+              t[5][(uint8_t)(crc >> 16)] ^
+              t[4][(uint8_t)(crc >> 24)] ^
+              t[3][(uint8_t)(crc >> 32)] ^
+              t[2][(uint8_t)(crc >> 40)] ^
+              t[1][(uint8_t)(crc >> 48)] ^
+              t[0][crc >> 56];
+    }
+    return crc64_byte(crc, s, l);
+}
+
+static uint64_t crc64_slice16(uint64_t crc, const unsigned char *s, uint64_t l) {
+    const uint64_t (*t)[256] = crc64_get_tables().slice;
+
+    for (; l >= 16; s += 16, l -= 16) {
+        uint64_t lo = crc64_load64(s) ^ crc;
+        uint64_t hi = crc64_load64(s + 8);
+        crc = t[15][(uint8_t)lo] ^
+              t[14][(uint8_t)(lo >> 8)] ^
+              t[13][(uint8_t)(lo >> 16)] ^
+              t[12][(uint8_t)(lo >> 24)] ^
+              t[11][(uint8_t)(lo >> 32)] ^
+              t[10][(uint8_t)(lo >> 40)] ^
+              t[9][(uint8_t)(lo >> 48)] ^
+              t[8][lo >> 56] ^
+              t[7][(uint8_t)hi] ^
+              t[6][(uint8_t)(hi >> 8)] ^
+              t[5][(uint8_t)(hi >> 16)] ^
+              t[4][(uint8_t)(hi >> 24)] ^
+              t[3][(uint8_t)(hi >> 32)] ^
+              t[2][(uint8_t)(hi >> 40)] ^
+              t[1][(uint8_t)(hi >> 48)] ^
+              t[0][hi >> 56];
+    }
+    return crc64_slice8(crc, s, l);
+}
+
+#if defined(CPU_FEATURES_X86)
+CPU_TARGET("pclmul,sse2")
+static inline __m128i crc64_fold(__m128i acc, __m128i k, __m128i data) {
+    __m128i lo = _mm_clmulepi64_si128(acc, k, 0x00);
+    __m128i hi = _mm_clmulepi64_si128(acc, k, 0x11);
+    return _mm_xor_si128(_mm_xor_si128(lo, hi), data);
+}
+
+/* Folds the input 128 bytes at a time with eight independent accumulators,
+ * then folds the accumulators into one and reduces the remaining 16 bytes
+ * with the slicing table. */
+CPU_TARGET("pclmul,sse2")
+static uint64_t crc64_pclmul(uint64_t crc, const unsigned char *s, uint64_t l) {
+    const crc64_tables& tables = crc64_get_tables();
+    __m128i acc[8];
+    __m128i k;
+    unsigned char last[16];
+    int i;
+
+    if (l < 256)
+        return crc64_slice16(crc, s, l);
+
+    for (i = 0; i < 8; i++)
+        acc[i] = _mm_loadu_si128((const __m128i*)(s + i * 16));
+    acc[0] = _mm_xor_si128(acc[0], _mm_set_epi64x(0, (long long)crc));
+    s += 128;
+    l -= 128;
+
+    k = _mm_set_epi64x((long long)tables.fold1024[1], (long long)tables.fold1024[0]);
+    for (; l >= 128; s += 128, l -= 128) {
+        for (i = 0; i < 8; i++)
+            acc[i] = crc64_fold(acc[i], k, _mm_loadu_si128((const __m128i*)(s + i * 16)));
+    }
+
+    k = _mm_set_epi64x((long long)tables.fold128[1], (long long)tables.fold128[0]);
+    for (i = 1; i < 8; i++)
+        acc[0] = crc64_fold(acc[0], k, acc[i]);
+    for (; l >= 16; s += 16, l -= 16)
+        acc[0] = crc64_fold(acc[0], k, _mm_loadu_si128((const __m128i*)s));
+
+    _mm_storeu_si128((__m128i*)last, acc[0]);
+    crc = crc64_slice16(0, last, sizeof(last));
+    return crc64_byte(crc, s, l);
+}
+#endif
+
+typedef uint64_t (*crc64_fn)(uint64_t crc, const unsigned char *s, uint64_t l);
+
+static crc64_fn crc64_impl_fn(int impl) {
+    switch (impl) {
+    case CRC64_IMPL_BYTE:
+        return crc64_byte;
+    case CRC64_IMPL_SLICE8:
+        return crc64_slice8;
+    case CRC64_IMPL_SLICE16:
+        return crc64_slice16;
+#if defined(CPU_FEATURES_X86)
+    case CRC64_IMPL_PCLMUL:
+        return (get_cpu_features().pclmulqdq && get_cpu_features().sse2) ? crc64_pclmul : 0;
+#endif
+    }
+    return 0;
+}
+
+static int crc64_best_impl(void) {
+    if (crc64_impl_fn(CRC64_IMPL_PCLMUL)) return CRC64_IMPL_PCLMUL;
+    return CRC64_IMPL_SLICE16;
+}
+
+static std::atomic<int> crc64_impl(CRC64_IMPL_AUTO);
+static std::atomic<crc64_fn> crc64_func(0);
+
+static crc64_fn crc64_get_fn(void) {
+    crc64_fn fn = crc64_func.load(std::memory_order_relaxed);
+
+    if (!fn) {
+        crc64_impl.store(crc64_best_impl(), std::memory_order_relaxed);
+        fn = crc64_impl_fn(crc64_impl.load(std::memory_order_relaxed));
+        crc64_func.store(fn, std::memory_order_relaxed);
+    }
+    return fn;
+}
+
+bool crc64_set_impl(int impl) {
+    crc64_fn fn;
+
+    if (impl == CRC64_IMPL_AUTO)
+        impl = crc64_best_impl();
+
+    fn = crc64_impl_fn(impl);
+    if (!fn)
+        return false;
+
+    crc64_impl.store(impl, std::memory_order_relaxed);
+    crc64_func.store(fn, std::memory_order_relaxed);
+    return true;
+}
+
+int crc64_get_impl(void) {
+    crc64_get_fn();
+    return crc64_impl.load(std::memory_order_relaxed);
+}
+
+bool crc64_impl_supported(int impl) {
+    return impl == CRC64_IMPL_AUTO || crc64_impl_fn(impl) != 0;
+}
+
+const char* crc64_impl_name(int impl) {
+    switch (impl) {
+    case CRC64_IMPL_AUTO:    return "auto";
+    case CRC64_IMPL_BYTE:    return "byte";
+    case CRC64_IMPL_SLICE8:  return "slice8";
+    case CRC64_IMPL_SLICE16: return "slice16";
+    case CRC64_IMPL_PCLMUL:  return "pclmul";
+    }
+    return "unknown";
+}
+
+uint64_t crc64(uint64_t crc, const unsigned char *s, uint64_t l) {
+    return crc64_get_fn()(crc, s, l);
+}
+
+/* This crc has no pre/post conditioning, so
+ * crc(A|B) = crc(A) * x^(8 * len(B)) mod P  ^  crc(B). */
+uint64_t crc64_combine(uint64_t crc1, uint64_t crc2, uint64_t len2) {
+    const crc64_tables& tables = crc64_get_tables();
+    return crc64_multmodp(crc64_x2nmodp(tables.x2n, len2, 3), crc1) ^ crc2;
+}
+
 /* Test main */
 #ifdef REDIS_TEST
 #include <stdio.h>
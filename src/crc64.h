@@ -5,6 +5,24 @@
 
 uint64_t crc64(uint64_t crc, const unsigned char *s, uint64_t l);
 
+/* Returns the crc of A followed by B, where crc1 = crc64(0, A, len(A)) and
+ * crc2 = crc64(0, B, len2). Lets chunks of a large buffer be checksummed
+ * independently (e.g. on separate threads) and merged afterwards. */
+uint64_t crc64_combine(uint64_t crc1, uint64_t crc2, uint64_t len2);
+
+/* crc64() picks the fastest implementation the cpu supports. These select a
+ * specific one, mainly for testing and benchmarking. */
+#define CRC64_IMPL_AUTO     0
+#define CRC64_IMPL_BYTE     1
+#define CRC64_IMPL_SLICE8   2
+#define CRC64_IMPL_SLICE16  3
+#define CRC64_IMPL_PCLMUL   4
+
+bool crc64_set_impl(int impl);
+int crc64_get_impl(void);
+bool crc64_impl_supported(int impl);
+const char* crc64_impl_name(int impl);
+
 #ifdef REDIS_TEST
 int crc64Test(int argc, char *argv[]);
 #endif
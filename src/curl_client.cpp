@@ -279,6 +279,66 @@ curl_client::http_get(
 }
 
 
+/// @brief	HTTP(S) GET 요청을 하고, 응답을 CSegmentedStream 으로 받는다.
+///			요청 성공시 true 를 리턴한다. (http_get() 참고)
+bool
+curl_client::http_get(
+	_In_ const char* url,
+	_Out_ HTTP_CODE& http_response_code,
+	_Out_ CSegmentedStream& stream
+)
+{
+	_ASSERTE(nullptr != _curl);
+	_ASSERTE(nullptr != url);
+	if (nullptr == url || nullptr == _curl) return false;
+
+	//
+	//	Prepare (set common options)
+	//
+	if (!prepare_perform(url, false))
+	{
+		return false;
+	}
+
+	//
+	//	응답데이터 처리
+	//
+	stream.reset();
+	auto curl_code = curl_easy_setopt(_curl,
+									  CURLOPT_WRITEDATA,
+									  &stream);
+	if (CURLE_OK != curl_code)
+	{
+		log_err "curl_easy_setopt() failed. curl_code = %d, %s",
+			curl_code,
+			curl_easy_strerror(curl_code)
+			log_end;
+		return false;
+	}
+
+	curl_code = curl_easy_setopt(_curl,
+								 CURLOPT_WRITEFUNCTION,
+								 curl_wcb_to_segmented_stream);
+	if (CURLE_OK != curl_code)
+	{
+		log_err "curl_easy_setopt() failed. curl_code = %d, %s",
+			curl_code,
+			curl_easy_strerror(curl_code)
+			log_end;
+		return false;
+	}
+
+	//
+	//	Perform http(s) I/O
+	//
+	if (true != perform(http_response_code))
+	{
+		return false;
+	}
+
+	return true;
+}
+
 /// @brief	HTTP(S) 파일 다운로드
 bool
 curl_client::http_download_file(
@@ -334,7 +394,19 @@ curl_client::http_download_file(
 	//
 	//	Perform http(s) I/O
 	//
-	if (true != perform(http_response_code))
+	bool ret = perform(http_response_code);
+
+	//
+	//	버퍼에 남은 데이터를 기록하고 해시 계산을 마친다. 
+	//	(perform() 이 실패해도 해시 스레드를 정리하기 위해 호출한다)
+	//
+	if (true != ctx->finish())
+	{
+		log_err "ctx->finish() failed. url=%s", ctx->url() log_end;
+		ret = false;
+	}
+
+	if (true != ret)
 	{
 		//log_err "perform() failed." log_end;
 		return false;
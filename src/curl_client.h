@@ -92,6 +92,12 @@ public:
 		_Out_ HTTP_CODE& http_response_code,
 		_Out_ std::string& response);
 
+	/// @brief	응답을 청크 단위로 받는다. (큰 응답을 받을 때 재할당/복사가 없다)
+	bool http_get(
+		_In_z_ const char* url,
+		_Out_ HTTP_CODE& http_response_code,
+		_Out_ CSegmentedStream& stream);
+
 	bool http_download_file(
 		_In_ http_download_ctx* ctx,
 		_Out_ HTTP_CODE& http_response_code);
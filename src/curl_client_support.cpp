@@ -14,25 +14,43 @@
 /// @brief	Constructor
 http_download_ctx::http_download_ctx(
 	_In_ const char* url,
-	_In_ const HANDLE file_handle
+	_In_ const HANDLE file_handle,
+	_In_ uint32_t block_size,
+	_In_ uint32_t block_count
 )
 	:
 	_cancel(false),
 	_url(url),
-	_file_handle(file_handle)
+	_file_handle(file_handle),
+	_block_size(max(block_size, (uint32_t)(16 * 1024))),
+	_block_count(max(block_count, (uint32_t)2)),
+	_bytes_received(0),
+	_failed(false),
+	_finished(false),
+	_current(0),
+	_current_size(0),
+	_hash_stop(false)
 {
 	_ASSERTE(nullptr != url);
 	_ASSERTE(INVALID_HANDLE_VALUE != file_handle);
+
+	_blocks.reserve(_block_count);
+	MD5Init(&_md5, 0);
+	sha256_begin(&_sha256);
+	memset(_sha256_digest, 0x00, sizeof(_sha256_digest));
 }
 
 /// @brief	
 http_download_ctx::~http_download_ctx()
 {
+	finish();
+
 	_url = _null_stringa;
 	_file_handle = INVALID_HANDLE_VALUE;
 }
 
-/// @brief	
+/// @brief	수신한 데이터를 현재 블록에 복사하고, 블록이 가득 차면 
+///			파일에 기록하고 해시 스레드로 넘긴다.
 bool 
 http_download_ctx::update(
 	_In_ const void* const buffer, 
@@ -49,82 +67,216 @@ http_download_ctx::update(
 		return false;
 	}
 
-	if (INVALID_HANDLE_VALUE == _file_handle) return false;
+	if (INVALID_HANDLE_VALUE == _file_handle || _failed || _finished) return false;
 
 	//
-	//	Write to file
+	//	NOTE
 	//
-	DWORD bytes_written = 0;
-	if (!WriteFile((HANDLE)_file_handle,
-					buffer,
-					(DWORD)cb_buffer,
-					&bytes_written,
-					nullptr))
-	{
-		log_err "WriteFile() failed. gle=%u, file=0x%p",
-			GetLastError(), 
-			_file_handle
-			log_end;
-		return false;
-	}
-
+	//	예전에는 청크마다 WriteFile() + FlushFileBuffers() 를 호출했고, 
+	//	해시는 다운로드가 끝난 후 파일을 다시 읽어서 계산했다. 
+	//	(청크마다 flush 하는 비용 때문에 다운로드가 느렸음)
 	//
-	//	NOTE
+	//	지금은 블록 단위로 기록하고, flush 는 finish() 에서 한번만 한다. 
+	//	해시는 해시 스레드에서 기록한 블록으로 계산한다. 
 	//
-	//	원래의 구현의도는 현재 루틴에서 전달받은 버퍼를 통해 해시값을 
-	//	같이 계산하는 것이었으나, 다운로드 시간이 굉장히 길어지는 이슈가
-	//	발생해서, 여기서는 파일로 저장만하고, 해시값을 계산하는 것은 
-	//	별도의 메소드에서 구현한다. 
-	//	
+	if (_blocks.empty())
+	{
+		_blocks.push_back(std::unique_ptr<uint8_t[]>(new uint8_t[_block_size]));
+		_current = 0;
+		_current_size = 0;
+	}
 
-	FlushFileBuffers(_file_handle);
+	const uint8_t* pos = (const uint8_t*)buffer;
+	size_t remain = cb_buffer;
+	while (remain > 0)
+	{
+		const uint32_t copy = (uint32_t)min((size_t)(_block_size - _current_size), remain);
+		memcpy(&_blocks[_current][_current_size], pos, copy);
+		_current_size += copy;
+		pos += copy;
+		remain -= copy;
+
+		if (_current_size == _block_size)
+		{
+			if (!write_block(_current, _current_size) || !next_block())
+			{
+				_failed = true;
+				return false;
+			}
+		}
+	}
+
+	_bytes_received += cb_buffer;
 	return true;
 }
 
-/// @brief	다운로드한 파일의 MD5 해시 값을 구한다.
-bool http_download_ctx::get_md5(_Out_ std::string& value)
+/// @brief	남은 블록을 기록하고, 해시 스레드를 종료시킨 후 digest 를 
+///			확정한다. 파일 버퍼는 여기서 한번만 flush 한다.
+bool http_download_ctx::finish()
 {
-	if (INVALID_HANDLE_VALUE == _file_handle) return false;
+	if (_finished) return !_failed;
+	_finished = true;
 
-	if (INVALID_SET_FILE_POINTER == SetFilePointer(_file_handle,
-												   0,
-												   nullptr,
-												   FILE_BEGIN))
+	if (!_failed && 0 < _current_size)
 	{
-		log_err
-			"SetFilePointer() failed. file=0x%p, gle=%u",
-			_file_handle,
-			GetLastError()
-			log_end;
-		return false;
+		if (!write_block(_current, _current_size))
+		{
+			_failed = true;
+		}
+		_current_size = 0;
+	}
+
+	if (_hash_thread.joinable())
+	{
+		{
+			std::lock_guard<std::mutex> lock(_lock);
+			_hash_stop = true;
+		}
+		_hash_ready.notify_one();
+		_hash_thread.join();
+	}
+
+	MD5Final(&_md5);
+	sha256_end(_sha256_digest, &_sha256);
+
+	if (INVALID_HANDLE_VALUE != _file_handle && !_failed)
+	{
+		FlushFileBuffers(_file_handle);
 	}
 	
-	return get_file_hash_by_filehandle(_file_handle,
-									   &value,
-									   nullptr);
+	_blocks.clear();
+	_free_blocks.clear();
+	return !_failed;
 }
 
-/// @brief	다운로드한 파일의 SHA2 해시 값을 구한다.
-bool http_download_ctx::get_sha2(_Out_ std::string& value)
+/// @brief	블록을 파일에 기록하고 해시 큐에 넣는다. 
+///			해시 스레드는 첫번째 블록을 큐에 넣을 때 시작한다.
+bool 
+http_download_ctx::write_block(
+	_In_ uint32_t block, 
+	_In_ uint32_t size
+)
 {
-	if (INVALID_HANDLE_VALUE == _file_handle) return false;
+	uint32_t written = 0;
+	while (written < size)
+	{
+		DWORD bytes_written = 0;
+		if (!WriteFile((HANDLE)_file_handle,
+					   &_blocks[block][written],
+					   size - written,
+					   &bytes_written,
+					   nullptr))
+		{
+			log_err "WriteFile() failed. gle=%u, file=0x%p",
+				GetLastError(), 
+				_file_handle
+				log_end;
+			return false;
+		}
+
+		//
+		//	TRUE 를 리턴하면서 한 바이트도 쓰지 못했다면 
+		//	다시 시도해도 진행되지 않는다.
+		//
+		if (0 == bytes_written)
+		{
+			log_err "WriteFile() wrote nothing. file=0x%p, remain=%u",
+				_file_handle,
+				size - written
+				log_end;
+			return false;
+		}
+		written += bytes_written;
+	}
 
-	if (INVALID_SET_FILE_POINTER == SetFilePointer(_file_handle,
-												   0,
-												   nullptr,
-												   FILE_BEGIN))
+	if (!_hash_thread.joinable())
 	{
-		log_err
-			"SetFilePointer() failed. file=0x%p, gle=%u",
-			_file_handle,
-			GetLastError()
-			log_end;
-		return false;
+		_hash_thread = std::thread(&http_download_ctx::hash_worker, this);
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(_lock);
+		_hash_queue.push_back(std::make_pair(block, size));
+	}
+	_hash_ready.notify_one();
+	return true;
+}
+
+/// @brief	다음에 채울 블록을 구한다. 
+///			블록이 _block_count 개 모두 사용중이면 해시 스레드가 
+///			반환할 때까지 기다린다.
+bool http_download_ctx::next_block()
+{
+	std::unique_lock<std::mutex> lock(_lock);
+	if (_free_blocks.empty() && _blocks.size() < _block_count)
+	{
+		_blocks.push_back(std::unique_ptr<uint8_t[]>(new uint8_t[_block_size]));
+		_current = (uint32_t)_blocks.size() - 1;
+	}
+	else
+	{
+		_block_free.wait(lock, [&]() { return !_free_blocks.empty(); });
+		_current = _free_blocks.front();
+		_free_blocks.pop_front();
 	}
+	_current_size = 0;
+	return true;
+}
+
+/// @brief	해시 스레드. 큐의 블록을 순서대로 MD5/SHA-256 에 반영하고 
+///			블록을 반환한다.
+void http_download_ctx::hash_worker()
+{
+	for (;;)
+	{
+		uint8_t* data = nullptr;
+		uint32_t block = 0;
+		uint32_t size = 0;
+		{
+			std::unique_lock<std::mutex> lock(_lock);
+			_hash_ready.wait(lock, [&]() 
+			{ 
+				return _hash_stop || !_hash_queue.empty(); 
+			});
+			if (_hash_queue.empty()) break;		// _hash_stop
+
+			block = _hash_queue.front().first;
+			size = _hash_queue.front().second;
+			_hash_queue.pop_front();
+			data = _blocks[block].get();
+		}
 
-	return get_file_hash_by_filehandle(_file_handle,
-									   nullptr,
-									   &value);
+		MD5Update(&_md5, data, size);
+		sha256_hash(data, size, &_sha256);
+
+		{
+			std::lock_guard<std::mutex> lock(_lock);
+			_free_blocks.push_back(block);
+		}
+		_block_free.notify_one();
+	}
+}
+
+/// @brief	다운로드한 파일의 MD5 해시 값을 구한다.
+bool http_download_ctx::get_md5(_Out_ std::string& value)
+{
+	if (!finish()) return false;
+
+	return bin_to_hexa_fast(sizeof(_md5.digest),
+							_md5.digest,
+							false,
+							value);
+}
+
+/// @brief	다운로드한 파일의 SHA2 해시 값을 구한다.
+bool http_download_ctx::get_sha2(_Out_ std::string& value)
+{
+	if (!finish()) return false;
+
+	return bin_to_hexa_fast(sizeof(_sha256_digest),
+							_sha256_digest,
+							false,
+							value);
 }
 
 ///	@brief	libcUrl Write Callback To Stream 
@@ -159,6 +311,55 @@ curl_wcb_to_stream(
 	return (size * nmemb);
 }
 
+///	@brief	libcUrl Write Callback To segmented stream 
+///			수신한 데이터를 청크에 이어 붙인다. 응답이 커져도 이미 받은 
+///			데이터를 재할당/복사하지 않는다.
+///	@param	userdata    CURLOPT_WRITEDATA 옵션으로 설정한 CSegmentedStream 포인터
+size_t
+curl_wcb_to_segmented_stream(
+	_In_ void* ptr,
+	_In_ size_t size,
+	_In_ size_t nmemb,
+	_In_ void* userdata
+)
+{
+	_ASSERTE(NULL != ptr);
+	_ASSERTE(NULL != userdata);
+	if (NULL == ptr || NULL == userdata) return 0;
+
+	const size_t bytes = size * nmemb;
+	if (0 == bytes) return 0;
+
+	CSegmentedStream* stream = (CSegmentedStream*)userdata;
+	if (bytes != stream->WriteToStream((char*)ptr, bytes))
+	{
+		log_err "Can not write to segmented stream" log_end;
+		return 0;
+	}
+	return bytes;
+}
+
+///	@brief	libcUrl Read Callback From segmented stream 
+///			업로드할 데이터를 스트림의 현재 포지션부터 청크에서 바로 복사한다.
+///			(CURLOPT_READDATA 로 CSegmentedStream 포인터를 설정하고, 
+///			SetPos(0) 후에 전송한다)
+///	@return	복사한 byte 수, 0 이면 전송 끝
+size_t
+curl_rcb_from_segmented_stream(
+	_Out_ char* buffer,
+	_In_ size_t size,
+	_In_ size_t nitems,
+	_In_ void* userdata
+)
+{
+	_ASSERTE(NULL != buffer);
+	_ASSERTE(NULL != userdata);
+	if (NULL == buffer || NULL == userdata) return 0;
+
+	CSegmentedStream* stream = (CSegmentedStream*)userdata;
+	return stream->ReadSome(buffer, size * nitems);
+}
+
 ///	@brief	libcUrl Write Callback To file 
 size_t
 curl_wcb_to_ctx(
@@ -12,14 +12,34 @@
 #include "_MyLib/src/md5.h"
 #include "_MyLib/src/sha2.h"
 
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+
+
+#define HTTP_DOWNLOAD_DEFAULT_BLOCK_SIZE	(1024 * 1024)
+#define HTTP_DOWNLOAD_DEFAULT_BLOCK_COUNT	4
 
 /// @brief	Context that holds file-downlaod related stuff
+///
+///			curl 이 전달하는 작은 청크들을 block_size 크기의 블록에 모아서 
+///			블록 단위로 파일에 기록하고 (FlushFileBuffers() 는 finish() 에서 
+///			한번만 호출), 기록한 블록은 해시 스레드의 큐에 넣어서 MD5/SHA-256 을 
+///			다운로드와 동시에 계산한다. 
+///
+///			블록은 최대 block_count 개만 사용하므로 해시 계산이 느리면 
+///			update() 가 블록이 반환될 때까지 대기한다. (bounded queue)
+///			다운로드가 끝나면 finish() 를 호출해야 한다. 
+///			(curl_client::http_download_file() 이 호출해 준다)
 typedef class http_download_ctx
 {
 public:
 	http_download_ctx(
 		_In_ const char* url,
-		_In_ const HANDLE file_handle);
+		_In_ const HANDLE file_handle,
+		_In_ uint32_t block_size = HTTP_DOWNLOAD_DEFAULT_BLOCK_SIZE,
+		_In_ uint32_t block_count = HTTP_DOWNLOAD_DEFAULT_BLOCK_COUNT);
 
 	~http_download_ctx();
 	
@@ -27,18 +47,53 @@ public:
 		_In_ const void* const buffer, 
 		_In_ const size_t cb_buffer);
 
+	/// @brief	버퍼에 남은 데이터를 기록하고, 해시 계산을 마친 후 
+	///			파일 버퍼를 flush 한다. 여러번 호출해도 한번만 수행된다.
+	bool finish();
+
 	void cancel() { _cancel = true; }
 	bool canceled() { return (true == _cancel) ? true : false; }
 	const char* url() { return _url.c_str(); }
+	uint64_t bytes_received() const { return _bytes_received; }
 
+	/// @brief	finish() 가 호출되지 않았으면 finish() 를 먼저 호출한다.
 	bool get_md5(_Out_ std::string& value);
 	bool get_sha2(_Out_ std::string& value);
 		
+private:
+	bool write_block(_In_ uint32_t block, _In_ uint32_t size);
+	bool next_block();
+	void hash_worker();
+
 private:
 	volatile bool _cancel;
 
 	std::string _url;
 	HANDLE _file_handle;
+
+	uint32_t _block_size;
+	uint32_t _block_count;
+	uint64_t _bytes_received;
+	bool _failed;
+	bool _finished;
+	
+	/// 블록 버퍼 (필요할 때 할당, 최대 _block_count 개)
+	std::vector<std::unique_ptr<uint8_t[]>> _blocks;
+	uint32_t _current;
+	uint32_t _current_size;
+
+	/// 해시 스레드와 공유 (_lock 으로 보호)
+	std::mutex _lock;
+	std::condition_variable _hash_ready;
+	std::condition_variable _block_free;
+	std::deque<std::pair<uint32_t, uint32_t>> _hash_queue;	///< (block, size)
+	std::deque<uint32_t> _free_blocks;
+	bool _hash_stop;
+	std::thread _hash_thread;
+
+	MD5_CTX _md5;
+	sha256_ctx _sha256;
+	uint8_t _sha256_digest[32];
 	
 	friend size_t curl_wcb_to_ctx(
 		_In_ void* rcvd_buffer,
@@ -63,4 +118,20 @@ curl_wcb_to_ctx(
 	_In_ size_t rcvd_block_count,
 	_In_ void* userdata);
 
+size_t
+curl_wcb_to_segmented_stream(
+	_In_ void* ptr,
+	_In_ size_t size,
+	_In_ size_t nmemb,
+	_In_ void* userdata
+);
+
+size_t
+curl_rcb_from_segmented_stream(
+	_Out_ char* buffer,
+	_In_ size_t size,
+	_In_ size_t nitems,
+	_In_ void* userdata
+);
+
 
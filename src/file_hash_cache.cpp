@@ -0,0 +1,498 @@
+﻿/**
+ * @file    file_hash_cache.cpp
+ * @brief   Persistent file hash cache keyed by file identity and modification stamp.
+ *
+ * @author  Yonhgwhan, Roh (somma@somma.kr)
+ * @date    2026/10/18 created.
+ * @copyright (C)Somma, Inc. All rights reserved.
+**/
+#include "stdafx.h"
+#include "file_hash_cache.h"
+
+#define FILE_HASH_CACHE_MAGIC		0x31434846		// 'FHC1'
+#define FILE_HASH_CACHE_VERSION		1
+
+/// 같은 해시값을 가진 key 들이 들어갈 수 있는 연속 슬롯 수.
+/// 모두 차 있으면 홈 슬롯을 덮어쓴다.
+#define FILE_HASH_CACHE_MAX_PROBE	8
+
+static uint64_t hash_identity(_In_ const file_hash_cache_key& key)
+{
+	// splitmix64 finalizer
+	uint64_t h = key.volume_id * 0x9e3779b97f4a7c15ull ^ key.file_id;
+	h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ull;
+	h = (h ^ (h >> 27)) * 0x94d049bb133111ebull;
+	return h ^ (h >> 31);
+}
+
+static bool same_identity(_In_ const file_hash_cache_key& a, _In_ const file_hash_cache_key& b)
+{
+	return a.volume_id == b.volume_id && a.file_id == b.file_id;
+}
+
+static bool same_stamp(_In_ const file_hash_cache_key& a, _In_ const file_hash_cache_key& b)
+{
+	return a.size == b.size && a.mtime == b.mtime && a.ctime == b.ctime;
+}
+
+file_hash_cache::file_hash_cache() :
+	_file_handle(INVALID_HANDLE_VALUE),
+	_map_handle(nullptr),
+	_header(nullptr),
+	_slots(nullptr),
+	_mask(0),
+	_batch_size(0),
+	_hits(0),
+	_misses(0),
+	_invalidations(0)
+{
+}
+
+file_hash_cache::~file_hash_cache()
+{
+	close();
+}
+
+/// @brief	캐시 파일을 열거나 새로 만든다.
+bool
+file_hash_cache::open(
+	_In_ const wchar_t* cache_file_path,
+	_In_ uint32_t capacity,
+	_In_ uint32_t batch_size
+	)
+{
+	_ASSERTE(nullptr != cache_file_path);
+	_ASSERTE(!is_open());
+	if (nullptr == cache_file_path || is_open()) return false;
+
+	//
+	//	2 의 거듭제곱으로 올릴 때 넘치지 않도록 먼저 확인한다.
+	//
+	if (capacity > FILE_HASH_CACHE_MAX_CAPACITY)
+	{
+		log_err "Invalid capacity. capacity=%u, max=%u",
+			capacity,
+			FILE_HASH_CACHE_MAX_CAPACITY
+			log_end;
+		return false;
+	}
+
+	uint32_t slot_count = FILE_HASH_CACHE_MAX_PROBE;
+	while (slot_count < capacity) slot_count <<= 1;
+
+	const uint64_t map_size = sizeof(header) + (uint64_t)slot_count * sizeof(slot);
+
+	bool ret = false;
+	do
+	{
+		_file_handle = CreateFileW(cache_file_path,
+								   GENERIC_READ | GENERIC_WRITE,
+								   FILE_SHARE_READ,
+								   nullptr,
+								   OPEN_ALWAYS,
+								   FILE_ATTRIBUTE_NORMAL,
+								   nullptr);
+		if (INVALID_HANDLE_VALUE == _file_handle)
+		{
+			log_err "CreateFileW() failed. path=%ws, gle=%u",
+				cache_file_path,
+				GetLastError()
+				log_end;
+			break;
+		}
+
+		LARGE_INTEGER file_size;
+		if (!GetFileSizeEx(_file_handle, &file_size))
+		{
+			log_err "GetFileSizeEx() failed. path=%ws, gle=%u",
+				cache_file_path,
+				GetLastError()
+				log_end;
+			break;
+		}
+
+		//
+		//	크기가 다르면 기존 내용을 버리고 다시 만든다.
+		//
+		bool reset = ((uint64_t)file_size.QuadPart != map_size);
+		if (reset)
+		{
+			LARGE_INTEGER zero = { 0 };
+			if (!SetFilePointerEx(_file_handle, zero, nullptr, FILE_BEGIN) ||
+				!SetEndOfFile(_file_handle))
+			{
+				log_err "SetEndOfFile() failed. path=%ws, gle=%u",
+					cache_file_path,
+					GetLastError()
+					log_end;
+				break;
+			}
+		}
+
+		_map_handle = CreateFileMapping(_file_handle,
+										nullptr,
+										PAGE_READWRITE,
+										(DWORD)(map_size >> 32),
+										(DWORD)(map_size & 0xffffffff),
+										nullptr);
+		if (nullptr == _map_handle)
+		{
+			log_err "CreateFileMapping() failed. path=%ws, gle=%u",
+				cache_file_path,
+				GetLastError()
+				log_end;
+			break;
+		}
+
+		_header = (header*)MapViewOfFile(_map_handle,
+										 FILE_MAP_READ | FILE_MAP_WRITE,
+										 0,
+										 0,
+										 (SIZE_T)map_size);
+		if (nullptr == _header)
+		{
+			log_err "MapViewOfFile() failed. path=%ws, gle=%u",
+				cache_file_path,
+				GetLastError()
+				log_end;
+			break;
+		}
+
+		if (reset ||
+			FILE_HASH_CACHE_MAGIC != _header->magic ||
+			FILE_HASH_CACHE_VERSION != _header->version ||
+			sizeof(slot) != _header->slot_size ||
+			slot_count != _header->capacity)
+		{
+			memset(_header, 0x00, (size_t)map_size);
+			_header->magic = FILE_HASH_CACHE_MAGIC;
+			_header->version = FILE_HASH_CACHE_VERSION;
+			_header->slot_size = sizeof(slot);
+			_header->capacity = slot_count;
+		}
+
+		//
+		//	쓰는 도중 종료되어 홀수로 남아있는 슬롯은 비운다.
+		//
+		_slots = (slot*)&_header[1];
+		for (uint32_t i = 0; i < slot_count; ++i)
+		{
+			if (0 != (_slots[i].seq.load(std::memory_order_relaxed) & 1))
+			{
+				memset(&_slots[i].rec, 0x00, sizeof(record));
+				_slots[i].seq.store(0, std::memory_order_relaxed);
+				_header->entries.fetch_sub(1, std::memory_order_relaxed);
+			}
+		}
+
+		_mask = slot_count - 1;
+		_batch_size = max(batch_size, (uint32_t)1);
+		_pending.reserve(_batch_size);
+		ret = true;
+	} while (false);
+
+	if (!ret)
+	{
+		_slots = nullptr;
+		close();
+	}
+	return ret;
+}
+
+/// @brief	대기중인 insert 를 반영하고 캐시 파일을 닫는다.
+void file_hash_cache::close()
+{
+	if (nullptr != _slots)
+	{
+		flush();
+		_slots = nullptr;
+	}
+
+	if (nullptr != _header)
+	{
+		UnmapViewOfFile(_header);
+		_header = nullptr;
+	}
+
+	if (nullptr != _map_handle)
+	{
+		CloseHandle(_map_handle);
+		_map_handle = nullptr;
+	}
+
+	if (INVALID_HANDLE_VALUE != _file_handle)
+	{
+		CloseHandle(_file_handle);
+		_file_handle = INVALID_HANDLE_VALUE;
+	}
+
+	_pending.clear();
+}
+
+/// @brief	대기중인 insert 를 테이블에 반영하고, 디스크에 기록한다.
+bool file_hash_cache::flush()
+{
+	if (!is_open()) return false;
+
+	{
+		std::lock_guard<std::mutex> lock(_write_lock);
+		apply_pending();
+	}
+
+	if (!FlushViewOfFile(_header, 0))
+	{
+		log_err "FlushViewOfFile() failed. gle=%u", GetLastError() log_end;
+		return false;
+	}
+	return true;
+}
+
+/// @brief	seqlock 으로 슬롯을 읽는다.
+///			쓰는 중이거나 읽는 동안 바뀌었으면 false 를 리턴한다.
+bool file_hash_cache::read_slot(_In_ const slot& s, _Out_ record& rec, _Out_ uint64_t& seq)
+{
+	seq = s.seq.load(std::memory_order_acquire);
+	if (0 != (seq & 1)) return false;
+
+	memcpy(&rec, &s.rec, sizeof(rec));
+
+	std::atomic_thread_fence(std::memory_order_acquire);
+	return seq == s.seq.load(std::memory_order_relaxed);
+}
+
+/// @brief	key 에 해당하는 항목을 찾는다.
+bool
+file_hash_cache::lookup(
+	_In_ const file_hash_cache_key& key,
+	_In_ uint32_t digests,
+	_Out_ file_digests& result
+	)
+{
+	result = file_digests();
+	if (!is_open())
+	{
+		_misses.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+
+	const uint64_t home = hash_identity(key);
+	for (uint32_t probe = 0; probe < FILE_HASH_CACHE_MAX_PROBE; ++probe)
+	{
+		const slot& s = _slots[(home + probe) & _mask];
+
+		record rec;
+		uint64_t seq = 0;
+		bool consistent = false;
+		for (int retry = 0; retry < 4 && !consistent; ++retry)
+		{
+			consistent = read_slot(s, rec, seq);
+		}
+		if (!consistent) continue;		// 쓰는 중인 슬롯은 건너뛴다.
+
+		if (0 == seq) break;			// 빈 슬롯
+		if (!same_identity(rec.key, key)) continue;
+
+		if (!same_stamp(rec.key, key))
+		{
+			_invalidations.fetch_add(1, std::memory_order_relaxed);
+			break;
+		}
+
+		if (digests != (rec.digests & digests)) break;
+
+		result.digests = rec.digests;
+		result.file_size = rec.key.size;
+		result.crc64 = rec.crc64;
+		memcpy(result.md5, rec.md5, sizeof(result.md5));
+		memcpy(result.sha256, rec.sha256, sizeof(result.sha256));
+		_hits.fetch_add(1, std::memory_order_relaxed);
+		return true;
+	}
+
+	_misses.fetch_add(1, std::memory_order_relaxed);
+	return false;
+}
+
+/// @brief	항목을 추가한다.
+void
+file_hash_cache::insert(
+	_In_ const file_hash_cache_key& key,
+	_In_ const file_digests& digests
+	)
+{
+	if (!is_open() || 0 == digests.digests) return;
+
+	record rec;
+	memset(&rec, 0x00, sizeof(rec));
+	rec.key = key;
+	rec.digests = digests.digests;
+	rec.crc64 = digests.crc64;
+	memcpy(rec.md5, digests.md5, sizeof(rec.md5));
+	memcpy(rec.sha256, digests.sha256, sizeof(rec.sha256));
+
+	std::lock_guard<std::mutex> lock(_write_lock);
+	_pending.push_back(rec);
+	if (_pending.size() >= _batch_size)
+	{
+		apply_pending();
+	}
+}
+
+/// @brief	파일을 해싱하고 캐시에 추가한다.
+bool
+file_hash_cache::hash_file(
+	_In_ HANDLE file_handle,
+	_In_ const file_hash_cache_key& key,
+	_In_ uint32_t digests,
+	_Out_ file_digests& result
+	)
+{
+	bool ret = false;
+	std::unique_lock<std::mutex> lock(_engine_lock, std::try_to_lock);
+	if (lock.owns_lock())
+	{
+		ret = _engine.hash_file(file_handle, digests, result);
+	}
+	else
+	{
+		file_hash_engine* engine = file_hash_engine_acquire();
+		ret = engine->hash_file(file_handle, digests, result);
+		file_hash_engine_release(engine);
+	}
+	if (true != ret) return false;
+
+	insert(key, result);
+	return true;
+}
+
+/// @brief	_pending 을 테이블에 반영한다. (_write_lock 을 잡은 상태에서 호출)
+void file_hash_cache::apply_pending()
+{
+	for (const auto& rec : _pending)
+	{
+		const uint64_t home = hash_identity(rec.key);
+
+		//
+		//	같은 파일의 슬롯 > 첫번째 빈 슬롯 > 홈 슬롯 순서로 선택
+		//
+		slot* target = nullptr;
+		slot* empty = nullptr;
+		for (uint32_t probe = 0; probe < FILE_HASH_CACHE_MAX_PROBE; ++probe)
+		{
+			slot* s = &_slots[(home + probe) & _mask];
+			if (0 == s->seq.load(std::memory_order_relaxed))
+			{
+				if (nullptr == empty) empty = s;
+				continue;
+			}
+			if (same_identity(s->rec.key, rec.key))
+			{
+				target = s;
+				break;
+			}
+		}
+
+		if (nullptr == target) target = empty;
+		if (nullptr == target) target = &_slots[home & _mask];
+
+		uint64_t seq = target->seq.load(std::memory_order_relaxed);
+		if (0 == seq)
+		{
+			_header->entries.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		target->seq.store(seq + 1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		memcpy(&target->rec, &rec, sizeof(rec));
+		target->seq.store(seq + 2, std::memory_order_release);
+	}
+	_pending.clear();
+}
+
+file_hash_cache_stats file_hash_cache::stats()
+{
+	file_hash_cache_stats st;
+	st.hits = _hits.load(std::memory_order_relaxed);
+	st.misses = _misses.load(std::memory_order_relaxed);
+	st.invalidations = _invalidations.load(std::memory_order_relaxed);
+	st.entries = (nullptr != _header) ? _header->entries.load(std::memory_order_relaxed) : 0;
+
+	std::lock_guard<std::mutex> lock(_write_lock);
+	st.pending = _pending.size();
+	return st;
+}
+
+void file_hash_cache::reset_stats()
+{
+	_hits.store(0, std::memory_order_relaxed);
+	_misses.store(0, std::memory_order_relaxed);
+	_invalidations.store(0, std::memory_order_relaxed);
+}
+
+/// @brief	파일 데이터를 읽지 않고 key 를 구한다.
+bool
+file_hash_cache::get_key(
+	_In_ const wchar_t* file_path,
+	_Out_ file_hash_cache_key& key
+	)
+{
+	_ASSERTE(nullptr != file_path);
+	if (nullptr == file_path) return false;
+
+	HANDLE file_handle = CreateFileW(file_path,
+									 FILE_READ_ATTRIBUTES,
+									 FILE_SHARE_DELETE | FILE_SHARE_READ | FILE_SHARE_WRITE,
+									 nullptr,
+									 OPEN_EXISTING,
+									 FILE_FLAG_BACKUP_SEMANTICS,
+									 nullptr);
+	if (INVALID_HANDLE_VALUE == file_handle)
+	{
+		log_err "CreateFileW() failed. path=%ws, gle=%u",
+			file_path,
+			GetLastError()
+			log_end;
+		return false;
+	}
+
+	bool ret = get_key(file_handle, key);
+	CloseHandle(file_handle);
+	return ret;
+}
+
+/// @brief	열린 파일의 key 를 구한다.
+bool
+file_hash_cache::get_key(
+	_In_ HANDLE file_handle,
+	_Out_ file_hash_cache_key& key
+	)
+{
+	key = file_hash_cache_key();
+
+	BY_HANDLE_FILE_INFORMATION fi;
+	if (!GetFileInformationByHandle(file_handle, &fi))
+	{
+		log_err "GetFileInformationByHandle() failed. file handle=0x%p, gle=%u",
+			file_handle,
+			GetLastError()
+			log_end;
+		return false;
+	}
+
+	FILE_BASIC_INFO bi;
+	if (!GetFileInformationByHandleEx(file_handle, FileBasicInfo, &bi, sizeof(bi)))
+	{
+		log_err "GetFileInformationByHandleEx() failed. file handle=0x%p, gle=%u",
+			file_handle,
+			GetLastError()
+			log_end;
+		return false;
+	}
+
+	key.volume_id = fi.dwVolumeSerialNumber;
+	key.file_id = ((uint64_t)fi.nFileIndexHigh << 32) | fi.nFileIndexLow;
+	key.size = ((uint64_t)fi.nFileSizeHigh << 32) | fi.nFileSizeLow;
+	key.mtime = (uint64_t)bi.LastWriteTime.QuadPart;
+	key.ctime = (uint64_t)bi.ChangeTime.QuadPart;
+	return true;
+}
@@ -0,0 +1,141 @@
+﻿/**
+ * @file    file_hash_cache.h
+ * @brief   Persistent file hash cache keyed by file identity and modification stamp.
+ *
+ * (볼륨 id, 파일 id, 크기, 수정시각, 변경시각) 을 key 로 MD5/SHA-256/CRC64 를
+ * 메모리 매핑된 파일에 저장해둔다. 파일 내용이 바뀌지 않았다면 파일을 읽지
+ * 않고 메타데이터만으로 해시를 구할 수 있다.
+ *
+ *	- lookup() 은 락 없이 동작한다. (슬롯마다 seqlock)
+ *	- insert() 는 내부 큐에 모아두었다가 batch_size 마다 (또는 flush() 시)
+ *	  한꺼번에 테이블에 반영한다.
+ *	- 한 프로세스에서만 사용해야 한다. (프로세스간 동기화는 하지 않음)
+ *
+ * @author  Yonhgwhan, Roh (somma@somma.kr)
+ * @date    2026/10/18 created.
+ * @copyright (C)Somma, Inc. All rights reserved.
+**/
+#pragma once
+#include <stdint.h>
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include "file_hash_engine.h"
+
+/// open() 에 지정할 수 있는 최대 슬롯 수 (슬롯 하나가 100 바이트 남짓)
+#define FILE_HASH_CACHE_MAX_CAPACITY	(16 * 1024 * 1024)
+
+typedef struct file_hash_cache_key
+{
+	file_hash_cache_key() : volume_id(0), file_id(0), size(0), mtime(0), ctime(0) {}
+
+	uint64_t volume_id;		///< 볼륨 시리얼 번호
+	uint64_t file_id;		///< 파일 인덱스 (NTFS file reference number)
+	uint64_t size;
+	uint64_t mtime;			///< LastWriteTime
+	uint64_t ctime;			///< ChangeTime
+} *pfile_hash_cache_key;
+
+typedef struct file_hash_cache_stats
+{
+	uint64_t hits;
+	uint64_t misses;
+	uint64_t invalidations;	///< 파일은 찾았지만 크기/시각이 바뀌어서 버려진 항목 (misses 에 포함)
+	uint64_t entries;		///< 테이블에 저장된 항목 수
+	uint64_t pending;		///< 아직 테이블에 반영되지 않은 insert 수
+} *pfile_hash_cache_stats;
+
+typedef class file_hash_cache
+{
+public:
+	file_hash_cache();
+	~file_hash_cache();
+
+	/// @brief	캐시 파일을 열거나 새로 만든다.
+	///			파일이 없거나, 헤더가 맞지 않거나, capacity 가 다르면 비운 상태로 다시 만든다.
+	/// @param	capacity	슬롯 수 (2 의 거듭제곱으로 올림, 최대 FILE_HASH_CACHE_MAX_CAPACITY)
+	/// @param	batch_size	insert 를 몇개씩 모아서 반영할지
+	bool open(_In_ const wchar_t* cache_file_path,
+			  _In_ uint32_t capacity = 64 * 1024,
+			  _In_ uint32_t batch_size = 64);
+	void close();
+	bool is_open() const { return nullptr != _slots; }
+
+	/// @brief	대기중인 insert 를 테이블에 반영하고, 디스크에 기록한다.
+	bool flush();
+
+	/// @brief	key 에 해당하는 항목이 digests 를 모두 가지고 있으면 result 를 채우고
+	///			true 를 리턴한다.
+	bool lookup(_In_ const file_hash_cache_key& key,
+				_In_ uint32_t digests,
+				_Out_ file_digests& result);
+
+	/// @brief	항목을 추가한다. (같은 파일의 이전 항목은 덮어쓴다)
+	void insert(_In_ const file_hash_cache_key& key,
+				_In_ const file_digests& digests);
+
+	/// @brief	캐시에 없는 파일을 해싱하고 insert 한다. 
+	///			캐시가 가진 엔진 (윈도우 버퍼) 을 재사용하고, 다른 스레드가 
+	///			엔진을 사용중이면 엔진 풀 (file_hash_engine_acquire()) 의 엔진으로 해싱한다.
+	bool hash_file(_In_ HANDLE file_handle,
+				   _In_ const file_hash_cache_key& key,
+				   _In_ uint32_t digests,
+				   _Out_ file_digests& result);
+
+	file_hash_cache_stats stats();
+	void reset_stats();
+
+	/// @brief	파일 데이터를 읽지 않고 (FILE_READ_ATTRIBUTES 로만 열어서) key 를 구한다.
+	static bool get_key(_In_ const wchar_t* file_path, _Out_ file_hash_cache_key& key);
+	static bool get_key(_In_ HANDLE file_handle, _Out_ file_hash_cache_key& key);
+
+private:
+	struct record
+	{
+		file_hash_cache_key key;
+		uint32_t digests;
+		uint32_t reserved;
+		uint64_t crc64;
+		uint8_t md5[16];
+		uint8_t sha256[32];
+	};
+
+	/// seq 가 0 이면 빈 슬롯, 홀수이면 쓰는 중
+	struct slot
+	{
+		std::atomic<uint64_t> seq;
+		record rec;
+	};
+
+	struct header
+	{
+		uint32_t magic;
+		uint32_t version;
+		uint32_t slot_size;
+		uint32_t capacity;
+		std::atomic<uint64_t> entries;
+	};
+
+	bool read_slot(_In_ const slot& s, _Out_ record& rec, _Out_ uint64_t& seq);
+	void apply_pending();
+
+private:
+	HANDLE _file_handle;
+	HANDLE _map_handle;
+	header* _header;
+	slot* _slots;
+	uint32_t _mask;
+	uint32_t _batch_size;
+
+	std::mutex _write_lock;
+	std::vector<record> _pending;
+
+	std::atomic<uint64_t> _hits;
+	std::atomic<uint64_t> _misses;
+	std::atomic<uint64_t> _invalidations;
+
+	/// 캐시 miss 를 해싱할 때 재사용하는 엔진
+	std::mutex _engine_lock;
+	file_hash_engine _engine;
+
+} *pfile_hash_cache;
@@ -0,0 +1,528 @@
+﻿/**
+ * @file    file_hash_engine.cpp
+ * @brief   Pipelined single-pass file hashing (MD5 / SHA-256 / CRC64).
+ *
+ * @author  Yonhgwhan, Roh (somma@somma.kr)
+ * @date    2026/10/18 created.
+ * @copyright (C)Somma, Inc. All rights reserved.
+**/
+#include "stdafx.h"
+#include "file_hash_engine.h"
+#include "md5.h"
+#include "sha2.h"
+#include "crc64.h"
+#include "FileIoHelperClass.h"
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+/// @brief	digest 하나의 해시 컨텍스트
+typedef class digest_ctx
+{
+public:
+	digest_ctx(_In_ uint32_t digest) : _digest(digest), _crc64(0)
+	{
+		switch (_digest)
+		{
+		case FILE_HASH_MD5: MD5Init(&_md5, 0); break;
+		case FILE_HASH_SHA256: sha256_begin(&_sha256); break;
+		}
+	}
+
+	void update(_In_reads_bytes_(size) const uint8_t* data, _In_ uint32_t size)
+	{
+		switch (_digest)
+		{
+		case FILE_HASH_MD5: MD5Update(&_md5, (unsigned char*)data, size); break;
+		case FILE_HASH_SHA256: sha256_hash(data, size, &_sha256); break;
+		case FILE_HASH_CRC64: _crc64 = crc64(_crc64, data, size); break;
+		}
+	}
+
+	void finish(_Inout_ file_digests& result)
+	{
+		switch (_digest)
+		{
+		case FILE_HASH_MD5:
+			MD5Final(&_md5);
+			memcpy(result.md5, _md5.digest, sizeof(result.md5));
+			break;
+		case FILE_HASH_SHA256:
+			sha256_end(result.sha256, &_sha256);
+			break;
+		case FILE_HASH_CRC64:
+			result.crc64 = _crc64;
+			break;
+		}
+		result.digests |= _digest;
+	}
+
+private:
+	uint32_t _digest;
+	MD5_CTX _md5;
+	sha256_ctx _sha256;
+	uint64_t _crc64;
+} *pdigest_ctx;
+
+static const uint32_t _digest_list[] = {
+	FILE_HASH_MD5,
+	FILE_HASH_SHA256,
+	FILE_HASH_CRC64
+};
+
+/// @brief	읽기 스테이지와 digest 워커들이 공유하는 링 버퍼 상태
+///
+///			윈도우 seq 는 슬롯 (seq % window_count) 에 저장된다.
+///			pending[slot] 은 해당 슬롯을 아직 소비하지 않은 워커 수이고,
+///			0 이 되어야 읽기 스테이지가 슬롯을 다시 채울 수 있다.
+typedef struct hash_pipeline
+{
+	hash_pipeline(_In_ uint32_t window_count)
+		: produced(0), sizes(window_count, 0), pending(window_count, 0), abort(false)
+	{}
+
+	std::mutex lock;
+	std::condition_variable window_ready;
+	std::condition_variable slot_free;
+	uint64_t produced;
+	std::vector<uint32_t> sizes;
+	std::vector<uint32_t> pending;
+	bool abort;
+} *phash_pipeline;
+
+
+file_hash_engine::file_hash_engine(
+	_In_ uint32_t window_size,
+	_In_ uint32_t window_count
+	) :
+	_window_size(max(window_size, (uint32_t)(64 * 1024))),
+	_window_count(max(window_count, (uint32_t)2)),
+	_read_error(ERROR_SUCCESS),
+	_serial_window_size(0)
+{
+}
+
+file_hash_engine::~file_hash_engine()
+{
+}
+
+/// @brief	파일의 digest 를 계산한다.
+bool
+file_hash_engine::hash_file(
+	_In_ const wchar_t* file_path,
+	_In_ uint32_t digests,
+	_Out_ file_digests& result
+	)
+{
+	_ASSERTE(nullptr != file_path);
+	if (nullptr == file_path) return false;
+
+	handle_ptr file_handle(
+		CreateFileW(file_path,
+					GENERIC_READ,
+					FILE_SHARE_DELETE | FILE_SHARE_READ | FILE_SHARE_WRITE,
+					NULL,
+					OPEN_EXISTING,
+					FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+					NULL),
+		[](HANDLE h)
+	{
+		if (INVALID_HANDLE_VALUE != h)
+		{
+			CloseHandle(h);
+		}
+	});
+
+	if (INVALID_HANDLE_VALUE == file_handle.get())
+	{
+		log_err
+			"CreateFileW() failed. path=%ws, gle = %u",
+			file_path,
+			GetLastError()
+			log_end;
+		return false;
+	}
+
+	return hash_file(file_handle.get(), digests, result);
+}
+
+/// @brief	파일의 digest 를 계산한다.
+bool
+file_hash_engine::hash_file(
+	_In_ HANDLE file_handle,
+	_In_ uint32_t digests,
+	_Out_ file_digests& result
+	)
+{
+	result = file_digests();
+
+	_ASSERTE(nullptr != file_handle && INVALID_HANDLE_VALUE != file_handle);
+	_ASSERTE(0 != (digests & FILE_HASH_ALL));
+	if (nullptr == file_handle ||
+		INVALID_HANDLE_VALUE == file_handle ||
+		0 == (digests & FILE_HASH_ALL))
+	{
+		return false;
+	}
+
+	LARGE_INTEGER file_size;
+	if (!GetFileSizeEx(file_handle, &file_size))
+	{
+		log_err "GetFileSizeEx() failed. file handle=0x%p, gle=%u",
+			file_handle,
+			GetLastError()
+			log_end;
+		return false;
+	}
+
+	//
+	//	윈도우 하나에 들어가는 파일은 스레드를 만드는 비용이 더 크므로
+	//	호출 스레드에서 바로 처리한다.
+	//
+	bool ret = false;
+	_read_error = ERROR_SUCCESS;
+	if ((uint64_t)file_size.QuadPart <= _window_size)
+	{
+		ret = hash_serial(file_handle, (uint64_t)file_size.QuadPart, digests, result);
+	}
+	else
+	{
+		ret = hash_pipelined(file_handle, (uint64_t)file_size.QuadPart, digests, result);
+	}
+
+	//
+	//	FILE_FLAG_NO_BUFFERING 핸들은 섹터 단위로 정렬되지 않은 크기/버퍼의 
+	//	ReadFile() 을 ERROR_INVALID_PARAMETER 로 거부한다. 
+	//	이런 핸들은 예전처럼 MMIO 로 읽는다.
+	//
+	if (!ret && ERROR_INVALID_PARAMETER == _read_error)
+	{
+		log_dbg "ReadFile() rejected unaligned read, falling back to MMIO. file handle=0x%p",
+			file_handle
+			log_end;
+		result = file_digests();
+		ret = hash_mapped(file_handle, digests, result);
+	}
+	return ret;
+}
+
+/// @brief	offset 위치에서 size 만큼 읽는다.
+///			파일 포인터가 아니라 OVERLAPPED 의 오프셋을 사용한다.
+bool
+file_hash_engine::read_window(
+	_In_ HANDLE file_handle,
+	_In_ uint64_t offset,
+	_In_ uint32_t size,
+	_Out_writes_bytes_(size) uint8_t* buffer
+	)
+{
+	uint32_t done = 0;
+	while (done < size)
+	{
+		OVERLAPPED ov = { 0 };
+		ov.Offset = (DWORD)((offset + done) & 0xffffffff);
+		ov.OffsetHigh = (DWORD)((offset + done) >> 32);
+
+		DWORD bytes_read = 0;
+		if (!ReadFile(file_handle, &buffer[done], size - done, &bytes_read, &ov))
+		{
+			DWORD gle = GetLastError();
+
+			//
+			//	FILE_FLAG_OVERLAPPED 로 연 핸들이면 완료될 때까지 기다린다.
+			//
+			if (ERROR_IO_PENDING == gle)
+			{
+				gle = GetOverlappedResult(file_handle, &ov, &bytes_read, TRUE) ? 
+					ERROR_SUCCESS : 
+					GetLastError();
+			}
+
+			if (ERROR_HANDLE_EOF == gle)
+			{
+				bytes_read = 0;
+			}
+			else if (ERROR_SUCCESS != gle)
+			{
+				_read_error = gle;
+				if (ERROR_INVALID_PARAMETER != gle)
+				{
+					log_err "ReadFile() failed. file handle=0x%p, offset=%llu, gle=%u",
+						file_handle,
+						offset + done,
+						gle
+						log_end;
+				}
+				return false;
+			}
+		}
+
+		if (0 == bytes_read)
+		{
+			log_err "unexpected end of file. file handle=0x%p, offset=%llu",
+				file_handle,
+				offset + done
+				log_end;
+			return false;
+		}
+		done += bytes_read;
+	}
+	return true;
+}
+
+/// @brief	호출 스레드에서 윈도우 단위로 읽고 해싱한다.
+bool
+file_hash_engine::hash_serial(
+	_In_ HANDLE file_handle,
+	_In_ uint64_t file_size,
+	_In_ uint32_t digests,
+	_Out_ file_digests& result
+	)
+{
+	//
+	//	버퍼는 파일 크기 (64KB 단위로 올림, 최대 윈도우 크기) 만큼만 할당한다.
+	//
+	const uint64_t granularity = 64 * 1024;
+	const uint32_t window_size = (uint32_t)min((uint64_t)_window_size,
+											   max(granularity, (file_size + granularity - 1) & ~(granularity - 1)));
+	if (_serial_window_size < window_size)
+	{
+		_serial_window.reset(new uint8_t[window_size]);
+		_serial_window_size = window_size;
+	}
+	uint8_t* window = _serial_window.get();
+
+	std::vector<digest_ctx> ctxs;
+	for (uint32_t digest : _digest_list)
+	{
+		if (digest & digests) ctxs.push_back(digest_ctx(digest));
+	}
+
+	for (uint64_t pos = 0; pos < file_size;)
+	{
+		uint32_t size = (uint32_t)min((uint64_t)window_size, file_size - pos);
+		if (!read_window(file_handle, pos, size, window)) return false;
+
+		for (auto& ctx : ctxs)
+		{
+			ctx.update(window, size);
+		}
+		pos += size;
+	}
+
+	for (auto& ctx : ctxs)
+	{
+		ctx.finish(result);
+	}
+	result.file_size = file_size;
+	return true;
+}
+
+/// @brief	호출 스레드가 읽기 스테이지가 되어 윈도우를 미리 읽어두고,
+///			digest 마다 워커 스레드 하나가 윈도우를 순서대로 소비한다.
+bool
+file_hash_engine::hash_pipelined(
+	_In_ HANDLE file_handle,
+	_In_ uint64_t file_size,
+	_In_ uint32_t digests,
+	_Out_ file_digests& result
+	)
+{
+	//
+	//	윈도우 수보다 적은 윈도우로 끝나는 파일은 그만큼만 사용한다.
+	//
+	const uint64_t window_total = (file_size + _window_size - 1) / _window_size;
+	const uint32_t window_count = (uint32_t)min((uint64_t)_window_count, window_total);
+	while (_windows.size() < window_count)
+	{
+		_windows.push_back(std::unique_ptr<uint8_t[]>(new uint8_t[_window_size]));
+	}
+
+	hash_pipeline pipeline(window_count);
+
+	std::vector<digest_ctx> ctxs;
+	for (uint32_t digest : _digest_list)
+	{
+		if (digest & digests) ctxs.push_back(digest_ctx(digest));
+	}
+	const uint32_t worker_count = (uint32_t)ctxs.size();
+
+	std::vector<std::thread> workers;
+	for (auto& ctx : ctxs)
+	{
+		pdigest_ctx pctx = &ctx;
+		workers.push_back(std::thread([this, pctx, &pipeline, window_total, window_count]()
+		{
+			for (uint64_t seq = 0; seq < window_total; ++seq)
+			{
+				const uint32_t slot = (uint32_t)(seq % window_count);
+				uint32_t size = 0;
+				{
+					std::unique_lock<std::mutex> lock(pipeline.lock);
+					pipeline.window_ready.wait(lock, [&]()
+					{
+						return pipeline.abort || pipeline.produced > seq;
+					});
+					if (pipeline.abort) return;
+					size = pipeline.sizes[slot];
+				}
+
+				pctx->update(_windows[slot].get(), size);
+
+				{
+					std::lock_guard<std::mutex> lock(pipeline.lock);
+					if (0 == --pipeline.pending[slot])
+					{
+						pipeline.slot_free.notify_one();
+					}
+				}
+			}
+		}));
+	}
+
+	bool ret = true;
+	uint64_t pos = 0;
+	for (uint64_t seq = 0; seq < window_total; ++seq)
+	{
+		const uint32_t slot = (uint32_t)(seq % window_count);
+		{
+			std::unique_lock<std::mutex> lock(pipeline.lock);
+			pipeline.slot_free.wait(lock, [&]()
+			{
+				return 0 == pipeline.pending[slot];
+			});
+		}
+
+		uint32_t size = (uint32_t)min((uint64_t)_window_size, file_size - pos);
+		if (!read_window(file_handle, pos, size, _windows[slot].get()))
+		{
+			ret = false;
+			break;
+		}
+		pos += size;
+
+		{
+			std::lock_guard<std::mutex> lock(pipeline.lock);
+			pipeline.sizes[slot] = size;
+			pipeline.pending[slot] = worker_count;
+			pipeline.produced = seq + 1;
+		}
+		pipeline.window_ready.notify_all();
+	}
+
+	if (!ret)
+	{
+		std::lock_guard<std::mutex> lock(pipeline.lock);
+		pipeline.abort = true;
+		pipeline.window_ready.notify_all();
+	}
+
+	for (auto& worker : workers)
+	{
+		worker.join();
+	}
+	if (!ret) return false;
+
+	for (auto& ctx : ctxs)
+	{
+		ctx.finish(result);
+	}
+	result.file_size = file_size;
+	return true;
+}
+
+/// @brief	파일을 윈도우 단위로 매핑해서 호출 스레드에서 해싱한다. 
+///			(ReadFile() 을 사용할 수 없는 핸들용)
+bool
+file_hash_engine::hash_mapped(
+	_In_ HANDLE file_handle,
+	_In_ uint32_t digests,
+	_Out_ file_digests& result
+	)
+{
+	FileIoHelper fio;
+	if (true != fio.OpenForRead(file_handle))
+	{
+		log_err "fio.OpenForRead() failed. file handle=0x%p",
+			file_handle
+			log_end;
+		return false;
+	}
+
+	std::vector<digest_ctx> ctxs;
+	for (uint32_t digest : _digest_list)
+	{
+		if (digest & digests) ctxs.push_back(digest_ctx(digest));
+	}
+
+	const uint64_t file_size = fio.FileSize();
+	for (uint64_t pos = 0; pos < file_size;)
+	{
+		uint32_t size = (uint32_t)min((uint64_t)fio.GetOptimizedBlockSize(), file_size - pos);
+		uint8_t* ptr = fio.GetFilePointer(true, pos, size);
+		if (nullptr == ptr)
+		{
+			log_err "fio.GetFilePointer() failed. file handle=0x%p, offset=%llu",
+				file_handle,
+				pos
+				log_end;
+			return false;
+		}
+
+		for (auto& ctx : ctxs)
+		{
+			ctx.update(ptr, size);
+		}
+		fio.ReleaseFilePointer();
+		pos += size;
+	}
+
+	for (auto& ctx : ctxs)
+	{
+		ctx.finish(result);
+	}
+	result.file_size = file_size;
+	return true;
+}
+
+//
+//	엔진 풀
+//
+static std::mutex _engine_pool_lock;
+static std::vector<std::unique_ptr<file_hash_engine>> _engine_pool;
+
+file_hash_engine* file_hash_engine_acquire()
+{
+	{
+		std::lock_guard<std::mutex> lock(_engine_pool_lock);
+		if (!_engine_pool.empty())
+		{
+			file_hash_engine* engine = _engine_pool.back().release();
+			_engine_pool.pop_back();
+			return engine;
+		}
+	}
+	return new file_hash_engine();
+}
+
+void file_hash_engine_release(_In_opt_ file_hash_engine* engine)
+{
+	if (nullptr == engine) return;
+
+	std::unique_ptr<file_hash_engine> ptr(engine);
+	std::lock_guard<std::mutex> lock(_engine_pool_lock);
+	if (_engine_pool.size() < FILE_HASH_ENGINE_POOL_SIZE)
+	{
+		_engine_pool.push_back(std::move(ptr));
+	}
+}
+
+void file_hash_engine_trim()
+{
+	std::vector<std::unique_ptr<file_hash_engine>> engines;
+	{
+		std::lock_guard<std::mutex> lock(_engine_pool_lock);
+		engines.swap(_engine_pool);
+	}
+}
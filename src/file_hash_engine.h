@@ -0,0 +1,125 @@
+﻿/**
+ * @file    file_hash_engine.h
+ * @brief   Pipelined single-pass file hashing (MD5 / SHA-256 / CRC64).
+ *
+ * 읽기 스테이지(호출 스레드)가 다음 윈도우를 미리 읽어두는 동안 digest 별
+ * 워커 스레드가 현재 윈도우를 해싱한다. 큰 파일의 처리 시간이
+ * (I/O 시간 + 각 digest 시간의 합) 이 아니라 max(I/O 시간, 가장 느린 digest)
+ * 에 가까워진다.
+ *
+ * @author  Yonhgwhan, Roh (somma@somma.kr)
+ * @date    2026/10/18 created.
+ * @copyright (C)Somma, Inc. All rights reserved.
+**/
+#pragma once
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+#include <memory>
+
+#define FILE_HASH_MD5		0x00000001
+#define FILE_HASH_SHA256	0x00000002
+#define FILE_HASH_CRC64		0x00000004
+#define FILE_HASH_ALL		(FILE_HASH_MD5 | FILE_HASH_SHA256 | FILE_HASH_CRC64)
+
+/// file_hash_engine_release() 가 보관하는 쉬고 있는 엔진의 최대 갯수
+#define FILE_HASH_ENGINE_POOL_SIZE	2
+
+typedef struct file_digests
+{
+	file_digests() : digests(0), file_size(0), crc64(0)
+	{
+		memset(md5, 0x00, sizeof(md5));
+		memset(sha256, 0x00, sizeof(sha256));
+	}
+
+	uint32_t digests;		///< 계산된 digest (FILE_HASH_XXX 조합)
+	uint64_t file_size;		///< 해싱한 바이트 수
+	uint8_t md5[16];
+	uint8_t sha256[32];
+	uint64_t crc64;			///< crc64(0, file, file_size)
+} *pfile_digests;
+
+/// @brief	파이프라인 파일 해시 엔진
+///
+///			윈도우 버퍼는 엔진 인스턴스가 소유하고 재사용하므로 여러 파일을
+///			해싱할 때는 인스턴스 하나를 재사용하는 것이 좋다. 
+///			(file_hash_engine_acquire() 참고)
+///			hash_file() 은 인스턴스 하나에 대해 동시에 호출하면 안된다.
+///
+///			윈도우 하나에 들어가는 파일은 호출 스레드에서 바로 해싱하고, 
+///			버퍼는 파일 크기에 맞게 (64KB 단위로) 할당한다. 큰 파일은 
+///			필요한 만큼의 윈도우 (최대 window_count) 만 사용한다.
+typedef class file_hash_engine
+{
+public:
+	/// @param	window_size		한번에 읽고 해싱하는 크기
+	/// @param	window_count	링 버퍼의 윈도우 갯수 (최소 2, 읽기 선행 깊이)
+	file_hash_engine(_In_ uint32_t window_size = 1024 * 1024,
+					 _In_ uint32_t window_count = 4);
+	~file_hash_engine();
+
+	bool hash_file(_In_ const wchar_t* file_path,
+				   _In_ uint32_t digests,
+				   _Out_ file_digests& result);
+
+	/// @brief	file_handle 의 0 ~ 파일 크기까지를 해싱한다.
+	///			읽기는 오프셋을 지정해서 하므로 현재 파일 포인터 위치와 상관없이
+	///			항상 파일의 처음부터 해싱한다.
+	///
+	///			FILE_FLAG_OVERLAPPED 로 연 핸들은 읽기가 끝날 때까지 기다린다.
+	///			FILE_FLAG_NO_BUFFERING 으로 연 핸들처럼 정렬되지 않은 ReadFile 이 
+	///			거부되면 MMIO (FileIoHelper) 로 읽어서 호출 스레드에서 해싱한다.
+	bool hash_file(_In_ HANDLE file_handle,
+				   _In_ uint32_t digests,
+				   _Out_ file_digests& result);
+
+	uint32_t window_size() const { return _window_size; }
+	uint32_t window_count() const { return _window_count; }
+
+private:
+	bool read_window(_In_ HANDLE file_handle,
+					 _In_ uint64_t offset,
+					 _In_ uint32_t size,
+					 _Out_writes_bytes_(size) uint8_t* buffer);
+
+	bool hash_serial(_In_ HANDLE file_handle,
+					 _In_ uint64_t file_size,
+					 _In_ uint32_t digests,
+					 _Out_ file_digests& result);
+
+	bool hash_pipelined(_In_ HANDLE file_handle,
+						_In_ uint64_t file_size,
+						_In_ uint32_t digests,
+						_Out_ file_digests& result);
+
+	bool hash_mapped(_In_ HANDLE file_handle,
+					 _In_ uint32_t digests,
+					 _Out_ file_digests& result);
+
+private:
+	uint32_t _window_size;
+	uint32_t _window_count;
+
+	/// 마지막으로 실패한 ReadFile() 의 에러 코드
+	DWORD _read_error;
+
+	/// 윈도우 버퍼 (필요할 때 할당하고, 인스턴스가 살아있는 동안 재사용)
+	std::vector<std::unique_ptr<uint8_t[]>> _windows;
+
+	/// 작은 파일용 버퍼 (파일 크기에 맞게 키운다)
+	std::unique_ptr<uint8_t[]> _serial_window;
+	uint32_t _serial_window_size;
+
+} *pfile_hash_engine;
+
+/// @brief	엔진 풀 (기본 설정)
+///			해싱하는 동안만 엔진을 빌리고 file_hash_engine_release() 로 돌려준다. 
+///			쉬고 있는 엔진은 최대 FILE_HASH_ENGINE_POOL_SIZE 개만 보관하고 
+///			나머지는 해제하므로, 해싱을 한번 한 스레드가 윈도우 버퍼를 
+///			계속 붙잡고 있지 않는다.
+file_hash_engine* file_hash_engine_acquire();
+void file_hash_engine_release(_In_opt_ file_hash_engine* engine);
+
+/// @brief	풀에 보관중인 엔진을 모두 해제한다.
+void file_hash_engine_trim();
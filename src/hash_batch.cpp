@@ -0,0 +1,468 @@
+﻿/**
+ * @file    hash_batch.cpp
+ * @brief   Multi-buffer MD5/SHA-256 for hashing many small independent buffers.
+ *
+ * 스케줄러는 lane 마다 하나의 입력 버퍼를 할당하고, 매 스텝마다 모든 lane 의
+ * 다음 64 바이트 블록을 전치(transpose)해서 커널을 한번 호출한다. 입력이 끝난
+ * lane 은 패딩 블록(1~2개)을 처리한 뒤 digest 를 꺼내고 다음 버퍼로 교체된다.
+ * 따라서 크기가 제각각인 버퍼들도 lane 이 놀지 않고 처리된다.
+ *
+ * @author  Yonhgwhan, Roh (somma@somma.kr)
+ * @date    2026/10/18 created.
+ * @copyright (C)Somma, Inc. All rights reserved.
+**/
+#include "stdafx.h"
+#include "hash_batch.h"
+#include "cpu_features.h"
+#include "md5.h"
+#include "sha2.h"
+#include <atomic>
+
+#define MB_MAX_LANES	16
+#define MB_BLOCK_SIZE	64
+
+static const uint32_t _mb_k256[64] =
+{
+	0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+	0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+	0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+	0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+	0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+	0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+	0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+	0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+static const uint32_t _md5_iv[4] = { 0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476 };
+static const uint32_t _sha256_iv[8] = {
+	0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+};
+
+typedef void(*mb_kernel_fn)(_Inout_ uint32_t* state, _In_ const uint32_t* w);
+
+//
+//	ISA 별 커널 생성
+//
+#if defined(CPU_FEATURES_X86)
+#include <immintrin.h>
+
+// SSE2, 4 lanes
+#define MB_TARGET		CPU_TARGET("sse2")
+#define MB_LANES		4
+#define MB_VEC			__m128i
+#define MB_LOAD(p)		_mm_load_si128((const __m128i*)(p))
+#define MB_STORE(p, v)	_mm_store_si128((__m128i*)(p), v)
+#define MB_SET1(x)		_mm_set1_epi32((int)(x))
+#define MB_ADD(a, b)	_mm_add_epi32(a, b)
+#define MB_XOR(a, b)	_mm_xor_si128(a, b)
+#define MB_AND(a, b)	_mm_and_si128(a, b)
+#define MB_OR(a, b)		_mm_or_si128(a, b)
+#define MB_SHR(x, n)	_mm_srli_epi32(x, n)
+#define MB_ROTL(x, n)	_mm_or_si128(_mm_slli_epi32(x, n), _mm_srli_epi32(x, 32 - (n)))
+#define MB_ROTR(x, n)	_mm_or_si128(_mm_srli_epi32(x, n), _mm_slli_epi32(x, 32 - (n)))
+#define MB_MD5_FN		md5_x4_sse2
+#define MB_SHA256_FN	sha256_x4_sse2
+#include "hash_batch_x86.inl"
+#undef MB_TARGET
+#undef MB_LANES
+#undef MB_VEC
+#undef MB_LOAD
+#undef MB_STORE
+#undef MB_SET1
+#undef MB_ADD
+#undef MB_XOR
+#undef MB_AND
+#undef MB_OR
+#undef MB_SHR
+#undef MB_ROTL
+#undef MB_ROTR
+#undef MB_MD5_FN
+#undef MB_SHA256_FN
+
+// AVX2, 8 lanes
+#define MB_TARGET		CPU_TARGET("avx2")
+#define MB_LANES		8
+#define MB_VEC			__m256i
+#define MB_LOAD(p)		_mm256_load_si256((const __m256i*)(p))
+#define MB_STORE(p, v)	_mm256_store_si256((__m256i*)(p), v)
+#define MB_SET1(x)		_mm256_set1_epi32((int)(x))
+#define MB_ADD(a, b)	_mm256_add_epi32(a, b)
+#define MB_XOR(a, b)	_mm256_xor_si256(a, b)
+#define MB_AND(a, b)	_mm256_and_si256(a, b)
+#define MB_OR(a, b)		_mm256_or_si256(a, b)
+#define MB_SHR(x, n)	_mm256_srli_epi32(x, n)
+#define MB_ROTL(x, n)	_mm256_or_si256(_mm256_slli_epi32(x, n), _mm256_srli_epi32(x, 32 - (n)))
+#define MB_ROTR(x, n)	_mm256_or_si256(_mm256_srli_epi32(x, n), _mm256_slli_epi32(x, 32 - (n)))
+#define MB_MD5_FN		md5_x8_avx2
+#define MB_SHA256_FN	sha256_x8_avx2
+#include "hash_batch_x86.inl"
+#undef MB_TARGET
+#undef MB_LANES
+#undef MB_VEC
+#undef MB_LOAD
+#undef MB_STORE
+#undef MB_SET1
+#undef MB_ADD
+#undef MB_XOR
+#undef MB_AND
+#undef MB_OR
+#undef MB_SHR
+#undef MB_ROTL
+#undef MB_ROTR
+#undef MB_MD5_FN
+#undef MB_SHA256_FN
+
+// AVX-512, 16 lanes
+#define MB_TARGET		CPU_TARGET("avx512f")
+#define MB_LANES		16
+#define MB_VEC			__m512i
+#define MB_LOAD(p)		_mm512_load_si512((const void*)(p))
+#define MB_STORE(p, v)	_mm512_store_si512((void*)(p), v)
+#define MB_SET1(x)		_mm512_set1_epi32((int)(x))
+#define MB_ADD(a, b)	_mm512_add_epi32(a, b)
+#define MB_XOR(a, b)	_mm512_xor_si512(a, b)
+#define MB_AND(a, b)	_mm512_and_si512(a, b)
+#define MB_OR(a, b)		_mm512_or_si512(a, b)
+#define MB_SHR(x, n)	_mm512_srli_epi32(x, n)
+#define MB_ROTL(x, n)	_mm512_rol_epi32(x, n)
+#define MB_ROTR(x, n)	_mm512_ror_epi32(x, n)
+#define MB_MD5_FN		md5_x16_avx512
+#define MB_SHA256_FN	sha256_x16_avx512
+#include "hash_batch_x86.inl"
+#undef MB_TARGET
+#undef MB_LANES
+#undef MB_VEC
+#undef MB_LOAD
+#undef MB_STORE
+#undef MB_SET1
+#undef MB_ADD
+#undef MB_XOR
+#undef MB_AND
+#undef MB_OR
+#undef MB_SHR
+#undef MB_ROTL
+#undef MB_ROTR
+#undef MB_MD5_FN
+#undef MB_SHA256_FN
+
+#endif//CPU_FEATURES_X86
+
+//
+//	lane 수 선택
+//
+static bool lanes_supported(_In_ uint32_t lanes)
+{
+	switch (lanes)
+	{
+	case 1: return true;
+#if defined(CPU_FEATURES_X86)
+	case 4: return get_cpu_features().sse2;
+	case 8: return get_cpu_features().avx2;
+	case 16: return get_cpu_features().avx512f;
+#endif
+	}
+	return false;
+}
+
+static uint32_t best_lanes()
+{
+	if (lanes_supported(16)) return 16;
+	if (lanes_supported(8)) return 8;
+	if (lanes_supported(4)) return 4;
+	return 1;
+}
+
+static std::atomic<uint32_t> _lanes(0);
+static std::atomic<bool> _lanes_forced(false);
+
+/// @brief	현재 사용중인 lane 수를 리턴한다.
+uint32_t hash_batch_lanes()
+{
+	uint32_t lanes = _lanes.load(std::memory_order_relaxed);
+	if (0 == lanes)
+	{
+		lanes = best_lanes();
+		_lanes.store(lanes, std::memory_order_relaxed);
+	}
+	return lanes;
+}
+
+/// @brief	사용할 lane 수를 강제로 지정한다.
+bool hash_batch_set_lanes(_In_ uint32_t lanes)
+{
+	bool forced = (0 != lanes);
+	if (0 == lanes) lanes = best_lanes();
+	if (!lanes_supported(lanes)) return false;
+
+	_lanes.store(lanes, std::memory_order_relaxed);
+	_lanes_forced.store(forced, std::memory_order_relaxed);
+	return true;
+}
+
+//
+//	multi-buffer 스케줄러
+//
+typedef struct mb_algorithm
+{
+	uint32_t state_words;
+	const uint32_t* iv;
+	bool big_endian;
+} *pmb_algorithm;
+
+static const mb_algorithm _mb_md5 = { 4, _md5_iv, false };
+static const mb_algorithm _mb_sha256 = { 8, _sha256_iv, true };
+
+typedef struct mb_lane
+{
+	bool active;
+	size_t job;
+	const uint8_t* data;		// 남은 full 블록
+	size_t full_blocks;
+	uint8_t tail[2 * MB_BLOCK_SIZE];	// 마지막 partial 데이터 + 패딩 + 길이
+	size_t tail_blocks;
+	size_t tail_index;
+} *pmb_lane;
+
+/// @brief	lane 에 새 입력을 할당하고 패딩 블록을 준비한다.
+static void
+mb_lane_assign(
+	_In_ const mb_algorithm& alg,
+	_Inout_ mb_lane& lane,
+	_In_ size_t job,
+	_In_ const uint8_t* data,
+	_In_ size_t size
+	)
+{
+	lane.active = true;
+	lane.job = job;
+	lane.data = data;
+	lane.full_blocks = size / MB_BLOCK_SIZE;
+	lane.tail_index = 0;
+
+	size_t rem = size % MB_BLOCK_SIZE;
+	lane.tail_blocks = (rem + 9 > MB_BLOCK_SIZE) ? 2 : 1;
+
+	memset(lane.tail, 0x00, sizeof(lane.tail));
+	if (rem > 0)
+	{
+		memcpy(lane.tail, data + lane.full_blocks * MB_BLOCK_SIZE, rem);
+	}
+	lane.tail[rem] = 0x80;
+
+	uint64_t bits = (uint64_t)size << 3;
+	uint8_t* len = &lane.tail[lane.tail_blocks * MB_BLOCK_SIZE - 8];
+	for (int i = 0; i < 8; ++i)
+	{
+		int shift = alg.big_endian ? (56 - 8 * i) : (8 * i);
+		len[i] = (uint8_t)(bits >> shift);
+	}
+}
+
+static inline uint32_t load_le32(_In_ const uint8_t* p)
+{
+	return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static inline uint32_t load_be32(_In_ const uint8_t* p)
+{
+	return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | (uint32_t)p[3];
+}
+
+static void
+mb_run(
+	_In_ const mb_algorithm& alg,
+	_In_ mb_kernel_fn kernel,
+	_In_ uint32_t lanes,
+	_In_ size_t count,
+	_In_reads_(count) const uint8_t* const* data,
+	_In_reads_(count) const size_t* sizes,
+	_Out_writes_bytes_(count * alg.state_words * 4) uint8_t* digests
+	)
+{
+	alignas(64) uint32_t state[8 * MB_MAX_LANES];
+	alignas(64) uint32_t w[16 * MB_MAX_LANES];
+	mb_lane lane[MB_MAX_LANES];
+
+	memset(state, 0x00, sizeof(state));
+	memset(w, 0x00, sizeof(w));
+
+	size_t next_job = 0;
+	size_t active = 0;
+	for (uint32_t l = 0; l < lanes; ++l)
+	{
+		lane[l].active = false;
+		if (next_job < count)
+		{
+			mb_lane_assign(alg, lane[l], next_job, data[next_job], sizes[next_job]);
+			for (uint32_t i = 0; i < alg.state_words; ++i)
+			{
+				state[i * lanes + l] = alg.iv[i];
+			}
+			++next_job;
+			++active;
+		}
+	}
+
+	while (active > 0)
+	{
+		//
+		//	각 lane 의 다음 블록을 [word][lane] 형태로 전치
+		//
+		for (uint32_t l = 0; l < lanes; ++l)
+		{
+			if (!lane[l].active) continue;
+
+			const uint8_t* block = (lane[l].full_blocks > 0) ?
+				lane[l].data :
+				&lane[l].tail[lane[l].tail_index * MB_BLOCK_SIZE];
+
+			if (alg.big_endian)
+			{
+				for (int i = 0; i < 16; ++i) { w[i * lanes + l] = load_be32(block + i * 4); }
+			}
+			else
+			{
+				for (int i = 0; i < 16; ++i) { w[i * lanes + l] = load_le32(block + i * 4); }
+			}
+		}
+
+		kernel(state, w);
+
+		//
+		//	블록 포인터 전진, 끝난 lane 은 digest 를 꺼내고 다음 입력으로 교체
+		//
+		for (uint32_t l = 0; l < lanes; ++l)
+		{
+			if (!lane[l].active) continue;
+
+			if (lane[l].full_blocks > 0)
+			{
+				lane[l].data += MB_BLOCK_SIZE;
+				--lane[l].full_blocks;
+				continue;
+			}
+
+			if (++lane[l].tail_index < lane[l].tail_blocks) continue;
+
+			uint8_t* digest = digests + lane[l].job * alg.state_words * 4;
+			for (uint32_t i = 0; i < alg.state_words; ++i)
+			{
+				uint32_t v = state[i * lanes + l];
+				for (int j = 0; j < 4; ++j)
+				{
+					int shift = alg.big_endian ? (24 - 8 * j) : (8 * j);
+					digest[i * 4 + j] = (uint8_t)(v >> shift);
+				}
+			}
+
+			lane[l].active = false;
+			--active;
+			if (next_job < count)
+			{
+				mb_lane_assign(alg, lane[l], next_job, data[next_job], sizes[next_job]);
+				for (uint32_t i = 0; i < alg.state_words; ++i)
+				{
+					state[i * lanes + l] = alg.iv[i];
+				}
+				++next_job;
+				++active;
+			}
+		}
+	}
+}
+
+/// @brief	count 개의 버퍼에 대한 MD5 를 계산한다.
+void
+md5_batch(
+	_In_ size_t count,
+	_In_reads_(count) const uint8_t* const* data,
+	_In_reads_(count) const size_t* sizes,
+	_Out_writes_(count) uint8_t(*digests)[MD5_BATCH_DIGEST_SIZE]
+	)
+{
+	if (0 == count) return;
+
+	mb_kernel_fn kernel = nullptr;
+	uint32_t lanes = hash_batch_lanes();
+	switch (lanes)
+	{
+#if defined(CPU_FEATURES_X86)
+	case 4: kernel = md5_x4_sse2; break;
+	case 8: kernel = md5_x8_avx2; break;
+	case 16: kernel = md5_x16_avx512; break;
+#endif
+	}
+
+	if (nullptr != kernel)
+	{
+		mb_run(_mb_md5, kernel, lanes, count, data, sizes, &digests[0][0]);
+		return;
+	}
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		MD5_CTX ctx;
+		MD5Init(&ctx, 0);
+		for (size_t pos = 0; pos < sizes[i]; )
+		{
+			unsigned int chunk = (unsigned int)min(sizes[i] - pos, (size_t)0x40000000);
+			MD5Update(&ctx, (unsigned char*)&data[i][pos], chunk);
+			pos += chunk;
+		}
+		MD5Final(&ctx);
+		memcpy(digests[i], ctx.digest, MD5_BATCH_DIGEST_SIZE);
+	}
+}
+
+/// @brief	count 개의 버퍼에 대한 SHA-256 을 계산한다.
+void
+sha256_batch(
+	_In_ size_t count,
+	_In_reads_(count) const uint8_t* const* data,
+	_In_reads_(count) const size_t* sizes,
+	_Out_writes_(count) uint8_t(*digests)[SHA256_BATCH_DIGEST_SIZE]
+	)
+{
+	if (0 == count) return;
+
+	//
+	//	SHA extensions 가 있으면 한 스트림 처리량이 4/8 lane 보다 높으므로,
+	//	lane 수를 강제로 지정하지 않은 경우에는 버퍼 단위로 sha256 을 호출한다.
+	//
+	mb_kernel_fn kernel = nullptr;
+	uint32_t lanes = hash_batch_lanes();
+	if (lanes < 16 &&
+		true != _lanes_forced.load(std::memory_order_relaxed) &&
+		SHA256_IMPL_SHANI == sha256_get_impl())
+	{
+		lanes = 1;
+	}
+
+	switch (lanes)
+	{
+#if defined(CPU_FEATURES_X86)
+	case 4: kernel = sha256_x4_sse2; break;
+	case 8: kernel = sha256_x8_avx2; break;
+	case 16: kernel = sha256_x16_avx512; break;
+#endif
+	}
+
+	if (nullptr != kernel)
+	{
+		mb_run(_mb_sha256, kernel, lanes, count, data, sizes, &digests[0][0]);
+		return;
+	}
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		sha256_ctx ctx;
+		sha256_begin(&ctx);
+		for (size_t pos = 0; pos < sizes[i]; )
+		{
+			unsigned long chunk = (unsigned long)min(sizes[i] - pos, (size_t)0x40000000);
+			sha256_hash(&data[i][pos], chunk, &ctx);
+			pos += chunk;
+		}
+		sha256_end(digests[i], &ctx);
+	}
+}
@@ -0,0 +1,43 @@
+﻿/**
+ * @file    hash_batch.h
+ * @brief   Multi-buffer MD5/SHA-256 for hashing many small independent buffers.
+ *
+ * 각 입력 버퍼를 SIMD 레지스터의 lane 하나에 할당해서 여러 버퍼를 동시에
+ * 해싱한다. (SSE2 4 lanes, AVX2 8 lanes, AVX-512 16 lanes)
+ * 결과는 MD5Init(ctx, 0)/MD5Update/MD5Final, sha256() 과 동일하다.
+ *
+ * @author  Yonhgwhan, Roh (somma@somma.kr)
+ * @date    2026/10/18 created.
+ * @copyright (C)Somma, Inc. All rights reserved.
+**/
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+#define MD5_BATCH_DIGEST_SIZE		16
+#define SHA256_BATCH_DIGEST_SIZE	32
+
+/// @brief	현재 사용중인 lane 수를 리턴한다. (1 이면 SIMD 미사용)
+uint32_t hash_batch_lanes();
+
+/// @brief	사용할 lane 수를 강제로 지정한다. (0 이면 CPU 에 맞게 자동 선택)
+///			CPU 가 지원하지 않는 lane 수이면 false 를 리턴한다.
+bool hash_batch_set_lanes(_In_ uint32_t lanes);
+
+/// @brief	count 개의 버퍼에 대한 MD5 를 계산한다.
+void
+md5_batch(
+	_In_ size_t count,
+	_In_reads_(count) const uint8_t* const* data,
+	_In_reads_(count) const size_t* sizes,
+	_Out_writes_(count) uint8_t (*digests)[MD5_BATCH_DIGEST_SIZE]
+	);
+
+/// @brief	count 개의 버퍼에 대한 SHA-256 을 계산한다.
+void
+sha256_batch(
+	_In_ size_t count,
+	_In_reads_(count) const uint8_t* const* data,
+	_In_reads_(count) const size_t* sizes,
+	_Out_writes_(count) uint8_t (*digests)[SHA256_BATCH_DIGEST_SIZE]
+	);
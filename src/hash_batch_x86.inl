@@ -0,0 +1,200 @@
+﻿/**
+ * @file    hash_batch_x86.inl
+ * @brief   Multi-buffer MD5/SHA-256 block kernels.
+ *
+ * hash_batch.cpp 에서 ISA 별 매크로를 정의한 뒤 여러번 include 한다.
+ * 벡터의 각 32 bit lane 이 서로 다른 입력 버퍼 하나를 담당한다.
+ *
+ * 필요한 매크로
+ *	MB_TARGET			CPU_TARGET("...") 문자열
+ *	MB_LANES			lane 수 (4, 8, 16)
+ *	MB_VEC				벡터 타입
+ *	MB_LOAD(p)			aligned load
+ *	MB_STORE(p, v)		aligned store
+ *	MB_SET1(x)			broadcast
+ *	MB_ADD/XOR/AND/OR(a, b)
+ *	MB_ROTL(x, n) / MB_ROTR(x, n) / MB_SHR(x, n)
+ *	MB_MD5_FN / MB_SHA256_FN	생성할 함수 이름
+ *
+ * 함수 인자
+ *	state	[word][MB_LANES] 형태의 체인 값 (md5: 4 words, sha256: 8 words)
+ *	w		[16][MB_LANES] 형태로 전치된 메시지 블록 (엔디안 변환 완료)
+ *
+ * @author  Yonhgwhan, Roh (somma@somma.kr)
+ * @date    2026/10/18 created.
+ * @copyright (C)Somma, Inc. All rights reserved.
+**/
+
+#define MB_NOT(x)	MB_XOR((x), MB_SET1(0xffffffff))
+
+#define MB_MD5_F(x, y, z)	MB_XOR((z), MB_AND((x), MB_XOR((y), (z))))
+#define MB_MD5_G(x, y, z)	MB_XOR((y), MB_AND((z), MB_XOR((x), (y))))
+#define MB_MD5_H(x, y, z)	MB_XOR(MB_XOR((x), (y)), (z))
+#define MB_MD5_I(x, y, z)	MB_XOR((y), MB_OR((x), MB_NOT(z)))
+
+#define MB_MD5_STEP(f, a, b, c, d, k, s, ac) \
+	a = MB_ADD(a, MB_ADD(f(b, c, d), MB_ADD(MB_LOAD(w + (k) * MB_LANES), MB_SET1(ac)))); \
+	a = MB_ADD(MB_ROTL(a, s), b)
+
+MB_TARGET
+static void MB_MD5_FN(_Inout_ uint32_t* state, _In_ const uint32_t* w)
+{
+	MB_VEC a = MB_LOAD(state + 0 * MB_LANES);
+	MB_VEC b = MB_LOAD(state + 1 * MB_LANES);
+	MB_VEC c = MB_LOAD(state + 2 * MB_LANES);
+	MB_VEC d = MB_LOAD(state + 3 * MB_LANES);
+	const MB_VEC a0 = a, b0 = b, c0 = c, d0 = d;
+
+	MB_MD5_STEP(MB_MD5_F, a, b, c, d,  0,  7, 0xd76aa478);
+	MB_MD5_STEP(MB_MD5_F, d, a, b, c,  1, 12, 0xe8c7b756);
+	MB_MD5_STEP(MB_MD5_F, c, d, a, b,  2, 17, 0x242070db);
+	MB_MD5_STEP(MB_MD5_F, b, c, d, a,  3, 22, 0xc1bdceee);
+	MB_MD5_STEP(MB_MD5_F, a, b, c, d,  4,  7, 0xf57c0faf);
+	MB_MD5_STEP(MB_MD5_F, d, a, b, c,  5, 12, 0x4787c62a);
+	MB_MD5_STEP(MB_MD5_F, c, d, a, b,  6, 17, 0xa8304613);
+	MB_MD5_STEP(MB_MD5_F, b, c, d, a,  7, 22, 0xfd469501);
+	MB_MD5_STEP(MB_MD5_F, a, b, c, d,  8,  7, 0x698098d8);
+	MB_MD5_STEP(MB_MD5_F, d, a, b, c,  9, 12, 0x8b44f7af);
+	MB_MD5_STEP(MB_MD5_F, c, d, a, b, 10, 17, 0xffff5bb1);
+	MB_MD5_STEP(MB_MD5_F, b, c, d, a, 11, 22, 0x895cd7be);
+	MB_MD5_STEP(MB_MD5_F, a, b, c, d, 12,  7, 0x6b901122);
+	MB_MD5_STEP(MB_MD5_F, d, a, b, c, 13, 12, 0xfd987193);
+	MB_MD5_STEP(MB_MD5_F, c, d, a, b, 14, 17, 0xa679438e);
+	MB_MD5_STEP(MB_MD5_F, b, c, d, a, 15, 22, 0x49b40821);
+
+	MB_MD5_STEP(MB_MD5_G, a, b, c, d,  1,  5, 0xf61e2562);
+	MB_MD5_STEP(MB_MD5_G, d, a, b, c,  6,  9, 0xc040b340);
+	MB_MD5_STEP(MB_MD5_G, c, d, a, b, 11, 14, 0x265e5a51);
+	MB_MD5_STEP(MB_MD5_G, b, c, d, a,  0, 20, 0xe9b6c7aa);
+	MB_MD5_STEP(MB_MD5_G, a, b, c, d,  5,  5, 0xd62f105d);
+	MB_MD5_STEP(MB_MD5_G, d, a, b, c, 10,  9, 0x02441453);
+	MB_MD5_STEP(MB_MD5_G, c, d, a, b, 15, 14, 0xd8a1e681);
+	MB_MD5_STEP(MB_MD5_G, b, c, d, a,  4, 20, 0xe7d3fbc8);
+	MB_MD5_STEP(MB_MD5_G, a, b, c, d,  9,  5, 0x21e1cde6);
+	MB_MD5_STEP(MB_MD5_G, d, a, b, c, 14,  9, 0xc33707d6);
+	MB_MD5_STEP(MB_MD5_G, c, d, a, b,  3, 14, 0xf4d50d87);
+	MB_MD5_STEP(MB_MD5_G, b, c, d, a,  8, 20, 0x455a14ed);
+	MB_MD5_STEP(MB_MD5_G, a, b, c, d, 13,  5, 0xa9e3e905);
+	MB_MD5_STEP(MB_MD5_G, d, a, b, c,  2,  9, 0xfcefa3f8);
+	MB_MD5_STEP(MB_MD5_G, c, d, a, b,  7, 14, 0x676f02d9);
+	MB_MD5_STEP(MB_MD5_G, b, c, d, a, 12, 20, 0x8d2a4c8a);
+
+	MB_MD5_STEP(MB_MD5_H, a, b, c, d,  5,  4, 0xfffa3942);
+	MB_MD5_STEP(MB_MD5_H, d, a, b, c,  8, 11, 0x8771f681);
+	MB_MD5_STEP(MB_MD5_H, c, d, a, b, 11, 16, 0x6d9d6122);
+	MB_MD5_STEP(MB_MD5_H, b, c, d, a, 14, 23, 0xfde5380c);
+	MB_MD5_STEP(MB_MD5_H, a, b, c, d,  1,  4, 0xa4beea44);
+	MB_MD5_STEP(MB_MD5_H, d, a, b, c,  4, 11, 0x4bdecfa9);
+	MB_MD5_STEP(MB_MD5_H, c, d, a, b,  7, 16, 0xf6bb4b60);
+	MB_MD5_STEP(MB_MD5_H, b, c, d, a, 10, 23, 0xbebfbc70);
+	MB_MD5_STEP(MB_MD5_H, a, b, c, d, 13,  4, 0x289b7ec6);
+	MB_MD5_STEP(MB_MD5_H, d, a, b, c,  0, 11, 0xeaa127fa);
+	MB_MD5_STEP(MB_MD5_H, c, d, a, b,  3, 16, 0xd4ef3085);
+	MB_MD5_STEP(MB_MD5_H, b, c, d, a,  6, 23, 0x04881d05);
+	MB_MD5_STEP(MB_MD5_H, a, b, c, d,  9,  4, 0xd9d4d039);
+	MB_MD5_STEP(MB_MD5_H, d, a, b, c, 12, 11, 0xe6db99e5);
+	MB_MD5_STEP(MB_MD5_H, c, d, a, b, 15, 16, 0x1fa27cf8);
+	MB_MD5_STEP(MB_MD5_H, b, c, d, a,  2, 23, 0xc4ac5665);
+
+	MB_MD5_STEP(MB_MD5_I, a, b, c, d,  0,  6, 0xf4292244);
+	MB_MD5_STEP(MB_MD5_I, d, a, b, c,  7, 10, 0x432aff97);
+	MB_MD5_STEP(MB_MD5_I, c, d, a, b, 14, 15, 0xab9423a7);
+	MB_MD5_STEP(MB_MD5_I, b, c, d, a,  5, 21, 0xfc93a039);
+	MB_MD5_STEP(MB_MD5_I, a, b, c, d, 12,  6, 0x655b59c3);
+	MB_MD5_STEP(MB_MD5_I, d, a, b, c,  3, 10, 0x8f0ccc92);
+	MB_MD5_STEP(MB_MD5_I, c, d, a, b, 10, 15, 0xffeff47d);
+	MB_MD5_STEP(MB_MD5_I, b, c, d, a,  1, 21, 0x85845dd1);
+	MB_MD5_STEP(MB_MD5_I, a, b, c, d,  8,  6, 0x6fa87e4f);
+	MB_MD5_STEP(MB_MD5_I, d, a, b, c, 15, 10, 0xfe2ce6e0);
+	MB_MD5_STEP(MB_MD5_I, c, d, a, b,  6, 15, 0xa3014314);
+	MB_MD5_STEP(MB_MD5_I, b, c, d, a, 13, 21, 0x4e0811a1);
+	MB_MD5_STEP(MB_MD5_I, a, b, c, d,  4,  6, 0xf7537e82);
+	MB_MD5_STEP(MB_MD5_I, d, a, b, c, 11, 10, 0xbd3af235);
+	MB_MD5_STEP(MB_MD5_I, c, d, a, b,  2, 15, 0x2ad7d2bb);
+	MB_MD5_STEP(MB_MD5_I, b, c, d, a,  9, 21, 0xeb86d391);
+
+	MB_STORE(state + 0 * MB_LANES, MB_ADD(a, a0));
+	MB_STORE(state + 1 * MB_LANES, MB_ADD(b, b0));
+	MB_STORE(state + 2 * MB_LANES, MB_ADD(c, c0));
+	MB_STORE(state + 3 * MB_LANES, MB_ADD(d, d0));
+}
+
+#define MB_CH(x, y, z)	MB_XOR((z), MB_AND((x), MB_XOR((y), (z))))
+#define MB_MAJ(x, y, z)	MB_OR(MB_AND((x), (y)), MB_AND((z), MB_OR((x), (y))))
+#define MB_S0(x)		MB_XOR(MB_XOR(MB_ROTR((x), 2), MB_ROTR((x), 13)), MB_ROTR((x), 22))
+#define MB_S1(x)		MB_XOR(MB_XOR(MB_ROTR((x), 6), MB_ROTR((x), 11)), MB_ROTR((x), 25))
+#define MB_G0(x)		MB_XOR(MB_XOR(MB_ROTR((x), 7), MB_ROTR((x), 18)), MB_SHR((x), 3))
+#define MB_G1(x)		MB_XOR(MB_XOR(MB_ROTR((x), 17), MB_ROTR((x), 19)), MB_SHR((x), 10))
+
+#define MB_SHA256_ROUND(a, b, c, d, e, f, g, h, i) \
+	if (t + (i) >= 16) \
+	{ \
+		x[(i)] = MB_ADD(MB_ADD(x[(i)], MB_G1(x[((i) + 14) & 15])), \
+						MB_ADD(x[((i) + 9) & 15], MB_G0(x[((i) + 1) & 15]))); \
+	} \
+	t1 = MB_ADD(MB_ADD(h, MB_S1(e)), MB_ADD(MB_CH(e, f, g), MB_ADD(MB_SET1(_mb_k256[t + (i)]), x[(i)]))); \
+	d = MB_ADD(d, t1); \
+	h = MB_ADD(t1, MB_ADD(MB_S0(a), MB_MAJ(a, b, c)))
+
+MB_TARGET
+static void MB_SHA256_FN(_Inout_ uint32_t* state, _In_ const uint32_t* w)
+{
+	MB_VEC a = MB_LOAD(state + 0 * MB_LANES);
+	MB_VEC b = MB_LOAD(state + 1 * MB_LANES);
+	MB_VEC c = MB_LOAD(state + 2 * MB_LANES);
+	MB_VEC d = MB_LOAD(state + 3 * MB_LANES);
+	MB_VEC e = MB_LOAD(state + 4 * MB_LANES);
+	MB_VEC f = MB_LOAD(state + 5 * MB_LANES);
+	MB_VEC g = MB_LOAD(state + 6 * MB_LANES);
+	MB_VEC h = MB_LOAD(state + 7 * MB_LANES);
+	MB_VEC t1;
+
+	MB_VEC x[16];
+	for (int i = 0; i < 16; ++i)
+	{
+		x[i] = MB_LOAD(w + i * MB_LANES);
+	}
+
+	for (int t = 0; t < 64; t += 16)
+	{
+		MB_SHA256_ROUND(a, b, c, d, e, f, g, h, 0);
+		MB_SHA256_ROUND(h, a, b, c, d, e, f, g, 1);
+		MB_SHA256_ROUND(g, h, a, b, c, d, e, f, 2);
+		MB_SHA256_ROUND(f, g, h, a, b, c, d, e, 3);
+		MB_SHA256_ROUND(e, f, g, h, a, b, c, d, 4);
+		MB_SHA256_ROUND(d, e, f, g, h, a, b, c, 5);
+		MB_SHA256_ROUND(c, d, e, f, g, h, a, b, 6);
+		MB_SHA256_ROUND(b, c, d, e, f, g, h, a, 7);
+		MB_SHA256_ROUND(a, b, c, d, e, f, g, h, 8);
+		MB_SHA256_ROUND(h, a, b, c, d, e, f, g, 9);
+		MB_SHA256_ROUND(g, h, a, b, c, d, e, f, 10);
+		MB_SHA256_ROUND(f, g, h, a, b, c, d, e, 11);
+		MB_SHA256_ROUND(e, f, g, h, a, b, c, d, 12);
+		MB_SHA256_ROUND(d, e, f, g, h, a, b, c, 13);
+		MB_SHA256_ROUND(c, d, e, f, g, h, a, b, 14);
+		MB_SHA256_ROUND(b, c, d, e, f, g, h, a, 15);
+	}
+
+	MB_STORE(state + 0 * MB_LANES, MB_ADD(a, MB_LOAD(state + 0 * MB_LANES)));
+	MB_STORE(state + 1 * MB_LANES, MB_ADD(b, MB_LOAD(state + 1 * MB_LANES)));
+	MB_STORE(state + 2 * MB_LANES, MB_ADD(c, MB_LOAD(state + 2 * MB_LANES)));
+	MB_STORE(state + 3 * MB_LANES, MB_ADD(d, MB_LOAD(state + 3 * MB_LANES)));
+	MB_STORE(state + 4 * MB_LANES, MB_ADD(e, MB_LOAD(state + 4 * MB_LANES)));
+	MB_STORE(state + 5 * MB_LANES, MB_ADD(f, MB_LOAD(state + 5 * MB_LANES)));
+	MB_STORE(state + 6 * MB_LANES, MB_ADD(g, MB_LOAD(state + 6 * MB_LANES)));
+	MB_STORE(state + 7 * MB_LANES, MB_ADD(h, MB_LOAD(state + 7 * MB_LANES)));
+}
+
+#undef MB_NOT
+#undef MB_MD5_F
+#undef MB_MD5_G
+#undef MB_MD5_H
+#undef MB_MD5_I
+#undef MB_MD5_STEP
+#undef MB_CH
+#undef MB_MAJ
+#undef MB_S0
+#undef MB_S1
+#undef MB_G0
+#undef MB_G1
+#undef MB_SHA256_ROUND
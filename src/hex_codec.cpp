@@ -0,0 +1,567 @@
+﻿/**
+ * @file    hex_codec.cpp
+ * @brief   Allocation-free hex encode/decode (scalar/SSSE3/AVX2) and hexdump streaming.
+ *
+ * @author  Yonhgwhan, Roh (somma@somma.kr)
+ * @date    2026/10/18 created.
+ * @copyright (C)Somma, Inc. All rights reserved.
+**/
+#include "stdafx.h"
+#include "hex_codec.h"
+#include "CStream.h"
+#include "cpu_features.h"
+#include <atomic>
+
+static const char _lower_digits[] = "0123456789abcdef";
+static const char _upper_digits[] = "0123456789ABCDEF";
+
+/// 문자 -> nibble, 16 진수 문자가 아니면 0xff
+static const uint8_t _decode_table[256] = 
+{
+	0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	0xff, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	0xff, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff
+};
+
+//
+//	커널은 처리할 수 있는 만큼 처리하고 처리한 입력 크기를 리턴한다. 
+//	digits 는 16 문자 테이블 ("0123456789abcdef" 또는 대문자)
+//	decode 커널은 잘못된 문자를 만나면 valid 를 false 로 하고 리턴한다.
+//
+typedef size_t (*hex_encode_fn)(const uint8_t* in, size_t in_len, const char* digits, char* out);
+typedef size_t (*hex_decode_fn)(const char* in, size_t in_len, uint8_t* out, bool& valid);
+
+#if defined(CPU_FEATURES_X86)
+size_t hex_encode_ssse3(const uint8_t* in, size_t in_len, const char* digits, char* out);
+size_t hex_encode_avx2(const uint8_t* in, size_t in_len, const char* digits, char* out);
+size_t hex_decode_ssse3(const char* in, size_t in_len, uint8_t* out, bool& valid);
+size_t hex_decode_avx2(const char* in, size_t in_len, uint8_t* out, bool& valid);
+#endif
+
+static size_t hex_encode_scalar(const uint8_t* in, size_t in_len, const char* digits, char* out)
+{
+	for (size_t i = 0; i < in_len; ++i)
+	{
+		out[0] = digits[in[i] >> 4];
+		out[1] = digits[in[i] & 0x0f];
+		out += 2;
+	}
+	return in_len;
+}
+
+static size_t hex_decode_scalar(const char* in, size_t in_len, uint8_t* out, bool& valid)
+{
+	valid = true;
+	size_t done = 0;
+	for (; in_len - done >= 2; done += 2)
+	{
+		const uint32_t hi = _decode_table[(uint8_t)in[done]];
+		const uint32_t lo = _decode_table[(uint8_t)in[done + 1]];
+		if (0 != ((hi | lo) & 0x80))
+		{
+			valid = false;
+			break;
+		}
+		*out++ = (uint8_t)((hi << 4) | lo);
+	}
+	return done;
+}
+
+typedef struct hex_kernels
+{
+	int impl;
+	hex_encode_fn encode;
+	hex_decode_fn decode;
+} *phex_kernels;
+
+static const hex_kernels _kernels_scalar = { HEX_IMPL_SCALAR, hex_encode_scalar, hex_decode_scalar };
+#if defined(CPU_FEATURES_X86)
+static const hex_kernels _kernels_ssse3 = { HEX_IMPL_SSSE3, hex_encode_ssse3, hex_decode_ssse3 };
+static const hex_kernels _kernels_avx2 = { HEX_IMPL_AVX2, hex_encode_avx2, hex_decode_avx2 };
+#endif
+
+static const hex_kernels* hex_impl_kernels(int impl)
+{
+	switch (impl)
+	{
+	case HEX_IMPL_SCALAR:
+		return &_kernels_scalar;
+#if defined(CPU_FEATURES_X86)
+	case HEX_IMPL_SSSE3:
+		return get_cpu_features().ssse3 ? &_kernels_ssse3 : nullptr;
+	case HEX_IMPL_AVX2:
+		return get_cpu_features().avx2 ? &_kernels_avx2 : nullptr;
+#endif
+	}
+	return nullptr;
+}
+
+static int hex_best_impl()
+{
+	if (nullptr != hex_impl_kernels(HEX_IMPL_AVX2)) return HEX_IMPL_AVX2;
+	if (nullptr != hex_impl_kernels(HEX_IMPL_SSSE3)) return HEX_IMPL_SSSE3;
+	return HEX_IMPL_SCALAR;
+}
+
+static std::atomic<const hex_kernels*> _kernels(nullptr);
+
+static const hex_kernels* hex_get_kernels()
+{
+	const hex_kernels* kernels = _kernels.load(std::memory_order_relaxed);
+	if (nullptr == kernels)
+	{
+		kernels = hex_impl_kernels(hex_best_impl());
+		_kernels.store(kernels, std::memory_order_relaxed);
+	}
+	return kernels;
+}
+
+/// @brief	hex_encode()/hex_decode() 가 사용할 구현을 선택한다.
+///			HEX_IMPL_AUTO 는 CPU 가 지원하는 가장 빠른 구현을 선택한다.
+bool hex_set_impl(int impl)
+{
+	if (HEX_IMPL_AUTO == impl)
+	{
+		impl = hex_best_impl();
+	}
+
+	const hex_kernels* kernels = hex_impl_kernels(impl);
+	if (nullptr == kernels) return false;
+
+	_kernels.store(kernels, std::memory_order_relaxed);
+	return true;
+}
+
+int hex_get_impl()
+{
+	return hex_get_kernels()->impl;
+}
+
+bool hex_impl_supported(int impl)
+{
+	return (HEX_IMPL_AUTO == impl || nullptr != hex_impl_kernels(impl));
+}
+
+const char* hex_impl_name(int impl)
+{
+	switch (impl)
+	{
+	case HEX_IMPL_AUTO: return "auto";
+	case HEX_IMPL_SCALAR: return "scalar";
+	case HEX_IMPL_SSSE3: return "ssse3";
+	case HEX_IMPL_AVX2: return "avx2";
+	}
+	return "unknown";
+}
+
+/// @brief	in_len 바이트를 out 에 인코딩한다. (out 은 in_len * 2 문자)
+static void encode_bytes(const uint8_t* in, size_t in_len, bool upper_case, char* out)
+{
+	const char* digits = (upper_case) ? _upper_digits : _lower_digits;
+	size_t done = hex_get_kernels()->encode(in, in_len, digits, out);
+	hex_encode_scalar(in + done, in_len - done, digits, out + done * 2);
+}
+
+/// @brief	in_len (짝수) 문자를 out 에 디코딩한다.
+static bool decode_chars(const char* in, size_t in_len, uint8_t* out)
+{
+	_ASSERTE(0 == in_len % 2);
+
+	bool valid = true;
+	size_t done = hex_get_kernels()->decode(in, in_len, out, valid);
+	if (valid)
+	{
+		done += hex_decode_scalar(in + done, in_len - done, out + done / 2, valid);
+	}
+	return (valid && done == in_len);
+}
+
+/// @brief	out 에 인코딩한다. (null 문자를 붙이지 않음)
+bool 
+hex_encode(
+	_In_reads_bytes_(in_len) const uint8_t* in, 
+	_In_ size_t in_len, 
+	_In_ bool upper_case,
+	_Out_writes_to_(out_size, out_len) char* out, 
+	_In_ size_t out_size, 
+	_Out_ size_t& out_len
+	)
+{
+	out_len = 0;
+	if ((nullptr == in || nullptr == out) && 0 != in_len) return false;
+
+	const size_t length = hex_encoded_length(in_len);
+	if (out_size < length)
+	{
+		log_err "output buffer too small. required=%zu, size=%zu", length, out_size log_end;
+		return false;
+	}
+
+	encode_bytes(in, in_len, upper_case, out);
+	out_len = length;
+	return true;
+}
+
+/// @brief	out 에 인코딩한다. (null 문자를 붙이지 않음)
+///			스택 버퍼 (4 KB) 단위로 인코딩해서 wchar_t 로 넓힌다.
+bool 
+hex_encode(
+	_In_reads_bytes_(in_len) const uint8_t* in, 
+	_In_ size_t in_len, 
+	_In_ bool upper_case,
+	_Out_writes_to_(out_size, out_len) wchar_t* out, 
+	_In_ size_t out_size, 
+	_Out_ size_t& out_len
+	)
+{
+	out_len = 0;
+	if ((nullptr == in || nullptr == out) && 0 != in_len) return false;
+
+	const size_t length = hex_encoded_length(in_len);
+	if (out_size < length)
+	{
+		log_err "output buffer too small. required=%zu, size=%zu", length, out_size log_end;
+		return false;
+	}
+
+	char buffer[4096];
+	for (size_t pos = 0; pos < in_len;)
+	{
+		const size_t count = min(in_len - pos, sizeof(buffer) / 2);
+		encode_bytes(&in[pos], count, upper_case, buffer);
+
+		wchar_t* dst = &out[pos * 2];
+		for (size_t i = 0; i < count * 2; ++i)
+		{
+			dst[i] = (wchar_t)buffer[i];
+		}
+		pos += count;
+	}
+	out_len = length;
+	return true;
+}
+
+/// @brief	out 의 뒤에 인코딩한 문자열을 붙인다.
+bool 
+hex_encode(
+	_In_reads_bytes_(in_len) const uint8_t* in, 
+	_In_ size_t in_len, 
+	_In_ bool upper_case, 
+	_Inout_ std::string& out
+	)
+{
+	if (nullptr == in && 0 != in_len) return false;
+	if (0 == in_len) return true;
+
+	const size_t offset = out.size();
+	out.resize(offset + hex_encoded_length(in_len));
+	encode_bytes(in, in_len, upper_case, &out[offset]);
+	return true;
+}
+
+/// @brief	out 의 뒤에 인코딩한 문자열을 붙인다.
+bool 
+hex_encode(
+	_In_reads_bytes_(in_len) const uint8_t* in, 
+	_In_ size_t in_len, 
+	_In_ bool upper_case, 
+	_Inout_ std::wstring& out
+	)
+{
+	if (nullptr == in && 0 != in_len) return false;
+	if (0 == in_len) return true;
+
+	const size_t offset = out.size();
+	out.resize(offset + hex_encoded_length(in_len));
+
+	size_t out_len = 0;
+	return hex_encode(in, in_len, upper_case, &out[offset], out.size() - offset, out_len);
+}
+
+/// @brief	stream 의 현재 위치에 인코딩한 문자열을 쓴다.
+///			스택 버퍼 (4 KB) 단위로 인코딩해서 스트림에 쓴다.
+bool 
+hex_encode(
+	_In_reads_bytes_(in_len) const uint8_t* in, 
+	_In_ size_t in_len, 
+	_In_ bool upper_case, 
+	_Inout_ CMemoryStream& stream
+	)
+{
+	if (nullptr == in && 0 != in_len) return false;
+
+	char buffer[4096];
+	for (size_t pos = 0; pos < in_len;)
+	{
+		const size_t count = min(in_len - pos, sizeof(buffer) / 2);
+		encode_bytes(&in[pos], count, upper_case, buffer);
+		if (count * 2 != stream.WriteToStream(buffer, count * 2))
+		{
+			log_err "WriteToStream() failed." log_end;
+			return false;
+		}
+		pos += count;
+	}
+	return true;
+}
+
+/// @brief	out 에 디코딩한다. 
+bool 
+hex_decode(
+	_In_reads_(in_len) const char* in, 
+	_In_ size_t in_len, 
+	_Out_writes_bytes_to_(out_size, out_len) uint8_t* out, 
+	_In_ size_t out_size, 
+	_Out_ size_t& out_len
+	)
+{
+	out_len = 0;
+	if ((nullptr == in || nullptr == out) && 0 != in_len) return false;
+	if (0 != in_len % 2) return false;
+
+	const size_t length = in_len / 2;
+	if (out_size < length)
+	{
+		log_err "output buffer too small. required=%zu, size=%zu", length, out_size log_end;
+		return false;
+	}
+
+	if (!decode_chars(in, in_len, out)) return false;
+	out_len = length;
+	return true;
+}
+
+/// @brief	out 에 디코딩한다. 
+///			스택 버퍼 (4 KB) 단위로 char 로 좁혀서 디코딩한다.
+bool 
+hex_decode(
+	_In_reads_(in_len) const wchar_t* in, 
+	_In_ size_t in_len, 
+	_Out_writes_bytes_to_(out_size, out_len) uint8_t* out, 
+	_In_ size_t out_size, 
+	_Out_ size_t& out_len
+	)
+{
+	out_len = 0;
+	if ((nullptr == in || nullptr == out) && 0 != in_len) return false;
+	if (0 != in_len % 2) return false;
+
+	const size_t length = in_len / 2;
+	if (out_size < length)
+	{
+		log_err "output buffer too small. required=%zu, size=%zu", length, out_size log_end;
+		return false;
+	}
+
+	char buffer[4096];
+	for (size_t pos = 0; pos < in_len;)
+	{
+		const size_t count = min(in_len - pos, sizeof(buffer));
+
+		//
+		//	ascii 가 아닌 문자는 0xff 로 바꿔서 디코딩이 실패하게 한다. 
+		//
+		for (size_t i = 0; i < count; ++i)
+		{
+			const wchar_t ch = in[pos + i];
+			buffer[i] = (ch < 0x80) ? (char)ch : (char)0xff;
+		}
+
+		if (!decode_chars(buffer, count, &out[pos / 2])) return false;
+		pos += count;
+	}
+	out_len = length;
+	return true;
+}
+
+
+//
+//	hexdump
+//
+
+/// 헤더 두 줄 (오프셋 컬럼 22 문자 + 바이트 컬럼)
+static const char _hexdump_header[] = 
+	"                      00 01 02 03 04 05 06 07   08 09 0A 0B 0C 0D 0E 0F";
+static const char _hexdump_separator[] = 
+	"                      -- -- -- -- -- -- -- --   -- -- -- -- -- -- -- --";
+
+/// 바이트 -> "XX " (4 번째 문자는 사용하지 않음, 4 바이트 단위로 복사하기 위해)
+typedef struct hexdump_tables
+{
+	hexdump_tables()
+	{
+		for (int i = 0; i < 256; ++i)
+		{
+			cells[i][0] = _upper_digits[i >> 4];
+			cells[i][1] = _upper_digits[i & 0x0f];
+			cells[i][2] = ' ';
+			cells[i][3] = ' ';
+			printable[i] = (i >= 0x20 && i <= 0x7e) ? (char)i : '.';
+		}
+	}
+
+	char cells[256][4];
+	char printable[256];
+} *phexdump_tables;
+
+static const hexdump_tables _hexdump_tables;
+
+/// @brief	offset 과 16 바이트 이하의 데이터를 line 에 포맷하고 길이를 리턴한다. 
+///			line 은 HEXDUMP_LINE_MAX 이상이어야 한다.
+///
+///			"0x" + 오프셋 (16 자리) + 4 칸 + 바이트 8 개 + 2 칸 + 바이트 8 개 + 3 칸 + ascii
+///			없는 바이트는 "   " 로 채운다. (ascii 컬럼은 있는 바이트만)
+static size_t 
+format_hexdump_line(
+	_In_ uint64_t offset, 
+	_In_reads_bytes_(size) const uint8_t* data, 
+	_In_ size_t size, 
+	_Out_writes_(HEXDUMP_LINE_MAX) char* line
+	)
+{
+	_ASSERTE(0 < size && size <= 16);
+
+	char* p = line;
+	*p++ = '0';
+	*p++ = 'x';
+	for (int shift = 60; shift >= 0; shift -= 4)
+	{
+		*p++ = _upper_digits[(offset >> shift) & 0x0f];
+	}
+	memcpy(p, "    ", 4);
+	p += 4;
+
+	//
+	//	"XX " 를 4 바이트씩 복사하고 3 바이트씩 전진한다. 
+	//	(마지막 4 번째 바이트는 다음 셀이나 구분자가 덮어쓴다)
+	//
+	for (size_t i = 0; i < 16; ++i)
+	{
+		if (8 == i)
+		{
+			memcpy(p, "  ", 2);
+			p += 2;
+		}
+
+		if (i < size)
+		{
+			memcpy(p, _hexdump_tables.cells[data[i]], 4);
+		}
+		else
+		{
+			memcpy(p, "    ", 4);
+		}
+		p += 3;
+	}
+
+	memcpy(p, "   ", 3);
+	p += 3;
+	for (size_t i = 0; i < size; ++i)
+	{
+		*p++ = _hexdump_tables.printable[data[i]];
+	}
+
+	_ASSERTE((size_t)(p - line) <= HEXDUMP_LINE_MAX);
+	return (size_t)(p - line);
+}
+
+/// @brief	buf 를 16 바이트씩 덤프해서 sink 로 보낸다. 
+bool 
+hexdump(
+	_In_ uint64_t base_offset,
+	_In_reads_bytes_(size) const uint8_t* buf,
+	_In_ size_t size,
+	_In_ bool header,
+	_In_ const hexdump_sink& sink
+	)
+{
+	_ASSERTE(sink);
+	if (!sink) return false;
+	if (nullptr == buf && 0 != size) return false;
+
+	if (header)
+	{
+		if (!sink(_hexdump_header, sizeof(_hexdump_header) - 1)) return false;
+		if (!sink(_hexdump_separator, sizeof(_hexdump_separator) - 1)) return false;
+	}
+
+	char line[HEXDUMP_LINE_MAX];
+	for (size_t pos = 0; pos < size; pos += 16)
+	{
+		const size_t line_len = format_hexdump_line(base_offset + pos, 
+													&buf[pos], 
+													min(size - pos, (size_t)16), 
+													line);
+		if (!sink(line, line_len)) return false;
+	}
+	return true;
+}
+
+/// @brief	stream 의 현재 위치에 라인마다 '\n' 을 붙여서 쓴다.
+///			스택 버퍼 (8 KB) 에 라인을 모아서 스트림에 쓴다.
+bool 
+hexdump(
+	_In_ uint64_t base_offset,
+	_In_reads_bytes_(size) const uint8_t* buf,
+	_In_ size_t size,
+	_In_ bool header,
+	_Inout_ CMemoryStream& stream
+	)
+{
+	if (nullptr == buf && 0 != size) return false;
+
+	char buffer[8192];
+	size_t used = 0;
+
+	auto flush = [&]() -> bool
+	{
+		if (0 < used && used != stream.WriteToStream(buffer, used))
+		{
+			log_err "WriteToStream() failed." log_end;
+			return false;
+		}
+		used = 0;
+		return true;
+	};
+
+	if (header)
+	{
+		memcpy(&buffer[used], _hexdump_header, sizeof(_hexdump_header) - 1);
+		used += sizeof(_hexdump_header) - 1;
+		buffer[used++] = '\n';
+		memcpy(&buffer[used], _hexdump_separator, sizeof(_hexdump_separator) - 1);
+		used += sizeof(_hexdump_separator) - 1;
+		buffer[used++] = '\n';
+	}
+
+	for (size_t pos = 0; pos < size; pos += 16)
+	{
+		//
+		//	라인 하나 (+ 개행) 가 들어갈 공간이 없으면 먼저 스트림에 쓴다.
+		//
+		if (sizeof(buffer) - used < HEXDUMP_LINE_MAX + 1)
+		{
+			if (!flush()) return false;
+		}
+
+		used += format_hexdump_line(base_offset + pos, 
+									&buf[pos], 
+									min(size - pos, (size_t)16), 
+									&buffer[used]);
+		buffer[used++] = '\n';
+	}
+	return flush();
+}
@@ -0,0 +1,122 @@
+﻿/**
+ * @file    hex_codec.h
+ * @brief   Allocation-free hex encode/decode (scalar/SSSE3/AVX2) and hexdump streaming.
+ *
+ *	- hex_encode/hex_decode 는 호출자 버퍼, std::string (뒤에 붙임), 
+ *	  CMemoryStream 에 바로 쓴다. 중간 버퍼를 할당하지 않는다.
+ *	- SSSE3/AVX2 커널은 nibble 을 pshufb 로 문자 테이블에서 찾는다. 
+ *	  (CPU 에 따라 런타임에 선택)
+ *	- hexdump 는 dump_memory() 와 같은 형식의 라인을 만들어서 sink 콜백이나 
+ *	  CMemoryStream 으로 흘려보낸다. 라인마다 할당하지 않는다.
+ *
+ *	                      00 01 02 03 04 05 06 07   08 09 0A 0B 0C 0D 0E 0F
+ *	                      -- -- -- -- -- -- -- --   -- -- -- -- -- -- -- --
+ *	0x0000000000001000    4D 5A 90 00 03 00 00 00   04 00 00 00 FF FF 00 00    MZ..............
+ *
+ * @author  Yonhgwhan, Roh (somma@somma.kr)
+ * @date    2026/10/18 created.
+ * @copyright (C)Somma, Inc. All rights reserved.
+**/
+#pragma once
+#include <stdint.h>
+#include <string>
+#include <functional>
+
+class CMemoryStream;
+
+#define HEX_IMPL_AUTO		0
+#define HEX_IMPL_SCALAR		1
+#define HEX_IMPL_SSSE3		2
+#define HEX_IMPL_AVX2		3
+
+bool hex_set_impl(int impl);
+int hex_get_impl();
+bool hex_impl_supported(int impl);
+const char* hex_impl_name(int impl);
+
+/// @brief	in_len 바이트를 인코딩한 문자열의 길이 (null 제외)
+inline size_t hex_encoded_length(size_t in_len) { return in_len * 2; }
+
+/// @brief	out 에 인코딩한다. (null 문자를 붙이지 않음)
+///			out_size 가 hex_encoded_length(in_len) 보다 작으면 false
+bool 
+hex_encode(
+	_In_reads_bytes_(in_len) const uint8_t* in, 
+	_In_ size_t in_len, 
+	_In_ bool upper_case,
+	_Out_writes_to_(out_size, out_len) char* out, 
+	_In_ size_t out_size, 
+	_Out_ size_t& out_len
+	);
+
+bool 
+hex_encode(
+	_In_reads_bytes_(in_len) const uint8_t* in, 
+	_In_ size_t in_len, 
+	_In_ bool upper_case,
+	_Out_writes_to_(out_size, out_len) wchar_t* out, 
+	_In_ size_t out_size, 
+	_Out_ size_t& out_len
+	);
+
+/// @brief	out 의 뒤에 인코딩한 문자열을 붙인다. (한번만 resize)
+bool hex_encode(_In_reads_bytes_(in_len) const uint8_t* in, _In_ size_t in_len, _In_ bool upper_case, _Inout_ std::string& out);
+bool hex_encode(_In_reads_bytes_(in_len) const uint8_t* in, _In_ size_t in_len, _In_ bool upper_case, _Inout_ std::wstring& out);
+
+/// @brief	stream 의 현재 위치에 인코딩한 문자열을 쓴다.
+bool hex_encode(_In_reads_bytes_(in_len) const uint8_t* in, _In_ size_t in_len, _In_ bool upper_case, _Inout_ CMemoryStream& stream);
+
+/// @brief	out 에 디코딩한다. 대소문자 모두 허용한다.
+///			길이가 홀수이거나, 16 진수가 아닌 문자가 있거나, out_size 가 
+///			in_len / 2 보다 작으면 false
+bool 
+hex_decode(
+	_In_reads_(in_len) const char* in, 
+	_In_ size_t in_len, 
+	_Out_writes_bytes_to_(out_size, out_len) uint8_t* out, 
+	_In_ size_t out_size, 
+	_Out_ size_t& out_len
+	);
+
+bool 
+hex_decode(
+	_In_reads_(in_len) const wchar_t* in, 
+	_In_ size_t in_len, 
+	_Out_writes_bytes_to_(out_size, out_len) uint8_t* out, 
+	_In_ size_t out_size, 
+	_Out_ size_t& out_len
+	);
+
+
+//
+//	hexdump
+//
+
+/// @brief	라인 하나의 최대 길이 (null, 개행 제외)
+#define HEXDUMP_LINE_MAX	96
+
+/// @brief	라인을 받는 콜백, line 은 null 종료되지 않으며 콜백이 리턴된 후에는 
+///			재사용된다. false 를 리턴하면 덤프를 중지한다.
+typedef std::function<bool(_In_ const char* line, _In_ size_t line_len)> hexdump_sink;
+
+/// @brief	buf 를 16 바이트씩 덤프해서 sink 로 보낸다. 
+///			header 이면 컬럼 헤더 두 줄을 먼저 보낸다. 
+///			sink 가 false 를 리턴하면 false
+bool 
+hexdump(
+	_In_ uint64_t base_offset,
+	_In_reads_bytes_(size) const uint8_t* buf,
+	_In_ size_t size,
+	_In_ bool header,
+	_In_ const hexdump_sink& sink
+	);
+
+/// @brief	stream 의 현재 위치에 라인마다 '\n' 을 붙여서 쓴다.
+bool 
+hexdump(
+	_In_ uint64_t base_offset,
+	_In_reads_bytes_(size) const uint8_t* buf,
+	_In_ size_t size,
+	_In_ bool header,
+	_Inout_ CMemoryStream& stream
+	);
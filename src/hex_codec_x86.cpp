@@ -0,0 +1,167 @@
+﻿/**
+ * @file    hex_codec_x86.cpp
+ * @brief   x86 hex encode/decode kernels (SSSE3, AVX2).
+ *
+ * hex_codec.cpp 에서 CPU 지원 여부에 따라 런타임에 선택된다.
+ * 커널은 처리할 수 있는 만큼만 처리하고 처리한 입력 크기를 리턴하며, 
+ * 나머지 (꼬리) 는 hex_codec.cpp 의 스칼라 코드가 처리한다.
+ *
+ * - encode : 각 바이트의 상/하위 nibble 을 인덱스로 16 문자 테이블을 
+ *            pshufb 로 찾고, unpacklo/hi 로 (상위, 하위) 순서로 섞는다.
+ * - decode : '0'..'9' 와 ('a'..'f' | 0x20) 범위를 unsigned min 으로 검사해서 
+ *            nibble 값을 만들고, maddubs (x16 + x1) 와 packus 로 바이트를 만든다.
+ *
+ * @author  Yonhgwhan, Roh (somma@somma.kr)
+ * @date    2026/10/18 created.
+ * @copyright (C)Somma, Inc. All rights reserved.
+**/
+#include "stdafx.h"
+#include "cpu_features.h"
+
+#if defined(CPU_FEATURES_X86)
+#include <immintrin.h>
+
+/// @brief	16 바이트를 32 문자로 인코딩한다.
+CPU_TARGET("ssse3")
+static inline void enc16_ssse3(const uint8_t* in, const __m128i lut, char* out)
+{
+	const __m128i mask = _mm_set1_epi8(0x0f);
+	const __m128i v = _mm_loadu_si128((const __m128i*)in);
+	const __m128i hi = _mm_shuffle_epi8(lut, _mm_and_si128(_mm_srli_epi16(v, 4), mask));
+	const __m128i lo = _mm_shuffle_epi8(lut, _mm_and_si128(v, mask));
+	_mm_storeu_si128((__m128i*)out, _mm_unpacklo_epi8(hi, lo));
+	_mm_storeu_si128((__m128i*)(out + 16), _mm_unpackhi_epi8(hi, lo));
+}
+
+/// @brief	16 문자를 nibble 값으로 바꾼다. 16 진수가 아닌 문자가 있으면 false
+CPU_TARGET("ssse3")
+static inline bool dec_nibbles_ssse3(const __m128i v, __m128i& nibbles)
+{
+	const __m128i digit = _mm_sub_epi8(v, _mm_set1_epi8('0'));
+	const __m128i is_digit = _mm_cmpeq_epi8(_mm_min_epu8(digit, _mm_set1_epi8(9)), digit);
+	const __m128i alpha = _mm_sub_epi8(_mm_or_si128(v, _mm_set1_epi8(0x20)), _mm_set1_epi8('a'));
+	const __m128i is_alpha = _mm_cmpeq_epi8(_mm_min_epu8(alpha, _mm_set1_epi8(5)), alpha);
+	if (0xffff != _mm_movemask_epi8(_mm_or_si128(is_digit, is_alpha))) return false;
+
+	nibbles = _mm_or_si128(_mm_and_si128(is_digit, digit),
+						   _mm_and_si128(is_alpha, _mm_add_epi8(alpha, _mm_set1_epi8(10))));
+	return true;
+}
+
+/// @brief	nibble 쌍 (상위, 하위) 을 16 비트 값으로 합친다.
+CPU_TARGET("ssse3")
+static inline __m128i dec_combine_ssse3(const __m128i nibbles)
+{
+	return _mm_maddubs_epi16(nibbles, _mm_set1_epi16(0x0110));
+}
+
+CPU_TARGET("ssse3")
+size_t hex_encode_ssse3(const uint8_t* in, size_t in_len, const char* digits, char* out)
+{
+	const __m128i lut = _mm_loadu_si128((const __m128i*)digits);
+
+	size_t done = 0;
+	for (; in_len - done >= 16; done += 16)
+	{
+		enc16_ssse3(&in[done], lut, &out[done * 2]);
+	}
+	return done;
+}
+
+CPU_TARGET("avx2")
+size_t hex_encode_avx2(const uint8_t* in, size_t in_len, const char* digits, char* out)
+{
+	const __m256i lut = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)digits));
+	const __m256i mask = _mm256_set1_epi8(0x0f);
+
+	size_t done = 0;
+	for (; in_len - done >= 32; done += 32)
+	{
+		const __m256i v = _mm256_loadu_si256((const __m256i*)&in[done]);
+		const __m256i hi = _mm256_shuffle_epi8(lut, _mm256_and_si256(_mm256_srli_epi16(v, 4), mask));
+		const __m256i lo = _mm256_shuffle_epi8(lut, _mm256_and_si256(v, mask));
+
+		//
+		//	unpack 은 128 비트 lane 단위로 동작하므로 
+		//	a = (0..7, 16..23), b = (8..15, 24..31) 바이트의 문자가 된다.
+		//
+		const __m256i a = _mm256_unpacklo_epi8(hi, lo);
+		const __m256i b = _mm256_unpackhi_epi8(hi, lo);
+		_mm256_storeu_si256((__m256i*)&out[done * 2], _mm256_permute2x128_si256(a, b, 0x20));
+		_mm256_storeu_si256((__m256i*)&out[done * 2 + 32], _mm256_permute2x128_si256(a, b, 0x31));
+	}
+
+	if (in_len - done >= 16)
+	{
+		enc16_ssse3(&in[done], _mm256_castsi256_si128(lut), &out[done * 2]);
+		done += 16;
+	}
+	return done;
+}
+
+CPU_TARGET("ssse3")
+size_t hex_decode_ssse3(const char* in, size_t in_len, uint8_t* out, bool& valid)
+{
+	valid = true;
+	size_t done = 0;
+	for (; in_len - done >= 32; done += 32)
+	{
+		__m128i n0, n1;
+		if (!dec_nibbles_ssse3(_mm_loadu_si128((const __m128i*)&in[done]), n0) ||
+			!dec_nibbles_ssse3(_mm_loadu_si128((const __m128i*)&in[done + 16]), n1))
+		{
+			valid = false;
+			break;
+		}
+
+		_mm_storeu_si128((__m128i*)&out[done / 2], 
+						 _mm_packus_epi16(dec_combine_ssse3(n0), dec_combine_ssse3(n1)));
+	}
+	return done;
+}
+
+CPU_TARGET("avx2")
+size_t hex_decode_avx2(const char* in, size_t in_len, uint8_t* out, bool& valid)
+{
+	const __m256i zero_digit = _mm256_set1_epi8('0');
+	const __m256i nine = _mm256_set1_epi8(9);
+	const __m256i case_bit = _mm256_set1_epi8(0x20);
+	const __m256i lower_a = _mm256_set1_epi8('a');
+	const __m256i five = _mm256_set1_epi8(5);
+	const __m256i ten = _mm256_set1_epi8(10);
+	const __m256i weights = _mm256_set1_epi16(0x0110);
+
+	valid = true;
+	size_t done = 0;
+	for (; in_len - done >= 64; done += 64)
+	{
+		__m256i values[2];
+		for (int i = 0; i < 2; ++i)
+		{
+			const __m256i v = _mm256_loadu_si256((const __m256i*)&in[done + i * 32]);
+			const __m256i digit = _mm256_sub_epi8(v, zero_digit);
+			const __m256i is_digit = _mm256_cmpeq_epi8(_mm256_min_epu8(digit, nine), digit);
+			const __m256i alpha = _mm256_sub_epi8(_mm256_or_si256(v, case_bit), lower_a);
+			const __m256i is_alpha = _mm256_cmpeq_epi8(_mm256_min_epu8(alpha, five), alpha);
+			if (-1 != _mm256_movemask_epi8(_mm256_or_si256(is_digit, is_alpha)))
+			{
+				valid = false;
+				return done;
+			}
+
+			const __m256i nibbles = _mm256_or_si256(_mm256_and_si256(is_digit, digit),
+													_mm256_and_si256(is_alpha, _mm256_add_epi8(alpha, ten)));
+			values[i] = _mm256_maddubs_epi16(nibbles, weights);
+		}
+
+		//
+		//	packus 도 lane 단위이므로 64 비트 단위로 순서를 바로 잡는다.
+		//
+		const __m256i packed = _mm256_packus_epi16(values[0], values[1]);
+		_mm256_storeu_si256((__m256i*)&out[done / 2], _mm256_permute4x64_epi64(packed, 0xd8));
+	}
+
+	return done + hex_decode_ssse3(&in[done], in_len - done, &out[done / 2], valid);
+}
+
+#endif//CPU_FEATURES_X86
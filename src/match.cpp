@@ -5,19 +5,25 @@
 //              https://www.codeproject.com/info/cpol10.aspx
 #include "stdafx.h"
 #include "_MyLib/src/match.h"
+#include "_MyLib/src/case_fold.h"
+#include "_MyLib/src/cpu_features.h"
 #include <iostream>
 #include <string>
 #include <cctype>
+#include <map>
+#include <queue>
+#include <algorithm>
+#include <atomic>
+#include <string_view>
+#include <string.h>
 
 using namespace std;
 
 // returns true if text string matches wild pattern with * and ?
-bool match_string(const string& text, const string& wild)
+static bool wildcard_match(const char* text, size_t n, const char* wild, size_t m)
 {
 	size_t i = 0;
 	size_t j = 0;
-	size_t n = text.size();
-	size_t m = wild.size();
 	size_t text_backup = string::npos;
 	size_t wild_backup = string::npos;
 	while (i < n)
@@ -51,16 +57,35 @@ bool match_string(const string& text, const string& wild)
 	return j >= m;
 }
 
+// match character class [...] at glob[j] against c, j is left at the closing ] (or m)
+template <class Case>
+static bool match_class(int c, const char* glob, size_t m, size_t& j)
+{
+	int lastchr;
+	bool matched = false;
+	bool reverse = j + 1 < m && (glob[j + 1] == '^' || glob[j + 1] == '!');
+	// inverted character class
+	if (reverse)
+		j++;
+	// match character class
+	for (lastchr = 256; ++j < m && glob[j] != ']'; lastchr = Case::fold(glob[j]))
+		if (lastchr < 256 && glob[j] == '-' && j + 1 < m && glob[j + 1] != ']' ?
+			c <= Case::fold(glob[++j]) && c >= lastchr :
+			c == Case::fold(glob[j]))
+			matched = true;
+	return matched != reverse;
+}
+
 // returns TRUE if text string matches glob pattern with * and ?
-bool glob_match_string(const string& text, const string& glob)
+template <class Case, class Sep, class Dot>
+bool basic_glob_match(const char* text, size_t n, const char* glob, size_t m)
 {
+	const char sep = Sep::value;
 	size_t i = 0;
 	size_t j = 0;
-	size_t n = text.size();
-	size_t m = glob.size();
 	size_t text_backup = string::npos;
 	size_t glob_backup = string::npos;
-	bool nodot = !DOTGLOB;
+	bool nodot = !Dot::dotglob;
 	while (i < n)
 	{
 		if (j < m)
@@ -80,38 +105,24 @@ bool glob_match_string(const string& text, const string& glob)
 				if (nodot && text[i] == '.')
 					break;
 				// match any character except /
-				if (text[i] == PATHSEP)
+				if (text[i] == sep)
 					break;
 				i++;
 				j++;
 				continue;
 			case '[':
-			{
 				// match anything except . after /
 				if (nodot && text[i] == '.')
 					break;
 				// match any character in [...] except /
-				if (text[i] == PATHSEP)
+				if (text[i] == sep)
 					break;
-				int lastchr;
-				bool matched = false;
-				bool reverse = j + 1 < m && (glob[j + 1] == '^' || glob[j + 1] == '!');
-				// inverted character class
-				if (reverse)
-					j++;
-				// match character class
-				for (lastchr = 256; ++j < m && glob[j] != ']'; lastchr = CASE(glob[j]))
-					if (lastchr < 256 && glob[j] == '-' && j + 1 < m && glob[j + 1] != ']' ?
-						CASE(text[i]) <= CASE(glob[++j]) && CASE(text[i]) >= lastchr :
-						CASE(text[i]) == CASE(glob[j]))
-						matched = true;
-				if (matched == reverse)
+				if (!match_class<Case>(Case::fold(text[i]), glob, m, j))
 					break;
 				i++;
 				if (j < m)
 					j++;
 				continue;
-			}
 			case '\\':
 				// literal match \-escaped character
 				if (j + 1 < m)
@@ -119,16 +130,16 @@ bool glob_match_string(const string& text, const string& glob)
 				// FALLTHROUGH
 			default:
 				// match the current non-NUL character
-				if (CASE(glob[j]) != CASE(text[i]) && !(glob[j] == '/' && text[i] == PATHSEP))
+				if (Case::fold(glob[j]) != Case::fold(text[i]) && !(glob[j] == '/' && text[i] == sep))
 					break;
 				// do not match a . with *, ? [] after /
-				nodot = !DOTGLOB && glob[j] == '/';
+				nodot = !Dot::dotglob && glob[j] == '/';
 				i++;
 				j++;
 				continue;
 			}
 		}
-		if (glob_backup == string::npos || text[text_backup] == PATHSEP)
+		if (glob_backup == string::npos || text[text_backup] == sep)
 			return false;
 		// star-loop: backtrack to the last * but do not jump over /
 		i = ++text_backup;
@@ -142,33 +153,33 @@ bool glob_match_string(const string& text, const string& glob)
 }
 
 // returns TRUE if text string matches gitignore-style glob pattern
-bool gitignore_glob_match_string(const string& text, const string& glob)
+template <class Case, class Sep, class Dot>
+bool basic_gitignore_glob_match(const char* text, size_t n, const char* glob, size_t m)
 {
+	const char sep = Sep::value;
 	size_t i = 0;
 	size_t j = 0;
-	size_t n = text.size();
-	size_t m = glob.size();
 	size_t text1_backup = string::npos;
 	size_t glob1_backup = string::npos;
 	size_t text2_backup = string::npos;
 	size_t glob2_backup = string::npos;
-	bool nodot = !DOTGLOB;
+	bool nodot = !Dot::dotglob;
 	// match pathname if glob contains a / otherwise match the basename
 	if (j + 1 < m && glob[j] == '/')
 	{
 		// if pathname starts with ./ then ignore these pairs
-		while (i + 1 < n && text[i] == '.' && text[i + 1] == PATHSEP)
+		while (i + 1 < n && text[i] == '.' && text[i + 1] == sep)
 			i += 2;
 		// if pathname starts with a / then ignore it
-		if (i < n && text[i] == PATHSEP)
+		if (i < n && text[i] == sep)
 			i++;
 		j++;
 	}
-	else if (glob.find('/') == string::npos)
+	else if (m == 0 || memchr(glob, '/', m) == nullptr)
 	{
-		size_t sep = text.rfind(PATHSEP);
-		if (sep != string::npos)
-			i = sep + 1;
+		size_t sep_pos = string_view(text, n).rfind(sep);
+		if (sep_pos != string::npos)
+			i = sep_pos + 1;
 	}
 	while (i < n)
 	{
@@ -204,38 +215,24 @@ bool gitignore_glob_match_string(const string& text, const string& glob)
 				if (nodot && text[i] == '.')
 					break;
 				// match any character except /
-				if (text[i] == PATHSEP)
+				if (text[i] == sep)
 					break;
 				i++;
 				j++;
 				continue;
 			case '[':
-			{
 				// match anything except . after /
 				if (nodot && text[i] == '.')
 					break;
 				// match any character in [...] except /
-				if (text[i] == PATHSEP)
+				if (text[i] == sep)
 					break;
-				int lastchr;
-				bool matched = false;
-				bool reverse = j + 1 < m && (glob[j + 1] == '^' || glob[j + 1] == '!');
-				// inverted character class
-				if (reverse)
-					j++;
-				// match character class
-				for (lastchr = 256; ++j < m && glob[j] != ']'; lastchr = CASE(glob[j]))
-					if (lastchr < 256 && glob[j] == '-' && j + 1 < m && glob[j + 1] != ']' ?
-						CASE(text[i]) <= CASE(glob[++j]) && CASE(text[i]) >= lastchr :
-						CASE(text[i]) == CASE(glob[j]))
-						matched = true;
-				if (matched == reverse)
+				if (!match_class<Case>(Case::fold(text[i]), glob, m, j))
 					break;
 				i++;
 				if (j < m)
 					j++;
 				continue;
-			}
 			case '\\':
 				// literal match \-escaped character
 				if (j + 1 < m)
@@ -243,16 +240,16 @@ bool gitignore_glob_match_string(const string& text, const string& glob)
 				// FALLTHROUGH
 			default:
 				// match the current non-NUL character
-				if (CASE(glob[j]) != CASE(text[i]) && !(glob[j] == '/' && text[i] == PATHSEP))
+				if (Case::fold(glob[j]) != Case::fold(text[i]) && !(glob[j] == '/' && text[i] == sep))
 					break;
 				// do not match a . with *, ? [] after /
-				nodot = !DOTGLOB && glob[j] == '/';
+				nodot = !Dot::dotglob && glob[j] == '/';
 				i++;
 				j++;
 				continue;
 			}
 		}
-		if (glob1_backup != string::npos && text[text1_backup] != PATHSEP)
+		if (glob1_backup != string::npos && text[text1_backup] != sep)
 		{
 			// *-loop: backtrack to the last * but do not jump over /
 			i = ++text1_backup;
@@ -275,6 +272,676 @@ bool gitignore_glob_match_string(const string& text, const string& glob)
 	return j >= m;
 }
 
+//
+//	정책 조합마다 명시적으로 인스턴스화한다. 
+//	(대소문자 2 x 구분자 2 x dot 2) x (glob, gitignore)
+//
+#define GLOB_INSTANTIATE(CASE_POLICY, SEP, DOT) \
+	template bool basic_glob_match<CASE_POLICY, glob_separator<SEP>, glob_dot<DOT>>(const char*, size_t, const char*, size_t); \
+	template bool basic_gitignore_glob_match<CASE_POLICY, glob_separator<SEP>, glob_dot<DOT>>(const char*, size_t, const char*, size_t);
+
+GLOB_INSTANTIATE(glob_case_sensitive, '\\', true)
+GLOB_INSTANTIATE(glob_case_sensitive, '\\', false)
+GLOB_INSTANTIATE(glob_case_sensitive, '/', true)
+GLOB_INSTANTIATE(glob_case_sensitive, '/', false)
+GLOB_INSTANTIATE(glob_case_insensitive, '\\', true)
+GLOB_INSTANTIATE(glob_case_insensitive, '\\', false)
+GLOB_INSTANTIATE(glob_case_insensitive, '/', true)
+GLOB_INSTANTIATE(glob_case_insensitive, '/', false)
+
+#undef GLOB_INSTANTIATE
+
+bool match_string(const string& text, const string& wild)
+{
+	return wildcard_match(text.data(), text.size(), wild.data(), wild.size());
+}
+
+bool glob_match_string(const string& text, const string& glob)
+{
+	return basic_glob_match<glob_default_case, glob_default_sep, glob_default_dot>(
+		text.data(), text.size(), glob.data(), glob.size());
+}
+
+bool gitignore_glob_match_string(const string& text, const string& glob)
+{
+	return basic_gitignore_glob_match<glob_default_case, glob_default_sep, glob_default_dot>(
+		text.data(), text.size(), glob.data(), glob.size());
+}
+
+//
+//	[syntax][case_insensitive][separator == '/'][dotglob]
+//
+#define GLOB_MATCHERS(MATCHER) \
+	{ \
+		{ \
+			{ MATCHER<glob_case_sensitive, glob_separator<'\\'>, glob_dot<false>>, MATCHER<glob_case_sensitive, glob_separator<'\\'>, glob_dot<true>> }, \
+			{ MATCHER<glob_case_sensitive, glob_separator<'/'>, glob_dot<false>>, MATCHER<glob_case_sensitive, glob_separator<'/'>, glob_dot<true>> } \
+		}, \
+		{ \
+			{ MATCHER<glob_case_insensitive, glob_separator<'\\'>, glob_dot<false>>, MATCHER<glob_case_insensitive, glob_separator<'\\'>, glob_dot<true>> }, \
+			{ MATCHER<glob_case_insensitive, glob_separator<'/'>, glob_dot<false>>, MATCHER<glob_case_insensitive, glob_separator<'/'>, glob_dot<true>> } \
+		} \
+	}
+
+static const glob_match_fn _glob_matchers[2][2][2][2] = {
+	GLOB_MATCHERS(basic_glob_match),
+	GLOB_MATCHERS(basic_gitignore_glob_match)
+};
+
+#undef GLOB_MATCHERS
+
+/// @brief	options 에 맞게 특수화된 매치 함수를 리턴한다. 
+///			구분자가 '\\', '/' 가 아니면 nullptr 을 리턴한다.
+glob_match_fn get_glob_matcher(glob_syntax syntax, const glob_options& options)
+{
+	if (syntax == glob_syntax::wildcard)
+		return wildcard_match;
+
+	if (options.separator != '\\' && options.separator != '/')
+		return nullptr;
+
+	return _glob_matchers[syntax == glob_syntax::gitignore ? 1 : 0]
+						 [options.case_insensitive ? 1 : 0]
+						 [options.separator == '/' ? 1 : 0]
+						 [options.dotglob ? 1 : 0];
+}
+
+static const uint32_t _no_state = 0xffffffff;
+
+/// @brief	패턴에서 뽑아낸 리터럴과 길이 정보
+struct pattern_literals
+{
+	pattern_literals() : prefix(false), suffix(false), min_length(0), has_star(false) {}
+
+	vector<string> runs;	///< 순서대로 나와야 하는 리터럴
+	bool prefix;			///< runs[0] 이 패턴의 시작에 있다.
+	bool suffix;			///< runs 의 마지막이 패턴의 끝에 있다.
+	size_t min_length;		///< 매치되는 텍스트의 최소 길이
+	bool has_star;
+};
+
+/// @brief	pattern 에 매치되는 텍스트에 반드시 들어있는 리터럴들을 구한다.
+///			(매치 함수들이 패턴을 읽는 방식을 그대로 따른다)
+///
+///			*, ?, [...] 와 / (텍스트의 구분자에도 매치된다) 에서 리터럴이 끊긴다. 
+static pattern_literals scan_pattern(glob_syntax syntax, const string& pattern, const glob_options& options)
+{
+	pattern_literals info;
+	string run;
+	bool leading = true;
+	auto flush = [&]()
+	{
+		if (!run.empty())
+		{
+			if (leading)
+				info.prefix = true;
+			info.runs.push_back(run);
+			info.min_length += run.size();
+		}
+		run.clear();
+		leading = false;
+	};
+
+	const size_t m = pattern.size();
+	for (size_t j = 0; j < m; ++j)
+	{
+		char c = pattern[j];
+		if (c == '*' || c == '?')
+		{
+			flush();
+			if (c == '*')
+				info.has_star = true;
+			else
+				info.min_length++;
+			continue;
+		}
+		if (syntax == glob_syntax::wildcard)
+		{
+			run += c;
+			continue;
+		}
+
+		if (c == '[')
+		{
+			flush();
+			info.min_length++;
+			bool reverse = j + 1 < m && (pattern[j + 1] == '^' || pattern[j + 1] == '!');
+			if (reverse)
+				j++;
+			for (int lastchr = 256; ++j < m && pattern[j] != ']'; lastchr = pattern[j])
+				if (lastchr < 256 && pattern[j] == '-' && j + 1 < m && pattern[j + 1] != ']')
+					j++;
+			// j 는 ']' (또는 m), 다음 루프에서 그 다음 문자부터
+			continue;
+		}
+		if (c == '\\' && j + 1 < m)
+			c = pattern[++j];
+		if (c == '/' && (options.separator != '/' || syntax == glob_syntax::gitignore))
+		{
+			flush();
+			// gitignore 는 앞의 / 와 **/ 의 / 가 텍스트에 없을 수 있다.
+			if (syntax != glob_syntax::gitignore)
+				info.min_length++;
+			continue;
+		}
+		run += options.case_insensitive ? (char)glob_case_insensitive::fold(c) : c;
+	}
+
+	const bool trailing = !run.empty();
+	flush();
+	info.suffix = trailing;
+
+	// gitignore 는 텍스트의 앞 (./, /, basename 이전) 을 건너뛸 수 있다.
+	if (syntax == glob_syntax::gitignore)
+		info.prefix = false;
+	return info;
+}
+
+
+//
+//	리터럴 검색 커널
+//
+//	find_pair8 : [0, positions) 중 s[i] == first && s[i + gap] == last 인 
+//	             첫번째 i, 없으면 positions
+//
+typedef size_t (*find_pair8_fn)(const uint8_t* s, size_t positions, size_t gap, uint8_t first, uint8_t last);
+
+#if defined(CPU_FEATURES_X86)
+size_t match_find_pair8_sse2(const uint8_t* s, size_t positions, size_t gap, uint8_t first, uint8_t last);
+size_t match_find_pair8_avx2(const uint8_t* s, size_t positions, size_t gap, uint8_t first, uint8_t last);
+#endif
+
+/// @brief	첫 바이트는 memchr (CRT 구현이 벡터화되어 있음) 로 찾는다.
+static size_t find_pair8_scalar(const uint8_t* s, size_t positions, size_t gap, uint8_t first, uint8_t last)
+{
+	size_t i = 0;
+	while (i < positions)
+	{
+		const uint8_t* found = (const uint8_t*)memchr(&s[i], first, positions - i);
+		if (found == nullptr)
+			break;
+		i = (size_t)(found - s);
+		if (s[i + gap] == last)
+			return i;
+		++i;
+	}
+	return positions;
+}
+
+typedef struct match_kernels
+{
+	int impl;
+	find_pair8_fn find_pair8;
+} *pmatch_kernels;
+
+static const match_kernels _kernels_scalar = {
+	MATCH_IMPL_SCALAR,
+	find_pair8_scalar
+};
+#if defined(CPU_FEATURES_X86)
+static const match_kernels _kernels_sse2 = {
+	MATCH_IMPL_SSE2,
+	match_find_pair8_sse2
+};
+static const match_kernels _kernels_avx2 = {
+	MATCH_IMPL_AVX2,
+	match_find_pair8_avx2
+};
+#endif
+
+static const match_kernels* match_impl_kernels(int impl)
+{
+	switch (impl)
+	{
+	case MATCH_IMPL_SCALAR:
+		return &_kernels_scalar;
+#if defined(CPU_FEATURES_X86)
+	case MATCH_IMPL_SSE2:
+		return get_cpu_features().sse2 ? &_kernels_sse2 : nullptr;
+	case MATCH_IMPL_AVX2:
+		return get_cpu_features().avx2 ? &_kernels_avx2 : nullptr;
+#endif
+	}
+	return nullptr;
+}
+
+static int match_best_impl()
+{
+	if (nullptr != match_impl_kernels(MATCH_IMPL_AVX2)) return MATCH_IMPL_AVX2;
+	if (nullptr != match_impl_kernels(MATCH_IMPL_SSE2)) return MATCH_IMPL_SSE2;
+	return MATCH_IMPL_SCALAR;
+}
+
+static atomic<const match_kernels*> _kernels(nullptr);
+
+static const match_kernels* match_get_kernels()
+{
+	const match_kernels* kernels = _kernels.load(memory_order_relaxed);
+	if (nullptr == kernels)
+	{
+		kernels = match_impl_kernels(match_best_impl());
+		_kernels.store(kernels, memory_order_relaxed);
+	}
+	return kernels;
+}
+
+/// @brief	glob_pattern 의 리터럴 검색이 사용할 구현을 선택한다.
+///			MATCH_IMPL_AUTO 는 CPU 가 지원하는 가장 빠른 구현을 선택한다.
+bool match_set_impl(int impl)
+{
+	if (MATCH_IMPL_AUTO == impl)
+	{
+		impl = match_best_impl();
+	}
+
+	const match_kernels* kernels = match_impl_kernels(impl);
+	if (nullptr == kernels) return false;
+
+	_kernels.store(kernels, memory_order_relaxed);
+	return true;
+}
+
+int match_get_impl()
+{
+	return match_get_kernels()->impl;
+}
+
+bool match_impl_supported(int impl)
+{
+	return (MATCH_IMPL_AUTO == impl || nullptr != match_impl_kernels(impl));
+}
+
+const char* match_impl_name(int impl)
+{
+	switch (impl)
+	{
+	case MATCH_IMPL_AUTO: return "auto";
+	case MATCH_IMPL_SCALAR: return "scalar";
+	case MATCH_IMPL_SSE2: return "sse2";
+	case MATCH_IMPL_AVX2: return "avx2";
+	}
+	return "unknown";
+}
+
+/// @brief	s 에서 needle 이 처음 나타나는 위치, 없으면 string::npos
+///			첫/마지막 바이트가 같은 위치를 커널로 찾고, 나머지만 비교한다.
+static size_t find_literal(const match_kernels* kernels, const char* s, size_t n, const string& needle)
+{
+	const size_t m = needle.size();
+	if (m > n)
+		return string::npos;
+
+	const uint8_t* str = (const uint8_t*)s;
+	const uint8_t* nd = (const uint8_t*)needle.data();
+	const size_t positions = n - m + 1;
+	const size_t gap = m - 1;
+
+	size_t i = 0;
+	while (i < positions)
+	{
+		i += kernels->find_pair8(&str[i], positions - i, gap, nd[0], nd[gap]);
+		if (i >= positions)
+			break;
+		if (m <= 2 || 0 == memcmp(&str[i + 1], &nd[1], m - 2))
+			return i;
+		++i;
+	}
+	return string::npos;
+}
+
+
+glob_pattern::glob_pattern() :
+	_syntax(glob_syntax::wildcard),
+	_matcher(nullptr),
+	_min_length(0),
+	_max_length(0),
+	_case_insensitive(false),
+	_has_prefix(false),
+	_has_suffix(false)
+{
+}
+
+glob_pattern::glob_pattern(glob_syntax syntax, const string& pattern, const glob_options& options) : glob_pattern()
+{
+	assign(syntax, pattern, options);
+}
+
+/// @brief	패턴을 바꾸고 리터럴 앵커를 다시 뽑는다.
+void glob_pattern::assign(glob_syntax syntax, const string& pattern, const glob_options& options)
+{
+	_syntax = syntax;
+	_options = options;
+	_pattern = pattern;
+	_matcher = get_glob_matcher(syntax, options);
+
+	pattern_literals info = scan_pattern(syntax, pattern, options);
+	_anchors.swap(info.runs);
+	_has_prefix = info.prefix;
+	_has_suffix = info.suffix;
+	_min_length = info.min_length;
+
+	// * 가 없으면 패턴의 항목마다 텍스트의 한 문자에 매치된다.
+	_max_length = (info.has_star || syntax == glob_syntax::gitignore) ? string::npos : info.min_length;
+	_case_insensitive = (syntax != glob_syntax::wildcard) && options.case_insensitive;
+
+	// 리터럴 하나가 접두어이면서 접미어이면 텍스트 전체이므로 접두어로만 확인한다.
+	if (_anchors.size() == 1 && _has_prefix)
+		_has_suffix = false;
+}
+
+bool glob_pattern::prefilter(const char* text, size_t length) const
+{
+	if (length < _min_length || length > _max_length)
+		return false;
+	if (_anchors.empty())
+		return true;
+
+	size_t begin = 0;
+	size_t end = length;
+	size_t first = 0;
+	size_t last = _anchors.size();
+	const string_view view(text, length);
+
+	if (_has_prefix)
+	{
+		const string& prefix = _anchors[0];
+		if (_case_insensitive ? !starts_with_ci(view, prefix) : 0 != view.compare(0, prefix.size(), prefix))
+			return false;
+		begin = prefix.size();
+		first = 1;
+	}
+	if (_has_suffix)
+	{
+		const string& suffix = _anchors[last - 1];
+		if (end - begin < suffix.size())
+			return false;
+		if (_case_insensitive ? !ends_with_ci(view, suffix) : 0 != view.compare(end - suffix.size(), suffix.size(), suffix))
+			return false;
+		end -= suffix.size();
+		last--;
+	}
+
+	const match_kernels* kernels = match_get_kernels();
+	for (size_t k = first; k < last; ++k)
+	{
+		const string& anchor = _anchors[k];
+		const size_t pos = _case_insensitive ?
+			find_ci(view.substr(0, end), anchor, begin) :
+			find_literal(kernels, &text[begin], end - begin, anchor);
+		if (pos == string::npos)
+			return false;
+		begin = (_case_insensitive ? pos : begin + pos) + anchor.size();
+	}
+	return true;
+}
+
+bool glob_pattern::match(const string& text) const
+{
+	_ASSERTE(nullptr != _matcher);
+	if (nullptr == _matcher || !prefilter(text.data(), text.size()))
+		return false;
+
+	return _matcher(text.data(), text.size(), _pattern.data(), _pattern.size());
+}
+
+glob_set::glob_set(glob_syntax syntax, const glob_options& options) :
+	_syntax(syntax),
+	_options(options),
+	_compiled(false)
+{
+	const bool fold = (syntax != glob_syntax::wildcard) && options.case_insensitive;
+	for (int c = 0; c < 256; ++c)
+		_fold[c] = fold ? (unsigned char)glob_case_insensitive::fold((char)c) : (unsigned char)c;
+}
+
+bool glob_set::add(const string& pattern)
+{
+	_ASSERTE(!_compiled);
+	if (_compiled)
+		return false;
+
+	_patterns.push_back(glob_pattern(_syntax, pattern, _options));
+	return true;
+}
+
+/// @brief	패턴마다 리터럴을 뽑아서 Aho-Corasick 오토마톤을 만든다.
+bool glob_set::compile()
+{
+	_ASSERTE(!_compiled);
+	if (_compiled)
+		return false;
+
+	//
+	//	패턴마다 리터럴 하나를 고른다. 여러 패턴에 공통인 리터럴 ("system32", 
+	//	".exe") 을 고르면 후보가 많아지므로, 리터럴을 가진 패턴 수가 가장 적은
+	//	것을 (같으면 긴 것을) 고른다. 텍스트에 흔히 나오는 짧은 리터럴 (1, 2 
+	//	문자) 은 다른 리터럴이 없을 때만 고른다.
+	//
+	vector<vector<string>> candidates(_patterns.size());
+	map<string, uint32_t> frequency;
+	for (size_t id = 0; id < _patterns.size(); ++id)
+	{
+		candidates[id] = scan_pattern(_syntax, _patterns[id].pattern(), _options).runs;
+		sort(candidates[id].begin(), candidates[id].end());
+		candidates[id].erase(unique(candidates[id].begin(), candidates[id].end()), candidates[id].end());
+		for (const auto& literal : candidates[id])
+			++frequency[literal];
+	}
+
+	//
+	//	trie (간선은 일단 상태마다 map 으로 만든다)
+	//
+	vector<map<unsigned char, uint32_t>> children(1);
+	vector<vector<uint32_t>> outputs(1);
+	for (uint32_t id = 0; id < (uint32_t)_patterns.size(); ++id)
+	{
+		const string* best = nullptr;
+		for (const auto& literal : candidates[id])
+		{
+			if (best == nullptr)
+			{
+				best = &literal;
+				continue;
+			}
+
+			const bool short_literal = literal.size() < 3;
+			const bool short_best = best->size() < 3;
+			if (short_literal != short_best)
+			{
+				if (short_best)
+					best = &literal;
+				continue;
+			}
+			if (frequency[literal] < frequency[*best] ||
+				(frequency[literal] == frequency[*best] && literal.size() > best->size()))
+				best = &literal;
+		}
+		if (best == nullptr)
+		{
+			_always.push_back(id);
+			continue;
+		}
+
+		uint32_t state = 0;
+		for (char c : *best)
+		{
+			auto it = children[state].find((unsigned char)c);
+			if (it == children[state].end())
+			{
+				const uint32_t next = (uint32_t)children.size();
+				children[state][(unsigned char)c] = next;
+				children.emplace_back();
+				outputs.emplace_back();
+				state = next;
+			}
+			else
+			{
+				state = it->second;
+			}
+		}
+		outputs[state].push_back(id);
+	}
+
+	const uint32_t state_count = (uint32_t)children.size();
+	_edge_begin.assign(state_count + 1, 0);
+	_edge_char.clear();
+	_edge_next.clear();
+	_out_begin.assign(state_count + 1, 0);
+	_out_ids.clear();
+	for (uint32_t state = 0; state < state_count; ++state)
+	{
+		_edge_begin[state] = (uint32_t)_edge_char.size();
+		for (const auto& edge : children[state])
+		{
+			_edge_char.push_back(edge.first);
+			_edge_next.push_back(edge.second);
+		}
+		_out_begin[state] = (uint32_t)_out_ids.size();
+		_out_ids.insert(_out_ids.end(), outputs[state].begin(), outputs[state].end());
+	}
+	_edge_begin[state_count] = (uint32_t)_edge_char.size();
+	_out_begin[state_count] = (uint32_t)_out_ids.size();
+
+	_root.assign(256, 0);
+	for (const auto& edge : children[0])
+		_root[edge.first] = edge.second;
+
+	//
+	//	실패 링크와 출력 링크를 BFS 로 구한다.
+	//
+	_fail.assign(state_count, 0);
+	_dict.assign(state_count, 0);
+	queue<uint32_t> pending;
+	for (const auto& edge : children[0])
+		pending.push(edge.second);
+
+	while (!pending.empty())
+	{
+		const uint32_t state = pending.front();
+		pending.pop();
+
+		for (const auto& edge : children[state])
+		{
+			const uint32_t next = edge.second;
+			uint32_t f = _fail[state];
+			for (;;)
+			{
+				if (f == 0)
+				{
+					f = _root[edge.first];
+					break;
+				}
+				auto it = children[f].find(edge.first);
+				if (it != children[f].end())
+				{
+					f = it->second;
+					break;
+				}
+				f = _fail[f];
+			}
+			_fail[next] = f;
+			_dict[next] = (_out_begin[f] != _out_begin[f + 1]) ? f : _dict[f];
+			pending.push(next);
+		}
+	}
+
+	_compiled = true;
+	return true;
+}
+
+bool glob_set::match_one(uint32_t id, const string& text) const
+{
+	return _patterns[id].match(text);
+}
+
+/// @brief	text 를 한번 훑으면서 리터럴이 나온 패턴과 리터럴이 없는 패턴을 
+///			candidates 에 넣는다. (정렬, 중복 제거)
+void glob_set::collect(const string& text, vector<uint32_t>& candidates) const
+{
+	candidates.assign(_always.begin(), _always.end());
+	if (_edge_begin.size() > 2)
+	{
+		uint32_t state = 0;
+		for (char ch : text)
+		{
+			const unsigned char c = _fold[(unsigned char)ch];
+			for (;;)
+			{
+				if (state == 0)
+				{
+					state = _root[c];
+					break;
+				}
+
+				uint32_t next = _no_state;
+				for (uint32_t e = _edge_begin[state]; e < _edge_begin[state + 1]; ++e)
+				{
+					if (_edge_char[e] == c)
+					{
+						next = _edge_next[e];
+						break;
+					}
+				}
+				if (next != _no_state)
+				{
+					state = next;
+					break;
+				}
+				state = _fail[state];
+			}
+
+			for (uint32_t s = (_out_begin[state] != _out_begin[state + 1]) ? state : _dict[state];
+				 s != 0;
+				 s = _dict[s])
+			{
+				candidates.insert(candidates.end(),
+								  _out_ids.begin() + _out_begin[s],
+								  _out_ids.begin() + _out_begin[s + 1]);
+			}
+		}
+	}
+
+	sort(candidates.begin(), candidates.end());
+	candidates.erase(unique(candidates.begin(), candidates.end()), candidates.end());
+}
+
+size_t glob_set::match_all(const string& text, vector<uint32_t>& ids) const
+{
+	_ASSERTE(_compiled);
+	ids.clear();
+	if (!_compiled)
+		return 0;
+
+	collect(text, ids);
+	size_t count = 0;
+	for (uint32_t id : ids)
+	{
+		if (match_one(id, text))
+			ids[count++] = id;
+	}
+	ids.resize(count);
+	return count;
+}
+
+bool glob_set::match_first(const string& text, uint32_t& id) const
+{
+	_ASSERTE(_compiled);
+	if (!_compiled)
+		return false;
+
+	static thread_local vector<uint32_t> candidates;
+	collect(text, candidates);
+	for (uint32_t candidate : candidates)
+	{
+		if (match_one(candidate, text))
+		{
+			id = candidate;
+			return true;
+		}
+	}
+	return false;
+}
+
 //int main(int argc, char **argv)
 //{
 //  if (argc > 2)
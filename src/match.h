@@ -4,7 +4,17 @@
 // License:     The Code Project Open License (CPOL)
 //              https://www.codeproject.com/info/cpol10.aspx
 #pragma once
+#include <stdint.h>
 #include <string>
+#include <vector>
+#include <type_traits>
+
+//
+//	아래 세 매크로는 match_string(), glob_match_string(), 
+//	gitignore_glob_match_string() 과 glob_options 의 기본값이다. 
+//	한 바이너리에서 여러 동작이 필요하면 glob_options (get_glob_matcher()) 
+//	또는 basic_glob_match<> 의 정책 인자를 사용한다.
+//
 
 // set to 1 to enable dotglob: *. ?, and [] match a . (dotfile) at the begin or after each /
 #define DOTGLOB 1
@@ -12,8 +22,6 @@
 // set to 1 to enable case-insensitive glob matching
 #define NOCASEGLOB 0
 
-#define CASE(c) (NOCASEGLOB ? tolower(c) : (c))
-
 // Windows \ versus normal / path separator
 //#ifdef OS_WIN
 #define PATHSEP '\\'
@@ -21,6 +29,53 @@
 //#define PATHSEP '/'
 //#endif
 
+//
+//	glob 매치 정책 (basic_glob_match<Case, Sep, Dot> 의 템플릿 인자)
+//
+//	정책은 컴파일 타임 상수이므로 인스턴스마다 문자 단위 분기가 없는 
+//	루프가 만들어진다. match.cpp 에서 모든 조합을 명시적으로 인스턴스화한다.
+//
+
+/// @brief	대소문자 구분
+struct glob_case_sensitive
+{
+	static const bool insensitive = false;
+	static int fold(char c) { return c; }
+};
+
+/// @brief	대소문자 무시 (ASCII 대문자만 소문자로, 분기 없이)
+struct glob_case_insensitive
+{
+	static const bool insensitive = true;
+	static int fold(char c) { return c | ((int)((unsigned)(c - 'A') < 26u) << 5); }
+};
+
+/// @brief	텍스트의 경로 구분자 ('\\' 또는 '/'), 패턴의 / 는 항상 구분자에 매치된다.
+template <char Sep>
+struct glob_separator
+{
+	static const char value = Sep;
+};
+
+/// @brief	dotglob 이 false 이면 *, ?, [] 가 처음 또는 / 다음의 . 에 매치되지 않는다.
+template <bool DotGlob>
+struct glob_dot
+{
+	static const bool dotglob = DotGlob;
+};
+
+typedef std::conditional<NOCASEGLOB != 0, glob_case_insensitive, glob_case_sensitive>::type glob_default_case;
+typedef glob_separator<PATHSEP> glob_default_sep;
+typedef glob_dot<DOTGLOB != 0> glob_default_dot;
+
+/// @brief	Returns true if text matches glob pattern with *, ?, [] (policy based)
+template <class Case, class Sep, class Dot>
+bool basic_glob_match(const char* text, size_t n, const char* glob, size_t m);
+
+/// @brief	Returns true if text matches gitignore-style glob pattern (policy based)
+template <class Case, class Sep, class Dot>
+bool basic_gitignore_glob_match(const char* text, size_t n, const char* glob, size_t m);
+
 /// @brief	Returns true if text string matches wild pattern with * and ?
 bool match_string(const std::string& text, const std::string& wild);
 
@@ -29,3 +84,180 @@ bool glob_match_string(const std::string& text, const std::string& glob);
 
 /// @brief Returns TRUE if text string matches gitignore-style glob pattern
 bool gitignore_glob_match_string(const std::string& text, const std::string& glob);
+
+
+/// @brief	glob_set 의 패턴 문법 (각각 match_string(), glob_match_string(), 
+///			gitignore_glob_match_string() 과 같은 의미)
+enum class glob_syntax
+{
+	wildcard,
+	glob,
+	gitignore
+};
+
+/// @brief	실행 중에 고르는 매치 정책 (wildcard 문법에는 영향이 없다)
+///			기본값은 DOTGLOB, NOCASEGLOB, PATHSEP 매크로와 같다.
+typedef struct glob_options
+{
+	glob_options(bool case_insensitive = (NOCASEGLOB != 0),
+				 char separator = PATHSEP,
+				 bool dotglob = (DOTGLOB != 0)) :
+		case_insensitive(case_insensitive),
+		separator(separator),
+		dotglob(dotglob)
+	{}
+
+	bool case_insensitive;
+	char separator;			///< '\\' 또는 '/'
+	bool dotglob;
+} *pglob_options;
+
+/// @brief	Windows 경로 : 대소문자 무시, '\\', dot 파일 구분 없음
+inline glob_options glob_windows_options() { return glob_options(true, '\\', true); }
+
+/// @brief	Linux 경로 : 대소문자 구분, '/', *, ? 가 dot 파일에 매치되지 않음
+inline glob_options glob_posix_options() { return glob_options(false, '/', false); }
+
+typedef bool(*glob_match_fn)(const char* text, size_t n, const char* pattern, size_t m);
+
+/// @brief	syntax, options 에 맞게 특수화된 매치 함수를 구한다. 
+///			지원하지 않는 구분자이면 nullptr
+glob_match_fn get_glob_matcher(glob_syntax syntax, const glob_options& options = glob_options());
+
+//
+//	리터럴 앵커 검색 (glob_pattern 의 사전 필터) 구현 선택
+//
+#define MATCH_IMPL_AUTO		0
+#define MATCH_IMPL_SCALAR	1
+#define MATCH_IMPL_SSE2		2
+#define MATCH_IMPL_AVX2		3
+
+bool match_set_impl(int impl);
+int match_get_impl();
+bool match_impl_supported(int impl);
+const char* match_impl_name(int impl);
+
+/// @brief	미리 컴파일해두고 재사용하는 패턴 하나
+///
+///			패턴에서 매치되는 텍스트에 반드시 있어야 하는 리터럴 (접두어, 
+///			접미어, 그 사이의 리터럴들 - 순서대로) 과 최소/최대 길이를 뽑아두고, 
+///			backtracking 매치 전에 SIMD 로 리터럴을 찾아서 매치될 수 없는 
+///			텍스트를 걸러낸다. 대부분의 텍스트가 매치되지 않는 규칙 검사에서 
+///			효과가 크다. 결과는 항상 원래의 매치 함수와 같다.
+///
+///			"*\\temp\\*.exe" (wildcard) -> 안쪽 "\\temp\\", 접미어 ".exe"
+///			"c:\\windows\\*" (wildcard) -> 접두어 "c:\\windows\\"
+///
+///			매치 함수는 options 에 맞게 특수화된 것 (get_glob_matcher()) 을 
+///			assign() 할 때 골라둔다.
+///			읽기 전용이므로 여러 스레드에서 동시에 매치해도 된다.
+class glob_pattern
+{
+public:
+	glob_pattern();
+	glob_pattern(glob_syntax syntax, const std::string& pattern, const glob_options& options = glob_options());
+
+	void assign(glob_syntax syntax, const std::string& pattern, const glob_options& options = glob_options());
+
+	glob_syntax syntax() const { return _syntax; }
+	const glob_options& options() const { return _options; }
+	const std::string& pattern() const { return _pattern; }
+
+	/// @brief	text 가 패턴에 매치되는지 확인한다.
+	bool match(const std::string& text) const;
+
+	/// @brief	리터럴, 길이 검사만 한다. false 이면 절대 매치되지 않는다.
+	bool prefilter(const char* text, size_t length) const;
+
+private:
+	glob_syntax _syntax;
+	glob_options _options;
+	std::string _pattern;
+	glob_match_fn _matcher;
+
+	size_t _min_length;
+	size_t _max_length;
+	bool _case_insensitive;
+
+	/// 순서대로 나와야 하는 리터럴, _has_prefix 이면 첫번째는 텍스트의 시작, 
+	/// _has_suffix 이면 마지막은 텍스트의 끝에 있어야 한다.
+	std::vector<std::string> _anchors;
+	bool _has_prefix;
+	bool _has_suffix;
+};
+
+/// @brief	여러 패턴을 한번에 컴파일해두고, 텍스트 하나에 대해 매치되는 
+///			패턴을 한번에 찾는다. 
+///
+///			패턴마다 매치되려면 반드시 텍스트에 있어야 하는 리터럴 중 하나를 
+///			뽑아서 Aho-Corasick 오토마톤 하나로 만든다. 리터럴은 3 글자 이상인 
+///			것 중 가장 적은 수의 패턴에 나오는 것을 고르고, 같으면 긴 것을 
+///			고른다. (3 글자 미만은 다른 리터럴이 없을 때만) 텍스트를 한번 훑어서 
+///			리터럴이 나온 패턴 (과 리터럴이 없는 패턴) 만 후보로 남기고, 
+///			후보만 glob_pattern 으로 확인한다. 결과는 패턴을 하나씩 매치 
+///			함수로 확인하는 것과 항상 같다.
+///
+///			패턴 id 는 add() 한 순서 (0 부터) 이다. 
+///			컴파일된 뒤에는 읽기 전용이므로 여러 스레드에서 동시에 매치해도 된다.
+///
+///			glob_set rules(glob_syntax::gitignore);
+///			rules.add("**/temp/*.exe");
+///			rules.add("/windows/system32/*.dll");
+///			rules.compile();
+///
+///			std::vector<uint32_t> ids;
+///			rules.match_all(path, ids);
+class glob_set
+{
+public:
+	explicit glob_set(glob_syntax syntax = glob_syntax::gitignore, const glob_options& options = glob_options());
+
+	/// @brief	패턴을 추가한다. compile() 전에만 추가할 수 있다.
+	bool add(const std::string& pattern);
+
+	/// @brief	오토마톤을 만든다. 추가된 패턴이 없어도 성공한다.
+	bool compile();
+
+	bool compiled() const { return _compiled; }
+	glob_syntax syntax() const { return _syntax; }
+	const glob_options& options() const { return _options; }
+	size_t size() const { return _patterns.size(); }
+	const std::string& pattern(uint32_t id) const { return _patterns[id].pattern(); }
+
+	/// @brief	text 에 매치되는 모든 패턴 id 를 오름차순으로 ids 에 넣는다. 
+	///			(ids 의 기존 내용은 지운다) 매치된 패턴 수를 리턴한다.
+	size_t match_all(const std::string& text, std::vector<uint32_t>& ids) const;
+
+	/// @brief	text 에 매치되는 가장 작은 패턴 id 를 구한다. 
+	bool match_first(const std::string& text, uint32_t& id) const;
+
+private:
+	bool match_one(uint32_t id, const std::string& text) const;
+	void collect(const std::string& text, std::vector<uint32_t>& candidates) const;
+
+private:
+	glob_syntax _syntax;
+	glob_options _options;
+	bool _compiled;
+	std::vector<glob_pattern> _patterns;
+
+	/// 오토마톤에 넣기 전 문자 변환 (대소문자 무시이면 소문자로)
+	unsigned char _fold[256];
+
+	/// 리터럴이 없어서 항상 확인해야 하는 패턴
+	std::vector<uint32_t> _always;
+
+	/// Aho-Corasick (루트는 256 개 전이표, 나머지 상태는 정렬된 간선 목록)
+	std::vector<uint32_t> _root;
+	std::vector<uint32_t> _edge_begin;
+	std::vector<unsigned char> _edge_char;
+	std::vector<uint32_t> _edge_next;
+	std::vector<uint32_t> _fail;
+
+	/// 출력이 있는 가장 가까운 접미사 상태 (없으면 0)
+	std::vector<uint32_t> _dict;
+
+	/// 상태에서 끝나는 리터럴을 가진 패턴 id 목록
+	std::vector<uint32_t> _out_begin;
+	std::vector<uint32_t> _out_ids;
+};
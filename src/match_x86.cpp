@@ -0,0 +1,80 @@
+﻿/**
+ * @file    match_x86.cpp
+ * @brief   x86 first/last byte filter kernels (SSE2, AVX2) for literal anchor search in match.cpp.
+ *
+ * match.cpp 에서 CPU 지원 여부에 따라 런타임에 선택된다.
+ * 위치 i 의 바이트와 위치 i + gap 의 바이트를 각각 리터럴의 첫/마지막 
+ * 바이트와 비교해서 둘 다 같은 위치를 movemask 로 찾는다.
+ *
+ * @author  Yonhgwhan, Roh (somma@somma.kr)
+ * @date    2026/10/18 created.
+ * @copyright (C)Somma, Inc. All rights reserved.
+**/
+#include "stdafx.h"
+#include "cpu_features.h"
+
+#if defined(CPU_FEATURES_X86)
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+/// @brief	v 의 최하위 1 비트 위치 (v != 0)
+static inline uint32_t lowest_bit(uint32_t v)
+{
+#if defined(_MSC_VER)
+	unsigned long index;
+	_BitScanForward(&index, v);
+	return (uint32_t)index;
+#else
+	return (uint32_t)__builtin_ctz(v);
+#endif
+}
+
+/// @brief	[0, positions) 중 s[i] == first && s[i + gap] == last 인 첫번째 i
+///			없으면 positions
+CPU_TARGET("sse2")
+size_t match_find_pair8_sse2(const uint8_t* s, size_t positions, size_t gap, uint8_t first, uint8_t last)
+{
+	const __m128i vf = _mm_set1_epi8((char)first);
+	const __m128i vl = _mm_set1_epi8((char)last);
+
+	size_t i = 0;
+	for (; i + 16 <= positions; i += 16)
+	{
+		const __m128i a = _mm_loadu_si128((const __m128i*)&s[i]);
+		const __m128i b = _mm_loadu_si128((const __m128i*)&s[i + gap]);
+		const uint32_t mask = (uint32_t)_mm_movemask_epi8(
+			_mm_and_si128(_mm_cmpeq_epi8(a, vf), _mm_cmpeq_epi8(b, vl)));
+		if (0 != mask) return i + lowest_bit(mask);
+	}
+	for (; i < positions; ++i)
+	{
+		if (s[i] == first && s[i + gap] == last) return i;
+	}
+	return positions;
+}
+
+CPU_TARGET("avx2")
+size_t match_find_pair8_avx2(const uint8_t* s, size_t positions, size_t gap, uint8_t first, uint8_t last)
+{
+	const __m256i vf = _mm256_set1_epi8((char)first);
+	const __m256i vl = _mm256_set1_epi8((char)last);
+
+	size_t i = 0;
+	for (; i + 32 <= positions; i += 32)
+	{
+		const __m256i a = _mm256_loadu_si256((const __m256i*)&s[i]);
+		const __m256i b = _mm256_loadu_si256((const __m256i*)&s[i + gap]);
+		const uint32_t mask = (uint32_t)_mm256_movemask_epi8(
+			_mm256_and_si256(_mm256_cmpeq_epi8(a, vf), _mm256_cmpeq_epi8(b, vl)));
+		if (0 != mask) return i + lowest_bit(mask);
+	}
+	if (i < positions)
+	{
+		return i + match_find_pair8_sse2(&s[i], positions - i, gap, first, last);
+	}
+	return positions;
+}
+
+#endif//CPU_FEATURES_X86
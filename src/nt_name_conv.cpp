@@ -13,6 +13,7 @@
 #include "_MyLib/src/Win32Utils.h"
 #include "_MyLib/src/nt_name_conv.h"
 #include "_MyLib/src/Singleton.h"
+#include "_MyLib/src/case_fold.h"
 
 
 /// @brief  
@@ -560,12 +561,11 @@ NameConverter::resolve_device_prefix(
 	}
 
 	std::wstring revised_file_name = strm.str();
-	std::wstring small_rfn = to_lower_string(revised_file_name);
 
 	//
 	// #0, \Device\HarddiskVolumeShadowCopy 라면 그대로 리턴한다.
 	//
-	if (lstrnicmp(L"\\Device\\HarddiskVolumeShadowCopy", small_rfn.c_str(), true))
+	if (starts_with_ci(revised_file_name, L"\\Device\\HarddiskVolumeShadowCopy"))
 	{
 		resolved_file_name = file_name;
 		return true;
@@ -581,11 +581,9 @@ NameConverter::resolve_device_prefix(
 		// 
         //	\Device\HarddiskVolume1, \Device\HarddiskVolume11 이 매칭되지 않도록
         //	dos_device._device_name 필드는 `\Device\HarddiskVolume1\` 처럼 `\` 로 끝난다.
+		//	(소문자로 복사하지 않고 prefix 만 대소문자 무시하고 비교)
 		//
-
-		std::wstring smal_dn = to_lower_string(dos_device->_device_name);
-        size_t pos = small_rfn.find(smal_dn);
-        if (pos == 0)
+        if (starts_with_ci(revised_file_name, dos_device->_device_name))
         {
             if (DRIVE_REMOTE == dos_device->_drive_type)
             {
@@ -625,6 +623,7 @@ NameConverter::resolve_device_prefix(
 			continue;
 		}
 
+		std::wstring small_rfn = to_lower_string(revised_file_name);
 		auto ltokens = split_string_w(small_rfn, L";", true);
 		std::vector<std::wstring> tokens(ltokens.cbegin(), ltokens.cend());
 		std::wstring mup_path;
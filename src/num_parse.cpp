@@ -0,0 +1,411 @@
+﻿/**
+ * @file    num_parse.cpp
+ * @brief   from_chars-style integer parsing (decimal/0x-hex, char/wchar_t) and delimited batch parsing.
+ *
+ * @author  Yonhgwhan, Roh (somma@somma.kr)
+ * @date    2026/10/18 created.
+ * @copyright (C)Somma, Inc. All rights reserved.
+**/
+#include "stdafx.h"
+#include "num_parse.h"
+#include <limits.h>
+#include <limits>
+#include <type_traits>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+/// 문자 -> 16 진수 값, 16 진수 문자가 아니면 0xff (ascii 범위만)
+static const uint8_t _hex_table[128] = 
+{
+	0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	0xff, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	0xff, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff
+};
+
+/// 10^n (n = 0..8)
+static const uint32_t _pow10[9] = 
+{
+	1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000
+};
+
+/// v * 10^8 + 99999999 가 uint64_t 를 넘지 않는 v 의 상한 (UINT64_MAX / 10^8)
+static const uint64_t _swar_safe_limit = 184467440737ull;
+
+template <typename CharT>
+static inline uint32_t char_value(_In_ CharT c)
+{
+	return (uint32_t)(typename std::make_unsigned<CharT>::type)c;
+}
+
+/// @brief	v 의 최하위 1 비트 위치 (v != 0)
+static inline uint32_t lowest_bit64(uint64_t v)
+{
+#if defined(_MSC_VER) && defined(_WIN64)
+	unsigned long index;
+	_BitScanForward64(&index, v);
+	return (uint32_t)index;
+#elif defined(_MSC_VER)
+	unsigned long index;
+	if (0 != (uint32_t)v)
+	{
+		_BitScanForward(&index, (uint32_t)v);
+		return (uint32_t)index;
+	}
+	_BitScanForward(&index, (uint32_t)(v >> 32));
+	return (uint32_t)index + 32;
+#else
+	return (uint32_t)__builtin_ctzll(v);
+#endif
+}
+
+/// @brief	8 문자를 바이트 8 개로 읽는다. (첫 문자가 최하위 바이트)
+///			ascii 가 아닌 문자는 0xff (숫자가 아닌 바이트) 가 된다.
+template <typename CharT>
+static inline uint64_t load_eight(_In_reads_(8) const CharT* p)
+{
+	uint64_t v = 0;
+	for (int i = 0; i < 8; ++i)
+	{
+		const uint32_t c = char_value(p[i]);
+		v |= (uint64_t)((c < 0x80) ? c : 0xff) << (i * 8);
+	}
+	return v;
+}
+
+static inline uint64_t load_eight(_In_reads_(8) const char* p)
+{
+	uint64_t v;
+	memcpy(&v, p, sizeof(v));
+	return v;
+}
+
+#if WCHAR_MAX == 0xffff
+/// @brief	16 비트 lane 4 개를 바이트 4 개로 모은다. (상위 바이트는 0)
+static inline uint64_t pack_four(uint64_t v)
+{
+	v = (v | (v >> 8)) & 0x0000ffff0000ffffull;
+	return (v | (v >> 16)) & 0x00000000ffffffffull;
+}
+
+static inline uint64_t load_eight(_In_reads_(8) const wchar_t* p)
+{
+	uint64_t lo, hi;
+	memcpy(&lo, p, sizeof(lo));
+	memcpy(&hi, p + 4, sizeof(hi));
+	if (0 != ((lo | hi) & 0xff00ff00ff00ff00ull))
+	{
+		return load_eight<wchar_t>(p);
+	}
+	return pack_four(lo) | (pack_four(hi) << 32);
+}
+#endif
+
+/// @brief	숫자가 아닌 바이트마다 0 이 아닌 값을 가지는 마스크
+///			(+6 에서 생기는 자리 올림은 숫자가 아닌 바이트보다 뒤쪽에만 
+///			영향을 주므로 첫번째 숫자가 아닌 바이트의 위치는 정확하다)
+static inline uint64_t non_digit_mask(uint64_t v)
+{
+	return ((v & 0xf0f0f0f0f0f0f0f0ull) ^ 0x3030303030303030ull) | 
+		   (((v + 0x0606060606060606ull) & 0xf0f0f0f0f0f0f0f0ull) ^ 0x3030303030303030ull);
+}
+
+/// @brief	숫자 문자 8 개 (첫 문자가 최하위 바이트) 를 값으로 바꾼다. (SWAR)
+static inline uint32_t parse_eight_digits(uint64_t v)
+{
+	v -= 0x3030303030303030ull;
+	v = (v * 10) + (v >> 8);
+	v = (((v & 0x000000ff000000ffull) * (100 + (1000000ull << 32))) + 
+		 (((v >> 16) & 0x000000ff000000ffull) * (1 + (10000ull << 32)))) >> 32;
+	return (uint32_t)v;
+}
+
+/// @brief	10 진수 숫자들을 파싱한다. 숫자의 끝을 리턴한다. (숫자가 없으면 p)
+///			uint64_t 를 넘으면 overflow 를 true 로 하고 나머지 숫자는 건너뛴다.
+template <typename CharT>
+static const CharT* 
+parse_decimal(
+	_In_ const CharT* p, 
+	_In_ const CharT* last, 
+	_Out_ uint64_t& magnitude, 
+	_Out_ bool& overflow
+	)
+{
+	uint64_t v = 0;
+	overflow = false;
+
+	//
+	//	8 문자를 한번에 읽어서 앞쪽의 숫자 n 개 (1..8) 를 SWAR 로 변환한다. 
+	//	n 이 8 보다 작으면 숫자가 끝난 것이다.
+	//
+	while (last - p >= 8)
+	{
+		uint64_t chunk = load_eight(p);
+		const uint64_t mask = non_digit_mask(chunk);
+		const uint32_t n = (0 == mask) ? 8 : lowest_bit64(mask) / 8;
+		if (0 == n) break;
+
+		if (n < 8)
+		{
+			//	숫자 n 개를 상위 바이트로 옮기고 앞을 '0' 으로 채운다.
+			chunk = (chunk << ((8 - n) * 8)) | (0x3030303030303030ull >> (n * 8));
+		}
+		const uint32_t x = parse_eight_digits(chunk);
+
+		if (v >= _swar_safe_limit && v > (UINT64_MAX - x) / _pow10[n])
+		{
+			overflow = true;
+			break;
+		}
+		v = v * _pow10[n] + x;
+		p += n;
+		if (n < 8)
+		{
+			magnitude = v;
+			return p;
+		}
+	}
+
+	for (; p < last; ++p)
+	{
+		const uint32_t d = char_value(*p) - '0';
+		if (d > 9) break;
+		if (overflow) continue;
+
+		if (v > (UINT64_MAX - d) / 10)
+		{
+			overflow = true;
+			continue;
+		}
+		v = v * 10 + d;
+	}
+	magnitude = v;
+	return p;
+}
+
+/// @brief	16 진수 숫자들을 파싱한다. 숫자의 끝을 리턴한다. (숫자가 없으면 p)
+template <typename CharT>
+static const CharT* 
+parse_hex(
+	_In_ const CharT* p, 
+	_In_ const CharT* last, 
+	_Out_ uint64_t& magnitude, 
+	_Out_ bool& overflow
+	)
+{
+	uint64_t v = 0;
+	overflow = false;
+	for (; p < last; ++p)
+	{
+		const uint32_t c = char_value(*p);
+		const uint32_t h = (c < 0x80) ? _hex_table[c] : 0xff;
+		if (0xff == h) break;
+		if (overflow) continue;
+
+		if (0 != (v >> 60))
+		{
+			overflow = true;
+			continue;
+		}
+		v = (v << 4) | h;
+	}
+	magnitude = v;
+	return p;
+}
+
+template <typename CharT>
+static inline bool is_hex_digit(_In_ CharT c)
+{
+	const uint32_t v = char_value(c);
+	return (v < 0x80 && 0xff != _hex_table[v]);
+}
+
+template <typename T, typename CharT>
+parse_number_result<CharT> 
+parse_number(
+	_In_reads_(last - first) const CharT* first, 
+	_In_ const CharT* last, 
+	_Out_ T& value, 
+	_In_ int base
+	)
+{
+	static_assert(std::is_integral<T>::value, "integral type required");
+	typedef typename std::make_unsigned<T>::type unsigned_type;
+
+	parse_number_result<CharT> result = { first, std::errc::invalid_argument };
+	if (nullptr == first || first >= last) return result;
+	if (0 != base && 10 != base && 16 != base) return result;
+
+	const CharT* p = first;
+	bool negative = false;
+	if (std::is_signed<T>::value && '-' == *p)
+	{
+		negative = true;
+		++p;
+	}
+
+	//
+	//	"0x" 뒤에 16 진수가 없으면 "0" 까지만 파싱한다. (strtol 과 같음)
+	//
+	bool hex = (16 == base);
+	if (0 == base && 
+		last - p >= 3 && 
+		'0' == p[0] && 
+		('x' == p[1] || 'X' == p[1]) && 
+		is_hex_digit(p[2]))
+	{
+		hex = true;
+		p += 2;
+	}
+
+	uint64_t magnitude = 0;
+	bool overflow = false;
+	const CharT* end = (hex) ? parse_hex(p, last, magnitude, overflow) : parse_decimal(p, last, magnitude, overflow);
+	if (end == p) return result;
+
+	result.ptr = end;
+	const uint64_t limit = (uint64_t)(std::numeric_limits<T>::max)() + ((negative) ? 1 : 0);
+	if (overflow || magnitude > limit)
+	{
+		result.ec = std::errc::result_out_of_range;
+		return result;
+	}
+
+	value = (negative) ? (T)(unsigned_type)(0 - magnitude) : (T)magnitude;
+	result.ec = std::errc();
+	return result;
+}
+
+template <typename T, typename CharT>
+bool 
+parse_number_list(
+	_In_reads_(last - first) const CharT* first, 
+	_In_ const CharT* last, 
+	_In_ CharT delimiter, 
+	_Inout_ std::vector<T>& values, 
+	_Out_opt_ size_t* error_offset
+	)
+{
+	if (nullptr != error_offset) *error_offset = 0;
+	if (first == last) return true;
+	if (nullptr == first || first > last) return false;
+
+	const bool blank_delimiter = (' ' == delimiter || '\t' == delimiter);
+	auto is_blank = [delimiter](_In_ CharT c)
+	{
+		return (' ' == c || '\t' == c || '\r' == c || delimiter == c);
+	};
+	auto is_space = [](_In_ CharT c)
+	{
+		return (' ' == c || '\t' == c || '\r' == c);
+	};
+
+	const CharT* p = first;
+	const CharT* field = first;
+	bool need_value = false;	// 구분자 뒤라서 값이 있어야 함
+	while (true)
+	{
+		//
+		//	필드 앞의 공백 (구분자가 공백이면 구분자 포함)
+		//
+		if (blank_delimiter)
+		{
+			while (p < last && is_blank(*p)) ++p;
+		}
+		else
+		{
+			while (p < last && is_space(*p)) ++p;
+		}
+
+		field = p;
+		if (p == last || '\n' == *p)
+		{
+			if (need_value) break;	// "1,\n", "1,"
+			if (p == last) return true;
+
+			++p;
+			continue;
+		}
+
+		T value;
+		const parse_number_result<CharT> r = parse_number(p, last, value, 0);
+		if (std::errc() != r.ec) break;
+
+		//
+		//	필드 뒤의 공백, 그 다음은 구분자, 줄바꿈, 끝 중 하나여야 한다.
+		//	필드 전체가 올바른 경우에만 values 에 넣는다.
+		//
+		p = r.ptr;
+		while (p < last && is_space(*p)) ++p;
+		if (p == last)
+		{
+			values.push_back(value);
+			return true;
+		}
+
+		if ('\n' == *p)
+		{
+			++p;
+			need_value = false;
+		}
+		else if (delimiter == *p)
+		{
+			++p;
+			need_value = !blank_delimiter;
+		}
+		else if (blank_delimiter && p > r.ptr)
+		{
+			need_value = false;
+		}
+		else
+		{
+			break;	// "12ab", "1 2" (delimiter=',')
+		}
+		values.push_back(value);
+	}
+
+	if (nullptr != error_offset) *error_offset = (size_t)(field - first);
+	log_err "invalid number list. offset=%zu", (size_t)(field - first) log_end;
+	return false;
+}
+
+//
+//	explicit instantiation
+//
+#define NUM_PARSE_INSTANTIATE(T, CharT) \
+	template parse_number_result<CharT> parse_number<T, CharT>(const CharT*, const CharT*, T&, int); \
+	template bool parse_number_list<T, CharT>(const CharT*, const CharT*, CharT, std::vector<T>&, size_t*);
+
+NUM_PARSE_INSTANTIATE(int8_t, char)
+NUM_PARSE_INSTANTIATE(uint8_t, char)
+NUM_PARSE_INSTANTIATE(int16_t, char)
+NUM_PARSE_INSTANTIATE(uint16_t, char)
+NUM_PARSE_INSTANTIATE(int32_t, char)
+NUM_PARSE_INSTANTIATE(uint32_t, char)
+NUM_PARSE_INSTANTIATE(int64_t, char)
+NUM_PARSE_INSTANTIATE(uint64_t, char)
+
+NUM_PARSE_INSTANTIATE(int8_t, wchar_t)
+NUM_PARSE_INSTANTIATE(uint8_t, wchar_t)
+NUM_PARSE_INSTANTIATE(int16_t, wchar_t)
+NUM_PARSE_INSTANTIATE(uint16_t, wchar_t)
+NUM_PARSE_INSTANTIATE(int32_t, wchar_t)
+NUM_PARSE_INSTANTIATE(uint32_t, wchar_t)
+NUM_PARSE_INSTANTIATE(int64_t, wchar_t)
+NUM_PARSE_INSTANTIATE(uint64_t, wchar_t)
+
+//
+//	long 이 int32_t/int64_t 와 다른 타입인 경우 (Windows 의 LONG, DWORD 등)
+//
+#if ULONG_MAX == 0xffffffff
+NUM_PARSE_INSTANTIATE(long, char)
+NUM_PARSE_INSTANTIATE(unsigned long, char)
+NUM_PARSE_INSTANTIATE(long, wchar_t)
+NUM_PARSE_INSTANTIATE(unsigned long, wchar_t)
+#endif
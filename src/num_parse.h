@@ -0,0 +1,71 @@
+﻿/**
+ * @file    num_parse.h
+ * @brief   from_chars-style integer parsing (decimal/0x-hex, char/wchar_t) and delimited batch parsing.
+ *
+ * std::from_chars 처럼 로케일, errno, 할당 없이 [first, last) 에서 정수를 
+ * 파싱하고, 오류를 정확하게 (std::errc) 알려준다. wchar_t 문자열도 변환 없이 
+ * 그대로 파싱한다. str_to_xxx()/wstr_to_xxx() 는 이 함수들 위에 구현되어 있다.
+ *
+ *	- base 가 0 이면 "0x"/"0X" 로 시작하면 16 진수, 아니면 10 진수 
+ *	  ("010" 은 8 진수가 아니라 10)
+ *	- 부호 있는 타입만 '-' 를 허용한다. '+', 공백은 허용하지 않는다. 
+ *	- 숫자가 아닌 문자에서 멈추고 그 위치를 ptr 로 알려준다. 
+ *	- 10 진수는 8 자리씩 SWAR 로 변환한다. 
+ *
+ *	parse_number_list() 는 구분자 (와 줄바꿈) 로 나뉜 숫자 목록을 한번에 
+ *	파싱해서 vector 에 넣는다. (CSV 컬럼, 공백으로 구분된 pid 목록 등)
+ *
+ * @author  Yonhgwhan, Roh (somma@somma.kr)
+ * @date    2026/10/18 created.
+ * @copyright (C)Somma, Inc. All rights reserved.
+**/
+#pragma once
+#include <stdint.h>
+#include <system_error>
+#include <vector>
+
+/// @brief	parse_number() 의 결과 (std::from_chars_result 와 같은 의미)
+///			ec 가 std::errc() 이면 성공이고 ptr 은 파싱한 마지막 문자의 다음
+///			ec 가 std::errc::invalid_argument 이면 숫자가 없으며 ptr 은 first
+///			ec 가 std::errc::result_out_of_range 이면 ptr 은 숫자의 끝
+///			오류인 경우 value 는 바뀌지 않는다.
+template <typename CharT>
+struct parse_number_result
+{
+	const CharT* ptr;
+	std::errc ec;
+};
+
+/// @brief	[first, last) 의 앞에서부터 정수를 파싱한다. 
+/// @param	base	0 (자동, "0x" 면 16 진수), 10, 16 ("0x" 접두어 없이)
+///
+///			T 는 int8_t ~ uint64_t, CharT 는 char, wchar_t
+template <typename T, typename CharT>
+parse_number_result<CharT> 
+parse_number(
+	_In_reads_(last - first) const CharT* first, 
+	_In_ const CharT* last, 
+	_Out_ T& value, 
+	_In_ int base = 0
+	);
+
+/// @brief	delimiter 나 줄바꿈으로 구분된 숫자를 모두 파싱해서 values 의 뒤에 붙인다.
+///			숫자 앞뒤의 공백 (' ', '\t', '\r') 은 무시하고, 빈 줄도 무시한다. 
+///			delimiter 가 공백이면 연속된 공백을 구분자 하나로 처리한다.
+///
+///			"1,2,3\r\n4,5\r\n" (delimiter=',') -> 1, 2, 3, 4, 5
+///			"  4  88 1024\n"   (delimiter=' ') -> 4, 88, 1024
+///
+///			숫자가 아니거나, 범위를 넘거나, 빈 필드 ("1,,2") 가 있으면 false 를
+///			리턴하고 error_offset 에 문제가 된 필드의 위치 (first 로부터의 문자 수) 
+///			를 넣는다. 그 전까지 파싱한 값은 values 에 들어있고, 문제가 된 필드의 
+///			값은 ("12ab" 의 12 등) 넣지 않는다.
+template <typename T, typename CharT>
+bool 
+parse_number_list(
+	_In_reads_(last - first) const CharT* first, 
+	_In_ const CharT* last, 
+	_In_ CharT delimiter, 
+	_Inout_ std::vector<T>& values, 
+	_Out_opt_ size_t* error_offset = nullptr
+	);
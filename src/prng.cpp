@@ -0,0 +1,238 @@
+﻿/**
+ * @file    prng.cpp
+ * @brief   Thread-local xoshiro256** PRNG (bounded integers, bulk fill, random strings) and CSPRNG entry point.
+ *
+ * @author  Yonhgwhan, Roh (somma@somma.kr)
+ * @date    2026/10/18 created.
+ * @copyright (C)Somma, Inc. All rights reserved.
+**/
+#include "stdafx.h"
+#include "prng.h"
+#include <string.h>
+#include <bcrypt.h>
+#pragma comment(lib, "bcrypt.lib")
+
+const char prng_alnum[] = 
+	"0123456789"
+	"ABCDEFGHIJKLMNOPQRSTUVWXYZ"
+	"abcdefghijklmnopqrstuvwxyz";
+
+const wchar_t prng_alnumw[] = 
+	L"0123456789"
+	L"ABCDEFGHIJKLMNOPQRSTUVWXYZ"
+	L"abcdefghijklmnopqrstuvwxyz";
+
+static_assert(sizeof(prng_alnum) - 1 == PRNG_ALNUM_SIZE, "PRNG_ALNUM_SIZE mismatch");
+
+
+/// @brief	splitmix64 (시드 확장용)
+static uint64_t splitmix64(_Inout_ uint64_t& x)
+{
+	uint64_t z = (x += 0x9e3779b97f4a7c15ull);
+	z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+	z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+	return z ^ (z >> 31);
+}
+
+void xoshiro256ss::seed(_In_ uint64_t seed)
+{
+	for (auto& s : _s)
+	{
+		s = splitmix64(seed);
+	}
+}
+
+void xoshiro256ss::set_state(_In_ const uint64_t state[4])
+{
+	memcpy(_s, state, sizeof(_s));
+
+	//
+	//	상태가 모두 0 이면 0 만 나온다.
+	//
+	if (0 == (_s[0] | _s[1] | _s[2] | _s[3]))
+	{
+		seed(0);
+	}
+}
+
+void xoshiro256ss::seed_from_entropy()
+{
+	uint64_t state[4];
+	if (csprng_fill(state, sizeof(state)))
+	{
+		set_state(state);
+		return;
+	}
+
+	LARGE_INTEGER counter;
+	QueryPerformanceCounter(&counter);
+	seed((uint64_t)counter.QuadPart ^ 
+		 ((uint64_t)GetCurrentThreadId() << 32) ^ 
+		 (uint64_t)(uintptr_t)this);
+}
+
+uint64_t xoshiro256ss::uniform(_In_ uint64_t bound)
+{
+	if (bound <= 1) return 0;
+
+	if (bound <= 0xffffffffull)
+	{
+		//
+		//	Lemire, "Fast Random Integer Generation in an Interval"
+		//	m 의 하위 32 비트가 threshold 보다 작을 때만 다시 뽑는다. 
+		//	threshold (나눗셈) 는 그 경우에만 계산한다.
+		//
+		const uint32_t b = (uint32_t)bound;
+		uint64_t m = (next() >> 32) * b;
+		if ((uint32_t)m < b)
+		{
+			const uint32_t threshold = (0u - b) % b;
+			while ((uint32_t)m < threshold)
+			{
+				m = (next() >> 32) * b;
+			}
+		}
+		return m >> 32;
+	}
+
+	//
+	//	bound 보다 크거나 같은 2^n - 1 로 마스킹하고 범위를 벗어나면 다시 뽑는다.
+	//	(평균 2 번 이하)
+	//
+	uint64_t mask = bound - 1;
+	mask |= mask >> 1;
+	mask |= mask >> 2;
+	mask |= mask >> 4;
+	mask |= mask >> 8;
+	mask |= mask >> 16;
+	mask |= mask >> 32;
+
+	uint64_t x;
+	do
+	{
+		x = next() & mask;
+	} while (x >= bound);
+	return x;
+}
+
+int64_t xoshiro256ss::range(_In_ int64_t min, _In_ int64_t max)
+{
+	_ASSERTE(min <= max);
+	if (min >= max) return min;
+
+	const uint64_t span = (uint64_t)max - (uint64_t)min;
+	if (span == 0xffffffffffffffffull)
+	{
+		return (int64_t)next();
+	}
+	return (int64_t)((uint64_t)min + uniform(span + 1));
+}
+
+void xoshiro256ss::fill(_Out_writes_bytes_(size) void* buf, _In_ size_t size)
+{
+	_ASSERTE(nullptr != buf || 0 == size);
+	uint8_t* pos = (uint8_t*)buf;
+	for (; size >= sizeof(uint64_t); size -= sizeof(uint64_t), pos += sizeof(uint64_t))
+	{
+		const uint64_t x = next();
+		memcpy(pos, &x, sizeof(x));
+	}
+	if (0 != size)
+	{
+		const uint64_t x = next();
+		memcpy(pos, &x, size);
+	}
+}
+
+/// @brief	next() 하나를 16 비트씩 4 개로 나눠서 문자 4 개를 만든다. 
+///			16 비트 Lemire 방식이라 편향이 없고, 나머지 연산은 문자 집합마다 한번만 한다.
+template <typename CharT>
+void 
+xoshiro256ss::string_t(
+	_Out_writes_(length) CharT* buf,
+	_In_ size_t length,
+	_In_reads_(alphabet_size) const CharT* alphabet,
+	_In_ size_t alphabet_size
+	)
+{
+	_ASSERTE(nullptr != buf || 0 == length);
+	_ASSERTE(nullptr != alphabet);
+	_ASSERTE(0 < alphabet_size && alphabet_size <= 0x10000);
+	if (nullptr == alphabet || 0 == alphabet_size || alphabet_size > 0x10000) return;
+
+	const uint32_t n = (uint32_t)alphabet_size;
+	const uint32_t threshold = (0x10000u - n) % n;
+
+	size_t i = 0;
+	while (i < length)
+	{
+		uint64_t x = next();
+		for (int lane = 0; lane < 4 && i < length; ++lane, x >>= 16)
+		{
+			const uint32_t m = (uint32_t)(x & 0xffff) * n;
+			if ((m & 0xffff) < threshold) continue;
+			buf[i++] = alphabet[m >> 16];
+		}
+	}
+}
+
+void 
+xoshiro256ss::string(
+	_Out_writes_(length) char* buf,
+	_In_ size_t length,
+	_In_reads_(alphabet_size) const char* alphabet,
+	_In_ size_t alphabet_size
+	)
+{
+	string_t(buf, length, alphabet, alphabet_size);
+}
+
+void
+xoshiro256ss::string(
+	_Out_writes_(length) wchar_t* buf,
+	_In_ size_t length,
+	_In_reads_(alphabet_size) const wchar_t* alphabet,
+	_In_ size_t alphabet_size
+	)
+{
+	string_t(buf, length, alphabet, alphabet_size);
+}
+
+
+/// @brief	스레드별 엔진, 처음 사용할 때 한번만 시드한다. 
+typedef struct thread_prng
+{
+	thread_prng() { engine.seed_from_entropy(); }
+	xoshiro256ss engine;
+} *pthread_prng;
+
+xoshiro256ss& prng_thread_local()
+{
+	static thread_local thread_prng _tls_prng;
+	return _tls_prng.engine;
+}
+
+
+bool csprng_fill(_Out_writes_bytes_(size) void* buf, _In_ size_t size)
+{
+	_ASSERTE(nullptr != buf || 0 == size);
+	if (nullptr == buf && 0 != size) return false;
+
+	uint8_t* pos = (uint8_t*)buf;
+	while (0 != size)
+	{
+		const ULONG chunk = (ULONG)((size > 0x40000000) ? 0x40000000 : size);
+		NTSTATUS status = BCryptGenRandom(nullptr, 
+										  pos, 
+										  chunk, 
+										  BCRYPT_USE_SYSTEM_PREFERRED_RNG);
+		if (!BCRYPT_SUCCESS(status))
+		{
+			log_err "BCryptGenRandom() failed. status=0x%08x", status log_end;
+			return false;
+		}
+		pos += chunk;
+		size -= chunk;
+	}
+	return true;
+}
@@ -0,0 +1,138 @@
+﻿/**
+ * @file    prng.h
+ * @brief   Thread-local xoshiro256** PRNG (bounded integers, bulk fill, random strings) and CSPRNG entry point.
+ *
+ * get_random_int() 는 호출할 때마다 std::random_device (시스템 콜) 와 엔진을
+ * 만들었고, generate_random_string() 은 rand() + stringstream 을 사용했다.
+ * 
+ *	- 스레드마다 xoshiro256** 엔진 하나를 처음 사용할 때 한번만 
+ *	  csprng_fill() 로 시드한다. 이후에는 락, 시스템 콜, 할당이 없다.
+ *	- prng_uniform() 은 편향 없이 [0, bound) 를 샘플링한다. 
+ *	  (32 비트 bound 는 Lemire 의 multiply-shift, 나눗셈은 거의 하지 않는다)
+ *	- prng_fill(), prng_string() 은 버퍼에 바로 채운다. 
+ *	
+ *	xoshiro256** 는 예측 가능하므로 키, salt, nonce, 토큰 같은 보안용 값은
+ *	반드시 csprng_fill() 로 만들어야 한다. 
+ *
+ * @author  Yonhgwhan, Roh (somma@somma.kr)
+ * @date    2026/10/18 created.
+ * @copyright (C)Somma, Inc. All rights reserved.
+**/
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+/// @brief	xoshiro256** 1.0 (Blackman, Vigna)
+///			스레드에 안전하지 않다. 스레드마다 인스턴스를 따로 사용하거나
+///			prng_xxx() 함수 (스레드별 인스턴스) 를 사용한다. 
+typedef class xoshiro256ss
+{
+public:
+	/// @brief	seed 를 splitmix64 로 확장해서 상태를 초기화한다. 
+	///			같은 seed 는 항상 같은 수열을 만든다. 
+	explicit xoshiro256ss(_In_ uint64_t seed = 0) { this->seed(seed); }
+	explicit xoshiro256ss(_In_ const uint64_t state[4]) { set_state(state); }
+
+	void seed(_In_ uint64_t seed);
+	void set_state(_In_ const uint64_t state[4]);
+
+	/// @brief	csprng_fill() 로 상태를 초기화한다. 
+	///			실패하면 시간, 스레드 id 등으로 시드한다.
+	void seed_from_entropy();
+
+	uint64_t next()
+	{
+		const uint64_t result = rotl(_s[1] * 5, 7) * 9;
+		const uint64_t t = _s[1] << 17;
+
+		_s[2] ^= _s[0];
+		_s[3] ^= _s[1];
+		_s[1] ^= _s[2];
+		_s[0] ^= _s[3];
+		_s[2] ^= t;
+		_s[3] = rotl(_s[3], 45);
+		return result;
+	}
+
+	/// @brief	[0, bound) 의 균등 분포 정수, bound 가 0 이면 0
+	uint64_t uniform(_In_ uint64_t bound);
+
+	/// @brief	[min, max] 의 균등 분포 정수 (max 포함)
+	int64_t range(_In_ int64_t min, _In_ int64_t max);
+
+	/// @brief	[0, 1) 의 double (53 비트)
+	double to_double() { return (double)(next() >> 11) * (1.0 / 9007199254740992.0); }
+
+	/// @brief	buf 를 size 바이트의 랜덤값으로 채운다. 
+	void fill(_Out_writes_bytes_(size) void* buf, _In_ size_t size);
+
+	/// @brief	alphabet 의 문자 중에서 균등하게 골라 buf 에 length 개를 쓴다. 
+	///			null 문자는 붙이지 않는다. alphabet_size 는 1 ~ 65536
+	void string(_Out_writes_(length) char* buf, 
+				_In_ size_t length, 
+				_In_reads_(alphabet_size) const char* alphabet, 
+				_In_ size_t alphabet_size);
+	void string(_Out_writes_(length) wchar_t* buf, 
+				_In_ size_t length, 
+				_In_reads_(alphabet_size) const wchar_t* alphabet, 
+				_In_ size_t alphabet_size);
+
+private:
+	static uint64_t rotl(_In_ uint64_t x, _In_ int k) { return (x << k) | (x >> (64 - k)); }
+
+	template <typename CharT>
+	void string_t(_Out_writes_(length) CharT* buf, 
+				  _In_ size_t length, 
+				  _In_reads_(alphabet_size) const CharT* alphabet, 
+				  _In_ size_t alphabet_size);
+
+private:
+	uint64_t _s[4];
+} *pxoshiro256ss;
+
+
+/// @brief	현재 스레드의 엔진 (처음 호출할 때 seed_from_entropy() 로 시드)
+///			루프에서 많이 뽑을 때는 참조를 한번 받아서 사용한다. 
+xoshiro256ss& prng_thread_local();
+
+/// @brief	현재 스레드의 엔진을 seed 로 다시 시드한다. (재현이 필요한 테스트용)
+inline void prng_seed(_In_ uint64_t seed) { prng_thread_local().seed(seed); }
+
+inline uint64_t prng_next() { return prng_thread_local().next(); }
+inline uint64_t prng_uniform(_In_ uint64_t bound) { return prng_thread_local().uniform(bound); }
+inline int64_t prng_range(_In_ int64_t min, _In_ int64_t max) { return prng_thread_local().range(min, max); }
+inline double prng_double() { return prng_thread_local().to_double(); }
+
+inline void prng_fill(_Out_writes_bytes_(size) void* buf, _In_ size_t size) 
+{ 
+	prng_thread_local().fill(buf, size); 
+}
+
+/// @brief	prng_string() 의 기본 문자 집합 (숫자, 영문 대소문자)
+extern const char prng_alnum[];
+extern const wchar_t prng_alnumw[];
+#define PRNG_ALNUM_SIZE		62
+
+inline void prng_string(
+	_Out_writes_(length) char* buf, 
+	_In_ size_t length, 
+	_In_reads_(alphabet_size) const char* alphabet = prng_alnum, 
+	_In_ size_t alphabet_size = PRNG_ALNUM_SIZE
+	)
+{
+	prng_thread_local().string(buf, length, alphabet, alphabet_size);
+}
+
+inline void prng_string(
+	_Out_writes_(length) wchar_t* buf, 
+	_In_ size_t length, 
+	_In_reads_(alphabet_size) const wchar_t* alphabet = prng_alnumw, 
+	_In_ size_t alphabet_size = PRNG_ALNUM_SIZE
+	)
+{
+	prng_thread_local().string(buf, length, alphabet, alphabet_size);
+}
+
+/// @brief	운영체제의 CSPRNG (BCryptGenRandom) 으로 buf 를 채운다. 
+///			키, salt, nonce 등 예측되면 안되는 값은 이 함수를 사용한다. 
+bool csprng_fill(_Out_writes_bytes_(size) void* buf, _In_ size_t size);
@@ -0,0 +1,330 @@
+﻿/**
+ * @file    replace_set.cpp
+ * @brief   Single-pass multi-pattern find-and-replace (Aho-Corasick).
+ *
+ * @author  Yonhgwhan, Roh (somma@somma.kr)
+ * @date    2026/10/18 created.
+ * @copyright (C)Somma, Inc. All rights reserved.
+**/
+#include "stdafx.h"
+#include "replace_set.h"
+#include <wctype.h>
+#include <map>
+#include <queue>
+#include <type_traits>
+
+static const uint32_t _no_state = 0xffffffff;
+
+/// replace() 가 한번에 역방향으로 훑는 최소 구간 길이
+static const size_t _min_block_size = 4096;
+
+template <typename CharT>
+static inline uint32_t char_value(_In_ CharT c)
+{
+	return (uint32_t)(typename std::make_unsigned<CharT>::type)c;
+}
+
+template <typename CharT>
+basic_replace_set<CharT>::basic_replace_set(
+	_In_ bool case_insensitive
+	) :
+	_case_insensitive(case_insensitive),
+	_compiled(false),
+	_class_count(1),
+	_max_length(0)
+{
+}
+
+/// @brief	비교용 소문자 (char 는 ASCII 만, wchar_t 는 ASCII 가 아니면 towlower)
+template <>
+char basic_replace_set<char>::fold(_In_ char c) const
+{
+	return (_case_insensitive && (uint8_t)(c - 'A') < 26) ? (char)(c | 0x20) : c;
+}
+
+template <>
+wchar_t basic_replace_set<wchar_t>::fold(_In_ wchar_t c) const
+{
+	if (!_case_insensitive) return c;
+	if (char_value(c) < 0x80)
+	{
+		return ((uint32_t)(c - L'A') < 26) ? (wchar_t)(c | 0x20) : c;
+	}
+	return (wchar_t)towlower((wint_t)c);
+}
+
+/// @brief	문자 클래스
+///			case_insensitive 이면 클래스 테이블이 이미 16 비트 범위의 대소문자를 
+///			같은 클래스로 매핑하고 있으므로 그 밖의 문자만 fold 해서 다시 찾는다.
+template <typename CharT>
+inline uint32_t basic_replace_set<CharT>::char_class(_In_ CharT c) const
+{
+	uint32_t u = char_value(c);
+	if (u < _classes.size()) return _classes[u];
+	if (!_case_insensitive || u < 0x10000) return 0;
+
+	u = char_value(fold(c));
+	return (u < _classes.size()) ? _classes[u] : 0;
+}
+
+/// @brief	치환할 쌍을 추가한다.
+template <typename CharT>
+bool 
+basic_replace_set<CharT>::add(
+	_In_ view_type find, 
+	_In_ view_type replace
+	)
+{
+	if (_compiled)
+	{
+		log_err "already compiled." log_end;
+		return false;
+	}
+	if (find.empty()) return false;
+
+	for (const auto& f : _finds)
+	{
+		if (f.size() != find.size()) continue;
+
+		size_t i = 0;
+		while (i < f.size() && fold(f[i]) == fold(find[i])) ++i;
+		if (i == f.size())
+		{
+			log_err "duplicate pattern. index=%zu", (size_t)(&f - &_finds[0]) log_end;
+			return false;
+		}
+	}
+
+	_finds.push_back(string_type(find));
+	_replaces.push_back(string_type(replace));
+	return true;
+}
+
+/// @brief	문자 클래스 테이블과 DFA 를 만든다.
+template <typename CharT>
+bool basic_replace_set<CharT>::compile()
+{
+	_ASSERTE(!_compiled);
+	if (_compiled) return false;
+
+	//
+	//	패턴에 나오는 (fold 된) 문자마다 클래스를 하나씩 부여한다.
+	//
+	std::map<uint32_t, uint32_t> class_of;
+	uint32_t max_value = 0;
+	for (const auto& find : _finds)
+	{
+		for (CharT c : find)
+		{
+			const uint32_t u = char_value(fold(c));
+			if (class_of.end() == class_of.find(u))
+			{
+				class_of[u] = (uint32_t)class_of.size() + 1;
+				if (u > max_value) max_value = u;
+			}
+		}
+	}
+	_class_count = (uint32_t)class_of.size() + 1;
+
+	_classes.clear();
+	if (!class_of.empty())
+	{
+		if (_case_insensitive)
+		{
+			//
+			//	fold 했을 때 패턴 문자가 되는 모든 문자 (대문자, KELVIN SIGN 등) 를 
+			//	같은 클래스로 매핑한다. 16 비트 범위 밖의 문자는 char_class() 에서 
+			//	fold 해서 찾는다.
+			//
+			const uint32_t limit = (sizeof(CharT) == 1) ? 0x100 : 0x10000;
+			_classes.assign(limit, 0);
+			uint32_t used = 0;
+			for (uint32_t u = 0; u < limit; ++u)
+			{
+				const auto it = class_of.find(char_value(fold((CharT)u)));
+				if (class_of.end() == it) continue;
+
+				_classes[u] = it->second;
+				used = u + 1;
+			}
+			_classes.resize(used);
+		}
+		else
+		{
+			_classes.assign(max_value + 1, 0);
+			for (const auto& it : class_of)
+			{
+				_classes[it.first] = it.second;
+			}
+		}
+		_classes.shrink_to_fit();
+	}
+
+	//
+	//	뒤집은 패턴으로 trie 를 만든다. 
+	//	(replace() 는 입력을 뒤에서부터 훑어서 위치마다 그 위치에서 시작하는 
+	//	가장 긴 패턴을 구한다)
+	//
+	const uint32_t k = _class_count;
+	_delta.assign(k, _no_state);
+	_output.assign(1, 0);
+	_max_length = 0;
+
+	for (size_t index = 0; index < _finds.size(); ++index)
+	{
+		const string_type& find = _finds[index];
+		if (find.size() > _max_length) _max_length = find.size();
+
+		uint32_t state = 0;
+		for (auto it = find.rbegin(); it != find.rend(); ++it)
+		{
+			const uint32_t cls = class_of[char_value(fold(*it))];
+			if (_no_state == _delta[state * k + cls])
+			{
+				const uint32_t next = (uint32_t)_output.size();
+				_delta.resize(_delta.size() + k, _no_state);
+				_output.push_back(0);
+				_delta[state * k + cls] = next;
+			}
+			state = _delta[state * k + cls];
+		}
+		_output[state] = (uint32_t)index + 1;
+	}
+
+	//
+	//	실패 링크를 BFS 로 구하면서 빈 전이를 채운다.
+	//	상태의 output 이 없으면 실패 링크의 output (더 짧은 접미사 패턴) 을 쓴다.
+	//	BFS 순서이므로 output 은 항상 상태에서 끝나는 가장 긴 패턴이다.
+	//
+	std::vector<uint32_t> fail(_output.size(), 0);
+	std::queue<uint32_t> queue;
+	for (uint32_t cls = 0; cls < k; ++cls)
+	{
+		uint32_t& next = _delta[cls];
+		if (_no_state == next)
+		{
+			next = 0;
+		}
+		else
+		{
+			fail[next] = 0;
+			queue.push(next);
+		}
+	}
+
+	while (!queue.empty())
+	{
+		const uint32_t state = queue.front();
+		queue.pop();
+
+		if (0 == _output[state])
+		{
+			_output[state] = _output[fail[state]];
+		}
+
+		for (uint32_t cls = 0; cls < k; ++cls)
+		{
+			uint32_t& next = _delta[state * k + cls];
+			const uint32_t fallback = _delta[fail[state] * k + cls];
+			if (_no_state == next)
+			{
+				next = fallback;
+			}
+			else
+			{
+				fail[next] = fallback;
+				queue.push(next);
+			}
+		}
+	}
+
+	_compiled = true;
+	return true;
+}
+
+/// @brief	source 의 매치를 모두 치환해서 out 에 쓴다.
+///
+///			입력을 구간 단위로 나눠서, 구간 끝에서부터 (패턴이 구간 밖으로 
+///			이어질 수 있으므로 _max_length - 1 만큼 더 뒤에서부터) 뒤집은 
+///			패턴의 오토마톤으로 거꾸로 훑으면 위치마다 그 위치에서 시작하는 
+///			가장 긴 패턴이 나온다. 그 매치들을 앞에서부터 보면서 앞의 치환과 
+///			겹치지 않는 것만 치환하면 leftmost-longest 가 된다. 
+///			구간 길이를 _max_length 의 4 배 이상으로 잡으므로 매치 후에 
+///			다시 훑는 일 없이 전체 비용은 O(n + _max_length) 이다.
+template <typename CharT>
+size_t 
+basic_replace_set<CharT>::replace(
+	_In_ view_type source, 
+	_Out_ string_type& out
+	) const
+{
+	_ASSERTE(_compiled);
+
+	out.clear();
+	if (!_compiled || _finds.empty())
+	{
+		out.assign(source);
+		return 0;
+	}
+	out.reserve(source.size());
+
+	const uint32_t k = _class_count;
+	const size_t n = source.size();
+	const size_t block_size = max(_min_block_size, _max_length * 4);
+
+	//
+	//	구간 안의 (시작 위치, 가장 긴 패턴 인덱스 + 1), 시작 위치의 역순
+	//	(스레드마다 재사용)
+	//
+	static thread_local std::vector<std::pair<size_t, uint32_t>> matches;
+
+	size_t count = 0;
+	size_t copied = 0;
+	size_t i = 0;
+	while (i < n)
+	{
+		const size_t block_end = min(n, i + block_size);
+
+		matches.clear();
+		uint32_t state = 0;
+		for (size_t j = min(n, block_end + _max_length - 1); j > i; --j)
+		{
+			state = _delta[state * k + char_class(source[j - 1])];
+			if (0 != _output[state] && j <= block_end)
+			{
+				matches.push_back(std::make_pair(j - 1, _output[state]));
+			}
+		}
+
+		for (auto it = matches.rbegin(); it != matches.rend(); ++it)
+		{
+			if (it->first < i) continue;	// 앞의 치환과 겹침
+
+			out.append(source.data() + copied, it->first - copied);
+			out.append(_replaces[it->second - 1]);
+			++count;
+
+			i = it->first + _finds[it->second - 1].size();
+			copied = i;
+		}
+
+		if (i < block_end) i = block_end;
+	}
+
+	out.append(source.data() + copied, n - copied);
+	return count;
+}
+
+template <typename CharT>
+typename basic_replace_set<CharT>::string_type 
+basic_replace_set<CharT>::replace(
+	_In_ view_type source
+	) const
+{
+	string_type out;
+	replace(source, out);
+	return out;
+}
+
+template class basic_replace_set<char>;
+template class basic_replace_set<wchar_t>;
@@ -0,0 +1,86 @@
+﻿/**
+ * @file    replace_set.h
+ * @brief   Single-pass multi-pattern find-and-replace (Aho-Corasick).
+ *
+ * 여러 (find, replace) 쌍을 (뒤집어서) Aho-Corasick 오토마톤 하나로 컴파일해두고, 
+ * 입력을 구간마다 뒤에서부터 한번 훑어서 찾은 매치로 새 버퍼에 치환 결과를 쓴다. 
+ * find_and_replace_string() 을 패턴 수만큼 연달아 호출하는 것과 달리 
+ * 패턴 수와 치환 횟수에 상관없이 입력 길이에 비례한다.
+ *
+ *	- leftmost-longest: 가장 왼쪽에서 시작하는 매치를, 같은 위치에서 시작하는
+ *	  매치가 여러개면 가장 긴 것을 치환한다. 매치는 겹치지 않으며, 치환된 
+ *	  결과는 다시 검색하지 않는다.
+ *	- case_insensitive 이면 char 는 ASCII 만, wchar_t 는 towlower() 로 비교한다. 
+ *	  (case_fold.h 와 같은 규칙)
+ *
+ *	replace_set_w env(true);
+ *	env.add(L"%SystemRoot%", L"C:\\Windows");
+ *	env.add(L"%ProgramFiles%", L"C:\\Program Files");
+ *	env.compile();
+ *	env.replace(cmdline, out);		// out 을 재사용하면 할당이 거의 없다.
+ *
+ *	컴파일된 뒤에는 읽기 전용이므로 여러 스레드에서 동시에 replace() 해도 된다.
+ *
+ * @author  Yonhgwhan, Roh (somma@somma.kr)
+ * @date    2026/10/18 created.
+ * @copyright (C)Somma, Inc. All rights reserved.
+**/
+#pragma once
+#include <stdint.h>
+#include <string>
+#include <string_view>
+#include <vector>
+
+template <typename CharT>
+class basic_replace_set
+{
+public:
+	typedef std::basic_string<CharT> string_type;
+	typedef std::basic_string_view<CharT> view_type;
+
+	explicit basic_replace_set(_In_ bool case_insensitive = false);
+
+	/// @brief	치환할 쌍을 추가한다. compile() 전에만 추가할 수 있다.
+	///			find 가 비어있거나 이미 추가된 find 이면 false
+	bool add(_In_ view_type find, _In_ view_type replace);
+
+	/// @brief	오토마톤을 만든다. 추가된 쌍이 없어도 성공한다.
+	bool compile();
+
+	bool compiled() const { return _compiled; }
+	bool case_insensitive() const { return _case_insensitive; }
+	size_t size() const { return _finds.size(); }
+
+	/// @brief	source 의 매치를 모두 치환해서 out 에 쓴다. (out 의 기존 내용은 지운다)
+	///			치환한 횟수를 리턴한다. 
+	///			입력의 각 문자를 최대 1.25 번 정도 훑는다. O(n + 가장 긴 find 의 길이)
+	size_t replace(_In_ view_type source, _Out_ string_type& out) const;
+	string_type replace(_In_ view_type source) const;
+
+private:
+	uint32_t char_class(_In_ CharT c) const;
+	CharT fold(_In_ CharT c) const;
+
+private:
+	bool _case_insensitive;
+	bool _compiled;
+
+	std::vector<string_type> _finds;
+	std::vector<string_type> _replaces;
+
+	/// 문자 -> 문자 클래스 (패턴에 없는 문자는 0)
+	std::vector<uint32_t> _classes;
+	uint32_t _class_count;
+
+	/// 상태 x 문자 클래스 전이표 (뒤집은 패턴으로 만들고 실패 전이까지 채운 DFA)
+	std::vector<uint32_t> _delta;
+
+	/// 상태에서 끝나는 가장 긴 (뒤집은) 패턴 인덱스 + 1 (없으면 0)
+	std::vector<uint32_t> _output;
+
+	/// 가장 긴 find 의 길이
+	size_t _max_length;
+};
+
+typedef basic_replace_set<char> replace_set_a;
+typedef basic_replace_set<wchar_t> replace_set_w;
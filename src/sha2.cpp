@@ -87,6 +87,8 @@
 #include <stdlib.h>     /* for _lrotr with VC++     */
 
 #include "sha2.h"
+#include "cpu_features.h"
+#include <atomic>
 
 /*  1. PLATFORM SPECIFIC INCLUDES */
 
@@ -284,6 +286,111 @@ void sha256_compile(sha256_ctx ctx[1])
 /* SHA256 hash data in an array of bytes into hash buffer   */
 /* and call the hash_compile function as required.          */
 
+/* Block functions: hash 'blocks' whole 64 byte blocks taken directly */
+/* from the input byte stream. The generic one goes through wbuf and  */
+/* sha256_compile(), the x86 ones (sha2_x86.cpp) read the input as is */
+
+typedef void (*sha256_blocks_fn)(sha2_32t hash[8], const unsigned char data[], unsigned long blocks);
+
+#if defined(CPU_FEATURES_X86)
+void sha256_blocks_shani(sha2_32t hash[8], const unsigned char data[], unsigned long blocks);
+void sha256_blocks_avx2(sha2_32t hash[8], const unsigned char data[], unsigned long blocks);
+#endif
+
+static void sha256_blocks_generic(sha2_32t hash[8], const unsigned char data[], unsigned long blocks)
+{   sha256_ctx  cx[1];
+
+    memcpy(cx->hash, hash, 8 * sizeof(sha2_32t));
+    while(blocks--)
+    {
+        memcpy(cx->wbuf, data, SHA256_BLOCK_SIZE);
+        bsw_32(cx->wbuf, SHA256_BLOCK_SIZE >> 2)
+        sha256_compile(cx);
+        data += SHA256_BLOCK_SIZE;
+    }
+    memcpy(hash, cx->hash, 8 * sizeof(sha2_32t));
+}
+
+static sha256_blocks_fn sha256_impl_fn(int impl)
+{
+    switch(impl)
+    {
+    case SHA256_IMPL_GENERIC:
+        return sha256_blocks_generic;
+#if defined(CPU_FEATURES_X86)
+    case SHA256_IMPL_AVX2:
+        return get_cpu_features().avx2 ? sha256_blocks_avx2 : 0;
+    case SHA256_IMPL_SHANI:
+        return (get_cpu_features().sha && get_cpu_features().sse41) ? sha256_blocks_shani : 0;
+#endif
+    }
+    return 0;
+}
+
+static int sha256_best_impl(void)
+{
+    if(sha256_impl_fn(SHA256_IMPL_SHANI)) return SHA256_IMPL_SHANI;
+    if(sha256_impl_fn(SHA256_IMPL_AVX2)) return SHA256_IMPL_AVX2;
+    return SHA256_IMPL_GENERIC;
+}
+
+static std::atomic<int> sha256_impl(SHA256_IMPL_AUTO);
+static std::atomic<sha256_blocks_fn> sha256_blocks(0);
+
+static sha256_blocks_fn sha256_get_blocks_fn(void)
+{   sha256_blocks_fn fn = sha256_blocks.load(std::memory_order_relaxed);
+
+    if(!fn)
+    {
+        sha256_impl.store(sha256_best_impl(), std::memory_order_relaxed);
+        fn = sha256_impl_fn(sha256_impl.load(std::memory_order_relaxed));
+        sha256_blocks.store(fn, std::memory_order_relaxed);
+    }
+    return fn;
+}
+
+/* Select the block function used by sha256_hash(). SHA256_IMPL_AUTO   */
+/* picks the fastest one the cpu supports. Returns SHA2_BAD if the cpu */
+/* does not support the requested implementation.                      */
+
+int sha256_set_impl(int impl)
+{   sha256_blocks_fn fn;
+
+    if(impl == SHA256_IMPL_AUTO)
+        impl = sha256_best_impl();
+
+    fn = sha256_impl_fn(impl);
+    if(!fn)
+        return SHA2_BAD;
+
+    sha256_impl.store(impl, std::memory_order_relaxed);
+    sha256_blocks.store(fn, std::memory_order_relaxed);
+    return SHA2_GOOD;
+}
+
+int sha256_get_impl(void)
+{
+    sha256_get_blocks_fn();
+    return sha256_impl.load(std::memory_order_relaxed);
+}
+
+int sha256_impl_supported(int impl)
+{
+    return impl == SHA256_IMPL_AUTO || sha256_impl_fn(impl) != 0;
+}
+
+const char* sha256_impl_name(int impl)
+{
+    switch(impl)
+    {
+    case SHA256_IMPL_AUTO:    return "auto";
+    case SHA256_IMPL_GENERIC: return "generic";
+    case SHA256_IMPL_AVX2:    return "avx2";
+    case SHA256_IMPL_SHANI:   return "sha-ni";
+    }
+    return "unknown";
+}
+
 void sha256_hash(const unsigned char data[], unsigned long len, sha256_ctx ctx[1])
 {   sha2_32t pos = (sha2_32t)(ctx->count[0] & SHA256_MASK), 
              space = SHA256_BLOCK_SIZE - pos;
@@ -292,14 +399,21 @@ void sha256_hash(const unsigned char data[], unsigned long len, sha256_ctx ctx[1
     if((ctx->count[0] += len) < len)
         ++(ctx->count[1]);
 
-    while(len >= space)     /* tranfer whole blocks while possible  */
+    if(pos && len >= space) /* complete a partially filled buffer   */
     {
         memcpy(((unsigned char*)ctx->wbuf) + pos, sp, space);
-        sp += space; len -= space; space = SHA256_BLOCK_SIZE; pos = 0; 
+        sp += space; len -= space; pos = 0; 
 		bsw_32(ctx->wbuf, SHA256_BLOCK_SIZE >> 2)
         sha256_compile(ctx);
     }
 
+    if(len >= SHA256_BLOCK_SIZE)    /* tranfer whole blocks directly   */
+    {   unsigned long blocks = len / SHA256_BLOCK_SIZE;
+
+        sha256_get_blocks_fn()(ctx->hash, sp, blocks);
+        sp += blocks * SHA256_BLOCK_SIZE; len -= blocks * SHA256_BLOCK_SIZE;
+    }
+
     memcpy(((unsigned char*)ctx->wbuf) + pos, sp, len);
 }
 
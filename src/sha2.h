@@ -120,6 +120,18 @@ typedef struct
 void sha256_compile(sha256_ctx ctx[1]);
 void sha512_compile(sha512_ctx ctx[1]);
 
+/* sha256 block function implementations, selected at runtime   */
+
+#define SHA256_IMPL_AUTO        0
+#define SHA256_IMPL_GENERIC     1
+#define SHA256_IMPL_AVX2        2
+#define SHA256_IMPL_SHANI       3
+
+int sha256_set_impl(int impl);
+int sha256_get_impl(void);
+int sha256_impl_supported(int impl);
+const char* sha256_impl_name(int impl);
+
 void sha256_begin(sha256_ctx ctx[1]);
 void sha256_hash(const unsigned char data[], unsigned long len, sha256_ctx ctx[1]);
 void sha256_end(unsigned char hval[], sha256_ctx ctx[1]);
@@ -0,0 +1,236 @@
+﻿/**
+ * @file    sha2_x86.cpp
+ * @brief   x86 SHA-256 block kernels (SHA extensions, AVX2 message schedule).
+ *
+ * sha2.cpp 의 sha256_hash() 가 64 바이트 블록 단위로 호출하며, CPU 지원 여부에
+ * 따라 sha2.cpp 에서 런타임에 선택된다. 모든 커널은 Gladman 의 generic
+ * sha256_compile() 과 동일한 결과를 내야 한다.
+ *
+ * - sha256_blocks_shani : Intel SHA extensions (sha256rnds2/msg1/msg2)
+ * - sha256_blocks_avx2  : 두 블록의 message schedule 을 ymm 한개의 상/하위
+ *                         lane 에서 동시에 계산하고, 라운드는 스칼라로 처리
+ *
+ * @author  Yonhgwhan, Roh (somma@somma.kr)
+ * @date    2026/10/18 created.
+ * @copyright (C)Somma, Inc. All rights reserved.
+**/
+#include "stdafx.h"
+#include "sha2.h"
+#include "cpu_features.h"
+
+#if defined(CPU_FEATURES_X86)
+#include <immintrin.h>
+
+static const sha2_32t _k256[64] =
+{
+	0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+	0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+	0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+	0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+	0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+	0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+	0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+	0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+/*
+ * SHA extensions
+ *
+ * state 는 ABEF/CDGH 로 재배치해서 유지하고, 4 라운드씩 처리한다.
+ * i 번째 4 라운드 그룹이 끝나면 msg1/msg2 로 다음 그룹의 W 를 준비한다.
+ */
+
+#define SHANI_ROUNDS(msg, i) \
+	tmp = _mm_add_epi32(msg, _mm_loadu_si128((const __m128i*)&_k256[(i) * 4])); \
+	state1 = _mm_sha256rnds2_epu32(state1, state0, tmp); \
+	tmp = _mm_shuffle_epi32(tmp, 0x0e); \
+	state0 = _mm_sha256rnds2_epu32(state0, state1, tmp)
+
+#define SHANI_MSG2(next, cur, prev) \
+	tmp = _mm_alignr_epi8(cur, prev, 4); \
+	next = _mm_add_epi32(next, tmp); \
+	next = _mm_sha256msg2_epu32(next, cur)
+
+#define SHANI_MSG1(prev, cur) \
+	prev = _mm_sha256msg1_epu32(prev, cur)
+
+CPU_TARGET("sha,sse4.1")
+void sha256_blocks_shani(sha2_32t hash[8], const unsigned char data[], unsigned long blocks)
+{
+	const __m128i bswap_mask = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+	__m128i state0, state1, tmp;
+	__m128i m0, m1, m2, m3;
+
+	tmp = _mm_loadu_si128((const __m128i*)&hash[0]);			// DCBA
+	state1 = _mm_loadu_si128((const __m128i*)&hash[4]);		// HGFE
+	tmp = _mm_shuffle_epi32(tmp, 0xb1);						// CDAB
+	state1 = _mm_shuffle_epi32(state1, 0x1b);				// EFGH
+	state0 = _mm_alignr_epi8(tmp, state1, 8);				// ABEF
+	state1 = _mm_blend_epi16(state1, tmp, 0xf0);			// CDGH
+
+	while (blocks--)
+	{
+		const __m128i abef_save = state0;
+		const __m128i cdgh_save = state1;
+
+		m0 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(data + 0)), bswap_mask);
+		m1 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(data + 16)), bswap_mask);
+		m2 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(data + 32)), bswap_mask);
+		m3 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(data + 48)), bswap_mask);
+
+		SHANI_ROUNDS(m0, 0);
+		SHANI_ROUNDS(m1, 1);  SHANI_MSG1(m0, m1);
+		SHANI_ROUNDS(m2, 2);  SHANI_MSG1(m1, m2);
+		SHANI_ROUNDS(m3, 3);  SHANI_MSG2(m0, m3, m2); SHANI_MSG1(m2, m3);
+		SHANI_ROUNDS(m0, 4);  SHANI_MSG2(m1, m0, m3); SHANI_MSG1(m3, m0);
+		SHANI_ROUNDS(m1, 5);  SHANI_MSG2(m2, m1, m0); SHANI_MSG1(m0, m1);
+		SHANI_ROUNDS(m2, 6);  SHANI_MSG2(m3, m2, m1); SHANI_MSG1(m1, m2);
+		SHANI_ROUNDS(m3, 7);  SHANI_MSG2(m0, m3, m2); SHANI_MSG1(m2, m3);
+		SHANI_ROUNDS(m0, 8);  SHANI_MSG2(m1, m0, m3); SHANI_MSG1(m3, m0);
+		SHANI_ROUNDS(m1, 9);  SHANI_MSG2(m2, m1, m0); SHANI_MSG1(m0, m1);
+		SHANI_ROUNDS(m2, 10); SHANI_MSG2(m3, m2, m1); SHANI_MSG1(m1, m2);
+		SHANI_ROUNDS(m3, 11); SHANI_MSG2(m0, m3, m2); SHANI_MSG1(m2, m3);
+		SHANI_ROUNDS(m0, 12); SHANI_MSG2(m1, m0, m3); SHANI_MSG1(m3, m0);
+		SHANI_ROUNDS(m1, 13); SHANI_MSG2(m2, m1, m0);
+		SHANI_ROUNDS(m2, 14); SHANI_MSG2(m3, m2, m1);
+		SHANI_ROUNDS(m3, 15);
+
+		state0 = _mm_add_epi32(state0, abef_save);
+		state1 = _mm_add_epi32(state1, cdgh_save);
+		data += SHA256_BLOCK_SIZE;
+	}
+
+	tmp = _mm_shuffle_epi32(state0, 0x1b);					// FEBA
+	state1 = _mm_shuffle_epi32(state1, 0xb1);				// DCHG
+	state0 = _mm_blend_epi16(tmp, state1, 0xf0);			// DCBA
+	state1 = _mm_alignr_epi8(state1, tmp, 8);				// HGFE
+
+	_mm_storeu_si128((__m128i*)&hash[0], state0);
+	_mm_storeu_si128((__m128i*)&hash[4], state1);
+}
+
+/*
+ * AVX2 message schedule
+ *
+ * ymm 의 하위 128 bit 에는 첫번째 블록, 상위 128 bit 에는 두번째 블록의
+ * W[t..t+3] 를 두고 W+K 를 한번에 계산해 둔 뒤, 라운드는 블록별로 스칼라로
+ * 처리한다. 블록 개수가 홀수이면 마지막 블록은 자기 자신과 짝을 지어서
+ * 계산하고 상위 lane 결과는 버린다.
+ */
+
+#define AVX2_ROTR(x, n)	_mm256_or_si256(_mm256_srli_epi32(x, n), _mm256_slli_epi32(x, 32 - (n)))
+#define AVX2_S0(x)		_mm256_xor_si256(_mm256_xor_si256(AVX2_ROTR(x, 7), AVX2_ROTR(x, 18)), _mm256_srli_epi32(x, 3))
+#define AVX2_S1(x)		_mm256_xor_si256(_mm256_xor_si256(AVX2_ROTR(x, 17), AVX2_ROTR(x, 19)), _mm256_srli_epi32(x, 10))
+
+/// @brief	x0..x3 = W[t-16..t-1] 로부터 W[t..t+3] 를 계산한다.
+CPU_TARGET("avx2")
+static inline __m256i avx2_schedule(__m256i x0, __m256i x1, __m256i x2, __m256i x3)
+{
+	const __m256i lo_mask = _mm256_set_epi32(0, 0, -1, -1, 0, 0, -1, -1);
+	const __m256i hi_mask = _mm256_set_epi32(-1, -1, 0, 0, -1, -1, 0, 0);
+
+	__m256i w15 = _mm256_alignr_epi8(x1, x0, 4);	// W[t-15..t-12]
+	__m256i w7 = _mm256_alignr_epi8(x3, x2, 4);		// W[t-7..t-4]
+	__m256i w = _mm256_add_epi32(_mm256_add_epi32(x0, w7), AVX2_S0(w15));
+
+	// W[t], W[t+1] 은 W[t-2], W[t-1] 에 의존
+	__m256i w2 = _mm256_shuffle_epi32(x3, _MM_SHUFFLE(3, 3, 3, 2));
+	w = _mm256_add_epi32(w, _mm256_and_si256(AVX2_S1(w2), lo_mask));
+
+	// W[t+2], W[t+3] 은 방금 계산한 W[t], W[t+1] 에 의존
+	w2 = _mm256_shuffle_epi32(w, _MM_SHUFFLE(1, 0, 0, 0));
+	w = _mm256_add_epi32(w, _mm256_and_si256(AVX2_S1(w2), hi_mask));
+	return w;
+}
+
+#define rotr32(x, n)	(((x) >> (n)) | ((x) << (32 - (n))))
+#define ch(x, y, z)		(((x) & (y)) ^ (~(x) & (z)))
+#define maj(x, y, z)	(((x) & (y)) ^ ((x) & (z)) ^ ((y) & (z)))
+#define s256_0(x)		(rotr32((x), 2) ^ rotr32((x), 13) ^ rotr32((x), 22))
+#define s256_1(x)		(rotr32((x), 6) ^ rotr32((x), 11) ^ rotr32((x), 25))
+
+#define WK_ROUND(a, b, c, d, e, f, g, h, i) \
+	t1 = h + s256_1(e) + ch(e, f, g) + wk[((i) >> 2) * 8 + off + ((i) & 3)]; \
+	d += t1; \
+	h = t1 + s256_0(a) + maj(a, b, c)
+
+/// @brief	미리 계산된 W+K (stride 8, lane 오프셋 off) 로 64 라운드를 처리한다.
+static inline void sha256_rounds_wk(sha2_32t hash[8], const sha2_32t* wk, int off)
+{
+	sha2_32t a = hash[0], b = hash[1], c = hash[2], d = hash[3];
+	sha2_32t e = hash[4], f = hash[5], g = hash[6], h = hash[7];
+	sha2_32t t1;
+
+	for (int t = 0; t < 64; t += 8)
+	{
+		WK_ROUND(a, b, c, d, e, f, g, h, t + 0);
+		WK_ROUND(h, a, b, c, d, e, f, g, t + 1);
+		WK_ROUND(g, h, a, b, c, d, e, f, t + 2);
+		WK_ROUND(f, g, h, a, b, c, d, e, t + 3);
+		WK_ROUND(e, f, g, h, a, b, c, d, t + 4);
+		WK_ROUND(d, e, f, g, h, a, b, c, t + 5);
+		WK_ROUND(c, d, e, f, g, h, a, b, t + 6);
+		WK_ROUND(b, c, d, e, f, g, h, a, t + 7);
+	}
+
+	hash[0] += a; hash[1] += b; hash[2] += c; hash[3] += d;
+	hash[4] += e; hash[5] += f; hash[6] += g; hash[7] += h;
+}
+
+CPU_TARGET("avx2")
+void sha256_blocks_avx2(sha2_32t hash[8], const unsigned char data[], unsigned long blocks)
+{
+	const __m256i bswap_mask = _mm256_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL,
+												 0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+#if defined(_MSC_VER)
+	__declspec(align(32)) sha2_32t wk[2 * 64];
+#else
+	sha2_32t wk[2 * 64] __attribute__((aligned(32)));
+#endif
+
+	while (blocks > 0)
+	{
+		const unsigned char* p0 = data;
+		const unsigned char* p1 = (blocks > 1) ? data + SHA256_BLOCK_SIZE : data;
+
+		__m256i x[4];
+		for (int i = 0; i < 4; ++i)
+		{
+			__m256i m = _mm256_inserti128_si256(
+				_mm256_castsi128_si256(_mm_loadu_si128((const __m128i*)(p0 + i * 16))),
+				_mm_loadu_si128((const __m128i*)(p1 + i * 16)),
+				1);
+			x[i] = _mm256_shuffle_epi8(m, bswap_mask);
+		}
+
+		for (int g = 0; g < 16; ++g)
+		{
+			const __m128i k = _mm_loadu_si128((const __m128i*)&_k256[g * 4]);
+			const __m256i kk = _mm256_inserti128_si256(_mm256_castsi128_si256(k), k, 1);
+			_mm256_store_si256((__m256i*)&wk[g * 8], _mm256_add_epi32(x[g & 3], kk));
+
+			if (g < 12)
+			{
+				x[g & 3] = avx2_schedule(x[g & 3],
+										 x[(g + 1) & 3],
+										 x[(g + 2) & 3],
+										 x[(g + 3) & 3]);
+			}
+		}
+
+		sha256_rounds_wk(hash, wk, 0);
+		if (blocks > 1)
+		{
+			sha256_rounds_wk(hash, wk, 4);
+			data += 2 * SHA256_BLOCK_SIZE;
+			blocks -= 2;
+		}
+		else
+		{
+			data += SHA256_BLOCK_SIZE;
+			blocks -= 1;
+		}
+	}
+}
+
+#endif//CPU_FEATURES_X86
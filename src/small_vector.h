@@ -0,0 +1,177 @@
+﻿/**
+ * @file    small_vector.h
+ * @brief   Vector with inline storage for the first N elements.
+ *
+ * N 개까지는 객체 내부의 배열을 사용하고, 넘치면 힙으로 옮긴다. 
+ * clear() 는 capacity 를 유지하므로 같은 객체를 재사용하면 (스택/멤버) 
+ * 반복 호출에서 할당이 없다. 
+ * string_view, 포인터, 정수 같은 trivially copyable 타입 전용.
+ *
+ * @author  Yonhgwhan, Roh (somma@somma.kr)
+ * @date    2026/10/18 created.
+ * @copyright (C)Somma, Inc. All rights reserved.
+**/
+#pragma once
+#include <stddef.h>
+#include <string.h>
+#include <stdlib.h>
+#include <new>
+#include <type_traits>
+
+template <typename T, size_t N>
+class small_vector
+{
+	static_assert(0 < N, "inline capacity must not be zero");
+	static_assert(std::is_trivially_copyable<T>::value, "small_vector supports trivially copyable types only");
+	static_assert(std::is_default_constructible<T>::value, "small_vector needs default constructible types");
+
+public:
+	typedef T value_type;
+	typedef T* iterator;
+	typedef const T* const_iterator;
+
+	small_vector() : _data(_inline), _size(0), _capacity(N) {}
+	~small_vector() { release(); }
+
+	small_vector(const small_vector& rhs) : _data(_inline), _size(0), _capacity(N)
+	{
+		assign(rhs.begin(), rhs.end());
+	}
+
+	small_vector(small_vector&& rhs) : _data(_inline), _size(0), _capacity(N)
+	{
+		swap_from(rhs);
+	}
+
+	small_vector& operator=(const small_vector& rhs)
+	{
+		if (this != &rhs) assign(rhs.begin(), rhs.end());
+		return *this;
+	}
+
+	small_vector& operator=(small_vector&& rhs)
+	{
+		if (this != &rhs)
+		{
+			release();
+			swap_from(rhs);
+		}
+		return *this;
+	}
+
+	size_t size() const { return _size; }
+	size_t capacity() const { return _capacity; }
+	bool empty() const { return 0 == _size; }
+
+	/// @brief	힙으로 옮기지 않고 내부 배열을 사용하고 있는지
+	bool is_inline() const { return _data == _inline; }
+
+	T* data() { return _data; }
+	const T* data() const { return _data; }
+
+	iterator begin() { return _data; }
+	iterator end() { return _data + _size; }
+	const_iterator begin() const { return _data; }
+	const_iterator end() const { return _data + _size; }
+
+	T& operator[](size_t index) { _ASSERTE(index < _size); return _data[index]; }
+	const T& operator[](size_t index) const { _ASSERTE(index < _size); return _data[index]; }
+
+	T& front() { _ASSERTE(0 < _size); return _data[0]; }
+	const T& front() const { _ASSERTE(0 < _size); return _data[0]; }
+	T& back() { _ASSERTE(0 < _size); return _data[_size - 1]; }
+	const T& back() const { _ASSERTE(0 < _size); return _data[_size - 1]; }
+
+	void push_back(const T& value)
+	{
+		if (_size == _capacity)
+		{
+			//
+			//	value 가 자기 자신의 원소일 수 있으므로 복사해두고 늘린다.
+			//
+			const T copy = value;
+			grow(_capacity * 2);
+			_data[_size++] = copy;
+		}
+		else
+		{
+			_data[_size++] = value;
+		}
+	}
+
+	void pop_back() { _ASSERTE(0 < _size); --_size; }
+
+	/// @brief	원소만 지우고 capacity (힙 버퍼) 는 유지한다.
+	void clear() { _size = 0; }
+
+	void reserve(size_t capacity)
+	{
+		if (capacity > _capacity) grow(capacity);
+	}
+
+	void resize(size_t size)
+	{
+		reserve(size);
+		for (size_t i = _size; i < size; ++i)
+		{
+			_data[i] = T();
+		}
+		_size = size;
+	}
+
+	template <typename It>
+	void assign(It first, It last)
+	{
+		clear();
+		for (; first != last; ++first)
+		{
+			push_back(*first);
+		}
+	}
+
+private:
+	void grow(size_t capacity)
+	{
+		T* data = (T*)malloc(capacity * sizeof(T));
+		if (nullptr == data) throw std::bad_alloc();
+
+		if (0 < _size) memcpy(data, _data, _size * sizeof(T));
+		if (_data != _inline) free(_data);
+
+		_data = data;
+		_capacity = capacity;
+	}
+
+	void release()
+	{
+		if (_data != _inline) free(_data);
+		_data = _inline;
+		_size = 0;
+		_capacity = N;
+	}
+
+	/// @brief	rhs 의 원소를 가져오고 rhs 를 비운다. (this 는 비어있는 inline 상태)
+	void swap_from(small_vector& rhs)
+	{
+		if (rhs.is_inline())
+		{
+			if (0 < rhs._size) memcpy(_inline, rhs._inline, rhs._size * sizeof(T));
+			_size = rhs._size;
+		}
+		else
+		{
+			_data = rhs._data;
+			_size = rhs._size;
+			_capacity = rhs._capacity;
+			rhs._data = rhs._inline;
+			rhs._capacity = N;
+		}
+		rhs._size = 0;
+	}
+
+private:
+	T* _data;
+	size_t _size;
+	size_t _capacity;
+	T _inline[N];
+};
@@ -0,0 +1,124 @@
+﻿/**
+ * @file    str_format.cpp
+ * @brief   Thread-safe printf-style formatting into caller/thread-local buffers with compile-time format checking.
+ *
+ * @author  Yonhgwhan, Roh (somma@somma.kr)
+ * @date    2026/10/18 created.
+ * @copyright (C)Somma, Inc. All rights reserved.
+**/
+#include "stdafx.h"
+#include "str_format.h"
+#include <stdio.h>
+
+/// format_tls() 의 스레드별 버퍼 (예전 format_string() 의 static 버퍼와 같은 크기)
+static thread_local format_buffer<2048> _tls_buffer;
+
+int 
+format_to(
+	_Out_writes_z_(buf_size) char* buf, 
+	_In_ size_t buf_size, 
+	_In_z_ _Printf_format_string_ const char* fmt, 
+	...
+	)
+{
+	va_list args;
+	va_start(args, fmt);
+	const int ret = vformat_to(buf, buf_size, fmt, args);
+	va_end(args);
+	return ret;
+}
+
+int 
+vformat_to(
+	_Out_writes_z_(buf_size) char* buf, 
+	_In_ size_t buf_size, 
+	_In_z_ const char* fmt, 
+	_In_ va_list args
+	)
+{
+	_ASSERTE(nullptr != fmt);
+	_ASSERTE(nullptr != buf || 0 == buf_size);
+	if (nullptr == fmt || (nullptr == buf && 0 != buf_size)) return -1;
+
+	const int ret = vsnprintf(buf, buf_size, fmt, args);
+	if (0 > ret && 0 != buf_size)
+	{
+		buf[0] = '\0';
+	}
+	return ret;
+}
+
+bool 
+format_append(
+	_Inout_ std::string& out, 
+	_In_z_ _Printf_format_string_ const char* fmt, 
+	...
+	)
+{
+	va_list args;
+	va_start(args, fmt);
+	const bool ret = vformat_append(out, fmt, args);
+	va_end(args);
+	return ret;
+}
+
+/// @brief	스택 버퍼 (512 바이트) 에 먼저 포맷팅하고, 넘치면 필요한 길이를 
+///			알았으므로 out 을 한번 늘려서 바로 포맷팅한다.
+bool 
+vformat_append(
+	_Inout_ std::string& out, 
+	_In_z_ const char* fmt, 
+	_In_ va_list args
+	)
+{
+	char stack_buf[512];
+
+	va_list copy;
+	va_copy(copy, args);
+	const int n = vformat_to(stack_buf, sizeof(stack_buf), fmt, copy);
+	va_end(copy);
+	if (0 > n) return false;
+
+	if ((size_t)n < sizeof(stack_buf))
+	{
+		out.append(stack_buf, (size_t)n);
+		return true;
+	}
+
+	const size_t offset = out.size();
+	out.resize(offset + (size_t)n + 1);
+	va_copy(copy, args);
+	const int written = vformat_to(&out[offset], (size_t)n + 1, fmt, copy);
+	va_end(copy);
+	if (written != n)
+	{
+		out.resize(offset);
+		return false;
+	}
+	out.resize(offset + (size_t)n);
+	return true;
+}
+
+const char* 
+format_tls(
+	_In_z_ _Printf_format_string_ const char* fmt, 
+	...
+	)
+{
+	va_list args;
+	va_start(args, fmt);
+	const char* ret = vformat_tls(fmt, args);
+	va_end(args);
+	return ret;
+}
+
+const char* 
+vformat_tls(
+	_In_z_ const char* fmt, 
+	_In_ va_list args
+	)
+{
+	_tls_buffer.clear();
+	if (!_tls_buffer.vappend(fmt, args)) return nullptr;
+	return _tls_buffer.c_str();
+}
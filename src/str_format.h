@@ -0,0 +1,419 @@
+﻿/**
+ * @file    str_format.h
+ * @brief   Thread-safe printf-style formatting into caller/thread-local buffers with compile-time format checking.
+ *
+ *	- format_to()      : 호출자 버퍼에 포맷팅 (vsnprintf 와 같은 의미, 할당 없음)
+ *	- format_append()  : std::string 이나 format_buffer 의 뒤에 붙인다.
+ *	- format_tls()     : 스레드별 버퍼에 포맷팅하고 포인터를 리턴한다. 
+ *	                     (락 없음, 같은 스레드에서 다음 format_tls() 전까지 유효)
+ *	- format_buffer<N> : N 바이트 내부 배열에 포맷팅하고, 넘치면 std::string 으로 
+ *	                     옮겨서 (spill) 계속 붙인다. clear() 는 capacity 를 유지한다.
+ *
+ *	FORMAT_TO/FORMAT_APPEND/FORMAT_TLS 매크로는 형식 문자열을 컴파일 시간에 
+ *	인자와 비교하고 (변환 수, 정수 크기, 문자열/포인터/실수 종류) 맞지 않으면 
+ *	컴파일 오류를 낸다. 형식 문자열은 문자열 리터럴이어야 한다.
+ *
+ *	char buf[256];
+ *	FORMAT_TO(buf, sizeof(buf), "pid=%u, path=%ws", pid, path.c_str());
+ *
+ *	format_buffer<512> line;
+ *	FORMAT_APPEND(line, "%llu %s", ts, "event");	// 512 바이트를 넘으면 spill
+ *	write(line.c_str(), line.size());
+ *
+ *	MSVC 는 _Printf_format_string_ (/analyze), gcc/clang 은 format 속성으로 
+ *	매크로를 쓰지 않는 호출도 검사한다.
+ *
+ * @author  Yonhgwhan, Roh (somma@somma.kr)
+ * @date    2026/10/18 created.
+ * @copyright (C)Somma, Inc. All rights reserved.
+**/
+#pragma once
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <string>
+#include <type_traits>
+
+#if defined(__GNUC__) || defined(__clang__)
+#define STR_FORMAT_PRINTF(fmt_index, args_index) __attribute__((format(printf, fmt_index, args_index)))
+#else
+#define STR_FORMAT_PRINTF(fmt_index, args_index)
+#endif
+
+#ifndef _Printf_format_string_
+#define _Printf_format_string_
+#endif
+
+/// @brief	buf 에 포맷팅한다. buf_size 가 모자라면 잘라서 쓰며, buf_size 가 
+///			0 이 아니면 항상 null 로 끝난다.
+///			필요한 길이 (null 제외) 를 리턴하고, 형식/인코딩 오류면 -1
+int 
+format_to(
+	_Out_writes_z_(buf_size) char* buf, 
+	_In_ size_t buf_size, 
+	_In_z_ _Printf_format_string_ const char* fmt, 
+	...
+	) STR_FORMAT_PRINTF(3, 4);
+
+int 
+vformat_to(
+	_Out_writes_z_(buf_size) char* buf, 
+	_In_ size_t buf_size, 
+	_In_z_ const char* fmt, 
+	_In_ va_list args
+	);
+
+/// @brief	out 의 뒤에 포맷팅한 문자열을 붙인다. 
+///			짧은 결과는 스택 버퍼에 먼저 포맷팅하므로 out 의 capacity 가 
+///			충분하면 할당이 없다.
+bool 
+format_append(
+	_Inout_ std::string& out, 
+	_In_z_ _Printf_format_string_ const char* fmt, 
+	...
+	) STR_FORMAT_PRINTF(2, 3);
+
+bool 
+vformat_append(
+	_Inout_ std::string& out, 
+	_In_z_ const char* fmt, 
+	_In_ va_list args
+	);
+
+/// @brief	스레드별 버퍼에 포맷팅하고 그 포인터를 리턴한다. (형식 오류면 nullptr)
+///			포인터는 같은 스레드에서 다음 format_tls() 를 호출하기 전까지 유효하다.
+const char* 
+format_tls(
+	_In_z_ _Printf_format_string_ const char* fmt, 
+	...
+	) STR_FORMAT_PRINTF(1, 2);
+
+const char* 
+vformat_tls(
+	_In_z_ const char* fmt, 
+	_In_ va_list args
+	);
+
+
+/// @brief	N 바이트 내부 배열에 포맷팅하고 넘치면 std::string 으로 옮긴다.
+template <size_t N>
+class format_buffer
+{
+	static_assert(1 < N, "inline capacity too small");
+
+public:
+	format_buffer() : _len(0), _spilled(false) { _inline[0] = '\0'; }
+
+	format_buffer(const format_buffer&) = delete;
+	format_buffer& operator=(const format_buffer&) = delete;
+
+	/// @brief	포맷팅한 문자열을 뒤에 붙인다. 형식 오류면 false (내용은 그대로)
+	bool append(_In_z_ _Printf_format_string_ const char* fmt, ...)
+	{
+		va_list args;
+		va_start(args, fmt);
+		const bool ret = vappend(fmt, args);
+		va_end(args);
+		return ret;
+	}
+
+	bool vappend(_In_z_ const char* fmt, _In_ va_list args)
+	{
+		if (_spilled) return vformat_append(_spill, fmt, args);
+
+		va_list copy;
+		va_copy(copy, args);
+		const int n = vformat_to(&_inline[_len], N - _len, fmt, copy);
+		va_end(copy);
+		if (0 > n)
+		{
+			_inline[_len] = '\0';
+			return false;
+		}
+		if ((size_t)n < N - _len)
+		{
+			_len += (size_t)n;
+			return true;
+		}
+
+		//
+		//	넘쳤으면 지금까지의 내용을 string 으로 옮기고 다시 포맷팅한다.
+		//
+		_spill.assign(_inline, _len);
+		_spilled = true;
+		_inline[_len] = '\0';
+		return vformat_append(_spill, fmt, args);
+	}
+
+	/// @brief	문자열 그대로 붙인다.
+	void append_raw(_In_reads_(len) const char* str, _In_ size_t len)
+	{
+		if (!_spilled && len < N - _len)
+		{
+			memcpy(&_inline[_len], str, len);
+			_len += len;
+			_inline[_len] = '\0';
+			return;
+		}
+
+		if (!_spilled)
+		{
+			_spill.assign(_inline, _len);
+			_spilled = true;
+		}
+		_spill.append(str, len);
+	}
+
+	/// @brief	내용을 지운다. spill 된 string 의 capacity 는 유지한다.
+	void clear()
+	{
+		_len = 0;
+		_inline[0] = '\0';
+		_spill.clear();
+		_spilled = false;
+	}
+
+	const char* c_str() const { return (_spilled) ? _spill.c_str() : _inline; }
+	size_t size() const { return (_spilled) ? _spill.size() : _len; }
+	bool empty() const { return 0 == size(); }
+	bool spilled() const { return _spilled; }
+	std::string str() const { return std::string(c_str(), size()); }
+
+private:
+	char _inline[N];
+	size_t _len;
+	bool _spilled;
+	std::string _spill;
+};
+
+template <size_t N>
+inline bool 
+format_append(
+	_Inout_ format_buffer<N>& out, 
+	_In_z_ _Printf_format_string_ const char* fmt, 
+	...
+	)
+{
+	va_list args;
+	va_start(args, fmt);
+	const bool ret = out.vappend(fmt, args);
+	va_end(args);
+	return ret;
+}
+
+
+//
+//	컴파일 시간 형식 문자열 검사
+//
+
+/// @brief	형식 문자열과 인자 타입을 비교하는 constexpr 검사기
+///			FORMAT_CHECK() 매크로를 통해서 사용한다.
+class format_checker
+{
+public:
+	enum arg_kind
+	{
+		ak_none,
+		ak_integer,
+		ak_floating,
+		ak_narrow_string,	///< char*, signed/unsigned char*
+		ak_wide_string,		///< wchar_t*
+		ak_pointer,			///< 그 외 포인터, nullptr
+		ak_invalid			///< 클래스 타입 등 printf 에 넘길 수 없는 타입
+	};
+
+	struct arg_desc
+	{
+		arg_kind kind;
+		size_t size;
+	};
+
+	template <typename... Ts>
+	struct type_list {};
+
+	/// @brief	인자 타입 목록 (decltype 안에서만 사용, 정의 없음)
+	template <typename... Ts>
+	static type_list<typename std::decay<Ts>::type...> types(Ts&&...);
+
+	template <typename T>
+	static constexpr arg_desc describe()
+	{
+		typedef typename std::remove_cv<typename std::remove_pointer<T>::type>::type pointee;
+		return 
+			(std::is_integral<T>::value || std::is_enum<T>::value) ? arg_desc{ ak_integer, sizeof(T) } :
+			(std::is_floating_point<T>::value) ? arg_desc{ ak_floating, sizeof(T) } :
+			(std::is_pointer<T>::value && 
+				(std::is_same<pointee, char>::value || 
+				 std::is_same<pointee, signed char>::value || 
+				 std::is_same<pointee, unsigned char>::value)) ? arg_desc{ ak_narrow_string, sizeof(T) } :
+			(std::is_pointer<T>::value && std::is_same<pointee, wchar_t>::value) ? arg_desc{ ak_wide_string, sizeof(T) } :
+			(std::is_pointer<T>::value || std::is_null_pointer<T>::value) ? arg_desc{ ak_pointer, sizeof(T) } :
+			arg_desc{ ak_invalid, sizeof(T) };
+	}
+
+	template <typename... Ts>
+	static constexpr bool check(_In_z_ const char* fmt, type_list<Ts...>)
+	{
+		const arg_desc args[] = { describe<Ts>()..., arg_desc{ ak_none, 0 } };
+		return check_args(fmt, args, sizeof...(Ts));
+	}
+
+	template <bool valid>
+	static constexpr int assert_valid()
+	{
+		static_assert(valid, "format string does not match the arguments");
+		return 0;
+	}
+
+private:
+	/// @brief	정수 인자 크기가 길이 지정자 (needed 바이트) 와 맞는지
+	///			4 바이트 이하는 int 로 승격되므로 4 바이트 이하면 모두 허용
+	static constexpr bool integer_fits(_In_ const arg_desc& arg, _In_ size_t needed)
+	{
+		return (ak_integer == arg.kind && 
+				((needed <= 4) ? (arg.size <= 4) : (arg.size == needed)));
+	}
+
+	static constexpr bool is_digit(_In_ char c) { return ('0' <= c && c <= '9'); }
+
+	static constexpr bool 
+	check_args(
+		_In_z_ const char* fmt, 
+		_In_reads_(count) const arg_desc* args, 
+		_In_ size_t count
+		)
+	{
+		size_t arg = 0;
+		for (const char* p = fmt; '\0' != *p; ++p)
+		{
+			if ('%' != *p) continue;
+			++p;
+			if ('%' == *p) continue;
+
+			//
+			//	flags, width, precision ('*' 는 int 인자를 하나 사용)
+			//
+			while ('-' == *p || '+' == *p || ' ' == *p || '#' == *p || '0' == *p) ++p;
+			if ('*' == *p)
+			{
+				if (arg >= count || !integer_fits(args[arg], 4)) return false;
+				++arg;
+				++p;
+			}
+			while (is_digit(*p)) ++p;
+			if ('.' == *p)
+			{
+				++p;
+				if ('*' == *p)
+				{
+					if (arg >= count || !integer_fits(args[arg], 4)) return false;
+					++arg;
+					++p;
+				}
+				while (is_digit(*p)) ++p;
+			}
+
+			//
+			//	길이 지정자 -> 정수 크기, wide 여부
+			//
+			size_t needed = 4;
+			bool wide = false;
+			bool narrow = false;
+			switch (*p)
+			{
+			case 'h':
+				++p;
+				if ('h' == *p) ++p;
+				narrow = true;
+				break;
+			case 'l':
+				++p;
+				if ('l' == *p)
+				{
+					++p;
+					needed = 8;
+				}
+				else
+				{
+					needed = sizeof(long);
+					wide = true;
+				}
+				break;
+			case 'j': case 'q':
+				++p;
+				needed = 8;
+				break;
+			case 'z': case 't':
+				++p;
+				needed = sizeof(size_t);
+				break;
+			case 'L':
+				++p;
+				break;
+			case 'w':
+				++p;
+				wide = true;
+				break;
+			case 'I':
+				++p;
+				if ('6' == p[0] && '4' == p[1])
+				{
+					p += 2;
+					needed = 8;
+				}
+				else if ('3' == p[0] && '2' == p[1])
+				{
+					p += 2;
+				}
+				else
+				{
+					needed = sizeof(size_t);
+				}
+				break;
+			}
+
+			if (arg >= count) return false;
+			const arg_desc& a = args[arg++];
+			switch (*p)
+			{
+			case 'd': case 'i': case 'o': case 'u': case 'x': case 'X':
+				if (!integer_fits(a, needed)) return false;
+				break;
+			case 'c': case 'C':
+				if (!integer_fits(a, 4)) return false;
+				break;
+			case 's':
+				if (wide && ak_wide_string != a.kind) return false;
+				if (!wide && ak_narrow_string != a.kind) return false;
+				break;
+			case 'S':
+				if ((narrow) ? (ak_narrow_string != a.kind) : (ak_wide_string != a.kind)) return false;
+				break;
+			case 'p':
+				if (ak_pointer != a.kind && ak_narrow_string != a.kind && ak_wide_string != a.kind) return false;
+				break;
+			case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+				if (ak_floating != a.kind) return false;
+				break;
+			default:
+				//	'%n', 알 수 없는 변환, 형식 문자열의 끝
+				return false;
+			}
+		}
+		return (arg == count);
+	}
+};
+
+/// @brief	형식 문자열 (리터럴) 과 인자를 컴파일 시간에 검사한다.
+#define FORMAT_CHECK(fmt, ...) \
+	((void)format_checker::assert_valid<format_checker::check(fmt, decltype(format_checker::types(__VA_ARGS__))())>())
+
+#define FORMAT_TO(buf, buf_size, fmt, ...) \
+	(FORMAT_CHECK(fmt, ##__VA_ARGS__), format_to((buf), (buf_size), fmt, ##__VA_ARGS__))
+
+#define FORMAT_APPEND(out, fmt, ...) \
+	(FORMAT_CHECK(fmt, ##__VA_ARGS__), format_append((out), fmt, ##__VA_ARGS__))
+
+#define FORMAT_TLS(fmt, ...) \
+	(FORMAT_CHECK(fmt, ##__VA_ARGS__), format_tls(fmt, ##__VA_ARGS__))
@@ -0,0 +1,205 @@
+﻿/**
+ * @file    string_tokenizer.h
+ * @brief   Zero-copy string_view tokenizer.
+ *
+ * source 를 복사하지 않고 토큰을 std::basic_string_view 로 하나씩 돌려주는
+ * range. 할당이 전혀 없으며, 리턴된 view 는 source 가 살아있는 동안만 
+ * 유효하다.
+ *
+ *	for (auto token : tokenize(cmdline, L" ", TOKEN_TRIM)) { ... }
+ *
+ *	small_vector<std::wstring_view, 16> parts;		// 재사용하면 할당 없음
+ *	split_string_views(path, L"\\", parts);
+ *
+ * @author  Yonhgwhan, Roh (somma@somma.kr)
+ * @date    2026/10/18 created.
+ * @copyright (C)Somma, Inc. All rights reserved.
+**/
+#pragma once
+#include <stdint.h>
+#include <string_view>
+#include <iterator>
+#include "small_vector.h"
+
+#define TOKEN_TRIM			0x00000001	///< 토큰 앞뒤의 공백 (' ', '\t', '\r', '\n') 을 제거
+#define TOKEN_KEEP_EMPTY	0x00000002	///< 빈 토큰 (연속된 구분자, trim 결과가 빈 토큰) 도 리턴
+
+/// @brief	s 의 앞뒤에서 drop 에 포함된 문자를 제거한 view 
+template <typename CharT>
+inline 
+std::basic_string_view<CharT> 
+trim_view(
+	_In_ std::basic_string_view<CharT> s, 
+	_In_ std::basic_string_view<CharT> drop
+	)
+{
+	const size_t first = s.find_first_not_of(drop);
+	if (std::basic_string_view<CharT>::npos == first) return s.substr(0, 0);
+
+	const size_t last = s.find_last_not_of(drop);
+	return s.substr(first, last - first + 1);
+}
+
+template <typename CharT> struct token_whitespace;
+template <> struct token_whitespace<char> { static const char* chars() { return " \t\r\n"; } };
+template <> struct token_whitespace<wchar_t> { static const wchar_t* chars() { return L" \t\r\n"; } };
+
+/// @brief	lazy 토크나이저 range
+///			구분자가 한 문자이면 문자 검색 (memchr/wmemchr), 여러 문자이면 
+///			부분 문자열 검색을 한다. 구분자가 빈 문자열이면 source 전체가 
+///			하나의 토큰이다.
+template <typename CharT>
+class basic_token_range
+{
+public:
+	typedef std::basic_string_view<CharT> view_type;
+
+	class iterator
+	{
+	public:
+		typedef std::forward_iterator_tag iterator_category;
+		typedef view_type value_type;
+		typedef ptrdiff_t difference_type;
+		typedef const view_type* pointer;
+		typedef const view_type& reference;
+
+		iterator() : _range(nullptr), _next(0) {}
+		iterator(_In_ const basic_token_range* range) : _range(range), _next(0) { advance(); }
+
+		reference operator*() const { return _token; }
+		pointer operator->() const { return &_token; }
+
+		iterator& operator++() { advance(); return *this; }
+		iterator operator++(int) { iterator it = *this; advance(); return it; }
+
+		/// 끝난 iterator 는 _range 가 nullptr 
+		bool operator==(const iterator& rhs) const 
+		{
+			return (_range == rhs._range && (nullptr == _range || _next == rhs._next));
+		}
+		bool operator!=(const iterator& rhs) const { return !(*this == rhs); }
+
+	private:
+		void advance()
+		{
+			const view_type& source = _range->_source;
+			for (;;)
+			{
+				//
+				//	_next 가 source.size() 보다 크면 마지막 토큰까지 리턴한 것
+				//
+				if (_next > source.size())
+				{
+					_range = nullptr;
+					_next = 0;
+					return;
+				}
+
+				size_t end = view_type::npos;
+				if (1 == _range->_delimiter.size())
+				{
+					end = source.find(_range->_delimiter[0], _next);
+				}
+				else if (!_range->_delimiter.empty())
+				{
+					end = source.find(_range->_delimiter, _next);
+				}
+
+				if (view_type::npos == end)
+				{
+					_token = source.substr(_next);
+					_next = source.size() + 1;
+				}
+				else
+				{
+					_token = source.substr(_next, end - _next);
+					_next = end + _range->_delimiter.size();
+				}
+
+				if (0 != (_range->_flags & TOKEN_TRIM))
+				{
+					_token = trim_view(_token, view_type(token_whitespace<CharT>::chars()));
+				}
+				if (!_token.empty() || 0 != (_range->_flags & TOKEN_KEEP_EMPTY)) return;
+			}
+		}
+
+	private:
+		const basic_token_range* _range;
+		size_t _next;
+		view_type _token;
+	};
+
+public:
+	basic_token_range(
+		_In_ view_type source, 
+		_In_ view_type delimiter, 
+		_In_ uint32_t flags = 0
+		) : 
+		_source(source), _delimiter(delimiter), _flags(flags)
+	{}
+
+	iterator begin() const { return iterator(this); }
+	iterator end() const { return iterator(); }
+
+private:
+	view_type _source;
+	view_type _delimiter;
+	uint32_t _flags;
+};
+
+typedef basic_token_range<char> token_range_a;
+typedef basic_token_range<wchar_t> token_range_w;
+
+/// @brief	source 를 delimiter 로 나누는 range 를 리턴한다. 
+///			range 는 source/delimiter 를 복사하지 않으므로 source, delimiter 
+///			보다 오래 사용하면 안된다.
+inline token_range_a tokenize(_In_ std::string_view source, _In_ std::string_view delimiter, _In_ uint32_t flags = 0)
+{
+	return token_range_a(source, delimiter, flags);
+}
+
+inline token_range_w tokenize(_In_ std::wstring_view source, _In_ std::wstring_view delimiter, _In_ uint32_t flags = 0)
+{
+	return token_range_w(source, delimiter, flags);
+}
+
+/// @brief	source 를 토큰으로 나눠서 out 에 채우고 토큰 수를 리턴한다.
+///			out 은 먼저 비우며, capacity 는 유지한다.
+template <typename CharT, size_t N>
+inline 
+size_t 
+split_string_views(
+	_In_ typename small_vector<std::basic_string_view<CharT>, N>::value_type source,
+	_In_ typename small_vector<std::basic_string_view<CharT>, N>::value_type delimiter,
+	_Out_ small_vector<std::basic_string_view<CharT>, N>& out,
+	_In_ uint32_t flags = 0
+	)
+{
+	out.clear();
+	for (const auto& token : basic_token_range<CharT>(source, delimiter, flags))
+	{
+		out.push_back(token);
+	}
+	return out.size();
+}
+
+/// @brief	org 에서 delimiter 를 처음 (first = true) 또는 마지막으로 찾아서 
+///			앞부분 (forward = true) 또는 뒷부분을 out 으로 리턴한다. 
+///			delimiter 가 없으면 org 전체를 리턴한다.
+///			(extract_first_tokenExW(), extract_last_tokenExW() 와 같은 규칙)
+template <typename CharT>
+inline 
+std::basic_string_view<CharT> 
+extract_token_view(
+	_In_ std::basic_string_view<CharT> org, 
+	_In_ std::basic_string_view<CharT> delimiter, 
+	_In_ bool first, 
+	_In_ bool forward
+	)
+{
+	const size_t pos = first ? org.find(delimiter) : org.rfind(delimiter);
+	if (std::basic_string_view<CharT>::npos == pos) return org;
+
+	return forward ? org.substr(0, pos) : org.substr(pos + delimiter.size());
+}
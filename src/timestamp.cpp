@@ -0,0 +1,231 @@
+﻿/**
+ * @file    timestamp.cpp
+ * @brief   Cached, lock-free timestamp formatting for the hot logging path.
+ *
+ * @author  Yonhgwhan, Roh (somma@somma.kr)
+ * @date    2026/10/18 created.
+ * @copyright (C)Somma, Inc. All rights reserved.
+**/
+#include "stdafx.h"
+#include "timestamp.h"
+#include <string.h>
+#include <time.h>
+#include <atomic>
+#include <chrono>
+
+/// @brief	초 하나에 대해 미리 만들어둔 문자열
+typedef struct timestamp_entry
+{
+	int64_t second;			///< unix time (초)
+	char date_time[19];		///< "YYYY-MM-DD hh:mm:ss" (null 없음)
+	char tz[6];				///< "+09:00" 또는 "Z" (null 없음)
+	uint8_t tz_len;
+} *ptimestamp_entry;
+
+/// @brief	seq 가 0 이면 빈 슬롯, 홀수이면 쓰는 중
+typedef struct alignas(64) timestamp_slot
+{
+	std::atomic<uint64_t> seq;
+	timestamp_entry entry;
+} *ptimestamp_slot;
+
+/// [0] utc, [1] localtime
+static timestamp_slot _slots[2];
+
+
+int64_t timestamp_now_msec(_In_ timestamp_clock clock)
+{
+	if (timestamp_clock::coarse == clock)
+	{
+#ifdef _WIN32
+		FILETIME ft;
+		GetSystemTimeAsFileTime(&ft);
+		return timestamp_msec_from_filetime(((uint64_t)ft.dwHighDateTime << 32) | ft.dwLowDateTime);
+#elif defined(CLOCK_REALTIME_COARSE)
+		struct timespec ts;
+		if (0 == clock_gettime(CLOCK_REALTIME_COARSE, &ts))
+		{
+			return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+		}
+#endif
+	}
+
+	return std::chrono::duration_cast<std::chrono::milliseconds>(
+		std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+/// @brief	1970-01-01 부터의 날짜 수를 년/월/일로 변환한다. 
+///			(Howard Hinnant, "chrono-Compatible Low-Level Date Algorithms")
+static void civil_from_days(_In_ int64_t days, _Out_ int64_t& y, _Out_ uint32_t& m, _Out_ uint32_t& d)
+{
+	days += 719468;
+	const int64_t era = ((days >= 0) ? days : days - 146096) / 146097;
+	const uint32_t doe = (uint32_t)(days - era * 146097);
+	const uint32_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+	const uint32_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+	const uint32_t mp = (5 * doy + 2) / 153;
+
+	d = doy - (153 * mp + 2) / 5 + 1;
+	m = (mp < 10) ? mp + 3 : mp - 9;
+	y = (int64_t)yoe + era * 400 + ((m <= 2) ? 1 : 0);
+}
+
+static void put2(_Out_writes_(2) char* pos, _In_ uint32_t v)
+{
+	pos[0] = (char)('0' + v / 10);
+	pos[1] = (char)('0' + v % 10);
+}
+
+/// @brief	second 의 utc 와 지역 시각의 차이 (초)
+///			Windows 에서는 SystemTimeToTzSpecificLocalTime() 을 사용하므로 
+///			1970 년 이전 시각과 일광 절약 시간도 처리된다. 
+static bool local_offset(_In_ int64_t second, _Out_ int64_t& offset)
+{
+	offset = 0;
+#ifdef _WIN32
+	uint64_t utc = (uint64_t)(second * 10000000 + 116444736000000000ll);
+	FILETIME utc_ft;
+	utc_ft.dwLowDateTime = (DWORD)(utc & 0xffffffff);
+	utc_ft.dwHighDateTime = (DWORD)(utc >> 32);
+
+	SYSTEMTIME utc_st;
+	SYSTEMTIME local_st;
+	FILETIME local_ft;
+	if (!FileTimeToSystemTime(&utc_ft, &utc_st) ||
+		!SystemTimeToTzSpecificLocalTime(NULL, &utc_st, &local_st) ||
+		!SystemTimeToFileTime(&local_st, &local_ft))
+	{
+		return false;
+	}
+
+	const uint64_t local = ((uint64_t)local_ft.dwHighDateTime << 32) | local_ft.dwLowDateTime;
+	offset = ((int64_t)local - (int64_t)utc) / 10000000;
+	return true;
+#else
+	const time_t t = (time_t)second;
+	struct tm tm;
+	if (nullptr == localtime_r(&t, &tm)) return false;
+	offset = (int64_t)tm.tm_gmtoff;
+	return true;
+#endif
+}
+
+/// @brief	second 에 대한 entry 를 만든다. (캐시 미스, 초마다 한번)
+static bool render_entry(_In_ int64_t second, _In_ bool localtime, _Out_ timestamp_entry& entry)
+{
+	entry.second = second;
+
+	int64_t offset = 0;
+	if (localtime)
+	{
+		if (!local_offset(second, offset)) return false;
+
+		const int64_t abs_offset = (offset < 0) ? -offset : offset;
+		entry.tz[0] = (offset < 0) ? '-' : '+';
+		put2(&entry.tz[1], (uint32_t)(abs_offset / 3600 % 100));
+		entry.tz[3] = ':';
+		put2(&entry.tz[4], (uint32_t)(abs_offset % 3600 / 60));
+		entry.tz_len = 6;
+	}
+	else
+	{
+		entry.tz[0] = 'Z';
+		entry.tz_len = 1;
+	}
+
+	const int64_t t = second + offset;
+	const int64_t days = (t >= 0) ? t / 86400 : -((-t + 86399) / 86400);
+	const uint32_t sod = (uint32_t)(t - days * 86400);
+
+	int64_t year;
+	uint32_t month;
+	uint32_t day;
+	civil_from_days(days, year, month, day);
+	if (year < 0 || year > 9999) return false;
+
+	char* pos = entry.date_time;
+	put2(&pos[0], (uint32_t)(year / 100));
+	put2(&pos[2], (uint32_t)(year % 100));
+	pos[4] = '-';
+	put2(&pos[5], month);
+	pos[7] = '-';
+	put2(&pos[8], day);
+	pos[10] = ' ';
+	put2(&pos[11], sod / 3600);
+	pos[13] = ':';
+	put2(&pos[14], sod % 3600 / 60);
+	pos[16] = ':';
+	put2(&pos[17], sod % 60);
+	return true;
+}
+
+/// @brief	슬롯에 second 에 대한 entry 가 있으면 복사한다. 
+static bool read_slot(_In_ const timestamp_slot& slot, _In_ int64_t second, _Out_ timestamp_entry& entry)
+{
+	const uint64_t seq = slot.seq.load(std::memory_order_acquire);
+	if (0 == seq || 0 != (seq & 1)) return false;
+
+	memcpy(&entry, &slot.entry, sizeof(entry));
+
+	std::atomic_thread_fence(std::memory_order_acquire);
+	return seq == slot.seq.load(std::memory_order_relaxed) && second == entry.second;
+}
+
+/// @brief	entry 를 슬롯에 저장한다. 
+///			다른 스레드가 쓰고 있으면 기다리지 않고 포기한다. 
+static void write_slot(_Inout_ timestamp_slot& slot, _In_ const timestamp_entry& entry)
+{
+	uint64_t seq = slot.seq.load(std::memory_order_relaxed);
+	if (0 != (seq & 1)) return;
+	if (!slot.seq.compare_exchange_strong(seq, seq + 1, std::memory_order_relaxed)) return;
+
+	std::atomic_thread_fence(std::memory_order_release);
+	memcpy(&slot.entry, &entry, sizeof(entry));
+	slot.seq.store(seq + 2, std::memory_order_release);
+}
+
+size_t
+format_timestamp(
+	_In_ int64_t unix_msec,
+	_In_ bool localtime,
+	_In_ timestamp_style style,
+	_Out_writes_z_(buf_size) char* buf,
+	_In_ size_t buf_size
+	)
+{
+	_ASSERTE(nullptr != buf);
+	if (nullptr == buf || 0 == buf_size) return 0;
+	buf[0] = '\0';
+
+	const int64_t second = (unix_msec >= 0) ? unix_msec / 1000 : -((-unix_msec + 999) / 1000);
+	const uint32_t msec = (uint32_t)(unix_msec - second * 1000);
+
+	timestamp_slot& slot = _slots[localtime ? 1 : 0];
+	timestamp_entry entry;
+	if (!read_slot(slot, second, entry))
+	{
+		if (!render_entry(second, localtime, entry)) return 0;
+		write_slot(slot, entry);
+	}
+
+	size_t len = sizeof(entry.date_time);
+	if (timestamp_style::date_time != style) len += 4;
+	if (timestamp_style::iso8601 == style) len += entry.tz_len;
+	if (buf_size <= len) return 0;
+
+	memcpy(buf, entry.date_time, sizeof(entry.date_time));
+	if (timestamp_style::date_time != style)
+	{
+		char* pos = &buf[sizeof(entry.date_time)];
+		pos[0] = '.';
+		pos[1] = (char)('0' + msec / 100);
+		put2(&pos[2], msec % 100);
+	}
+	if (timestamp_style::iso8601 == style)
+	{
+		buf[10] = 'T';
+		memcpy(&buf[sizeof(entry.date_time) + 4], entry.tz, entry.tz_len);
+	}
+	buf[len] = '\0';
+	return len;
+}
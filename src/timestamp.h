@@ -0,0 +1,77 @@
+﻿/**
+ * @file    timestamp.h
+ * @brief   Cached, lock-free timestamp formatting for the hot logging path.
+ *
+ * 로그 한줄마다 시각을 가져오고, 타임존 변환을 하고, printf 로 포맷팅하던 것을
+ * 초 단위로 캐시한다. 
+ * 
+ *	- "YYYY-MM-DD hh:mm:ss" 와 타임존 접미사 ("+09:00") 를 초마다 한번만 
+ *	  만들어서 (utc, localtime) 슬롯에 저장해두고, 같은 초 안에서는 
+ *	  복사한 뒤 밀리초만 고쳐 쓴다.
+ *	- 슬롯은 seqlock 으로 보호한다. 읽기는 락이 없고, 슬롯을 쓰고 있는 
+ *	  중이면 기다리지 않고 직접 만든다. 
+ *	- timestamp_clock::coarse 는 정밀도 대신 (타이머 틱 단위) 시각을 읽는
+ *	  비용을 줄인다. 
+ *	- Windows 가 아닌 환경에서도 동작한다. (localtime_r, clock_gettime)
+ *
+ *	시각은 1970-01-01 00:00:00 UTC 부터의 밀리초 (unix_msec) 로 다룬다.
+ *
+ * @author  Yonhgwhan, Roh (somma@somma.kr)
+ * @date    2026/10/18 created.
+ * @copyright (C)Somma, Inc. All rights reserved.
+**/
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+/// 포맷팅 결과를 담기에 충분한 버퍼 크기 (null 포함)
+#define TIMESTAMP_BUF_SIZE		32
+
+enum class timestamp_clock
+{
+	precise,		///< 가능한 가장 정밀한 시스템 시각
+	coarse			///< 타이머 틱 단위 (수 ms) 시각, 읽는 비용이 가장 적다.
+};
+
+enum class timestamp_style
+{
+	date_time,		///< 2017-05-23 21:23:24
+	date_time_msec,	///< 2017-05-23 21:23:24.821
+	iso8601			///< 2017-05-23T21:23:24.821+09:00 (utc 이면 2017-05-23T12:23:24.821Z)
+};
+
+/// @brief	현재 시각 (unix_msec)
+int64_t timestamp_now_msec(_In_ timestamp_clock clock = timestamp_clock::precise);
+
+/// @brief	FILETIME (1601-01-01 부터의 100ns 단위) 을 unix_msec 로 변환한다.
+inline int64_t timestamp_msec_from_filetime(_In_ uint64_t file_time)
+{
+	const int64_t ticks = (int64_t)file_time - 116444736000000000ll;
+	return (ticks >= 0) ? ticks / 10000 : -((-ticks + 9999) / 10000);
+}
+
+/// @brief	unix_msec 를 style 형식으로 buf 에 쓰고 null 을 붙인다. 
+///			localtime 이 true 이면 현재 타임존의 지역 시각으로 변환한다.
+/// @return	쓴 문자 수 (null 제외), buf 가 작거나 연도가 0 ~ 9999 를 
+///			벗어나면 0
+size_t 
+format_timestamp(
+	_In_ int64_t unix_msec, 
+	_In_ bool localtime, 
+	_In_ timestamp_style style, 
+	_Out_writes_z_(buf_size) char* buf, 
+	_In_ size_t buf_size
+	);
+
+/// @brief	현재 시각을 style 형식으로 buf 에 쓴다. 
+inline size_t 
+format_timestamp_now(
+	_In_ bool localtime, 
+	_In_ timestamp_style style, 
+	_Out_writes_z_(buf_size) char* buf, 
+	_In_ size_t buf_size,
+	_In_ timestamp_clock clock = timestamp_clock::precise
+	)
+{
+	return format_timestamp(timestamp_now_msec(clock), localtime, style, buf, buf_size);
+}
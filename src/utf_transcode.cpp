@@ -0,0 +1,520 @@
+﻿/**
+ * @file    utf_transcode.cpp
+ * @brief   Portable UTF-8 <-> UTF-16 transcoder with SIMD ASCII fast path.
+ *
+ * @author  Yonhgwhan, Roh (somma@somma.kr)
+ * @date    2026/10/18 created.
+ * @copyright (C)Somma, Inc. All rights reserved.
+**/
+#include "stdafx.h"
+#include "utf_transcode.h"
+#include "cpu_features.h"
+#include <string.h>
+#include <atomic>
+
+//
+//	커널은 선두의 ASCII 문자를 변환 (또는 검사) 하고 그 갯수를 리턴한다. 
+//	in[0] 이 ASCII 이면 1 이상을 리턴해야 한다. 
+//
+//	widen/narrow 커널은 블록 단위로 쓰기 때문에 리턴한 갯수 이후의 출력 
+//	위치에도 값을 쓸 수 있지만 out[0] ~ out[in_len - 1] 범위를 벗어나지는 
+//	않는다. (호출자는 출력 버퍼가 최대 길이 이상인 것을 보장한다)
+//
+typedef size_t (*utf_widen_fn)(const uint8_t* in, size_t in_len, uint16_t* out);
+typedef size_t (*utf_narrow_fn)(const uint16_t* in, size_t in_len, uint8_t* out);
+typedef size_t (*utf_ascii8_fn)(const uint8_t* in, size_t in_len);
+typedef size_t (*utf_ascii16_fn)(const uint16_t* in, size_t in_len);
+
+#if defined(CPU_FEATURES_X86)
+size_t utf_widen_ascii_sse2(const uint8_t* in, size_t in_len, uint16_t* out);
+size_t utf_widen_ascii_avx2(const uint8_t* in, size_t in_len, uint16_t* out);
+size_t utf_narrow_ascii_sse2(const uint16_t* in, size_t in_len, uint8_t* out);
+size_t utf_narrow_ascii_avx2(const uint16_t* in, size_t in_len, uint8_t* out);
+size_t utf_ascii_length8_sse2(const uint8_t* in, size_t in_len);
+size_t utf_ascii_length8_avx2(const uint8_t* in, size_t in_len);
+size_t utf_ascii_length16_sse2(const uint16_t* in, size_t in_len);
+size_t utf_ascii_length16_avx2(const uint16_t* in, size_t in_len);
+#endif
+
+//
+//	스칼라 구현은 8 바이트 단위로 (SWAR) 검사한다.
+//
+static size_t utf_widen_ascii_scalar(const uint8_t* in, size_t in_len, uint16_t* out)
+{
+	size_t done = 0;
+	for (; in_len - done >= 8; done += 8)
+	{
+		uint64_t v;
+		memcpy(&v, &in[done], sizeof(v));
+		if (0 != (v & 0x8080808080808080ULL)) break;
+
+		for (size_t i = 0; i < 8; ++i)
+		{
+			out[done + i] = in[done + i];
+		}
+	}
+
+	for (; done < in_len && in[done] < 0x80; ++done)
+	{
+		out[done] = in[done];
+	}
+	return done;
+}
+
+static size_t utf_narrow_ascii_scalar(const uint16_t* in, size_t in_len, uint8_t* out)
+{
+	size_t done = 0;
+	for (; in_len - done >= 4; done += 4)
+	{
+		uint64_t v;
+		memcpy(&v, &in[done], sizeof(v));
+		if (0 != (v & 0xff80ff80ff80ff80ULL)) break;
+
+		for (size_t i = 0; i < 4; ++i)
+		{
+			out[done + i] = (uint8_t)in[done + i];
+		}
+	}
+
+	for (; done < in_len && in[done] < 0x80; ++done)
+	{
+		out[done] = (uint8_t)in[done];
+	}
+	return done;
+}
+
+static size_t utf_ascii_length8_scalar(const uint8_t* in, size_t in_len)
+{
+	size_t done = 0;
+	for (; in_len - done >= 8; done += 8)
+	{
+		uint64_t v;
+		memcpy(&v, &in[done], sizeof(v));
+		if (0 != (v & 0x8080808080808080ULL)) break;
+	}
+
+	while (done < in_len && in[done] < 0x80) ++done;
+	return done;
+}
+
+static size_t utf_ascii_length16_scalar(const uint16_t* in, size_t in_len)
+{
+	size_t done = 0;
+	for (; in_len - done >= 4; done += 4)
+	{
+		uint64_t v;
+		memcpy(&v, &in[done], sizeof(v));
+		if (0 != (v & 0xff80ff80ff80ff80ULL)) break;
+	}
+
+	while (done < in_len && in[done] < 0x80) ++done;
+	return done;
+}
+
+typedef struct utf_kernels
+{
+	int impl;
+	utf_widen_fn widen_ascii;
+	utf_narrow_fn narrow_ascii;
+	utf_ascii8_fn ascii_length8;
+	utf_ascii16_fn ascii_length16;
+} *putf_kernels;
+
+static const utf_kernels _kernels_scalar = { 
+	UTF_IMPL_SCALAR, 
+	utf_widen_ascii_scalar, 
+	utf_narrow_ascii_scalar, 
+	utf_ascii_length8_scalar, 
+	utf_ascii_length16_scalar 
+};
+#if defined(CPU_FEATURES_X86)
+static const utf_kernels _kernels_sse2 = { 
+	UTF_IMPL_SSE2, 
+	utf_widen_ascii_sse2, 
+	utf_narrow_ascii_sse2, 
+	utf_ascii_length8_sse2, 
+	utf_ascii_length16_sse2 
+};
+static const utf_kernels _kernels_avx2 = { 
+	UTF_IMPL_AVX2, 
+	utf_widen_ascii_avx2, 
+	utf_narrow_ascii_avx2, 
+	utf_ascii_length8_avx2, 
+	utf_ascii_length16_avx2 
+};
+#endif
+
+static const utf_kernels* utf_impl_kernels(int impl)
+{
+	switch (impl)
+	{
+	case UTF_IMPL_SCALAR:
+		return &_kernels_scalar;
+#if defined(CPU_FEATURES_X86)
+	case UTF_IMPL_SSE2:
+		return get_cpu_features().sse2 ? &_kernels_sse2 : nullptr;
+	case UTF_IMPL_AVX2:
+		return get_cpu_features().avx2 ? &_kernels_avx2 : nullptr;
+#endif
+	}
+	return nullptr;
+}
+
+static int utf_best_impl()
+{
+	if (nullptr != utf_impl_kernels(UTF_IMPL_AVX2)) return UTF_IMPL_AVX2;
+	if (nullptr != utf_impl_kernels(UTF_IMPL_SSE2)) return UTF_IMPL_SSE2;
+	return UTF_IMPL_SCALAR;
+}
+
+static std::atomic<const utf_kernels*> _kernels(nullptr);
+
+static const utf_kernels* utf_get_kernels()
+{
+	const utf_kernels* kernels = _kernels.load(std::memory_order_relaxed);
+	if (nullptr == kernels)
+	{
+		kernels = utf_impl_kernels(utf_best_impl());
+		_kernels.store(kernels, std::memory_order_relaxed);
+	}
+	return kernels;
+}
+
+/// @brief	변환 함수들이 사용할 구현을 선택한다.
+///			UTF_IMPL_AUTO 는 CPU 가 지원하는 가장 빠른 구현을 선택한다.
+bool utf_transcode_set_impl(int impl)
+{
+	if (UTF_IMPL_AUTO == impl)
+	{
+		impl = utf_best_impl();
+	}
+
+	const utf_kernels* kernels = utf_impl_kernels(impl);
+	if (nullptr == kernels) return false;
+
+	_kernels.store(kernels, std::memory_order_relaxed);
+	return true;
+}
+
+int utf_transcode_get_impl()
+{
+	return utf_get_kernels()->impl;
+}
+
+bool utf_transcode_impl_supported(int impl)
+{
+	return (UTF_IMPL_AUTO == impl || nullptr != utf_impl_kernels(impl));
+}
+
+const char* utf_transcode_impl_name(int impl)
+{
+	switch (impl)
+	{
+	case UTF_IMPL_AUTO: return "auto";
+	case UTF_IMPL_SCALAR: return "scalar";
+	case UTF_IMPL_SSE2: return "sse2";
+	case UTF_IMPL_AVX2: return "avx2";
+	}
+	return "unknown";
+}
+
+static inline bool is_continuation(uint32_t c)
+{
+	return (0x80 == (c & 0xc0));
+}
+
+/// @brief	UTF-8 을 검증하고, out 이 nullptr 이 아니면 UTF-16 으로 변환한다.
+static bool 
+utf8_decode(
+	_In_ const utf_kernels* kernels,
+	_In_reads_(in_len) const uint8_t* in, 
+	_In_ size_t in_len, 
+	_Out_writes_to_opt_(in_len, out_len) uint16_t* out, 
+	_Out_ size_t& out_len
+	)
+{
+	out_len = 0;
+
+	size_t i = 0;
+	size_t o = 0;
+	while (i < in_len)
+	{
+		uint32_t c = in[i];
+		if (c < 0x80)
+		{
+			const size_t n = (nullptr != out) ? 
+				kernels->widen_ascii(&in[i], in_len - i, &out[o]) :
+				kernels->ascii_length8(&in[i], in_len - i);
+			_ASSERTE(0 < n);
+			i += n;
+			o += n;
+			continue;
+		}
+
+		//
+		//	C0, C1 : overlong 2 바이트, F5 ~ FF : U+10FFFF 초과
+		//	
+		if (c < 0xc2) return false;
+		if (c < 0xe0)
+		{
+			if (in_len - i < 2 || !is_continuation(in[i + 1])) return false;
+			if (nullptr != out)
+			{
+				out[o] = (uint16_t)(((c & 0x1f) << 6) | (in[i + 1] & 0x3f));
+			}
+			i += 2;
+			o += 1;
+		}
+		else if (c < 0xf0)
+		{
+			if (in_len - i < 3) return false;
+
+			const uint32_t c1 = in[i + 1];
+			const uint32_t c2 = in[i + 2];
+			if (!is_continuation(c1) || !is_continuation(c2)) return false;
+			if (0xe0 == c && c1 < 0xa0) return false;		// overlong
+			if (0xed == c && c1 > 0x9f) return false;		// U+D800 ~ U+DFFF
+
+			if (nullptr != out)
+			{
+				out[o] = (uint16_t)(((c & 0x0f) << 12) | ((c1 & 0x3f) << 6) | (c2 & 0x3f));
+			}
+			i += 3;
+			o += 1;
+		}
+		else if (c < 0xf5)
+		{
+			if (in_len - i < 4) return false;
+
+			const uint32_t c1 = in[i + 1];
+			const uint32_t c2 = in[i + 2];
+			const uint32_t c3 = in[i + 3];
+			if (!is_continuation(c1) || !is_continuation(c2) || !is_continuation(c3)) return false;
+			if (0xf0 == c && c1 < 0x90) return false;		// overlong
+			if (0xf4 == c && c1 > 0x8f) return false;		// U+10FFFF 초과
+
+			if (nullptr != out)
+			{
+				c = (((c & 0x07) << 18) | ((c1 & 0x3f) << 12) | ((c2 & 0x3f) << 6) | (c3 & 0x3f)) - 0x10000;
+				out[o] = (uint16_t)(0xd800 | (c >> 10));
+				out[o + 1] = (uint16_t)(0xdc00 | (c & 0x3ff));
+			}
+			i += 4;
+			o += 2;
+		}
+		else
+		{
+			return false;
+		}
+	}
+
+	out_len = o;
+	return true;
+}
+
+static bool 
+utf16_encode(
+	_In_ const utf_kernels* kernels,
+	_In_reads_(in_len) const uint16_t* in, 
+	_In_ size_t in_len, 
+	_Out_writes_to_(in_len * 3, out_len) uint8_t* out, 
+	_Out_ size_t& out_len, 
+	_In_ bool strict
+	)
+{
+	out_len = 0;
+
+	size_t i = 0;
+	size_t o = 0;
+	while (i < in_len)
+	{
+		uint32_t c = in[i];
+		if (c < 0x80)
+		{
+			const size_t n = kernels->narrow_ascii(&in[i], in_len - i, &out[o]);
+			_ASSERTE(0 < n);
+			i += n;
+			o += n;
+			continue;
+		}
+
+		if (c < 0x800)
+		{
+			out[o] = (uint8_t)(0xc0 | (c >> 6));
+			out[o + 1] = (uint8_t)(0x80 | (c & 0x3f));
+			i += 1;
+			o += 2;
+			continue;
+		}
+
+		if (0xd800 == (c & 0xf800))
+		{
+			if (0xd800 == (c & 0xfc00) && 
+				i + 1 < in_len && 
+				0xdc00 == (in[i + 1] & 0xfc00))
+			{
+				c = 0x10000 + (((c & 0x3ff) << 10) | (in[i + 1] & 0x3ff));
+				out[o] = (uint8_t)(0xf0 | (c >> 18));
+				out[o + 1] = (uint8_t)(0x80 | ((c >> 12) & 0x3f));
+				out[o + 2] = (uint8_t)(0x80 | ((c >> 6) & 0x3f));
+				out[o + 3] = (uint8_t)(0x80 | (c & 0x3f));
+				i += 2;
+				o += 4;
+				continue;
+			}
+
+			//
+			//	짝이 맞지 않는 surrogate
+			//
+			if (strict) return false;
+			c = 0xfffd;
+		}
+
+		out[o] = (uint8_t)(0xe0 | (c >> 12));
+		out[o + 1] = (uint8_t)(0x80 | ((c >> 6) & 0x3f));
+		out[o + 2] = (uint8_t)(0x80 | (c & 0x3f));
+		i += 1;
+		o += 3;
+	}
+
+	out_len = o;
+	return true;
+}
+
+/// @brief	선두의 ASCII (0x00~0x7f) 문자 수
+size_t ascii_prefix_length(_In_reads_(in_len) const char* in, _In_ size_t in_len)
+{
+	if (nullptr == in || 0 == in_len) return 0;
+	return utf_get_kernels()->ascii_length8((const uint8_t*)in, in_len);
+}
+
+size_t ascii_prefix_length(_In_reads_(in_len) const char16_t* in, _In_ size_t in_len)
+{
+	if (nullptr == in || 0 == in_len) return 0;
+	return utf_get_kernels()->ascii_length16((const uint16_t*)in, in_len);
+}
+
+bool is_valid_utf8(_In_reads_(in_len) const char* in, _In_ size_t in_len)
+{
+	if (nullptr == in) return (0 == in_len);
+
+	size_t out_len = 0;
+	return utf8_decode(utf_get_kernels(), (const uint8_t*)in, in_len, nullptr, out_len);
+}
+
+/// @brief	UTF-8 을 UTF-16 으로 변환한다. 
+bool 
+utf8_to_utf16(
+	_In_reads_(in_len) const char* in, 
+	_In_ size_t in_len, 
+	_Out_writes_to_(out_size, out_len) char16_t* out, 
+	_In_ size_t out_size, 
+	_Out_ size_t& out_len
+	)
+{
+	out_len = 0;
+	if (0 == in_len) return true;
+	if (nullptr == in || nullptr == out) return false;
+
+	if (out_size < utf8_to_utf16_max_length(in_len))
+	{
+		log_err "output buffer too small. required=%zu, size=%zu", 
+			utf8_to_utf16_max_length(in_len), 
+			out_size 
+			log_end;
+		return false;
+	}
+
+	return utf8_decode(utf_get_kernels(), (const uint8_t*)in, in_len, (uint16_t*)out, out_len);
+}
+
+/// @brief	UTF-16 을 UTF-8 로 변환한다. 
+bool 
+utf16_to_utf8(
+	_In_reads_(in_len) const char16_t* in, 
+	_In_ size_t in_len, 
+	_Out_writes_to_(out_size, out_len) char* out, 
+	_In_ size_t out_size, 
+	_Out_ size_t& out_len, 
+	_In_ bool strict
+	)
+{
+	out_len = 0;
+	if (0 == in_len) return true;
+	if (nullptr == in || nullptr == out) return false;
+
+	if (out_size < utf16_to_utf8_max_length(in_len))
+	{
+		log_err "output buffer too small. required=%zu, size=%zu", 
+			utf16_to_utf8_max_length(in_len), 
+			out_size 
+			log_end;
+		return false;
+	}
+
+	return utf16_encode(utf_get_kernels(), (const uint16_t*)in, in_len, (uint8_t*)out, out_len, strict);
+}
+
+template <typename string_type>
+static bool utf8_to_utf16_string(const char* in, size_t in_len, string_type& out)
+{
+	static_assert(sizeof(typename string_type::value_type) == sizeof(uint16_t), "not a UTF-16 string");
+
+	out.resize(utf8_to_utf16_max_length(in_len));
+	if (0 == in_len) return true;
+
+	size_t out_len = 0;
+	if (nullptr == in || 
+		!utf8_decode(utf_get_kernels(), (const uint8_t*)in, in_len, (uint16_t*)&out[0], out_len))
+	{
+		out.clear();
+		return false;
+	}
+	out.resize(out_len);
+	return true;
+}
+
+/// @brief	out 을 최대 길이로 한번만 resize 하고 변환한 뒤 실제 길이로 줄인다. 
+bool 
+utf8_to_utf16(
+	_In_reads_(in_len) const char* in, 
+	_In_ size_t in_len, 
+	_Out_ std::u16string& out
+	)
+{
+	return utf8_to_utf16_string(in, in_len, out);
+}
+
+#if WCHAR_MAX == 0xffff
+bool 
+utf8_to_utf16(
+	_In_reads_(in_len) const char* in, 
+	_In_ size_t in_len, 
+	_Out_ std::wstring& out
+	)
+{
+	return utf8_to_utf16_string(in, in_len, out);
+}
+#endif//WCHAR_MAX == 0xffff
+
+bool 
+utf16_to_utf8(
+	_In_reads_(in_len) const char16_t* in, 
+	_In_ size_t in_len, 
+	_Out_ std::string& out, 
+	_In_ bool strict
+	)
+{
+	out.resize(utf16_to_utf8_max_length(in_len));
+	if (0 == in_len) return true;
+
+	size_t out_len = 0;
+	if (nullptr == in || 
+		!utf16_encode(utf_get_kernels(), (const uint16_t*)in, in_len, (uint8_t*)&out[0], out_len, strict))
+	{
+		out.clear();
+		return false;
+	}
+	out.resize(out_len);
+	return true;
+}
@@ -0,0 +1,145 @@
+﻿/**
+ * @file    utf_transcode.h
+ * @brief   Portable UTF-8 <-> UTF-16 transcoder with SIMD ASCII fast path.
+ *
+ * Win32 API (MultiByteToWideChar/WideCharToMultiByte) 를 사용하지 않으므로 
+ * 플랫폼에 상관없이 빌드/테스트할 수 있다. ASCII 구간은 SSE2/AVX2 커널 
+ * (CPU 에 따라 런타임에 선택) 이 한번에 16/32 문자씩 변환하고, 그 외의 
+ * 문자는 스칼라 코드가 검증하면서 변환한다.
+ *
+ *	- UTF-8 -> UTF-16 : 엄격하게 검증한다. overlong, surrogate (U+D800~U+DFFF), 
+ *	  U+10FFFF 초과, 잘린 시퀀스가 있으면 false 
+ *	  (MultiByteToWideChar(CP_UTF8, MB_ERR_INVALID_CHARS) 와 같음)
+ *	- UTF-16 -> UTF-8 : 짝이 맞지 않는 surrogate 는 U+FFFD 로 바꾼다. 
+ *	  (WideCharToMultiByte(CP_UTF8, 0) 와 같음) strict 이면 false
+ *	- 출력 버퍼는 최대 길이 (utf8_to_utf16_max_length(), utf16_to_utf8_max_length()) 
+ *	  이상이어야 한다. 길이를 구하기 위해 두번 변환하지 않는다.
+ *	- null 문자를 붙이지 않는다. 
+ *
+ * @author  Yonhgwhan, Roh (somma@somma.kr)
+ * @date    2026/10/18 created.
+ * @copyright (C)Somma, Inc. All rights reserved.
+**/
+#pragma once
+#include <stdint.h>
+#include <wchar.h>
+#include <string>
+
+#define UTF_IMPL_AUTO		0
+#define UTF_IMPL_SCALAR		1
+#define UTF_IMPL_SSE2		2
+#define UTF_IMPL_AVX2		3
+
+bool utf_transcode_set_impl(int impl);
+int utf_transcode_get_impl();
+bool utf_transcode_impl_supported(int impl);
+const char* utf_transcode_impl_name(int impl);
+
+/// @brief	UTF-8 in_len 바이트를 변환한 UTF-16 의 최대 길이 (문자 수)
+inline size_t utf8_to_utf16_max_length(size_t in_len) { return in_len; }
+
+/// @brief	UTF-16 in_len 문자를 변환한 UTF-8 의 최대 길이 (바이트 수)
+inline size_t utf16_to_utf8_max_length(size_t in_len) { return in_len * 3; }
+
+/// @brief	선두의 ASCII (0x00~0x7f) 문자 수
+size_t ascii_prefix_length(_In_reads_(in_len) const char* in, _In_ size_t in_len);
+size_t ascii_prefix_length(_In_reads_(in_len) const char16_t* in, _In_ size_t in_len);
+
+bool is_valid_utf8(_In_reads_(in_len) const char* in, _In_ size_t in_len);
+
+/// @brief	UTF-8 을 UTF-16 으로 변환한다. 
+///			out_size 가 utf8_to_utf16_max_length(in_len) 보다 작거나 
+///			입력이 올바른 UTF-8 이 아니면 false
+bool 
+utf8_to_utf16(
+	_In_reads_(in_len) const char* in, 
+	_In_ size_t in_len, 
+	_Out_writes_to_(out_size, out_len) char16_t* out, 
+	_In_ size_t out_size, 
+	_Out_ size_t& out_len
+	);
+
+/// @brief	UTF-16 을 UTF-8 로 변환한다. 
+///			out_size 가 utf16_to_utf8_max_length(in_len) 보다 작으면 false
+bool 
+utf16_to_utf8(
+	_In_reads_(in_len) const char16_t* in, 
+	_In_ size_t in_len, 
+	_Out_writes_to_(out_size, out_len) char* out, 
+	_In_ size_t out_size, 
+	_Out_ size_t& out_len, 
+	_In_ bool strict = false
+	);
+
+/// @brief	out 을 최대 길이로 한번만 resize 하고 변환한 뒤 실제 길이로 줄인다. 
+///			out 의 capacity 는 유지되므로 같은 문자열을 재사용하면 할당이 없다.
+///			실패하면 out 은 빈 문자열
+bool 
+utf8_to_utf16(
+	_In_reads_(in_len) const char* in, 
+	_In_ size_t in_len, 
+	_Out_ std::u16string& out
+	);
+
+bool 
+utf16_to_utf8(
+	_In_reads_(in_len) const char16_t* in, 
+	_In_ size_t in_len, 
+	_Out_ std::string& out, 
+	_In_ bool strict = false
+	);
+
+//
+//	windows 의 wchar_t 는 UTF-16 이므로 wchar_t/std::wstring 을 바로 사용할 수 있다.
+//
+#if WCHAR_MAX == 0xffff
+static_assert(sizeof(wchar_t) == sizeof(char16_t), "wchar_t is not UTF-16");
+
+inline size_t ascii_prefix_length(_In_reads_(in_len) const wchar_t* in, _In_ size_t in_len)
+{
+	return ascii_prefix_length((const char16_t*)in, in_len);
+}
+
+inline bool 
+utf8_to_utf16(
+	_In_reads_(in_len) const char* in, 
+	_In_ size_t in_len, 
+	_Out_writes_to_(out_size, out_len) wchar_t* out, 
+	_In_ size_t out_size, 
+	_Out_ size_t& out_len
+	)
+{
+	return utf8_to_utf16(in, in_len, (char16_t*)out, out_size, out_len);
+}
+
+inline bool 
+utf16_to_utf8(
+	_In_reads_(in_len) const wchar_t* in, 
+	_In_ size_t in_len, 
+	_Out_writes_to_(out_size, out_len) char* out, 
+	_In_ size_t out_size, 
+	_Out_ size_t& out_len, 
+	_In_ bool strict = false
+	)
+{
+	return utf16_to_utf8((const char16_t*)in, in_len, out, out_size, out_len, strict);
+}
+
+bool 
+utf8_to_utf16(
+	_In_reads_(in_len) const char* in, 
+	_In_ size_t in_len, 
+	_Out_ std::wstring& out
+	);
+
+inline bool 
+utf16_to_utf8(
+	_In_reads_(in_len) const wchar_t* in, 
+	_In_ size_t in_len, 
+	_Out_ std::string& out, 
+	_In_ bool strict = false
+	)
+{
+	return utf16_to_utf8((const char16_t*)in, in_len, out, strict);
+}
+#endif//WCHAR_MAX == 0xffff
@@ -0,0 +1,223 @@
+﻿/**
+ * @file    utf_transcode_x86.cpp
+ * @brief   x86 ASCII widen/narrow kernels (SSE2, AVX2) for utf_transcode.
+ *
+ * utf_transcode.cpp 에서 CPU 지원 여부에 따라 런타임에 선택된다.
+ * 블록 (16/32 문자) 을 먼저 변환해서 쓰고, 블록에 ASCII 가 아닌 문자가 
+ * 있으면 movemask 로 첫번째 위치를 찾아서 그 앞까지만 처리한 것으로 리턴한다.
+ *
+ * @author  Yonhgwhan, Roh (somma@somma.kr)
+ * @date    2026/10/18 created.
+ * @copyright (C)Somma, Inc. All rights reserved.
+**/
+#include "stdafx.h"
+#include "cpu_features.h"
+
+#if defined(CPU_FEATURES_X86)
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+/// @brief	v 의 최하위 1 비트 위치 (v != 0)
+static inline uint32_t lowest_bit(uint32_t v)
+{
+#if defined(_MSC_VER)
+	unsigned long index;
+	_BitScanForward(&index, v);
+	return (uint32_t)index;
+#else
+	return (uint32_t)__builtin_ctz(v);
+#endif
+}
+
+/// @brief	각 16 비트 값이 ASCII 이면 해당하는 두 비트가 1 인 마스크
+CPU_TARGET("sse2")
+static inline uint32_t ascii_mask16_sse2(const __m128i v)
+{
+	const __m128i high = _mm_and_si128(v, _mm_set1_epi16((short)0xff80));
+	return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi16(high, _mm_setzero_si128()));
+}
+
+CPU_TARGET("avx2")
+static inline uint32_t ascii_mask16_avx2(const __m256i v)
+{
+	const __m256i high = _mm256_and_si256(v, _mm256_set1_epi16((short)0xff80));
+	return (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi16(high, _mm256_setzero_si256()));
+}
+
+
+//
+//	SSE2
+//
+
+CPU_TARGET("sse2")
+static inline size_t widen_ascii_sse2(const uint8_t* in, size_t in_len, uint16_t* out)
+{
+	const __m128i zero = _mm_setzero_si128();
+
+	size_t done = 0;
+	for (; in_len - done >= 16; done += 16)
+	{
+		const __m128i v = _mm_loadu_si128((const __m128i*)&in[done]);
+		_mm_storeu_si128((__m128i*)&out[done], _mm_unpacklo_epi8(v, zero));
+		_mm_storeu_si128((__m128i*)&out[done + 8], _mm_unpackhi_epi8(v, zero));
+
+		const uint32_t mask = (uint32_t)_mm_movemask_epi8(v);
+		if (0 != mask) return done + lowest_bit(mask);
+	}
+
+	for (; done < in_len && in[done] < 0x80; ++done)
+	{
+		out[done] = in[done];
+	}
+	return done;
+}
+
+CPU_TARGET("sse2")
+static inline size_t narrow_ascii_sse2(const uint16_t* in, size_t in_len, uint8_t* out)
+{
+	size_t done = 0;
+	for (; in_len - done >= 16; done += 16)
+	{
+		const __m128i lo = _mm_loadu_si128((const __m128i*)&in[done]);
+		const __m128i hi = _mm_loadu_si128((const __m128i*)&in[done + 8]);
+		_mm_storeu_si128((__m128i*)&out[done], _mm_packus_epi16(lo, hi));
+
+		const uint32_t mask = ascii_mask16_sse2(lo) | (ascii_mask16_sse2(hi) << 16);
+		if (0xffffffff != mask) return done + lowest_bit(~mask) / 2;
+	}
+
+	for (; done < in_len && in[done] < 0x80; ++done)
+	{
+		out[done] = (uint8_t)in[done];
+	}
+	return done;
+}
+
+CPU_TARGET("sse2")
+static inline size_t ascii_length8_sse2(const uint8_t* in, size_t in_len)
+{
+	size_t done = 0;
+	for (; in_len - done >= 16; done += 16)
+	{
+		const __m128i v = _mm_loadu_si128((const __m128i*)&in[done]);
+		const uint32_t mask = (uint32_t)_mm_movemask_epi8(v);
+		if (0 != mask) return done + lowest_bit(mask);
+	}
+
+	while (done < in_len && in[done] < 0x80) ++done;
+	return done;
+}
+
+CPU_TARGET("sse2")
+static inline size_t ascii_length16_sse2(const uint16_t* in, size_t in_len)
+{
+	size_t done = 0;
+	for (; in_len - done >= 8; done += 8)
+	{
+		const uint32_t mask = ascii_mask16_sse2(_mm_loadu_si128((const __m128i*)&in[done]));
+		if (0xffff != mask) return done + lowest_bit(~mask) / 2;
+	}
+
+	while (done < in_len && in[done] < 0x80) ++done;
+	return done;
+}
+
+CPU_TARGET("sse2")
+size_t utf_widen_ascii_sse2(const uint8_t* in, size_t in_len, uint16_t* out)
+{
+	return widen_ascii_sse2(in, in_len, out);
+}
+
+CPU_TARGET("sse2")
+size_t utf_narrow_ascii_sse2(const uint16_t* in, size_t in_len, uint8_t* out)
+{
+	return narrow_ascii_sse2(in, in_len, out);
+}
+
+CPU_TARGET("sse2")
+size_t utf_ascii_length8_sse2(const uint8_t* in, size_t in_len)
+{
+	return ascii_length8_sse2(in, in_len);
+}
+
+CPU_TARGET("sse2")
+size_t utf_ascii_length16_sse2(const uint16_t* in, size_t in_len)
+{
+	return ascii_length16_sse2(in, in_len);
+}
+
+
+//
+//	AVX2 
+//	32 문자 미만 남은 부분은 SSE2 블록 루프를 인라인해서 처리한다. 
+//	(SSE2 함수를 호출하면 VEX 가 아닌 SSE 명령으로 전환되면서 느려진다)
+//
+
+CPU_TARGET("avx2")
+size_t utf_widen_ascii_avx2(const uint8_t* in, size_t in_len, uint16_t* out)
+{
+	size_t done = 0;
+	for (; in_len - done >= 32; done += 32)
+	{
+		const __m256i v = _mm256_loadu_si256((const __m256i*)&in[done]);
+		_mm256_storeu_si256((__m256i*)&out[done], _mm256_cvtepu8_epi16(_mm256_castsi256_si128(v)));
+		_mm256_storeu_si256((__m256i*)&out[done + 16], _mm256_cvtepu8_epi16(_mm256_extracti128_si256(v, 1)));
+
+		const uint32_t mask = (uint32_t)_mm256_movemask_epi8(v);
+		if (0 != mask) return done + lowest_bit(mask);
+	}
+	return done + widen_ascii_sse2(&in[done], in_len - done, &out[done]);
+}
+
+CPU_TARGET("avx2")
+size_t utf_narrow_ascii_avx2(const uint16_t* in, size_t in_len, uint8_t* out)
+{
+	size_t done = 0;
+	for (; in_len - done >= 32; done += 32)
+	{
+		const __m256i lo = _mm256_loadu_si256((const __m256i*)&in[done]);
+		const __m256i hi = _mm256_loadu_si256((const __m256i*)&in[done + 16]);
+
+		//
+		//	packus 는 128 비트 lane 단위로 동작하므로 순서를 바로잡는다.
+		//
+		const __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(lo, hi), 0xd8);
+		_mm256_storeu_si256((__m256i*)&out[done], packed);
+
+		const uint32_t lo_mask = ascii_mask16_avx2(lo);
+		if (0xffffffff != lo_mask) return done + lowest_bit(~lo_mask) / 2;
+
+		const uint32_t hi_mask = ascii_mask16_avx2(hi);
+		if (0xffffffff != hi_mask) return done + 16 + lowest_bit(~hi_mask) / 2;
+	}
+	return done + narrow_ascii_sse2(&in[done], in_len - done, &out[done]);
+}
+
+CPU_TARGET("avx2")
+size_t utf_ascii_length8_avx2(const uint8_t* in, size_t in_len)
+{
+	size_t done = 0;
+	for (; in_len - done >= 32; done += 32)
+	{
+		const __m256i v = _mm256_loadu_si256((const __m256i*)&in[done]);
+		const uint32_t mask = (uint32_t)_mm256_movemask_epi8(v);
+		if (0 != mask) return done + lowest_bit(mask);
+	}
+	return done + ascii_length8_sse2(&in[done], in_len - done);
+}
+
+CPU_TARGET("avx2")
+size_t utf_ascii_length16_avx2(const uint16_t* in, size_t in_len)
+{
+	size_t done = 0;
+	for (; in_len - done >= 16; done += 16)
+	{
+		const uint32_t mask = ascii_mask16_avx2(_mm256_loadu_si256((const __m256i*)&in[done]));
+		if (0xffffffff != mask) return done + lowest_bit(~mask) / 2;
+	}
+	return done + ascii_length16_sse2(&in[done], in_len - done);
+}
+
+#endif//CPU_FEATURES_X86
@@ -0,0 +1,440 @@
+﻿/**
+ * @file    wcs_search.cpp
+ * @brief   SIMD substring search over counted (non null-terminated) wide buffers.
+ *
+ * @author  Yonhgwhan, Roh (somma@somma.kr)
+ * @date    2026/10/18 created.
+ * @copyright (C)Somma, Inc. All rights reserved.
+**/
+#include "stdafx.h"
+#include "wcs_search.h"
+#include "cpu_features.h"
+#include <wchar.h>
+#include <atomic>
+
+//
+//	후보 필터 커널
+//
+//	find_pair  : [0, positions) 중 s[i] == first && s[i + gap] == last 인 
+//	             첫번째 i, 없으면 positions
+//	rfind_pair : 같은 조건의 마지막 i, 없으면 positions
+//	ci 이면 s 의 문자를 ASCII 소문자로 바꿔서 비교한다. (first, last 는 이미 소문자)
+//
+typedef size_t (*find_pair16_fn)(const uint16_t* s, size_t positions, size_t gap, uint16_t first, uint16_t last, bool ci);
+
+#if defined(CPU_FEATURES_X86)
+size_t wcs_find_pair16_sse2(const uint16_t* s, size_t positions, size_t gap, uint16_t first, uint16_t last, bool ci);
+size_t wcs_rfind_pair16_sse2(const uint16_t* s, size_t positions, size_t gap, uint16_t first, uint16_t last, bool ci);
+size_t wcs_find_pair16_avx2(const uint16_t* s, size_t positions, size_t gap, uint16_t first, uint16_t last, bool ci);
+size_t wcs_rfind_pair16_avx2(const uint16_t* s, size_t positions, size_t gap, uint16_t first, uint16_t last, bool ci);
+#endif
+
+template <typename U, bool CI>
+static inline U fold(U c)
+{
+	return (CI && (U)(c - 'A') < 26) ? (U)(c | 0x20) : c;
+}
+
+template <typename U, bool CI>
+static size_t find_pair_scalar(const U* s, size_t positions, size_t gap, U first, U last)
+{
+	for (size_t i = 0; i < positions; ++i)
+	{
+		if (fold<U, CI>(s[i]) == first && fold<U, CI>(s[i + gap]) == last) return i;
+	}
+	return positions;
+}
+
+template <typename U, bool CI>
+static size_t rfind_pair_scalar(const U* s, size_t positions, size_t gap, U first, U last)
+{
+	for (size_t i = positions; i > 0; --i)
+	{
+		if (fold<U, CI>(s[i - 1]) == first && fold<U, CI>(s[i - 1 + gap]) == last) return i - 1;
+	}
+	return positions;
+}
+
+template <typename U>
+static size_t find_pair_scalar(const U* s, size_t positions, size_t gap, U first, U last, bool ci)
+{
+	return ci ? 
+		find_pair_scalar<U, true>(s, positions, gap, first, last) : 
+		find_pair_scalar<U, false>(s, positions, gap, first, last);
+}
+
+template <typename U>
+static size_t rfind_pair_scalar(const U* s, size_t positions, size_t gap, U first, U last, bool ci)
+{
+	return ci ? 
+		rfind_pair_scalar<U, true>(s, positions, gap, first, last) : 
+		rfind_pair_scalar<U, false>(s, positions, gap, first, last);
+}
+
+typedef struct wcs_search_kernels
+{
+	int impl;
+	find_pair16_fn find_pair16;
+	find_pair16_fn rfind_pair16;
+} *pwcs_search_kernels;
+
+static const wcs_search_kernels _kernels_scalar = {
+	WCS_SEARCH_IMPL_SCALAR,
+	find_pair_scalar<uint16_t>,
+	rfind_pair_scalar<uint16_t>
+};
+#if defined(CPU_FEATURES_X86)
+static const wcs_search_kernels _kernels_sse2 = {
+	WCS_SEARCH_IMPL_SSE2,
+	wcs_find_pair16_sse2,
+	wcs_rfind_pair16_sse2
+};
+static const wcs_search_kernels _kernels_avx2 = {
+	WCS_SEARCH_IMPL_AVX2,
+	wcs_find_pair16_avx2,
+	wcs_rfind_pair16_avx2
+};
+#endif
+
+static const wcs_search_kernels* wcs_search_impl_kernels(int impl)
+{
+	switch (impl)
+	{
+	case WCS_SEARCH_IMPL_SCALAR:
+		return &_kernels_scalar;
+#if defined(CPU_FEATURES_X86)
+	case WCS_SEARCH_IMPL_SSE2:
+		return get_cpu_features().sse2 ? &_kernels_sse2 : nullptr;
+	case WCS_SEARCH_IMPL_AVX2:
+		return get_cpu_features().avx2 ? &_kernels_avx2 : nullptr;
+#endif
+	}
+	return nullptr;
+}
+
+static int wcs_search_best_impl()
+{
+	if (nullptr != wcs_search_impl_kernels(WCS_SEARCH_IMPL_AVX2)) return WCS_SEARCH_IMPL_AVX2;
+	if (nullptr != wcs_search_impl_kernels(WCS_SEARCH_IMPL_SSE2)) return WCS_SEARCH_IMPL_SSE2;
+	return WCS_SEARCH_IMPL_SCALAR;
+}
+
+static std::atomic<const wcs_search_kernels*> _kernels(nullptr);
+
+static const wcs_search_kernels* wcs_search_get_kernels()
+{
+	const wcs_search_kernels* kernels = _kernels.load(std::memory_order_relaxed);
+	if (nullptr == kernels)
+	{
+		kernels = wcs_search_impl_kernels(wcs_search_best_impl());
+		_kernels.store(kernels, std::memory_order_relaxed);
+	}
+	return kernels;
+}
+
+/// @brief	wcs_search 함수들이 사용할 구현을 선택한다.
+///			WCS_SEARCH_IMPL_AUTO 는 CPU 가 지원하는 가장 빠른 구현을 선택한다.
+bool wcs_search_set_impl(int impl)
+{
+	if (WCS_SEARCH_IMPL_AUTO == impl)
+	{
+		impl = wcs_search_best_impl();
+	}
+
+	const wcs_search_kernels* kernels = wcs_search_impl_kernels(impl);
+	if (nullptr == kernels) return false;
+
+	_kernels.store(kernels, std::memory_order_relaxed);
+	return true;
+}
+
+int wcs_search_get_impl()
+{
+	return wcs_search_get_kernels()->impl;
+}
+
+bool wcs_search_impl_supported(int impl)
+{
+	return (WCS_SEARCH_IMPL_AUTO == impl || nullptr != wcs_search_impl_kernels(impl));
+}
+
+const char* wcs_search_impl_name(int impl)
+{
+	switch (impl)
+	{
+	case WCS_SEARCH_IMPL_AUTO: return "auto";
+	case WCS_SEARCH_IMPL_SCALAR: return "scalar";
+	case WCS_SEARCH_IMPL_SSE2: return "sse2";
+	case WCS_SEARCH_IMPL_AVX2: return "avx2";
+	}
+	return "unknown";
+}
+
+
+//
+//	Two-Way (Crochemore-Perrin)
+//
+//	REV 이면 haystack/needle 을 뒤집은 문자열에서 찾는다. (마지막 위치 검색용)
+//
+
+template <typename U, bool CI, bool REV>
+class fold_seq
+{
+public:
+	fold_seq(const U* buf, size_t len) : _buf(buf), _len(len) {}
+	U operator[](size_t i) const { return fold<U, CI>(REV ? _buf[_len - 1 - i] : _buf[i]); }
+private:
+	const U* _buf;
+	size_t _len;
+};
+
+/// @brief	needle 의 maximal suffix 시작 위치 - 1 과 주기를 구한다.
+///			greater 이면 큰 문자가 앞서는 순서로 비교한다.
+template <typename SEQ>
+static ptrdiff_t maximal_suffix(const SEQ& needle, size_t m, bool greater, size_t& period)
+{
+	ptrdiff_t ms = -1;
+	size_t j = 0;
+	size_t k = 1;
+	size_t p = 1;
+	while (j + k < m)
+	{
+		const auto a = needle[(size_t)(ms + (ptrdiff_t)k)];
+		const auto b = needle[j + k];
+		if (a == b)
+		{
+			if (k == p)
+			{
+				j += p;
+				k = 1;
+			}
+			else
+			{
+				++k;
+			}
+		}
+		else if (greater ? (a > b) : (a < b))
+		{
+			j += k;
+			k = 1;
+			p = j - (size_t)(ms + 1) + 1;
+		}
+		else
+		{
+			ms = (ptrdiff_t)j++;
+			k = p = 1;
+		}
+	}
+	period = p;
+	return ms;
+}
+
+/// @brief	haystack[start, n) 에서 needle 을 찾는다. (위치는 SEQ 기준)
+template <typename U, bool CI, bool REV>
+static size_t two_way(const U* haystack, size_t n, const U* needle, size_t m, size_t start)
+{
+	const fold_seq<U, CI, REV> hay(haystack, n);
+	const fold_seq<U, CI, REV> ndl(needle, m);
+
+	//
+	//	critical factorization
+	//
+	size_t p0 = 0;
+	size_t p1 = 0;
+	const ptrdiff_t ms0 = maximal_suffix(ndl, m, true, p0);
+	const ptrdiff_t ms1 = maximal_suffix(ndl, m, false, p1);
+	const size_t ms = (size_t)((ms1 > ms0 ? ms1 : ms0) + 1);	// 오른쪽 부분의 시작 위치
+	size_t period = (ms1 > ms0) ? p1 : p0;
+
+	//
+	//	needle[0, ms) == needle[period, period + ms) 이면 주기적인 needle
+	//
+	bool periodic = (period + ms <= m);
+	for (size_t i = 0; periodic && i < ms; ++i)
+	{
+		if (ndl[i] != ndl[i + period]) periodic = false;
+	}
+
+	size_t memory = 0;
+	size_t memory0 = 0;
+	if (periodic)
+	{
+		memory0 = m - period;
+	}
+	else
+	{
+		//	max(ms - 1, m - ms) + 1
+		period = ((ms > m - ms + 1) ? ms - 1 : m - ms) + 1;
+	}
+
+	for (size_t pos = start; pos + m <= n;)
+	{
+		size_t k = (ms > memory) ? ms : memory;
+		while (k < m && ndl[k] == hay[pos + k]) ++k;
+		if (k < m)
+		{
+			pos += k - ms + 1;
+			memory = 0;
+			continue;
+		}
+
+		k = ms;
+		while (k > memory && ndl[k - 1] == hay[pos + k - 1]) --k;
+		if (k <= memory) return pos;
+
+		pos += period;
+		memory = memory0;
+	}
+	return std::wstring::npos;
+}
+
+
+//
+//	검색
+//
+//	첫/마지막 문자 필터로 후보를 찾고, 후보마다 나머지를 비교한다. 
+//	비교한 문자 수가 지나온 위치 수보다 너무 많아지면 남은 구간은 Two-Way 로 찾는다.
+//
+
+static const size_t _two_way_slack = 1024;
+
+template <typename U, bool CI>
+static bool verify(const U* s, const U* needle, size_t from, size_t to, size_t& compared)
+{
+	size_t k = from;
+	while (k < to && fold<U, CI>(s[k]) == fold<U, CI>(needle[k])) ++k;
+	compared += k - from + 1;
+	return (k == to);
+}
+
+template <typename U, bool CI, typename FIND>
+static size_t search_t(const U* haystack, size_t n, const U* needle, size_t m, FIND find_pair)
+{
+	if (0 == m) return 0;
+	if (m > n) return std::wstring::npos;
+
+	const size_t positions = n - m + 1;
+	const U first = fold<U, CI>(needle[0]);
+	const U last = fold<U, CI>(needle[m - 1]);
+
+	size_t compared = 0;
+	for (size_t i = 0; i < positions; ++i)
+	{
+		i += find_pair(&haystack[i], positions - i, m - 1, first, last, CI);
+		if (i >= positions) break;
+
+		if (m <= 2 || verify<U, CI>(&haystack[i], needle, 1, m - 1, compared)) return i;
+
+		if (compared > i + _two_way_slack)
+		{
+			return two_way<U, CI, false>(haystack, n, needle, m, i + 1);
+		}
+	}
+	return std::wstring::npos;
+}
+
+template <typename U, bool CI, typename FIND>
+static size_t rsearch_t(const U* haystack, size_t n, const U* needle, size_t m, FIND rfind_pair)
+{
+	if (0 == m) return n;
+	if (m > n) return std::wstring::npos;
+
+	const U first = fold<U, CI>(needle[0]);
+	const U last = fold<U, CI>(needle[m - 1]);
+
+	//
+	//	[0, positions) 구간의 뒤에서부터 찾는다.
+	//
+	size_t compared = 0;
+	for (size_t positions = n - m + 1; positions > 0;)
+	{
+		const size_t i = rfind_pair(haystack, positions, m - 1, first, last, CI);
+		if (i >= positions) break;
+
+		if (m <= 2 || verify<U, CI>(&haystack[i], needle, 1, m - 1, compared)) return i;
+
+		if (compared > (n - m - i) + _two_way_slack)
+		{
+			//
+			//	[0, i) 위치에서 시작하는 것만 남았다. 
+			//	haystack[0, i + m - 1) 을 뒤집어서 찾는다.
+			//
+			const size_t len = i + m - 1;
+			const size_t pos = two_way<U, CI, true>(haystack, len, needle, m, 0);
+			return (std::wstring::npos == pos) ? pos : len - m - pos;
+		}
+		positions = i;
+	}
+	return std::wstring::npos;
+}
+
+#if WCHAR_MAX == 0xffff
+typedef uint16_t wide_unit;
+
+template <bool CI>
+static size_t search_wide(const wchar_t* haystack, size_t n, const wchar_t* needle, size_t m, bool reverse)
+{
+	const wcs_search_kernels* kernels = wcs_search_get_kernels();
+	return reverse ?
+		rsearch_t<uint16_t, CI>((const uint16_t*)haystack, n, (const uint16_t*)needle, m, kernels->rfind_pair16) :
+		search_t<uint16_t, CI>((const uint16_t*)haystack, n, (const uint16_t*)needle, m, kernels->find_pair16);
+}
+#else
+typedef uint32_t wide_unit;
+
+template <bool CI>
+static size_t search_wide(const wchar_t* haystack, size_t n, const wchar_t* needle, size_t m, bool reverse)
+{
+	size_t (*find)(const uint32_t*, size_t, size_t, uint32_t, uint32_t, bool) = find_pair_scalar<uint32_t>;
+	size_t (*rfind)(const uint32_t*, size_t, size_t, uint32_t, uint32_t, bool) = rfind_pair_scalar<uint32_t>;
+	return reverse ?
+		rsearch_t<uint32_t, CI>((const uint32_t*)haystack, n, (const uint32_t*)needle, m, rfind) :
+		search_t<uint32_t, CI>((const uint32_t*)haystack, n, (const uint32_t*)needle, m, find);
+}
+#endif//WCHAR_MAX == 0xffff
+
+/// @brief	haystack 에서 needle 이 처음 나타나는 위치
+size_t 
+wcs_search(
+	_In_reads_(haystack_len) const wchar_t* haystack,
+	_In_ size_t haystack_len,
+	_In_reads_(needle_len) const wchar_t* needle,
+	_In_ size_t needle_len,
+	_In_ bool case_insensitive
+	)
+{
+	_ASSERTE(nullptr != haystack || 0 == haystack_len);
+	_ASSERTE(nullptr != needle || 0 == needle_len);
+	if ((nullptr == haystack && 0 != haystack_len) || 
+		(nullptr == needle && 0 != needle_len))
+	{
+		return std::wstring::npos;
+	}
+
+	return case_insensitive ?
+		search_wide<true>(haystack, haystack_len, needle, needle_len, false) :
+		search_wide<false>(haystack, haystack_len, needle, needle_len, false);
+}
+
+/// @brief	haystack 에서 needle 이 마지막으로 나타나는 위치
+size_t 
+wcs_rsearch(
+	_In_reads_(haystack_len) const wchar_t* haystack,
+	_In_ size_t haystack_len,
+	_In_reads_(needle_len) const wchar_t* needle,
+	_In_ size_t needle_len,
+	_In_ bool case_insensitive
+	)
+{
+	_ASSERTE(nullptr != haystack || 0 == haystack_len);
+	_ASSERTE(nullptr != needle || 0 == needle_len);
+	if ((nullptr == haystack && 0 != haystack_len) || 
+		(nullptr == needle && 0 != needle_len))
+	{
+		return std::wstring::npos;
+	}
+
+	return case_insensitive ?
+		search_wide<true>(haystack, haystack_len, needle, needle_len, true) :
+		search_wide<false>(haystack, haystack_len, needle, needle_len, true);
+}
@@ -0,0 +1,84 @@
+﻿/**
+ * @file    wcs_search.h
+ * @brief   SIMD substring search over counted (non null-terminated) wide buffers.
+ *
+ * UNICODE_STRING 처럼 길이가 정해진 wchar_t 버퍼에서 부분 문자열을 찾는다.
+ *
+ *	- needle 의 첫 문자와 마지막 문자를 SSE2/AVX2 로 8/16 위치씩 동시에 비교해서
+ *	  후보를 거르고, 후보 위치만 나머지 문자를 비교한다.
+ *	- 후보 비교가 너무 많아지면 (aaaa...ab 같은 주기적인 입력) Two-Way 
+ *	  (Crochemore-Perrin) 로 바꿔서 O(n + m) 을 보장한다.
+ *	- case_insensitive 이면 ASCII 문자만 대소문자를 무시한다.
+ *	- 커널은 16 비트 wchar_t (windows) 에서만 사용된다. 
+ *
+ * @author  Yonhgwhan, Roh (somma@somma.kr)
+ * @date    2026/10/18 created.
+ * @copyright (C)Somma, Inc. All rights reserved.
+**/
+#pragma once
+#include <stdint.h>
+#include <string>
+
+#define WCS_SEARCH_IMPL_AUTO	0
+#define WCS_SEARCH_IMPL_SCALAR	1
+#define WCS_SEARCH_IMPL_SSE2	2
+#define WCS_SEARCH_IMPL_AVX2	3
+
+bool wcs_search_set_impl(int impl);
+int wcs_search_get_impl();
+bool wcs_search_impl_supported(int impl);
+const char* wcs_search_impl_name(int impl);
+
+/// @brief	haystack 에서 needle 이 처음 나타나는 위치 (문자 단위)
+///			없으면 std::wstring::npos, needle 이 비어있으면 0
+size_t 
+wcs_search(
+	_In_reads_(haystack_len) const wchar_t* haystack,
+	_In_ size_t haystack_len,
+	_In_reads_(needle_len) const wchar_t* needle,
+	_In_ size_t needle_len,
+	_In_ bool case_insensitive = false
+	);
+
+/// @brief	haystack 에서 needle 이 마지막으로 나타나는 위치 (문자 단위)
+///			없으면 std::wstring::npos, needle 이 비어있으면 haystack_len
+size_t 
+wcs_rsearch(
+	_In_reads_(haystack_len) const wchar_t* haystack,
+	_In_ size_t haystack_len,
+	_In_reads_(needle_len) const wchar_t* needle,
+	_In_ size_t needle_len,
+	_In_ bool case_insensitive = false
+	);
+
+/// @brief	UNICODE_STRING 버전 
+///			(Length/Buffer 필드를 가진 구조체면 되므로 ntdef.h 가 없어도 된다)
+///
+///			test_unicode_string_wcsstr.cpp 의 uni_wcsstr() 와 같이 동작한다.
+///			- 둘 중 하나라도 nullptr 이거나 Length 가 0 이면 nullptr
+///			- needle 의 첫 문자가 L'\0' 이면 haystack->Buffer
+///			- 찾으면 haystack->Buffer 안의 위치, 못찾으면 nullptr
+template <typename UNICODE_STRING_T>
+wchar_t*
+uni_wcsstr(
+	_In_ const UNICODE_STRING_T* haystack,
+	_In_ const UNICODE_STRING_T* needle,
+	_In_ bool reverse,
+	_In_ bool case_insensitive = false
+	)
+{
+	if (nullptr == haystack || nullptr == needle) return nullptr;
+	if (0 == haystack->Length || 0 == needle->Length) return nullptr;
+	if (needle->Length > haystack->Length) return nullptr;
+	if (L'\0' == needle->Buffer[0]) return (wchar_t*)haystack->Buffer;
+
+	const size_t cnt_haystack = haystack->Length / sizeof(wchar_t);
+	const size_t cnt_needle = needle->Length / sizeof(wchar_t);
+
+	const size_t pos = (true != reverse) ? 
+		wcs_search((const wchar_t*)haystack->Buffer, cnt_haystack, (const wchar_t*)needle->Buffer, cnt_needle, case_insensitive) :
+		wcs_rsearch((const wchar_t*)haystack->Buffer, cnt_haystack, (const wchar_t*)needle->Buffer, cnt_needle, case_insensitive);
+	if (std::wstring::npos == pos) return nullptr;
+
+	return (wchar_t*)&haystack->Buffer[pos];
+}
@@ -0,0 +1,220 @@
+﻿/**
+ * @file    wcs_search_x86.cpp
+ * @brief   x86 first/last character filter kernels (SSE2, AVX2) for wcs_search.
+ *
+ * wcs_search.cpp 에서 CPU 지원 여부에 따라 런타임에 선택된다.
+ * 위치 i 의 문자와 위치 i + gap 의 문자를 각각 needle 의 첫/마지막 문자와
+ * 비교해서 둘 다 같은 위치를 movemask 로 찾는다.
+ *
+ * @author  Yonhgwhan, Roh (somma@somma.kr)
+ * @date    2026/10/18 created.
+ * @copyright (C)Somma, Inc. All rights reserved.
+**/
+#include "stdafx.h"
+#include "cpu_features.h"
+
+#if defined(CPU_FEATURES_X86)
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+/// @brief	v 의 최하위 1 비트 위치 (v != 0)
+static inline uint32_t lowest_bit(uint32_t v)
+{
+#if defined(_MSC_VER)
+	unsigned long index;
+	_BitScanForward(&index, v);
+	return (uint32_t)index;
+#else
+	return (uint32_t)__builtin_ctz(v);
+#endif
+}
+
+/// @brief	v 의 최상위 1 비트 위치 (v != 0)
+static inline uint32_t highest_bit(uint32_t v)
+{
+#if defined(_MSC_VER)
+	unsigned long index;
+	_BitScanReverse(&index, v);
+	return (uint32_t)index;
+#else
+	return (uint32_t)(31 - __builtin_clz(v));
+#endif
+}
+
+template <bool CI>
+static inline uint16_t fold(uint16_t c)
+{
+	return (CI && (uint16_t)(c - 'A') < 26) ? (uint16_t)(c | 0x20) : c;
+}
+
+template <bool CI>
+static inline bool is_pair(const uint16_t* s, size_t i, size_t gap, uint16_t first, uint16_t last)
+{
+	return (fold<CI>(s[i]) == first && fold<CI>(s[i + gap]) == last);
+}
+
+
+//
+//	SSE2
+//
+
+/// @brief	8 문자를 읽는다. CI 이면 ASCII 대문자를 소문자로 바꾼다.
+template <bool CI>
+CPU_TARGET("sse2")
+static inline __m128i load_fold_sse2(const uint16_t* s)
+{
+	const __m128i v = _mm_loadu_si128((const __m128i*)s);
+	if (!CI) return v;
+
+	const __m128i in_range = _mm_cmpgt_epi16(_mm_set1_epi16((short)(-32768 + 26)),
+											 _mm_sub_epi16(v, _mm_set1_epi16((short)('A' + 0x8000))));
+	return _mm_or_si128(v, _mm_and_si128(in_range, _mm_set1_epi16(0x20)));
+}
+
+/// @brief	s[i] == first && s[i + gap] == last 인 위치의 마스크 (위치마다 2 비트)
+template <bool CI>
+CPU_TARGET("sse2")
+static inline uint32_t pair_mask_sse2(const uint16_t* s, size_t gap, const __m128i vf, const __m128i vl)
+{
+	const __m128i eq_first = _mm_cmpeq_epi16(load_fold_sse2<CI>(s), vf);
+	const __m128i eq_last = _mm_cmpeq_epi16(load_fold_sse2<CI>(&s[gap]), vl);
+	return (uint32_t)_mm_movemask_epi8(_mm_and_si128(eq_first, eq_last));
+}
+
+template <bool CI>
+CPU_TARGET("sse2")
+static inline size_t find_pair16_sse2(const uint16_t* s, size_t positions, size_t gap, uint16_t first, uint16_t last)
+{
+	const __m128i vf = _mm_set1_epi16((short)first);
+	const __m128i vl = _mm_set1_epi16((short)last);
+
+	size_t i = 0;
+	for (; positions - i >= 8; i += 8)
+	{
+		const uint32_t mask = pair_mask_sse2<CI>(&s[i], gap, vf, vl);
+		if (0 != mask) return i + lowest_bit(mask) / 2;
+	}
+
+	for (; i < positions; ++i)
+	{
+		if (is_pair<CI>(s, i, gap, first, last)) return i;
+	}
+	return positions;
+}
+
+template <bool CI>
+CPU_TARGET("sse2")
+static inline size_t rfind_pair16_sse2(const uint16_t* s, size_t positions, size_t gap, uint16_t first, uint16_t last)
+{
+	const __m128i vf = _mm_set1_epi16((short)first);
+	const __m128i vl = _mm_set1_epi16((short)last);
+
+	size_t i = positions;
+	for (; i >= 8; i -= 8)
+	{
+		const uint32_t mask = pair_mask_sse2<CI>(&s[i - 8], gap, vf, vl);
+		if (0 != mask) return i - 8 + highest_bit(mask) / 2;
+	}
+
+	for (; i > 0; --i)
+	{
+		if (is_pair<CI>(s, i - 1, gap, first, last)) return i - 1;
+	}
+	return positions;
+}
+
+CPU_TARGET("sse2")
+size_t wcs_find_pair16_sse2(const uint16_t* s, size_t positions, size_t gap, uint16_t first, uint16_t last, bool ci)
+{
+	return ci ?
+		find_pair16_sse2<true>(s, positions, gap, first, last) :
+		find_pair16_sse2<false>(s, positions, gap, first, last);
+}
+
+CPU_TARGET("sse2")
+size_t wcs_rfind_pair16_sse2(const uint16_t* s, size_t positions, size_t gap, uint16_t first, uint16_t last, bool ci)
+{
+	return ci ?
+		rfind_pair16_sse2<true>(s, positions, gap, first, last) :
+		rfind_pair16_sse2<false>(s, positions, gap, first, last);
+}
+
+
+//
+//	AVX2 (16 위치씩, 나머지는 SSE2 로 처리)
+//
+
+template <bool CI>
+CPU_TARGET("avx2")
+static inline __m256i load_fold_avx2(const uint16_t* s)
+{
+	const __m256i v = _mm256_loadu_si256((const __m256i*)s);
+	if (!CI) return v;
+
+	const __m256i in_range = _mm256_cmpgt_epi16(_mm256_set1_epi16((short)(-32768 + 26)),
+												_mm256_sub_epi16(v, _mm256_set1_epi16((short)('A' + 0x8000))));
+	return _mm256_or_si256(v, _mm256_and_si256(in_range, _mm256_set1_epi16(0x20)));
+}
+
+template <bool CI>
+CPU_TARGET("avx2")
+static inline uint32_t pair_mask_avx2(const uint16_t* s, size_t gap, const __m256i vf, const __m256i vl)
+{
+	const __m256i eq_first = _mm256_cmpeq_epi16(load_fold_avx2<CI>(s), vf);
+	const __m256i eq_last = _mm256_cmpeq_epi16(load_fold_avx2<CI>(&s[gap]), vl);
+	return (uint32_t)_mm256_movemask_epi8(_mm256_and_si256(eq_first, eq_last));
+}
+
+template <bool CI>
+CPU_TARGET("avx2")
+static inline size_t find_pair16_avx2(const uint16_t* s, size_t positions, size_t gap, uint16_t first, uint16_t last)
+{
+	const __m256i vf = _mm256_set1_epi16((short)first);
+	const __m256i vl = _mm256_set1_epi16((short)last);
+
+	size_t i = 0;
+	for (; positions - i >= 16; i += 16)
+	{
+		const uint32_t mask = pair_mask_avx2<CI>(&s[i], gap, vf, vl);
+		if (0 != mask) return i + lowest_bit(mask) / 2;
+	}
+	return i + find_pair16_sse2<CI>(&s[i], positions - i, gap, first, last);
+}
+
+template <bool CI>
+CPU_TARGET("avx2")
+static inline size_t rfind_pair16_avx2(const uint16_t* s, size_t positions, size_t gap, uint16_t first, uint16_t last)
+{
+	const __m256i vf = _mm256_set1_epi16((short)first);
+	const __m256i vl = _mm256_set1_epi16((short)last);
+
+	size_t i = positions;
+	for (; i >= 16; i -= 16)
+	{
+		const uint32_t mask = pair_mask_avx2<CI>(&s[i - 16], gap, vf, vl);
+		if (0 != mask) return i - 16 + highest_bit(mask) / 2;
+	}
+
+	const size_t found = rfind_pair16_sse2<CI>(s, i, gap, first, last);
+	return (found < i) ? found : positions;
+}
+
+CPU_TARGET("avx2")
+size_t wcs_find_pair16_avx2(const uint16_t* s, size_t positions, size_t gap, uint16_t first, uint16_t last, bool ci)
+{
+	return ci ?
+		find_pair16_avx2<true>(s, positions, gap, first, last) :
+		find_pair16_avx2<false>(s, positions, gap, first, last);
+}
+
+CPU_TARGET("avx2")
+size_t wcs_rfind_pair16_avx2(const uint16_t* s, size_t positions, size_t gap, uint16_t first, uint16_t last, bool ci)
+{
+	return ci ?
+		rfind_pair16_avx2<true>(s, positions, gap, first, last) :
+		rfind_pair16_avx2<false>(s, positions, gap, first, last);
+}
+
+#endif//CPU_FEATURES_X86
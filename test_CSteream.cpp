@@ -9,6 +9,7 @@
 
 #include "stdafx.h"
 #include "_MyLib/src/CStream.h"
+#include "_MyLib/src/StopWatch.h"
 
 bool test_cstream()
 {
@@ -202,4 +203,329 @@ bool test_cstream_read_write_string()
 	}
 	_mem_check_end;
 	return true;
-}
\ No newline at end of file
+}
+/// @brief	작은 쓰기를 반복할 때 버퍼가 기하급수적으로 커지는지, reset() 이 
+///			버퍼를 유지하는지 확인한다.
+bool test_cstream_growth_reset()
+{
+	_mem_check_begin
+	{
+		CMemoryStream strm;
+		char chunk[100];
+		for (int i = 0; i < sizeof(chunk); ++i) chunk[i] = (char)i;
+
+		//
+		//	1MB 를 100 바이트씩 쓰는 동안 capacity 가 바뀐 횟수
+		//
+		size_t grow_count = 0;
+		size_t capacity = strm.GetCapacity();
+		for (int i = 0; i < 10 * 1024; ++i)
+		{
+			_ASSERTE(sizeof(chunk) == strm.WriteToStream(chunk, sizeof(chunk)));
+			if (capacity != strm.GetCapacity())
+			{
+				capacity = strm.GetCapacity();
+				++grow_count;
+			}
+		}
+		log_info "1MB in 100 byte writes, capacity=%zu, grow count=%zu", capacity, grow_count log_end;
+		_ASSERTE(strm.GetSize() == 10 * 1024 * sizeof(chunk));
+		_ASSERTE(grow_count < 30);
+
+		//
+		//	reset() 은 데이터만 비운다.
+		//
+		const char* memory = strm.GetMemory();
+		strm.reset();
+		_ASSERTE(0 == strm.GetSize());
+		_ASSERTE(0 == strm.GetPos());
+		_ASSERTE(capacity == strm.GetCapacity());
+		_ASSERTE(memory == strm.GetMemory());
+
+		_ASSERTE(strm.WriteInt<uint32_t>(0x11223344));
+		_ASSERTE(sizeof(uint32_t) == strm.GetSize());
+		_ASSERTE(memory == strm.GetMemory());
+		_ASSERTE(strm.SetPos(0));
+		_ASSERTE(0x11223344 == strm.ReadInt<uint32_t>());
+
+		//
+		//	ReleaseMemory() 후에는 빈 스트림
+		//
+		const size_t size = strm.GetSize();
+		char* released = strm.ReleaseMemory();
+		_ASSERTE(nullptr != released && sizeof(uint32_t) == size);
+		_ASSERTE(0 == strm.GetCapacity() && 0 == strm.GetSize() && nullptr == strm.GetMemory());
+		free(released);
+
+		_ASSERTE(strm.WriteInt<uint16_t>(0x1122));
+		_ASSERTE(strm.SetPos(0));
+		_ASSERTE(0x1122 == strm.ReadInt<uint16_t>());
+	}
+	_mem_check_end;
+
+	return true;
+}
+
+/// @brief	스트림 버퍼 풀
+bool test_cstream_pool()
+{
+	_mem_check_begin
+	{
+		stream_pool_enable(true);
+		stream_pool_reset_stats();
+
+		//
+		//	같은 크기의 스트림을 반복해서 만들면 첫번째만 새로 할당한다.
+		//
+		std::string data(10000, 'x');
+		for (int i = 0; i < 100; ++i)
+		{
+			CMemoryStream strm;
+			_ASSERTE(data.size() == strm.WriteToStream(data.c_str(), data.size()));
+			_ASSERTE(strm.to_str() == data);
+		}
+
+		stream_pool_stats stats = stream_pool_get_stats();
+		log_info "pool hits=%llu, misses=%llu, returns=%llu, discards=%llu, cached=%llu",
+			stats.hits,
+			stats.misses,
+			stats.returns,
+			stats.discards,
+			stats.cached_bytes
+			log_end;
+		_ASSERTE(stats.hits > 0);
+		_ASSERTE(stats.misses < 10);
+		_ASSERTE(stats.cached_bytes > 0);
+
+		//
+		//	크기 클래스
+		//
+		size_t capacity = 0;
+		char* ptr = stream_pool_acquire(5000, capacity);
+		_ASSERTE(nullptr != ptr && 8192 == capacity);
+		stream_pool_release(ptr, capacity);
+		_ASSERTE(nullptr == stream_pool_acquire(STREAM_POOL_MAX_CLASS_SIZE + 1, capacity));
+
+		//
+		//	한도를 넘는 버퍼는 보관하지 않는다.
+		//
+		stream_pool_trim();
+		_ASSERTE(0 == stream_pool_get_stats().cached_bytes);
+		stream_pool_set_limit(8192);
+		{
+			size_t c1, c2;
+			char* p1 = stream_pool_acquire(8192, c1);
+			char* p2 = stream_pool_acquire(8192, c2);
+			stream_pool_reset_stats();
+			stream_pool_release(p1, c1);
+			stream_pool_release(p2, c2);
+			stats = stream_pool_get_stats();
+			_ASSERTE(1 == stats.returns && 1 == stats.discards && 8192 == stats.cached_bytes);
+		}
+		stream_pool_set_limit(STREAM_POOL_DEFAULT_LIMIT);
+
+		//
+		//	풀을 끄면 보관중인 버퍼를 모두 해제한다.
+		//
+		stream_pool_enable(false);
+		_ASSERTE(0 == stream_pool_get_stats().cached_bytes);
+		_ASSERTE(nullptr == stream_pool_acquire(4096, capacity));
+	}
+	_mem_check_end;
+
+	return true;
+}
+
+/// @brief	curl 응답처럼 작은 조각으로 큰 스트림을 채우는 경우와, 
+///			스트림을 많이 만들고 지우는 경우 (풀 사용/미사용) 의 시간
+bool test_cstream_benchmark()
+{
+	std::string chunk(1024, 'x');
+	StopWatch sw;
+
+	sw.Start();
+	for (int i = 0; i < 10; ++i)
+	{
+		CMemoryStream strm;
+		for (int k = 0; k < 16 * 1024; ++k)
+		{
+			strm.WriteToStream(chunk.c_str(), chunk.size());
+		}
+	}
+	sw.Stop();
+	log_info "16MB in 1KB writes x 10, %.3f ms/stream",
+		sw.GetDurationMilliSecond() / 10
+		log_end;
+
+	for (bool pool : { false, true })
+	{
+		stream_pool_enable(pool);
+		stream_pool_reset_stats();
+
+		sw.Start();
+		for (int i = 0; i < 1000; ++i)
+		{
+			CMemoryStream strm;
+			for (int k = 0; k < 1024; ++k)
+			{
+				strm.WriteToStream(chunk.c_str(), chunk.size());
+			}
+		}
+		sw.Stop();
+
+		stream_pool_stats stats = stream_pool_get_stats();
+		log_info "1000 streams of 1MB, pool=%s, %.3f us/stream, hits=%llu, misses=%llu",
+			pool ? "on" : "off",
+			sw.GetDurationMilliSecond() * 1000.0 / 1000,
+			stats.hits,
+			stats.misses
+			log_end;
+	}
+	stream_pool_enable(false);
+
+	sw.Start();
+	{
+		CMemoryStream strm;
+		for (int i = 0; i < 1000; ++i)
+		{
+			strm.reset();
+			for (int k = 0; k < 1024; ++k)
+			{
+				strm.WriteToStream(chunk.c_str(), chunk.size());
+			}
+		}
+	}
+	sw.Stop();
+	log_info "1000 x 1MB with reset(), %.3f us/stream",
+		sw.GetDurationMilliSecond() * 1000.0 / 1000
+		log_end;
+	return true;
+}
+
+/// @brief	CSegmentedStream 읽기/쓰기 (청크 경계에 걸치는 값), iovec
+bool test_csegmented_stream()
+{
+	_mem_check_begin
+	{
+		CSegmentedStream strm(1);
+		_ASSERTE(STREAM_POOL_MIN_CLASS_SIZE == strm.GetChunkSize());
+		_ASSERTE(!strm.SetPos(0));
+
+		//
+		//	CMemoryStream 과 같은 내용을 쓰고, 결과를 비교한다.
+		//
+		CMemoryStream ref;
+		const std::string test_str = "0123456789";
+		const std::wstring test_wstr = L"0123456789";
+		for (int i = 0; i < 1000; ++i)
+		{
+			_ASSERTE(strm.WriteInt<uint8_t>((uint8_t)i) && ref.WriteInt<uint8_t>((uint8_t)i));
+			_ASSERTE(strm.WriteInt<uint32_t>(0x11223344 + i) && ref.WriteInt<uint32_t>(0x11223344 + i));
+			_ASSERTE(strm.WriteInt<uint64_t>(0x1122334411223344 + i) && ref.WriteInt<uint64_t>(0x1122334411223344 + i));
+			_ASSERTE(strm.WriteString(test_str) && ref.WriteString(test_str));
+			_ASSERTE(strm.WriteWstring(test_wstr) && ref.WriteWstring(test_wstr));
+		}
+		_ASSERTE(strm.GetSize() == ref.GetSize());
+		_ASSERTE(strm.GetChunkCount() == (strm.GetSize() + strm.GetChunkSize() - 1) / strm.GetChunkSize());
+		_ASSERTE(strm.to_str() == ref.to_str());
+
+		_ASSERTE(strm.SetPos(0));
+		for (int i = 0; i < 1000; ++i)
+		{
+			_ASSERTE((uint8_t)i == strm.ReadInt<uint8_t>());
+			_ASSERTE((uint32_t)(0x11223344 + i) == strm.ReadInt<uint32_t>());
+			_ASSERTE((uint64_t)(0x1122334411223344 + i) == strm.ReadInt<uint64_t>());
+			_ASSERTE(strm.ReadString() == test_str);
+			_ASSERTE(strm.ReadWstring() == test_wstr);
+		}
+		_ASSERTE(strm.GetPos() == strm.GetSize());
+		_ASSERTE(false == strm.SetPos(strm.GetSize() + 1));
+
+		//
+		//	iovec 은 청크 경계에서 나뉘고, 이어 붙이면 스트림 전체와 같다.
+		//
+		std::vector<stream_iovec> iov;
+		const size_t offset = strm.GetChunkSize() - 3;
+		_ASSERTE(strm.GetIovec(iov, offset) == strm.GetChunkCount());
+		_ASSERTE(3 == iov[0].len);
+		std::string joined;
+		for (const auto& v : iov)
+		{
+			joined.append(v.base, v.len);
+		}
+		_ASSERTE(joined == ref.to_str().substr(offset));
+
+		//
+		//	curl 읽기 콜백처럼 조금씩 읽기
+		//
+		_ASSERTE(strm.SetPos(0));
+		std::string read;
+		char buf[1000];
+		size_t count;
+		while (0 != (count = strm.ReadSome(buf, sizeof(buf))))
+		{
+			read.append(buf, count);
+		}
+		_ASSERTE(read == ref.to_str());
+
+		//
+		//	중간에 쓰면 그 위치가 끝이 된다. (CMemoryStream 과 같음)
+		//
+		_ASSERTE(strm.SetPos(10) && ref.SetPos(10));
+		_ASSERTE(strm.WriteInt<uint16_t>(0xffff) && ref.WriteInt<uint16_t>(0xffff));
+		_ASSERTE(strm.GetSize() == 12 && strm.to_str() == ref.to_str());
+
+		//
+		//	reset() 은 청크를 유지한다.
+		//
+		const size_t chunk_count = strm.GetChunkCount();
+		strm.reset();
+		_ASSERTE(0 == strm.GetSize() && 0 == strm.GetPos());
+		_ASSERTE(chunk_count == strm.GetChunkCount());
+		_ASSERTE(0 == strm.GetIovec(iov));
+
+		strm.ClearStream();
+		_ASSERTE(0 == strm.GetCapacity() && 0 == strm.GetSize());
+	}
+	_mem_check_end;
+
+	return true;
+}
+
+/// @brief	큰 응답을 작은 조각으로 받는 경우 CMemoryStream / CSegmentedStream
+bool test_csegmented_stream_benchmark()
+{
+	const size_t total = 64 * 1024 * 1024;
+	std::string chunk(16 * 1024, 'x');
+	StopWatch sw;
+
+	sw.Start();
+	{
+		CMemoryStream strm;
+		for (size_t i = 0; i < total / chunk.size(); ++i)
+		{
+			strm.WriteToStream(chunk.c_str(), chunk.size());
+		}
+	}
+	sw.Stop();
+	log_info "CMemoryStream    64MB in 16KB writes, %.3f ms", sw.GetDurationMilliSecond() log_end;
+
+	sw.Start();
+	size_t chunk_count = 0;
+	{
+		CSegmentedStream strm(1024 * 1024);
+		for (size_t i = 0; i < total / chunk.size(); ++i)
+		{
+			strm.WriteToStream(chunk.c_str(), chunk.size());
+		}
+
+		std::vector<stream_iovec> iov;
+		chunk_count = strm.GetIovec(iov);
+	}
+	sw.Stop();
+	log_info "CSegmentedStream 64MB in 16KB writes, %.3f ms (%zu chunks)",
+		sw.GetDurationMilliSecond(),
+		chunk_count
+		log_end;
+	return true;
+}
@@ -7,6 +7,9 @@
  * @copyright All rights reserved by Yonghwan, Roh.
 **/
 #include "stdafx.h"
+#include "_MyLib/src/wcs_search.h"
+#include "_MyLib/src/StopWatch.h"
+#include <random>
 
 typedef struct _UNICODE_STRING {
 	USHORT Length;
@@ -20,12 +23,20 @@ typedef struct _UNICODE_STRING {
 typedef UNICODE_STRING* PUNICODE_STRING;
 typedef const UNICODE_STRING* PCUNICODE_STRING;
 
+static const int _wcs_search_impls[] = {
+	WCS_SEARCH_IMPL_SCALAR,
+	WCS_SEARCH_IMPL_SSE2,
+	WCS_SEARCH_IMPL_AVX2
+};
 
-/// @brief	
+
+/// @brief	예전 구현 (비교용 naive scan)
+///			라이브러리 버전은 wcs_search.h 의 uni_wcsstr()
 _Must_inspect_result_
 _IRQL_requires_max_(PASSIVE_LEVEL)
+static
 wchar_t*
-uni_wcsstr(
+uni_wcsstr_naive(
 	_In_ const PUNICODE_STRING haystack,
 	_In_ const PUNICODE_STRING needle,
 	_In_ bool reverse
@@ -103,6 +114,20 @@ uni_wcsstr(
 	return nullptr;
 }
 
+/// @brief	str 의 앞 count 문자만 가리키는 UNICODE_STRING (null 종료되지 않음)
+static UNICODE_STRING make_unicode_string(_In_ const wchar_t* str, _In_ size_t count)
+{
+	UNICODE_STRING ustr;
+	ustr.Buffer = (PWCH)str;
+	ustr.Length = ustr.MaximumLength = (USHORT)(count * sizeof(wchar_t));
+	return ustr;
+}
+
+/// @brief	결과 포인터를 haystack 의 인덱스로 (없으면 -1)
+static int result_index(_In_ const UNICODE_STRING& hay, _In_ const wchar_t* result)
+{
+	return (nullptr == result) ? -1 : (int)(result - hay.Buffer);
+}
 
 /// @brief 
 /// @return 
@@ -111,51 +136,230 @@ bool test_uni_wcsstr()
 	struct test_struct
 	{
 		const wchar_t* haystack;
+		size_t hay_count;			// haystack 의 앞 hay_count 문자만 사용
 		const wchar_t* needle;
-		const bool expected;
+		bool case_insensitive;
+		int expected;				// 정방향 결과 (인덱스, 없으면 -1)
+		int expected_reverse;		// 역방향 결과
 	} 
 	data[] = 
 	{
-		{L"012340123401234", L"", true},
-		{L"012340123401234", L"123", true},
-		{nullptr, nullptr, false}
+		{L"012340123401234", 14, L"", false, -1, -1},
+		{L"012340123401234", 14, L"123", false, 1, 11},
+		{L"012340123401234", 14, L"234", false, 2, 7},		// 마지막 "234" 는 길이 밖
+		{L"012340123401234", 15, L"234", false, 2, 12},
+		{L"012340123401234", 14, L"0123401234", false, 0, 0},
+		{L"012340123401234", 14, L"012340123401234", false, -1, -1},
+		{L"012340123401234", 15, L"012340123401234", false, 0, 0},
+		{L"012340123401234", 15, L"5", false, -1, -1},
+		{L"\\Device\\HarddiskVolume3\\Windows\\System32\\svchost.exe", 52, L"\\system32\\", false, -1, -1},
+		{L"\\Device\\HarddiskVolume3\\Windows\\System32\\svchost.exe", 52, L"\\system32\\", true, 31, 31},
+		{L"\\Device\\HarddiskVolume3\\Windows\\System32\\svchost.exe", 52, L"E", true, 2, 51},
+		{L"\\Device\\HarddiskVolume3\\Windows\\System32\\svchost.exe", 52, L"\\", false, 0, 40},
+		{L"C:\\Users\\홍길동\\설치파일.EXE", 21, L"설치파일.exe", true, 13, 13},
+		{L"C:\\Users\\홍길동\\설치파일.EXE", 21, L"설치파일.exe", false, -1, -1},
+		{L"@[`{", 4, L"`{", true, 2, 2},						// '@' != '`', '[' != '{'
+		{nullptr, 0, nullptr, false, 0, 0}
 	};
 
+	bool ret = true;
+	for (int impl : _wcs_search_impls)
+	{
+		if (!wcs_search_set_impl(impl))
+		{
+			log_info "wcs_search impl %s is not supported, skip.", wcs_search_impl_name(impl) log_end;
+			continue;
+		}
+
+		for (size_t i = 0; i < _countof(data); ++i)
+		{
+			if (nullptr == data[i].haystack) break;
+
+			UNICODE_STRING hay = make_unicode_string(data[i].haystack, data[i].hay_count);
+			UNICODE_STRING needle = make_unicode_string(data[i].needle, wcslen(data[i].needle));
+
+			for (bool reverse : { false, true })
+			{
+				const int expected = reverse ? data[i].expected_reverse : data[i].expected;
+				const int result = result_index(hay, uni_wcsstr(&hay, &needle, reverse, data[i].case_insensitive));
+				if (expected != result)
+				{
+					log_err
+						"uni_wcsstr mismatch. impl=%s, hay=%ws, needle=%ws, reverse=%s, expected=%d, result=%d",
+						wcs_search_impl_name(impl),
+						data[i].haystack,
+						data[i].needle,
+						reverse ? "true" : "false",
+						expected,
+						result
+						log_end;
+					ret = false;
+				}
+
+				//
+				//	case sensitive 결과는 예전 구현과 같아야 한다.
+				//
+				if (!data[i].case_insensitive &&
+					result != result_index(hay, uni_wcsstr_naive(&hay, &needle, reverse)))
+				{
+					log_err "uni_wcsstr_naive mismatch. impl=%s, hay=%ws, needle=%ws",
+						wcs_search_impl_name(impl),
+						data[i].haystack,
+						data[i].needle
+						log_end;
+					ret = false;
+				}
+			}
+		}
+
+		//
+		//	임의의 문자열 (작은 알파벳, 블록 경계 주변 길이) 로 예전 구현과 비교
+		//
+		std::mt19937 rng(impl);
+		const wchar_t alphabet[] = { L'a', L'b', L'\\', 0xac00 };
+		for (int round = 0; round < 20000; ++round)
+		{
+			std::wstring hay_str;
+			std::wstring needle_str;
+			const size_t hay_len = 1 + rng() % 80;
+			const size_t needle_len = 1 + rng() % 6;
+			const size_t letters = 2 + rng() % 3;
+			for (size_t k = 0; k < hay_len; ++k) hay_str.push_back(alphabet[rng() % letters]);
+			for (size_t k = 0; k < needle_len; ++k) needle_str.push_back(alphabet[rng() % letters]);
+
+			UNICODE_STRING hay = make_unicode_string(hay_str.c_str(), hay_str.size());
+			UNICODE_STRING needle = make_unicode_string(needle_str.c_str(), needle_str.size());
+			for (bool reverse : { false, true })
+			{
+				if (uni_wcsstr(&hay, &needle, reverse) != uni_wcsstr_naive(&hay, &needle, reverse))
+				{
+					log_err "random mismatch. impl=%s, hay=%ws, needle=%ws, reverse=%s",
+						wcs_search_impl_name(impl),
+						hay_str.c_str(),
+						needle_str.c_str(),
+						reverse ? "true" : "false"
+						log_end;
+					ret = false;
+				}
+			}
+		}
+
+		//
+		//	주기적인 입력 (Two-Way 로 넘어가는 경우)
+		//
+		std::wstring periodic(20000, L'a');
+		std::wstring periodic_needle(300, L'a');
+		periodic_needle[150] = L'b';
+		if (std::wstring::npos != wcs_search(periodic.c_str(), periodic.size(), periodic_needle.c_str(), periodic_needle.size()) ||
+			std::wstring::npos != wcs_rsearch(periodic.c_str(), periodic.size(), periodic_needle.c_str(), periodic_needle.size()))
+		{
+			log_err "periodic false positive. impl=%s", wcs_search_impl_name(impl) log_end;
+			ret = false;
+		}
+
+		periodic.replace(5000, periodic_needle.size(), periodic_needle);
+		periodic.replace(15000, periodic_needle.size(), periodic_needle);
+		periodic_needle[7] = L'A';
+		if (5000 != wcs_search(periodic.c_str(), periodic.size(), periodic_needle.c_str(), periodic_needle.size(), true) ||
+			15000 != wcs_rsearch(periodic.c_str(), periodic.size(), periodic_needle.c_str(), periodic_needle.size(), true) ||
+			std::wstring::npos != wcs_search(periodic.c_str(), periodic.size(), periodic_needle.c_str(), periodic_needle.size()))
+		{
+			log_err "periodic search failed. impl=%s", wcs_search_impl_name(impl) log_end;
+			ret = false;
+		}
+	}
 
-	for (int i = 0; i < sizeof(test_struct); ++i)
+	wcs_search_set_impl(WCS_SEARCH_IMPL_AUTO);
+	return ret;
+}
+
+/// @brief	긴 device 경로에서의 검색 시간 (ns/검색), 예전 구현과 비교
+bool test_uni_wcsstr_benchmark()
+{
+	static const wchar_t* const paths[] = {
+		L"\\Device\\HarddiskVolume3\\Windows\\WinSxS\\amd64_microsoft-windows-servicingstack_31bf3856ad364e35_10.0.19041.3920_none_7e0bd6c5a3c9ee34\\TiWorker.exe",
+		L"\\Device\\HarddiskVolume3\\Users\\somma\\AppData\\Local\\Microsoft\\Windows\\INetCache\\IE\\0Z5KQ7JX\\setup_x64_2026-10-18[1].exe",
+		L"\\Device\\HarddiskVolume4\\Program Files (x86)\\Google\\Chrome\\Application\\118.0.5993.118\\Installer\\chrmstp.exe",
+		L"\\Device\\HarddiskVolumeShadowCopy12\\ProgramData\\Microsoft\\Windows Defender\\Platform\\4.18.23090.2008-0\\MsMpEng.exe",
+		L"\\Device\\Mup\\;LanmanRedirector\\;Z:0000000000012345\\192.168.0.10\\share\\보고서\\2026년\\회의록_최종.docx",
+	};
+	static const wchar_t* const needles[] = {
+		L"\\AppData\\Local\\Temp\\",
+		L"\\Windows\\System32\\",
+		L"MsMpEng.exe",
+		L"\\Installer\\",
+	};
+
+	std::vector<UNICODE_STRING> hays;
+	for (size_t i = 0; i < 10000; ++i)
 	{
-		if (nullptr == data[i].haystack) break;
-
-		UNICODE_STRING hay;
-		hay.Buffer = (wchar_t*)data[i].haystack;
-		// test 를 위해서 일부러 null 문자 길이를 뺌
-		hay.Length = hay.MaximumLength = (USHORT)wcslen(data[i].haystack)*sizeof(wchar_t) - sizeof(wchar_t);
-		
-		UNICODE_STRING needle;
-		needle.Buffer = (wchar_t*)data[i].needle;
-		needle.Length = needle.MaximumLength = (USHORT)wcslen(data[i].needle) * sizeof(wchar_t) - sizeof(wchar_t);
-
-		bool reverse = true;
-		wchar_t* result = uni_wcsstr(&hay, &needle, reverse);
-		log_info
-			"hay=%ws, needle=%ws, reverse=%s, result=%ws",
-			hay.Buffer,
-			needle.Buffer,
-			reverse ? "true" : "false",
-			result
-			log_end;
+		const wchar_t* path = paths[i % _countof(paths)];
+		hays.push_back(make_unicode_string(path, wcslen(path)));
+	}
+	std::vector<UNICODE_STRING> ndls;
+	for (const wchar_t* needle : needles)
+	{
+		ndls.push_back(make_unicode_string(needle, wcslen(needle)));
+	}
+
+	const int rounds = 20;
+	const double count = (double)hays.size() * ndls.size() * rounds * 2;
 
-		reverse = false;
-		result = uni_wcsstr(&hay, &needle, reverse);
-		log_info
-			"hay=%ws, needle=%ws, reverse=%s, result=%ws",
-			hay.Buffer,
-			needle.Buffer,
-			reverse ? "true" : "false",
-			result
+	{
+		size_t check = 0;
+
+		StopWatch sw;
+		sw.Start();
+		for (int r = 0; r < rounds; ++r)
+		{
+			for (auto& hay : hays)
+			{
+				for (auto& needle : ndls)
+				{
+					if (nullptr != uni_wcsstr_naive(&hay, &needle, false)) ++check;
+					if (nullptr != uni_wcsstr_naive(&hay, &needle, true)) ++check;
+				}
+			}
+		}
+		sw.Stop();
+
+		log_info "naive  : %7.1f ns/search (check=%zu)", 
+			sw.GetDurationSecond() * 1e9 / count, check 
 			log_end;
 	}
-	
-	return true;
 
-}
\ No newline at end of file
+	for (int impl : _wcs_search_impls)
+	{
+		if (!wcs_search_set_impl(impl)) continue;
+
+		for (bool case_insensitive : { false, true })
+		{
+			size_t check = 0;
+
+			StopWatch sw;
+			sw.Start();
+			for (int r = 0; r < rounds; ++r)
+			{
+				for (auto& hay : hays)
+				{
+					for (auto& needle : ndls)
+					{
+						if (nullptr != uni_wcsstr(&hay, &needle, false, case_insensitive)) ++check;
+						if (nullptr != uni_wcsstr(&hay, &needle, true, case_insensitive)) ++check;
+					}
+				}
+			}
+			sw.Stop();
+
+			log_info "%-6s : %7.1f ns/search (check=%zu%s)",
+				wcs_search_impl_name(impl),
+				sw.GetDurationSecond() * 1e9 / count,
+				check,
+				case_insensitive ? ", case insensitive" : ""
+				log_end;
+		}
+	}
+
+	wcs_search_set_impl(WCS_SEARCH_IMPL_AUTO);
+	return true;
+}